@@ -23,20 +23,52 @@
 
 #include "mfxdefs.h"
 #include <vector>
+#include <deque>
 #include <memory>
 #include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "aenc.h"
 #include "mfx_enctools_utils.h"
 
 #define ENC_TOOLS_DS_FRAME_WIDTH 256
 #define ENC_TOOLS_DS_FRAME_HEIGHT 128
 
+// result ring holds the look-ahead window (MaxDelayInFrames + MaxGopRefDist) plus
+// this many frames which are already analyzed but still being encoded
+#define ENC_TOOLS_AENC_RING_MARGIN 16
+// luma plane preparation is split into bands of at least this many rows
+#define ENC_TOOLS_AENC_MIN_BAND_ROWS 64
+#define ENC_TOOLS_AENC_MAX_PREP_THREADS 4
+
+/*
+AEnc_EncTool runs the AEnc analyzer asynchronously:
+ - SubmitFrame prepares (downscales or copies) the luma plane into a pooled buffer
+   and puts it into the submit queue; it never waits for the analysis itself.
+   Large planes are copied in row bands by a pool of preparation threads.
+ - a worker thread drains the submit queue in order and calls AEncProcessFrame.
+   AEnc keeps GOP/ARef state between frames, so the calls themselves are serialized,
+   and preparation of the next frames runs concurrently with analysis.
+ - results are kept in a fixed ring indexed by display order (POC % ring size),
+   decision getters wait only if the requested frame is still in flight.
+   A new result replaces whatever the slot holds: an older POC in the same slot
+   is at least a whole ring behind and can't be requested anymore.
+*/
 class AEnc_EncTool
 {
 public:
     AEnc_EncTool() :
-        m_ptmpFrame(nullptr),
-        m_bInit(false)
+        m_aenc(nullptr),
+        m_bInit(false),
+        m_bStop(false),
+        m_bBusy(false),
+        m_asyncSts(MFX_ERR_NONE),
+        m_bPrepStop(false),
+        m_prepPending(0),
+        m_curFrame(),
+        FrameWidth_aligned(0),
+        FrameHeight_aligned(0)
     {
         m_aencPar = {};
     }
@@ -53,13 +85,74 @@ public:
     bool DoDownScaling(mfxFrameInfo const & frameInfo);
 
 protected:
-    std::vector<AEncFrame>  m_outframes;
-    std::vector<AEncFrame>::iterator m_frameIt;
+    enum eAEncRequest
+    {
+        AENC_PROCESS_FRAME = 0,
+        AENC_FLUSH,
+        AENC_UPDATE_BITS
+    };
+
+    struct AEncRequest
+    {
+        eAEncRequest Type;
+        mfxU32       POC;
+        mfxI32       Pitch;
+        std::vector<mfxU8> Luma;
+        // AENC_UPDATE_BITS
+        mfxU32       Bits;
+        mfxU32       QpY;
+        mfxU32       ClassCmplx;
+    };
+
+    struct AEncRingSlot
+    {
+        bool      Valid;
+        AEncFrame Frame;
+    };
+
+    // band of rows copied by a preparation thread
+    struct AEncPrepJob
+    {
+        mfxU8 const * Src;
+        mfxU32        SrcPitch;
+        mfxU8 *       Dst;
+        mfxU32        DstPitch;
+        mfxU32        Width;
+        mfxU32        Height;
+    };
+
     mfxStatus FindOutFrame(mfxU32 displayOrder);
+    void      Enqueue(AEncRequest && request);
+    void      WorkerLoop();
+    void      StoreResult(AEncFrame const & frame);
+    void      CopyPlane(mfxU8 const * src, mfxU32 srcPitch, mfxU8 * dst, mfxU32 dstPitch, mfxU32 width, mfxU32 height);
+    void      PrepWorkerLoop();
+    void      StopWorker();
+
     mfxHDL       m_aenc;
     AEncParam    m_aencPar;
-    mfxU8 *m_ptmpFrame;
-    bool m_bInit;
+    bool         m_bInit;
+
+    std::thread              m_worker;
+    std::mutex               m_mutex;
+    std::condition_variable  m_cvSubmitted;
+    std::condition_variable  m_cvCompleted;
+    bool                     m_bStop;
+    bool                     m_bBusy;
+    mfxStatus                m_asyncSts;    // first analysis error, sticky
+    std::deque<AEncRequest>  m_submitQueue;
+    std::vector<std::vector<mfxU8>> m_freeBuffers;
+    std::vector<AEncRingSlot> m_ring;
+
+    std::vector<std::thread> m_prepWorkers;
+    std::mutex               m_prepMutex;
+    std::condition_variable  m_cvPrep;
+    std::condition_variable  m_cvPrepDone;
+    bool                     m_bPrepStop;
+    mfxU32                   m_prepPending; // bands of the current frame not copied yet
+    std::deque<AEncPrepJob>  m_prepQueue;
+
+    AEncFrame    m_curFrame; // copy of the frame found by FindOutFrame
     mfxU32 FrameWidth_aligned;
     mfxU32 FrameHeight_aligned;
 
@@ -81,6 +81,23 @@ mfxStatus AEnc_EncTool::Init(mfxEncToolsCtrl const & ctrl, mfxExtEncToolsConfig
 
     mfxStatus sts = AEncInit(&m_aenc, m_aencPar);
     MFX_CHECK_STS(sts);
+
+    m_ring.assign(ctrl.MaxDelayInFrames + ctrl.MaxGopRefDist + ENC_TOOLS_AENC_RING_MARGIN, AEncRingSlot());
+    m_submitQueue.clear();
+    m_asyncSts = MFX_ERR_NONE;
+    m_bStop = false;
+    m_bBusy = false;
+    m_worker = std::thread(&AEnc_EncTool::WorkerLoop, this);
+
+    // the caller copies one band itself, so the pool is one thread smaller
+    mfxU32 numBands = std::min<mfxU32>(m_aencPar.FrameHeight / ENC_TOOLS_AENC_MIN_BAND_ROWS,
+        std::min<mfxU32>(std::thread::hardware_concurrency(), ENC_TOOLS_AENC_MAX_PREP_THREADS));
+    m_prepQueue.clear();
+    m_prepPending = 0;
+    m_bPrepStop = false;
+    for (mfxU32 i = 1; i < numBands; i++)
+        m_prepWorkers.emplace_back(&AEnc_EncTool::PrepWorkerLoop, this);
+
     m_bInit = true;
     return sts;
 }
@@ -112,7 +129,7 @@ mfxStatus AEnc_EncTool::SubmitFrame(mfxFrameSurface1 *surface)
     MFX_CHECK(m_bInit, MFX_ERR_NOT_INITIALIZED);
     mfxStatus sts = MFX_ERR_NONE;
     mfxU32 wS, hS, pitch;
-    mfxU8 *pS0, *pS;
+    mfxU8 *pS;
 
     if (surface->Info.CropH > 0 && surface->Info.CropW > 0)
     {
@@ -125,56 +142,201 @@ mfxStatus AEnc_EncTool::SubmitFrame(mfxFrameSurface1 *surface)
         hS = surface->Info.Height;
     }
     pitch = surface->Data.Pitch;
+    MFX_CHECK_NULL_PTR1(surface->Data.Y);
 
-    pS = pS0 = surface->Data.Y + surface->Info.CropX + surface->Info.CropY * pitch;
+    pS = surface->Data.Y + surface->Info.CropX + surface->Info.CropY * pitch;
 
-    if (wS > m_aencPar.FrameWidth || hS > m_aencPar.FrameHeight)
+    AEncRequest request = {};
+    request.Type  = AENC_PROCESS_FRAME;
+    request.POC   = surface->Data.FrameOrder;
+    request.Pitch = (mfxI32)m_aencPar.FrameWidth;
     {
-        if (!m_ptmpFrame)
-            m_ptmpFrame = new mfxU8[m_aencPar.FrameWidth * m_aencPar.FrameHeight];
+        std::lock_guard<std::mutex> guard(m_mutex);
+        MFX_CHECK_STS(m_asyncSts);
+        if (!m_freeBuffers.empty())
+        {
+            request.Luma.swap(m_freeBuffers.back());
+            m_freeBuffers.pop_back();
+        }
+    }
+    request.Luma.resize(m_aencPar.FrameWidth * m_aencPar.FrameHeight);
 
-        sts = DownScaleNN(*pS, wS, hS, pitch, *m_ptmpFrame, m_aencPar.FrameWidth, m_aencPar.FrameHeight, m_aencPar.FrameWidth);
-        pitch = m_aencPar.FrameWidth;
-        pS = m_ptmpFrame;
+    // the surface can be released right after return, so the analyzed plane is
+    // always prepared here on the caller's thread
+    if (wS > m_aencPar.FrameWidth || hS > m_aencPar.FrameHeight)
+    {
+        sts = DownScaleNN(*pS, wS, hS, pitch, *request.Luma.data(), m_aencPar.FrameWidth, m_aencPar.FrameHeight, m_aencPar.FrameWidth);
         MFX_CHECK_STS(sts);
     }
+    else
+    {
+        mfxU32 w = std::min(wS, m_aencPar.FrameWidth);
+        mfxU32 h = std::min(hS, m_aencPar.FrameHeight);
+        CopyPlane(pS, pitch, request.Luma.data(), m_aencPar.FrameWidth, w, h);
+    }
 
-    AEncFrame res;
-    sts = AEncProcessFrame(m_aenc, surface->Data.FrameOrder, pS, pitch, &res);
-    if (MFX_ERR_NONE != sts)
-        return MFX_ERR_MORE_DATA;
-    //else
-    //    res.print();
-
-    m_outframes.push_back(res);
+    Enqueue(std::move(request));
 
     return sts;
 }
 
+static void CopyRows(mfxU8 const * src, mfxU32 srcPitch, mfxU8 * dst, mfxU32 dstPitch, mfxU32 width, mfxU32 height)
+{
+    for (mfxU32 y = 0; y < height; y++)
+        std::copy(src + y * srcPitch, src + y * srcPitch + width, dst + y * dstPitch);
+}
 
- mfxStatus AEnc_EncTool::FindOutFrame(mfxU32 displayOrder)
+// Splits the plane into row bands, hands all but the first one to the preparation
+// pool and returns when every band is copied, the source surface isn't ours after return
+void AEnc_EncTool::CopyPlane(mfxU8 const * src, mfxU32 srcPitch, mfxU8 * dst, mfxU32 dstPitch, mfxU32 width, mfxU32 height)
 {
-     struct CompareByDisplayOrder
-     {
-         mfxU32 m_DispOrder;
-         CompareByDisplayOrder(mfxU32 frameOrder) : m_DispOrder(frameOrder) {}
-         bool operator ()(AEncFrame const & extframe) const { return extframe.POC == m_DispOrder; }
-     };
-     {
-         auto outframe = std::find_if(m_outframes.begin(), m_outframes.end(), CompareByDisplayOrder(displayOrder));
-         if (outframe == m_outframes.end())
-         {
-             // EOS:output previously submitted frames
-             mfxFrameSurface1 emptySrf = {};
-             emptySrf.Data.FrameOrder = UINT_MAX;
-             SubmitFrame(&emptySrf);
-             outframe = std::find_if(m_outframes.begin(), m_outframes.end(), CompareByDisplayOrder(displayOrder));
-             if (outframe == m_outframes.end())
-                 return MFX_ERR_INCOMPATIBLE_VIDEO_PARAM;
-         }
-         m_frameIt = outframe;
-     }
-    return MFX_ERR_NONE;
+    mfxU32 numBands = std::min<mfxU32>((mfxU32)m_prepWorkers.size() + 1, height / ENC_TOOLS_AENC_MIN_BAND_ROWS);
+    if (numBands < 2)
+    {
+        CopyRows(src, srcPitch, dst, dstPitch, width, height);
+        return;
+    }
+
+    mfxU32 bandRows = (height + numBands - 1) / numBands;
+    {
+        std::lock_guard<std::mutex> guard(m_prepMutex);
+        for (mfxU32 y = bandRows; y < height; y += bandRows)
+        {
+            AEncPrepJob job = {};
+            job.Src      = src + y * srcPitch;
+            job.SrcPitch = srcPitch;
+            job.Dst      = dst + y * dstPitch;
+            job.DstPitch = dstPitch;
+            job.Width    = width;
+            job.Height   = std::min(bandRows, height - y);
+            m_prepQueue.push_back(job);
+            m_prepPending++;
+        }
+    }
+    m_cvPrep.notify_all();
+
+    CopyRows(src, srcPitch, dst, dstPitch, width, bandRows);
+
+    std::unique_lock<std::mutex> lock(m_prepMutex);
+    m_cvPrepDone.wait(lock, [this] { return m_prepPending == 0; });
+}
+
+void AEnc_EncTool::PrepWorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_prepMutex);
+
+    for (;;)
+    {
+        m_cvPrep.wait(lock, [this] { return m_bPrepStop || !m_prepQueue.empty(); });
+        if (m_bPrepStop)
+            break;
+
+        AEncPrepJob job = m_prepQueue.front();
+        m_prepQueue.pop_front();
+        lock.unlock();
+
+        CopyRows(job.Src, job.SrcPitch, job.Dst, job.DstPitch, job.Width, job.Height);
+
+        lock.lock();
+        if (--m_prepPending == 0)
+            m_cvPrepDone.notify_one();
+    }
+}
+
+void AEnc_EncTool::Enqueue(AEncRequest && request)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_submitQueue.push_back(std::move(request));
+    }
+    m_cvSubmitted.notify_one();
+}
+
+void AEnc_EncTool::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (;;)
+    {
+        m_cvSubmitted.wait(lock, [this] { return m_bStop || !m_submitQueue.empty(); });
+        if (m_bStop)
+            break;
+
+        AEncRequest request = std::move(m_submitQueue.front());
+        m_submitQueue.pop_front();
+        m_bBusy = true;
+        lock.unlock();
+
+        AEncFrame res = {};
+        mfxStatus sts = MFX_ERR_MORE_DATA;
+
+        switch (request.Type)
+        {
+        case AENC_PROCESS_FRAME:
+            sts = AEncProcessFrame(m_aenc, request.POC, request.Luma.data(), request.Pitch, &res);
+            break;
+        case AENC_FLUSH:
+            // EOS: output previously submitted frames
+            sts = AEncProcessFrame(m_aenc, UINT_MAX, nullptr, 0, &res);
+            break;
+        case AENC_UPDATE_BITS:
+            AEncUpdatePFrameBits(m_aenc, request.POC, request.Bits, request.QpY, request.ClassCmplx);
+            break;
+        }
+
+        lock.lock();
+        if (sts == MFX_ERR_NONE)
+            StoreResult(res);
+        else if (sts < MFX_ERR_NONE && sts != MFX_ERR_MORE_DATA && m_asyncSts == MFX_ERR_NONE)
+            m_asyncSts = sts; // reported by next SubmitFrame or decision query
+        if (!request.Luma.empty())
+            m_freeBuffers.push_back(std::move(request.Luma));
+        m_bBusy = false;
+        m_cvCompleted.notify_all();
+    }
+}
+
+// called with m_mutex held
+void AEnc_EncTool::StoreResult(AEncFrame const & frame)
+{
+    // the slot may still hold the same POC (re-analysis after reset) or a frame
+    // a whole ring behind which the encoder never completed, both are replaced
+    AEncRingSlot & slot = m_ring[frame.POC % m_ring.size()];
+    slot.Frame = frame;
+    slot.Valid = true;
+}
+
+mfxStatus AEnc_EncTool::FindOutFrame(mfxU32 displayOrder)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    bool bFlushed = false;
+
+    for (;;)
+    {
+        AEncRingSlot const & slot = m_ring[displayOrder % m_ring.size()];
+        if (slot.Valid && slot.Frame.POC == displayOrder)
+        {
+            m_curFrame = slot.Frame;
+            return MFX_ERR_NONE;
+        }
+
+        MFX_CHECK_STS(m_asyncSts);
+
+        if (m_bBusy || !m_submitQueue.empty())
+        {
+            // requested frame can still be produced by in-flight requests
+            m_cvCompleted.wait(lock);
+            continue;
+        }
+
+        MFX_CHECK(!bFlushed, MFX_ERR_INCOMPATIBLE_VIDEO_PARAM);
+
+        AEncRequest request = {};
+        request.Type = AENC_FLUSH;
+        m_submitQueue.push_back(std::move(request));
+        m_cvSubmitted.notify_one();
+        bFlushed = true;
+    }
 }
 
 mfxStatus AEnc_EncTool::ReportEncResult(mfxU32 displayOrder, mfxEncToolsBRCEncodeResult const & pEncRes)
@@ -182,10 +344,15 @@ mfxStatus AEnc_EncTool::ReportEncResult(mfxU32 displayOrder, mfxEncToolsBRCEncod
      MFX_CHECK(m_bInit, MFX_ERR_NOT_INITIALIZED);
      mfxStatus sts = FindOutFrame(displayOrder);
      MFX_CHECK_STS(sts);
-     //printf("Found SCD_Enctool Reporting Frame %d\n", displayOrder);
-     if ((*m_frameIt).Type == MFX_FRAMETYPE_P) {
-        //printf("Updating Frame %d %d %d %d\n", displayOrder, pEncRes->CodedFrameSize, pEncRes->QpY, (*m_frameIt).ClassCmplx);
-        AEncUpdatePFrameBits(m_aenc, displayOrder, pEncRes.CodedFrameSize*8, pEncRes.QpY, (*m_frameIt).ClassCmplx);
+     if (m_curFrame.Type == MFX_FRAMETYPE_P) {
+        // AEnc isn't thread safe, update goes through the same queue as analysis
+        AEncRequest request = {};
+        request.Type       = AENC_UPDATE_BITS;
+        request.POC        = displayOrder;
+        request.Bits       = pEncRes.CodedFrameSize * 8;
+        request.QpY        = pEncRes.QpY;
+        request.ClassCmplx = m_curFrame.ClassCmplx;
+        Enqueue(std::move(request));
      }
      return MFX_ERR_NONE;
 }
@@ -196,9 +363,9 @@ mfxStatus AEnc_EncTool::GetSCDecision(mfxU32 displayOrder, mfxEncToolsHintPreEnc
 
     mfxStatus sts = FindOutFrame(displayOrder);
     MFX_CHECK_STS(sts);
-    pPreEncSC->SceneChangeFlag = static_cast<mfxU16>((*m_frameIt).SceneChanged);
-    pPreEncSC->RepeatedFrameFlag = static_cast<mfxU16>((*m_frameIt).RepeatedFrame);
-    pPreEncSC->TemporalComplexity = static_cast<mfxU16>((*m_frameIt).TemporalComplexity);
+    pPreEncSC->SceneChangeFlag = static_cast<mfxU16>(m_curFrame.SceneChanged);
+    pPreEncSC->RepeatedFrameFlag = static_cast<mfxU16>(m_curFrame.RepeatedFrame);
+    pPreEncSC->TemporalComplexity = static_cast<mfxU16>(m_curFrame.TemporalComplexity);
 
     return sts;
 }
@@ -210,10 +377,10 @@ mfxStatus AEnc_EncTool::GetGOPDecision(mfxU32 displayOrder, mfxEncToolsHintPreEn
 
     mfxStatus sts = FindOutFrame(displayOrder);
     MFX_CHECK_STS(sts);
-    mfxU16 miniGOP = (mfxU16)(*m_frameIt).MiniGopSize;
+    mfxU16 miniGOP = (mfxU16)m_curFrame.MiniGopSize;
     pPreEncGOP->MiniGopSize = miniGOP;
 
-    switch ((*m_frameIt).Type)
+    switch (m_curFrame.Type)
     {
     case MFX_FRAMETYPE_IDR:
         pPreEncGOP->FrameType = MFX_FRAMETYPE_IDR | MFX_FRAMETYPE_I | MFX_FRAMETYPE_REF;
@@ -230,9 +397,9 @@ mfxStatus AEnc_EncTool::GetGOPDecision(mfxU32 displayOrder, mfxEncToolsHintPreEn
     default:
         pPreEncGOP->FrameType = MFX_FRAMETYPE_UNKNOWN;
     }
-   pPreEncGOP->QPDelta = (mfxI16)(*m_frameIt).DeltaQP;
+   pPreEncGOP->QPDelta = (mfxI16)m_curFrame.DeltaQP;
 
-    switch ((mfxI16)(*m_frameIt).ClassAPQ)
+    switch ((mfxI16)m_curFrame.ClassAPQ)
     {
     case 1:
         pPreEncGOP->QPModulation = MFX_QP_MODULATION_HIGH;
@@ -259,15 +426,15 @@ mfxStatus AEnc_EncTool::GetARefDecision(mfxU32 displayOrder, mfxEncToolsHintPreE
 
     mfxStatus sts = FindOutFrame(displayOrder);
     MFX_CHECK_STS(sts);
-    pPreEncARef->CurrFrameType = (mfxU16)((*m_frameIt).LTR ? MFX_REF_FRAME_TYPE_LTR :
-        ((*m_frameIt).KeepInDPB ? MFX_REF_FRAME_TYPE_KEY : MFX_REF_FRAME_NORMAL));
+    pPreEncARef->CurrFrameType = (mfxU16)(m_curFrame.LTR ? MFX_REF_FRAME_TYPE_LTR :
+        (m_curFrame.KeepInDPB ? MFX_REF_FRAME_TYPE_KEY : MFX_REF_FRAME_NORMAL));
 
 
-    pPreEncARef->RejectedRefListSize = std::min<mfxU16>((mfxU16)(*m_frameIt).RemoveFromDPBSize, 16);
-    std::copy((*m_frameIt).RemoveFromDPB, (*m_frameIt).RemoveFromDPB + pPreEncARef->RejectedRefListSize, pPreEncARef->RejectedRefList);
+    pPreEncARef->RejectedRefListSize = std::min<mfxU16>((mfxU16)m_curFrame.RemoveFromDPBSize, 16);
+    std::copy(m_curFrame.RemoveFromDPB, m_curFrame.RemoveFromDPB + pPreEncARef->RejectedRefListSize, pPreEncARef->RejectedRefList);
 
-    pPreEncARef->PreferredRefListSize = std::min<mfxU16>((mfxU16)(*m_frameIt).RefListSize, 16);
-    std::copy((*m_frameIt).RefList, (*m_frameIt).RefList + pPreEncARef->PreferredRefListSize, pPreEncARef->PreferredRefList);
+    pPreEncARef->PreferredRefListSize = std::min<mfxU16>((mfxU16)m_curFrame.RefListSize, 16);
+    std::copy(m_curFrame.RefList, m_curFrame.RefList + pPreEncARef->PreferredRefListSize, pPreEncARef->PreferredRefList);
 
     return sts;
 }
@@ -278,19 +445,50 @@ mfxStatus AEnc_EncTool::CompleteFrame(mfxU32 displayOrder)
 {
     MFX_CHECK(m_bInit, MFX_ERR_NOT_INITIALIZED);
 
-    mfxStatus sts = FindOutFrame(displayOrder);
-    MFX_CHECK_STS(sts);
-    m_outframes.erase(m_frameIt);
+    // the frame was found by decision queries already, just drop it if the slot wasn't reused
+    std::lock_guard<std::mutex> guard(m_mutex);
+    MFX_CHECK_STS(m_asyncSts);
+    AEncRingSlot & slot = m_ring[displayOrder % m_ring.size()];
+    if (slot.Valid && slot.Frame.POC == displayOrder)
+        slot.Valid = false;
+
     return MFX_ERR_NONE;
 }
 
+void AEnc_EncTool::StopWorker()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_bStop = true;
+    }
+    m_cvSubmitted.notify_one();
+
+    if (m_worker.joinable())
+        m_worker.join();
+
+    {
+        std::lock_guard<std::mutex> guard(m_prepMutex);
+        m_bPrepStop = true;
+    }
+    m_cvPrep.notify_all();
+
+    for (auto & worker : m_prepWorkers)
+        worker.join();
+
+    m_prepWorkers.clear();
+    m_prepQueue.clear();
+
+    m_submitQueue.clear();
+    m_freeBuffers.clear();
+    m_ring.clear();
+}
 
 void AEnc_EncTool::Close()
 {
     if (m_bInit)
     {
+        StopWorker();
         AEncClose(m_aenc);
-        delete m_ptmpFrame;
         m_bInit = false;
     }
 }
@@ -1527,7 +1527,9 @@ mfxStatus ExtBRC::Update(mfxBRCFrameParam* frame_par, mfxBRCFrameCtrl* frame_ctr
     par.NumExtParam = (mfxU16)extParams.size();
 
     sts = Query(&par, 5000);
+    MFX_CHECK_STS(sts);
 
+    *status = extSts.FrameStatus;
     return sts;
 }
 
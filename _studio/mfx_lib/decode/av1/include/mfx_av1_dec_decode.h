@@ -20,8 +20,10 @@
 
 #include "mfx_common.h"
 #include "mfx_common_int.h"
+#include "mfx_common_decode_int.h"
 
 #include "umc_defs.h"
+#include <atomic>
 #include <mutex>
 
 #ifndef _MFX_AV1_DEC_DECODE_H_
@@ -48,10 +50,27 @@ using UMC_AV1_DECODER::AV1DecoderFrame;
 class VideoDECODEAV1
     : public VideoDECODE
 {
+    struct FilmGrainTask;
+
+    enum
+    {
+        FILM_GRAIN_IDLE,
+        FILM_GRAIN_INIT,
+        FILM_GRAIN_READY,
+        FILM_GRAIN_FAILED
+    };
+
     struct TaskInfo
+        : SharedDecodeTask
     {
-        mfxFrameSurface1 *surface_work;
-        mfxFrameSurface1 *surface_out;
+        mfxFrameSurface1 *surface_work = nullptr;
+        mfxFrameSurface1 *surface_out  = nullptr;
+
+        // film grain synthesized on the CPU by the threads running the task
+        std::atomic<int>               grain_state{FILM_GRAIN_IDLE};
+        std::unique_ptr<FilmGrainTask> grain;
+
+        ~TaskInfo();
     };
 
 public:
@@ -95,6 +114,12 @@ private:
     }
 
     mfxStatus DecodeFrame(mfxFrameSurface1 *surface_out, AV1DecoderFrame* pFrame);
+
+    // Lock the reconstructed and output surfaces of the frame and prepare its grain
+    mfxStatus InitFilmGrain(TaskInfo&, AV1DecoderFrame const&);
+    // Add film grain to the stripes left, last is set for the thread that completed the frame
+    mfxStatus ApplyFilmGrain(TaskInfo&, AV1DecoderFrame const&, bool& last);
+
     bool IsNeedChangeVideoParam(mfxVideoParam * newPar, mfxVideoParam * oldPar, eMFXHWType type) const;
 
 private:
@@ -108,6 +133,7 @@ private:
 
     bool                                         m_opaque;
     bool                                         m_first_run;
+    bool                                         m_cpu_film_grain;
 
     mfxVideoParamWrapper                         m_video_par;
     mfxVideoParamWrapper                         m_init_par;
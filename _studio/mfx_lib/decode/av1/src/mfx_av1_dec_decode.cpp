@@ -36,6 +36,7 @@
 #include "umc_av1_dec_defs.h"
 #include "umc_av1_frame.h"
 #include "umc_av1_utils.h"
+#include "umc_av1_film_grain.h"
 
 #include "libmfx_core_hw.h"
 
@@ -123,6 +124,12 @@ namespace MFX_VPX_Utility
     }
 }
 
+// frames with apply_grain off are output as they come from the driver
+inline bool AddsFilmGrainOnCpu(UMC_AV1_DECODER::AV1DecoderFrame const& frame)
+{
+    return frame.FilmGrainOnCpu() && frame.GetFrameHeader().film_grain_params.apply_grain;
+}
+
 static void SetFrameType(const UMC_AV1_DECODER::AV1DecoderFrame& frame, mfxFrameSurface1 &surface_out)
 {
     auto extFrameInfo = reinterpret_cast<mfxExtDecodedFrameInfo *>(GetExtendedBuffer(surface_out.Data.ExtParam, surface_out.Data.NumExtParam, MFX_EXTBUFF_DECODED_FRAME_INFO));
@@ -150,6 +157,7 @@ VideoDECODEAV1::VideoDECODEAV1(VideoCORE* core, mfxStatus* sts)
     , m_platform(MFX_PLATFORM_SOFTWARE)
     , m_opaque(false)
     , m_first_run(true)
+    , m_cpu_film_grain(false)
     , m_request()
     , m_response()
     , m_is_init(false)
@@ -188,6 +196,18 @@ mfxStatus VideoDECODEAV1::Init(mfxVideoParam* par)
 
     MFX_CHECK(MFX_VPX_Utility::CheckVideoParam(par, MFX_CODEC_AV1, m_platform), MFX_ERR_INVALID_VIDEO_PARAM);
 
+    m_cpu_film_grain = false;
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    auto synthesis =
+        reinterpret_cast<mfxExtAV1FilmGrainSynthesis*>(GetExtendedBuffer(par->ExtParam, par->NumExtParam, MFX_EXTBUFF_AV1_FILM_GRAIN_SYNTHESIS));
+    if (synthesis && synthesis->Mode == MFX_CODINGOPTION_ON)
+    {
+        // the CPU path handles 4:2:0 with interleaved chroma only
+        MFX_CHECK(par->mfx.FrameInfo.FourCC == MFX_FOURCC_NV12 || par->mfx.FrameInfo.FourCC == MFX_FOURCC_P010, MFX_ERR_INVALID_VIDEO_PARAM);
+        m_cpu_film_grain = true;
+    }
+#endif
+
     m_first_par = *par;
 
     MFX_CHECK(m_platform != MFX_PLATFORM_SOFTWARE, MFX_ERR_UNSUPPORTED);
@@ -261,6 +281,7 @@ mfxStatus VideoDECODEAV1::Init(mfxVideoParam* par)
     vp.allocator = m_allocator.get();
     vp.async_depth = par->AsyncDepth;
     vp.film_grain = par->mfx.FilmGrain ? 1 : 0; // 0 - film grain is forced off, 1 - film grain is controlled by apply_grain syntax parameter
+    vp.film_grain_on_cpu = m_cpu_film_grain ? 1 : 0;
     if (!vp.async_depth)
         vp.async_depth = MFX_AUTO_ASYNC_DEPTH_VALUE;
     vp.io_pattern = par->IOPattern;
@@ -700,13 +721,23 @@ mfxStatus VideoDECODEAV1::DecodeFrameCheck(mfxBitstream* bs, mfxFrameSurface1* s
     if (*surface_out)
         info->surface_out = GetOriginalSurface(*surface_out);
 
+    // film grain stripes are spread over the scheduler threads, a frame
+    // without grain is only output
+    bool grain = false;
+    if (m_cpu_film_grain && info->surface_out)
+    {
+        UMC::FrameMemID id = m_allocator->FindSurface(info->surface_out, m_opaque);
+        UMC_AV1_DECODER::AV1DecoderFrame const* frame = m_decoder->FindFrameByMemID(id);
+        grain = frame && AddsFilmGrainOnCpu(*frame);
+    }
+
     mfxThreadTask task =
         reinterpret_cast<mfxThreadTask>(info.release());
 
     entry_point->pRoutine = &DecodeRoutine;
     entry_point->pCompleteProc = &CompleteProc;
     entry_point->pState = this;
-    entry_point->requiredNumThreads = 1;
+    entry_point->requiredNumThreads = SharedDecodeTask::GetRequiredNumThreads(m_core, grain);
     entry_point->pParam = task;
 
     return sts;
@@ -799,12 +830,144 @@ mfxStatus VideoDECODEAV1::QueryFrame(mfxThreadTask task)
 
     MFX_CHECK(frame->DecodingCompleted(), MFX_TASK_WORKING);
 
+    if (AddsFilmGrainOnCpu(*frame))
+    {
+        bool last = false;
+        mfxStatus sts = ApplyFilmGrain(*info, *frame, last);
+        MFX_CHECK_STS(sts);
+
+        if (sts == MFX_TASK_BUSY)
+            return sts;
+
+        // the frame is output by the thread that added grain to its last stripe
+        if (!last)
+            return MFX_TASK_DONE;
+    }
+    else if (!info->ClaimOutput())
+        return MFX_TASK_DONE;
+
     mfxStatus sts = DecodeFrame(surface_out, frame);
     MFX_CHECK_STS(sts);
 
     return MFX_TASK_DONE;
 }
 
+// Film grain of a frame, shared by the threads running its task
+struct VideoDECODEAV1::FilmGrainTask
+{
+    FilmGrainTask(mfx_UMC_FrameAllocator& allocator)
+        : allocator(allocator)
+    {}
+
+    ~FilmGrainTask()
+    { Unlock(); }
+
+    void Unlock()
+    {
+        for (auto id : locked)
+            allocator.Unlock(id);
+
+        locked.clear();
+    }
+
+    mfx_UMC_FrameAllocator&               allocator;
+    std::vector<UMC::FrameMemID>          locked;
+
+    UMC_AV1_DECODER::FilmGrainSynthesizer synthesizer;
+    UMC_AV1_DECODER::FilmGrainFrame       src;         // reconstructed frame
+    UMC_AV1_DECODER::FilmGrainFrame       dst;         // output frame
+    std::atomic<mfxU32>                   next_stripe{0};
+    std::atomic<mfxU32>                   done_stripes{0};
+};
+
+VideoDECODEAV1::TaskInfo::~TaskInfo()
+{}
+
+mfxStatus VideoDECODEAV1::InitFilmGrain(TaskInfo& info, AV1DecoderFrame const& frame)
+{
+    std::unique_ptr<FilmGrainTask> grain(new FilmGrainTask(*m_allocator));
+
+    auto lock = [&](UMC::FrameMemID id, UMC_AV1_DECODER::FilmGrainFrame& planes)
+    {
+        UMC::FrameData const* fd = m_allocator->Lock(id);
+        if (!fd)
+            return false;
+
+        grain->locked.push_back(id);
+        planes.y     = fd->GetPlaneMemoryInfo(0)->m_planePtr;
+        planes.uv    = fd->GetPlaneMemoryInfo(1)->m_planePtr;
+        planes.pitch = fd->GetPlaneMemoryInfo(0)->m_pitch;
+
+        return true;
+    };
+
+    MFX_CHECK(lock(frame.GetMemID(UMC_AV1_DECODER::SURFACE_RECON), grain->src), MFX_ERR_LOCK_MEMORY);
+    MFX_CHECK(lock(frame.GetMemID(), grain->dst), MFX_ERR_LOCK_MEMORY);
+
+    UMC_AV1_DECODER::FilmGrainParams const& params = frame.GetFrameHeader().film_grain_params;
+    bool const p010 = m_init_par.mfx.FrameInfo.FourCC == MFX_FOURCC_P010;
+    MFX_CHECK(p010 == (params.BitDepth > 8), MFX_ERR_UNDEFINED_BEHAVIOR);
+
+    try
+    {
+        grain->synthesizer.Init(params, frame.GetUpscaledWidth(), frame.GetFrameHeight(),
+            frame.GetSeqHeader().color_config.matrix_coefficients == UMC_AV1_DECODER::AOM_CICP_MC_IDENTITY, p010 ? 6 : 0);
+    }
+    catch (UMC_AV1_DECODER::av1_exception const& ex)
+    {
+        MFX_RETURN(ConvertUMCStatusToMfx(ex.GetStatus()));
+    }
+
+    info.grain = std::move(grain);
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus VideoDECODEAV1::ApplyFilmGrain(TaskInfo& info, AV1DecoderFrame const& frame, bool& last)
+{
+    last = false;
+
+    int state = FILM_GRAIN_IDLE;
+    if (info.grain_state.compare_exchange_strong(state, FILM_GRAIN_INIT))
+    {
+        // the first thread prepares the frame, the others wait for it
+        mfxStatus sts = InitFilmGrain(info, frame);
+        info.grain_state = sts == MFX_ERR_NONE ? FILM_GRAIN_READY : FILM_GRAIN_FAILED;
+        MFX_CHECK_STS(sts);
+        state = FILM_GRAIN_READY;
+    }
+
+    if (state == FILM_GRAIN_INIT)
+        return MFX_TASK_BUSY;
+
+    // the error is reported by the thread that failed
+    if (state == FILM_GRAIN_FAILED)
+        return MFX_ERR_NONE;
+
+    FilmGrainTask& grain = *info.grain;
+    mfxU32 const count = grain.synthesizer.GetStripeCount();
+
+    try
+    {
+        for (mfxU32 stripe = grain.next_stripe++; stripe < count; stripe = grain.next_stripe++)
+        {
+            grain.synthesizer.ApplyStripe(stripe, grain.src, grain.dst);
+
+            if (++grain.done_stripes == count)
+            {
+                grain.Unlock();
+                last = true;
+            }
+        }
+    }
+    catch (std::bad_alloc const&)
+    {
+        MFX_RETURN(MFX_ERR_MEMORY_ALLOC);
+    }
+
+    return MFX_ERR_NONE;
+}
+
 static mfxStatus CheckFrameInfo(mfxFrameInfo const &currInfo, mfxFrameInfo &info)
 {
     MFX_SAFE_CALL(CheckFrameInfoCommon(&info, MFX_CODEC_AV1));
@@ -437,6 +437,9 @@ mfxStatus VideoDECODEH264::Init(mfxVideoParam *par)
     ConvertMFXParamsToUMC(&m_vFirstPar, &umcVideoParams);
     umcVideoParams.numThreads       = m_vPar.mfx.NumThread;
     umcVideoParams.m_bufferedFrames = asyncDepth - umcVideoParams.numThreads;
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    umcVideoParams.preSplitSize     = GetPreSplitSize(par);
+#endif
 
     if (MFX_PLATFORM_SOFTWARE != m_platform)
     {
@@ -795,9 +798,18 @@ mfxStatus VideoDECODEH264::DecodeHeader(VideoCORE *core, mfxBitstream *bs, mfxVi
     MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_API, "VideoDECODEH264::DecodeHeader");
     MFX_CHECK_NULL_PTR2(bs, par);
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    mfxStatus sts = CheckFragmentedBitstream(bs);
+    if (sts != MFX_ERR_NONE)
+        return sts;
+
+    MFXGatheredBitstream gathered(bs);
+    bs = gathered.Get();
+#else
     mfxStatus sts = CheckBitstream(bs);
     if (sts != MFX_ERR_NONE)
         return sts;
+#endif
 
     MFXMediaDataAdapter in(bs);
 
@@ -1168,7 +1180,16 @@ mfxStatus VideoDECODEH264::DecodeFrameCheck(mfxBitstream *bs, mfxFrameSurface1 *
 
     mfxStatus sts = MFX_ERR_NONE;
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        sts = bs ? CheckFragmentedBitstream(bs) : MFX_ERR_NONE;
+
+        // input queued for splitting can't be put back to fragments
+        if (sts == MFX_ERR_NONE && bs && m_pH264VideoDecoder->GetPreSplitter() &&
+            GetExtendedBuffer(bs->ExtParam, bs->NumExtParam, MFX_EXTBUFF_BITSTREAM_FRAGMENTS))
+            sts = MFX_ERR_UNSUPPORTED;
+#else
         sts = bs ? CheckBitstream(bs) : MFX_ERR_NONE;
+#endif
 
     if (sts != MFX_ERR_NONE)
         return sts;
@@ -1249,6 +1270,11 @@ mfxStatus VideoDECODEH264::DecodeFrameCheck(mfxBitstream *bs, mfxFrameSurface1 *
         for (;;)
         {
             umcRes = m_pH264VideoDecoder->AddSource(bs ? &src : 0);
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+            // scattered input: keep feeding fragments while splitter asks for more data
+            while (umcRes == UMC::UMC_ERR_NOT_ENOUGH_DATA && src.NextFragment())
+                umcRes = m_pH264VideoDecoder->AddSource(&src);
+#endif
 
             umcAddSourceRes = umcFrameRes = umcRes;
 
@@ -1277,7 +1303,12 @@ mfxStatus VideoDECODEH264::DecodeFrameCheck(mfxBitstream *bs, mfxFrameSurface1 *
                 }
 
                 if (umcRes == UMC::UMC_NTF_NEW_RESOLUTION)
+                {
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+                    MFX_SAFE_CALL(ReturnPreSplitData(m_pH264VideoDecoder->GetPreSplitter(), bs));
+#endif
                     return MFX_ERR_INCOMPATIBLE_VIDEO_PARAM;
+                }
             }
 
             if (umcRes == UMC::UMC_ERR_INVALID_STREAM)
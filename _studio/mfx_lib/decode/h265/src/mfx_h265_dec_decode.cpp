@@ -395,6 +395,9 @@ mfxStatus VideoDECODEH265::Init(mfxVideoParam *par)
     ConvertMFXParamsToUMC(&m_vFirstPar, &umcVideoParams);
     umcVideoParams.numThreads = m_vPar.mfx.NumThread;
     umcVideoParams.info.bitrate = asyncDepth - umcVideoParams.numThreads; // buffered frames
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    umcVideoParams.preSplitSize = GetPreSplitSize(par);
+#endif
 
     if (MFX_PLATFORM_SOFTWARE != m_platform)
     {
@@ -663,8 +666,16 @@ mfxStatus VideoDECODEH265::DecodeHeader(VideoCORE *core, mfxBitstream *bs, mfxVi
 {
     MFX_CHECK_NULL_PTR2(bs, par);
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    mfxStatus sts = CheckFragmentedBitstream(bs);
+    MFX_CHECK_STS(sts);
+
+    MFXGatheredBitstream gathered(bs);
+    bs = gathered.Get();
+#else
     mfxStatus sts = CheckBitstream(bs);
     MFX_CHECK_STS(sts);
+#endif
 
     MFXMediaDataAdapter in(bs);
 
@@ -1028,7 +1039,16 @@ mfxStatus VideoDECODEH265::DecodeFrameCheck(mfxBitstream *bs, mfxFrameSurface1 *
     MFX_CHECK_NULL_PTR2(surface_work, surface_out);
 
     mfxStatus sts = MFX_ERR_NONE;
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        sts = bs ? CheckFragmentedBitstream(bs) : MFX_ERR_NONE;
+
+        // input queued for splitting can't be put back to fragments
+        if (sts == MFX_ERR_NONE && bs && m_pH265VideoDecoder->GetPreSplitter() &&
+            GetExtendedBuffer(bs->ExtParam, bs->NumExtParam, MFX_EXTBUFF_BITSTREAM_FRAGMENTS))
+            sts = MFX_ERR_UNSUPPORTED;
+#else
         sts = bs ? CheckBitstream(bs) : MFX_ERR_NONE;
+#endif
 
     if (sts != MFX_ERR_NONE)
         return sts;
@@ -1097,6 +1117,11 @@ mfxStatus VideoDECODEH265::DecodeFrameCheck(mfxBitstream *bs, mfxFrameSurface1 *
             else
             {
                     umcRes = m_pH265VideoDecoder->AddSource(bs ? &src : 0);
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+                    // scattered input: keep feeding fragments while splitter asks for more data
+                    while (umcRes == UMC::UMC_ERR_NOT_ENOUGH_DATA && src.NextFragment())
+                        umcRes = m_pH265VideoDecoder->AddSource(&src);
+#endif
             }
 
             umcAddSourceRes = umcFrameRes = umcRes;
@@ -1165,7 +1190,12 @@ mfxStatus VideoDECODEH265::DecodeFrameCheck(mfxBitstream *bs, mfxFrameSurface1 *
             }
 
             if (sts == MFX_ERR_INCOMPATIBLE_VIDEO_PARAM)
+            {
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+                MFX_SAFE_CALL(ReturnPreSplitData(m_pH265VideoDecoder->GetPreSplitter(), bs));
+#endif
                 return sts;
+            }
 
             //return these errors immediatelly unless we have [input == 0]
             if (sts == MFX_ERR_DEVICE_FAILED || sts == MFX_ERR_GPU_HANG)
@@ -20,10 +20,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include "mfx_common.h"
 #include "mfx_common_int.h"
+#include "mfx_common_decode_int.h"
 
 #include "umc_defs.h"
 
@@ -42,9 +44,10 @@ class VideoDECODEMPEG2
 {
     // scheduler task info
     struct TaskInfo
+        : SharedDecodeTask
     {
-        mfxFrameSurface1 *surface_work;
-        mfxFrameSurface1 *surface_out;
+        mfxFrameSurface1 *surface_work = nullptr;
+        mfxFrameSurface1 *surface_out  = nullptr;
     };
 
 public:
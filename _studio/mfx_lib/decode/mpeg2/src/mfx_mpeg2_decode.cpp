@@ -32,6 +32,7 @@
 #include "umc_va_base.h"
 #include "umc_mpeg2_utils.h"
 #include "umc_mpeg2_decoder_va.h"
+#include "umc_mpeg2_decoder_sw.h"
 
 using UMC_MPEG2_DECODER::MPEG2DecoderFrame;
 
@@ -205,14 +206,26 @@ mfxStatus VideoDECODEMPEG2::Init(mfxVideoParam* par)
     m_video_par.CreateExtendedBuffer(MFX_EXTBUFF_VIDEO_SIGNAL_INFO);
     m_video_par.CreateExtendedBuffer(MFX_EXTBUFF_CODING_OPTION_SPSPPS);
 
-    MFX_CHECK(m_platform != MFX_PLATFORM_SOFTWARE, MFX_ERR_UNSUPPORTED);
+    if (MFX_PLATFORM_SOFTWARE == m_platform)
+    {
+#if defined (MFX_ENABLE_SW_FALLBACK)
+        MFX_CHECK(par->mfx.CodecProfile != UMC_MPEG2_DECODER::MFX_PROFILE_MPEG1, MFX_ERR_UNSUPPORTED);
 
+        m_decoder.reset(new UMC_MPEG2_DECODER::MPEG2DecoderSW());
+        m_allocator.reset(new mfx_UMC_FrameAllocator());
+#else
+        return MFX_ERR_UNSUPPORTED;
+#endif
+    }
+    else
+    {
 #if !defined (MFX_VA)
-    return MFX_ERR_UNSUPPORTED;
+        return MFX_ERR_UNSUPPORTED;
 #else
-    m_decoder.reset(new UMC_MPEG2_DECODER::MPEG2DecoderVA());
-    m_allocator.reset(new mfx_UMC_FrameAllocator_D3D());
+        m_decoder.reset(new UMC_MPEG2_DECODER::MPEG2DecoderVA());
+        m_allocator.reset(new mfx_UMC_FrameAllocator_D3D());
 #endif
+    }
 
     // Internal or expernal memory
     bool internal = (MFX_PLATFORM_SOFTWARE == m_platform) ?
@@ -284,10 +297,13 @@ mfxStatus VideoDECODEMPEG2::Init(mfxVideoParam* par)
     vp.async_depth = CalculateAsyncDepth(par);
 
 #if defined (MFX_VA)
-    mfxSts = m_core->CreateVA(par, &request, &m_response, m_allocator.get());
-    MFX_CHECK_STS(mfxSts);
+    if (MFX_PLATFORM_SOFTWARE != m_platform)
+    {
+        mfxSts = m_core->CreateVA(par, &request, &m_response, m_allocator.get());
+        MFX_CHECK_STS(mfxSts);
 
-    m_core->GetVA((mfxHDL*)&vp.pVideoAccelerator, MFX_MEMTYPE_FROM_DECODE);
+        m_core->GetVA((mfxHDL*)&vp.pVideoAccelerator, MFX_MEMTYPE_FROM_DECODE);
+    }
 #endif
 
     ConvertMFXParamsToUMC(par, &vp);
@@ -300,6 +316,8 @@ mfxStatus VideoDECODEMPEG2::Init(mfxVideoParam* par)
 
     m_decoder->SetVideoParams(m_first_video_par);
 
+    MFX_CHECK(m_platform == m_core->GetPlatformType(), MFX_WRN_PARTIAL_ACCELERATION);
+
     return isNeedChangeVideoParamWarning ? MFX_WRN_INCOMPATIBLE_VIDEO_PARAM : MFX_ERR_NONE;
 }
 
@@ -449,7 +467,7 @@ mfxStatus VideoDECODEMPEG2::QueryIOSurf(VideoCORE* core, mfxVideoParam* par, mfx
 
     eMFXPlatform platform = UMC_MPEG2_DECODER::GetPlatform_MPEG2(core, par);
 
-#if defined (MFX_VA_LINUX)
+#if defined (MFX_VA_LINUX) && !defined (MFX_ENABLE_SW_FALLBACK)
     if (platform != MFX_PLATFORM_HARDWARE)
         return MFX_ERR_UNSUPPORTED;
 #endif
@@ -702,7 +720,8 @@ mfxStatus VideoDECODEMPEG2::DecodeFrameCheck(mfxBitstream* bs, mfxFrameSurface1*
     entry_point->pRoutine = &DecodeRoutine;
     entry_point->pCompleteProc = &CompleteProc;
     entry_point->pState = this;
-    entry_point->requiredNumThreads = 1;
+    // the CPU decoder spreads slices over the scheduler threads
+    entry_point->requiredNumThreads = SharedDecodeTask::GetRequiredNumThreads(m_core, MFX_PLATFORM_SOFTWARE == m_platform);
     entry_point->pParam = task;
 
     return sts;
@@ -873,10 +892,14 @@ mfxStatus VideoDECODEMPEG2::QueryFrame(mfxThreadTask task)
 
     if (!frame->DecodingCompleted())
     {
-        m_decoder->QueryFrames(*frame);
+        bool const progress = m_decoder->QueryFrames(*frame);
+
+        // nothing to take right now, the rest of the frame is decoded by other threads
+        MFX_CHECK(frame->DecodingCompleted(), progress ? MFX_TASK_WORKING : MFX_TASK_BUSY);
     }
 
-    MFX_CHECK(frame->DecodingCompleted(), MFX_TASK_WORKING);
+    if (!info->ClaimOutput())
+        return MFX_TASK_DONE;
 
     mfxStatus sts = DecodeFrame(surface_out, frame);
     MFX_CHECK_STS(sts);
@@ -36,6 +36,8 @@
 #include "mfx_h264_encode_cm.h"
 #include "vm_time.h"
 #include "asc.h"
+#include "ehw_coded_buffer_ref.h"
+#include "ehw_stage_latency.h"
 
 #ifdef MXF_ENABLE_MCTF_IN_AVC
 #include "cmvm.h"
@@ -1267,6 +1269,7 @@ namespace MfxHwH264Encode
         std::vector<SliceStructInfo> m_SliceInfo;
 
         mfxU32 m_startTime;
+        MfxEncodeHW::StageTimes m_stageTimes;
 #ifdef MFX_ENABLE_MFE
         vm_tick m_beginTime;//where we start counting
         vm_tick m_endTime;//where we get bitstream
@@ -2975,6 +2978,7 @@ private:
         MfxVideoParam       m_video;
         MfxVideoParam       m_videoInit;  // m_video may change by Reset, m_videoInit doesn't change
         mfxEncodeStat       m_stat;
+        MfxEncodeHW::StageLatencyStat m_stageLatency;
 
         std::list<std::pair<mfxBitstream *, mfxU32> > m_listOfPairsForFieldOutputMode;
 
@@ -3039,6 +3043,9 @@ private:
         MfxFrameAllocResponse   m_rawSys;
         MfxFrameAllocResponse   m_rec;
         MfxFrameAllocResponse   m_bit;
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        MfxEncodeHW::CodedBufferRefs m_codedRefs;   // coded buffers lent to application, destroyed before m_bit
+#endif
         MfxFrameAllocResponse   m_opaqResponse;     // Response for opaq
         MfxFrameAllocResponse   m_histogram;
 
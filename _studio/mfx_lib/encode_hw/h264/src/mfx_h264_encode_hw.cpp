@@ -1095,6 +1095,17 @@ mfxStatus ImplementationAvc::Init(mfxVideoParam * par)
 
     m_NumSlices = m_video.mfx.FrameInfo.Height / 16;
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    // extra coded buffers for the ones held by application in zero-copy output mode,
+    // field pairs share one mfxBitstream and are always copied
+    mfxExtCodedBufferRef const & extCodedRef = GetExtBufferRef(m_video);
+    mfxU16 numHeldBs = IsFieldCodingPossible(m_video) ? 0
+        : std::min(extCodedRef.NumHeldBuffers, MfxEncodeHW::CodedBufferRefs::MAX_HELD);
+
+    m_codedRefs.Init(*m_core, numHeldBs);
+    request.NumFrameMin = mfxU16(request.NumFrameMin + numHeldBs);
+#endif
+
     sts = m_bit.Alloc(m_core, request, false);
     MFX_CHECK_STS(sts);
 
@@ -1447,6 +1458,12 @@ mfxStatus ImplementationAvc::ProcessAndCheckNewParameters(
                   MFX_ERR_INCOMPATIBLE_VIDEO_PARAM);
     }
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    // coded buffer pool isn't reallocated on Reset
+    mfxExtCodedBufferRef const & extCodedRefOld = GetExtBufferRef(m_video);
+    mfxExtCodedBufferRef const & extCodedRefNew = GetExtBufferRef(newPar);
+    MFX_CHECK(extCodedRefNew.NumHeldBuffers <= extCodedRefOld.NumHeldBuffers, MFX_ERR_INCOMPATIBLE_VIDEO_PARAM);
+#endif
 
     if (IsOn(extOpt2Old.ExtBRC))
     {
@@ -1587,7 +1604,14 @@ mfxStatus ImplementationAvc::Reset(mfxVideoParam *par)
         m_mb.Unlock();
         m_rawSys.Unlock();
         m_rec.Unlock();
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        // pool locks are dropped all together below, released buffers only need unmapping
+        m_codedRefs.Recycle([](mfxU32) {});
+#endif
         m_bit.Unlock();
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        m_codedRefs.Relock([this](mfxU32 idx) { m_bit.Lock(idx); });
+#endif
 
         m_recNonRef[0] = m_recNonRef[1] = 0xffffffff;
 
@@ -1675,6 +1699,14 @@ mfxStatus ImplementationAvc::GetVideoParam(mfxVideoParam *par)
         else
             buffers_offsets[par->ExtParam[i]->BufferId]++;
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        if (par->ExtParam[i]->BufferId == MFX_EXTBUFF_ENCODE_STAGE_LATENCY_STAT)
+        {
+            MFX_CHECK(par->ExtParam[i]->BufferSz >= sizeof(mfxExtEncodeStageLatencyStat), MFX_ERR_UNSUPPORTED);
+            m_stageLatency.Get(*(mfxExtEncodeStageLatencyStat*)par->ExtParam[i]);
+            continue;
+        }
+#endif
 
         if (mfxExtBuffer * buf = GetExtBuffer(m_video.ExtParam, m_video.NumExtParam, par->ExtParam[i]->BufferId, buffers_offsets[par->ExtParam[i]->BufferId]))
         {
@@ -1773,6 +1805,7 @@ void ImplementationAvc::OnNewFrame()
     m_stagesToGo &= ~AsyncRoutineEmulator::STG_BIT_ACCEPT_FRAME;
 
     UMC::AutomaticUMCMutex guard(m_listMutex);
+    m_incoming.front().m_stageTimes.Enter(MfxEncodeHW::StageTimes::REORDER);
     m_reordering.splice(m_reordering.end(), m_incoming, m_incoming.begin());
 }
 
@@ -1781,6 +1814,7 @@ void ImplementationAvc::SubmitScd()
     m_stagesToGo &= ~AsyncRoutineEmulator::STG_BIT_ACCEPT_FRAME;
 
     UMC::AutomaticUMCMutex guard(m_listMutex);
+    m_incoming.front().m_stageTimes.Enter(MfxEncodeHW::StageTimes::SCD);
     m_ScDetectionStarted.splice(m_ScDetectionStarted.end(), m_incoming, m_incoming.begin());
 }
 
@@ -1797,6 +1831,7 @@ void ImplementationAvc::OnScdFinished()
     m_stagesToGo &= ~AsyncRoutineEmulator::STG_BIT_WAIT_SCD;
 
     UMC::AutomaticUMCMutex guard(m_listMutex);
+    m_ScDetectionFinished.front().m_stageTimes.Enter(MfxEncodeHW::StageTimes::REORDER);
     m_reordering.splice(m_reordering.end(), m_ScDetectionFinished, m_ScDetectionFinished.begin());
 }
 
@@ -1805,6 +1840,7 @@ void ImplementationAvc::SubmitMCTF()
     m_stagesToGo &= ~AsyncRoutineEmulator::STG_BIT_WAIT_SCD;
 
     UMC::AutomaticUMCMutex guard(m_listMutex);
+    m_ScDetectionFinished.front().m_stageTimes.Enter(MfxEncodeHW::StageTimes::MCTF);
     m_MctfStarted.splice(m_MctfStarted.end(), m_ScDetectionFinished, m_ScDetectionFinished.begin());
 }
 
@@ -1821,6 +1857,7 @@ void ImplementationAvc::OnMctfFinished()
     m_stagesToGo &= ~AsyncRoutineEmulator::STG_BIT_WAIT_MCTF;
 
     UMC::AutomaticUMCMutex guard(m_listMutex);
+    m_MctfFinished.front().m_stageTimes.Enter(MfxEncodeHW::StageTimes::REORDER);
     m_reordering.splice(m_reordering.end(), m_MctfFinished, m_MctfFinished.begin());
 }
 
@@ -1830,6 +1867,7 @@ void ImplementationAvc::OnLookaheadSubmitted(DdiTaskIter task)
 
     if (m_inputFrameType == MFX_IOPATTERN_IN_SYSTEM_MEMORY)
         m_core->DecreaseReference(&task->m_yuv->Data);
+    task->m_stageTimes.Enter(MfxEncodeHW::StageTimes::LOOKAHEAD);
     m_lookaheadStarted.splice(m_lookaheadStarted.end(), m_reordering, task);
 }
 
@@ -1886,6 +1924,7 @@ void ImplementationAvc::OnLookaheadQueried()
     }
 
 
+    task.m_stageTimes.Enter(MfxEncodeHW::StageTimes::HISTOGRAM);
     m_histRun.splice(m_histRun.end(), m_lookaheadStarted, m_lookaheadStarted.begin());
 }
 
@@ -1931,6 +1970,7 @@ void ImplementationAvc::OnHistogramQueried()
         task.m_event = 0;
     }
 
+    task.m_stageTimes.Enter(MfxEncodeHW::StageTimes::READY);
     m_lookaheadFinished.splice(m_lookaheadFinished.end(), m_histWait, m_histWait.begin());
 }
 
@@ -1942,6 +1982,7 @@ void ImplementationAvc::OnEncodingSubmitted(DdiTaskIter task)
 
     MFX_TRACE_D(task->m_startTime);
 
+    task->m_stageTimes.Enter(MfxEncodeHW::StageTimes::ENCODE);
     m_encoding.splice(m_encoding.end(), m_lookaheadFinished, task);
 }
 
@@ -1995,6 +2036,10 @@ void ImplementationAvc::OnEncodingQueried(DdiTaskIter task)
         ReleaseResource(m_mbControl, task->m_midMBControl);
 
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    m_stageLatency.Report(task->m_stageTimes, MfxEncodeHW::StageTimes::Now(), task->m_bs);
+#endif
+
     mfxU32 numBits = 8 * (task->m_bsDataLength[0] + task->m_bsDataLength[1]);
     *task = DdiTask();
 
@@ -3316,6 +3361,10 @@ mfxStatus ImplementationAvc::AsyncRoutine(mfxBitstream * bs)
                 task->m_idxRecon = FindFreeResourceIndex(m_rec);
             }
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+            // take back coded buffers released by application
+            m_codedRefs.Recycle([this](mfxU32 idx) { m_bit.Unlock(idx); });
+#endif
             task->m_idxBs[0] = FindFreeResourceIndex(m_bit);
             task->m_midRec = AcquireResource(m_rec, task->m_idxRecon);
             task->m_midBit[0] = AcquireResource(m_bit, task->m_idxBs[0]);
@@ -3941,6 +3990,8 @@ mfxStatus ImplementationAvc::EncodeFrameCheckNormalWay(
         m_free.front().m_roi.Resize(MaxNumOfROI);
 
         m_stat.NumCachedFrame++;
+        m_free.front().m_stageTimes.Reset();
+        m_free.front().m_stageTimes.Enter(MfxEncodeHW::StageTimes::ACCEPT);
 #ifdef MFX_ENABLE_MFE
         mfxExtMultiFrameControl * mfeCtrl = GetExtBuffer(*ctrl);
         if (mfeCtrl && mfeCtrl->Timeout)// Use user timeout to wait for frames
@@ -4049,6 +4100,24 @@ mfxStatus ImplementationAvc::UpdateBitstream(
         || m_video.Protected != 0)
         doPatch = needIntermediateBitstreamBuffer = false;
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    // zero-copy output: application gets the coded buffer itself if nothing is to be patched
+    mfxExtCodedBufferRef * extCodedRef = m_codedRefs.IsEnabled()
+        ? (mfxExtCodedBufferRef*)GetExtBuffer(task.m_bs->ExtParam, task.m_bs->NumExtParam, MFX_EXTBUFF_CODED_BUFFER_REF)
+        : 0;
+    bool lendCodedBuffer = extCodedRef
+        && !doPatch
+        && m_video.Protected == 0
+        && task.m_fieldPicFlag == 0
+        && task.m_bs->DataLength == 0
+        && m_codedRefs.CanLend();
+
+    if (extCodedRef)
+        extCodedRef->Referenced = MFX_CODINGOPTION_OFF;
+#else
+    bool lendCodedBuffer = false;
+#endif
+
     // Lock d3d surface with compressed picture.
     MFX_LTRACE_S(MFX_TRACE_LEVEL_INTERNAL, task.m_FrameName);
 
@@ -4064,6 +4133,18 @@ mfxStatus ImplementationAvc::UpdateBitstream(
         MFX_LTRACE_S(MFX_TRACE_LEVEL_EXTCALL, "First 4 bytes of output bitstream don't contain Annex B NAL unit startcode - start_code_prefix_one_3bytes");
     }
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    if (lendCodedBuffer)
+    {
+        // task.m_bs now points to the mapped frame, the buffer stays locked until application releases it
+        mfxStatus sts = m_codedRefs.Lend(*task.m_bs, *extCodedRef, task.m_midBit[fid], task.m_idxBs[fid], bitstream, m_maxBsSize - skippedff);
+        MFX_CHECK_STS(sts);
+
+        lock.Detach();
+        m_bit.Lock(task.m_idxBs[fid]);
+    }
+#endif
+
     mfxU32   bsSizeActual  = task.m_bsDataLength[fid];
     mfxU32   bsSizeToCopy  = task.m_bsDataLength[fid];
     mfxU32   bsSizeAvail   = task.m_bs->MaxLength - task.m_bs->DataOffset - task.m_bs->DataLength;
@@ -4109,7 +4190,7 @@ mfxStatus ImplementationAvc::UpdateBitstream(
     }
 
     // Copy compressed picture from d3d surface to buffer in system memory
-    if (bsSizeToCopy)
+    if (bsSizeToCopy && !lendCodedBuffer)
     {
         FastCopyBufferVid2Sys(bsData, bitstream.Y, bsSizeToCopy);
     }
@@ -27,6 +27,7 @@
 #include <va/va_enc_hevc.h>
 
 #include "libmfx_core_vaapi.h"
+#include "mfx_va_caps_cache.h"
 #include "mfx_common_int.h"
 #include "mfx_h265_encode_vaapi.h"
 #include "mfx_h265_encode_hw_utils.h"
@@ -941,7 +942,7 @@ mfxStatus VAAPIEncoder::CreateAuxilliaryDevice(
 
     VAParameters vaParams = GetVaParams(guid);
 
-    VAStatus vaSts = vaGetConfigAttributes(m_vaDisplay,
+    VAStatus vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
                           vaParams.profile,
                           vaParams.entrypoint,
                           attrs.data(), attrs.size());
@@ -1089,7 +1090,7 @@ mfxStatus VAAPIEncoder::CreateAccelerationService(MfxVideoParam const & par)
 
     std::vector<VAProfile> profile_list(vaMaxNumProfiles(m_vaDisplay), VAProfileNone);
     mfxI32 num_profiles = 0;
-    VAStatus vaSts = vaQueryConfigProfiles(
+    VAStatus vaSts = MfxVaCaps::QueryConfigProfiles(
                 m_vaDisplay,
                 profile_list.data(),
                 &num_profiles);
@@ -1097,7 +1098,7 @@ mfxStatus VAAPIEncoder::CreateAccelerationService(MfxVideoParam const & par)
     MFX_CHECK_WITH_ASSERT(std::find(profile_list.begin(), profile_list.end(), vaParams.profile) != profile_list.end(),
         MFX_ERR_DEVICE_FAILED);
 
-    vaSts = vaQueryConfigEntrypoints(
+    vaSts = MfxVaCaps::QueryConfigEntrypoints(
                 m_vaDisplay,
                 vaParams.profile,
                 pEntrypoints.data(),
@@ -1117,7 +1118,7 @@ mfxStatus VAAPIEncoder::CreateAccelerationService(MfxVideoParam const & par)
     mfxStatus sts = ConfigureExtraVAattribs(attrib);
     MFX_CHECK_STS(sts);
 
-    vaSts = vaGetConfigAttributes(m_vaDisplay,
+    vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
                           vaParams.profile,
                           vaParams.entrypoint,
                           attrib.data(), (mfxI32)attrib.size());
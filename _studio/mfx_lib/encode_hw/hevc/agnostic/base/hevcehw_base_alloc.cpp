@@ -67,6 +67,7 @@ IAllocation* Allocator::MakeAlloc(std::unique_ptr<MfxEncodeHW::ResPool>&& upAllo
     WRAP_CC(SetFlag);
     WRAP_CC(GetFlag);
     WRAP_CC(UnlockAll);
+    WRAP_CC(Lock);
     WRAP_CC(Acquire);
 
     return pIAlloc.release();
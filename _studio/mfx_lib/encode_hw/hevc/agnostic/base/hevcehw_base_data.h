@@ -27,6 +27,7 @@
 #include "hevcehw_ddi.h"
 #include "ehw_resources_pool.h"
 #include "ehw_device.h"
+#include "ehw_stage_latency.h"
 #include <vector>
 
 namespace HEVCEHW
@@ -624,6 +625,9 @@ namespace Base
         using TUnlockAll = CallChain<void>;
         TUnlockAll UnlockAll;
 
+        using TLock = CallChain<mfxU32, mfxU32 /*idx*/>;
+        TLock Lock;
+
         std::unique_ptr<Storable> m_pthis;
     };
 
@@ -755,6 +759,11 @@ namespace Base
         , REC_READY = 2
     };
 
+    enum eBsFlag
+    {
+        BS_LENT = 1 // coded buffer is held by application, see mfxExtCodedBufferRef
+    };
+
     struct TaskCommonPar
         : DpbFrame
     {
@@ -787,6 +796,7 @@ namespace Base
         mfxU32              InsertHeaders       = 0;
         mfxU32              RepackHeaders       = 0;
         mfxU32              StatusReportId      = mfxU32(-1);
+        MfxEncodeHW::StageTimes Latency;
 
         mfxU32              initial_cpb_removal_delay   = 0;
         mfxU32              initial_cpb_removal_offset  = 0;
@@ -860,6 +870,8 @@ namespace Base
             return mfxSts;
         }
 
+        // keeps the frame locked, the caller becomes responsible for unlocking it
+        void Detach() { m_status = LOCK_NO; }
 
         mfxU32 Lock(bool external)
         {
@@ -294,6 +294,15 @@ void Legacy::SetSupported(ParamSupport& blocks)
         MFX_COPY_FIELD(NumQPAlloc);
         MFX_COPY_FIELD(QP);
     });
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    blocks.m_ebCopySupported[MFX_EXTBUFF_CODED_BUFFER_REF].emplace_back(
+        [](const mfxExtBuffer* pSrc, mfxExtBuffer* pDst) -> void
+    {
+        const auto& buf_src = *(const mfxExtCodedBufferRef*)pSrc;
+        auto& buf_dst = *(mfxExtCodedBufferRef*)pDst;
+        MFX_COPY_FIELD(NumHeldBuffers);
+    });
+#endif
 }
 
 void Legacy::SetInherited(ParamInheritance& par)
@@ -1202,6 +1211,19 @@ void Legacy::InitAlloc(const FeatureBlocks& /*blocks*/, TPushIA Push)
         auto& req = Tmp::BSAllocInfo::Get(local);
 
         SetDefault(req.NumFrameMin, GetMaxBS(par));
+
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        // extra coded buffers for the ones held by application in zero-copy output mode,
+        // field pairs may share one mfxBitstream and are always copied
+        const mfxExtCodedBufferRef* pCodedRef = ExtBuffer::Get(par);
+        mfxU16 numHeldBS = 0;
+
+        if (pCodedRef && !(par.mfx.FrameInfo.PicStruct & MFX_PICSTRUCT_FIELD_SINGLE))
+            numHeldBS = std::min(pCodedRef->NumHeldBuffers, MfxEncodeHW::CodedBufferRefs::MAX_HELD);
+
+        m_codedRefs.Init(Glob::VideoCore::Get(strg), numHeldBS);
+        req.NumFrameMin = mfxU16(req.NumFrameMin + numHeldBS);
+#endif
         SetDefault(req.Type
             , mfxU16(MFX_MEMTYPE_FROM_ENCODE
             | MFX_MEMTYPE_DXVA2_DECODER_TARGET
@@ -1368,6 +1390,15 @@ void Legacy::Reset(const FeatureBlocks& blocks, TPushR Push)
         MFX_CHECK(parOld.mfx.FrameInfo.ChromaFormat == parNew.mfx.FrameInfo.ChromaFormat,   MFX_ERR_INCOMPATIBLE_VIDEO_PARAM);
         MFX_CHECK(parOld.IOPattern                  == parNew.IOPattern,                    MFX_ERR_INCOMPATIBLE_VIDEO_PARAM);
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        // coded buffer pool isn't reallocated on Reset
+        const mfxExtCodedBufferRef* pCodedRef[2] = { ExtBuffer::Get(parOld), ExtBuffer::Get(parNew) };
+        MFX_CHECK(
+            !pCodedRef[1]
+            || pCodedRef[1]->NumHeldBuffers <= (pCodedRef[0] ? pCodedRef[0]->NumHeldBuffers : 0)
+            , MFX_ERR_INCOMPATIBLE_VIDEO_PARAM);
+#endif
+
         MFX_CHECK(local.Contains(Tmp::RecInfo::Key), MFX_ERR_UNDEFINED_BEHAVIOR);
         auto  recOld = Glob::AllocRec::Get(init).GetInfo();
         auto& recNew = Tmp::RecInfo::Get(local).Info;
@@ -1467,7 +1498,14 @@ void Legacy::ResetState(const FeatureBlocks& blocks, TPushRS Push)
         MFX_CHECK(hint.Flags & RF_IDR_REQUIRED, MFX_ERR_NONE);
 
         Glob::AllocRec::Get(real).UnlockAll();
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        // pool locks are dropped all together below, released buffers only need unmapping
+        m_codedRefs.Recycle([](mfxU32) {});
+#endif
         Glob::AllocBS::Get(real).UnlockAll();
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        m_codedRefs.Relock([&real](mfxU32 idx) { Glob::AllocBS::Get(real).Lock(idx); });
+#endif
 
         if (real.Contains(Glob::AllocMBQP::Key))
             Glob::AllocMBQP::Get(real).UnlockAll();
@@ -1556,8 +1594,10 @@ void Legacy::InitTask(const FeatureBlocks& /*blocks*/, TPushIT Push)
         auto& tpar = Task::Common::Get(task);
 
         auto stage = tpar.stage;
+        auto latency = tpar.Latency;
         tpar = TaskCommonPar();
         tpar.stage = stage;
+        tpar.Latency = latency;
         tpar.pBsOut = pBs;
 
         MFX_CHECK(pSurf, MFX_ERR_NONE);
@@ -1644,6 +1684,10 @@ void Legacy::PostReorderTask(const FeatureBlocks& /*blocks*/, TPushPostRT Push)
         }
 
         task.Rec = Glob::AllocRec::Get(global).Acquire();
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        // take back coded buffers released by application
+        m_codedRefs.Recycle([&global](mfxU32 idx) { Glob::AllocBS::Get(global).Release(idx); });
+#endif
         task.BS = Glob::AllocBS::Get(global).Acquire();
         MFX_CHECK(task.BS.Idx != IDX_INVALID, MFX_ERR_UNDEFINED_BEHAVIOR);
         MFX_CHECK(task.Rec.Idx != IDX_INVALID, MFX_ERR_UNDEFINED_BEHAVIOR);
@@ -1857,10 +1901,50 @@ void Legacy::SubmitTask(const FeatureBlocks& /*blocks*/, TPushST Push)
 void Legacy::QueryTask(const FeatureBlocks& /*blocks*/, TPushQT Push)
 {
     Push(BLK_CopyBS
-        , [](StorageW& global, StorageW& s_task) -> mfxStatus
+        , [this](StorageW& global, StorageW& s_task) -> mfxStatus
     {
         auto& task = Task::Common::Get(s_task);
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        mfxExtCodedBufferRef* pCodedRef = nullptr;
+
+        if (m_codedRefs.IsEnabled())
+            pCodedRef = ExtBuffer::Get(*task.pBsOut);
+
+        if (pCodedRef)
+            pCodedRef->Referenced = MFX_CODINGOPTION_OFF;
+
+        // zero-copy output: application gets the coded buffer itself,
+        // suffix SEI and padding are written right after the frame
+        if (   pCodedRef
+            && !task.pBsData
+            && task.BsDataLength
+            && task.pBsOut->DataLength == 0
+            && m_codedRefs.CanLend())
+        {
+            auto&  allocBS = Glob::AllocBS::Get(global);
+            auto   bsInfo  = allocBS.GetInfo();
+            mfxU32 bsSize  = bsInfo.Width * bsInfo.Height;
+
+            MFX_CHECK(bsSize >= task.BsDataLength, MFX_ERR_NOT_ENOUGH_BUFFER);
+
+            FrameLocker codedFrame(Glob::VideoCore::Get(global), task.BS.Mid);
+            MFX_CHECK(codedFrame.Y, MFX_ERR_LOCK_MEMORY);
+
+            auto sts = m_codedRefs.Lend(*task.pBsOut, *pCodedRef, task.BS.Mid, task.BS.Idx, codedFrame, bsSize);
+            MFX_CHECK_STS(sts);
+
+            codedFrame.Detach();
+            allocBS.SetFlag(task.BS.Idx, BS_LENT);
+
+            task.pBsData          = task.pBsOut->Data;
+            task.pBsDataLength    = &task.pBsOut->DataLength;
+            task.BsBytesAvailable = bsSize - task.BsDataLength;
+
+            return MFX_ERR_NONE;
+        }
+#endif
+
         if (!task.pBsData)
         {
             auto& bs              = *task.pBsOut;
@@ -1963,9 +2047,14 @@ void Legacy::FreeTask(const FeatureBlocks& /*blocks*/, TPushFT Push)
     {
         auto& task = Task::Common::Get(s_task);
         auto& core = Glob::VideoCore::Get(global);
+        auto& allocBS = Glob::AllocBS::Get(global);
+
+        // coded buffer lent to application goes back to the pool in m_codedRefs.Recycle()
+        if (task.BS.Idx != IDX_INVALID && (allocBS.GetFlag(task.BS.Idx) & BS_LENT))
+            task.BS = Resource();
 
         ThrowAssert(
-            !ReleaseResource(Glob::AllocBS::Get(global), task.BS)
+            !ReleaseResource(allocBS, task.BS)
             , "task.BS resource is invalid");
         ThrowAssert(
             global.Contains(Glob::AllocMBQP::Key)
@@ -2007,6 +2096,18 @@ void Legacy::FreeTask(const FeatureBlocks& /*blocks*/, TPushFT Push)
     });
 }
 
+void Legacy::Close(const FeatureBlocks& /*blocks*/, TPushCLS Push)
+{
+    Push(BLK_Close
+        , [this](StorageW& /*global*/)
+    {
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        // unmap coded buffers before the pool is freed
+        m_codedRefs.Close();
+#endif
+    });
+}
+
 void Legacy::GetVideoParam(const FeatureBlocks& blocks, TPushGVP Push)
 {
     Push(BLK_CopyConfigurable
@@ -26,6 +26,7 @@
 #include "hevcehw_base.h"
 #include "hevcehw_ddi.h"
 #include "hevcehw_base_data.h"
+#include "ehw_coded_buffer_ref.h"
 #include <tuple>
 
 namespace HEVCEHW
@@ -110,7 +111,8 @@ namespace Base
     DECL_BLOCK(DoPadding            )\
     DECL_BLOCK(UpdateBsInfo         )\
     DECL_BLOCK(SetRawInfo           )\
-    DECL_BLOCK(FreeTask             )
+    DECL_BLOCK(FreeTask             )\
+    DECL_BLOCK(Close                )
 #define DECL_FEATURE_NAME "Base_Legacy"
 #include "hevcehw_decl_blocks.h"
 
@@ -133,6 +135,9 @@ namespace Base
         std::unique_ptr<Defaults::Param> m_pQWCDefaults;
         NotNull<Defaults*> m_pQNCDefaults;
         eMFXHWType m_hw = MFX_HW_UNKNOWN;
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        MfxEncodeHW::CodedBufferRefs m_codedRefs;
+#endif
 
         void ResetState()
         {
@@ -164,6 +169,7 @@ namespace Base
         virtual void GetVideoParam(const FeatureBlocks& blocks, TPushGVP Push) override;
         virtual void Reset(const FeatureBlocks& blocks, TPushR Push) override;
         virtual void ResetState(const FeatureBlocks& blocks, TPushRS Push) override;
+        virtual void Close(const FeatureBlocks& blocks, TPushCLS Push) override;
 
         static void PushDefaults(Defaults& df);
 
@@ -114,6 +114,11 @@ void TaskManager::AddNumRecode(StorageW& task, mfxU16 n) const
     Task::Common::Get(task).NumRecode += n;
 }
 
+MfxEncodeHW::StageTimes& TaskManager::GetStageTimes(StorageW& task) const
+{
+    return Task::Common::Get(task).Latency;
+}
+
 mfxStatus TaskManager::RunQueueTaskAlloc(StorageRW& task)
 {
     return RunBlocks(
@@ -271,4 +276,21 @@ void TaskManager::Close(const FeatureBlocks& /*blocks*/, TPushCLS Push)
     });
 }
 
+void TaskManager::GetVideoParam(const FeatureBlocks& /*blocks*/, TPushGVP Push)
+{
+    Push(BLK_GetLatencyStat
+        , [this](mfxVideoParam& out, StorageR& /*global*/) -> mfxStatus
+    {
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        mfxExtEncodeStageLatencyStat* pStat = ExtBuffer::Get(out);
+        MFX_CHECK(pStat, MFX_ERR_NONE);
+
+        m_stageLatency.Get(*pStat);
+#else
+        std::ignore = out;
+#endif
+        return MFX_ERR_NONE;
+    });
+}
+
 #endif //defined(MFX_ENABLE_H265_VIDEO_ENCODE)
\ No newline at end of file
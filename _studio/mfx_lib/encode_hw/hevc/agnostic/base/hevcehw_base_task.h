@@ -45,7 +45,8 @@ namespace Base
     DECL_BLOCK(ReorderTask) \
     DECL_BLOCK(SubmitTask) \
     DECL_BLOCK(QueryTask) \
-    DECL_BLOCK(Close)
+    DECL_BLOCK(Close) \
+    DECL_BLOCK(GetLatencyStat)
 #define DECL_FEATURE_NAME "Base_TaskManager"
 #include "hevcehw_decl_blocks.h"
 
@@ -66,6 +67,7 @@ namespace Base
         virtual void FrameSubmit(const FeatureBlocks& blocks, TPushFS Push) override;
         virtual void AsyncRoutine(const FeatureBlocks& blocks, TPushAR Push) override;
         virtual void Close(const FeatureBlocks& blocks, TPushCLS Push) override;
+        virtual void GetVideoParam(const FeatureBlocks& blocks, TPushGVP Push) override;
 
         virtual mfxU32 GetNumTask() const override;
         virtual mfxU16 GetBufferSize() const override;
@@ -84,6 +86,7 @@ namespace Base
         virtual mfxU32 GetBsDataLength(const StorageR& task) const override;
         virtual void SetBsDataLength(StorageW& task, mfxU32 len) const override;
         virtual void AddNumRecode(StorageW& task, mfxU16 n) const override;
+        virtual MfxEncodeHW::StageTimes& GetStageTimes(StorageW& task) const override;
         virtual mfxStatus RunQueueTaskAlloc(StorageRW& task) override;
 
         virtual mfxStatus RunQueueTaskInit(
@@ -33,6 +33,7 @@
 #include "mfx_session.h"
 #include "mfx_mjpeg_encode_hw_utils.h"
 #include "libmfx_core_vaapi.h"
+#include "mfx_va_caps_cache.h"
 #include "fast_copy.h"
 
 using namespace MfxHwMJpegEncode;
@@ -86,7 +87,7 @@ mfxStatus VAAPIEncoder::CreateAuxilliaryDevice(
 
     std::vector<VAEntrypoint> pEntrypoints(numEntrypoints);
 
-    vaSts = vaQueryConfigEntrypoints(
+    vaSts = MfxVaCaps::QueryConfigEntrypoints(
                 m_vaDisplay,
                 VAProfileJPEGBaseline,
                 &pEntrypoints[0],
@@ -123,7 +124,7 @@ mfxStatus VAAPIEncoder::CreateAuxilliaryDevice(
     VAConfigAttrib attrib;
 
     attrib.type = VAConfigAttribEncJPEG;
-    vaSts = vaGetConfigAttributes(m_vaDisplay,
+    vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
                           VAProfileJPEGBaseline,
                           VAEntrypointEncPicture,
                           &attrib, 1);
@@ -136,7 +137,7 @@ mfxStatus VAAPIEncoder::CreateAuxilliaryDevice(
     m_caps.MaxNumQuantTable = encAttribVal.bits.max_num_quantization_tables;
 
     attrib.type = VAConfigAttribMaxPictureWidth;
-    vaSts = vaGetConfigAttributes(m_vaDisplay,
+    vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
                           VAProfileJPEGBaseline,
                           VAEntrypointEncPicture,
                           &attrib, 1);
@@ -144,7 +145,7 @@ mfxStatus VAAPIEncoder::CreateAuxilliaryDevice(
     m_caps.MaxPicWidth      = attrib.value;
 
     attrib.type = VAConfigAttribMaxPictureHeight;
-    vaSts = vaGetConfigAttributes(m_vaDisplay,
+    vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
                           VAProfileJPEGBaseline,
                           VAEntrypointEncPicture,
                           &attrib, 1);
@@ -152,7 +153,7 @@ mfxStatus VAAPIEncoder::CreateAuxilliaryDevice(
     m_caps.MaxPicHeight     = attrib.value;
 
     attrib.type = VAConfigAttribContextPriority;
-    vaSts = vaGetConfigAttributes(m_vaDisplay,
+    vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
                           VAProfileJPEGBaseline,
                           VAEntrypointEncPicture,
                           &attrib, 1);
@@ -176,7 +177,7 @@ mfxStatus VAAPIEncoder::CreateAccelerationService(mfxVideoParam const & par)
 
     MFX_CHECK_WITH_ASSERT(par.mfx.CodecProfile == MFX_PROFILE_JPEG_BASELINE, MFX_ERR_DEVICE_FAILED);
 
-    vaSts = vaQueryConfigEntrypoints(
+    vaSts = MfxVaCaps::QueryConfigEntrypoints(
                 m_vaDisplay,
                 VAProfileJPEGBaseline,
                 &pEntrypoints[0],
@@ -202,7 +203,7 @@ mfxStatus VAAPIEncoder::CreateAccelerationService(mfxVideoParam const & par)
 
     attrib.type = VAConfigAttribRTFormat;
 
-    vaSts = vaGetConfigAttributes(m_vaDisplay,
+    vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
                           VAProfileJPEGBaseline,
                           VAEntrypointEncPicture,
                           &attrib, 1);
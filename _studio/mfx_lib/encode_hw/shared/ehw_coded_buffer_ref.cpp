@@ -0,0 +1,120 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "ehw_coded_buffer_ref.h"
+#include "mfx_common_int.h"
+#include <algorithm>
+
+namespace MfxEncodeHW
+{
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+
+constexpr mfxU16 CodedBufferRefs::MAX_HELD;
+
+void CodedBufferRefs::Init(VideoCORE& core, mfxU16 numHeld)
+{
+    Close();
+
+    m_core    = &core;
+    m_maxHeld = std::min(numHeld, MAX_HELD);
+    m_held.reserve(m_maxHeld);
+}
+
+void CodedBufferRefs::Close()
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+
+    // buffers still held by the application are unmapped anyway,
+    // pools are freed by the owner right after
+    if (m_core)
+    {
+        for (auto& held : m_held)
+            m_core->UnlockFrame(held.Mid, &held.Mapped);
+    }
+
+    m_held.clear();
+    m_maxHeld = 0;
+}
+
+bool CodedBufferRefs::CanLend()
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+    return m_held.size() < m_maxHeld;
+}
+
+mfxStatus CodedBufferRefs::Lend(
+    mfxBitstream& bs
+    , mfxExtCodedBufferRef& ref
+    , mfxMemId mid
+    , mfxU32 idx
+    , const mfxFrameData& mapped
+    , mfxU32 capacity)
+{
+    MFX_CHECK(m_core && mapped.Y, MFX_ERR_UNDEFINED_BEHAVIOR);
+
+    std::unique_lock<std::mutex> lock(m_mtx);
+    MFX_CHECK(m_held.size() < m_maxHeld, MFX_ERR_UNDEFINED_BEHAVIOR);
+
+    m_held.push_back({ mapped.Y, mid, idx, mapped, false });
+
+    ref.SavedData      = bs.Data;
+    ref.SavedMaxLength = bs.MaxLength;
+    ref.Referenced     = MFX_CODINGOPTION_ON;
+    ref.pthis          = this;
+    ref.Release        = &CodedBufferRefs::Release;
+
+    bs.Data       = mapped.Y;
+    bs.DataOffset = 0;
+    bs.DataLength = 0;
+    bs.MaxLength  = capacity;
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus MFX_CDECL CodedBufferRefs::Release(mfxHDL pthis, mfxBitstream* bs)
+{
+    MFX_CHECK_NULL_PTR2(pthis, bs);
+
+    auto& self = *(CodedBufferRefs*)pthis;
+    auto  pRef = (mfxExtCodedBufferRef*)GetExtendedBuffer(bs->ExtParam, bs->NumExtParam, MFX_EXTBUFF_CODED_BUFFER_REF);
+    MFX_CHECK(pRef && pRef->Referenced == MFX_CODINGOPTION_ON, MFX_ERR_UNDEFINED_BEHAVIOR);
+
+    std::unique_lock<std::mutex> lock(self.m_mtx);
+
+    auto it = std::find_if(self.m_held.begin(), self.m_held.end()
+        , [bs](const Held& held) { return held.Data == bs->Data && !held.Returned; });
+    MFX_CHECK(it != self.m_held.end(), MFX_ERR_UNDEFINED_BEHAVIOR);
+
+    it->Returned = true;
+
+    bs->Data       = pRef->SavedData;
+    bs->MaxLength  = pRef->SavedMaxLength;
+    bs->DataOffset = 0;
+    bs->DataLength = 0;
+
+    pRef->SavedData      = nullptr;
+    pRef->SavedMaxLength = 0;
+    pRef->Referenced     = MFX_CODINGOPTION_OFF;
+
+    return MFX_ERR_NONE;
+}
+
+#endif
+} //namespace MfxEncodeHW
@@ -0,0 +1,110 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "libmfx_core_interface.h"
+#include <mutex>
+#include <vector>
+
+namespace MfxEncodeHW
+{
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+// Coded buffers lent to the application through mfxExtCodedBufferRef.
+// A lent buffer stays mapped and its pool entry stays locked until the application
+// calls mfxExtCodedBufferRef::Release(). Release() may come from any thread, so it only
+// marks the buffer as returned; the encoder unmaps it and unlocks the pool entry in
+// Recycle() from its own task routine.
+class CodedBufferRefs
+{
+public:
+    static constexpr mfxU16 MAX_HELD = 64;
+
+    CodedBufferRefs() = default;
+    ~CodedBufferRefs() { Close(); }
+
+    void      Init(VideoCORE& core, mfxU16 numHeld);
+    void      Close();
+
+    bool      IsEnabled() const { return m_maxHeld != 0; }
+    bool      CanLend();
+
+    // 'mapped' is the locked coded buffer pointing to the frame, the lock is taken over
+    // and bs is switched to it with capacity bytes available
+    mfxStatus Lend(
+        mfxBitstream& bs
+        , mfxExtCodedBufferRef& ref
+        , mfxMemId mid
+        , mfxU32 idx
+        , const mfxFrameData& mapped
+        , mfxU32 capacity);
+
+    template<class TUnlock>
+    void Recycle(TUnlock&& unlock)
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+
+        for (auto it = m_held.begin(); it != m_held.end();)
+        {
+            if (!it->Returned)
+            {
+                ++it;
+                continue;
+            }
+
+            m_core->UnlockFrame(it->Mid, &it->Mapped);
+            unlock(it->Idx);
+            it = m_held.erase(it);
+        }
+    }
+
+    // Reset unlocks the whole pool, buffers not recycled yet are locked again
+    // so the encoder doesn't write to them and Recycle() has a lock to drop
+    template<class TLock>
+    void Relock(TLock&& relock)
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+
+        for (auto& held : m_held)
+            relock(held.Idx);
+    }
+
+protected:
+    CodedBufferRefs(CodedBufferRefs const &) = delete;
+    CodedBufferRefs & operator =(CodedBufferRefs const &) = delete;
+
+    static mfxStatus MFX_CDECL Release(mfxHDL pthis, mfxBitstream* bs);
+
+    struct Held
+    {
+        mfxU8*       Data;
+        mfxMemId     Mid;
+        mfxU32       Idx;
+        mfxFrameData Mapped;
+        bool         Returned;
+    };
+
+    VideoCORE*        m_core    = nullptr;
+    mfxU16            m_maxHeld = 0;
+    std::mutex        m_mtx;
+    std::vector<Held> m_held;
+};
+#endif
+
+} //namespace MfxEncodeHW
@@ -24,6 +24,7 @@
 #if defined(MFX_VA_LINUX)
 #include "ehw_device.h"
 #include "va/va.h"
+#include "mfx_va_caps_cache.h"
 #include <vector>
 #include <tuple>
 #include <functional>
@@ -180,9 +181,9 @@ protected:
         , {VAFID_DestroyConfig,           CallDefault(&vaDestroyConfig)}
         , {VAFID_CreateContext,           CallDefault(&vaCreateContext)}
         , {VAFID_DestroyContext,          CallDefault(&vaDestroyContext)}
-        , {VAFID_GetConfigAttributes,     CallDefault(&vaGetConfigAttributes)}
-        , {VAFID_QueryConfigEntrypoints,  CallDefault(&vaQueryConfigEntrypoints)}
-        , {VAFID_QueryConfigProfiles,     CallDefault(&vaQueryConfigProfiles)}
+        , {VAFID_GetConfigAttributes,     CallDefault(&MfxVaCaps::GetConfigAttributes)}
+        , {VAFID_QueryConfigEntrypoints,  CallDefault(&MfxVaCaps::QueryConfigEntrypoints)}
+        , {VAFID_QueryConfigProfiles,     CallDefault(&MfxVaCaps::QueryConfigProfiles)}
         , {VAFID_CreateBuffer,            CallDefault(&vaCreateBuffer)}
         , {VAFID_MapBuffer,               CallDefault(&vaMapBuffer)}
         , {VAFID_UnmapBuffer,             CallDefault(&vaUnmapBuffer)}
@@ -0,0 +1,122 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "ehw_stage_latency.h"
+#include "mfx_common_int.h"
+#include <algorithm>
+#include <chrono>
+
+namespace MfxEncodeHW
+{
+
+constexpr mfxU16 StageTimes::ACCEPT;
+constexpr mfxU16 StageTimes::SCD;
+constexpr mfxU16 StageTimes::MCTF;
+constexpr mfxU16 StageTimes::REORDER;
+constexpr mfxU16 StageTimes::LOOKAHEAD;
+constexpr mfxU16 StageTimes::HISTOGRAM;
+constexpr mfxU16 StageTimes::READY;
+constexpr mfxU16 StageTimes::ENCODE;
+constexpr mfxU16 StageTimes::NUM_STAGES;
+constexpr mfxU16 StageLatencyStat::NUM_BINS;
+
+mfxU64 StageTimes::Now()
+{
+    using namespace std::chrono;
+    return mfxU64(duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+void StageLatencyStat::Reset()
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+
+    m_numFrame = 0;
+    std::fill_n(m_total, StageTimes::NUM_STAGES, 0);
+    std::fill_n(&m_hist[0][0], StageTimes::NUM_STAGES * NUM_BINS, 0);
+}
+
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+static_assert(StageTimes::ACCEPT     == MFX_ENCODE_STAGE_ACCEPT
+    && StageTimes::SCD               == MFX_ENCODE_STAGE_SCD
+    && StageTimes::MCTF              == MFX_ENCODE_STAGE_MCTF
+    && StageTimes::REORDER           == MFX_ENCODE_STAGE_REORDER
+    && StageTimes::LOOKAHEAD         == MFX_ENCODE_STAGE_LOOKAHEAD
+    && StageTimes::HISTOGRAM         == MFX_ENCODE_STAGE_HISTOGRAM
+    && StageTimes::READY             == MFX_ENCODE_STAGE_READY
+    && StageTimes::ENCODE            == MFX_ENCODE_STAGE_ENCODE
+    && StageTimes::NUM_STAGES        == MFX_ENCODE_STAGE_NUM
+    , "StageTimes ids must match MFX_ENCODE_STAGE_*");
+
+void StageLatencyStat::Report(const StageTimes& times, mfxU64 done, mfxBitstream* pBs)
+{
+    mfxU32 latency[StageTimes::NUM_STAGES] = {};
+    mfxU64 end = done;
+
+    // stages are entered in increasing order, a stage lasts until the next entered one
+    for (mfxI32 s = StageTimes::NUM_STAGES - 1; s >= 0; --s)
+    {
+        if (!times.Time[s])
+            continue;
+
+        latency[s] = mfxU32(std::min<mfxU64>(end - std::min(end, times.Time[s]), mfxU32(-1)));
+        end = times.Time[s];
+    }
+
+    auto pExt = pBs
+        ? (mfxExtEncodeStageLatency*)GetExtendedBuffer(pBs->ExtParam, pBs->NumExtParam, MFX_EXTBUFF_ENCODE_STAGE_LATENCY)
+        : nullptr;
+
+    if (pExt)
+    {
+        std::copy_n(times.Time, StageTimes::NUM_STAGES, pExt->EnterTime);
+        std::copy_n(latency, StageTimes::NUM_STAGES, pExt->Latency);
+        pExt->DoneTime = done;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mtx);
+
+    ++m_numFrame;
+
+    for (mfxU32 s = 0; s < StageTimes::NUM_STAGES; ++s)
+    {
+        if (!times.Time[s])
+            continue;
+
+        mfxU32 bin = 0;
+        for (mfxU32 us = latency[s]; us > 1 && bin < NUM_BINS - 1; us >>= 1)
+            ++bin;
+
+        m_total[s] += latency[s];
+        ++m_hist[s][bin];
+    }
+}
+
+void StageLatencyStat::Get(mfxExtEncodeStageLatencyStat& stat)
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+
+    stat.NumFrame = m_numFrame;
+    std::copy_n(m_total, StageTimes::NUM_STAGES, stat.TotalLatency);
+
+    for (mfxU32 s = 0; s < StageTimes::NUM_STAGES; ++s)
+        std::copy_n(m_hist[s], NUM_BINS, stat.Histogram[s]);
+}
+#endif
+
+} //namespace MfxEncodeHW
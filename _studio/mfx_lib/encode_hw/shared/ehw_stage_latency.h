@@ -0,0 +1,77 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+#include "mfx_common.h"
+#include <mutex>
+
+namespace MfxEncodeHW
+{
+// Time stamps of encode stage transitions of one task, in microseconds of a
+// monotonic clock. Stage ids match MFX_ENCODE_STAGE_*; a stage not entered keeps 0.
+class StageTimes
+{
+public:
+    static constexpr mfxU16 ACCEPT     = 0;
+    static constexpr mfxU16 SCD        = 1;
+    static constexpr mfxU16 MCTF       = 2;
+    static constexpr mfxU16 REORDER    = 3;
+    static constexpr mfxU16 LOOKAHEAD  = 4;
+    static constexpr mfxU16 HISTOGRAM  = 5;
+    static constexpr mfxU16 READY      = 6;
+    static constexpr mfxU16 ENCODE     = 7;
+    static constexpr mfxU16 NUM_STAGES = 8;
+
+    static mfxU64 Now();
+
+    void Reset() { *this = StageTimes(); }
+    void Enter(mfxU16 stage) { Enter(stage, Now()); }
+    void Enter(mfxU16 stage, mfxU64 time)
+    {
+        if (stage < NUM_STAGES)
+            Time[stage] = time;
+    }
+
+    mfxU64 Time[NUM_STAGES] = {};
+};
+
+// Per-session latency statistics. Report() is called once per output frame from the
+// encoder task routine, Get() may come from the application thread at any time.
+class StageLatencyStat
+{
+public:
+    static constexpr mfxU16 NUM_BINS = 24;
+
+    void Reset();
+
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    // closes the last entered stage at 'done', accumulates per stage latencies and
+    // reports them to mfxExtEncodeStageLatency attached to pBs if any
+    void Report(const StageTimes& times, mfxU64 done, mfxBitstream* pBs);
+    void Get(mfxExtEncodeStageLatencyStat& stat);
+#endif
+
+protected:
+    std::mutex m_mtx;
+    mfxU32     m_numFrame                                  = 0;
+    mfxU64     m_total[StageTimes::NUM_STAGES]             = {};
+    mfxU32     m_hist[StageTimes::NUM_STAGES][NUM_BINS]    = {};
+};
+
+} //namespace MfxEncodeHW
@@ -39,6 +39,8 @@ mfxStatus TaskManager::ManagerInit()
     m_maxParallelSubmits = GetMaxParallelSubmits();
     m_nTasksInExecution  = 0;
 
+    m_stageLatency.Reset();
+
     return sts;
 }
 
@@ -198,6 +200,10 @@ mfxStatus TaskManager::TaskQuery(StorageW& inTask)
 
     ThrowIf(pPrevRecode, std::logic_error("For recode must exit by \"no task for query\" condition"));
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    m_stageLatency.Report(GetStageTimes(*pTask), StageTimes::Now(), pBs);
+#endif
+
     auto sts = RunQueueTaskFree(*pTask);
     MFX_CHECK_STS(sts);
 
@@ -287,6 +293,14 @@ StorageRW* TaskManager::MoveTask(
             stage &= ~(0xffffffff << to);
 
             SetStage(*pTask, stage);
+
+            auto  latencyStage = LatencyStage(to);
+            auto& times        = GetStageTimes(*pTask);
+
+            if (latencyStage == StageTimes::ACCEPT)
+                times.Reset();
+
+            times.Enter(latencyStage);
         }
     }
 
@@ -296,6 +310,28 @@ StorageRW* TaskManager::MoveTask(
     return pTask;
 }
 
+mfxU16 TaskManager::LatencyStage(mfxU16 to) const
+{
+    static const std::map<mfxU16, mfxU16> latencyStage =
+    {
+          {S_PREPARE, StageTimes::ACCEPT}
+        , {S_REORDER, StageTimes::REORDER}
+        , {S_SUBMIT,  StageTimes::READY}
+        , {S_QUERY,   StageTimes::ENCODE}
+    };
+
+    auto itId = std::find_if(m_stageID.begin(), m_stageID.end()
+        , [to](const std::pair<const mfxU16, mfxU16>& id) { return id.second == to; });
+    if (itId == m_stageID.end())
+        return StageTimes::NUM_STAGES;
+
+    auto itStage = latencyStage.find(itId->first);
+    if (itStage == latencyStage.end())
+        return StageTimes::NUM_STAGES;
+
+    return itStage->second;
+}
+
 StorageRW* TaskManager::GetTask(mfxU16 stage, TFnGetTask which)
 {
     ThrowIf(stage >= m_stages.size(), std::out_of_range("Invalid task stage id"));
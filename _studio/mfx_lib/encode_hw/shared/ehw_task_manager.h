@@ -23,6 +23,7 @@
 #include <condition_variable>
 #include <vector>
 #include "feature_blocks/mfx_feature_blocks_utils.h"
+#include "ehw_stage_latency.h"
 
 namespace MfxEncodeHW
 {
@@ -54,6 +55,7 @@ namespace MfxEncodeHW
         virtual mfxU32        GetBsDataLength      (const StorageR& /*task*/) const = 0;
         virtual void          SetBsDataLength      (StorageW& /*task*/, mfxU32) const = 0;
         virtual void          AddNumRecode         (StorageW& /*task*/, mfxU16) const = 0;
+        virtual StageTimes&   GetStageTimes        (StorageW& /*task*/) const = 0;
 
         virtual mfxStatus RunQueueTaskAlloc(StorageRW& /*task*/) = 0;
         virtual mfxStatus RunQueueTaskInit(
@@ -104,6 +106,7 @@ namespace MfxEncodeHW
         mfxU16                  m_nRecodeTasks       = 0;
         std::mutex              m_mtx, m_closeMtx;
         std::condition_variable m_cv;
+        StageLatencyStat        m_stageLatency;
 
         static TTaskIt    FirstTask     (TTaskIt begin, TTaskIt) { return begin; }
         static TTaskIt    EndTask       (TTaskIt, TTaskIt end) { return end; }
@@ -118,6 +121,8 @@ namespace MfxEncodeHW
             return SimpleCheck([pTask](StorageR& b) { return &b == pTask; });
         }
         mfxU16 Stage(mfxU16 s) { return m_stageID.at(s); }
+        // encode stage (StageTimes id) a task enters when moved to queue 'to'
+        mfxU16 LatencyStage(mfxU16 to) const;
 
         //blocking
         mfxStatus ManagerReset(mfxU32 numTask);
@@ -25,6 +25,7 @@
 #include "mfx_common_int.h"
 #include <map>
 #include "mfx_session.h"
+#include "mfx_va_caps_cache.h"
 
 namespace MfxHwVP9Encode
 {
@@ -703,7 +704,7 @@ mfxStatus VAAPIEncoder::CreateAuxilliaryDevice(
         return MFX_ERR_UNSUPPORTED;
     }
 
-    VAStatus vaSts = vaGetConfigAttributes(m_vaDisplay,
+    VAStatus vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
                           vaapipr,
                           VAEntrypointEncSliceLP,
                           attrs.data(),
@@ -801,7 +802,7 @@ mfxStatus VAAPIEncoder::CreateAccelerationService(VP9MfxVideoParam const & par)
 
     std::vector<VAEntrypoint> pEntrypoints(numEntrypoints);
 
-    vaSts = vaQueryConfigEntrypoints(
+    vaSts = MfxVaCaps::QueryConfigEntrypoints(
                 m_vaDisplay,
                 va_profile,
                 pEntrypoints.data(),
@@ -827,7 +828,7 @@ mfxStatus VAAPIEncoder::CreateAccelerationService(VP9MfxVideoParam const & par)
 
     attrib[0].type = VAConfigAttribRTFormat;
     attrib[1].type = VAConfigAttribRateControl;
-    vaSts = vaGetConfigAttributes(m_vaDisplay,
+    vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
                           va_profile,
                           VAEntrypointEncSliceLP,
                           &attrib[0], 2);
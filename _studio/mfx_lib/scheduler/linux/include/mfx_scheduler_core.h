@@ -213,6 +213,12 @@ public:
     // WA for SINGLE THREAD MODE
     virtual
     mfxStatus GetTimeout(mfxU32 & maxTimeToRun);
+
+    // Wait until any task completes, used to block on MFX_WRN_DEVICE_BUSY
+    virtual
+    mfxStatus WaitForTaskCompletion(mfxU64 & completedTasks, mfxU32 timeToWait);
+    virtual
+    mfxU32 GetBusyWaitTimeout();
 protected:
     // Destructor is protected to avoid deletion the object by occasion.
     virtual
@@ -386,6 +392,9 @@ protected:
     // Condition variable to wait free task objects
     mfxU16 m_freeTasksCount;
     std::condition_variable m_freeTasks;
+    // Number of completed (done or failed) tasks and condition variable to wait for it to change
+    mfxU64 m_completedTasksCount;
+    std::condition_variable m_taskCompleted;
     // Handle to the wakeup thread
     std::thread m_hwWakeUpThread;
 
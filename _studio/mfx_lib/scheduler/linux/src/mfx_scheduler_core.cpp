@@ -34,6 +34,7 @@ mfxSchedulerCore::mfxSchedulerCore(void)
     // since on Linux we have blocking synchronization which means an absence of polling,
     // there is no need to use 'waiting' time period.
     , m_timeWaitPeriod(0)
+    , m_completedTasksCount(0)
     , m_hwWakeUpThread()
     , m_DedicatedThreadsToWakeUp(0)
     , m_RegularThreadsToWakeUp(0)
@@ -278,6 +278,38 @@ mfxStatus mfxSchedulerCore::GetTimeout(mfxU32& maxTimeToRun)
     return MFX_ERR_UNSUPPORTED;
 }
 
+mfxStatus mfxSchedulerCore::WaitForTaskCompletion(mfxU64 & completedTasks, mfxU32 timeToWait)
+{
+    // check error(s)
+    if (0 == m_param.numberOfThreads)
+    {
+        return MFX_ERR_NOT_INITIALIZED;
+    }
+    // nobody runs tasks while the caller waits
+    if (MFX_SINGLE_THREAD == m_param.flags)
+    {
+        return MFX_ERR_UNSUPPORTED;
+    }
+
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_PRIVATE, "Scheduler::WaitForTaskCompletion");
+
+    std::unique_lock<std::mutex> guard(m_guard);
+
+    m_taskCompleted.wait_for(guard, std::chrono::milliseconds(timeToWait), [this, completedTasks] {
+        return m_completedTasksCount != completedTasks;
+    });
+
+    bool const completed = (m_completedTasksCount != completedTasks);
+    completedTasks = m_completedTasksCount;
+
+    return completed ? MFX_ERR_NONE : MFX_WRN_IN_EXECUTION;
+}
+
+mfxU32 mfxSchedulerCore::GetBusyWaitTimeout()
+{
+    return m_param.busyWaitTimeout;
+}
+
 mfxStatus mfxSchedulerCore::WaitForDependencyResolved(const void *pDependency)
 {
     mfxTaskHandle waitHandle = {};
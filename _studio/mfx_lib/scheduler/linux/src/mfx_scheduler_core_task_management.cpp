@@ -414,6 +414,7 @@ void mfxSchedulerCore::MarkTaskCompleted(const MFX_CALL_INFO *pCallInfo,
     }
 
     bool taskReleased = false;
+    bool taskCompleted = false;
     mfxU32 nTraceTaskId = 0;
     mfxU32 curTime;
 
@@ -549,6 +550,8 @@ void mfxSchedulerCore::MarkTaskCompleted(const MFX_CALL_INFO *pCallInfo,
             pTask->ResolveDependencies(pTask->curStatus);
             // release all allocated resources
             pTask->ReleaseResources();
+
+            taskCompleted = true;
         }
         // process task completed
         else if (MFX_TASK_DONE == pTask->curStatus)
@@ -581,6 +584,7 @@ void mfxSchedulerCore::MarkTaskCompleted(const MFX_CALL_INFO *pCallInfo,
 
             // task object becomes free
             taskReleased = true;
+            taskCompleted = true;
         }
     }
 
@@ -597,6 +601,13 @@ void mfxSchedulerCore::MarkTaskCompleted(const MFX_CALL_INFO *pCallInfo,
         m_freeTasks.notify_one();
     }
 
+    // wake up external threads waiting for the component to free its resources
+    if (taskCompleted)
+    {
+        ++m_completedTasksCount;
+        m_taskCompleted.notify_all();
+    }
+
     // send tracing event
     if (nTraceTaskId)
     {
@@ -21,11 +21,17 @@
 #ifndef __MFX_COMMON_DECODE_INT_H__
 #define __MFX_COMMON_DECODE_INT_H__
 
+#include <atomic>
 #include <vector>
 #include "mfx_common.h"
 #include "mfx_common_int.h"
 #include "umc_video_decoder.h"
 
+namespace UMC
+{
+    class NalUnitSplitterThread;
+}
+
 class MFXMediaDataAdapter : public UMC::MediaData
 {
 public:
@@ -35,6 +41,68 @@ public:
     void Save(mfxBitstream *pBitstream);
 
     void SetExtBuffer(mfxExtBuffer*);
+
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    // Switches to the next fragment of a scattered bitstream when the current one is fully consumed
+    bool NextFragment();
+
+protected:
+    void LoadFragment(mfxU32 offset);
+
+    mfxExtBitstreamFragments* m_fragments;
+    mfxU32                    m_fragment;      // current fragment index
+    mfxU32                    m_fragmentBase;  // offset of current fragment in concatenated stream
+    mfxU32                    m_released;      // fragments [0, m_released) are given back to application
+    mfxU16                    m_dataFlag;
+#endif
+};
+
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+// Validates bitstream which may carry mfxExtBitstreamFragments instead of contiguous Data
+mfxStatus CheckFragmentedBitstream(const mfxBitstream *bs);
+
+// Header parsing works on one contiguous buffer. For a scattered bitstream the fragments
+// from DataOffset on are gathered into a temporary one, the position reached there is
+// written back to the original bitstream on destruction. Other bitstreams are used as is.
+class MFXGatheredBitstream
+{
+public:
+    MFXGatheredBitstream(mfxBitstream *bs);
+    ~MFXGatheredBitstream();
+
+    mfxBitstream* Get() { return m_target; }
+
+private:
+    mfxBitstream*      m_original;
+    mfxBitstream*      m_target;
+    mfxBitstream       m_gathered;
+    std::vector<mfxU8> m_buffer;
+    mfxU32             m_base;     // offset of m_buffer in concatenated stream
+
+    MFXGatheredBitstream(const MFXGatheredBitstream&) = delete;
+    MFXGatheredBitstream& operator=(const MFXGatheredBitstream&) = delete;
+};
+
+// Returns size of the input queued for splitting on a parse thread requested by mfxExtDecodePreSplit, 0 if it is off
+size_t GetPreSplitSize(mfxVideoParam const* par);
+// Puts the input queued for splitting back to the bitstream when the decoder has to be reinitialized
+mfxStatus ReturnPreSplitData(UMC::NalUnitSplitterThread* splitter, mfxBitstream *bs);
+#endif
+
+// Scheduler task of a decoder which lets several threads work on one frame
+// (slices decoded on the CPU, film grain added in stripes). Any of them may
+// see the frame completed, only one outputs it.
+struct SharedDecodeTask
+{
+    // Threads for the entry point: all threads of the session scheduler when
+    // the frame is shared between them, one otherwise
+    static mfxU32 GetRequiredNumThreads(VideoCORE* core, bool shared);
+
+    // True for the first thread only, that one outputs the frame
+    bool ClaimOutput()
+    { return !outputted.exchange(true); }
+
+    std::atomic<bool> outputted{false};
 };
 
 mfxStatus ConvertUMCStatusToMfx(UMC::Status status);
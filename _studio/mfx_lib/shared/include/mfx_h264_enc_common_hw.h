@@ -219,6 +219,9 @@ namespace MfxHwH264Encode
 #if defined (__MFXBRC_H__)
     BIND_EXTBUF_TYPE_TO_ID (mfxExtBRC,        MFX_EXTBUFF_BRC          );
 #endif
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    BIND_EXTBUF_TYPE_TO_ID (mfxExtCodedBufferRef,       MFX_EXTBUFF_CODED_BUFFER_REF         );
+#endif
 
 #ifdef MFX_ENABLE_MFE
     BIND_EXTBUF_TYPE_TO_ID (mfxExtMultiFrameControl,     MFX_EXTBUFF_MULTI_FRAME_CONTROL     );
@@ -606,6 +609,9 @@ namespace MfxHwH264Encode
 #if defined(__MFXBRC_H__)
         mfxExtBRC                   m_extBRC;
 #endif
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        mfxExtCodedBufferRef        m_extCodedRef;
+#endif
 #if defined(MFX_ENABLE_ENCTOOLS)
         mfxEncTools                     m_encTools;
         mfxExtEncToolsConfig            m_encToolsConfig;
@@ -1085,6 +1091,8 @@ namespace MfxHwH264Encode
             return mfxSts;
         }
 
+        // keeps the frame locked, the caller becomes responsible for unlocking it
+        void Detach() { m_status = LOCK_NO; }
 
         enum { LOCK_NO, LOCK_INT, LOCK_EXT };
 
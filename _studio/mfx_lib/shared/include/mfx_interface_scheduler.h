@@ -127,6 +127,8 @@ struct MFX_SCHEDULER_PARAM2: public MFX_SCHEDULER_PARAM
 {
     // user-adjustable extended parameters
     mfxExtThreadsParam params;
+    // time to wait for a task completion before returning MFX_WRN_DEVICE_BUSY, 0 - no waiting
+    mfxU32 busyWaitTimeout;
 };
 
 class MFXIScheduler2 : public MFXIScheduler
@@ -140,6 +142,15 @@ public:
 
     virtual
     mfxStatus GetTimeout(mfxU32 & maxTimeToRun) = 0;
+
+    // Wait until the number of completed tasks differs from 'completedTasks' or the time runs out.
+    // 'completedTasks' is updated with the current number, zero 'timeToWait' only gets it.
+    virtual
+    mfxStatus WaitForTaskCompletion(mfxU64 & completedTasks, mfxU32 timeToWait) = 0;
+
+    // Get the busy wait timeout the scheduler was initialized with.
+    virtual
+    mfxU32 GetBusyWaitTimeout() = 0;
 };
 
 #endif // __MFX_INTERFACE_SCHEDULER_H
@@ -22,6 +22,7 @@
 #define _MFX_SESSION_H
 
 #include <memory>
+#include <chrono>
 
 // base mfx headers
 #include <mfxdefs.h>
@@ -182,6 +183,23 @@ private:
   static_assert(sizeof(_mfxSession) == 244, "size_of_session_is_fixed");
 #endif
 
+// Makes an async call wait for a task of the session's scheduler to complete and repeat,
+// instead of returning MFX_WRN_DEVICE_BUSY to the application. Enabled by mfxExtDeviceBusyWait.
+class DeviceBusyWait
+{
+public:
+    // Create before the first attempt, so tasks completed meanwhile are not missed
+    DeviceBusyWait(_mfxSession* session);
+
+    // Returns false if the call shouldn't be repeated: the mode is off or the time ran out
+    bool Wait();
+
+private:
+    MFXIScheduler2* m_pScheduler;
+    mfxU64          m_completedTasks;
+    std::chrono::steady_clock::time_point m_deadline;
+};
+
 
 // {90567606-C57A-447F-8941-1F14597DA475}
 static const
@@ -522,17 +522,21 @@ mfxStatus MFXVideoDECODE_DecodeFrameAsync(mfxSession session, mfxBitstream *bs,
     {
         mfxSyncPoint syncPoint = NULL;
         MFX_TASK task;
+        DeviceBusyWait busyWait(session);
 
         // Wait for the bit stream
         mfxRes = session->m_pScheduler->WaitForDependencyResolved(bs);
         MFX_CHECK_STS(mfxRes);
 
-        // reset the sync point
-        *syncp = NULL;
-        *surface_out = NULL;
+        do
+        {
+            // reset the sync point
+            *syncp = NULL;
+            *surface_out = NULL;
 
-        memset(&task, 0, sizeof(MFX_TASK));
-        mfxRes = session->m_pDECODE->DecodeFrameCheck(bs, surface_work, surface_out, &task.entryPoint);
+            memset(&task, 0, sizeof(MFX_TASK));
+            mfxRes = session->m_pDECODE->DecodeFrameCheck(bs, surface_work, surface_out, &task.entryPoint);
+        } while (MFX_WRN_DEVICE_BUSY == mfxRes && !task.entryPoint.pRoutine && busyWait.Wait());
         MFX_CHECK(mfxRes >= 0 || MFX_ERR_MORE_DATA_SUBMIT_TASK == static_cast<int>(mfxRes)
                   || MFX_ERR_MORE_DATA == static_cast<int>(mfxRes)
                   || MFX_ERR_MORE_SURFACE == static_cast<int>(mfxRes), mfxRes);
@@ -858,15 +858,20 @@ mfxStatus MFXVideoENCODE_EncodeFrameAsync(mfxSession session, mfxEncodeCtrl *ctr
         mfxEncodeInternalParams internal_params;
         MFX_ENTRY_POINT entryPoints[MFX_NUM_ENTRY_POINTS];
         mfxU32 numEntryPoints = MFX_NUM_ENTRY_POINTS;
+        DeviceBusyWait busyWait(session);
 
-        memset(&entryPoints, 0, sizeof(entryPoints));
-        mfxRes = session->m_pENCODE->EncodeFrameCheck(ctrl,
-                                                      surface,
-                                                      bs,
-                                                      &reordered_surface,
-                                                      &internal_params,
-                                                      entryPoints,
-                                                      numEntryPoints);
+        do
+        {
+            numEntryPoints = MFX_NUM_ENTRY_POINTS;
+            memset(&entryPoints, 0, sizeof(entryPoints));
+            mfxRes = session->m_pENCODE->EncodeFrameCheck(ctrl,
+                                                          surface,
+                                                          bs,
+                                                          &reordered_surface,
+                                                          &internal_params,
+                                                          entryPoints,
+                                                          numEntryPoints);
+        } while (MFX_WRN_DEVICE_BUSY == mfxRes && busyWait.Wait());
         // source data is OK, go forward
         if ((MFX_ERR_NONE == mfxRes) ||
             (MFX_WRN_INCOMPATIBLE_VIDEO_PARAM == mfxRes) ||
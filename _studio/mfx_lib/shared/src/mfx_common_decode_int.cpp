@@ -19,56 +19,281 @@
 // SOFTWARE.
 
 #include "mfx_common_decode_int.h"
+#include "mfx_session.h"
+#include "umc_nal_unit_splitter_thread.h"
 #include "mfx_enc_common.h"
 
 #include "umc_va_base.h"
 #include "umc_defs.h"
 
 MFXMediaDataAdapter::MFXMediaDataAdapter(mfxBitstream *pBitstream)
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    : m_fragments(nullptr)
+    , m_fragment(0)
+    , m_fragmentBase(0)
+    , m_released(0)
+    , m_dataFlag(0)
+#endif
 {
     Load(pBitstream);
 }
 
+static void SetBitstreamFlags(UMC::MediaData& data, mfxU16 dataFlag)
+{
+    data.SetFlags(0);
+
+    if (dataFlag & MFX_BITSTREAM_EOS)
+    {
+        data.SetFlags(UMC::MediaData::FLAG_VIDEO_DATA_END_OF_STREAM);
+    }
+    else
+    {
+        if (!(dataFlag & MFX_BITSTREAM_COMPLETE_FRAME))
+        {
+            data.SetFlags(UMC::MediaData::FLAG_VIDEO_DATA_NOT_FULL_UNIT | UMC::MediaData::FLAG_VIDEO_DATA_NOT_FULL_FRAME);
+        }
+    }
+}
+
 void MFXMediaDataAdapter::Load(mfxBitstream *pBitstream)
 {
     if (!pBitstream)
         return;
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    m_fragments = (mfxExtBitstreamFragments*)GetExtendedBuffer(pBitstream->ExtParam, pBitstream->NumExtParam, MFX_EXTBUFF_BITSTREAM_FRAGMENTS);
+    if (m_fragments)
+    {
+        m_dataFlag = pBitstream->DataFlag;
+        SetTime(GetUmcTimeStamp(pBitstream->TimeStamp));
+
+        // fragments which end before DataOffset were consumed by previous calls or skipped by application,
+        // all of them are given back by Save if they were not yet
+        m_fragment     = 0;
+        m_fragmentBase = 0;
+        while (m_fragment < m_fragments->NumFragments
+            && m_fragmentBase + m_fragments->Fragments[m_fragment].DataLength <= pBitstream->DataOffset)
+        {
+            m_fragmentBase += m_fragments->Fragments[m_fragment].DataLength;
+            m_fragment++;
+        }
+
+        m_released = m_fragments->NumReleased;
+        LoadFragment(pBitstream->DataOffset - m_fragmentBase);
+        return;
+    }
+#endif
+
     SetBufferPointer(pBitstream->Data, pBitstream->DataOffset + pBitstream->DataLength);
     SetDataSize(pBitstream->DataOffset + pBitstream->DataLength);
     MoveDataPointer(pBitstream->DataOffset);
     SetTime(GetUmcTimeStamp(pBitstream->TimeStamp));
 
-    SetFlags(0);
+    SetBitstreamFlags(*this, pBitstream->DataFlag);
+}
 
-    if (pBitstream->DataFlag & MFX_BITSTREAM_EOS)
+void MFXMediaDataAdapter::Save(mfxBitstream *pBitstream)
+{
+    if (!pBitstream)
+        return;
+
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    if (m_fragments)
     {
-        SetFlags(UMC::MediaData::FLAG_VIDEO_DATA_END_OF_STREAM);
+        mfxU32 total = m_fragmentBase;
+        for (mfxU32 i = m_fragment; i < m_fragments->NumFragments; i++)
+            total += m_fragments->Fragments[i].DataLength;
+
+        mfxU32 consumed = m_fragment < m_fragments->NumFragments ? (mfxU32)((mfxU8*)GetDataPointer() - (mfxU8*)GetBufferPointer()) : 0;
+        pBitstream->DataOffset = m_fragmentBase + consumed;
+        pBitstream->DataLength = total - pBitstream->DataOffset;
+
+        // Decoder never keeps pointers to input past AddSource (partial NAL units are gathered
+        // by splitter, slice data of incomplete frame is copied), so consumed fragments can go
+        mfxU32 end = m_fragment;
+        if (end < m_fragments->NumFragments && !GetDataSize())
+            end++;
+
+        for (; m_released < end; m_released++)
+        {
+            if (m_fragments->Release)
+                m_fragments->Release(m_fragments->pthis, &m_fragments->Fragments[m_released]);
+        }
+        m_fragments->NumReleased = mfxU16(m_released);
+        return;
     }
+#endif
+
+    pBitstream->DataOffset = (mfxU32)((mfxU8*)GetDataPointer() - (mfxU8*)GetBufferPointer());
+    pBitstream->DataLength = (mfxU32)GetDataSize();
+}
+
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+void MFXMediaDataAdapter::LoadFragment(mfxU32 offset)
+{
+    mfxU32 num = m_fragments->NumFragments;
+
+    if (m_fragment >= num)
+    {
+        // everything is consumed, expose empty tail of last fragment to keep non-null pointer
+        mfxBitstreamFragment& last = m_fragments->Fragments[num - 1];
+        SetBufferPointer(last.Data, last.DataLength);
+        SetDataSize(last.DataLength);
+        MoveDataPointer(last.DataLength);
+        SetBitstreamFlags(*this, m_dataFlag);
+        return;
+    }
+
+    mfxBitstreamFragment& fragment = m_fragments->Fragments[m_fragment];
+    SetBufferPointer(fragment.Data, fragment.DataLength);
+    SetDataSize(fragment.DataLength);
+    MoveDataPointer(offset);
+
+    if (m_fragment + 1 < num)
+        SetFlags(UMC::MediaData::FLAG_VIDEO_DATA_NOT_FULL_UNIT | UMC::MediaData::FLAG_VIDEO_DATA_NOT_FULL_FRAME);
     else
+        SetBitstreamFlags(*this, m_dataFlag);
+}
+
+bool MFXMediaDataAdapter::NextFragment()
+{
+    if (!m_fragments || m_fragment >= m_fragments->NumFragments || GetDataSize())
+        return false;
+
+    if (m_fragment + 1 >= m_fragments->NumFragments)
+        return false;
+
+    m_fragmentBase += m_fragments->Fragments[m_fragment].DataLength;
+    m_fragment++;
+    LoadFragment(0);
+    return true;
+}
+
+mfxStatus CheckFragmentedBitstream(const mfxBitstream *bs)
+{
+    MFX_CHECK_NULL_PTR1(bs);
+
+    mfxExtBitstreamFragments* fragments = (mfxExtBitstreamFragments*)GetExtendedBuffer(bs->ExtParam, bs->NumExtParam, MFX_EXTBUFF_BITSTREAM_FRAGMENTS);
+    if (!fragments)
+        return CheckBitstream(bs);
+
+    MFX_CHECK(fragments->NumFragments && fragments->Fragments, MFX_ERR_NULL_PTR);
+    MFX_CHECK(fragments->NumReleased <= fragments->NumFragments, MFX_ERR_UNDEFINED_BEHAVIOR);
+
+    mfxU64 total = 0;
+    for (mfxU32 i = 0; i < fragments->NumFragments; i++)
     {
-        if (!(pBitstream->DataFlag & MFX_BITSTREAM_COMPLETE_FRAME))
-        {
-            SetFlags(UMC::MediaData::FLAG_VIDEO_DATA_NOT_FULL_UNIT | UMC::MediaData::FLAG_VIDEO_DATA_NOT_FULL_FRAME);
-        }
+        MFX_CHECK(fragments->Fragments[i].Data || !fragments->Fragments[i].DataLength, MFX_ERR_NULL_PTR);
+        total += fragments->Fragments[i].DataLength;
     }
+
+    MFX_CHECK((mfxU64)bs->DataOffset + bs->DataLength <= total, MFX_ERR_UNDEFINED_BEHAVIOR);
+
+    return MFX_ERR_NONE;
 }
 
-void MFXMediaDataAdapter::Save(mfxBitstream *pBitstream)
+MFXGatheredBitstream::MFXGatheredBitstream(mfxBitstream *bs)
+    : m_original(bs)
+    , m_target(bs)
+    , m_gathered()
+    , m_base(0)
 {
-    if (!pBitstream)
+    mfxExtBitstreamFragments* fragments = bs ? (mfxExtBitstreamFragments*)GetExtendedBuffer(bs->ExtParam, bs->NumExtParam, MFX_EXTBUFF_BITSTREAM_FRAGMENTS) : nullptr;
+    if (!fragments)
         return;
 
-    pBitstream->DataOffset = (mfxU32)((mfxU8*)GetDataPointer() - (mfxU8*)GetBufferPointer());
-    pBitstream->DataLength = (mfxU32)GetDataSize();
+    // fragments before DataOffset may be given back already
+    mfxU32 i = 0;
+    for (; i < fragments->NumFragments && m_base + fragments->Fragments[i].DataLength <= bs->DataOffset; i++)
+        m_base += fragments->Fragments[i].DataLength;
+
+    m_buffer.reserve(bs->DataOffset + bs->DataLength - m_base);
+    for (; i < fragments->NumFragments; i++)
+        m_buffer.insert(m_buffer.end(), fragments->Fragments[i].Data, fragments->Fragments[i].Data + fragments->Fragments[i].DataLength);
+
+    m_gathered             = *bs;
+    m_gathered.ExtParam    = nullptr;
+    m_gathered.NumExtParam = 0;
+    m_gathered.Data        = m_buffer.data();
+    m_gathered.MaxLength   = (mfxU32)m_buffer.size();
+    m_gathered.DataOffset  = bs->DataOffset - m_base;
+    m_target               = &m_gathered;
+}
+
+MFXGatheredBitstream::~MFXGatheredBitstream()
+{
+    if (m_target == m_original)
+        return;
+
+    m_original->DataOffset = m_base + m_gathered.DataOffset;
+    m_original->DataLength = m_gathered.DataLength;
 }
 
+size_t GetPreSplitSize(mfxVideoParam const* par)
+{
+    mfxExtDecodePreSplit* preSplit = (mfxExtDecodePreSplit*)GetExtendedBuffer(par->ExtParam, par->NumExtParam, MFX_EXTBUFF_DECODE_PRE_SPLIT);
+    if (!preSplit || preSplit->Mode != MFX_CODINGOPTION_ON)
+        return 0;
+
+    if (preSplit->MaxQueueSize)
+        return preSplit->MaxQueueSize;
+
+    // a few uncompressed frames hold many compressed ones, three NV12 frames
+    size_t const frameSize = size_t(par->mfx.FrameInfo.Width) * par->mfx.FrameInfo.Height * 3 / 2;
+    return std::max<size_t>(1 << 20, frameSize * 3);
+}
+
+mfxStatus ReturnPreSplitData(UMC::NalUnitSplitterThread* splitter, mfxBitstream *bs)
+{
+    // nothing can be given back at the end of stream
+    if (!splitter || !bs)
+        return MFX_ERR_NONE;
+
+    std::vector<uint8_t> data;
+    splitter->TakeBack(data);
+
+    mfxU32 const size = mfxU32(data.size());
+    if (!size)
+        return MFX_ERR_NONE;
+
+    if (bs->DataOffset >= size)
+    {
+        // put it back to the consumed part of the bitstream
+        bs->DataOffset -= size;
+    }
+    else
+    {
+        MFX_CHECK((mfxU64)bs->DataLength + size <= bs->MaxLength, MFX_ERR_NOT_ENOUGH_BUFFER);
+
+        memmove(bs->Data + size, bs->Data + bs->DataOffset, bs->DataLength);
+        bs->DataOffset = 0;
+    }
+
+    std::copy(data.begin(), data.end(), bs->Data + bs->DataOffset);
+    bs->DataLength += size;
+
+    return MFX_ERR_NONE;
+}
+#endif
+
 void MFXMediaDataAdapter::SetExtBuffer(mfxExtBuffer* extbuf)
 {
     if (extbuf)
         SetAuxInfo(extbuf, extbuf->BufferSz, extbuf->BufferId);
 }
 
+mfxU32 SharedDecodeTask::GetRequiredNumThreads(VideoCORE* core, bool shared)
+{
+    if (!shared || !core || !core->GetSession() || !core->GetSession()->m_pScheduler)
+        return 1;
+
+    MFX_SCHEDULER_PARAM schedParam = {};
+    if (MFX_ERR_NONE != core->GetSession()->m_pScheduler->GetParam(&schedParam))
+        return 1;
+
+    return std::max<mfxU32>(schedParam.numberOfThreads, 1);
+}
+
 mfxStatus ConvertUMCStatusToMfx(UMC::Status status)
 {
     switch((UMC::eUMC_VA_Status)status)
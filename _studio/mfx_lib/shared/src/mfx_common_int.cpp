@@ -560,16 +560,28 @@ mfxStatus CheckDecodersExtendedBuffers(mfxVideoParam const* par)
                                                                MFX_EXTBUFF_MVC_SEQ_DESC,
                                                                MFX_EXTBUFF_MVC_TARGET_VIEWS,
                                                                MFX_EXTBUFF_DEC_VIDEO_PROCESSING,
-                                                               MFX_EXTBUFF_FEI_PARAM};
+                                                               MFX_EXTBUFF_FEI_PARAM,
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+                                                               MFX_EXTBUFF_DECODE_PRE_SPLIT,
+#endif
+                                                               };
 
     static const mfxU32 g_decoderSupportedExtBuffersHEVC[]  = {
                                                                MFX_EXTBUFF_HEVC_PARAM,
-	                                                         MFX_EXTBUFF_DEC_VIDEO_PROCESSING
+	                                                         MFX_EXTBUFF_DEC_VIDEO_PROCESSING,
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+                                                               MFX_EXTBUFF_DECODE_PRE_SPLIT,
+#endif
                                                                };
 
     static const mfxU32 g_decoderSupportedExtBuffersVC1[]   = {MFX_EXTBUFF_OPAQUE_SURFACE_ALLOCATION,
                                                                };
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    static const mfxU32 g_decoderSupportedExtBuffersAV1[]   = {MFX_EXTBUFF_AV1_FILM_GRAIN_SYNTHESIS,
+                                                               };
+#endif
+
 
     static const mfxU32 g_decoderSupportedExtBuffersMJPEG[] = {MFX_EXTBUFF_JPEG_HUFFMAN,
                                                                MFX_EXTBUFF_DEC_VIDEO_PROCESSING,
@@ -598,6 +610,13 @@ mfxStatus CheckDecodersExtendedBuffers(mfxVideoParam const* par)
         supported_buffers = g_decoderSupportedExtBuffersMJPEG;
         numberOfSupported = sizeof(g_decoderSupportedExtBuffersMJPEG) / sizeof(g_decoderSupportedExtBuffersMJPEG[0]);
     }
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    else if (par->mfx.CodecId == MFX_CODEC_AV1)
+    {
+        supported_buffers = g_decoderSupportedExtBuffersAV1;
+        numberOfSupported = sizeof(g_decoderSupportedExtBuffersAV1) / sizeof(g_decoderSupportedExtBuffersAV1[0]);
+    }
+#endif
     else
     {
         supported_buffers = g_commonSupportedExtBuffers;
@@ -855,6 +874,10 @@ void mfxVideoParamWrapper::CopyVideoParam(const mfxVideoParam & par)
         case MFX_EXTBUFF_JPEG_HUFFMAN:
         case MFX_EXTBUFF_HEVC_PARAM:
         case MFX_EXTBUFF_FEI_PARAM:
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        case MFX_EXTBUFF_DECODE_PRE_SPLIT:
+        case MFX_EXTBUFF_AV1_FILM_GRAIN_SYNTHESIS:
+#endif
             {
                 void * in = GetExtendedBufferInternal(par.ExtParam, par.NumExtParam, par.ExtParam[i]->BufferId);
                 m_buffers.AddBuffer(par.ExtParam[i]);
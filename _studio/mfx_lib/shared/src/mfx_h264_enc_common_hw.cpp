@@ -1782,6 +1782,10 @@ bool MfxHwH264Encode::IsRuntimeOutputExtBufferIdSupported(MfxVideoParam const &
 #ifndef MFX_AVC_ENCODING_UNIT_DISABLE
             || id == MFX_EXTBUFF_ENCODED_UNITS_INFO
 #endif
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+            || id == MFX_EXTBUFF_CODED_BUFFER_REF
+            || id == MFX_EXTBUFF_ENCODE_STAGE_LATENCY
+#endif
 #if defined (MFX_ENABLE_H264_VIDEO_FEI_ENCPAK)
             || (isFeiENCPAK && (
                id == MFX_EXTBUFF_FEI_ENC_MV
@@ -1855,6 +1859,9 @@ bool MfxHwH264Encode::IsVideoParamExtBufferIdSupported(mfxU32 id)
 #if defined(__MFXBRC_H__)
         || id == MFX_EXTBUFF_BRC
 #endif
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        || id == MFX_EXTBUFF_CODED_BUFFER_REF
+#endif
 #if defined(MFX_ENABLE_ENCTOOLS)
         || id == MFX_EXTBUFF_ENCTOOLS
         || id == MFX_EXTBUFF_ENCTOOLS_CONFIG
@@ -8015,6 +8022,9 @@ void MfxVideoParam::Construct(mfxVideoParam const & par)
 #if defined(__MFXBRC_H__)
     CONSTRUCT_EXT_BUFFER(mfxExtBRC,                  m_extBRC);
 #endif
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    CONSTRUCT_EXT_BUFFER(mfxExtCodedBufferRef,       m_extCodedRef);
+#endif
 #if defined(MFX_ENABLE_ENCTOOLS)
     CONSTRUCT_EXT_BUFFER(mfxEncTools,                m_encTools);
     CONSTRUCT_EXT_BUFFER(mfxExtEncToolsConfig,          m_encToolsConfig);
@@ -27,6 +27,7 @@
 #include <va/va_enc_h264.h>
 #include "mfxfei.h"
 #include "libmfx_core_vaapi.h"
+#include "mfx_va_caps_cache.h"
 #include "mfx_common_int.h"
 #include "mfx_h264_encode_vaapi.h"
 #include "mfx_h264_encode_hw_utils.h"
@@ -1524,7 +1525,7 @@ mfxStatus VAAPIEncoder::CreateAuxilliaryDevice(
         entrypoint = VAEntrypointEncSliceLP;
     }
 
-    VAStatus vaSts = vaGetConfigAttributes(m_vaDisplay,
+    VAStatus vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
                           ConvertProfileTypeMFX2VAAPI(m_videoParam.mfx.CodecProfile),
                           entrypoint,
                           Begin(attrs), attrs.size());
@@ -1653,7 +1654,7 @@ mfxStatus VAAPIEncoder::CreateAccelerationService(MfxVideoParam const & par)
 
     std::vector<VAEntrypoint> pEntrypoints(numEntrypoints);
 
-    vaSts = vaQueryConfigEntrypoints(
+    vaSts = MfxVaCaps::QueryConfigEntrypoints(
                 m_vaDisplay,
                 ConvertProfileTypeMFX2VAAPI(par.mfx.CodecProfile),
                 Begin(pEntrypoints),
@@ -1725,7 +1726,7 @@ mfxStatus VAAPIEncoder::CreateAccelerationService(MfxVideoParam const & par)
     }
 #endif
 
-    vaSts = vaGetConfigAttributes(m_vaDisplay,
+    vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
                           ConvertProfileTypeMFX2VAAPI(par.mfx.CodecProfile),
                           entryPoint,
                           &attrib[0], numAttrib);
@@ -2006,23 +2007,12 @@ mfxStatus VAAPIEncoder::QueryEncodeCaps(MFX_ENCODE_CAPS& caps)
 
 mfxStatus VAAPIEncoder::QueryMbPerSec(mfxVideoParam const & par, mfxU32 (&mbPerSec)[16])
 {
-    VAConfigID config = VA_INVALID_ID;
-
     VAConfigAttrib attrib[2];
     attrib[0].type = VAConfigAttribRTFormat;
     attrib[0].value = VA_RT_FORMAT_YUV420;
     attrib[1].type = VAConfigAttribRateControl;
     attrib[1].value = ConvertRateControlMFX2VAAPI(par.mfx.RateControlMethod);
 
-    VAStatus vaSts = vaCreateConfig(
-        m_vaDisplay,
-        ConvertProfileTypeMFX2VAAPI(par.mfx.CodecProfile),
-        IsOn(par.mfx.LowPower) ? VAEntrypointEncSliceLP : VAEntrypointEncSlice,
-        attrib,
-        2,
-        &config);
-    MFX_CHECK_WITH_ASSERT(VA_STATUS_SUCCESS == vaSts, MFX_ERR_DEVICE_FAILED);
-
     VAProcessingRateParameter proc_rate_buf = { };
     mfxU32 & processing_rate = mbPerSec[0];
 
@@ -2031,11 +2021,17 @@ mfxStatus VAAPIEncoder::QueryMbPerSec(mfxVideoParam const & par, mfxU32 (&mbPerS
     proc_rate_buf.proc_buf_enc.intra_period = par.mfx.GopPicSize ? par.mfx.GopPicSize : 0xffff;
     proc_rate_buf.proc_buf_enc.ip_period = par.mfx.GopRefDist ? par.mfx.GopRefDist : 0xffff;
 
-    vaSts = vaQueryProcessingRate(m_vaDisplay, config, &proc_rate_buf, &processing_rate);
+    // throwaway config is created by the cache on the first query only
+    VAStatus vaSts = MfxVaCaps::QueryProcessingRate(
+        m_vaDisplay,
+        ConvertProfileTypeMFX2VAAPI(par.mfx.CodecProfile),
+        IsOn(par.mfx.LowPower) ? VAEntrypointEncSliceLP : VAEntrypointEncSlice,
+        attrib,
+        2,
+        &proc_rate_buf,
+        &processing_rate);
     MFX_CHECK_WITH_ASSERT(VA_STATUS_SUCCESS == vaSts, MFX_ERR_DEVICE_FAILED);
 
-    vaDestroyConfig(m_vaDisplay, config);
-
     return MFX_ERR_NONE;
 }
 
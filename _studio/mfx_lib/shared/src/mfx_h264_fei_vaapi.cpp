@@ -26,6 +26,7 @@
 #include <va/va_enc_h264.h>
 #include "mfxfei.h"
 #include "libmfx_core_vaapi.h"
+#include "mfx_va_caps_cache.h"
 #include "mfx_h264_encode_vaapi.h"
 #include "mfx_h264_encode_hw_utils.h"
 
@@ -109,7 +110,7 @@ mfxStatus VAAPIFEIPREENCEncoder::CreatePREENCAccelerationService(MfxVideoParam c
     std::vector<VAEntrypoint> pEntrypoints(numEntrypoints);
 
     // Find entry point for PreENC
-    VAStatus vaSts = vaQueryConfigEntrypoints(
+    VAStatus vaSts = MfxVaCaps::QueryConfigEntrypoints(
             m_vaDisplay,
             VAProfileNone, //specific for statistic
             Begin(pEntrypoints),
@@ -129,7 +130,7 @@ mfxStatus VAAPIFEIPREENCEncoder::CreatePREENCAccelerationService(MfxVideoParam c
     //attrib[0].type = VAConfigAttribRTFormat;
     attrib[0].type = VAConfigAttribStats;
 
-    vaSts = vaGetConfigAttributes(m_vaDisplay,
+    vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
             VAProfileNone,
             VAEntrypointStats,
             &attrib[0], 1);
@@ -854,7 +855,7 @@ mfxStatus VAAPIFEIENCEncoder::CreateENCAccelerationService(MfxVideoParam const &
     int num_entrypoints, slice_entrypoint;
     VAConfigAttrib attrib[4];
 
-    vaSts = vaQueryConfigEntrypoints(m_vaDisplay, profile, entrypoints, &num_entrypoints);
+    vaSts = MfxVaCaps::QueryConfigEntrypoints(m_vaDisplay, profile, entrypoints, &num_entrypoints);
     MFX_CHECK_WITH_ASSERT(VA_STATUS_SUCCESS == vaSts, MFX_ERR_DEVICE_FAILED);
 
     for (slice_entrypoint = 0; slice_entrypoint < num_entrypoints; ++slice_entrypoint)
@@ -871,7 +872,7 @@ mfxStatus VAAPIFEIENCEncoder::CreateENCAccelerationService(MfxVideoParam const &
     attrib[2].type = VAConfigAttribFEIFunctionType;
     attrib[3].type = VAConfigAttribFEIMVPredictors;
 
-    vaSts = vaGetConfigAttributes(m_vaDisplay, profile, VAEntrypointFEI, &attrib[0], 4);
+    vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay, profile, VAEntrypointFEI, &attrib[0], 4);
     MFX_CHECK_WITH_ASSERT(VA_STATUS_SUCCESS == vaSts, MFX_ERR_DEVICE_FAILED);
 
     /* not find desired YUV420 RT format */
@@ -1785,7 +1786,7 @@ mfxStatus VAAPIFEIPAKEncoder::CreatePAKAccelerationService(MfxVideoParam const &
     int num_entrypoints, slice_entrypoint;
     VAConfigAttrib attrib[4];
 
-    vaSts = vaQueryConfigEntrypoints( m_vaDisplay, profile,
+    vaSts = MfxVaCaps::QueryConfigEntrypoints( m_vaDisplay, profile,
                                 entrypoints,&num_entrypoints);
     MFX_CHECK_WITH_ASSERT(VA_STATUS_SUCCESS == vaSts, MFX_ERR_DEVICE_FAILED);
 
@@ -1802,7 +1803,7 @@ mfxStatus VAAPIFEIPAKEncoder::CreatePAKAccelerationService(MfxVideoParam const &
     attrib[2].type = VAConfigAttribFEIFunctionType;
     attrib[3].type = VAConfigAttribFEIMVPredictors;
 
-    vaSts = vaGetConfigAttributes(m_vaDisplay, profile, VAEntrypointFEI, &attrib[0], 4);
+    vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay, profile, VAEntrypointFEI, &attrib[0], 4);
     MFX_CHECK_WITH_ASSERT(VA_STATUS_SUCCESS == vaSts, MFX_ERR_DEVICE_FAILED);
 
     /* not find desired YUV420 RT format */
@@ -27,6 +27,7 @@
 
 #include "mfx_session.h"
 #include "libmfx_core_vaapi.h"
+#include "mfx_va_caps_cache.h"
 #include "mfx_common_int.h"
 #include "mfx_mpeg2_encode_vaapi.h"
 #include "vaapi_ext_interface.h"
@@ -415,7 +416,7 @@ mfxStatus VAAPIEncoder::CreateAuxilliaryDevice(mfxU16 codecProfile)
 
     VAEntrypoint entrypoint = VAEntrypointEncSlice;
 
-    VAStatus vaSts = vaGetConfigAttributes(m_vaDisplay,
+    VAStatus vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
                           ConvertProfileTypeMFX2VAAPI(codecProfile),
                           entrypoint,
                           attrs.data(), attrs.size());
@@ -519,7 +520,7 @@ mfxStatus VAAPIEncoder::Init(ENCODE_FUNC func, ExecuteBuffers* pExecuteBuffers)
         else
             return MFX_ERR_DEVICE_FAILED;
 
-        vaSts = vaQueryConfigEntrypoints(
+        vaSts = MfxVaCaps::QueryConfigEntrypoints(
             m_vaDisplay,
             mpegProfile,
             pEntrypoints,
@@ -546,7 +547,7 @@ mfxStatus VAAPIEncoder::Init(ENCODE_FUNC func, ExecuteBuffers* pExecuteBuffers)
     // Configuration
     std::vector<VAConfigAttrib> attrib_priority(1);
     attrib_priority[0].type = VAConfigAttribContextPriority;
-    vaGetConfigAttributes(m_vaDisplay,
+    MfxVaCaps::GetConfigAttributes(m_vaDisplay,
         ConvertProfileTypeMFX2VAAPI(pExecuteBuffers->m_sps.Profile),
         VAEntrypointEncSlice,
         attrib_priority.data(), attrib_priority.size());
@@ -560,7 +561,7 @@ mfxStatus VAAPIEncoder::Init(ENCODE_FUNC func, ExecuteBuffers* pExecuteBuffers)
     attrib[1].type = VAConfigAttribRateControl;
     //attrib[2].type = VAConfigAttribEncSkipFrame;
 
-    vaGetConfigAttributes(m_vaDisplay,
+    MfxVaCaps::GetConfigAttributes(m_vaDisplay,
         ConvertProfileTypeMFX2VAAPI(pExecuteBuffers->m_sps.Profile),
         VAEntrypointEncSlice,
         &attrib[0], 2);
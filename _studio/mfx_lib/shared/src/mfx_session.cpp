@@ -496,12 +496,17 @@ _mfxSession::_mfxSession(const mfxU32 adapterNum)
     m_currentPlatform = MFX_PLATFORM_HARDWARE;
 
     Clear();
+
+    mfxSysMemFramePool::Instance().AddSession();
 } // _mfxSession::_mfxSession(const mfxU32 adapterNum) :
 
 _mfxSession::~_mfxSession(void)
 {
     Cleanup();
 
+    // frames of the session are freed with the core
+    mfxSysMemFramePool::Instance().RemoveSession();
+
 } // _mfxSession::~_mfxSession(void)
 
 void _mfxSession::Clear(void)
@@ -707,6 +712,57 @@ mfxStatus _mfxSession::ReleaseScheduler(void)
 
 } // mfxStatus _mfxSession::RestoreScheduler(void)
 
+//////////////////////////////////////////////////////////////////////////
+// DeviceBusyWait members
+//////////////////////////////////////////////////////////////////////////
+
+DeviceBusyWait::DeviceBusyWait(_mfxSession* session)
+    : m_pScheduler()
+    , m_completedTasks()
+{
+    MFXIUnknown* pInt = session->m_pScheduler;
+    m_pScheduler = ::QueryInterface<MFXIScheduler2>(pInt, MFXIScheduler2_GUID);
+    if (!m_pScheduler)
+        return;
+    // the session keeps the scheduler alive
+    m_pScheduler->Release();
+
+    mfxU32 const busyWaitTimeout = m_pScheduler->GetBusyWaitTimeout();
+    if (!busyWaitTimeout)
+    {
+        m_pScheduler = nullptr;
+        return;
+    }
+
+    // get the current number of completed tasks
+    if (MFX_ERR_NONE > m_pScheduler->WaitForTaskCompletion(m_completedTasks, 0))
+    {
+        m_pScheduler = nullptr;
+        return;
+    }
+
+    m_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(busyWaitTimeout);
+}
+
+bool DeviceBusyWait::Wait()
+{
+    if (!m_pScheduler)
+        return false;
+
+    auto const now = std::chrono::steady_clock::now();
+    if (now >= m_deadline)
+        return false;
+
+    // round up, so a short remainder doesn't turn into a zero wait
+    auto const timeToWait = std::chrono::duration_cast<std::chrono::milliseconds>(
+        m_deadline - now + std::chrono::milliseconds(1) - std::chrono::nanoseconds(1));
+
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_API, "DeviceBusyWait");
+    mfxStatus sts = m_pScheduler->WaitForTaskCompletion(m_completedTasks, mfxU32(timeToWait.count()));
+
+    return MFX_ERR_NONE == sts;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // _mfxSession_1_10 own members
 //////////////////////////////////////////////////////////////////////////
@@ -823,17 +879,58 @@ mfxStatus _mfxSession_1_10::InitEx(mfxInitParam& par)
             return MFX_ERR_INCOMPATIBLE_VIDEO_PARAM;
     }
 
-    // only mfxExtThreadsParam is allowed
+    // only mfxExtThreadsParam, mfxExtDeviceBusyWait and mfxExtSysMemFramePool are allowed
+    mfxExtThreadsParam* threadsParam = nullptr;
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    mfxExtDeviceBusyWait* busyWait = nullptr;
+    mfxExtSysMemFramePool* framePool = nullptr;
+#else
+    void* busyWait = nullptr;
+#endif
     if (par.NumExtParam)
     {
-        if ((par.NumExtParam > 1) || !par.ExtParam)
+        if (!par.ExtParam)
         {
             return MFX_ERR_UNSUPPORTED;
         }
-        if ((par.ExtParam[0]->BufferId != MFX_EXTBUFF_THREADS_PARAM) ||
-            (par.ExtParam[0]->BufferSz != sizeof(mfxExtThreadsParam)))
+        for (mfxU16 i = 0; i < par.NumExtParam; i++)
         {
-            return MFX_ERR_UNSUPPORTED;
+            mfxExtBuffer* buffer = par.ExtParam[i];
+            if (!buffer)
+            {
+                return MFX_ERR_UNSUPPORTED;
+            }
+
+            if ((buffer->BufferId == MFX_EXTBUFF_THREADS_PARAM) &&
+                (buffer->BufferSz == sizeof(mfxExtThreadsParam)) && !threadsParam)
+            {
+                threadsParam = reinterpret_cast<mfxExtThreadsParam*>(buffer);
+            }
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+            else if ((buffer->BufferId == MFX_EXTBUFF_DEVICE_BUSY_WAIT) &&
+                     (buffer->BufferSz == sizeof(mfxExtDeviceBusyWait)) && !busyWait)
+            {
+                // nobody completes tasks while the application thread waits
+                if (par.ExternalThreads)
+                {
+                    return MFX_ERR_UNSUPPORTED;
+                }
+                busyWait = reinterpret_cast<mfxExtDeviceBusyWait*>(buffer);
+            }
+            else if ((buffer->BufferId == MFX_EXTBUFF_SYSMEM_FRAME_POOL) &&
+                     (buffer->BufferSz == sizeof(mfxExtSysMemFramePool)) && !framePool)
+            {
+                framePool = reinterpret_cast<mfxExtSysMemFramePool*>(buffer);
+                if (!framePool->MaxSize)
+                {
+                    return MFX_ERR_UNSUPPORTED;
+                }
+            }
+#endif
+            else
+            {
+                return MFX_ERR_UNSUPPORTED;
+            }
         }
     }
 
@@ -871,7 +968,7 @@ mfxStatus _mfxSession_1_10::InitEx(mfxInitParam& par)
 
     MFXIScheduler2* pScheduler2 = ::QueryInterface<MFXIScheduler2>(m_pSchedulerAllocated, MFXIScheduler2_GUID);
 
-    if (par.NumExtParam && !pScheduler2) {
+    if ((threadsParam || busyWait) && !pScheduler2) {
         return MFX_ERR_UNKNOWN;
     }
 
@@ -881,9 +978,14 @@ mfxStatus _mfxSession_1_10::InitEx(mfxInitParam& par)
         schedParam.flags = MFX_SCHEDULER_DEFAULT;
         schedParam.numberOfThreads = maxNumThreads;
         schedParam.pCore = m_pCORE.get();
-        if (par.NumExtParam) {
-            schedParam.params = *((mfxExtThreadsParam*)par.ExtParam[0]);
+        if (threadsParam) {
+            schedParam.params = *threadsParam;
+        }
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        if (busyWait) {
+            schedParam.busyWaitTimeout = busyWait->Timeout;
         }
+#endif
         mfxRes = pScheduler2->Initialize2(&schedParam);
 
         m_pScheduler->Release();
@@ -926,6 +1028,13 @@ mfxStatus _mfxSession_1_10::InitEx(mfxInitParam& par)
         }
     }
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    if (framePool)
+    {
+        mfxSysMemFramePool::Instance().RequestBudget((size_t)framePool->MaxSize << 20);
+    }
+#endif
+
     return MFX_ERR_NONE;
 } // mfxStatus _mfxSession_1_10::InitEx(mfxInitParam& par);
 
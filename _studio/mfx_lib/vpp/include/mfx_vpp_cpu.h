@@ -0,0 +1,209 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_common.h"
+
+#if defined (MFX_ENABLE_VPP)
+
+#ifndef __MFX_VPP_CPU_H
+#define __MFX_VPP_CPU_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "mfxvideo++int.h"
+#include "mfx_vpp_cpu_kernels.h"
+
+// CPU implementation of the system memory subset of VPP: crop, resize
+// (nearest, bilinear, bicubic, Lanczos), color conversion between NV12,
+// YV12, P010, YUY2 and RGB4, and N:1 composition with global/pixel alpha.
+//
+// Every output frame is split in row tiles. The task entry point runs one
+// tile per call, so the scheduler spreads a frame over the session threads.
+// Each plane is resampled separably: source rows are unpacked to float,
+// filtered horizontally into a ring of rows, then filtered vertically into
+// a band of the output (the canvas), which is packed into the output
+// surface once all streams are drawn.
+//
+// As on the GPU path, only the last input of a composition cycle is a
+// scheduler dependency; the other inputs must be ready when they're passed.
+
+namespace MfxCpuVideoProcessing
+{
+    enum FilterKernel
+    {
+        FILTER_NEAREST,
+        FILTER_BILINEAR,
+        FILTER_BICUBIC,
+        FILTER_LANCZOS3
+    };
+
+    // Weights of one resampling direction. Output sample i uses taps input
+    // samples from start[i]; coef is tap major (k * dstSize + i) for
+    // horizontal and sample major (i * taps + k) for vertical tables.
+    struct FilterTable
+    {
+        mfxI32              srcSize;
+        mfxI32              dstSize;
+        mfxI32              taps;
+        bool                identity;
+        std::vector<mfxI32> start;
+        std::vector<float>  coef;
+    };
+
+    void BuildFilterTable(FilterTable & table, mfxI32 srcSize, mfxI32 dstSize, FilterKernel kernel, bool tapMajor);
+
+    struct Rect
+    {
+        mfxI32 x, y, w, h;
+    };
+
+    // what is read from the source for a plane
+    enum Component
+    {
+        COMP_Y, COMP_U, COMP_V,             // planes of YUV sources
+        COMP_B, COMP_G, COMP_R, COMP_A,     // channels of RGB4 sources
+        COMP_RGB_Y, COMP_RGB_U, COMP_RGB_V  // RGB4 sources converted to YUV on fetch
+    };
+
+    struct PlaneSetup
+    {
+        Component   component;
+        Rect        src;    // in source plane samples, absolute
+        Rect        dst;    // in canvas plane samples, relative to the canvas
+        FilterTable horz;
+        FilterTable vert;
+    };
+
+    // Immutable per stream state, rebuilt when the crops change. Shared by
+    // all tasks that use it.
+    struct StreamSetup
+    {
+        mfxFrameInfo srcInfo;
+        Rect         rect;          // in canvas luma samples
+        bool         toRgb;         // YUV source on RGB canvas
+        float        matrix[3][4];  // RGB to YUV on fetch or YUV to BGR after resampling
+        mfxU32       numPlanes;     // planes written to the canvas
+        PlaneSetup   plane[4];
+        bool         pixelAlpha;    // alpha holds the resampled source alpha
+        PlaneSetup   alpha;
+        float        globalAlpha;   // 0..1
+    };
+
+    struct CanvasSetup
+    {
+        mfxFrameInfo info;
+        bool         rgb;
+        bool         fields;        // fields are processed as separate pictures
+        mfxU32       numPlanes;
+        mfxU32       subX;          // log2 chroma subsampling
+        mfxU32       subY;
+        Rect         crop;          // per picture (field) in luma samples
+        float        background[4];
+        bool         fillBackground;
+        mfxU32       tileRows;
+        mfxU32       tilesPerPicture;
+    };
+
+    struct Task
+    {
+        std::vector<mfxFrameSurface1*>                  surfIn;  // as passed to RunFrameVPPAsync
+        std::vector<mfxFrameSurface1>                   in;      // with locked data pointers
+        std::vector<bool>                               lockedIn;
+        std::vector<std::shared_ptr<const StreamSetup>> setup;
+        mfxFrameSurface1*                               surfOut;
+        mfxFrameSurface1                                out;
+        bool                                            lockedOut;
+        std::shared_ptr<const CanvasSetup>              canvas;
+        mfxU32                                          numTiles;
+    };
+
+    // where mfxExtVPPExecution asks VPP to run
+    enum ExecutionMode
+    {
+        EXECUTION_AUTO,
+        EXECUTION_GPU,
+        EXECUTION_CPU
+    };
+
+    ExecutionMode GetExecutionMode(mfxVideoParam const & par);
+
+    struct Workspace;
+
+    class CpuVideoProcessing
+    {
+    public:
+        CpuVideoProcessing(VideoCORE *core);
+        ~CpuVideoProcessing();
+
+        // MFX_ERR_NONE if the parameters can be processed on the CPU
+        static mfxStatus CheckParams(mfxVideoParam const & par);
+
+        mfxStatus Init(mfxVideoParam const & par);
+        mfxStatus Reset(mfxVideoParam const & par);
+        void      Close();
+
+        // MFX_ERR_MORE_DATA until all inputs of a composition are collected
+        mfxStatus FrameCheck(mfxFrameSurface1 *in, mfxFrameSurface1 *out, Task *& task);
+
+        mfxStatus ProcessTile(Task const & task, mfxU32 tile);
+        mfxStatus CompleteTask(Task * task);
+
+        mfxU32 GetNumThreads() const { return m_numThreads; }
+
+    protected:
+        mfxStatus LockSurface(mfxFrameSurface1 *surf, mfxFrameSurface1 & locked, bool & isLocked);
+        void      UnlockSurface(mfxFrameSurface1 & locked, bool isLocked);
+        void      ReleaseTask(Task * task);
+
+        std::shared_ptr<const StreamSetup> GetStreamSetup(mfxU32 stream, mfxFrameInfo const & src, CanvasSetup const & canvas);
+        std::shared_ptr<const CanvasSetup> GetCanvasSetup(mfxFrameInfo const & out);
+
+        Workspace* AcquireWorkspace();
+        void       ReleaseWorkspace(Workspace * ws);
+
+        VideoCORE*                                      m_core;
+        CpuKernels                                      m_kernels;
+        mfxU32                                          m_numThreads;
+
+        FilterKernel                                    m_filter;
+        mfxU16                                          m_inMatrix;
+        mfxU16                                          m_inRange;
+        mfxU16                                          m_outMatrix;
+        mfxU16                                          m_outRange;
+        bool                                            m_composition;
+        std::vector<mfxVPPCompInputStream>              m_streams;
+        mfxU16                                          m_background[3];
+
+        std::mutex                                      m_guard;
+        std::unique_ptr<Task>                           m_pending; // composition inputs collected so far
+        std::shared_ptr<const CanvasSetup>              m_canvas;
+        std::vector<std::shared_ptr<const StreamSetup>> m_setup;
+
+        std::mutex                                      m_wsGuard;
+        std::vector<Workspace*>                         m_freeWorkspaces;
+        std::vector<std::unique_ptr<Workspace>>         m_workspaces;
+    };
+}
+
+#endif // __MFX_VPP_CPU_H
+
+#endif // MFX_ENABLE_VPP
@@ -0,0 +1,97 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __MFX_VPP_CPU_KERNELS_H
+#define __MFX_VPP_CPU_KERNELS_H
+
+#include "mfxdefs.h"
+
+// Row kernels of the CPU VPP. Samples are processed as floats in 8-bit units
+// (10-bit values are divided by 4), so one set of kernels serves all depths.
+// The AVX2 unpack / pack kernels give the same samples as the C ones; the
+// filters and the color matrix use FMA and may differ in the last bits of the
+// float result, which can move a packed sample by one code value.
+
+namespace MfxCpuVideoProcessing
+{
+    // src[i * step] -> dst[i]
+    typedef void (*UnpackRow8Func) (const mfxU8  *src, mfxI32 step, float *dst, mfxI32 width);
+    // (src[i * step] >> shift) / 4 -> dst[i]
+    typedef void (*UnpackRow16Func)(const mfxU16 *src, mfxI32 step, mfxI32 shift, float *dst, mfxI32 width);
+    // round and saturate src[i] -> dst[i * step]
+    typedef void (*PackRow8Func)   (const float *src, mfxU8  *dst, mfxI32 step, mfxI32 width);
+    typedef void (*PackRow16Func)  (const float *src, mfxU16 *dst, mfxI32 step, mfxI32 shift, mfxI32 width);
+    // interleaved chroma of NV12 / P010
+    typedef void (*PackUV8Func)    (const float *u, const float *v, mfxU8  *dst, mfxI32 width);
+    typedef void (*PackUV16Func)   (const float *u, const float *v, mfxU16 *dst, mfxI32 shift, mfxI32 width);
+
+    // dst[i] = sum(coef[k * width + i] * src[start[i] + k]), k < taps
+    typedef void (*HorzFilterFunc) (const float *src, float *dst, const mfxI32 *start, const float *coef, mfxI32 taps, mfxI32 width);
+    // dst[i] = sum(coef[k] * rows[k][i]), k < taps
+    typedef void (*VertFilterFunc) (const float * const *rows, const float *coef, mfxI32 taps, float *dst, mfxI32 width);
+    // dst[i] = m[0] * a[i] + m[1] * b[i] + m[2] * c[i] + m[3]
+    typedef void (*Combine3Func)   (const float *a, const float *b, const float *c, const float m[4], float *dst, mfxI32 width);
+    // dst[i] += (src[i] - dst[i]) * globalAlpha * alpha[i * alphaStep] / 255, alpha may be NULL
+    typedef void (*BlendRowFunc)   (const float *src, const float *alpha, mfxI32 alphaStep, float globalAlpha, float *dst, mfxI32 width);
+
+    struct CpuKernels
+    {
+        UnpackRow8Func  UnpackRow8;
+        UnpackRow16Func UnpackRow16;
+        PackRow8Func    PackRow8;
+        PackRow16Func   PackRow16;
+        PackUV8Func     PackUV8;
+        PackUV16Func    PackUV16;
+        HorzFilterFunc  HorzFilter;
+        VertFilterFunc  VertFilter;
+        Combine3Func    Combine3;
+        BlendRowFunc    BlendRow;
+    };
+
+    // C kernels, replaced by the AVX2 ones when allowSimd is set and the CPU
+    // has both AVX2 and FMA; BlendRow has no SIMD variant
+    void GetCpuKernels(CpuKernels & kernels, bool allowSimd = true);
+
+    void UnpackRow8_C (const mfxU8  *src, mfxI32 step, float *dst, mfxI32 width);
+    void UnpackRow16_C(const mfxU16 *src, mfxI32 step, mfxI32 shift, float *dst, mfxI32 width);
+    void PackRow8_C   (const float *src, mfxU8  *dst, mfxI32 step, mfxI32 width);
+    void PackRow16_C  (const float *src, mfxU16 *dst, mfxI32 step, mfxI32 shift, mfxI32 width);
+    void PackUV8_C    (const float *u, const float *v, mfxU8  *dst, mfxI32 width);
+    void PackUV16_C   (const float *u, const float *v, mfxU16 *dst, mfxI32 shift, mfxI32 width);
+    void HorzFilter_C (const float *src, float *dst, const mfxI32 *start, const float *coef, mfxI32 taps, mfxI32 width);
+    void VertFilter_C (const float * const *rows, const float *coef, mfxI32 taps, float *dst, mfxI32 width);
+    void Combine3_C   (const float *a, const float *b, const float *c, const float m[4], float *dst, mfxI32 width);
+    void BlendRow_C   (const float *src, const float *alpha, mfxI32 alphaStep, float globalAlpha, float *dst, mfxI32 width);
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define MFX_VPP_CPU_AVX2
+    void UnpackRow8_AVX2 (const mfxU8  *src, mfxI32 step, float *dst, mfxI32 width);
+    void UnpackRow16_AVX2(const mfxU16 *src, mfxI32 step, mfxI32 shift, float *dst, mfxI32 width);
+    void PackRow8_AVX2   (const float *src, mfxU8  *dst, mfxI32 step, mfxI32 width);
+    void PackRow16_AVX2  (const float *src, mfxU16 *dst, mfxI32 step, mfxI32 shift, mfxI32 width);
+    void PackUV8_AVX2    (const float *u, const float *v, mfxU8  *dst, mfxI32 width);
+    void PackUV16_AVX2   (const float *u, const float *v, mfxU16 *dst, mfxI32 shift, mfxI32 width);
+    void HorzFilter_AVX2 (const float *src, float *dst, const mfxI32 *start, const float *coef, mfxI32 taps, mfxI32 width);
+    void VertFilter_AVX2 (const float * const *rows, const float *coef, mfxI32 taps, float *dst, mfxI32 width);
+    void Combine3_AVX2   (const float *a, const float *b, const float *c, const float m[4], float *dst, mfxI32 width);
+#endif
+}
+
+#endif // __MFX_VPP_CPU_KERNELS_H
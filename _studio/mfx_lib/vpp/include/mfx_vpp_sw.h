@@ -41,6 +41,7 @@
 /* ******************************************************************** */
 
 #include "mfx_vpp_hw.h"
+#include "mfx_vpp_cpu.h"
 
 class VideoVPPBase
 {
@@ -141,6 +142,28 @@ public:
     mfxStatus PassThrough(mfxFrameInfo* In, mfxFrameInfo* Out, mfxU32 taskIndex);
 };
 
+// system memory VPP on the CPU, see mfx_vpp_cpu.h
+class VideoVPP_SW : public VideoVPPBase
+{
+public:
+    VideoVPP_SW(VideoCORE *core, mfxStatus* sts);
+
+    virtual mfxStatus InternalInit(mfxVideoParam *par);
+    virtual mfxStatus Close(void);
+    virtual mfxStatus Reset(mfxVideoParam *par);
+
+    virtual mfxStatus VppFrameCheck(mfxFrameSurface1 *in, mfxFrameSurface1 *out, mfxExtVppAuxData *aux,
+                                    MFX_ENTRY_POINT pEntryPoints[], mfxU32 &numEntryPoints);
+
+    virtual mfxStatus RunFrameVPP(mfxFrameSurface1* in, mfxFrameSurface1* out, mfxExtVppAuxData *aux);
+
+protected:
+    static mfxStatus RunTileRoutine(void *pState, void *pParam, mfxU32 threadNumber, mfxU32 callNumber);
+    static mfxStatus CompleteTaskRoutine(void *pState, void *pParam, mfxStatus taskRes);
+
+    std::unique_ptr<MfxCpuVideoProcessing::CpuVideoProcessing> m_pCPUVPP;
+};
+
 
 mfxStatus RunFrameVPPRoutine(void *pState, void *pParam, mfxU32 threadNumber, mfxU32 callNumber);
 mfxStatus CompleteFrameVPPRoutine(void *pState, void *pParam, mfxStatus taskRes);
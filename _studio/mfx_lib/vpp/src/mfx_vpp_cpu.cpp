@@ -0,0 +1,1200 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_common.h"
+
+#if defined (MFX_ENABLE_VPP)
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#include "mfx_common_int.h"
+#include "mfx_session.h"
+#include "mfx_vpp_defs.h"
+#include "mfx_vpp_utils.h"
+#include "mfx_vpp_cpu.h"
+
+namespace MfxCpuVideoProcessing
+{
+
+// luma rows of the canvas processed at once
+static const mfxI32 BAND_ROWS = 16;
+
+// source rows of one plane after the horizontal pass, indexed by source row % rows
+struct RowCache
+{
+    std::vector<float>  data;
+    std::vector<mfxI32> tag;
+    mfxI32              width;
+    mfxI32              rows;
+};
+
+struct Workspace
+{
+    std::vector<float>        canvas[4];
+    std::vector<float>        alpha;      // resampled source alpha of the current band
+    std::vector<float>        fetch[4];   // unpacked source row, R/G/B when converted on fetch
+    std::vector<float>        out[3];     // vertically filtered rows
+    std::vector<float>        bgr;
+    std::vector<float>        opaque;
+    std::vector<RowCache>     cache;      // planes and alpha of every stream
+    std::vector<const float*> taps;
+};
+
+// pointers of one picture (frame or field) of a locked surface
+struct View
+{
+    mfxU8* ptr[4];
+    mfxI32 pitch[4];
+    mfxU32 fourCC;
+    mfxI32 shift;
+};
+
+template <class T>
+static inline void Grow(std::vector<T> & v, size_t size)
+{
+    if (v.size() < size)
+        v.resize(size);
+}
+
+static inline mfxI32 Clip(mfxI32 v, mfxI32 lo, mfxI32 hi)
+{
+    return std::min(std::max(v, lo), hi);
+}
+
+static inline mfxI32 CeilShift(mfxI32 v, mfxU32 shift)
+{
+    return (v + (1 << shift) - 1) >> shift;
+}
+
+static void GetSubsampling(mfxU32 fourCC, mfxU32 & subX, mfxU32 & subY)
+{
+    switch (fourCC)
+    {
+    case MFX_FOURCC_NV12:
+    case MFX_FOURCC_YV12:
+    case MFX_FOURCC_P010:
+        subX = 1; subY = 1;
+        break;
+    case MFX_FOURCC_YUY2:
+        subX = 1; subY = 0;
+        break;
+    default:
+        subX = 0; subY = 0;
+        break;
+    }
+}
+
+static Rect GetCrop(mfxFrameInfo const & info, bool fields)
+{
+    Rect r = { info.CropX, info.CropY, info.CropW, info.CropH };
+
+    if (fields)
+    {
+        r.y >>= 1;
+        r.h >>= 1;
+    }
+
+    return r;
+}
+
+static View MakeView(mfxFrameSurface1 const & surf, bool fields, mfxU32 field)
+{
+    View v = {};
+    mfxI32 pitch = (mfxI32)(((mfxU32)surf.Data.PitchHigh << 16) | surf.Data.PitchLow);
+
+    v.fourCC = surf.Info.FourCC;
+    v.shift  = surf.Info.Shift ? 6 : 0;
+
+    switch (surf.Info.FourCC)
+    {
+    case MFX_FOURCC_NV12:
+    case MFX_FOURCC_P010:
+        v.ptr[0] = surf.Data.Y;  v.pitch[0] = pitch;
+        v.ptr[1] = surf.Data.UV; v.pitch[1] = pitch;
+        break;
+    case MFX_FOURCC_YV12:
+        v.ptr[0] = surf.Data.Y;  v.pitch[0] = pitch;
+        v.ptr[1] = surf.Data.U;  v.pitch[1] = pitch / 2;
+        v.ptr[2] = surf.Data.V;  v.pitch[2] = pitch / 2;
+        break;
+    case MFX_FOURCC_YUY2:
+        v.ptr[0] = surf.Data.Y;  v.pitch[0] = pitch;
+        break;
+    case MFX_FOURCC_RGB4:
+        v.ptr[0] = surf.Data.B;  v.pitch[0] = pitch;
+        break;
+    default:
+        break;
+    }
+
+    if (fields)
+    {
+        for (mfxU32 p = 0; p < 4; p++)
+        {
+            if (v.ptr[p])
+                v.ptr[p] += field * v.pitch[p];
+            v.pitch[p] *= 2;
+        }
+    }
+
+    return v;
+}
+
+/* ******************************************************************** */
+/*                         resampling weights                           */
+/* ******************************************************************** */
+
+static double Sinc(double x)
+{
+    if (fabs(x) < 1e-8)
+        return 1.0;
+    x *= 3.14159265358979323846;
+    return sin(x) / x;
+}
+
+static double KernelSupport(FilterKernel kernel)
+{
+    switch (kernel)
+    {
+    case FILTER_BILINEAR: return 1.0;
+    case FILTER_BICUBIC:  return 2.0;
+    case FILTER_LANCZOS3: return 3.0;
+    default:              return 0.5;
+    }
+}
+
+static double KernelWeight(FilterKernel kernel, double x)
+{
+    x = fabs(x);
+
+    switch (kernel)
+    {
+    case FILTER_BILINEAR:
+        return x < 1.0 ? 1.0 - x : 0.0;
+    case FILTER_BICUBIC:
+    {
+        // Keys, a = -0.5
+        const double a = -0.5;
+        if (x < 1.0)
+            return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+        if (x < 2.0)
+            return ((a * x - 5.0 * a) * x + 8.0 * a) * x - 4.0 * a;
+        return 0.0;
+    }
+    case FILTER_LANCZOS3:
+        return x < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+    default:
+        return x <= 0.5 ? 1.0 : 0.0;
+    }
+}
+
+void BuildFilterTable(FilterTable & table, mfxI32 srcSize, mfxI32 dstSize, FilterKernel kernel, bool tapMajor)
+{
+    const double scale = (double)srcSize / dstSize;
+
+    table.srcSize  = srcSize;
+    table.dstSize  = dstSize;
+    table.identity = (srcSize == dstSize);
+
+    if (table.identity || kernel == FILTER_NEAREST || srcSize == 1)
+    {
+        table.taps = 1;
+        table.start.resize(dstSize);
+        table.coef.assign(dstSize, 1.f);
+
+        for (mfxI32 i = 0; i < dstSize; i++)
+            table.start[i] = table.identity ? i : std::min((mfxI32)((i + 0.5) * scale), srcSize - 1);
+        return;
+    }
+
+    // widen the kernel when downscaling so it works as a low pass filter
+    const double fscale = std::max(scale, 1.0);
+    const double radius = KernelSupport(kernel) * fscale;
+    const mfxI32 taps   = std::min(srcSize, 2 * (mfxI32)ceil(radius) + 1);
+
+    table.taps = taps;
+    table.start.resize(dstSize);
+    table.coef.assign(dstSize * taps, 0.f);
+
+    std::vector<double> w(taps);
+
+    for (mfxI32 i = 0; i < dstSize; i++)
+    {
+        const double center = (i + 0.5) * scale - 0.5;
+        const mfxI32 first  = (mfxI32)floor(center - radius) + 1;
+        const mfxI32 last   = (mfxI32)floor(center + radius);
+        const mfxI32 start  = Clip(first, 0, srcSize - taps);
+
+        std::fill(w.begin(), w.end(), 0.0);
+
+        double sum = 0.0;
+        for (mfxI32 j = first; j <= last; j++)
+        {
+            // samples past the edges repeat the edge sample
+            mfxI32 k = Clip(j, 0, srcSize - 1) - start;
+            if (k < 0 || k >= taps)
+                continue;
+
+            double v = KernelWeight(kernel, (j - center) / fscale);
+            w[k] += v;
+            sum  += v;
+        }
+
+        if (fabs(sum) < 1e-6)
+        {
+            std::fill(w.begin(), w.end(), 0.0);
+            w[Clip((mfxI32)floor(center + 0.5), 0, srcSize - 1) - start] = sum = 1.0;
+        }
+
+        table.start[i] = start;
+        for (mfxI32 k = 0; k < taps; k++)
+        {
+            size_t idx = tapMajor ? (size_t)k * dstSize + i : (size_t)i * taps + k;
+            table.coef[idx] = (float)(w[k] / sum);
+        }
+    }
+}
+
+/* ******************************************************************** */
+/*                          parameter checks                            */
+/* ******************************************************************** */
+
+static bool IsSupportedFourCC(mfxU32 fourCC)
+{
+    return fourCC == MFX_FOURCC_NV12
+        || fourCC == MFX_FOURCC_YV12
+        || fourCC == MFX_FOURCC_P010
+        || fourCC == MFX_FOURCC_YUY2
+        || fourCC == MFX_FOURCC_RGB4;
+}
+
+static bool IsFields(mfxU16 picStruct)
+{
+    return !!(picStruct & (MFX_PICSTRUCT_FIELD_TFF | MFX_PICSTRUCT_FIELD_BFF));
+}
+
+static mfxExtBuffer* GetExtBuffer(mfxVideoParam const & par, mfxU32 id)
+{
+    return par.ExtParam ? GetExtendedBuffer(par.ExtParam, par.NumExtParam, id) : NULL;
+}
+
+ExecutionMode GetExecutionMode(mfxVideoParam const & par)
+{
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    mfxExtVPPExecution* exec = (mfxExtVPPExecution*)GetExtBuffer(par, MFX_EXTBUFF_VPP_EXECUTION);
+    if (exec && exec->Mode == MFX_VPP_EXECUTION_GPU)
+        return EXECUTION_GPU;
+    if (exec && exec->Mode == MFX_VPP_EXECUTION_CPU)
+        return EXECUTION_CPU;
+#else
+    (void)par;
+#endif
+    return EXECUTION_AUTO;
+}
+
+mfxStatus CpuVideoProcessing::CheckParams(mfxVideoParam const & par)
+{
+    mfxFrameInfo const & in  = par.vpp.In;
+    mfxFrameInfo const & out = par.vpp.Out;
+
+    MFX_CHECK(par.IOPattern == (MFX_IOPATTERN_IN_SYSTEM_MEMORY | MFX_IOPATTERN_OUT_SYSTEM_MEMORY), MFX_ERR_UNSUPPORTED);
+    MFX_CHECK(IsSupportedFourCC(in.FourCC) && IsSupportedFourCC(out.FourCC), MFX_ERR_UNSUPPORTED);
+
+    // no deinterlacing, weaving or splitting: fields are scaled as separate pictures
+    MFX_CHECK(IsFields(in.PicStruct) == IsFields(out.PicStruct), MFX_ERR_UNSUPPORTED);
+    MFX_CHECK(!(in.PicStruct & MFX_PICSTRUCT_FIELD_SINGLE) && !(out.PicStruct & MFX_PICSTRUCT_FIELD_SINGLE), MFX_ERR_UNSUPPORTED);
+
+    // no frame rate conversion
+    MFX_CHECK((mfxU64)in.FrameRateExtN * out.FrameRateExtD == (mfxU64)out.FrameRateExtN * in.FrameRateExtD, MFX_ERR_UNSUPPORTED);
+
+    std::vector<mfxU32> pipelineList;
+    mfxStatus sts = GetPipelineList(const_cast<mfxVideoParam*>(&par), pipelineList, true);
+    MFX_CHECK_STS(sts);
+
+    for (mfxU32 filter : pipelineList)
+    {
+        switch (filter)
+        {
+        case MFX_EXTBUFF_VPP_CSC:
+        case MFX_EXTBUFF_VPP_CSC_OUT_RGB4:
+        case MFX_EXTBUFF_VPP_RESIZE:
+        case MFX_EXTBUFF_VPP_RSHIFT_IN:
+        case MFX_EXTBUFF_VPP_LSHIFT_OUT:
+        case MFX_EXTBUFF_VPP_SCALING:
+        case MFX_EXTBUFF_VPP_VIDEO_SIGNAL_INFO:
+        case MFX_EXTBUFF_VPP_COMPOSITE:
+            break;
+        default:
+            MFX_RETURN(MFX_ERR_UNSUPPORTED);
+        }
+    }
+
+    mfxExtVPPComposite* comp = (mfxExtVPPComposite*)GetExtBuffer(par, MFX_EXTBUFF_VPP_COMPOSITE);
+    if (comp)
+    {
+        MFX_CHECK(comp->NumTiles == 0 && comp->NumInputStream && comp->InputStream, MFX_ERR_UNSUPPORTED);
+
+        for (mfxU32 i = 0; i < comp->NumInputStream; i++)
+            MFX_CHECK(!comp->InputStream[i].LumaKeyEnable, MFX_ERR_UNSUPPORTED);
+    }
+
+    mfxExtVPPVideoSignalInfo* vsi = (mfxExtVPPVideoSignalInfo*)GetExtBuffer(par, MFX_EXTBUFF_VPP_VIDEO_SIGNAL_INFO);
+    if (vsi && in.FourCC != MFX_FOURCC_RGB4 && out.FourCC != MFX_FOURCC_RGB4)
+    {
+        // YUV to YUV is a plain copy of the samples
+        MFX_CHECK(vsi->In.TransferMatrix == vsi->Out.TransferMatrix && vsi->In.NominalRange == vsi->Out.NominalRange, MFX_ERR_UNSUPPORTED);
+    }
+
+    return MFX_ERR_NONE;
+}
+
+/* ******************************************************************** */
+/*                            color matrices                            */
+/* ******************************************************************** */
+
+static void GetKrKb(mfxU16 matrix, double & kr, double & kb)
+{
+    if (matrix == MFX_TRANSFERMATRIX_BT709)
+    {
+        kr = 0.2126; kb = 0.0722;
+    }
+    else
+    {
+        kr = 0.299;  kb = 0.114;
+    }
+}
+
+static void GetRange(mfxU16 range, double & ys, double & cs, double & yo, double & co)
+{
+    co = 128.0;
+    if (range == MFX_NOMINALRANGE_0_255)
+    {
+        ys = cs = 1.0; yo = 0.0;
+    }
+    else
+    {
+        ys = 219.0 / 255.0; cs = 224.0 / 255.0; yo = 16.0;
+    }
+}
+
+// rows produce Y, U, V from (R, G, B, 1)
+static void GetRgbToYuv(mfxU16 matrix, mfxU16 range, float m[3][4])
+{
+    double kr, kb, ys, cs, yo, co;
+    GetKrKb(matrix, kr, kb);
+    GetRange(range, ys, cs, yo, co);
+    const double kg = 1.0 - kr - kb;
+
+    const double rows[3][4] =
+    {
+        {  ys * kr,                      ys * kg,                      ys * kb,                      yo },
+        { -cs * kr / (2.0 * (1.0 - kb)), -cs * kg / (2.0 * (1.0 - kb)), cs / 2.0,                     co },
+        {  cs / 2.0,                     -cs * kg / (2.0 * (1.0 - kr)), -cs * kb / (2.0 * (1.0 - kr)), co },
+    };
+
+    for (mfxU32 i = 0; i < 3; i++)
+        for (mfxU32 j = 0; j < 4; j++)
+            m[i][j] = (float)rows[i][j];
+}
+
+// rows produce B, G, R (the order of the canvas planes) from (Y, U, V, 1)
+static void GetYuvToBgr(mfxU16 matrix, mfxU16 range, float m[3][4])
+{
+    double kr, kb, ys, cs, yo, co;
+    GetKrKb(matrix, kr, kb);
+    GetRange(range, ys, cs, yo, co);
+    const double kg = 1.0 - kr - kb;
+
+    const double y  = 1.0 / ys;
+    const double bu = 2.0 * (1.0 - kb) / cs;
+    const double rv = 2.0 * (1.0 - kr) / cs;
+    const double gu = -2.0 * kb * (1.0 - kb) / kg / cs;
+    const double gv = -2.0 * kr * (1.0 - kr) / kg / cs;
+
+    const double rows[3][4] =
+    {
+        { y, bu,  0.0, -y * yo - bu * co           },
+        { y, gu,  gv,  -y * yo - gu * co - gv * co },
+        { y, 0.0, rv,  -y * yo - rv * co           },
+    };
+
+    for (mfxU32 i = 0; i < 3; i++)
+        for (mfxU32 j = 0; j < 4; j++)
+            m[i][j] = (float)rows[i][j];
+}
+
+/* ******************************************************************** */
+/*                          CpuVideoProcessing                          */
+/* ******************************************************************** */
+
+CpuVideoProcessing::CpuVideoProcessing(VideoCORE *core)
+    : m_core(core)
+    , m_kernels()
+    , m_numThreads(1)
+    , m_filter(FILTER_BICUBIC)
+    , m_inMatrix(MFX_TRANSFERMATRIX_BT601)
+    , m_inRange(MFX_NOMINALRANGE_16_235)
+    , m_outMatrix(MFX_TRANSFERMATRIX_BT601)
+    , m_outRange(MFX_NOMINALRANGE_16_235)
+    , m_composition(false)
+    , m_background()
+{
+}
+
+CpuVideoProcessing::~CpuVideoProcessing()
+{
+    Close();
+}
+
+static FilterKernel GetFilterKernel(mfxVideoParam const & par)
+{
+    mfxExtVPPScaling* scaling = (mfxExtVPPScaling*)GetExtBuffer(par, MFX_EXTBUFF_VPP_SCALING);
+    if (!scaling)
+        return FILTER_BICUBIC;
+
+#if (MFX_VERSION >= 1033)
+    switch (scaling->InterpolationMethod)
+    {
+    case MFX_INTERPOLATION_NEAREST_NEIGHBOR: return FILTER_NEAREST;
+    case MFX_INTERPOLATION_BILINEAR:         return FILTER_BILINEAR;
+    case MFX_INTERPOLATION_ADVANCED:         return FILTER_LANCZOS3;
+    default:                                 break;
+    }
+#endif
+
+    switch (scaling->ScalingMode)
+    {
+    case MFX_SCALING_MODE_LOWPOWER: return FILTER_BILINEAR;
+    case MFX_SCALING_MODE_QUALITY:  return FILTER_LANCZOS3;
+    default:                        return FILTER_BICUBIC;
+    }
+}
+
+mfxStatus CpuVideoProcessing::Init(mfxVideoParam const & par)
+{
+    mfxStatus sts = CheckParams(par);
+    MFX_CHECK_STS(sts);
+
+    Close();
+
+    m_filter = GetFilterKernel(par);
+
+    m_inMatrix  = m_outMatrix = MFX_TRANSFERMATRIX_BT601;
+    m_inRange   = m_outRange  = MFX_NOMINALRANGE_16_235;
+
+    mfxExtVPPVideoSignalInfo* vsi = (mfxExtVPPVideoSignalInfo*)GetExtBuffer(par, MFX_EXTBUFF_VPP_VIDEO_SIGNAL_INFO);
+    if (vsi)
+    {
+        if (vsi->In.TransferMatrix  != MFX_TRANSFERMATRIX_UNKNOWN) m_inMatrix  = vsi->In.TransferMatrix;
+        if (vsi->Out.TransferMatrix != MFX_TRANSFERMATRIX_UNKNOWN) m_outMatrix = vsi->Out.TransferMatrix;
+        if (vsi->In.NominalRange    != MFX_NOMINALRANGE_UNKNOWN)   m_inRange   = vsi->In.NominalRange;
+        if (vsi->Out.NominalRange   != MFX_NOMINALRANGE_UNKNOWN)   m_outRange  = vsi->Out.NominalRange;
+    }
+
+    m_streams.clear();
+    m_background[0] = m_background[1] = m_background[2] = 0;
+
+    mfxExtVPPComposite* comp = (mfxExtVPPComposite*)GetExtBuffer(par, MFX_EXTBUFF_VPP_COMPOSITE);
+    m_composition = (comp != NULL);
+
+    if (comp)
+    {
+        m_streams.assign(comp->InputStream, comp->InputStream + comp->NumInputStream);
+        m_background[0] = comp->Y;
+        m_background[1] = comp->U;
+        m_background[2] = comp->V;
+    }
+    else
+    {
+        // the only stream covers the output crop
+        mfxVPPCompInputStream stream = {};
+        stream.DstX = par.vpp.Out.CropX;
+        stream.DstY = par.vpp.Out.CropY;
+        stream.DstW = par.vpp.Out.CropW;
+        stream.DstH = par.vpp.Out.CropH;
+        m_streams.push_back(stream);
+    }
+
+    m_numThreads = 1;
+    if (m_core->GetSession() && m_core->GetSession()->m_pScheduler)
+    {
+        MFX_SCHEDULER_PARAM schedParam = {};
+        if (MFX_ERR_NONE == m_core->GetSession()->m_pScheduler->GetParam(&schedParam))
+            m_numThreads = std::max<mfxU32>(schedParam.numberOfThreads, 1);
+    }
+
+    GetCpuKernels(m_kernels);
+
+    m_setup.assign(m_streams.size(), std::shared_ptr<const StreamSetup>());
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus CpuVideoProcessing::Reset(mfxVideoParam const & par)
+{
+    return Init(par);
+}
+
+void CpuVideoProcessing::Close()
+{
+    std::lock_guard<std::mutex> guard(m_guard);
+
+    if (m_pending)
+        ReleaseTask(m_pending.release());
+
+    m_canvas.reset();
+    m_setup.clear();
+}
+
+mfxStatus CpuVideoProcessing::LockSurface(mfxFrameSurface1 *surf, mfxFrameSurface1 & locked, bool & isLocked)
+{
+    locked   = *surf;
+    isLocked = false;
+
+    if (!surf->Data.Y && !surf->Data.B && surf->Data.MemId)
+    {
+        mfxStatus sts = m_core->LockExternalFrame(surf->Data.MemId, &locked.Data);
+        MFX_CHECK_STS(sts);
+        isLocked = true;
+    }
+
+    MFX_CHECK(locked.Data.Y || locked.Data.B, MFX_ERR_LOCK_MEMORY);
+
+    return MFX_ERR_NONE;
+}
+
+void CpuVideoProcessing::UnlockSurface(mfxFrameSurface1 & locked, bool isLocked)
+{
+    if (isLocked)
+        m_core->UnlockExternalFrame(locked.Data.MemId, &locked.Data);
+}
+
+void CpuVideoProcessing::ReleaseTask(Task * task)
+{
+    for (size_t i = 0; i < task->surfIn.size(); i++)
+    {
+        UnlockSurface(task->in[i], task->lockedIn[i]);
+        m_core->DecreaseReference(&task->surfIn[i]->Data);
+    }
+
+    if (task->surfOut)
+    {
+        UnlockSurface(task->out, task->lockedOut);
+        m_core->DecreaseReference(&task->surfOut->Data);
+    }
+
+    delete task;
+}
+
+mfxStatus CpuVideoProcessing::CompleteTask(Task * task)
+{
+    MFX_CHECK_NULL_PTR1(task);
+
+    ReleaseTask(task);
+    return MFX_ERR_NONE;
+}
+
+std::shared_ptr<const CanvasSetup> CpuVideoProcessing::GetCanvasSetup(mfxFrameInfo const & out)
+{
+    bool fields = IsFields(out.PicStruct);
+
+    if (m_canvas
+        && m_canvas->info.FourCC == out.FourCC
+        && m_canvas->info.Shift  == out.Shift
+        && m_canvas->info.CropX  == out.CropX
+        && m_canvas->info.CropY  == out.CropY
+        && m_canvas->info.CropW  == out.CropW
+        && m_canvas->info.CropH  == out.CropH
+        && m_canvas->fields      == fields)
+    {
+        return m_canvas;
+    }
+
+    std::shared_ptr<CanvasSetup> cv = std::make_shared<CanvasSetup>();
+
+    cv->info      = out;
+    cv->rgb       = (out.FourCC == MFX_FOURCC_RGB4);
+    cv->fields    = fields;
+    cv->numPlanes = cv->rgb ? 4 : 3;
+    cv->crop      = GetCrop(out, fields);
+    GetSubsampling(out.FourCC, cv->subX, cv->subY);
+
+    if (cv->rgb)
+    {
+        // B, G, R, A
+        cv->background[0] = m_background[2];
+        cv->background[1] = m_background[1];
+        cv->background[2] = m_background[0];
+        cv->background[3] = 255.f;
+    }
+    else
+    {
+        const float scale = (out.FourCC == MFX_FOURCC_P010) ? 0.25f : 1.f;
+        cv->background[0] = m_background[0] * scale;
+        cv->background[1] = m_background[1] * scale;
+        cv->background[2] = m_background[2] * scale;
+        cv->background[3] = 0.f;
+    }
+
+    // the background shows through unless one opaque stream covers everything
+    cv->fillBackground = false;
+    if (m_composition)
+    {
+        cv->fillBackground = true;
+        for (mfxVPPCompInputStream const & s : m_streams)
+        {
+            bool opaque = !s.PixelAlphaEnable && (!s.GlobalAlphaEnable || s.GlobalAlpha >= 255);
+            if (opaque && s.DstX <= out.CropX && s.DstY <= out.CropY
+                && s.DstX + s.DstW >= (mfxU32)out.CropX + out.CropW
+                && s.DstY + s.DstH >= (mfxU32)out.CropY + out.CropH)
+            {
+                cv->fillBackground = false;
+            }
+        }
+    }
+
+    // two tiles per thread give the scheduler some room to balance
+    const mfxU32 height = (mfxU32)std::max(cv->crop.h, 1);
+    if (m_numThreads <= 1)
+        cv->tileRows = mfx::align2_value(height, BAND_ROWS);
+    else
+        cv->tileRows = std::max<mfxU32>(32, mfx::align2_value((height + 2 * m_numThreads - 1) / (2 * m_numThreads), BAND_ROWS));
+    cv->tilesPerPicture = (height + cv->tileRows - 1) / cv->tileRows;
+
+    m_canvas = cv;
+    m_setup.assign(m_streams.size(), std::shared_ptr<const StreamSetup>());
+
+    return m_canvas;
+}
+
+std::shared_ptr<const StreamSetup> CpuVideoProcessing::GetStreamSetup(mfxU32 stream, mfxFrameInfo const & src, CanvasSetup const & cv)
+{
+    std::shared_ptr<const StreamSetup> & cached = m_setup[stream];
+
+    if (cached
+        && cached->srcInfo.FourCC == src.FourCC
+        && cached->srcInfo.Shift  == src.Shift
+        && cached->srcInfo.CropX  == src.CropX
+        && cached->srcInfo.CropY  == src.CropY
+        && cached->srcInfo.CropW  == src.CropW
+        && cached->srcInfo.CropH  == src.CropH)
+    {
+        return cached;
+    }
+
+    std::shared_ptr<StreamSetup> st = std::make_shared<StreamSetup>();
+    mfxVPPCompInputStream const & s = m_streams[stream];
+
+    st->srcInfo     = src;
+    st->globalAlpha = s.GlobalAlphaEnable ? std::min<mfxU16>(s.GlobalAlpha, 255) / 255.f : 1.f;
+
+    // destination rectangle in canvas luma samples, aligned to the chroma grid
+    mfxI32 x0 = (mfxI32)s.DstX - (mfxI32)cv.info.CropX;
+    mfxI32 x1 = x0 + (mfxI32)s.DstW;
+    mfxI32 y0 = (mfxI32)s.DstY - (mfxI32)cv.info.CropY;
+    mfxI32 y1 = y0 + (mfxI32)s.DstH;
+
+    if (cv.fields)
+    {
+        y0 >>= 1;
+        y1 >>= 1;
+    }
+
+    x0 = Clip(x0 & ~((1 << cv.subX) - 1), 0, cv.crop.w);
+    y0 = Clip(y0 & ~((1 << cv.subY) - 1), 0, cv.crop.h);
+    x1 = Clip(CeilShift(x1, cv.subX) << cv.subX, x0, cv.crop.w);
+    y1 = Clip(CeilShift(y1, cv.subY) << cv.subY, y0, cv.crop.h);
+
+    st->rect.x = x0;
+    st->rect.y = y0;
+    st->rect.w = x1 - x0;
+    st->rect.h = y1 - y0;
+
+    const Rect crop = GetCrop(src, cv.fields);
+    const bool rgbSrc = (src.FourCC == MFX_FOURCC_RGB4);
+    mfxU32 srcSubX, srcSubY;
+    GetSubsampling(src.FourCC, srcSubX, srcSubY);
+
+    st->toRgb      = cv.rgb && !rgbSrc;
+    st->pixelAlpha = rgbSrc && s.PixelAlphaEnable;
+
+    if (rgbSrc && !cv.rgb)
+        GetRgbToYuv(m_outMatrix, m_outRange, st->matrix);
+    else if (st->toRgb)
+        GetYuvToBgr(m_inMatrix, m_inRange, st->matrix);
+    else
+        memset(st->matrix, 0, sizeof(st->matrix));
+
+    auto setupPlane = [&](PlaneSetup & ps, Component c, mfxU32 ssx, mfxU32 ssy, mfxU32 dsx, mfxU32 dsy)
+    {
+        ps.component = c;
+
+        ps.src.x = crop.x >> ssx;
+        ps.src.y = crop.y >> ssy;
+        ps.src.w = std::max(CeilShift(crop.x + crop.w, ssx) - ps.src.x, 1);
+        ps.src.h = std::max(CeilShift(crop.y + crop.h, ssy) - ps.src.y, 1);
+
+        ps.dst.x = st->rect.x >> dsx;
+        ps.dst.y = st->rect.y >> dsy;
+        ps.dst.w = CeilShift(st->rect.x + st->rect.w, dsx) - ps.dst.x;
+        ps.dst.h = CeilShift(st->rect.y + st->rect.h, dsy) - ps.dst.y;
+
+        BuildFilterTable(ps.horz, ps.src.w, std::max(ps.dst.w, 1), m_filter, true);
+        BuildFilterTable(ps.vert, ps.src.h, std::max(ps.dst.h, 1), m_filter, false);
+    };
+
+    if (cv.rgb && rgbSrc)
+    {
+        st->numPlanes = 4;
+        for (mfxU32 p = 0; p < 4; p++)
+            setupPlane(st->plane[p], (Component)(COMP_B + p), 0, 0, 0, 0);
+    }
+    else if (cv.rgb)
+    {
+        // all planes at full resolution, converted to B, G, R after resampling
+        st->numPlanes = 3;
+        for (mfxU32 p = 0; p < 3; p++)
+            setupPlane(st->plane[p], (Component)(COMP_Y + p), p ? srcSubX : 0, p ? srcSubY : 0, 0, 0);
+    }
+    else if (rgbSrc)
+    {
+        st->numPlanes = 3;
+        for (mfxU32 p = 0; p < 3; p++)
+            setupPlane(st->plane[p], (Component)(COMP_RGB_Y + p), 0, 0, p ? cv.subX : 0, p ? cv.subY : 0);
+    }
+    else
+    {
+        st->numPlanes = 3;
+        for (mfxU32 p = 0; p < 3; p++)
+            setupPlane(st->plane[p], (Component)(COMP_Y + p), p ? srcSubX : 0, p ? srcSubY : 0, p ? cv.subX : 0, p ? cv.subY : 0);
+    }
+
+    if (st->pixelAlpha)
+        setupPlane(st->alpha, COMP_A, 0, 0, 0, 0);
+
+    cached = st;
+    return cached;
+}
+
+Workspace* CpuVideoProcessing::AcquireWorkspace()
+{
+    std::lock_guard<std::mutex> guard(m_wsGuard);
+
+    if (m_freeWorkspaces.empty())
+    {
+        m_workspaces.emplace_back(new Workspace);
+        return m_workspaces.back().get();
+    }
+
+    Workspace* ws = m_freeWorkspaces.back();
+    m_freeWorkspaces.pop_back();
+    return ws;
+}
+
+void CpuVideoProcessing::ReleaseWorkspace(Workspace * ws)
+{
+    std::lock_guard<std::mutex> guard(m_wsGuard);
+    m_freeWorkspaces.push_back(ws);
+}
+
+mfxStatus CpuVideoProcessing::FrameCheck(mfxFrameSurface1 *in, mfxFrameSurface1 *out, Task *& task)
+{
+    task = NULL;
+
+    // nothing is buffered between frames
+    MFX_CHECK(in, MFX_ERR_MORE_DATA);
+    MFX_CHECK_NULL_PTR1(out);
+
+    std::lock_guard<std::mutex> guard(m_guard);
+
+    if (!m_pending)
+    {
+        m_pending.reset(new Task());
+        m_pending->surfOut   = NULL;
+        m_pending->lockedOut = false;
+        m_pending->numTiles  = 0;
+    }
+
+    Task & t = *m_pending;
+
+    mfxFrameSurface1 locked;
+    bool isLocked = false;
+    mfxStatus sts = LockSurface(in, locked, isLocked);
+    MFX_CHECK_STS(sts);
+
+    m_core->IncreaseReference(&in->Data);
+    t.surfIn.push_back(in);
+    t.in.push_back(locked);
+    t.lockedIn.push_back(isLocked);
+
+    // inputs of a composition arrive one per call
+    if (t.surfIn.size() < m_streams.size())
+        return MFX_ERR_MORE_DATA;
+
+    std::unique_ptr<Task> ready(m_pending.release());
+
+    sts = LockSurface(out, ready->out, ready->lockedOut);
+    if (sts != MFX_ERR_NONE)
+    {
+        ReleaseTask(ready.release());
+        MFX_RETURN(sts);
+    }
+
+    m_core->IncreaseReference(&out->Data);
+    ready->surfOut = out;
+
+    ready->canvas = GetCanvasSetup(out->Info);
+    for (mfxU32 i = 0; i < ready->in.size(); i++)
+        ready->setup.push_back(GetStreamSetup(i, ready->in[i].Info, *ready->canvas));
+
+    ready->numTiles = ready->canvas->tilesPerPicture * (ready->canvas->fields ? 2 : 1);
+
+    task = ready.release();
+    return MFX_ERR_NONE;
+}
+
+/* ******************************************************************** */
+/*                           tile processing                            */
+/* ******************************************************************** */
+
+static inline mfxU32 PlaneShiftX(CanvasSetup const & cv, mfxU32 p)
+{
+    return (cv.rgb || p == 0) ? 0 : cv.subX;
+}
+
+static inline mfxU32 PlaneShiftY(CanvasSetup const & cv, mfxU32 p)
+{
+    return (cv.rgb || p == 0) ? 0 : cv.subY;
+}
+
+static inline mfxI32 PlaneWidth(CanvasSetup const & cv, mfxU32 p)
+{
+    return CeilShift(cv.crop.w, PlaneShiftX(cv, p));
+}
+
+// unpacks w samples of one source component starting at (x, row) in plane samples
+static void FetchRow(CpuKernels const & k, View const & v, StreamSetup const & st, Component c,
+                     mfxI32 row, mfxI32 x, mfxI32 w, float *dst, Workspace & ws)
+{
+    switch (v.fourCC)
+    {
+    case MFX_FOURCC_NV12:
+        if (c == COMP_Y)
+            k.UnpackRow8(v.ptr[0] + row * v.pitch[0] + x, 1, dst, w);
+        else
+            k.UnpackRow8(v.ptr[1] + row * v.pitch[1] + 2 * x + (c == COMP_V), 2, dst, w);
+        break;
+
+    case MFX_FOURCC_P010:
+        if (c == COMP_Y)
+            k.UnpackRow16((mfxU16*)(v.ptr[0] + row * v.pitch[0]) + x, 1, v.shift, dst, w);
+        else
+            k.UnpackRow16((mfxU16*)(v.ptr[1] + row * v.pitch[1]) + 2 * x + (c == COMP_V), 2, v.shift, dst, w);
+        break;
+
+    case MFX_FOURCC_YV12:
+        k.UnpackRow8(v.ptr[c - COMP_Y] + row * v.pitch[c - COMP_Y] + x, 1, dst, w);
+        break;
+
+    case MFX_FOURCC_YUY2:
+        if (c == COMP_Y)
+            k.UnpackRow8(v.ptr[0] + row * v.pitch[0] + 2 * x, 2, dst, w);
+        else
+            k.UnpackRow8(v.ptr[0] + row * v.pitch[0] + 4 * x + (c == COMP_U ? 1 : 3), 4, dst, w);
+        break;
+
+    case MFX_FOURCC_RGB4:
+    {
+        mfxU8* line = v.ptr[0] + row * v.pitch[0] + 4 * x;
+
+        if (c >= COMP_B && c <= COMP_A)
+        {
+            k.UnpackRow8(line + (c - COMP_B), 4, dst, w);
+            break;
+        }
+
+        for (mfxU32 i = 0; i < 3; i++)
+        {
+            Grow(ws.fetch[1 + i], w);
+            k.UnpackRow8(line + 2 - i, 4, ws.fetch[1 + i].data(), w); // R, G, B
+        }
+        k.Combine3(ws.fetch[1].data(), ws.fetch[2].data(), ws.fetch[3].data(), st.matrix[c - COMP_RGB_Y], dst, w);
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+// source row (relative to the plane crop) after the horizontal pass
+static const float* GetSourceRow(CpuKernels const & k, View const & v, StreamSetup const & st, PlaneSetup const & ps,
+                                 RowCache & cache, mfxI32 row, Workspace & ws)
+{
+    const mfxI32 slot = row % cache.rows;
+    float* dst = &cache.data[(size_t)slot * cache.width];
+
+    if (cache.tag[slot] != row)
+    {
+        if (ps.horz.identity)
+        {
+            FetchRow(k, v, st, ps.component, ps.src.y + row, ps.src.x, ps.src.w, dst, ws);
+        }
+        else
+        {
+            Grow(ws.fetch[0], ps.src.w);
+            FetchRow(k, v, st, ps.component, ps.src.y + row, ps.src.x, ps.src.w, ws.fetch[0].data(), ws);
+            k.HorzFilter(ws.fetch[0].data(), dst, ps.horz.start.data(), ps.horz.coef.data(), ps.horz.taps, ps.dst.w);
+        }
+        cache.tag[slot] = row;
+    }
+
+    return dst;
+}
+
+// output row (in canvas plane samples) of a plane after both passes
+static const float* ProduceRow(CpuKernels const & k, View const & v, StreamSetup const & st, PlaneSetup const & ps,
+                               RowCache & cache, mfxI32 row, float *tmp, Workspace & ws)
+{
+    const mfxI32 i     = row - ps.dst.y;
+    const mfxI32 taps  = ps.vert.taps;
+    const mfxI32 start = ps.vert.start[i];
+
+    // consecutive source rows never share a slot, so the pointers stay valid
+    Grow(ws.taps, taps);
+    for (mfxI32 t = 0; t < taps; t++)
+        ws.taps[t] = GetSourceRow(k, v, st, ps, cache, start + t, ws);
+
+    if (taps == 1)
+        return ws.taps[0];
+
+    k.VertFilter(ws.taps.data(), &ps.vert.coef[(size_t)i * taps], taps, tmp, ps.dst.w);
+    return tmp;
+}
+
+static void ResetCache(RowCache & cache, PlaneSetup const & ps)
+{
+    cache.width = ps.dst.w;
+    cache.rows  = ps.vert.taps;
+    Grow(cache.data, (size_t)cache.width * cache.rows);
+    cache.tag.assign(cache.rows, -1);
+}
+
+static void EmitRow(CpuKernels const & k, Workspace & ws, CanvasSetup const & cv, mfxU32 p, mfxI32 bandRow,
+                    mfxI32 x, const float *src, mfxI32 w, const float *alpha, mfxI32 alphaStep, float globalAlpha)
+{
+    float* dst = &ws.canvas[p][(size_t)bandRow * PlaneWidth(cv, p) + x];
+
+    if (!alpha && globalAlpha >= 1.f)
+        memcpy(dst, src, w * sizeof(float));
+    else
+        k.BlendRow(src, alpha, alphaStep, globalAlpha, dst, w);
+}
+
+static void DrawStream(CpuKernels const & k, Workspace & ws, CanvasSetup const & cv, StreamSetup const & st,
+                       View const & v, RowCache *cache, mfxI32 b0, mfxI32 b1)
+{
+    const Rect & r = st.rect;
+
+    // clipped away by the canvas
+    if (r.w <= 0 || r.h <= 0)
+        return;
+
+    if (st.pixelAlpha)
+    {
+        PlaneSetup const & pa = st.alpha;
+        Grow(ws.alpha, (size_t)BAND_ROWS * pa.dst.w);
+
+        for (mfxI32 row = std::max(b0, pa.dst.y); row < std::min(b1, pa.dst.y + pa.dst.h); row++)
+        {
+            float* dst = &ws.alpha[(size_t)(row - b0) * pa.dst.w];
+            const float* src = ProduceRow(k, v, st, pa, cache[4], row, dst, ws);
+            if (src != dst)
+                memcpy(dst, src, pa.dst.w * sizeof(float));
+        }
+    }
+
+    if (st.toRgb)
+    {
+        Grow(ws.bgr, r.w);
+        Grow(ws.opaque, r.w);
+        std::fill(ws.opaque.begin(), ws.opaque.begin() + r.w, 255.f);
+
+        for (mfxI32 row = std::max(b0, r.y); row < std::min(b1, r.y + r.h); row++)
+        {
+            const float* yuv[3];
+            for (mfxU32 p = 0; p < 3; p++)
+            {
+                Grow(ws.out[p], r.w);
+                yuv[p] = ProduceRow(k, v, st, st.plane[p], cache[p], row, ws.out[p].data(), ws);
+            }
+
+            for (mfxU32 c = 0; c < 3; c++)
+            {
+                k.Combine3(yuv[0], yuv[1], yuv[2], st.matrix[c], ws.bgr.data(), r.w);
+                EmitRow(k, ws, cv, c, row - b0, r.x, ws.bgr.data(), r.w, NULL, 1, st.globalAlpha);
+            }
+            EmitRow(k, ws, cv, 3, row - b0, r.x, ws.opaque.data(), r.w, NULL, 1, st.globalAlpha);
+        }
+        return;
+    }
+
+    for (mfxU32 p = 0; p < st.numPlanes; p++)
+    {
+        PlaneSetup const & ps = st.plane[p];
+        const mfxU32 sx  = PlaneShiftX(cv, p);
+        const mfxU32 sy  = PlaneShiftY(cv, p);
+        const mfxI32 pb0 = b0 >> sy;
+        const mfxI32 pb1 = CeilShift(b1, sy);
+
+        Grow(ws.out[0], ps.dst.w);
+
+        for (mfxI32 row = std::max(pb0, ps.dst.y); row < std::min(pb1, ps.dst.y + ps.dst.h); row++)
+        {
+            const float* src   = ProduceRow(k, v, st, ps, cache[p], row, ws.out[0].data(), ws);
+            const float* alpha = NULL;
+
+            if (st.pixelAlpha)
+                alpha = &ws.alpha[(size_t)((row << sy) - b0) * st.alpha.dst.w + ((ps.dst.x << sx) - st.alpha.dst.x)];
+
+            EmitRow(k, ws, cv, p, row - pb0, ps.dst.x, src, ps.dst.w, alpha, 1 << sx, st.globalAlpha);
+        }
+    }
+}
+
+static void PackBand(CpuKernels const & k, Workspace & ws, CanvasSetup const & cv, View const & v, mfxI32 b0, mfxI32 b1)
+{
+    const mfxI32 cw  = PlaneWidth(cv, 1);
+    const mfxI32 cx  = cv.crop.x >> cv.subX;
+    const mfxI32 cy  = cv.crop.y >> cv.subY;
+    const mfxI32 cb0 = b0 >> cv.subY;
+    const mfxI32 cb1 = CeilShift(b1, cv.subY);
+
+    switch (v.fourCC)
+    {
+    case MFX_FOURCC_NV12:
+        for (mfxI32 row = b0; row < b1; row++)
+            k.PackRow8(&ws.canvas[0][(size_t)(row - b0) * cv.crop.w], v.ptr[0] + (cv.crop.y + row) * v.pitch[0] + cv.crop.x, 1, cv.crop.w);
+        for (mfxI32 row = cb0; row < cb1; row++)
+            k.PackUV8(&ws.canvas[1][(size_t)(row - cb0) * cw], &ws.canvas[2][(size_t)(row - cb0) * cw],
+                      v.ptr[1] + (cy + row) * v.pitch[1] + 2 * cx, cw);
+        break;
+
+    case MFX_FOURCC_P010:
+        for (mfxI32 row = b0; row < b1; row++)
+            k.PackRow16(&ws.canvas[0][(size_t)(row - b0) * cv.crop.w], (mfxU16*)(v.ptr[0] + (cv.crop.y + row) * v.pitch[0]) + cv.crop.x, 1, v.shift, cv.crop.w);
+        for (mfxI32 row = cb0; row < cb1; row++)
+            k.PackUV16(&ws.canvas[1][(size_t)(row - cb0) * cw], &ws.canvas[2][(size_t)(row - cb0) * cw],
+                       (mfxU16*)(v.ptr[1] + (cy + row) * v.pitch[1]) + 2 * cx, v.shift, cw);
+        break;
+
+    case MFX_FOURCC_YV12:
+        for (mfxI32 row = b0; row < b1; row++)
+            k.PackRow8(&ws.canvas[0][(size_t)(row - b0) * cv.crop.w], v.ptr[0] + (cv.crop.y + row) * v.pitch[0] + cv.crop.x, 1, cv.crop.w);
+        for (mfxU32 p = 1; p < 3; p++)
+            for (mfxI32 row = cb0; row < cb1; row++)
+                k.PackRow8(&ws.canvas[p][(size_t)(row - cb0) * cw], v.ptr[p] + (cy + row) * v.pitch[p] + cx, 1, cw);
+        break;
+
+    case MFX_FOURCC_YUY2:
+        for (mfxI32 row = b0; row < b1; row++)
+        {
+            mfxU8* line = v.ptr[0] + (cv.crop.y + row) * v.pitch[0];
+            k.PackRow8(&ws.canvas[0][(size_t)(row - b0) * cv.crop.w], line + 2 * cv.crop.x, 2, cv.crop.w);
+            k.PackRow8(&ws.canvas[1][(size_t)(row - b0) * cw], line + 4 * cx + 1, 4, cw);
+            k.PackRow8(&ws.canvas[2][(size_t)(row - b0) * cw], line + 4 * cx + 3, 4, cw);
+        }
+        break;
+
+    case MFX_FOURCC_RGB4:
+        for (mfxI32 row = b0; row < b1; row++)
+        {
+            mfxU8* line = v.ptr[0] + (cv.crop.y + row) * v.pitch[0] + 4 * cv.crop.x;
+            for (mfxU32 p = 0; p < 4; p++)
+                k.PackRow8(&ws.canvas[p][(size_t)(row - b0) * cv.crop.w], line + p, 4, cv.crop.w);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+mfxStatus CpuVideoProcessing::ProcessTile(Task const & task, mfxU32 tile)
+{
+    CanvasSetup const & cv = *task.canvas;
+
+    MFX_CHECK(tile < task.numTiles, MFX_ERR_UNDEFINED_BEHAVIOR);
+
+    const mfxU32 field = tile / cv.tilesPerPicture;
+    const mfxI32 y0    = (mfxI32)((tile % cv.tilesPerPicture) * cv.tileRows);
+    const mfxI32 y1    = std::min(y0 + (mfxI32)cv.tileRows, cv.crop.h);
+
+    Workspace* ws = AcquireWorkspace();
+
+    const View out = MakeView(task.out, cv.fields, field);
+    const size_t numStreams = task.in.size();
+
+    std::vector<View> in(numStreams);
+    Grow(ws->cache, numStreams * 5);
+
+    for (size_t s = 0; s < numStreams; s++)
+    {
+        StreamSetup const & st = *task.setup[s];
+        in[s] = MakeView(task.in[s], cv.fields, field);
+
+        for (mfxU32 p = 0; p < st.numPlanes; p++)
+            ResetCache(ws->cache[s * 5 + p], st.plane[p]);
+        if (st.pixelAlpha)
+            ResetCache(ws->cache[s * 5 + 4], st.alpha);
+    }
+
+    for (mfxU32 p = 0; p < cv.numPlanes; p++)
+        Grow(ws->canvas[p], (size_t)BAND_ROWS * PlaneWidth(cv, p));
+
+    for (mfxI32 b0 = y0; b0 < y1; b0 += BAND_ROWS)
+    {
+        const mfxI32 b1 = std::min(b0 + BAND_ROWS, y1);
+
+        if (cv.fillBackground)
+        {
+            for (mfxU32 p = 0; p < cv.numPlanes; p++)
+            {
+                const mfxI32 rows = CeilShift(b1, PlaneShiftY(cv, p)) - (b0 >> PlaneShiftY(cv, p));
+                std::fill(ws->canvas[p].begin(), ws->canvas[p].begin() + (size_t)rows * PlaneWidth(cv, p), cv.background[p]);
+            }
+        }
+
+        for (size_t s = 0; s < numStreams; s++)
+            DrawStream(m_kernels, *ws, cv, *task.setup[s], in[s], &ws->cache[s * 5], b0, b1);
+
+        PackBand(m_kernels, *ws, cv, out, b0, b1);
+    }
+
+    ReleaseWorkspace(ws);
+
+    return MFX_ERR_NONE;
+}
+
+} // namespace MfxCpuVideoProcessing
+
+#endif // MFX_ENABLE_VPP
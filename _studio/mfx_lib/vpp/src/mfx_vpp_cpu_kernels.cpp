@@ -0,0 +1,153 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_vpp_cpu_kernels.h"
+
+#include <math.h>
+
+namespace MfxCpuVideoProcessing
+{
+
+static inline mfxI32 Round(float v)
+{
+    // same rounding (to nearest even) as cvtps2dq
+    return (mfxI32)lrintf(v);
+}
+
+static inline mfxI32 Saturate(mfxI32 v, mfxI32 maxVal)
+{
+    return v < 0 ? 0 : (v > maxVal ? maxVal : v);
+}
+
+void UnpackRow8_C(const mfxU8 *src, mfxI32 step, float *dst, mfxI32 width)
+{
+    for (mfxI32 i = 0; i < width; i++)
+        dst[i] = (float)src[i * step];
+}
+
+void UnpackRow16_C(const mfxU16 *src, mfxI32 step, mfxI32 shift, float *dst, mfxI32 width)
+{
+    for (mfxI32 i = 0; i < width; i++)
+        dst[i] = (float)(src[i * step] >> shift) * 0.25f;
+}
+
+void PackRow8_C(const float *src, mfxU8 *dst, mfxI32 step, mfxI32 width)
+{
+    for (mfxI32 i = 0; i < width; i++)
+        dst[i * step] = (mfxU8)Saturate(Round(src[i]), 255);
+}
+
+void PackRow16_C(const float *src, mfxU16 *dst, mfxI32 step, mfxI32 shift, mfxI32 width)
+{
+    for (mfxI32 i = 0; i < width; i++)
+        dst[i * step] = (mfxU16)(Saturate(Round(src[i] * 4.f), 1023) << shift);
+}
+
+void PackUV8_C(const float *u, const float *v, mfxU8 *dst, mfxI32 width)
+{
+    PackRow8_C(u, dst,     2, width);
+    PackRow8_C(v, dst + 1, 2, width);
+}
+
+void PackUV16_C(const float *u, const float *v, mfxU16 *dst, mfxI32 shift, mfxI32 width)
+{
+    PackRow16_C(u, dst,     2, shift, width);
+    PackRow16_C(v, dst + 1, 2, shift, width);
+}
+
+void HorzFilter_C(const float *src, float *dst, const mfxI32 *start, const float *coef, mfxI32 taps, mfxI32 width)
+{
+    for (mfxI32 i = 0; i < width; i++)
+    {
+        const float *s = src + start[i];
+        float acc = 0.f;
+        for (mfxI32 k = 0; k < taps; k++)
+            acc += coef[k * width + i] * s[k];
+        dst[i] = acc;
+    }
+}
+
+void VertFilter_C(const float * const *rows, const float *coef, mfxI32 taps, float *dst, mfxI32 width)
+{
+    for (mfxI32 i = 0; i < width; i++)
+    {
+        float acc = 0.f;
+        for (mfxI32 k = 0; k < taps; k++)
+            acc += coef[k] * rows[k][i];
+        dst[i] = acc;
+    }
+}
+
+void Combine3_C(const float *a, const float *b, const float *c, const float m[4], float *dst, mfxI32 width)
+{
+    for (mfxI32 i = 0; i < width; i++)
+        dst[i] = m[0] * a[i] + m[1] * b[i] + m[2] * c[i] + m[3];
+}
+
+void BlendRow_C(const float *src, const float *alpha, mfxI32 alphaStep, float globalAlpha, float *dst, mfxI32 width)
+{
+    if (!alpha)
+    {
+        for (mfxI32 i = 0; i < width; i++)
+            dst[i] += (src[i] - dst[i]) * globalAlpha;
+        return;
+    }
+
+    const float scale = globalAlpha * (1.f / 255.f);
+    for (mfxI32 i = 0; i < width; i++)
+    {
+        float a = alpha[i * alphaStep] * scale;
+        a = a < 0.f ? 0.f : (a > 1.f ? 1.f : a);
+        dst[i] += (src[i] - dst[i]) * a;
+    }
+}
+
+void GetCpuKernels(CpuKernels & kernels, bool allowSimd)
+{
+    kernels.UnpackRow8  = UnpackRow8_C;
+    kernels.UnpackRow16 = UnpackRow16_C;
+    kernels.PackRow8    = PackRow8_C;
+    kernels.PackRow16   = PackRow16_C;
+    kernels.PackUV8     = PackUV8_C;
+    kernels.PackUV16    = PackUV16_C;
+    kernels.HorzFilter  = HorzFilter_C;
+    kernels.VertFilter  = VertFilter_C;
+    kernels.Combine3    = Combine3_C;
+    kernels.BlendRow    = BlendRow_C;
+
+#if defined(MFX_VPP_CPU_AVX2)
+    if (allowSimd && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        kernels.UnpackRow8  = UnpackRow8_AVX2;
+        kernels.UnpackRow16 = UnpackRow16_AVX2;
+        kernels.PackRow8    = PackRow8_AVX2;
+        kernels.PackRow16   = PackRow16_AVX2;
+        kernels.PackUV8     = PackUV8_AVX2;
+        kernels.PackUV16    = PackUV16_AVX2;
+        kernels.HorzFilter  = HorzFilter_AVX2;
+        kernels.VertFilter  = VertFilter_AVX2;
+        kernels.Combine3    = Combine3_AVX2;
+    }
+#else
+    (void)allowSimd;
+#endif
+}
+
+} // namespace MfxCpuVideoProcessing
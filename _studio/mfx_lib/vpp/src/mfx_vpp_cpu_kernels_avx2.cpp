@@ -0,0 +1,255 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// The only vpp source built with -mavx2 -mfma (the vpp_cpu_avx2 object
+// library). Each kernel runs 8 or 16 samples per iteration and passes the
+// remainder of the row to its C variant.
+
+#include "mfx_vpp_cpu_kernels.h"
+
+#if defined(MFX_VPP_CPU_AVX2)
+
+#include <immintrin.h>
+
+namespace MfxCpuVideoProcessing
+{
+
+void UnpackRow8_AVX2(const mfxU8 *src, mfxI32 step, float *dst, mfxI32 width)
+{
+    mfxI32 i = 0;
+
+    if (step == 1)
+    {
+        for (; i + 8 <= width; i += 8)
+        {
+            __m128i p = _mm_loadl_epi64((const __m128i *)(src + i));
+            _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(p)));
+        }
+    }
+    else if (step == 2)
+    {
+        // every other byte of NV12 chroma / YUY2 luma; the last load must not
+        // go past the final sample, so one group is always left to the tail
+        const __m128i mask = _mm_set1_epi16(0xff);
+        for (; i + 8 < width; i += 8)
+        {
+            __m128i p = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src + 2 * i)), mask);
+            _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(p)));
+        }
+    }
+
+    UnpackRow8_C(src + i * step, step, dst + i, width - i);
+}
+
+void UnpackRow16_AVX2(const mfxU16 *src, mfxI32 step, mfxI32 shift, float *dst, mfxI32 width)
+{
+    mfxI32 i = 0;
+
+    if (step == 1)
+    {
+        const __m128i sh    = _mm_cvtsi32_si128(shift);
+        const __m256  scale = _mm256_set1_ps(0.25f);
+        for (; i + 8 <= width; i += 8)
+        {
+            __m128i p = _mm_srl_epi16(_mm_loadu_si128((const __m128i *)(src + i)), sh);
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(p)), scale));
+        }
+    }
+    else if (step == 2)
+    {
+        const __m128i sh    = _mm_cvtsi32_si128(shift);
+        const __m256  scale = _mm256_set1_ps(0.25f);
+        const __m256i mask  = _mm256_set1_epi32(0xffff);
+        for (; i + 8 < width; i += 8)
+        {
+            __m256i p = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(src + 2 * i)), mask);
+            p = _mm256_srl_epi32(p, sh);
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(p), scale));
+        }
+    }
+
+    UnpackRow16_C(src + i * step, step, shift, dst + i, width - i);
+}
+
+// 16 floats -> 16 saturated bytes
+static inline __m128i Pack16x8(const float *src)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 vmax = _mm256_set1_ps(255.f);
+
+    __m256i a = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src),     zero), vmax));
+    __m256i b = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + 8), zero), vmax));
+    __m256i w = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xd8);
+
+    return _mm_packus_epi16(_mm256_castsi256_si128(w), _mm256_extracti128_si256(w, 1));
+}
+
+// 16 floats -> 16 saturated 10-bit words
+static inline __m256i Pack16x16(const float *src, __m128i sh)
+{
+    const __m256 zero  = _mm256_setzero_ps();
+    const __m256 vmax  = _mm256_set1_ps(1023.f);
+    const __m256 scale = _mm256_set1_ps(4.f);
+
+    __m256i a = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src),     scale), zero), vmax));
+    __m256i b = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + 8), scale), zero), vmax));
+    __m256i w = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xd8);
+
+    return _mm256_sll_epi16(w, sh);
+}
+
+void PackRow8_AVX2(const float *src, mfxU8 *dst, mfxI32 step, mfxI32 width)
+{
+    mfxI32 i = 0;
+
+    if (step == 1)
+    {
+        for (; i + 16 <= width; i += 16)
+            _mm_storeu_si128((__m128i *)(dst + i), Pack16x8(src + i));
+    }
+
+    PackRow8_C(src + i, dst + i * step, step, width - i);
+}
+
+void PackRow16_AVX2(const float *src, mfxU16 *dst, mfxI32 step, mfxI32 shift, mfxI32 width)
+{
+    mfxI32 i = 0;
+
+    if (step == 1)
+    {
+        const __m128i sh = _mm_cvtsi32_si128(shift);
+        for (; i + 16 <= width; i += 16)
+            _mm256_storeu_si256((__m256i *)(dst + i), Pack16x16(src + i, sh));
+    }
+
+    PackRow16_C(src + i, dst + i * step, step, shift, width - i);
+}
+
+void PackUV8_AVX2(const float *u, const float *v, mfxU8 *dst, mfxI32 width)
+{
+    mfxI32 i = 0;
+
+    for (; i + 16 <= width; i += 16)
+    {
+        __m128i pu = Pack16x8(u + i);
+        __m128i pv = Pack16x8(v + i);
+        _mm_storeu_si128((__m128i *)(dst + 2 * i),      _mm_unpacklo_epi8(pu, pv));
+        _mm_storeu_si128((__m128i *)(dst + 2 * i + 16), _mm_unpackhi_epi8(pu, pv));
+    }
+
+    PackUV8_C(u + i, v + i, dst + 2 * i, width - i);
+}
+
+void PackUV16_AVX2(const float *u, const float *v, mfxU16 *dst, mfxI32 shift, mfxI32 width)
+{
+    mfxI32 i = 0;
+    const __m128i sh = _mm_cvtsi32_si128(shift);
+
+    for (; i + 16 <= width; i += 16)
+    {
+        __m256i pu = Pack16x16(u + i, sh);
+        __m256i pv = Pack16x16(v + i, sh);
+        __m256i lo = _mm256_unpacklo_epi16(pu, pv); // u0-3 v0-3 | u8-11 v8-11
+        __m256i hi = _mm256_unpackhi_epi16(pu, pv); // u4-7 v4-7 | u12-15 v12-15
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i),      _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+
+    PackUV16_C(u + i, v + i, dst + 2 * i, shift, width - i);
+}
+
+void HorzFilter_AVX2(const float *src, float *dst, const mfxI32 *start, const float *coef, mfxI32 taps, mfxI32 width)
+{
+    mfxI32 i = 0;
+
+    for (; i + 8 <= width; i += 8)
+    {
+        __m256i idx = _mm256_loadu_si256((const __m256i *)(start + i));
+        __m256  acc = _mm256_setzero_ps();
+        const float *c = coef + i;
+
+        for (mfxI32 k = 0; k < taps; k++, c += width)
+            acc = _mm256_fmadd_ps(_mm256_i32gather_ps(src + k, idx, 4), _mm256_loadu_ps(c), acc);
+
+        _mm256_storeu_ps(dst + i, acc);
+    }
+
+    // the C tail indexes the coefficients with its own width
+    for (; i < width; i++)
+    {
+        const float *s = src + start[i];
+        float acc = 0.f;
+        for (mfxI32 k = 0; k < taps; k++)
+            acc += coef[k * width + i] * s[k];
+        dst[i] = acc;
+    }
+}
+
+void VertFilter_AVX2(const float * const *rows, const float *coef, mfxI32 taps, float *dst, mfxI32 width)
+{
+    mfxI32 i = 0;
+
+    for (; i + 16 <= width; i += 16)
+    {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+
+        for (mfxI32 k = 0; k < taps; k++)
+        {
+            __m256 c = _mm256_broadcast_ss(coef + k);
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(rows[k] + i),     c, acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(rows[k] + i + 8), c, acc1);
+        }
+
+        _mm256_storeu_ps(dst + i,     acc0);
+        _mm256_storeu_ps(dst + i + 8, acc1);
+    }
+
+    for (; i < width; i++)
+    {
+        float acc = 0.f;
+        for (mfxI32 k = 0; k < taps; k++)
+            acc += coef[k] * rows[k][i];
+        dst[i] = acc;
+    }
+}
+
+void Combine3_AVX2(const float *a, const float *b, const float *c, const float m[4], float *dst, mfxI32 width)
+{
+    const __m256 m0 = _mm256_set1_ps(m[0]);
+    const __m256 m1 = _mm256_set1_ps(m[1]);
+    const __m256 m2 = _mm256_set1_ps(m[2]);
+    const __m256 m3 = _mm256_set1_ps(m[3]);
+    mfxI32 i = 0;
+
+    for (; i + 8 <= width; i += 8)
+    {
+        __m256 acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), m0, m3);
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(b + i), m1, acc);
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(c + i), m2, acc);
+        _mm256_storeu_ps(dst + i, acc);
+    }
+
+    Combine3_C(a + i, b + i, c + i, m, dst + i, width - i);
+}
+
+} // namespace MfxCpuVideoProcessing
+
+#endif // MFX_VPP_CPU_AVX2
@@ -39,9 +39,11 @@ class CmDevice;
 
 VideoVPPBase* CreateAndInitVPPImpl(mfxVideoParam *par, VideoCORE *core, mfxStatus *mfxSts)
 {
-    bool bHWInitFailed = false;
+    MfxCpuVideoProcessing::ExecutionMode execMode = MfxCpuVideoProcessing::GetExecutionMode(*par);
+    mfxStatus hwSts = MFX_ERR_UNSUPPORTED;
     VideoVPPBase * vpp = 0;
-    if( MFX_PLATFORM_HARDWARE == core->GetPlatformType())
+
+    if( MFX_PLATFORM_HARDWARE == core->GetPlatformType() && MfxCpuVideoProcessing::EXECUTION_CPU != execMode)
     {
         vpp = new VideoVPP_HW(core, mfxSts);
         if (*mfxSts != MFX_ERR_NONE)
@@ -51,11 +53,6 @@ VideoVPPBase* CreateAndInitVPPImpl(mfxVideoParam *par, VideoCORE *core, mfxStatu
         }
 
         *mfxSts = vpp->Init(par);
-        if (*mfxSts < MFX_ERR_NONE)
-        {
-            delete vpp;
-            return 0;
-        }
 
         if(MFX_WRN_INCOMPATIBLE_VIDEO_PARAM == *mfxSts ||
             MFX_WRN_FILTER_SKIPPED == *mfxSts ||
@@ -67,10 +64,32 @@ VideoVPPBase* CreateAndInitVPPImpl(mfxVideoParam *par, VideoCORE *core, mfxStatu
 
         delete vpp;
         vpp = 0;
-        bHWInitFailed = true;
+        hwSts = (*mfxSts < MFX_ERR_NONE) ? *mfxSts : MFX_ERR_UNSUPPORTED;
     }
 
-    *mfxSts = MFX_ERR_UNSUPPORTED;
+    // system memory pipelines the GPU can't take, or that are sent to the CPU on purpose;
+    // parameter errors from the GPU path go back to the caller as is
+    if (MfxCpuVideoProcessing::EXECUTION_GPU != execMode &&
+        MFX_ERR_UNSUPPORTED == hwSts &&
+        MFX_ERR_NONE == MfxCpuVideoProcessing::CpuVideoProcessing::CheckParams(*par))
+    {
+        vpp = new VideoVPP_SW(core, mfxSts);
+        if (*mfxSts == MFX_ERR_NONE)
+        {
+            *mfxSts = vpp->Init(par);
+            if (*mfxSts >= MFX_ERR_NONE)
+            {
+                if (MFX_ERR_NONE == *mfxSts)
+                    *mfxSts = MFX_WRN_PARTIAL_ACCELERATION;
+                return vpp;
+            }
+        }
+
+        delete vpp;
+        vpp = 0;
+    }
+
+    *mfxSts = hwSts;
     return 0;
 }
 
@@ -392,10 +411,17 @@ mfxStatus VideoVPPBase::QueryIOSurf(VideoCORE* core, mfxVideoParam *par, mfxFram
 
     if( MFX_PLATFORM_HARDWARE == core->GetPlatformType() )
     {
+        MfxCpuVideoProcessing::ExecutionMode execMode = MfxCpuVideoProcessing::GetExecutionMode(*par);
+
         mfxFrameAllocRequest hwRequest[2];
-        mfxSts = VideoVPPHW::QueryIOSurf(VideoVPPHW::ALL, core, par, hwRequest);
+        mfxSts = (MfxCpuVideoProcessing::EXECUTION_CPU == execMode)
+            ? MFX_ERR_UNSUPPORTED
+            : VideoVPPHW::QueryIOSurf(VideoVPPHW::ALL, core, par, hwRequest);
 
         bool bSWLib = (mfxSts == MFX_ERR_NONE) ? false : true;
+        bool bCpuFallback = bSWLib
+            && MfxCpuVideoProcessing::EXECUTION_GPU != execMode
+            && MFX_ERR_NONE == MfxCpuVideoProcessing::CpuVideoProcessing::CheckParams(*par);
         if( !bSWLib )
         {
             // suggested
@@ -421,6 +447,10 @@ mfxStatus VideoVPPBase::QueryIOSurf(VideoCORE* core, mfxVideoParam *par, mfxFram
 
         mfxSts = CheckIOPattern_AndSetIOMemTypes(par->IOPattern, &(request[VPP_IN].Type), &(request[VPP_OUT].Type), bSWLib);
         MFX_CHECK_STS(mfxSts);
+
+        if (bCpuFallback)
+            return MFX_WRN_PARTIAL_ACCELERATION;
+
         return (bSWLib)? MFX_ERR_UNSUPPORTED : MFX_ERR_NONE;
     }
     return MFX_ERR_NONE;
@@ -565,6 +595,13 @@ mfxStatus VideoVPPBase::QueryCaps(VideoCORE * core, MfxHwVideoProcessing::mfxVpp
         if (sts >= MFX_ERR_NONE)
            return sts;
     }
+    else
+    {
+        // CPU VPP: resize, CSC and composition only
+        caps.uScaling            = 1;
+        caps.uVideoSignalInfo    = 1;
+        return MFX_ERR_NONE;
+    }
 
     return MFX_ERR_UNSUPPORTED;
 } // mfxStatus VideoVPPBase::QueryCaps((VideoCORE * core, MfxHwVideoProcessing::mfxVppCaps& caps)
@@ -902,6 +939,20 @@ mfxStatus VideoVPPBase::Query(VideoCORE * core, mfxVideoParam *in, mfxVideoParam
                         // no specific checks for MCTF control buffer
                         continue;
                     }
+#endif
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+                    else if (MFX_EXTBUFF_VPP_EXECUTION == in->ExtParam[i]->BufferId)
+                    {
+                        mfxExtVPPExecution* extExecIn  = (mfxExtVPPExecution*)in->ExtParam[i];
+                        mfxExtVPPExecution* extExecOut = (mfxExtVPPExecution*)out->ExtParam[i];
+
+                        extExecOut->Mode = extExecIn->Mode;
+                        if (extExecIn->Mode > MFX_VPP_EXECUTION_CPU)
+                        {
+                            extExecOut->Mode = MFX_VPP_EXECUTION_AUTO;
+                            mfxSts = MFX_ERR_UNSUPPORTED;
+                        }
+                    }
 #endif
                     else
                     {
@@ -1138,41 +1189,39 @@ mfxStatus VideoVPPBase::Query(VideoCORE * core, mfxVideoParam *in, mfxVideoParam
 
         mfxStatus   hwQuerySts = MFX_ERR_NONE;
 
-        if(MFX_PLATFORM_HARDWARE == core->GetPlatformType())
+        MfxCpuVideoProcessing::ExecutionMode execMode = MfxCpuVideoProcessing::GetExecutionMode(*in);
+        bool bCpuSupported = MfxCpuVideoProcessing::EXECUTION_GPU != execMode
+            && MFX_ERR_NONE == MfxCpuVideoProcessing::CpuVideoProcessing::CheckParams(*in);
+
+        if (MfxCpuVideoProcessing::EXECUTION_CPU == execMode || MFX_PLATFORM_HARDWARE != core->GetPlatformType())
         {
-            // HW VPP checking
-            hwQuerySts = VideoVPPHW::Query(core, out);
+            MFX_CHECK(bCpuSupported, MFX_ERR_UNSUPPORTED);
+            return (MFX_ERR_NONE == mfxSts) ? MFX_WRN_PARTIAL_ACCELERATION : mfxSts;
+        }
 
-            // Statuses returned by Init differ in several cases from Query
-            if (MFX_ERR_INVALID_VIDEO_PARAM == hwQuerySts || MFX_ERR_UNSUPPORTED == hwQuerySts)
-            {
-                return MFX_ERR_UNSUPPORTED;
-            }
+        // HW VPP checking
+        hwQuerySts = VideoVPPHW::Query(core, out);
 
-            if (MFX_WRN_INCOMPATIBLE_VIDEO_PARAM == hwQuerySts || MFX_WRN_FILTER_SKIPPED == hwQuerySts)
-            {
-                return hwQuerySts;
-            }
+        // Statuses returned by Init differ in several cases from Query
+        if (MFX_ERR_INVALID_VIDEO_PARAM == hwQuerySts || MFX_ERR_UNSUPPORTED == hwQuerySts)
+        {
+            // Init falls back to the CPU for these
+            return bCpuSupported ? MFX_WRN_PARTIAL_ACCELERATION : MFX_ERR_UNSUPPORTED;
+        }
 
-            if(MFX_ERR_NONE == hwQuerySts)
-            {
-                return mfxSts;
-            }
-            else
-            {
-                // doesn't support sw fallback now so return MFX_ERR_UNSUPPORTED
-                // will return MFX_WRN_PARTIAL_ACCELERATION after enabling sw fallback
-                hwQuerySts = MFX_ERR_UNSUPPORTED;
-            }
+        if (MFX_WRN_INCOMPATIBLE_VIDEO_PARAM == hwQuerySts || MFX_WRN_FILTER_SKIPPED == hwQuerySts)
+        {
+            return hwQuerySts;
         }
-        else
+
+        if(MFX_ERR_NONE == hwQuerySts)
         {
-            MFX_RETURN(MFX_ERR_UNSUPPORTED);
+            return mfxSts;
         }
 
-        MFX_CHECK_STS(hwQuerySts);
+        MFX_CHECK(bCpuSupported, MFX_ERR_UNSUPPORTED);
 
-        return mfxSts;
+        return MFX_WRN_PARTIAL_ACCELERATION;
     }//else
 } // mfxStatus VideoVPPBase::Query(VideoCORE *core, mfxVideoParam *in, mfxVideoParam *out)
 
@@ -1480,6 +1529,116 @@ mfxStatus VideoVPP_HW::RunFrameVPP(mfxFrameSurface1* , mfxFrameSurface1* , mfxEx
     return MFX_ERR_NONE;
 }
 
+VideoVPP_SW::VideoVPP_SW(VideoCORE *core, mfxStatus* sts)
+    : VideoVPPBase(core, sts)
+{
+}
+
+mfxStatus VideoVPP_SW::InternalInit(mfxVideoParam *par)
+{
+    mfxStatus sts = MfxCpuVideoProcessing::CpuVideoProcessing::CheckParams(*par);
+    MFX_CHECK(MFX_ERR_NONE == sts, MFX_ERR_INVALID_VIDEO_PARAM);
+
+    m_pCPUVPP.reset(new MfxCpuVideoProcessing::CpuVideoProcessing(m_core));
+
+    sts = m_pCPUVPP->Init(*par);
+    if (MFX_ERR_NONE != sts)
+    {
+        m_pCPUVPP.reset(0);
+    }
+    MFX_CHECK_STS(sts);
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus VideoVPP_SW::Reset(mfxVideoParam *par)
+{
+    mfxStatus sts = VideoVPPBase::Reset(par);
+    MFX_CHECK_STS( sts );
+
+    MFX_CHECK(MFX_ERR_NONE == MfxCpuVideoProcessing::CpuVideoProcessing::CheckParams(*par), MFX_ERR_INVALID_VIDEO_PARAM);
+
+    sts = m_pCPUVPP->Reset(*par);
+    MFX_CHECK_STS(sts);
+
+    bool bCorrectionEnable = false;
+    return CheckPlatformLimitations(m_core, *par, bCorrectionEnable);
+}
+
+mfxStatus VideoVPP_SW::Close(void)
+{
+    mfxStatus sts = VideoVPPBase::Close();
+    m_pCPUVPP.reset(0);
+    return sts;
+}
+
+mfxStatus VideoVPP_SW::VppFrameCheck(mfxFrameSurface1 *in, mfxFrameSurface1 *out, mfxExtVppAuxData *aux,
+                                     MFX_ENTRY_POINT pEntryPoints[], mfxU32 &numEntryPoints)
+{
+    mfxStatus sts = VideoVPPBase::VppFrameCheck(in, out, aux, pEntryPoints, numEntryPoints);
+    MFX_CHECK_STS( sts );
+
+    MfxCpuVideoProcessing::Task* task = 0;
+    sts = m_pCPUVPP->FrameCheck(in, out, task);
+    MFX_CHECK_STS( sts );
+
+    // the first input of a composition carries the frame properties
+    mfxFrameSurface1 const & primary = *task->surfIn[0];
+
+    out->Info.AspectRatioW  = primary.Info.AspectRatioW;
+    out->Info.AspectRatioH  = primary.Info.AspectRatioH;
+    out->Info.FrameRateExtN = m_errPrtctState.Out.FrameRateExtN;
+    out->Info.FrameRateExtD = m_errPrtctState.Out.FrameRateExtD;
+    if (MFX_PICSTRUCT_UNKNOWN == m_errPrtctState.Out.PicStruct)
+        out->Info.PicStruct = primary.Info.PicStruct;
+
+    out->Data.TimeStamp  = primary.Data.TimeStamp;
+    out->Data.FrameOrder = primary.Data.FrameOrder;
+
+    pEntryPoints[0].pRoutine           = &RunTileRoutine;
+    pEntryPoints[0].pCompleteProc      = &CompleteTaskRoutine;
+    pEntryPoints[0].pState             = this;
+    pEntryPoints[0].pParam             = task;
+    pEntryPoints[0].requiredNumThreads = std::min(task->numTiles, m_pCPUVPP->GetNumThreads());
+    pEntryPoints[0].pRoutineName       = "VPP CPU";
+
+    numEntryPoints = 1;
+
+    m_stat.NumFrame++;
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus VideoVPP_SW::RunFrameVPP(mfxFrameSurface1* , mfxFrameSurface1* , mfxExtVppAuxData *)
+{
+    return MFX_ERR_NONE;
+}
+
+// one row tile of the output per call, the scheduler keeps calling while tiles are left
+mfxStatus VideoVPP_SW::RunTileRoutine(void *pState, void *pParam, mfxU32 /*threadNumber*/, mfxU32 callNumber)
+{
+    MFX_CHECK_NULL_PTR2(pState, pParam);
+
+    VideoVPP_SW & vpp = *(VideoVPP_SW*)pState;
+    MfxCpuVideoProcessing::Task const & task = *(MfxCpuVideoProcessing::Task*)pParam;
+
+    if (callNumber >= task.numTiles)
+        return MFX_TASK_DONE;
+
+    mfxStatus sts = vpp.m_pCPUVPP->ProcessTile(task, callNumber);
+    MFX_CHECK_STS(sts);
+
+    return (callNumber + 1 == task.numTiles) ? MFX_TASK_DONE : MFX_TASK_WORKING;
+}
+
+mfxStatus VideoVPP_SW::CompleteTaskRoutine(void *pState, void *pParam, mfxStatus /*taskRes*/)
+{
+    MFX_CHECK_NULL_PTR2(pState, pParam);
+
+    VideoVPP_SW & vpp = *(VideoVPP_SW*)pState;
+    return vpp.m_pCPUVPP->CompleteTask((MfxCpuVideoProcessing::Task*)pParam);
+}
+
 
 #endif // MFX_ENABLE_VPP
 /* EOF */
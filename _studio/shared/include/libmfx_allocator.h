@@ -22,6 +22,9 @@
 #define _LIBMFX_ALLOCATOR_H_
 
 #include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
 #include "mfxvideo.h"
 
 
@@ -42,6 +45,7 @@ namespace mfxDefaultAllocator
     struct BufferStruct
     {
         mfxHDL      allocator;
+        mfxHDL      pool;       // size class of mfxSysMemFramePool owning the block, 0 - heap
         mfxU32      id;
         mfxU32      nbytes;
         mfxU16      type;
@@ -53,6 +57,68 @@ namespace mfxDefaultAllocator
     };
 }
 
+// Process-wide pool of large system memory blocks used by mfxDefaultAllocator.
+// Blocks of one size are carved from 2MB aligned slabs (hugetlb pages if reserved,
+// transparent hugepages otherwise) and recycled on free, so frames of the same
+// resolution survive Close/Reset/Init without faulting pages in again.
+// The pool is off until a session requests it with mfxExtSysMemFramePool and
+// is released when the last session is closed. It never maps more than its
+// budget, Alloc returns 0 then and caller falls back to the heap.
+// Every block size has its own lock; the class list lock is taken only by Alloc
+// to find the class and by budget enforcement, Free goes straight to the class.
+class mfxSysMemFramePool
+{
+public:
+    struct SizeClass;
+
+    static mfxSysMemFramePool& Instance();
+
+    // pZeroed is set if block content is known to be zero (fresh slab),
+    // ppClass receives the class which Free expects
+    void*  Alloc(size_t nbytes, bool* pZeroed, SizeClass** ppClass);
+    void   Free(void* ptr, SizeClass* pClass);
+    // enables the pool, the largest budget requested by open sessions is used
+    void   RequestBudget(size_t nbytes);
+    // called on session creation and destruction, last session disables the pool
+    void   AddSession();
+    void   RemoveSession();
+
+    struct Slab
+    {
+        mfxU8*              base;
+        size_t              size;
+        mfxU32              numUsed;
+        std::vector<mfxU8*> idle;
+        std::vector<mfxU8*> fresh;
+    };
+
+    struct SizeClass
+    {
+        std::mutex          mutex;
+        size_t              blockSize;
+        std::vector<Slab*>  slabs;
+    };
+
+private:
+    mfxSysMemFramePool();
+    ~mfxSysMemFramePool() = delete;
+
+    SizeClass* GetClass(size_t blockSize);
+    bool       ReserveSlab(size_t blockSize, size_t& slabSize, SizeClass* pOwner);
+    Slab*      CreateSlab(SizeClass& cls);
+    void       DestroySlab(SizeClass& cls, Slab* slab);
+    size_t     ReleaseIdleSlabs(SizeClass& cls, size_t nbytes);
+
+    std::mutex                    m_mutex;       // guards m_classes and m_numSessions
+    mfxU32                        m_numSessions;
+    std::atomic<size_t>           m_budget;      // 0 - pool is disabled
+    std::atomic<size_t>           m_mapped;
+    std::map<size_t, SizeClass*>  m_classes;     // block size -> class, never removed
+
+    mfxSysMemFramePool(const mfxSysMemFramePool&) = delete;
+    mfxSysMemFramePool& operator=(const mfxSysMemFramePool&) = delete;
+};
+
 class mfxWideBufferAllocator
 {
 public:
@@ -30,8 +30,11 @@
 #include "mfx_ext_buffers.h"
 #include "fast_copy.h"
 #include "libmfx_core_interface.h"
+#include "libmfx_core_registry.h"
 
 #include <memory>
+#include <vector>
+#include <atomic>
 
 
 class mfx_UMC_FrameAllocator;
@@ -176,13 +179,14 @@ protected:
 
     virtual mfxStatus          DefaultAllocFrames(mfxFrameAllocRequest *request, mfxFrameAllocResponse *response);
     mfxFrameAllocator*         GetAllocatorAndMid(mfxMemId& mid);
+    bool                       IsForeignMid(mfxMemId mid) const;
+    void                       RetireAllocator(mfxBaseWideFrameAllocator* pAlloc);
     mfxBaseWideFrameAllocator* GetAllocatorByReq(mfxU16 type) const;
     virtual void               Close();
     mfxStatus                  FreeMidArray(mfxFrameAllocator* pAlloc, mfxFrameAllocResponse *response);
     mfxStatus                  RegisterMids(mfxFrameAllocResponse *response, mfxU16 memType, bool IsDefaultAlloc, mfxBaseWideFrameAllocator* pAlloc = 0);
     mfxStatus                  CheckTimingLog();
 
-    bool                       GetUniqID(mfxMemId& mId);
     virtual mfxStatus          InternalFreeFrames(mfxFrameAllocResponse *response);
     bool IsEqual (const mfxFrameAllocResponse &resp1, const mfxFrameAllocResponse &resp2) const
     {
@@ -200,30 +204,27 @@ protected:
     //function checks if surfaces already allocated and mapped and request is consistent. Fill response if surfaces are correct
     virtual bool IsOpaqSurfacesAlreadyMapped(mfxFrameSurface1 **pOpaqueSurface, mfxU32 NumOpaqueSurface, mfxFrameAllocResponse *response, bool ExtendedSearch = true) override;
 
-    typedef struct
-    {
-        mfxMemId InternalMid;
-        bool isDefaultMem;
-        mfxU16 memType;
-
-    } MemDesc;
-
-    typedef std::map<mfxMemId, MemDesc> CorrespTbl;
-    typedef std::map<mfxMemId, mfxBaseWideFrameAllocator*> AllocQueue;
     typedef std::map<mfxMemId*, mfxMemId*> MemIDMap;
 
     typedef std::map<mfxFrameSurface1*, mfxFrameSurface1> OpqTbl;
     typedef std::map<mfxMemId, mfxFrameSurface1*> OpqTbl_MemId;
-    typedef std::map<mfxFrameData*, mfxFrameSurface1*> OpqTbl_FrameData;
     typedef std::map<mfxFrameAllocResponse*, mfxU32> RefCtrTbl;
 
 
-    CorrespTbl       m_CTbl;
-    AllocQueue       m_AllocatorQueue;
+    // Counts LockFrame/UnlockFrame calls which use a registry snapshot without the lock
+    class LockFreeUser
+    {
+    public:
+        LockFreeUser(std::atomic<mfxU32>& users) : m_users(users) { m_users.fetch_add(1); }
+        ~LockFreeUser() { m_users.fetch_sub(1); }
+    private:
+        std::atomic<mfxU32>& m_users;
+    };
+
+    MemIdRegistry    m_MidRegistry;
     MemIDMap         m_RespMidQ;
     OpqTbl           m_OpqTbl;
     OpqTbl_MemId     m_OpqTbl_MemId;
-    OpqTbl_FrameData m_OpqTbl_FrameData;
     RefCtrTbl        m_RefCtrTbl;
 
     // Number of available threads
@@ -251,6 +252,9 @@ protected:
 
     std::unique_ptr<mfxMemId[]>                m_pMemId;
     std::unique_ptr<mfxBaseWideFrameAllocator> m_pcAlloc;
+    // self allocators of freed frames, deleted once no lock-free user may hold them
+    std::vector<std::unique_ptr<mfxBaseWideFrameAllocator>> m_retiredAllocs;
+    std::atomic<mfxU32>                        m_lockFreeUsers;
 
     std::unique_ptr<FastCopy>                  m_pFastCopy;
     bool                                       m_bUseExtManager;
@@ -35,6 +35,7 @@ public:
         , m_CoreCounter(0)
     {
         m_Cores.push_back(pCore);
+        m_CoreIds.push_back(0);
         pCore->SetCoreId(0);
     };
 
@@ -46,7 +47,8 @@ public:
             return MFX_ERR_MEMORY_ALLOC;
 
         m_Cores.push_back(pCore);
-        pCore->SetCoreId(++m_CoreCounter);
+        m_CoreIds.push_back(++m_CoreCounter);
+        pCore->SetCoreId(m_CoreCounter);
         m_CoreCounter = (m_CoreCounter == 0xFFFF)?0:m_CoreCounter;
 
         return MFX_ERR_NONE;
@@ -60,6 +62,7 @@ public:
         {
             if (*it == pCore)
             {
+                m_CoreIds.erase(m_CoreIds.begin() + (it - m_Cores.begin()));
                 m_Cores.erase(it);
                 return;
             }
@@ -134,6 +137,18 @@ public:
         return MFX_ERR_UNDEFINED_BEHAVIOR;
     }
 
+    // functor to run fuction from the core with given id only
+    template <typename func, typename arg>
+    mfxStatus DoCoreOperationById(mfxU32 coreId, func functor, arg par)
+    {
+        UMC::AutomaticUMCMutex guard(m_guard);
+        VideoCORE* pCore = FindCore(coreId);
+        if (!pCore)
+            return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+        return (pCore->*functor)(par, false);
+    }
+
     // functor to get instance from child cores
     template <typename obj, typename func, typename arg>
     void* QueryGUID(func functor, arg par)
@@ -204,9 +219,24 @@ private:
     virtual ~OperatorCORE()
     {
         m_Cores.clear();
+        m_CoreIds.clear();
     };
+
+    // m_guard should be taken
+    VideoCORE* FindCore(mfxU32 coreId) const
+    {
+        for (size_t i = 0; i < m_CoreIds.size(); i++)
+        {
+            if (m_CoreIds[i] == coreId)
+                return m_Cores[i];
+        }
+        return 0;
+    }
+
     // self and child cores
     std::vector<VideoCORE*>  m_Cores;
+    // ids assigned to m_Cores, used to route mids to the owning core
+    std::vector<mfxU32>      m_CoreIds;
 
     // Reference counters
     mfxU32 m_refCounter;
@@ -0,0 +1,271 @@
+// Copyright (c) 2020 Intel Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __LIBMFX_CORE_REGISTRY_H__
+#define __LIBMFX_CORE_REGISTRY_H__
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+#include "mfxvideo.h"
+#include "libmfx_allocator.h"
+
+// Table of frame mids registered by one core.
+// mfxMemId handed out by the core encodes the table slot itself:
+//   bits 0..14  - slot index (0 is never used)
+//   bits 15..   - core id assigned by OperatorCORE
+// so a lookup is a plain index operation and needs no lock. Slots are kept in
+// chunks which are allocated on demand and never released until the table is
+// destroyed, so a reader racing with Unregister never touches freed memory.
+// Every slot is published under its own sequence counter: writers make it odd
+// while they update the fields, readers copy the fields and retry if the
+// counter moved, so Find always returns a consistent snapshot of one
+// registration. Register/SetOpaque/Unregister/Clear must be serialized by the owner.
+class MemIdRegistry
+{
+public:
+    enum
+    {
+        SLOT_BITS  = 15,
+        SLOT_MASK  = (1 << SLOT_BITS) - 1,
+        CHUNK_BITS = 8,
+        CHUNK_SIZE = 1 << CHUNK_BITS,
+        NUM_CHUNKS = (1 << SLOT_BITS) >> CHUNK_BITS
+    };
+
+    struct Entry
+    {
+        mfxMemId                   Mid;          // mid as seen by components
+        mfxMemId                   InternalMid;  // mid of the allocator
+        mfxBaseWideFrameAllocator* pAlloc;       // self allocator, 0 for application one
+        mfxFrameSurface1*          pOpqSurface;  // opaque surface mapped to the mid
+        mfxFrameData*              pNativeData;  // native frame data of the opaque mapping
+        mfxU16                     memType;
+        bool                       isDefaultMem;
+    };
+
+    static mfxU32 GetCoreId(mfxMemId mid) { return (mfxU32)((size_t)mid >> SLOT_BITS); }
+    static mfxU32 GetSlot(mfxMemId mid)   { return (mfxU32)((size_t)mid & SLOT_MASK); }
+
+    MemIdRegistry()
+        : m_nextSlot(1)
+        , m_numUsed(0)
+    {
+        for (mfxU32 i = 0; i < NUM_CHUNKS; i++)
+            m_chunks[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~MemIdRegistry()
+    {
+        for (mfxU32 i = 0; i < NUM_CHUNKS; i++)
+            delete m_chunks[i].load(std::memory_order_relaxed);
+    }
+
+    // Lock-free. Copies the entry registered for mid, returns false if there is none.
+    bool Find(mfxMemId mid, Entry& entry) const
+    {
+        mfxU32 slot = GetSlot(mid);
+        if (!slot)
+            return false;
+
+        Chunk* chunk = m_chunks[slot >> CHUNK_BITS].load(std::memory_order_acquire);
+        if (!chunk)
+            return false;
+
+        return chunk->slots[slot & (CHUNK_SIZE - 1)].Read(entry) && entry.Mid == mid;
+    }
+
+    bool IsRegistered(mfxMemId mid) const
+    {
+        Entry entry;
+        return Find(mid, entry);
+    }
+
+    // Returns new mid or 0 if the table is full
+    mfxMemId Register(mfxU32 coreId, const Entry& desc)
+    {
+        if (m_numUsed.load(std::memory_order_relaxed) >= SLOT_MASK)
+            return 0;
+
+        // next-fit keeps just released slots out of use for as long as possible
+        for (mfxU32 n = 0; n < SLOT_MASK; n++)
+        {
+            mfxU32 slot = m_nextSlot;
+            m_nextSlot = (m_nextSlot == SLOT_MASK) ? 1 : m_nextSlot + 1;
+
+            Chunk* chunk = m_chunks[slot >> CHUNK_BITS].load(std::memory_order_relaxed);
+            if (!chunk)
+            {
+                chunk = new Chunk();
+                m_chunks[slot >> CHUNK_BITS].store(chunk, std::memory_order_release);
+            }
+
+            Slot& s = chunk->slots[slot & (CHUNK_SIZE - 1)];
+            if (s.mid.load(std::memory_order_relaxed))
+                continue;
+
+            Entry entry = desc;
+            entry.Mid   = (mfxMemId)(size_t)(slot | (coreId << SLOT_BITS));
+            s.Write(entry);
+            m_numUsed.fetch_add(1, std::memory_order_relaxed);
+            return entry.Mid;
+        }
+        return 0;
+    }
+
+    bool SetOpaque(mfxMemId mid, mfxFrameSurface1* pOpqSurface, mfxFrameData* pNativeData)
+    {
+        Entry entry;
+        if (!Find(mid, entry))
+            return false;
+
+        entry.pOpqSurface = pOpqSurface;
+        entry.pNativeData = pNativeData;
+        GetSlotRef(mid).Write(entry);
+        return true;
+    }
+
+    void Unregister(mfxMemId mid)
+    {
+        if (!IsRegistered(mid))
+            return;
+
+        GetSlotRef(mid).Write(Entry());
+        m_numUsed.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void Clear()
+    {
+        for (mfxU32 i = 0; i < NUM_CHUNKS; i++)
+        {
+            Chunk* chunk = m_chunks[i].load(std::memory_order_relaxed);
+            if (!chunk)
+                continue;
+            for (mfxU32 j = 0; j < CHUNK_SIZE; j++)
+            {
+                if (chunk->slots[j].mid.load(std::memory_order_relaxed))
+                    chunk->slots[j].Write(Entry());
+            }
+        }
+        m_numUsed.store(0, std::memory_order_relaxed);
+        m_nextSlot = 1;
+    }
+
+    // Copies the first registered entry satisfying pred(const Entry&), returns false if there is none
+    template <typename func>
+    bool FindIf(func pred, Entry& entry) const
+    {
+        for (mfxU32 i = 0; i < NUM_CHUNKS && m_numUsed.load(std::memory_order_relaxed); i++)
+        {
+            Chunk* chunk = m_chunks[i].load(std::memory_order_acquire);
+            if (!chunk)
+                continue;
+            for (mfxU32 j = 0; j < CHUNK_SIZE; j++)
+            {
+                if (chunk->slots[j].Read(entry) && pred(entry))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    // Sequence counter is odd while the slot is being rewritten, a slot with zero mid is free
+    struct Slot
+    {
+        Slot()
+            : seq(0), mid(nullptr), internalMid(nullptr), pAlloc(nullptr)
+            , pOpqSurface(nullptr), pNativeData(nullptr), memType(0), isDefaultMem(false)
+        {}
+
+        bool Read(Entry& entry) const
+        {
+            for (;;)
+            {
+                mfxU32 before = seq.load(std::memory_order_acquire);
+                if (before & 1)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                entry.Mid          = mid.load(std::memory_order_relaxed);
+                entry.InternalMid  = internalMid.load(std::memory_order_relaxed);
+                entry.pAlloc       = pAlloc.load(std::memory_order_relaxed);
+                entry.pOpqSurface  = pOpqSurface.load(std::memory_order_relaxed);
+                entry.pNativeData  = pNativeData.load(std::memory_order_relaxed);
+                entry.memType      = memType.load(std::memory_order_relaxed);
+                entry.isDefaultMem = isDefaultMem.load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq.load(std::memory_order_relaxed) == before)
+                    return entry.Mid != nullptr;
+            }
+        }
+
+        void Write(const Entry& entry)
+        {
+            mfxU32 current = seq.load(std::memory_order_relaxed);
+            seq.store(current + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            mid.store(entry.Mid, std::memory_order_relaxed);
+            internalMid.store(entry.InternalMid, std::memory_order_relaxed);
+            pAlloc.store(entry.pAlloc, std::memory_order_relaxed);
+            pOpqSurface.store(entry.pOpqSurface, std::memory_order_relaxed);
+            pNativeData.store(entry.pNativeData, std::memory_order_relaxed);
+            memType.store(entry.memType, std::memory_order_relaxed);
+            isDefaultMem.store(entry.isDefaultMem, std::memory_order_relaxed);
+
+            seq.store(current + 2, std::memory_order_release);
+        }
+
+        std::atomic<mfxU32>                     seq;
+        std::atomic<mfxMemId>                   mid;
+        std::atomic<mfxMemId>                   internalMid;
+        std::atomic<mfxBaseWideFrameAllocator*> pAlloc;
+        std::atomic<mfxFrameSurface1*>          pOpqSurface;
+        std::atomic<mfxFrameData*>              pNativeData;
+        std::atomic<mfxU16>                     memType;
+        std::atomic<bool>                       isDefaultMem;
+    };
+
+    struct Chunk
+    {
+        Slot slots[CHUNK_SIZE];
+    };
+
+    // mid must be registered
+    Slot& GetSlotRef(mfxMemId mid)
+    {
+        mfxU32 slot = GetSlot(mid);
+        return m_chunks[slot >> CHUNK_BITS].load(std::memory_order_relaxed)->slots[slot & (CHUNK_SIZE - 1)];
+    }
+
+    std::atomic<Chunk*> m_chunks[NUM_CHUNKS];
+    mfxU32              m_nextSlot;
+    std::atomic<mfxU32> m_numUsed;
+
+    MemIdRegistry(const MemIdRegistry&) = delete;
+    MemIdRegistry& operator=(const MemIdRegistry&) = delete;
+};
+
+#endif // __LIBMFX_CORE_REGISTRY_H__
@@ -0,0 +1,60 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_common.h"
+
+#if defined (MFX_VA_LINUX)
+
+#ifndef __MFX_VA_CAPS_CACHE_H__
+#define __MFX_VA_CAPS_CACHE_H__
+
+#include "va/va.h"
+
+// Process-wide cache of driver capabilities.
+//
+// Query and Init of every component ask the driver about supported profiles,
+// entrypoints and config attributes, which are fixed for a given device. The
+// functions below have the same signatures and results as the libva calls they
+// replace, but only the first request for a given device/profile/entrypoint/
+// attribute reaches the driver. Capabilities are kept per DRM device node and
+// driver, so all displays opened on one device share them. Displays must be
+// attached to use the cache, others go to the driver directly. All functions
+// are thread-safe.
+namespace MfxVaCaps
+{
+    // Attach/detach are reference counted, capabilities of a device are
+    // dropped when its last display is detached
+    void AttachDisplay(VADisplay dpy);
+
+    void DetachDisplay(VADisplay dpy);
+
+    VAStatus QueryConfigProfiles(VADisplay dpy, VAProfile* profiles, int* num_profiles);
+
+    VAStatus QueryConfigEntrypoints(VADisplay dpy, VAProfile profile, VAEntrypoint* entrypoints, int* num_entrypoints);
+
+    VAStatus GetConfigAttributes(VADisplay dpy, VAProfile profile, VAEntrypoint entrypoint, VAConfigAttrib* attrib_list, int num_attribs);
+
+    // vaQueryProcessingRate for a temporary config created from profile, entrypoint and attributes
+    VAStatus QueryProcessingRate(VADisplay dpy, VAProfile profile, VAEntrypoint entrypoint, VAConfigAttrib* attrib_list, int num_attribs,
+        VAProcessingRateParameter* proc_buf, unsigned int* processing_rate);
+}
+
+#endif // __MFX_VA_CAPS_CACHE_H__
+#endif // MFX_VA_LINUX
@@ -410,6 +410,10 @@ MFX_PACK_END()
 mfxEncTools*  MFX_CDECL MFXVideoENCODE_CreateEncTools();
 void  MFX_CDECL MFXVideoENCODE_DestroyEncTools(mfxEncTools *et);
 
+/* mfxExtBRC callbacks backed by EncTools BRC */
+mfxExtBRC* MFX_CDECL MFXVideoENCODE_CreateExtBRC();
+void  MFX_CDECL MFXVideoENCODE_DestroyExtBRC(mfxExtBRC *ebrc);
+
 
 
 #ifdef __cplusplus
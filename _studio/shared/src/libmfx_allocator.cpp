@@ -25,6 +25,14 @@
 #include "mfx_utils.h"
 #include "mfx_common.h"
 
+#include <algorithm>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
 #define ALIGN32(X) (((mfxU32)((X)+31)) & (~ (mfxU32)31))
 #define ID_BUFFER MFX_MAKEFOURCC('B','U','F','F')
 #define ID_FRAME  MFX_MAKEFOURCC('F','R','M','E')
@@ -33,6 +41,298 @@
 
 #define DEFAULT_ALIGNMENT_SIZE 64
 
+#define POOL_SLAB_ALIGN       (2 * 1024 * 1024)
+#define POOL_BLOCK_ALIGN      4096
+// smaller buffers are not worth a slab
+#define POOL_MIN_BLOCK        (256 * 1024)
+#define POOL_MAX_SLAB_BLOCKS  8
+
+static inline size_t PoolAlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static mfxU8* PoolMapSlab(size_t size)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return (mfxU8*)VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+#if defined(MAP_HUGETLB)
+    void* huge = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (MAP_FAILED != huge)
+        return (mfxU8*)huge;
+#endif
+    // map with a margin to get 2MB alignment, so slab may be backed by transparent hugepages
+    size_t full = size + POOL_SLAB_ALIGN;
+    void* raw = mmap(NULL, full, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == raw)
+        return NULL;
+
+    mfxU8* begin = (mfxU8*)raw;
+    mfxU8* aligned = (mfxU8*)PoolAlignUp((size_t)begin, POOL_SLAB_ALIGN);
+    if (aligned > begin)
+        munmap(begin, aligned - begin);
+    if (begin + full > aligned + size)
+        munmap(aligned + size, (begin + full) - (aligned + size));
+#if defined(MADV_HUGEPAGE)
+    madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+    return aligned;
+#endif
+}
+
+static void PoolUnmapSlab(mfxU8* base, size_t size)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    (void)size;
+    VirtualFree(base, 0, MEM_RELEASE);
+#else
+    munmap(base, size);
+#endif
+}
+
+mfxSysMemFramePool& mfxSysMemFramePool::Instance()
+{
+    // never destroyed: buffers may be freed from other static destructors
+    static mfxSysMemFramePool* pool = new mfxSysMemFramePool;
+    return *pool;
+}
+
+mfxSysMemFramePool::mfxSysMemFramePool()
+    : m_numSessions(0)
+    , m_budget(0)
+    , m_mapped(0)
+{
+}
+
+void* mfxSysMemFramePool::Alloc(size_t nbytes, bool* pZeroed, SizeClass** ppClass)
+{
+    if (nbytes < POOL_MIN_BLOCK || !m_budget.load(std::memory_order_relaxed))
+        return NULL;
+
+    SizeClass* cls = GetClass(PoolAlignUp(nbytes, POOL_BLOCK_ALIGN));
+    std::lock_guard<std::mutex> guard(cls->mutex);
+
+    mfxU8* block = NULL;
+
+    // already touched blocks first, their pages are resident
+    for (Slab* slab : cls->slabs)
+    {
+        if (!slab->idle.empty())
+        {
+            block = slab->idle.back();
+            slab->idle.pop_back();
+            slab->numUsed++;
+            if (pZeroed) *pZeroed = false;
+            *ppClass = cls;
+            return block;
+        }
+    }
+
+    Slab* target = NULL;
+    for (Slab* slab : cls->slabs)
+    {
+        if (!slab->fresh.empty())
+        {
+            target = slab;
+            break;
+        }
+    }
+
+    if (!target)
+    {
+        target = CreateSlab(*cls);
+        if (!target)
+            return NULL;
+    }
+
+    block = target->fresh.back();
+    target->fresh.pop_back();
+    target->numUsed++;
+    if (pZeroed) *pZeroed = true;
+    *ppClass = cls;
+    return block;
+}
+
+void mfxSysMemFramePool::Free(void* ptr, SizeClass* cls)
+{
+    mfxU8* block = (mfxU8*)ptr;
+    std::lock_guard<std::mutex> guard(cls->mutex);
+
+    for (Slab* slab : cls->slabs)
+    {
+        if (block < slab->base || block >= slab->base + slab->size)
+            continue;
+
+        slab->idle.push_back(block);
+        slab->numUsed--;
+
+        // blocks which outlived all sessions are not kept
+        if (!m_budget.load(std::memory_order_relaxed) && !slab->numUsed)
+            DestroySlab(*cls, slab);
+        return;
+    }
+}
+
+void mfxSysMemFramePool::RequestBudget(size_t nbytes)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_budget = std::max(m_budget.load(), nbytes);
+}
+
+void mfxSysMemFramePool::AddSession()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_numSessions++;
+}
+
+void mfxSysMemFramePool::RemoveSession()
+{
+    std::vector<SizeClass*> classes;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (m_numSessions && --m_numSessions)
+            return;
+
+        m_budget = 0;
+        for (auto& it : m_classes)
+            classes.push_back(it.second);
+    }
+
+    // class locks are never taken under m_mutex
+    for (SizeClass* cls : classes)
+    {
+        std::lock_guard<std::mutex> guard(cls->mutex);
+        ReleaseIdleSlabs(*cls, m_mapped.load());
+    }
+}
+
+mfxSysMemFramePool::SizeClass* mfxSysMemFramePool::GetClass(size_t blockSize)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    SizeClass*& cls = m_classes[blockSize];
+    if (!cls)
+    {
+        cls = new SizeClass;
+        cls->blockSize = blockSize;
+    }
+    return cls;
+}
+
+// cls.mutex should be taken, on success slabSize is already accounted in m_mapped
+bool mfxSysMemFramePool::ReserveSlab(size_t blockSize, size_t& slabSize, SizeClass* pOwner)
+{
+    auto tryReserve = [this](size_t size)
+    {
+        size_t mapped = m_mapped.load();
+        do
+        {
+            if (mapped + size > m_budget.load())
+                return false;
+        } while (!m_mapped.compare_exchange_weak(mapped, mapped + size));
+        return true;
+    };
+
+    if (tryReserve(slabSize))
+        return true;
+
+    ReleaseIdleSlabs(*pOwner, slabSize);
+    if (tryReserve(slabSize))
+        return true;
+
+    // idle slabs of other sizes go next, classes busy right now are skipped
+    std::vector<SizeClass*> classes;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        for (auto& it : m_classes)
+            if (it.second != pOwner)
+                classes.push_back(it.second);
+    }
+    for (SizeClass* cls : classes)
+    {
+        std::unique_lock<std::mutex> lock(cls->mutex, std::try_to_lock);
+        if (lock.owns_lock())
+            ReleaseIdleSlabs(*cls, slabSize);
+        if (tryReserve(slabSize))
+            return true;
+    }
+
+    // near the budget a single block slab is still better than heap
+    size_t single = PoolAlignUp(blockSize, POOL_SLAB_ALIGN);
+    if (single < slabSize && tryReserve(single))
+    {
+        slabSize = single;
+        return true;
+    }
+    return false;
+}
+
+// cls.mutex should be taken
+mfxSysMemFramePool::Slab* mfxSysMemFramePool::CreateSlab(SizeClass& cls)
+{
+    size_t blockSize = cls.blockSize;
+
+    // choose number of blocks giving the least tail in 2MB granularity
+    size_t slabSize = PoolAlignUp(blockSize, POOL_SLAB_ALIGN);
+    for (mfxU32 n = 2; n <= POOL_MAX_SLAB_BLOCKS; n++)
+    {
+        size_t size = PoolAlignUp(blockSize * n, POOL_SLAB_ALIGN);
+        if ((size % blockSize) * slabSize < (slabSize % blockSize) * size)
+            slabSize = size;
+    }
+
+    if (!ReserveSlab(blockSize, slabSize, &cls))
+        return NULL;
+
+    mfxU8* base = PoolMapSlab(slabSize);
+    if (!base)
+    {
+        m_mapped -= slabSize;
+        return NULL;
+    }
+
+    Slab* slab = new Slab;
+    slab->base      = base;
+    slab->size      = slabSize;
+    slab->numUsed   = 0;
+    // reversed, so blocks are handed out from the slab start
+    for (size_t offset = (slabSize / blockSize) * blockSize; offset >= blockSize; offset -= blockSize)
+        slab->fresh.push_back(base + offset - blockSize);
+
+    cls.slabs.push_back(slab);
+    return slab;
+}
+
+// cls.mutex should be taken
+void mfxSysMemFramePool::DestroySlab(SizeClass& cls, Slab* slab)
+{
+    cls.slabs.erase(std::remove(cls.slabs.begin(), cls.slabs.end(), slab), cls.slabs.end());
+
+    PoolUnmapSlab(slab->base, slab->size);
+    m_mapped -= slab->size;
+    delete slab;
+}
+
+// cls.mutex should be taken
+size_t mfxSysMemFramePool::ReleaseIdleSlabs(SizeClass& cls, size_t nbytes)
+{
+    size_t released = 0;
+    for (size_t i = 0; i < cls.slabs.size() && released < nbytes;)
+    {
+        Slab* slab = cls.slabs[i];
+        if (slab->numUsed)
+        {
+            i++;
+            continue;
+        }
+
+        released += slab->size;
+        DestroySlab(cls, slab);
+    }
+    return released;
+}
+
 // Implementation of Internal allocators
 mfxStatus mfxDefaultAllocator::AllocBuffer(mfxHDL pthis, mfxU32 nbytes, mfxU16 type, mfxHDL *mid)
 {
@@ -41,15 +341,22 @@ mfxStatus mfxDefaultAllocator::AllocBuffer(mfxHDL pthis, mfxU32 nbytes, mfxU16 t
     if(!mid)
         return MFX_ERR_NULL_PTR;
     mfxU32 header_size = ALIGN32(sizeof(BufferStruct));
-    mfxU8 *buffer_ptr=(mfxU8 *)malloc(header_size + nbytes + DEFAULT_ALIGNMENT_SIZE);
+    bool isZeroed = false;
+    mfxSysMemFramePool::SizeClass* pool = NULL;
+    mfxU8 *buffer_ptr = (mfxU8 *)mfxSysMemFramePool::Instance().Alloc(header_size + nbytes + DEFAULT_ALIGNMENT_SIZE, &isZeroed, &pool);
+
+    if (!buffer_ptr)
+        buffer_ptr = (mfxU8 *)malloc(header_size + nbytes + DEFAULT_ALIGNMENT_SIZE);
 
     if (!buffer_ptr)
         return MFX_ERR_MEMORY_ALLOC;
 
-    memset(buffer_ptr, 0, header_size + nbytes);
+    if (!isZeroed)
+        memset(buffer_ptr, 0, header_size + nbytes);
 
     BufferStruct *bs=(BufferStruct *)buffer_ptr;
     bs->allocator = pthis;
+    bs->pool = pool;
     bs->id = ID_BUFFER;
     bs->type = type;
     bs->nbytes = nbytes;
@@ -87,6 +394,8 @@ mfxStatus mfxDefaultAllocator::LockBuffer(mfxHDL pthis, mfxHDL mid, mfxU8 **ptr)
             (index == 0))
             return MFX_ERR_INVALID_HANDLE;
         bs = pBA->m_bufHdl[index - 1];
+        if (!bs)
+            return MFX_ERR_INVALID_HANDLE;
     }
     catch (...)
     {
@@ -111,7 +420,7 @@ mfxStatus mfxDefaultAllocator::UnlockBuffer(mfxHDL pthis, mfxHDL mid)
             return MFX_ERR_INVALID_HANDLE;
 
         bs = pBA->m_bufHdl[index - 1];
-        if (bs->id!=ID_BUFFER)
+        if (!bs || bs->id!=ID_BUFFER)
             return MFX_ERR_INVALID_HANDLE;
     }
     catch (...)
@@ -134,11 +443,16 @@ mfxStatus mfxDefaultAllocator::FreeBuffer(mfxHDL pthis, mfxMemId mid)
             return MFX_ERR_INVALID_HANDLE;
 
         bs = pBA->m_bufHdl[index - 1];
-        if (bs->id!=ID_BUFFER)
-            return MFX_ERR_INVALID_HANDLE;
-        if (bs->id!=ID_BUFFER)
+        if (!bs || bs->id!=ID_BUFFER)
             return MFX_ERR_INVALID_HANDLE;
-        free(bs);
+        // pooled block may be handed out again, stale mid must not reach it
+        bs->id = 0;
+        pBA->m_bufHdl[index - 1] = 0;
+        // heap blocks never touch the pool
+        if (bs->pool)
+            mfxSysMemFramePool::Instance().Free(bs, (mfxSysMemFramePool::SizeClass*)bs->pool);
+        else
+            free(bs);
         return MFX_ERR_NONE;
     }
     catch (...)
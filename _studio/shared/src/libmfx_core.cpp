@@ -134,7 +134,7 @@ mfxStatus CommonCORE::AllocFrames(mfxFrameAllocRequest *request,
 
         // filling helper tables
         m_OpqTbl_MemId.insert(std::make_pair(opq_it->second.Data.MemId, pOpaqueSurface[i]));
-        m_OpqTbl_FrameData.insert(std::make_pair(&opq_it->second.Data, pOpaqueSurface[i]));
+        m_MidRegistry.SetOpaque(opq_it->second.Data.MemId, pOpaqueSurface[i], &opq_it->second.Data);
     }
     mfxFrameAllocResponse* pResp = new mfxFrameAllocResponse;
     *pResp = *response;
@@ -229,15 +229,16 @@ mfxStatus CommonCORE::DefaultAllocFrames(mfxFrameAllocRequest *request, mfxFrame
 }
 mfxStatus CommonCORE::LockFrame(mfxMemId mid, mfxFrameData *ptr)
 {
-    UMC::AutomaticUMCMutex guard(m_guard);
-
     try
     {
         MFX_CHECK_HDL(mid);
         MFX_CHECK_NULL_PTR1(ptr);
+        // self allocator released by InternalFreeFrames stays alive while we use it
+        LockFreeUser user(m_lockFreeUsers);
         mfxFrameAllocator* pAlloc = GetAllocatorAndMid(mid);
         if (!pAlloc)
             return MFX_ERR_INVALID_HANDLE;
+
         return (*pAlloc->Lock)(pAlloc->pthis, mid, ptr);
     }
     catch(...)
@@ -277,11 +278,11 @@ mfxStatus CommonCORE::GetFrameHDL(mfxMemId mid, mfxHDL* handle, bool ExtendedSea
 }
 mfxStatus CommonCORE::UnlockFrame(mfxMemId mid, mfxFrameData *ptr)
 {
-    UMC::AutomaticUMCMutex guard(m_guard);
-
     try
     {
         MFX_CHECK_HDL(mid);
+        // self allocator released by InternalFreeFrames stays alive while we use it
+        LockFreeUser user(m_lockFreeUsers);
         mfxFrameAllocator* pAlloc = GetAllocatorAndMid(mid);
         if (!pAlloc)
             return MFX_ERR_INVALID_HANDLE;
@@ -323,12 +324,7 @@ mfxStatus CommonCORE::FreeFrames(mfxFrameAllocResponse *response, bool ExtendedS
                                 assert(m_OpqTbl.end() != opqTbl_it);
                                 if (m_OpqTbl.end() != opqTbl_it)
                                 {
-                                    OpqTbl_FrameData::iterator frameDataTbl_it = m_OpqTbl_FrameData.find(&opqTbl_it->second.Data);
-                                    assert(m_OpqTbl_FrameData.end() != frameDataTbl_it);
-                                    if (m_OpqTbl_FrameData.end() != frameDataTbl_it)
-                                    {
-                                        m_OpqTbl_FrameData.erase(frameDataTbl_it);
-                                    }
+                                    m_MidRegistry.SetOpaque(response->mids[i], 0, 0);
                                     m_OpqTbl.erase(opqTbl_it);
                                 }
                                 m_OpqTbl_MemId.erase(memIdTbl_it);
@@ -384,12 +380,11 @@ mfxStatus CommonCORE::InternalFreeFrames(mfxFrameAllocResponse *response)
         mfxStatus sts = MFX_ERR_NONE;
         m_pMemId.reset(new mfxMemId[response->NumFrameActual]);
         mfxFrameAllocator* pAlloc;
-        CorrespTbl::iterator ctbl_it;
-        AllocQueue::iterator it;
-        ctbl_it = m_CTbl.find(response->mids[0]);
-        if (ctbl_it == m_CTbl.end())
+        MemIdRegistry::Entry desc;
+        if (!m_MidRegistry.Find(response->mids[0], desc))
             return MFX_ERR_INVALID_HANDLE;
-        bool IsDefaultMem = ctbl_it->second.isDefaultMem;
+        bool IsDefaultMem = desc.isDefaultMem;
+        mfxBaseWideFrameAllocator* pSelfAlloc = desc.pAlloc;
         mfxMemId extMem = response->mids[0];
         mfxFrameAllocator* pFirstAlloc = GetAllocatorAndMid(extMem);
         MFX_CHECK_NULL_PTR1(pFirstAlloc);
@@ -397,40 +392,23 @@ mfxStatus CommonCORE::InternalFreeFrames(mfxFrameAllocResponse *response)
         for (mfxU32 i = 0; i < response->NumFrameActual; i++)
         {
             extMem = response->mids[i];
-            ctbl_it = m_CTbl.find(response->mids[i]);
-            if (m_CTbl.end() == ctbl_it)
+            if (!m_MidRegistry.Find(response->mids[i], desc))
                 return MFX_ERR_INVALID_HANDLE;
-            m_pMemId[i] = ctbl_it->second.InternalMid;
+            m_pMemId[i] = desc.InternalMid;
             pAlloc = GetAllocatorAndMid(extMem);
             // all frames should be allocated by one allocator
-            if ((IsDefaultMem != ctbl_it->second.isDefaultMem)||
+            if ((IsDefaultMem != desc.isDefaultMem)||
                 (pAlloc != pFirstAlloc))
                 return MFX_ERR_INVALID_HANDLE;
         }
-        // save first mid. Need for future internal memory free
-        extMem = response->mids[0];
         sts = FreeMidArray(pFirstAlloc, response);
         MFX_CHECK_STS(sts);
-        // delete self allocator
-        if (IsDefaultMem)
-        {
-            it = m_AllocatorQueue.find(extMem);
-            if (m_AllocatorQueue.end() == it)
-                return MFX_ERR_INVALID_HANDLE;
-            if (it->second)
-            {
-                delete it->second;
-                it->second = 0;
-            }
-        }
         // delete self queues
         for (mfxU32 i = 0; i < response->NumFrameActual; i++)
-        {
-            ctbl_it = m_CTbl.find(response->mids[i]);
-            if (IsDefaultMem)
-                m_AllocatorQueue.erase(response->mids[i]);
-            m_CTbl.erase(ctbl_it);
-        }
+            m_MidRegistry.Unregister(response->mids[i]);
+        // delete self allocator
+        if (IsDefaultMem)
+            RetireAllocator(pSelfAlloc);
         m_pMemId.reset();
         // we sure about response->mids
         delete[] response->mids;
@@ -548,16 +526,11 @@ mfxStatus  CommonCORE::UnlockExternalFrame(mfxMemId mid, mfxFrameData *ptr, bool
 }
 mfxMemId CommonCORE::MapIdx(mfxMemId mid)
 {
-    UMC::AutomaticUMCMutex guard(m_guard);
     if (0 == mid)
         return 0;
 
-    CorrespTbl::iterator ctbl_it;
-    ctbl_it = m_CTbl.find(mid);
-    if (m_CTbl.end() == ctbl_it)
-        return 0;
-    else
-        return ctbl_it->second.InternalMid;
+    MemIdRegistry::Entry desc;
+    return m_MidRegistry.Find(mid, desc) ? desc.InternalMid : 0;
 }
 mfxFrameSurface1* CommonCORE::GetNativeSurface(mfxFrameSurface1 *pOpqSurface, bool ExtendedSearch)
 {
@@ -614,27 +587,27 @@ mfxStatus CommonCORE::FreeMidArray(mfxFrameAllocator* pAlloc, mfxFrameAllocRespo
 
 mfxStatus CommonCORE::RegisterMids(mfxFrameAllocResponse *response, mfxU16 memType, bool IsDefaultAlloc, mfxBaseWideFrameAllocator* pAlloc)
 {
+    UMC::AutomaticUMCMutex guard(m_guard);
     m_pMemId.reset(new mfxMemId[response->NumFrameActual]);
-    mfxMemId mId;
     for (mfxU32 i = 0; i < response->NumFrameActual; i++)
     {
-        MemDesc ds;
-        if (!GetUniqID(mId))
-        {
-            return MFX_ERR_UNDEFINED_BEHAVIOR;
-        }
-
-        // add in queue only self allocators
-        // need to define SW or HW allocation mode
-        if (IsDefaultAlloc)
-            m_AllocatorQueue.insert(pair<mfxMemId, mfxBaseWideFrameAllocator*>(mId, pAlloc));
+        MemIdRegistry::Entry ds = {};
         ds.InternalMid = response->mids[i];
+        // keep only self allocators
+        // need to define SW or HW allocation mode
+        ds.pAlloc = IsDefaultAlloc ? pAlloc : 0;
         ds.isDefaultMem = IsDefaultAlloc;
 
         // set render target memory description
         ds.memType = memType;
-        m_CTbl.insert(pair<mfxMemId, MemDesc>(mId, ds));
-        m_pMemId[i] = mId;
+        m_pMemId[i] = m_MidRegistry.Register(m_CoreId, ds);
+        if (!m_pMemId[i])
+        {
+            for (mfxU32 j = 0; j < i; j++)
+                m_MidRegistry.Unregister(m_pMemId[j]);
+            m_pMemId.reset();
+            return MFX_ERR_UNDEFINED_BEHAVIOR;
+        }
     }
     m_RespMidQ.insert(pair<mfxMemId*, mfxMemId*>(m_pMemId.get(), response->mids));
     response->mids = m_pMemId.release();
@@ -653,6 +626,7 @@ CommonCORE::CommonCORE(const mfxU32 numThreadsAvailable, const mfxSession sessio
     m_D3DVPPHandle(NULL),
     m_bSetExtBufAlloc(false),
     m_bSetExtFrameAlloc(false),
+    m_lockFreeUsers(0),
     m_bUseExtManager(false),
     m_bIsOpaqMode(false),
     m_CoreId(0),
@@ -666,10 +640,9 @@ CommonCORE::CommonCORE(const mfxU32 numThreadsAvailable, const mfxSession sessio
 
 void CommonCORE::Close()
 {
-    m_CTbl.clear();
-    m_AllocatorQueue.clear();
+    m_MidRegistry.Clear();
+    m_retiredAllocs.clear();
     m_OpqTbl_MemId.clear();
-    m_OpqTbl_FrameData.clear();
     m_OpqTbl.clear();
     MemIDMap::iterator it;
     while(m_RespMidQ.size())
@@ -791,15 +764,14 @@ mfxStatus CommonCORE::SetBufferAllocator(mfxBufferAllocator *allocator)
 }
 mfxFrameAllocator* CommonCORE::GetAllocatorAndMid(mfxMemId& mid)
 {
-    UMC::AutomaticUMCMutex guard(m_guard);
-    CorrespTbl::iterator ctbl_it = m_CTbl.find(mid);
-    if (m_CTbl.end() == ctbl_it)
+    MemIdRegistry::Entry desc;
+    if (!m_MidRegistry.Find(mid, desc))
         return 0;
-    if (!ctbl_it->second.isDefaultMem)
+    if (!desc.isDefaultMem)
     {
         if (m_bSetExtFrameAlloc)
         {
-            mid = ctbl_it->second.InternalMid;
+            mid = desc.InternalMid;
             return &m_FrameAllocator.frameAllocator;
         }
         else // error
@@ -810,33 +782,46 @@ mfxFrameAllocator* CommonCORE::GetAllocatorAndMid(mfxMemId& mid)
     }
     else
     {
-        AllocQueue::iterator it = m_AllocatorQueue.find(mid);
-        if (it == m_AllocatorQueue.end())
+        if (!desc.pAlloc)
         {
             mid = 0;
             return 0;
         }
         else
         {
-            mid = ctbl_it->second.InternalMid;
-            return &it->second->frameAllocator;
+            mid = desc.InternalMid;
+            return &desc.pAlloc->frameAllocator;
         }
 
     }
 }
 mfxBaseWideFrameAllocator* CommonCORE::GetAllocatorByReq(mfxU16 type) const
 {
-    AllocQueue::const_iterator it = m_AllocatorQueue.begin();
-    while (it != m_AllocatorQueue.end())
-    {
-        // external frames should be allocated at once
-        // internal frames can be allocated many times
-        if ((it->second->type == type)&&
-            (it->second->type & MFX_MEMTYPE_EXTERNAL_FRAME))
-            return it->second;
-        ++it;
-    }
-    return 0;
+    // external frames should be allocated at once
+    // internal frames can be allocated many times
+    MemIdRegistry::Entry desc;
+    bool found = m_MidRegistry.FindIf([type](const MemIdRegistry::Entry& entry)
+    {
+        return entry.pAlloc &&
+              (entry.pAlloc->type == type) &&
+              (entry.pAlloc->type & MFX_MEMTYPE_EXTERNAL_FRAME);
+    }, desc);
+    return found ? desc.pAlloc : 0;
+}
+bool CommonCORE::IsForeignMid(mfxMemId mid) const
+{
+    return MemIdRegistry::GetSlot(mid) && MemIdRegistry::GetCoreId(mid) != m_CoreId;
+}
+// Must be called under m_guard after the mids of the allocator are unregistered.
+// LockFrame/UnlockFrame which found a mid before that count themselves in
+// m_lockFreeUsers, so the allocator is kept until none of them is running.
+void CommonCORE::RetireAllocator(mfxBaseWideFrameAllocator* pAlloc)
+{
+    m_retiredAllocs.emplace_back(pAlloc);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!m_lockFreeUsers.load())
+        m_retiredAllocs.clear();
 }
 mfxStatus CommonCORE::SetFrameAllocator(mfxFrameAllocator *allocator)
 {
@@ -859,23 +844,31 @@ mfxStatus CommonCORE::SetFrameAllocator(mfxFrameAllocator *allocator)
 // no care about surface, opaq and all round. Just increasing reference
 mfxStatus CommonCORE::IncreasePureReference(mfxU16& Locked)
 {
-    UMC::AutomaticUMCMutex guard(m_guard);
+    volatile uint16_t* pLocked = (volatile uint16_t*)&Locked;
+    for (;;)
+    {
+        uint16_t current = *pLocked;
 
-    MFX_CHECK(Locked <= 65534, MFX_ERR_LOCK_MEMORY);
+        MFX_CHECK(current <= 65534, MFX_ERR_LOCK_MEMORY);
 
-    vm_interlocked_inc16((volatile uint16_t*)&Locked);
-    return MFX_ERR_NONE;
+        if (vm_interlocked_cas16(pLocked, (uint16_t)(current + 1), current) == current)
+            return MFX_ERR_NONE;
+    }
 }// CommonCORE::IncreasePureReference(mfxFrameData *ptr)
 
 // no care about surface, opaq and all round. Just increasing reference
 mfxStatus CommonCORE::DecreasePureReference(mfxU16& Locked)
 {
-    UMC::AutomaticUMCMutex guard(m_guard);
+    volatile uint16_t* pLocked = (volatile uint16_t*)&Locked;
+    for (;;)
+    {
+        uint16_t current = *pLocked;
 
-    MFX_CHECK(Locked != 0, MFX_ERR_LOCK_MEMORY);
+        MFX_CHECK(current != 0, MFX_ERR_LOCK_MEMORY);
 
-    vm_interlocked_dec16((volatile uint16_t*)&Locked);
-    return MFX_ERR_NONE;
+        if (vm_interlocked_cas16(pLocked, (uint16_t)(current - 1), current) == current)
+            return MFX_ERR_NONE;
+    }
 }// CommonCORE::IncreasePureReference(mfxFrameData *ptr)
 
 mfxStatus CommonCORE::IncreaseReference(mfxFrameData *ptr, bool ExtendedSearch)
@@ -887,31 +880,27 @@ mfxStatus CommonCORE::IncreaseReference(mfxFrameData *ptr, bool ExtendedSearch)
     }
     else
     {
+        // Opaque surface synchronization
+        if (m_bIsOpaqMode)
         {
-            UMC::AutomaticUMCMutex guard(m_guard);
-            // Opaque surface synchronization
-            if (m_bIsOpaqMode)
+            // opaque surfaces belong to the application, a stale mapping can't point to freed memory
+            MemIdRegistry::Entry desc;
+            if (m_MidRegistry.Find(ptr->MemId, desc) && desc.pOpqSurface && desc.pNativeData == ptr)
             {
-                OpqTbl_FrameData::iterator opq_it = m_OpqTbl_FrameData.find(ptr);
-                if (m_OpqTbl_FrameData.end() != opq_it)
-                {
-                    vm_interlocked_inc16((volatile uint16_t*)&(opq_it->second->Data.Locked));
-                    vm_interlocked_inc16((volatile uint16_t*)&ptr->Locked);
-                    return MFX_ERR_NONE;
-                }
+                vm_interlocked_inc16((volatile uint16_t*)&(desc.pOpqSurface->Data.Locked));
+                vm_interlocked_inc16((volatile uint16_t*)&ptr->Locked);
+                return MFX_ERR_NONE;
             }
         }
 
-        // we don't find in self queue let find in neigb cores
+        // only the core which registered the mid may know it
         if (ExtendedSearch)
         {
-            // makes sense to remove ans tay only error return
-            if (MFX_ERR_NONE != m_session->m_pOperatorCore->DoCoreOperation(&VideoCORE::IncreaseReference, ptr))
-                return IncreasePureReference(ptr->Locked);
-            else
+            if (IsForeignMid(ptr->MemId) &&
+                MFX_ERR_NONE == m_session->m_pOperatorCore->DoCoreOperationById(MemIdRegistry::GetCoreId(ptr->MemId), &VideoCORE::IncreaseReference, ptr))
                 return MFX_ERR_NONE;
 
-
+            return IncreasePureReference(ptr->Locked);
         }
         return MFX_ERR_INVALID_HANDLE;
     }
@@ -927,29 +916,27 @@ mfxStatus CommonCORE::DecreaseReference(mfxFrameData *ptr, bool ExtendedSearch)
     }
     else
     {
+        // Opaque surface synchronization
+        if (m_bIsOpaqMode)
         {
-            UMC::AutomaticUMCMutex guard(m_guard);
-            // Opaque surface synchronization
-            if (m_bIsOpaqMode)
+            // opaque surfaces belong to the application, a stale mapping can't point to freed memory
+            MemIdRegistry::Entry desc;
+            if (m_MidRegistry.Find(ptr->MemId, desc) && desc.pOpqSurface && desc.pNativeData == ptr)
             {
-                OpqTbl_FrameData::iterator opq_it = m_OpqTbl_FrameData.find(ptr);
-                if (m_OpqTbl_FrameData.end() != opq_it)
-                {
-                    vm_interlocked_dec16((volatile uint16_t*)&(opq_it->second->Data.Locked));
-                    vm_interlocked_dec16((volatile uint16_t*)&ptr->Locked);
-                    return MFX_ERR_NONE;
-                }
+                vm_interlocked_dec16((volatile uint16_t*)&(desc.pOpqSurface->Data.Locked));
+                vm_interlocked_dec16((volatile uint16_t*)&ptr->Locked);
+                return MFX_ERR_NONE;
             }
         }
 
-        // we dont find in self queue let find in neigb cores
+        // only the core which registered the mid may know it
         if (ExtendedSearch)
         {
-            // makes sence to remove ans tay only error return
-            if (MFX_ERR_NONE != m_session->m_pOperatorCore->DoCoreOperation(&VideoCORE::DecreaseReference, ptr))
-                return DecreasePureReference(ptr->Locked);
-            else
+            if (IsForeignMid(ptr->MemId) &&
+                MFX_ERR_NONE == m_session->m_pOperatorCore->DoCoreOperationById(MemIdRegistry::GetCoreId(ptr->MemId), &VideoCORE::DecreaseReference, ptr))
                 return MFX_ERR_NONE;
+
+            return DecreasePureReference(ptr->Locked);
         }
         return MFX_ERR_INVALID_HANDLE;
     }
@@ -1676,24 +1663,6 @@ bool CommonCORE::IsOpaqSurfacesAlreadyMapped(mfxFrameSurface1 **pOpaqueSurface,
 
 }
 
-// 15 bits - uniq surface Id
-// 15 bits score Id
-bool CommonCORE::GetUniqID(mfxMemId& id)
-{
-    size_t count = 1;
-    CorrespTbl::iterator ctbl_it;
-    for (; count < (1 << 15); count++)
-    {
-        ctbl_it = m_CTbl.find((mfxMemId)(count | (m_CoreId << 15)));
-        if (ctbl_it == m_CTbl.end())
-        {
-            id = (mfxMemId)(count | (m_CoreId << 15));
-            return true;
-        }
-    }
-    return false;
-}
-
 bool  CommonCORE::SetCoreId(mfxU32 Id)
 {
     if (m_CoreId < (1 << 15))
@@ -27,6 +27,7 @@
 #include "umc_va_linux.h"
 
 #include "libmfx_core_vaapi.h"
+#include "mfx_va_caps_cache.h"
 #include "mfx_utils.h"
 #include "mfx_session.h"
 #include "mfx_common_decode_int.h"
@@ -469,6 +470,9 @@ template <class Base>
 VAAPIVideoCORE_T<Base>::~VAAPIVideoCORE_T()
 {
     Close();
+
+    if (m_Display)
+        MfxVaCaps::DetachDisplay(m_Display);
 }
 
 template <class Base>
@@ -542,6 +546,8 @@ mfxStatus VAAPIVideoCORE_T<Base>::SetHandle(
             this->m_hdl = hdl;
             m_Display   = (VADisplay)this->m_hdl;
 
+            MfxVaCaps::AttachDisplay(m_Display);
+
             /* As we know right VA handle (pointer),
             * we can get real authenticated fd of VAAPI library(display),
             * and can call ioctl() to kernel mode driver,
@@ -1330,7 +1336,7 @@ mfxStatus VAAPIVideoCORE_T<Base>::IsGuidSupported(const GUID guid,
         vector <VAProfile> va_profiles (va_max_num_profiles, VAProfileNone);
 
         //ask driver about profile support
-        VAStatus va_sts = vaQueryConfigProfiles(m_Display,
+        VAStatus va_sts = MfxVaCaps::QueryConfigProfiles(m_Display,
                             va_profiles.data(), &va_max_num_profiles);
         MFX_CHECK(va_sts == VA_STATUS_SUCCESS, MFX_ERR_UNSUPPORTED);
 
@@ -1342,7 +1348,7 @@ mfxStatus VAAPIVideoCORE_T<Base>::IsGuidSupported(const GUID guid,
     vector <VAEntrypoint> va_entrypoints (va_max_num_entrypoints, static_cast<VAEntrypoint> (0));
 
     //ask driver about entrypoint support
-    VAStatus va_sts = vaQueryConfigEntrypoints(m_Display, req_profile,
+    VAStatus va_sts = MfxVaCaps::QueryConfigEntrypoints(m_Display, req_profile,
                     va_entrypoints.data(), &va_max_num_entrypoints);
     MFX_CHECK(va_sts == VA_STATUS_SUCCESS, MFX_ERR_UNSUPPORTED);
 
@@ -1355,7 +1361,7 @@ mfxStatus VAAPIVideoCORE_T<Base>::IsGuidSupported(const GUID guid,
                              {VAConfigAttribContextPriority,  0}};
 
     //ask driver about support
-    va_sts = vaGetConfigAttributes(m_Display, mapper.profile,
+    va_sts = MfxVaCaps::GetConfigAttributes(m_Display, mapper.profile,
                                    mapper.entrypoint,
                                    attr, sizeof(attr)/sizeof(*attr));
 
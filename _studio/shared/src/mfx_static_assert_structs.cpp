@@ -72,6 +72,10 @@
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxBitstream              ,72   )
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxInitParam              ,80   )
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtThreadsParam        ,132  )
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtDeviceBusyWait      ,72   )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtSysMemFramePool     ,72   )
+#endif
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxPlatform               ,32   )
     #elif defined(LINUX32)
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtBuffer              ,8    )
@@ -79,6 +83,10 @@
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxBitstream              ,64   )
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxInitParam              ,68   )
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtThreadsParam        ,132  )
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtDeviceBusyWait      ,72   )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtSysMemFramePool     ,72   )
+#endif
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxPlatform               ,32   )
     #endif
 #endif //defined (__MFXCOMMON_H__)
@@ -363,6 +371,16 @@
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtHEVCParam              ,256  )
 #if (MFX_VERSION >= 1025)
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtDecodeErrorReport      ,32   )
+#endif
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxBitstreamFragment         ,24   )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtBitstreamFragments     ,104  )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtDecodePreSplit         ,72   )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtAV1FilmGrainSynthesis  ,32   )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtCodedBufferRef         ,104  )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtEncodeStageLatency     ,264  )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtEncodeStageLatencyStat ,1800 )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtVPPExecution           ,32   )
 #endif
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtDecodedFrameInfo       ,128  )
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtTimeCode               ,32   )
@@ -485,6 +503,16 @@
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtHEVCParam              ,256  )
 #if (MFX_VERSION >= 1025)
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtDecodeErrorReport      ,32   )
+#endif
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxBitstreamFragment         ,20   )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtBitstreamFragments     ,92   )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtDecodePreSplit         ,72   )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtAV1FilmGrainSynthesis  ,32   )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtCodedBufferRef         ,92   )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtEncodeStageLatency     ,264  )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtEncodeStageLatencyStat ,1800 )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtVPPExecution           ,32   )
 #endif
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtDecodedFrameInfo       ,128  )
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtTimeCode               ,32   )
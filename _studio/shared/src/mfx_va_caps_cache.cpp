@@ -0,0 +1,380 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_va_caps_cache.h"
+
+#if defined (MFX_VA_LINUX)
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <sys/stat.h>
+#include <va/va_backend.h>
+
+namespace MfxVaCaps
+{
+
+namespace
+{
+    // device node and the driver serving it
+    typedef std::pair<dev_t, std::string> DeviceKey;
+
+    struct DeviceCaps
+    {
+        mfxU32                 numDisplays = 0;
+
+        bool                   profilesValid = false;
+        std::vector<VAProfile> profiles;
+
+        std::map<VAProfile, std::vector<VAEntrypoint>> entrypoints;
+
+        // "unsupported" errors are as stable as the capabilities, cache them too
+        std::map<VAProfile, VAStatus> unsupportedProfiles;
+        std::map<std::pair<VAProfile, VAEntrypoint>, VAStatus> unsupported;
+
+        std::map<std::tuple<VAProfile, VAEntrypoint, VAConfigAttribType>, uint32_t> attribs;
+
+        // raw config parameters and VAProcessingRateParameter -> processing rate
+        std::map<std::string, unsigned int> processingRates;
+    };
+
+    struct DisplayRef
+    {
+        DeviceKey key;
+        mfxU32    numRefs;
+    };
+
+    std::mutex                          g_mutex;
+    std::map<DeviceKey, DeviceCaps>     g_devices;
+    std::map<VADisplay, DisplayRef>     g_displays;
+
+    inline bool IsUnsupported(VAStatus sts)
+    {
+        return sts == VA_STATUS_ERROR_UNSUPPORTED_PROFILE
+            || sts == VA_STATUS_ERROR_UNSUPPORTED_ENTRYPOINT;
+    }
+
+    // DRM device node of the display, false if the display isn't backed by one
+    bool GetDeviceKey(VADisplay dpy, DeviceKey& key)
+    {
+        VADriverContextP ctx = reinterpret_cast<VADisplayContextP>(dpy)->pDriverContext;
+        if (!ctx || !ctx->drm_state)
+            return false;
+
+        int fd = *(int*)ctx->drm_state;
+
+        struct stat st = {};
+        if (fd < 0 || fstat(fd, &st) || !S_ISCHR(st.st_mode))
+            return false;
+
+        const char* vendor = vaQueryVendorString(dpy);
+
+        key = DeviceKey(st.st_rdev, vendor ? vendor : "");
+        return true;
+    }
+
+    // must be called with g_mutex held, returns 0 for displays which weren't attached
+    DeviceCaps* GetDevice(VADisplay dpy)
+    {
+        auto it = g_displays.find(dpy);
+        if (it == g_displays.end())
+            return 0;
+
+        return &g_devices[it->second.key];
+    }
+}
+
+// g_mutex is never held across a driver call: cached state is copied out under
+// the lock, the driver is queried unlocked and the lock is taken again only to
+// publish the result. The device is looked up again at that point since the
+// display may have been detached meanwhile. Concurrent misses may query the
+// driver twice, which is harmless as the answers are the same.
+
+void AttachDisplay(VADisplay dpy)
+{
+    {
+        std::lock_guard<std::mutex> guard(g_mutex);
+
+        auto it = g_displays.find(dpy);
+        if (it != g_displays.end())
+        {
+            it->second.numRefs++;
+            return;
+        }
+    }
+
+    DeviceKey key;
+    if (!GetDeviceKey(dpy, key))
+        return;
+
+    std::lock_guard<std::mutex> guard(g_mutex);
+
+    auto it = g_displays.find(dpy);
+    if (it != g_displays.end())
+    {
+        it->second.numRefs++;
+        return;
+    }
+
+    g_displays[dpy] = DisplayRef{ key, 1 };
+    g_devices[key].numDisplays++;
+}
+
+void DetachDisplay(VADisplay dpy)
+{
+    std::lock_guard<std::mutex> guard(g_mutex);
+
+    auto it = g_displays.find(dpy);
+    if (it == g_displays.end() || --it->second.numRefs)
+        return;
+
+    DeviceKey key = it->second.key;
+    g_displays.erase(it);
+
+    auto dev = g_devices.find(key);
+    if (dev != g_devices.end() && !--dev->second.numDisplays)
+        g_devices.erase(dev);
+}
+
+VAStatus QueryConfigProfiles(VADisplay dpy, VAProfile* profiles, int* num_profiles)
+{
+    if (!profiles || !num_profiles)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    bool attached = false;
+    {
+        std::lock_guard<std::mutex> guard(g_mutex);
+        DeviceCaps* dev = GetDevice(dpy);
+        attached = !!dev;
+
+        if (dev && dev->profilesValid)
+        {
+            std::copy(dev->profiles.begin(), dev->profiles.end(), profiles);
+            *num_profiles = int(dev->profiles.size());
+            return VA_STATUS_SUCCESS;
+        }
+    }
+
+    if (!attached)
+        return vaQueryConfigProfiles(dpy, profiles, num_profiles);
+
+    int n = vaMaxNumProfiles(dpy);
+    if (n <= 0)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::vector<VAProfile> list(n, VAProfileNone);
+
+    VAStatus sts = vaQueryConfigProfiles(dpy, list.data(), &n);
+    if (sts != VA_STATUS_SUCCESS)
+        return sts;
+
+    list.resize(n);
+    std::copy(list.begin(), list.end(), profiles);
+    *num_profiles = n;
+
+    std::lock_guard<std::mutex> guard(g_mutex);
+    DeviceCaps* dev = GetDevice(dpy);
+    if (dev && !dev->profilesValid)
+    {
+        dev->profiles.swap(list);
+        dev->profilesValid = true;
+    }
+
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus QueryConfigEntrypoints(VADisplay dpy, VAProfile profile, VAEntrypoint* entrypoints, int* num_entrypoints)
+{
+    if (!entrypoints || !num_entrypoints)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    bool attached = false;
+    {
+        std::lock_guard<std::mutex> guard(g_mutex);
+        DeviceCaps* dev = GetDevice(dpy);
+        attached = !!dev;
+
+        if (dev)
+        {
+            auto unsupported = dev->unsupportedProfiles.find(profile);
+            if (unsupported != dev->unsupportedProfiles.end())
+                return unsupported->second;
+
+            auto it = dev->entrypoints.find(profile);
+            if (it != dev->entrypoints.end())
+            {
+                std::copy(it->second.begin(), it->second.end(), entrypoints);
+                *num_entrypoints = int(it->second.size());
+                return VA_STATUS_SUCCESS;
+            }
+        }
+    }
+
+    if (!attached)
+        return vaQueryConfigEntrypoints(dpy, profile, entrypoints, num_entrypoints);
+
+    int n = vaMaxNumEntrypoints(dpy);
+    if (n <= 0)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::vector<VAEntrypoint> list(n);
+
+    VAStatus sts = vaQueryConfigEntrypoints(dpy, profile, list.data(), &n);
+
+    if (sts == VA_STATUS_SUCCESS)
+    {
+        list.resize(n);
+        std::copy(list.begin(), list.end(), entrypoints);
+        *num_entrypoints = n;
+    }
+
+    if (sts == VA_STATUS_SUCCESS || IsUnsupported(sts))
+    {
+        std::lock_guard<std::mutex> guard(g_mutex);
+        DeviceCaps* dev = GetDevice(dpy);
+        if (dev && sts == VA_STATUS_SUCCESS)
+            dev->entrypoints.emplace(profile, std::move(list));
+        else if (dev)
+            dev->unsupportedProfiles[profile] = sts;
+    }
+
+    return sts;
+}
+
+VAStatus GetConfigAttributes(VADisplay dpy, VAProfile profile, VAEntrypoint entrypoint, VAConfigAttrib* attrib_list, int num_attribs)
+{
+    if (num_attribs < 0 || (num_attribs && !attrib_list))
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    // attributes not seen yet and their positions in attrib_list
+    std::vector<VAConfigAttrib> missing;
+    std::vector<int>            missingIdx;
+
+    bool attached = false;
+    {
+        std::lock_guard<std::mutex> guard(g_mutex);
+        DeviceCaps* dev = GetDevice(dpy);
+        attached = !!dev;
+
+        if (dev)
+        {
+            auto unsupported = dev->unsupported.find(std::make_pair(profile, entrypoint));
+            if (unsupported != dev->unsupported.end())
+                return unsupported->second;
+
+            for (int i = 0; i < num_attribs; ++i)
+            {
+                auto it = dev->attribs.find(std::make_tuple(profile, entrypoint, attrib_list[i].type));
+                if (it != dev->attribs.end())
+                    attrib_list[i].value = it->second;
+                else
+                {
+                    missing.push_back({ attrib_list[i].type, 0 });
+                    missingIdx.push_back(i);
+                }
+            }
+
+            if (missing.empty())
+                return VA_STATUS_SUCCESS;
+        }
+    }
+
+    if (!attached)
+        return vaGetConfigAttributes(dpy, profile, entrypoint, attrib_list, num_attribs);
+
+    // ask the driver about all of the missing attributes at once
+    VAStatus sts = vaGetConfigAttributes(dpy, profile, entrypoint, missing.data(), int(missing.size()));
+
+    if (sts == VA_STATUS_SUCCESS)
+    {
+        for (size_t i = 0; i < missing.size(); ++i)
+            attrib_list[missingIdx[i]].value = missing[i].value;
+    }
+
+    if (sts == VA_STATUS_SUCCESS || IsUnsupported(sts))
+    {
+        std::lock_guard<std::mutex> guard(g_mutex);
+        DeviceCaps* dev = GetDevice(dpy);
+        if (dev && sts == VA_STATUS_SUCCESS)
+        {
+            for (auto const& attr : missing)
+                dev->attribs[std::make_tuple(profile, entrypoint, attr.type)] = attr.value;
+        }
+        else if (dev)
+            dev->unsupported[std::make_pair(profile, entrypoint)] = sts;
+    }
+
+    return sts;
+}
+
+VAStatus QueryProcessingRate(VADisplay dpy, VAProfile profile, VAEntrypoint entrypoint, VAConfigAttrib* attrib_list, int num_attribs,
+    VAProcessingRateParameter* proc_buf, unsigned int* processing_rate)
+{
+    if (num_attribs < 0 || (num_attribs && !attrib_list) || !proc_buf || !processing_rate)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::string key;
+    key.append((const char*)&profile, sizeof(profile));
+    key.append((const char*)&entrypoint, sizeof(entrypoint));
+    key.append((const char*)attrib_list, num_attribs * sizeof(VAConfigAttrib));
+    key.append((const char*)proc_buf, sizeof(VAProcessingRateParameter));
+
+    {
+        std::lock_guard<std::mutex> guard(g_mutex);
+        DeviceCaps* dev = GetDevice(dpy);
+        if (dev)
+        {
+            auto it = dev->processingRates.find(key);
+            if (it != dev->processingRates.end())
+            {
+                *processing_rate = it->second;
+                return VA_STATUS_SUCCESS;
+            }
+        }
+    }
+
+    // the config is only needed for the query itself
+    VAConfigID config = VA_INVALID_ID;
+    VAStatus sts = vaCreateConfig(dpy, profile, entrypoint, attrib_list, num_attribs, &config);
+    if (sts != VA_STATUS_SUCCESS)
+        return sts;
+
+    sts = vaQueryProcessingRate(dpy, config, proc_buf, processing_rate);
+    vaDestroyConfig(dpy, config);
+
+    if (sts == VA_STATUS_SUCCESS)
+    {
+        std::lock_guard<std::mutex> guard(g_mutex);
+        DeviceCaps* dev = GetDevice(dpy);
+        if (dev)
+            dev->processingRates[key] = *processing_rate;
+    }
+
+    return sts;
+}
+
+} // namespace MfxVaCaps
+
+#endif // MFX_VA_LINUX
@@ -29,6 +29,7 @@
 #include "mfx_vpp_vaapi.h"
 #include "mfx_utils.h"
 #include "libmfx_core_vaapi.h"
+#include "mfx_va_caps_cache.h"
 #include <algorithm>
 
 template<typename T>
@@ -235,7 +236,7 @@ mfxStatus VAAPIVideoProcessing::Init(_mfxPlatformAccelerationService* pVADisplay
 
         mfxI32 entrypointsCount = 0, entrypointsIndx = 0;
 
-        vaSts = vaQueryConfigEntrypoints(m_vaDisplay,
+        vaSts = MfxVaCaps::QueryConfigEntrypoints(m_vaDisplay,
                                             VAProfileNone,
                                             va_entrypoints,
                                             &entrypointsCount);
@@ -520,7 +521,7 @@ mfxStatus VAAPIVideoProcessing::QueryCapabilities(mfxVppCaps& caps)
 
     std::vector<VAConfigAttrib> attrib(1);
     attrib[0].type = VAConfigAttribContextPriority;
-    vaSts = vaGetConfigAttributes(m_vaDisplay,
+    vaSts = MfxVaCaps::GetConfigAttributes(m_vaDisplay,
                                   VAProfileNone,
                                   VAEntrypointVideoProc,
                                   attrib.data(),
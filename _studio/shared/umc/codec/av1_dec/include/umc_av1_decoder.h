@@ -53,6 +53,7 @@ namespace UMC_AV1_DECODER
             : allocator(nullptr)
             , async_depth(0)
             , film_grain(0)
+            , film_grain_on_cpu(0)
             , io_pattern(0)
         {}
 
@@ -61,6 +62,7 @@ namespace UMC_AV1_DECODER
         UMC::FrameAllocator* allocator;
         uint32_t             async_depth;
         uint32_t             film_grain;
+        uint32_t             film_grain_on_cpu; // film grain is applied by the caller, the driver only reconstructs
         uint32_t             io_pattern;
     };
 
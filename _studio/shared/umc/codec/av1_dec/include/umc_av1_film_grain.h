@@ -0,0 +1,167 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "umc_defs.h"
+#ifdef MFX_ENABLE_AV1_VIDEO_DECODE
+
+#ifndef __UMC_AV1_FILM_GRAIN_H_
+#define __UMC_AV1_FILM_GRAIN_H_
+
+#include "umc_av1_dec_defs.h"
+
+// Film grain synthesis process (AV1 spec 7.18.3) on the CPU, for 4:2:0 frames
+// with interleaved chroma: NV12 and 10-bit P010. Only adding the noise to the
+// samples is done by the row kernels below; the noise itself is integer math,
+// so the C and AVX2 kernels give bit exact output.
+
+namespace UMC_AV1_DECODER
+{
+    enum
+    {
+        FILM_GRAIN_STRIPE_HEIGHT = 32,  // luma rows
+        FILM_GRAIN_MAX_BIT_DEPTH = 10
+    };
+
+    // Locked frame, both planes share the pitch
+    struct FilmGrainFrame
+    {
+        uint8_t* y     = nullptr;
+        uint8_t* uv    = nullptr;
+        size_t   pitch = 0;
+    };
+
+    // Per plane (Y, Cb, Cr) noise scaling and clipping of a frame
+    struct FilmGrainScaling
+    {
+        int32_t lut[3][1 << FILM_GRAIN_MAX_BIT_DEPTH]; // scale_lut() over the whole sample range
+        int32_t shift;                                 // ScalingShift
+        int32_t minValue[3];                           // planes without noise keep their samples,
+        int32_t maxValue[3];                           // they get a zero LUT and the full range here
+        int32_t maxSample;                             // (1 << BitDepth) - 1
+        int32_t sampleShift;                           // of the samples in 16-bit containers (6 for P010)
+
+        // chroma only, index 0 for Cb and 1 for Cr
+        bool    fromLuma;                              // chroma_scaling_from_luma
+        int32_t lumaMult[2];                           // cb_luma_mult - 128
+        int32_t mult[2];                               // cb_mult - 128
+        int32_t offset[2];                             // (cb_offset - 256) << (BitDepth - 8)
+    };
+
+    // dst[i] = Clip3(min, max, src[i] + Round2(lut[src[i]] * noise[i], shift)) for the luma plane
+    typedef void (*FilmGrainLumaRow8Func)   (uint8_t const* src, uint8_t* dst, int16_t const* noise, int32_t width, FilmGrainScaling const&);
+    typedef void (*FilmGrainLumaRow16Func)  (uint16_t const* src, uint16_t* dst, int16_t const* noise, int32_t width, FilmGrainScaling const&);
+    // the same for an interleaved chroma row, the LUT index is taken from the average
+    // of the two co-located luma samples; lumaWidth limits the luma samples to read
+    typedef void (*FilmGrainChromaRow8Func) (uint8_t const* srcY, uint8_t const* srcUV, uint8_t* dstUV, int16_t const* noiseCb, int16_t const* noiseCr,
+                                             int32_t width, int32_t lumaWidth, FilmGrainScaling const&);
+    typedef void (*FilmGrainChromaRow16Func)(uint16_t const* srcY, uint16_t const* srcUV, uint16_t* dstUV, int16_t const* noiseCb, int16_t const* noiseCr,
+                                             int32_t width, int32_t lumaWidth, FilmGrainScaling const&);
+
+    struct FilmGrainKernels
+    {
+        FilmGrainLumaRow8Func    LumaRow8;
+        FilmGrainLumaRow16Func   LumaRow16;
+        FilmGrainChromaRow8Func  ChromaRow8;
+        FilmGrainChromaRow16Func ChromaRow16;
+    };
+
+    // AVX2 rows where the CPU has AVX2 and allowSimd is set, C rows otherwise
+    void GetFilmGrainKernels(FilmGrainKernels& kernels, bool allowSimd = true);
+
+    void FilmGrainLumaRow8_C   (uint8_t const* src, uint8_t* dst, int16_t const* noise, int32_t width, FilmGrainScaling const&);
+    void FilmGrainLumaRow16_C  (uint16_t const* src, uint16_t* dst, int16_t const* noise, int32_t width, FilmGrainScaling const&);
+    void FilmGrainChromaRow8_C (uint8_t const* srcY, uint8_t const* srcUV, uint8_t* dstUV, int16_t const* noiseCb, int16_t const* noiseCr,
+                                int32_t width, int32_t lumaWidth, FilmGrainScaling const&);
+    void FilmGrainChromaRow16_C(uint16_t const* srcY, uint16_t const* srcUV, uint16_t* dstUV, int16_t const* noiseCb, int16_t const* noiseCr,
+                                int32_t width, int32_t lumaWidth, FilmGrainScaling const&);
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define UMC_AV1_FILM_GRAIN_AVX2
+    void FilmGrainLumaRow8_AVX2   (uint8_t const* src, uint8_t* dst, int16_t const* noise, int32_t width, FilmGrainScaling const&);
+    void FilmGrainLumaRow16_AVX2  (uint16_t const* src, uint16_t* dst, int16_t const* noise, int32_t width, FilmGrainScaling const&);
+    void FilmGrainChromaRow8_AVX2 (uint8_t const* srcY, uint8_t const* srcUV, uint8_t* dstUV, int16_t const* noiseCb, int16_t const* noiseCr,
+                                   int32_t width, int32_t lumaWidth, FilmGrainScaling const&);
+    void FilmGrainChromaRow16_AVX2(uint16_t const* srcY, uint16_t const* srcUV, uint16_t* dstUV, int16_t const* noiseCb, int16_t const* noiseCr,
+                                   int32_t width, int32_t lumaWidth, FilmGrainScaling const&);
+#endif
+
+    // Adds film grain to a decoded frame. Init() generates the grain templates
+    // and scaling tables once per frame, then the frame is processed in stripes
+    // of 32 luma rows which are independent of each other: every stripe derives
+    // its random offsets from its own seed and rebuilds the bottom rows of the
+    // stripe above it for the overlap, so any number of threads may call
+    // ApplyStripe() at the same time.
+    class FilmGrainSynthesizer
+    {
+    public:
+
+        FilmGrainSynthesizer();
+
+        // width x height are the luma samples to process (UpscaledWidth x FrameHeight),
+        // sampleShift is the position of the samples in 16-bit containers
+        void Init(FilmGrainParams const&, uint32_t width, uint32_t height, bool identityMatrix, uint32_t sampleShift);
+
+        uint32_t GetStripeCount() const
+        { return (m_height + FILM_GRAIN_STRIPE_HEIGHT - 1) / FILM_GRAIN_STRIPE_HEIGHT; }
+
+        // Reads the samples of the stripe from src and writes them with noise to dst,
+        // src and dst may be the same frame
+        void ApplyStripe(uint32_t stripe, FilmGrainFrame const& src, FilmGrainFrame const& dst) const;
+
+    private:
+
+        enum
+        {
+            LUMA_GRAIN_H   = 73,
+            LUMA_GRAIN_W   = 82,
+            CHROMA_GRAIN_H = 38,
+            CHROMA_GRAIN_W = 44
+        };
+
+        void GenerateLumaGrain();
+        void GenerateChromaGrain();
+        void InitScaling(bool identityMatrix, uint32_t sampleShift);
+
+        // Writes rows [first, first + count) of the noise stripe of the plane (noiseStripe[stripe][plane] in the spec)
+        void BuildNoiseStripe(uint32_t stripe, int32_t plane, int32_t first, int32_t count, int16_t* dst, size_t pitch) const;
+        // Noise image rows of the stripe with the vertical overlap applied
+        void BuildNoise(uint32_t stripe, int32_t plane, int32_t rows, int16_t* dst, size_t pitch) const;
+
+    private:
+
+        FilmGrainParams   m_params;
+        uint32_t          m_width;
+        uint32_t          m_height;
+        int32_t           m_grainMin;
+        int32_t           m_grainMax;
+
+        int16_t           m_lumaGrain[LUMA_GRAIN_H][LUMA_GRAIN_W];
+        int16_t           m_cbGrain[CHROMA_GRAIN_H][CHROMA_GRAIN_W];
+        int16_t           m_crGrain[CHROMA_GRAIN_H][CHROMA_GRAIN_W];
+
+        FilmGrainScaling  m_scaling;
+        FilmGrainKernels  m_kernels;
+    };
+}
+
+#endif // __UMC_AV1_FILM_GRAIN_H_
+#endif // MFX_ENABLE_AV1_VIDEO_DECODE
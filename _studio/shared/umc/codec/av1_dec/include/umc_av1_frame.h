@@ -179,6 +179,13 @@ namespace UMC_AV1_DECODER
         void DisableFilmGrain()
         { film_grain_disabled = true; }
 
+        // Film grain is synthesized from data[SURFACE_RECON] to data[SURFACE_DISPLAY]
+        // after decoding instead of being applied by the driver
+        bool FilmGrainOnCpu() const
+        { return film_grain_on_cpu; }
+        void SynthesizeFilmGrainOnCpu()
+        { film_grain_on_cpu = true; }
+
         UMC::FrameData* GetFrameData(int idx = SURFACE_DISPLAY)
         { return data[idx].get(); }
         UMC::FrameData const* GetFrameData(int idx = SURFACE_DISPLAY) const
@@ -248,6 +255,7 @@ namespace UMC_AV1_DECODER
         bool                              ref_valid;
 
         bool                              film_grain_disabled;
+        bool                              film_grain_on_cpu;
 
         mfxF64                            frame_time;
         mfxU16                            frame_order;
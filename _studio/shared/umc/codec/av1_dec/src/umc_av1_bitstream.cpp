@@ -1206,9 +1206,10 @@ namespace UMC_AV1_DECODER
 
     void AV1Bitstream::ReadByteAlignment()
     {
-        if (m_bitOffset)
+        const uint32_t bitOffset = BitsDecoded() & 7;
+        if (bitOffset)
         {
-            const uint32_t bitsToRead = 8 - m_bitOffset;
+            const uint32_t bitsToRead = 8 - bitOffset;
             const uint32_t bits = GetBits(bitsToRead);
             if (bits)
                 throw av1_exception(UMC::UMC_ERR_INVALID_STREAM);
@@ -1240,12 +1241,12 @@ namespace UMC_AV1_DECODER
 
     uint64_t AV1Bitstream::GetLE(uint32_t n)
     {
-        VM_ASSERT(m_bitOffset == 0);
+        VM_ASSERT(IsByteAligned());
         VM_ASSERT(n <= 8);
 
         uint64_t t = 0;
         for (uint32_t i = 0; i < n; i++)
-            t += (*m_pbs++) << (i * 8);
+            t += uint64_t(GetBits(8)) << (i * 8);
 
         return t;
     }
@@ -1258,7 +1259,7 @@ namespace UMC_AV1_DECODER
         if (BytesLeft() < reportedSize)
             actualSize = BytesLeft();
 
-        m_pbs += actualSize;
+        Seek(static_cast<int32_t>(actualSize * 8));
     }
 
     void AV1Bitstream::ReadSequenceHeader(SequenceHeader& sh)
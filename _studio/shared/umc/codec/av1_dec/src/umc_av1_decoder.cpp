@@ -285,6 +285,8 @@ namespace UMC_AV1_DECODER
 
         if (!params.film_grain)
             pFrame->DisableFilmGrain();
+        else if (params.film_grain_on_cpu)
+            pFrame->SynthesizeFilmGrainOnCpu();
 
         return pFrame;
     }
@@ -136,7 +136,8 @@ namespace UMC_AV1_DECODER
             uint32_t index = 0;
 
             VAStatus surfErr = VA_STATUS_SUCCESS;
-            index = frame.GetMemID();
+            // the driver writes only the reconstructed surface if film grain is added on the CPU
+            index = frame.FilmGrainOnCpu() ? frame.GetMemID(SURFACE_RECON) : frame.GetMemID();
             auto_guard.unlock();
             UMC::Status sts =  packer->SyncTask(index, &surfErr);
             auto_guard.lock();
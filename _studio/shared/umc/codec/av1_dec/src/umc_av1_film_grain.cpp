@@ -0,0 +1,625 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "umc_defs.h"
+#ifdef MFX_ENABLE_AV1_VIDEO_DECODE
+
+#include <algorithm>
+#include <memory>
+
+#include "mfx_utils.h"
+#include "umc_av1_film_grain.h"
+
+namespace UMC_AV1_DECODER
+{
+    // Gaussian_Sequence of the AV1 spec
+    static const int16_t GaussianSequence[2048] =
+    {
+           56,   568,  -180,   172,   124,   -84,   172,   -64,  -900,    24,   820,   224,  1248,   996,   272,    -8,
+         -916,  -388,  -732,  -104,  -188,   800,   112,  -652,  -320,  -376,   140,  -252,   492,  -168,    44,  -788,
+          588,  -584,   500,  -228,    12,   680,   272,  -476,   972,  -100,   652,   368,   432,  -196,  -720,  -192,
+         1000,  -332,   652,  -136,  -552,  -604,    -4,   192,  -220,  -136,  1000,   -52,   372,   -96,  -624,   124,
+          -24,   396,   540,   -12,  -104,   640,   464,   244,  -208,   -84,   368,  -528,  -740,   248,  -968,  -848,
+          608,   376,   -60,  -292,   -40,  -156,   252,  -292,   248,   224,  -280,   400,  -244,   244,   -60,    76,
+          -80,   212,   532,   340,   128,   -36,   824,  -352,   -60,  -264,   -96,  -612,   416,  -704,   220,  -204,
+          640,  -160,  1220,  -408,   900,   336,    20,  -336,   -96,  -792,   304,    48,   -28, -1232, -1172,  -448,
+          104,  -292,  -520,   244,    60,  -948,     0,  -708,   268,   108,   356,  -548,   488,  -344,  -136,   488,
+         -196,  -224,   656,  -236, -1128,    60,     4,   140,   276,  -676,  -376,   168,  -108,   464,     8,   564,
+           64,   240,   308,  -300,  -400,  -456,  -136,    56,   120,  -408,  -116,   436,   504,  -232,   328,   844,
+         -164,   -84,   784,  -168,   232,  -224,   348,  -376,   128,   568,    96, -1244,  -288,   276,   848,   832,
+         -360,   656,   464,  -384,  -332,  -356,   728,  -388,   160,  -192,   468,   296,   224,   140,  -776,  -100,
+          280,     4,   196,    44,   -36,  -648,   932,    16,  1428,    28,   528,   808,   772,    20,   268,    88,
+         -332,  -284,   124,  -384,  -448,   208,  -228, -1044,  -328,   660,   380,  -148,  -300,   588,   240,   540,
+           28,   136,   -88,  -436,   256,   296, -1000,  1400,     0,   -48,  1056,  -136,   264,  -528, -1108,   632,
+         -484,  -592,  -344,   796,   124,  -668,  -768,   388,  1296,  -232,  -188,  -200,  -288,    -4,   308,   100,
+         -168,   256,  -500,   204,  -508,   648,  -136,   372,  -272,  -120, -1004,  -552,  -548,  -384,   548,  -296,
+          428,  -108,    -8,  -912,  -324,  -224,   -88,  -112,  -220,  -100,   996,  -796,   548,   360,  -216,   180,
+          428,  -200,  -212,   148,    96,   148,   284,   216,  -412,  -320,   120,  -300,  -384,  -604,  -572,  -332,
+           -8,  -180,  -176,   696,   116,   -88,   628,    76,    44,  -516,   240,  -208,   -40,   100,  -592,   344,
+         -308,  -452,  -228,    20,   916, -1752,  -136,  -340,  -804,   140,    40,   512,   340,   248,   184,  -492,
+          896,  -156,   932,  -628,   328,  -688,  -448,  -616,  -752,  -100,   560, -1020,   180,  -800,   -64,    76,
+          576,  1068,   396,   660,   552,  -108,   -28,   320,  -628,   312,   -92,   -92,  -472,   268,    16,   560,
+          516,  -672,   -52,   492,  -100,   260,   384,   284,   292,   304,  -148,    88,  -152,  1012,  1064,  -228,
+          164,  -376,  -684,   592,  -392,   156,   196,  -524,   -64,  -884,   160,  -176,   636,   648,   404,  -396,
+         -436,   864,   424,  -728,   988,  -604,   904,  -592,   296,  -224,   536,  -176,  -920,   436,   -48,  1176,
+         -884,   416,  -776,  -824,  -884,   524,  -548,  -564,   -68,  -164,   -96,   692,   364,  -692, -1012,   -68,
+          260,  -480,   876, -1116,   452,  -332,  -352,   892, -1088,  1220,  -676,    12,  -292,   244,   496,   372,
+          -32,   280,   200,   112,  -440,   -96,    24,  -644,  -184,    56,  -432,   224,  -980,   272,  -260,   144,
+         -436,   420,   356,   364,  -528,    76,   172,  -744,  -368,   404,  -752,  -416,   684,  -688,    72,   540,
+          416,    92,   444,   480,   -72, -1416,   164, -1172,   -68,    24,   424,   264,  1040,   128,  -912,  -524,
+         -356,    64,   876,   -12,     4,   -88,   532,   272,  -524,   320,   276,  -508,   940,    24,  -400,  -120,
+          756,    60,   236,  -412,   100,   376,  -484,   400,  -100,  -740,  -108,  -260,   328,  -268,   224,  -200,
+         -416,   184,  -604,  -564,   -20,   296,    60,   892,  -888,    60,   164,    68,  -760,   216,  -296,   904,
+         -336,   -28,   404,  -356,  -568,  -208, -1480,  -512,   296,   328,  -360,  -164, -1560,  -776,  1156,  -428,
+          164,  -504,  -112,   120,  -216,  -148,  -264,   308,    32,    64,   -72,    72,   116,   176,   -64,  -272,
+          460,  -536,  -784,  -280,   348,   108,  -752,  -132,   524,  -540,  -776,   116,  -296, -1196,  -288,  -560,
+         1040,  -472,   116,  -848, -1116,   116,   636,   696,   284,  -176,  1016,   204,  -864,  -648,  -248,   356,
+          972,  -584,  -204,   264,   880,   528,   -24,  -184,   116,   448,  -144,   828,   524,   212,  -212,    52,
+           12,   200,   268,  -488,  -404,  -880,   824,  -672,   -40,   908,  -248,   500,   716,  -576,   492,  -576,
+           16,   720,  -108,   384,   124,   344,   280,   576,  -500,   252,   104,  -308,   196,  -188,    -8,  1268,
+          296,  1032, -1196,   436,   316,   372,  -432,  -200,  -660,   704,  -224,   596,  -132,   268,    32,  -452,
+          884,   104, -1008,   424, -1348,  -280,     4, -1168,   368,   476,   696,   300,    -8,    24,   180,  -592,
+         -196,   388,   304,   500,   724,  -160,   244,   -84,   272,  -256,  -420,   320,   208,  -144,  -156,   156,
+          364,   452,    28,   540,   316,   220,  -644,  -248,   464,    72,   360,    32,  -388,   496,  -680,   -48,
+          208,  -116,  -408,    60,  -604,  -392,   548,  -840,   784,  -460,   656,  -544,  -388,  -264,   908,  -800,
+         -628,  -612,  -568,   572,  -220,   164,   288,   -16,  -308,   308,  -112,  -636,  -760,   280,  -668,   432,
+          364,   240,  -196,   604,   340,   384,   196,   592,   -44,  -500,   432,  -580,  -132,   636,   -76,   392,
+            4,  -412,   540,   508,   328,  -356,   -36,    16,  -220,   -64,  -248,   -60,    24,  -192,   368,  1040,
+           92,   -24, -1044,   -32,    40,   104,   148,   192,  -136,  -520,    56,  -816,  -224,   732,   392,   356,
+          212,   -80,  -424, -1008,  -324,   588, -1496,   576,   460,  -816,  -848,    56,  -580,   -92, -1372,  -112,
+         -496,   200,   364,    52,  -140,    48,   -48,   -60,    84,    72,    40,   132,  -356,  -268,  -104,  -284,
+         -404,   732,  -520,   164,  -304,  -540,   120,   328,   -76,  -460,   756,   388,   588,   236,  -436,   -72,
+         -176,  -404,  -316,  -148,   716,  -604,   404,   -72,   -88,  -888,   -68,   944,    88,  -220,  -344,   960,
+          472,   460,  -232,   704,   120,   832,  -228,   692,  -508,   132,  -476,   844,  -748,  -364,   -44,  1116,
+        -1104, -1056,    76,   428,   552,  -692,    60,   356,    96,  -384,  -188,  -612,  -576,   736,   508,   892,
+          352, -1132,   504,   -24,  -352,   324,   332,  -600,  -312,   292,   508,  -144,    -8,   484,    48,   284,
+         -260,  -240,   256,  -100,  -292,  -204,   -44,   472,  -204,   908,  -188, -1000,  -256,    92,  1164,  -392,
+          564,   356,   652,   -28,  -884,   256,   484,  -192,   760,  -176,   376,  -524,  -452,  -436,   860,  -736,
+          212,   124,   504,  -476,   468,    76,  -472,   552,  -692,  -944,  -620,   740,  -240,   400,   132,    20,
+          192,  -196,   264,  -668, -1012,   -60,   296,  -316,  -828,    76,  -156,   284,  -768,  -448,  -832,   148,
+          248,   652,   616,  1236,   288,  -328,  -400,  -124,   588,   220,   520,  -696,  1032,   768,  -740,   -92,
+         -272,   296,   448,  -464,   412,  -200,   392,   440,  -200,   264,  -152,  -260,   320,  1032,   216,   320,
+           -8,   -64,   156, -1016,  1084,  1172,   536,   484,  -432,   132,   372,   -52,  -256,    84,   116,  -352,
+           48,   116,   304,  -384,   412,   924,  -300,   528,   628,   180,   648,    44,  -980,  -220,  1320,    48,
+          332,   748,   524,  -268,  -720,   540,  -276,   564,  -344,  -208,  -196,   436,   896,    88,  -392,   132,
+           80,  -964,  -288,   568,    56,   -48,  -456,   888,     8,   552,  -156,  -292,   948,   288,   128,  -716,
+         -292,  1192,  -152,   876,   352,  -600,  -260,  -812,  -468,   -28,  -120,   -32,   -44,  1284,   496,   192,
+          464,   312,   -76,  -516,  -380,  -456, -1012,   -48,   308,  -156,    36,   492,  -156,  -808,   188,  1652,
+           68,  -120,  -116,   316,   160,  -140,   352,   808,  -416,   592,   316,  -480,    56,   528,  -204,  -568,
+          372,  -232,   752,  -344,   744,    -4,   324,  -416,  -600,   768,   268,  -248,   -88,  -132,  -420,  -432,
+           80,  -288,   404,  -316, -1216,  -588,   520,  -108,    92,  -320,   368,  -480,  -216,   -92,  1688,  -300,
+          180,  1020,  -176,   820,   -68,  -228,  -260,   436,  -904,    20,    40,  -508,   440,  -736,   312,   332,
+          204,   760,  -372,   728,    96,   -20,  -632,  -520,  -560,   336,  1076,   -64,  -532,   776,   584,   192,
+          396,  -728,  -520,   276,  -188,    80,   -52,  -612,  -252,   -48,   648,   212,  -688,   228,   -52,  -260,
+          428,  -412,  -272,  -404,   180,   816,  -796,    48,   152,   484,   -88,  -216,   988,   696,   188,  -528,
+          648,  -116,  -180,   316,   476,    12,  -564,    96,   476,  -252,  -364,  -376,  -392,   556,  -256,  -576,
+          260,  -352,   120,   -16,  -136,  -260,  -492,    72,   556,   660,   580,   616,   772,   436,   424,   -32,
+         -324, -1268,   416,  -324,   -80,   920,   160,   228,   724,    32,  -516,    64,   384,    68,  -128,   136,
+          240,   248,  -204,   -68,   252,  -932,  -120,  -480,  -628,   -84,   192,   852,  -404,  -288,  -132,   204,
+          100,   168,   -68,  -196,  -868,   460,  1080,   380,   -80,   244,     0,   484,  -888,    64,   184,   352,
+          600,   460,   164,   604,  -196,   320,   -64,   588,  -184,   228,    12,   372,    48,  -848,  -344,   224,
+          208,  -200,   484,   128,   -20,   272,  -468,  -840,   384,   256,  -720,  -520,  -464,  -580,   112,  -120,
+          644,  -356,  -208,  -608,  -528,   704,   560,  -424,   392,   828,    40,    84,   200,  -152,     0,  -144,
+          584,   280,  -120,    80,  -556,  -972,  -196,  -472,   724,    80,   168,   -32,    88,   160,  -688,     0,
+          160,   356,   372,  -776,   740,  -128,   676,  -248,  -480,     4,  -364,    96,   544,   232, -1032,   956,
+          236,   356,    20,   -40,   300,    24,  -676,  -596,   132,  1120,  -104,   532, -1096,   568,   648,   444,
+          508,   380,   188,  -376,  -604,  1488,   424,    24,   756,  -220,  -192,   716,   120,   920,   688,   168,
+           44,  -460,   568,   284,  1144,  1160,   600,   424,   888,   656,  -356,  -320,   220,   316,  -176,  -724,
+         -188,  -816,  -628,  -348,  -228,  -380,  1012,  -452,  -660,   736,   928,   404,  -696,   -72,  -268,  -892,
+          128,   184,  -344,  -780,   360,   336,   400,   344,   428,   548,  -112,   136,  -228,  -216,  -820,  -516,
+          340,    92,  -136,   116,  -300,   376,  -244,   100,  -316,  -520,  -284,   -12,   824,   164,  -548,  -180,
+         -128,   116,  -924,  -828,   268,  -368,  -580,   620,   192,   160,     0, -1676,  1068,   424,   -56,  -360,
+          468,  -156,   720,   288,  -528,   556,  -364,   548,  -148,   504,   316,   152,  -648,  -620,  -684,   -24,
+         -376,  -384,  -108,  -920, -1032,   768,   180,  -264,  -508, -1268,  -260,   -60,   300,  -240,   988,   724,
+         -376,  -576,  -212,  -736,   556,   192,  1092,  -620,  -880,   376,   -56,    -4,  -216,   -32,   836,   268,
+          396,  1332,   864,  -600,   100,    56,  -412,   -92,   356,   180,   884,  -468,  -436,   292,  -388,  -804,
+         -704,  -840,   368,  -348,   140,  -724,  1536,   940,   372,   112,  -372,   436,  -480,  1136,   296,   -32,
+         -228,   132,   -48,  -220,   868, -1016,   -60, -1044,  -464,   328,   916,   244,    12,  -736,  -296,   360,
+          468,  -376,  -108,   -92,   788,   368,   -56,   544,   400,  -672,  -420,   728,    16,   320,    44,  -284,
+         -380,  -796,   488,   132,   204,  -596,  -372,    88,  -152,  -908,  -636,  -572,  -624,  -116,  -692,  -200,
+          -56,   276,   -88,   484,  -324,   948,   864,  1000,  -456,  -184,  -276,   292,  -296,   156,   676,   320,
+          160,   908,   -84, -1236,  -288,  -116,   260,  -372,  -644,   732,  -756,   -96,    84,   344,  -520,   348,
+         -688,   240,   -84,   216, -1044,  -136,  -676,  -396, -1500,   960,   -40,   176,   168,  1516,   420,  -504,
+         -344,  -364,  -360,  1216,  -940,  -380,  -212,   252,  -660,  -708,   484,  -444,  -152,   928,  -120,  1112,
+          476,  -260,   560,  -148,  -344,   108,  -196,   228,  -288,   504,   560,  -328,   -88,   288, -1008,   460,
+         -228,   468,  -836,  -196,    76,   388,   232,   412, -1168,  -716,  -644,   756,  -172,  -356,  -504,   116,
+          432,   528,    48,   476,  -168,  -608,   448,   160,  -532,  -272,    28,  -676,   -12,   828,   980,   456,
+          520,   104,  -104,   256,  -344,    -4,   -28,  -368,   -52,  -524,  -572,  -556,  -200,   768,  1124,  -208,
+         -512,   176,   232,   248,  -148,  -888,   604,  -600,  -304,   804,  -156,  -212,   488,  -192,  -804,  -256,
+          368,  -360,  -916,  -328,   228,  -240,  -448,  -472,   856,  -556,  -364,   572,   -12,  -156,  -368,  -340,
+          432,   252,  -752,  -152,   288,   268,  -580,  -848,  -592,   108,   -76,   244,   312,  -716,   592,   -80,
+          436,   360,     4,  -248,   160,   516,   584,   732,    44,  -468,  -280,  -292,  -156,  -588,    28,   308,
+          912,    24,   124,   156,   180,  -252,   944,  -924,  -772,  -520,  -428,  -624,   300,  -212, -1144,    32,
+         -724,   800, -1128,  -212, -1288,  -848,   180,  -416,   440,   192,  -576,  -792,   -76, -1080,    80,  -532,
+         -352,  -132,   380,  -820,   148,  1112,   128,   164,   456,   700,  -924,   144,  -668,  -384,   648,  -832,
+          508,   552,   -52,  -100,  -656,   208,  -568,   748,   -88,   680,   232,   300,   192,  -408, -1012,  -152,
+         -252,  -268,   272,  -876,  -664,  -648,  -332,  -136,    16,    12,  1152,   -28,   332,  -536,   320,  -672,
+         -460,  -316,   532,  -260,   228,   -40,  1052,  -816,   180,    88,  -496,  -556,  -672,  -368,   428,    92,
+          356,   404,  -408,   252,   196,  -176,  -556,   792,   268,    32,   372,    40,    96,  -332,   328,   120,
+          372,  -900,   -40,   472,  -264,  -592,   952,   128,   656,   112,   664,  -232,   420,     4,  -344,  -464,
+          556,   244,  -416,   -32,   252,     0,  -412,   188,  -696,   508,  -476,   324, -1096,   656,  -312,   560,
+          264,  -136,   304,   160,   -64,  -580,   248,   336,  -720,   560,  -348,  -288,  -276,  -196,  -500,   852,
+         -544,  -236, -1128,  -992,  -776,   116,    56,    52,   860,   884,   212,   -12,   168,  1020,   512,  -552,
+          924,  -148,   716,   188,   164,  -340,  -520,  -184,   880,  -152,  -680,  -208, -1156,  -300,  -528,  -472,
+          364,   100,  -744, -1056,   -32,   540,   280,   144,  -676,   -32,  -232,  -280,  -224,    96,   568,   -76,
+          172,   148,   148,   104,    32,  -296,   -32,   788,   -80,    32,   -16,   280,   288,   944,   428,  -484,
+    };
+
+    // 16-bit LFSR of get_random_number()
+    inline int32_t GetRandomNumber(uint16_t& reg, int32_t bits)
+    {
+        uint32_t r = reg;
+        uint32_t const bit = ((r >> 0) ^ (r >> 1) ^ (r >> 3) ^ (r >> 12)) & 1;
+        r = (r >> 1) | (bit << 15);
+        reg = static_cast<uint16_t>(r);
+
+        return (r >> (16 - bits)) & ((1 << bits) - 1);
+    }
+
+    inline int32_t Round2(int32_t x, int32_t n)
+    {
+        return n ? (x + (1 << (n - 1))) >> n : x;
+    }
+
+    // Piecewise linear scaling function of the points, 8-bit index
+    static void InitScalingFunction(int32_t numPoints, int32_t const* value, int32_t const* scaling, int32_t lut[256])
+    {
+        if (!numPoints)
+        {
+            std::fill_n(lut, 256, 0);
+            return;
+        }
+
+        std::fill_n(lut, value[0], scaling[0]);
+
+        for (int32_t i = 0; i < numPoints - 1; i++)
+        {
+            int32_t const deltaY = scaling[i + 1] - scaling[i];
+            int32_t const deltaX = value[i + 1] - value[i];
+            int32_t const delta = deltaY * ((65536 + (deltaX >> 1)) / deltaX);
+
+            for (int32_t x = 0; x < deltaX; x++)
+                lut[value[i] + x] = scaling[i] + ((x * delta + 32768) >> 16);
+        }
+
+        std::fill(lut + value[numPoints - 1], lut + 256, scaling[numPoints - 1]);
+    }
+
+    void FilmGrainLumaRow8_C(uint8_t const* src, uint8_t* dst, int16_t const* noise, int32_t width, FilmGrainScaling const& s)
+    {
+        for (int32_t x = 0; x < width; x++)
+        {
+            int32_t const orig = src[x];
+            int32_t const v = orig + Round2(s.lut[0][orig] * noise[x], s.shift);
+            dst[x] = static_cast<uint8_t>(mfx::clamp(v, s.minValue[0], s.maxValue[0]));
+        }
+    }
+
+    void FilmGrainLumaRow16_C(uint16_t const* src, uint16_t* dst, int16_t const* noise, int32_t width, FilmGrainScaling const& s)
+    {
+        for (int32_t x = 0; x < width; x++)
+        {
+            int32_t const orig = src[x] >> s.sampleShift;
+            int32_t const v = orig + Round2(s.lut[0][orig] * noise[x], s.shift);
+            dst[x] = static_cast<uint16_t>(mfx::clamp(v, s.minValue[0], s.maxValue[0]) << s.sampleShift);
+        }
+    }
+
+    template <typename T>
+    inline void ApplyChromaRow(T const* srcY, T const* srcUV, T* dstUV, int16_t const* noiseCb, int16_t const* noiseCr,
+                               int32_t width, int32_t lumaWidth, FilmGrainScaling const& s)
+    {
+        int16_t const* noise[2] = { noiseCb, noiseCr };
+
+        for (int32_t x = 0; x < width; x++)
+        {
+            int32_t const lumaX = x << 1;
+            int32_t const lumaNextX = std::min(lumaX + 1, lumaWidth - 1);
+            int32_t const averageLuma = ((srcY[lumaX] >> s.sampleShift) + (srcY[lumaNextX] >> s.sampleShift) + 1) >> 1;
+
+            for (int32_t c = 0; c < 2; c++)
+            {
+                int32_t const orig = srcUV[2 * x + c] >> s.sampleShift;
+                int32_t merged = averageLuma;
+                if (!s.fromLuma)
+                {
+                    int32_t const combined = averageLuma * s.lumaMult[c] + orig * s.mult[c];
+                    merged = mfx::clamp((combined >> 6) + s.offset[c], 0, s.maxSample);
+                }
+
+                int32_t const v = orig + Round2(s.lut[1 + c][merged] * noise[c][x], s.shift);
+                dstUV[2 * x + c] = static_cast<T>(mfx::clamp(v, s.minValue[1 + c], s.maxValue[1 + c]) << s.sampleShift);
+            }
+        }
+    }
+
+    void FilmGrainChromaRow8_C(uint8_t const* srcY, uint8_t const* srcUV, uint8_t* dstUV, int16_t const* noiseCb, int16_t const* noiseCr,
+                               int32_t width, int32_t lumaWidth, FilmGrainScaling const& s)
+    {
+        ApplyChromaRow(srcY, srcUV, dstUV, noiseCb, noiseCr, width, lumaWidth, s);
+    }
+
+    void FilmGrainChromaRow16_C(uint16_t const* srcY, uint16_t const* srcUV, uint16_t* dstUV, int16_t const* noiseCb, int16_t const* noiseCr,
+                                int32_t width, int32_t lumaWidth, FilmGrainScaling const& s)
+    {
+        ApplyChromaRow(srcY, srcUV, dstUV, noiseCb, noiseCr, width, lumaWidth, s);
+    }
+
+    void GetFilmGrainKernels(FilmGrainKernels& kernels, bool allowSimd)
+    {
+        kernels.LumaRow8    = FilmGrainLumaRow8_C;
+        kernels.LumaRow16   = FilmGrainLumaRow16_C;
+        kernels.ChromaRow8  = FilmGrainChromaRow8_C;
+        kernels.ChromaRow16 = FilmGrainChromaRow16_C;
+
+#if defined(UMC_AV1_FILM_GRAIN_AVX2)
+        if (allowSimd && __builtin_cpu_supports("avx2"))
+        {
+            kernels.LumaRow8    = FilmGrainLumaRow8_AVX2;
+            kernels.LumaRow16   = FilmGrainLumaRow16_AVX2;
+            kernels.ChromaRow8  = FilmGrainChromaRow8_AVX2;
+            kernels.ChromaRow16 = FilmGrainChromaRow16_AVX2;
+        }
+#else
+        (void)allowSimd;
+#endif
+    }
+
+    FilmGrainSynthesizer::FilmGrainSynthesizer()
+        : m_params()
+        , m_width(0)
+        , m_height(0)
+        , m_grainMin(0)
+        , m_grainMax(0)
+        , m_scaling()
+    {
+        GetFilmGrainKernels(m_kernels);
+    }
+
+    void FilmGrainSynthesizer::Init(FilmGrainParams const& params, uint32_t width, uint32_t height, bool identityMatrix, uint32_t sampleShift)
+    {
+        if (params.BitDepth < 8 || params.BitDepth > FILM_GRAIN_MAX_BIT_DEPTH)
+            throw av1_exception(UMC::UMC_ERR_UNSUPPORTED);
+
+        m_params = params;
+        m_width  = width;
+        m_height = height;
+
+        int32_t const grainCenter = 128 << (params.BitDepth - 8);
+        m_grainMin = -grainCenter;
+        m_grainMax = (256 << (params.BitDepth - 8)) - 1 - grainCenter;
+
+        GenerateLumaGrain();
+        GenerateChromaGrain();
+        InitScaling(identityMatrix, sampleShift);
+    }
+
+    void FilmGrainSynthesizer::GenerateLumaGrain()
+    {
+        FilmGrainParams const& p = m_params;
+
+        int32_t const shift = 12 - p.BitDepth + p.grain_scale_shift;
+        uint16_t reg = static_cast<uint16_t>(p.grain_seed);
+
+        for (int32_t y = 0; y < LUMA_GRAIN_H; y++)
+            for (int32_t x = 0; x < LUMA_GRAIN_W; x++)
+            {
+                int32_t const g = p.num_y_points ? GaussianSequence[GetRandomNumber(reg, 11)] : 0;
+                m_lumaGrain[y][x] = static_cast<int16_t>(Round2(g, shift));
+            }
+
+        if (!p.num_y_points)
+            return;
+
+        // auto-regressive filter, the current sample is the last one of the neighbourhood
+        int32_t const lag = p.ar_coeff_lag;
+        for (int32_t y = 3; y < LUMA_GRAIN_H; y++)
+            for (int32_t x = 3; x < LUMA_GRAIN_W - 3; x++)
+            {
+                int32_t sum = 0;
+                int32_t pos = 0;
+                for (int32_t deltaRow = -lag; deltaRow <= 0; deltaRow++)
+                    for (int32_t deltaCol = -lag; deltaCol <= lag; deltaCol++)
+                    {
+                        if (deltaRow == 0 && deltaCol == 0)
+                            break;
+
+                        sum += m_lumaGrain[y + deltaRow][x + deltaCol] * p.ar_coeffs_y[pos];
+                        pos++;
+                    }
+
+                int32_t const g = m_lumaGrain[y][x] + Round2(sum, p.ar_coeff_shift);
+                m_lumaGrain[y][x] = static_cast<int16_t>(mfx::clamp(g, m_grainMin, m_grainMax));
+            }
+    }
+
+    void FilmGrainSynthesizer::GenerateChromaGrain()
+    {
+        FilmGrainParams const& p = m_params;
+
+        int32_t const shift = 12 - p.BitDepth + p.grain_scale_shift;
+        bool const cb = p.num_cb_points || p.chroma_scaling_from_luma;
+        bool const cr = p.num_cr_points || p.chroma_scaling_from_luma;
+
+        uint16_t reg = static_cast<uint16_t>(p.grain_seed ^ 0xb524);
+        for (int32_t y = 0; y < CHROMA_GRAIN_H; y++)
+            for (int32_t x = 0; x < CHROMA_GRAIN_W; x++)
+                m_cbGrain[y][x] = static_cast<int16_t>(cb ? Round2(GaussianSequence[GetRandomNumber(reg, 11)], shift) : 0);
+
+        reg = static_cast<uint16_t>(p.grain_seed ^ 0x49d8);
+        for (int32_t y = 0; y < CHROMA_GRAIN_H; y++)
+            for (int32_t x = 0; x < CHROMA_GRAIN_W; x++)
+                m_crGrain[y][x] = static_cast<int16_t>(cr ? Round2(GaussianSequence[GetRandomNumber(reg, 11)], shift) : 0);
+
+        // auto-regressive filter, the last coefficient applies to the co-located luma grain
+        int32_t const lag = p.ar_coeff_lag;
+        for (int32_t y = 3; y < CHROMA_GRAIN_H; y++)
+            for (int32_t x = 3; x < CHROMA_GRAIN_W - 3; x++)
+            {
+                int32_t sum0 = 0;
+                int32_t sum1 = 0;
+                int32_t pos = 0;
+                for (int32_t deltaRow = -lag; deltaRow <= 0; deltaRow++)
+                    for (int32_t deltaCol = -lag; deltaCol <= lag; deltaCol++)
+                    {
+                        int32_t const c0 = p.ar_coeffs_cb[pos];
+                        int32_t const c1 = p.ar_coeffs_cr[pos];
+
+                        if (deltaRow == 0 && deltaCol == 0)
+                        {
+                            if (p.num_y_points)
+                            {
+                                int32_t const lumaX = ((x - 3) << 1) + 3;
+                                int32_t const lumaY = ((y - 3) << 1) + 3;
+                                int32_t const luma = Round2(m_lumaGrain[lumaY][lumaX] + m_lumaGrain[lumaY][lumaX + 1] +
+                                    m_lumaGrain[lumaY + 1][lumaX] + m_lumaGrain[lumaY + 1][lumaX + 1], 2);
+
+                                sum0 += luma * c0;
+                                sum1 += luma * c1;
+                            }
+                            break;
+                        }
+
+                        sum0 += c0 * m_cbGrain[y + deltaRow][x + deltaCol];
+                        sum1 += c1 * m_crGrain[y + deltaRow][x + deltaCol];
+                        pos++;
+                    }
+
+                if (cb)
+                    m_cbGrain[y][x] = static_cast<int16_t>(mfx::clamp(m_cbGrain[y][x] + Round2(sum0, p.ar_coeff_shift), m_grainMin, m_grainMax));
+                if (cr)
+                    m_crGrain[y][x] = static_cast<int16_t>(mfx::clamp(m_crGrain[y][x] + Round2(sum1, p.ar_coeff_shift), m_grainMin, m_grainMax));
+            }
+    }
+
+    void FilmGrainSynthesizer::InitScaling(bool identityMatrix, uint32_t sampleShift)
+    {
+        FilmGrainParams const& p = m_params;
+        FilmGrainScaling& s = m_scaling;
+
+        int32_t const bitDepth = p.BitDepth;
+        int32_t const rangeShift = bitDepth - 8;
+
+        int32_t lut[3][256];
+        InitScalingFunction(p.num_y_points, p.point_y_value, p.point_y_scaling, lut[0]);
+        if (p.chroma_scaling_from_luma)
+        {
+            std::copy_n(lut[0], 256, lut[1]);
+            std::copy_n(lut[0], 256, lut[2]);
+        }
+        else
+        {
+            InitScalingFunction(p.num_cb_points, p.point_cb_value, p.point_cb_scaling, lut[1]);
+            InitScalingFunction(p.num_cr_points, p.point_cr_value, p.point_cr_scaling, lut[2]);
+        }
+
+        // scale_lut() interpolates between the entries for high bit depths
+        for (int32_t plane = 0; plane < 3; plane++)
+            for (int32_t index = 0; index < (1 << bitDepth); index++)
+            {
+                int32_t const x = index >> rangeShift;
+                int32_t const rem = index - (x << rangeShift);
+                s.lut[plane][index] = (bitDepth == 8 || x == 255) ?
+                    lut[plane][x] : lut[plane][x] + Round2((lut[plane][x + 1] - lut[plane][x]) * rem, rangeShift);
+            }
+
+        s.shift       = p.grain_scaling;
+        s.maxSample   = (1 << bitDepth) - 1;
+        s.sampleShift = static_cast<int32_t>(sampleShift);
+
+        int32_t minValue = 0;
+        int32_t maxLuma = s.maxSample;
+        int32_t maxChroma = s.maxSample;
+        if (p.clip_to_restricted_range)
+        {
+            minValue = 16 << rangeShift;
+            maxLuma = 235 << rangeShift;
+            maxChroma = identityMatrix ? maxLuma : (240 << rangeShift);
+        }
+
+        bool const enabled[3] =
+        {
+            p.num_y_points > 0,
+            p.num_cb_points > 0 || p.chroma_scaling_from_luma,
+            p.num_cr_points > 0 || p.chroma_scaling_from_luma
+        };
+
+        for (int32_t plane = 0; plane < 3; plane++)
+        {
+            s.minValue[plane] = enabled[plane] ? minValue : 0;
+            s.maxValue[plane] = enabled[plane] ? (plane ? maxChroma : maxLuma) : s.maxSample;
+            if (!enabled[plane])
+                std::fill_n(s.lut[plane], 1 << bitDepth, 0);
+        }
+
+        s.fromLuma    = !!p.chroma_scaling_from_luma;
+        s.lumaMult[0] = p.cb_luma_mult - 128;
+        s.lumaMult[1] = p.cr_luma_mult - 128;
+        s.mult[0]     = p.cb_mult - 128;
+        s.mult[1]     = p.cr_mult - 128;
+        s.offset[0]   = (p.cb_offset - 256) * (1 << rangeShift);
+        s.offset[1]   = (p.cr_offset - 256) * (1 << rangeShift);
+    }
+
+    void FilmGrainSynthesizer::BuildNoiseStripe(uint32_t stripe, int32_t plane, int32_t first, int32_t count, int16_t* dst, size_t pitch) const
+    {
+        int32_t const sub = plane ? 1 : 0;
+        int32_t const blockRows = 34 >> sub;
+        int32_t const blockCols = 34 >> sub;
+        int32_t const last = std::min(first + count, blockRows);
+
+        int16_t const* grain = plane == 0 ? &m_lumaGrain[0][0] :
+                               plane == 1 ? &m_cbGrain[0][0] : &m_crGrain[0][0];
+        int32_t const grainPitch = plane ? CHROMA_GRAIN_W : LUMA_GRAIN_W;
+
+        uint16_t reg = static_cast<uint16_t>(m_params.grain_seed);
+        reg ^= static_cast<uint16_t>(((stripe * 37 + 178) & 255) << 8);
+        reg ^= static_cast<uint16_t>((stripe * 173 + 105) & 255);
+
+        // 32x32 luma blocks at random offsets of the template, the 2 extra
+        // columns (1 for chroma) are blended into the next block
+        for (int32_t x = 0; x < static_cast<int32_t>((m_width + 1) / 2); x += 16)
+        {
+            int32_t const rand = GetRandomNumber(reg, 8);
+            int32_t const offsetX = rand >> 4;
+            int32_t const offsetY = rand & 15;
+            int32_t const planeOffsetX = sub ? 6 + offsetX : 9 + offsetX * 2;
+            int32_t const planeOffsetY = sub ? 6 + offsetY : 9 + offsetY * 2;
+            int32_t const base = sub ? x : x * 2;
+            bool const overlap = m_params.overlap_flag && x > 0;
+
+            for (int32_t i = first; i < last; i++)
+            {
+                int16_t const* src = grain + (planeOffsetY + i) * grainPitch + planeOffsetX;
+                int16_t* row = dst + (i - first) * pitch + base;
+
+                int32_t j = 0;
+                if (overlap)
+                {
+                    if (sub)
+                    {
+                        row[0] = static_cast<int16_t>(mfx::clamp(Round2(row[0] * 23 + src[0] * 22, 5), m_grainMin, m_grainMax));
+                        j = 1;
+                    }
+                    else
+                    {
+                        row[0] = static_cast<int16_t>(mfx::clamp(Round2(row[0] * 27 + src[0] * 17, 5), m_grainMin, m_grainMax));
+                        row[1] = static_cast<int16_t>(mfx::clamp(Round2(row[1] * 17 + src[1] * 27, 5), m_grainMin, m_grainMax));
+                        j = 2;
+                    }
+                }
+
+                std::copy(src + j, src + blockCols, row + j);
+            }
+        }
+    }
+
+    void FilmGrainSynthesizer::BuildNoise(uint32_t stripe, int32_t plane, int32_t rows, int16_t* dst, size_t pitch) const
+    {
+        BuildNoiseStripe(stripe, plane, 0, rows, dst, pitch);
+
+        if (!m_params.overlap_flag || !stripe)
+            return;
+
+        // blend the top rows with the 2 extra rows (1 for chroma) of the stripe above
+        int32_t const sub = plane ? 1 : 0;
+        int32_t const overlapRows = std::min(2 >> sub, rows);
+        int32_t const width = static_cast<int32_t>((m_width + sub) >> sub);
+
+        std::unique_ptr<int16_t[]> prev(new int16_t[2 * pitch]);
+        BuildNoiseStripe(stripe - 1, plane, FILM_GRAIN_STRIPE_HEIGHT >> sub, overlapRows, prev.get(), pitch);
+
+        for (int32_t i = 0; i < overlapRows; i++)
+        {
+            int16_t const* old = prev.get() + i * pitch;
+            int16_t* row = dst + i * pitch;
+
+            int32_t w0 = 23, w1 = 22;
+            if (!sub)
+            {
+                w0 = i ? 17 : 27;
+                w1 = i ? 27 : 17;
+            }
+
+            for (int32_t x = 0; x < width; x++)
+                row[x] = static_cast<int16_t>(mfx::clamp(Round2(old[x] * w0 + row[x] * w1, 5), m_grainMin, m_grainMax));
+        }
+    }
+
+    void FilmGrainSynthesizer::ApplyStripe(uint32_t stripe, FilmGrainFrame const& src, FilmGrainFrame const& dst) const
+    {
+        int32_t const y0 = static_cast<int32_t>(stripe * FILM_GRAIN_STRIPE_HEIGHT);
+        int32_t const rows = std::min<int32_t>(FILM_GRAIN_STRIPE_HEIGHT, m_height - y0);
+        if (rows <= 0)
+            return;
+
+        int32_t const width = static_cast<int32_t>(m_width);
+        int32_t const chromaWidth = (width + 1) >> 1;
+        int32_t const chromaY0 = y0 >> 1;
+        int32_t const chromaRows = std::min<int32_t>(FILM_GRAIN_STRIPE_HEIGHT / 2, ((m_height + 1) >> 1) - chromaY0);
+
+        // blocks are written up to 34 samples past their start
+        size_t const pitch = (m_width + 34 + 15) & ~15;
+        std::unique_ptr<int16_t[]> noise(new int16_t[(FILM_GRAIN_STRIPE_HEIGHT * 2) * pitch]);
+        int16_t* noiseY  = noise.get();
+        int16_t* noiseCb = noiseY + FILM_GRAIN_STRIPE_HEIGHT * pitch;
+        int16_t* noiseCr = noiseCb + (FILM_GRAIN_STRIPE_HEIGHT / 2) * pitch;
+
+        BuildNoise(stripe, 0, rows, noiseY, pitch);
+        BuildNoise(stripe, 1, chromaRows, noiseCb, pitch);
+        BuildNoise(stripe, 2, chromaRows, noiseCr, pitch);
+
+        // chroma first, it is scaled by the luma samples without noise
+        if (m_params.BitDepth == 8)
+        {
+            for (int32_t i = 0; i < chromaRows; i++)
+            {
+                int32_t const y = chromaY0 + i;
+                m_kernels.ChromaRow8(src.y + 2 * y * src.pitch, src.uv + y * src.pitch, dst.uv + y * dst.pitch,
+                    noiseCb + i * pitch, noiseCr + i * pitch, chromaWidth, width, m_scaling);
+            }
+
+            for (int32_t i = 0; i < rows; i++)
+            {
+                int32_t const y = y0 + i;
+                m_kernels.LumaRow8(src.y + y * src.pitch, dst.y + y * dst.pitch, noiseY + i * pitch, width, m_scaling);
+            }
+        }
+        else
+        {
+            for (int32_t i = 0; i < chromaRows; i++)
+            {
+                int32_t const y = chromaY0 + i;
+                m_kernels.ChromaRow16(reinterpret_cast<uint16_t const*>(src.y + 2 * y * src.pitch),
+                    reinterpret_cast<uint16_t const*>(src.uv + y * src.pitch), reinterpret_cast<uint16_t*>(dst.uv + y * dst.pitch),
+                    noiseCb + i * pitch, noiseCr + i * pitch, chromaWidth, width, m_scaling);
+            }
+
+            for (int32_t i = 0; i < rows; i++)
+            {
+                int32_t const y = y0 + i;
+                m_kernels.LumaRow16(reinterpret_cast<uint16_t const*>(src.y + y * src.pitch),
+                    reinterpret_cast<uint16_t*>(dst.y + y * dst.pitch), noiseY + i * pitch, width, m_scaling);
+            }
+        }
+    }
+}
+
+#endif // MFX_ENABLE_AV1_VIDEO_DECODE
@@ -0,0 +1,196 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Compiled as the av1_film_grain_avx2 object library of the decode target.
+// The scaling LUT is read with 8-lane gathers: 16 luma or 8 chroma pairs per
+// iteration, the chroma loop also stops before it would read past lumaWidth.
+// What is left of the row goes to the C kernel.
+
+#include "umc_defs.h"
+#ifdef MFX_ENABLE_AV1_VIDEO_DECODE
+
+#include "umc_av1_film_grain.h"
+
+#if defined(UMC_AV1_FILM_GRAIN_AVX2)
+
+#include <immintrin.h>
+
+namespace UMC_AV1_DECODER
+{
+    // Clip3(min, max, orig + Round2(lut[index] * noise, shift)) on 8 samples
+    static inline __m256i AddNoise(__m256i orig, __m256i index, __m256i noise, int32_t const* lut,
+                                   __m256i round, __m128i shift, __m256i minValue, __m256i maxValue)
+    {
+        __m256i const scale = _mm256_i32gather_epi32(reinterpret_cast<int const*>(lut), index, 4);
+        __m256i v = _mm256_mullo_epi32(scale, noise);
+        v = _mm256_sra_epi32(_mm256_add_epi32(v, round), shift);
+        v = _mm256_add_epi32(orig, v);
+
+        return _mm256_min_epi32(_mm256_max_epi32(v, minValue), maxValue);
+    }
+
+    // 16 x 32-bit to 16 x 16-bit with unsigned saturation, in order
+    static inline __m256i Pack32To16(__m256i lo, __m256i hi)
+    {
+        return _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xD8);
+    }
+
+    // Index of the chroma LUT for 8 samples of a chroma plane
+    static inline __m256i MergeLuma(__m256i averageLuma, __m256i orig, int32_t c, FilmGrainScaling const& s)
+    {
+        if (s.fromLuma)
+            return averageLuma;
+
+        __m256i combined = _mm256_add_epi32(
+            _mm256_mullo_epi32(averageLuma, _mm256_set1_epi32(s.lumaMult[c])),
+            _mm256_mullo_epi32(orig, _mm256_set1_epi32(s.mult[c])));
+        combined = _mm256_add_epi32(_mm256_srai_epi32(combined, 6), _mm256_set1_epi32(s.offset[c]));
+
+        return _mm256_min_epi32(_mm256_max_epi32(combined, _mm256_setzero_si256()), _mm256_set1_epi32(s.maxSample));
+    }
+
+    void FilmGrainLumaRow8_AVX2(uint8_t const* src, uint8_t* dst, int16_t const* noise, int32_t width, FilmGrainScaling const& s)
+    {
+        __m256i const round    = _mm256_set1_epi32(1 << (s.shift - 1));
+        __m128i const shift    = _mm_cvtsi32_si128(s.shift);
+        __m256i const minValue = _mm256_set1_epi32(s.minValue[0]);
+        __m256i const maxValue = _mm256_set1_epi32(s.maxValue[0]);
+
+        int32_t x = 0;
+        for (; x + 16 <= width; x += 16)
+        {
+            __m128i const p = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + x));
+            __m256i const n = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(noise + x));
+
+            __m256i const orig0 = _mm256_cvtepu8_epi32(p);
+            __m256i const orig1 = _mm256_cvtepu8_epi32(_mm_srli_si128(p, 8));
+
+            __m256i const v0 = AddNoise(orig0, orig0, _mm256_cvtepi16_epi32(_mm256_castsi256_si128(n)),
+                                        s.lut[0], round, shift, minValue, maxValue);
+            __m256i const v1 = AddNoise(orig1, orig1, _mm256_cvtepi16_epi32(_mm256_extracti128_si256(n, 1)),
+                                        s.lut[0], round, shift, minValue, maxValue);
+
+            __m256i const v = Pack32To16(v0, v1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x),
+                _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+        }
+
+        FilmGrainLumaRow8_C(src + x, dst + x, noise + x, width - x, s);
+    }
+
+    void FilmGrainLumaRow16_AVX2(uint16_t const* src, uint16_t* dst, int16_t const* noise, int32_t width, FilmGrainScaling const& s)
+    {
+        __m256i const round       = _mm256_set1_epi32(1 << (s.shift - 1));
+        __m128i const shift       = _mm_cvtsi32_si128(s.shift);
+        __m128i const sampleShift = _mm_cvtsi32_si128(s.sampleShift);
+        __m256i const minValue    = _mm256_set1_epi32(s.minValue[0]);
+        __m256i const maxValue    = _mm256_set1_epi32(s.maxValue[0]);
+
+        int32_t x = 0;
+        for (; x + 16 <= width; x += 16)
+        {
+            __m256i const p = _mm256_srl_epi16(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + x)), sampleShift);
+            __m256i const n = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(noise + x));
+
+            __m256i const orig0 = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(p));
+            __m256i const orig1 = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(p, 1));
+
+            __m256i const v0 = AddNoise(orig0, orig0, _mm256_cvtepi16_epi32(_mm256_castsi256_si128(n)),
+                                        s.lut[0], round, shift, minValue, maxValue);
+            __m256i const v1 = AddNoise(orig1, orig1, _mm256_cvtepi16_epi32(_mm256_extracti128_si256(n, 1)),
+                                        s.lut[0], round, shift, minValue, maxValue);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), _mm256_sll_epi16(Pack32To16(v0, v1), sampleShift));
+        }
+
+        FilmGrainLumaRow16_C(src + x, dst + x, noise + x, width - x, s);
+    }
+
+    void FilmGrainChromaRow8_AVX2(uint8_t const* srcY, uint8_t const* srcUV, uint8_t* dstUV, int16_t const* noiseCb, int16_t const* noiseCr,
+                                  int32_t width, int32_t lumaWidth, FilmGrainScaling const& s)
+    {
+        __m256i const round = _mm256_set1_epi32(1 << (s.shift - 1));
+        __m128i const shift = _mm_cvtsi32_si128(s.shift);
+        __m128i const mask  = _mm_set1_epi16(0xff);
+
+        // 8 chroma pairs and the 16 luma samples above them per iteration,
+        // the last pair may need the clamped luma position, so it goes to the tail
+        int32_t x = 0;
+        for (; x + 8 <= width && 2 * x + 16 <= lumaWidth; x += 8)
+        {
+            __m128i const luma = _mm_loadu_si128(reinterpret_cast<__m128i const*>(srcY + 2 * x));
+            __m128i const uv   = _mm_loadu_si128(reinterpret_cast<__m128i const*>(srcUV + 2 * x));
+
+            __m256i const averageLuma = _mm256_cvtepu16_epi32(_mm_avg_epu16(_mm_and_si128(luma, mask), _mm_srli_epi16(luma, 8)));
+            __m256i const u = _mm256_cvtepu16_epi32(_mm_and_si128(uv, mask));
+            __m256i const v = _mm256_cvtepu16_epi32(_mm_srli_epi16(uv, 8));
+
+            __m256i const outU = AddNoise(u, MergeLuma(averageLuma, u, 0, s),
+                _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(noiseCb + x))),
+                s.lut[1], round, shift, _mm256_set1_epi32(s.minValue[1]), _mm256_set1_epi32(s.maxValue[1]));
+            __m256i const outV = AddNoise(v, MergeLuma(averageLuma, v, 1, s),
+                _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(noiseCr + x))),
+                s.lut[2], round, shift, _mm256_set1_epi32(s.minValue[2]), _mm256_set1_epi32(s.maxValue[2]));
+
+            __m256i const out = _mm256_or_si256(outU, _mm256_slli_epi32(outV, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dstUV + 2 * x),
+                _mm_packus_epi32(_mm256_castsi256_si128(out), _mm256_extracti128_si256(out, 1)));
+        }
+
+        FilmGrainChromaRow8_C(srcY + 2 * x, srcUV + 2 * x, dstUV + 2 * x, noiseCb + x, noiseCr + x, width - x, lumaWidth - 2 * x, s);
+    }
+
+    void FilmGrainChromaRow16_AVX2(uint16_t const* srcY, uint16_t const* srcUV, uint16_t* dstUV, int16_t const* noiseCb, int16_t const* noiseCr,
+                                   int32_t width, int32_t lumaWidth, FilmGrainScaling const& s)
+    {
+        __m256i const round       = _mm256_set1_epi32(1 << (s.shift - 1));
+        __m128i const shift       = _mm_cvtsi32_si128(s.shift);
+        __m128i const sampleShift = _mm_cvtsi32_si128(s.sampleShift);
+        __m256i const mask        = _mm256_set1_epi32(0xffff);
+        __m256i const one         = _mm256_set1_epi32(1);
+
+        int32_t x = 0;
+        for (; x + 8 <= width && 2 * x + 16 <= lumaWidth; x += 8)
+        {
+            __m256i const luma = _mm256_srl_epi16(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(srcY + 2 * x)), sampleShift);
+            __m256i const uv   = _mm256_srl_epi16(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(srcUV + 2 * x)), sampleShift);
+
+            __m256i const averageLuma = _mm256_srli_epi32(
+                _mm256_add_epi32(_mm256_add_epi32(_mm256_and_si256(luma, mask), _mm256_srli_epi32(luma, 16)), one), 1);
+            __m256i const u = _mm256_and_si256(uv, mask);
+            __m256i const v = _mm256_srli_epi32(uv, 16);
+
+            __m256i const outU = AddNoise(u, MergeLuma(averageLuma, u, 0, s),
+                _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(noiseCb + x))),
+                s.lut[1], round, shift, _mm256_set1_epi32(s.minValue[1]), _mm256_set1_epi32(s.maxValue[1]));
+            __m256i const outV = AddNoise(v, MergeLuma(averageLuma, v, 1, s),
+                _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(noiseCr + x))),
+                s.lut[2], round, shift, _mm256_set1_epi32(s.minValue[2]), _mm256_set1_epi32(s.maxValue[2]));
+
+            __m256i const out = _mm256_or_si256(outU, _mm256_slli_epi32(outV, 16));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dstUV + 2 * x), _mm256_sll_epi16(out, sampleShift));
+        }
+
+        FilmGrainChromaRow16_C(srcY + 2 * x, srcUV + 2 * x, dstUV + 2 * x, noiseCb + x, noiseCr + x, width - x, lumaWidth - 2 * x, s);
+    }
+}
+
+#endif // UMC_AV1_FILM_GRAIN_AVX2
+#endif // MFX_ENABLE_AV1_VIDEO_DECODE
@@ -112,6 +112,7 @@ namespace UMC_AV1_DECODER
         SetRefValid(false);
 
         film_grain_disabled = false;
+        film_grain_on_cpu = false;
 
         UID = -1;
 
@@ -193,7 +193,7 @@ namespace UMC_AV1_DECODER
 
         // set current and reference frames
         picParam.current_frame = (VASurfaceID)m_va->GetSurfaceID(frame.GetMemID(SURFACE_RECON));
-        if (!frame.FilmGrainDisabled())
+        if (!frame.FilmGrainDisabled() && !frame.FilmGrainOnCpu())
             picParam.current_display_picture = (VASurfaceID)m_va->GetSurfaceID(frame.GetMemID());
 
         if (seg.segment_info_fields.bits.enabled)
@@ -300,7 +300,7 @@ namespace UMC_AV1_DECODER
         auto& fg = picParam.film_grain_info;
         auto& fgInfo = fg.film_grain_info_fields.bits;
 
-        if (!frame.FilmGrainDisabled())
+        if (!frame.FilmGrainDisabled() && !frame.FilmGrainOnCpu())
         {
             fgInfo.apply_grain = info.film_grain_params.apply_grain;
             fgInfo.chroma_scaling_from_luma = info.film_grain_params.chroma_scaling_from_luma;
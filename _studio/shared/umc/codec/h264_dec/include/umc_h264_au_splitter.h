@@ -32,6 +32,7 @@
 #include "umc_h264_frame_info.h"
 
 #include "umc_h264_headers.h"
+#include "umc_nal_unit_splitter_thread.h"
 
 namespace UMC
 {
@@ -159,7 +160,7 @@ public:
     AU_Splitter(H264_Heap_Objects *objectHeap);
     virtual ~AU_Splitter();
 
-    void Init();
+    void Init(VideoDecoderParams * init);
     void Close();
 
     void Reset();
@@ -168,6 +169,9 @@ public:
 
     NALUnitSplitter * GetNalUnitSplitter();
 
+    // Returns the parse thread splitter, NULL if NAL units are split on decoding
+    NalUnitSplitterThread * GetPreSplitter();
+
 protected:
 
     Headers     m_Headers;
@@ -178,6 +182,7 @@ protected:
     //Status DecodeHeaders(MediaDataEx *nalUnit);
 
     std::unique_ptr<NALUnitSplitter> m_pNALSplitter;
+    NalUnitSplitterThread *          m_pPreSplitter;
 };
 
 } // namespace UMC
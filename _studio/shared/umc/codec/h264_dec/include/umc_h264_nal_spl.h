@@ -24,10 +24,12 @@
 #ifndef __UMC_H264_NAL_SPL_H
 #define __UMC_H264_NAL_SPL_H
 
+#include <atomic>
 #include <vector>
 #include "umc_h264_dec_defs_dec.h"
 #include "umc_media_data_ex.h"
 #include "umc_h264_heap.h"
+#include "umc_nal_unit_splitter_thread.h"
 
 namespace UMC
 {
@@ -189,6 +191,32 @@ protected:
     NalUnit     m_nalUnit;
 };
 
+// NAL unit splitter which takes NAL units split ahead by the parse thread
+class NALUnitPreSplitter : public NALUnitSplitter, public NalUnitSplitterThread
+{
+public:
+
+    NALUnitPreSplitter();
+
+    virtual ~NALUnitPreSplitter();
+
+    virtual void Init();
+    virtual void Release();
+
+    virtual NalUnit * GetNalUnits(MediaData * in);
+
+    virtual void SetSuggestedSize(size_t size);
+
+protected:
+
+    virtual MediaData * SplitNext(MediaData * pSource, int32_t & type);
+    virtual void PrepareUnit(MediaData & nalUnit, Unit & unit);
+    virtual void ResetSplit();
+
+    NALUnitSplitter      m_splitter;       // used by the parse thread
+    std::atomic<size_t>  m_suggestedSize;
+};
+
 } // namespace UMC
 
 #endif // __UMC_H264_NAL_SPL_H
@@ -603,6 +603,8 @@ protected:
     virtual void AddFakeReferenceFrame(H264Slice * pSlice);
 
     virtual Status AddOneFrame(MediaData * pSource);
+    // Queue the source to the parse thread and add frames of NAL units it has split
+    Status AddPreSplitFrame(MediaData * pSource);
 
     virtual Status AllocateFrameData(H264DecoderFrame * pFrame) = 0;
 
@@ -507,6 +507,7 @@ SetOfSlices * AccessUnit::GetLayerBySlice(H264Slice * slice)
 AU_Splitter::AU_Splitter(H264_Heap_Objects *objectHeap)
     : m_Headers(objectHeap)
     , m_objHeap(objectHeap)
+    , m_pPreSplitter(0)
 {
 }
 
@@ -515,21 +516,37 @@ AU_Splitter::~AU_Splitter()
     Close();
 }
 
-void AU_Splitter::Init()
+void AU_Splitter::Init(VideoDecoderParams * init)
 {
     Close();
 
-    m_pNALSplitter.reset(new NALUnitSplitter());
-    m_pNALSplitter->Init();
+    if (init && init->preSplitSize)
+    {
+        NALUnitPreSplitter * splitter = new NALUnitPreSplitter();
+        m_pNALSplitter.reset(splitter);
+        m_pNALSplitter->Init();
+
+        m_pPreSplitter = splitter;
+        m_pPreSplitter->Start(init->preSplitSize);
+    }
+    else
+    {
+        m_pNALSplitter.reset(new NALUnitSplitter());
+        m_pNALSplitter->Init();
+    }
 }
 
 void AU_Splitter::Close()
 {
+    m_pPreSplitter = 0;
     m_pNALSplitter.reset(0);
 }
 
 void AU_Splitter::Reset()
 {
+    if (m_pPreSplitter)
+        m_pPreSplitter->Drop();
+
     if (m_pNALSplitter.get())
         m_pNALSplitter->Reset();
 
@@ -546,5 +563,10 @@ NALUnitSplitter * AU_Splitter::GetNalUnitSplitter()
     return m_pNALSplitter.get();
 }
 
+NalUnitSplitterThread * AU_Splitter::GetPreSplitter()
+{
+    return m_pPreSplitter;
+}
+
 } // namespace UMC
 #endif // MFX_ENABLE_H264_VIDEO_DECODE
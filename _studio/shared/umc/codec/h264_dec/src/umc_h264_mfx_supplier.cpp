@@ -155,7 +155,7 @@ Status MFXTaskSupplier::Init(VideoDecoderParams *init)
         break;
     }
 
-    AU_Splitter::Init();
+    AU_Splitter::Init(init);
     DPBOutput::Reset(m_iThreadNum != 1);
 
     // create slice decoder(s)
@@ -384,6 +384,36 @@ public:
     }
 };
 
+// Takes NAL units prepared by the parse thread instead of swapping them again
+class PreSplitSwapper : public Swapper
+{
+public:
+
+    PreSplitSwapper(NalUnitSplitterThread const & splitter)
+        : m_splitter(splitter)
+    {
+    }
+
+    virtual void SwapMemory(uint8_t *pDestination, size_t &nDstSize, uint8_t *pSource, size_t nSrcSize)
+    {
+        NalUnitSplitterThread::Unit const * unit = m_splitter.FindPrepared(pSource, nSrcSize);
+        if (!unit)
+        {
+            Swapper::SwapMemory(pDestination, nDstSize, pSource, nSrcSize);
+            return;
+        }
+
+        MFX_INTERNAL_CPY(pDestination, unit->payload.data(), (uint32_t)unit->payloadSize);
+        nDstSize = unit->payloadSize;
+    }
+
+    using Swapper::SwapMemory;
+
+private:
+
+    NalUnitSplitterThread const & m_splitter;
+};
+
 NALUnitSplitter::NALUnitSplitter()
     : m_pSwapper(0)
     , m_pStartCodeIter(0)
@@ -612,5 +642,91 @@ void SwapMemoryAndRemovePreventingBytes(void *pDestination, size_t &nDstSize, vo
 
 } // void SwapMemoryAndRemovePreventingBytes(void *pDst, size_t &nDstSize, void *pSrc, size_t nSrcSize)
 
+NALUnitPreSplitter::NALUnitPreSplitter()
+    : m_suggestedSize(0)
+{
+}
+
+NALUnitPreSplitter::~NALUnitPreSplitter()
+{
+    Release();
+}
+
+void NALUnitPreSplitter::Init()
+{
+    NALUnitSplitter::Init();
+
+    delete m_pSwapper;
+    m_pSwapper = new PreSplitSwapper(*this);
+
+    m_splitter.Init();
+}
+
+void NALUnitPreSplitter::Release()
+{
+    Stop();
+
+    m_splitter.Release();
+    NALUnitSplitter::Release();
+}
+
+NalUnit * NALUnitPreSplitter::GetNalUnits(MediaData * pSource)
+{
+    Unit const * unit = FindUnit(pSource);
+    if (!unit)
+        return NALUnitSplitter::GetNalUnits(pSource);
+
+    // the window is compacted by the next PutData, so slices can't keep pointing to it
+    m_nalUnit.m_use_external_memory = false;
+
+    // skip 3 bytes start code the window has before each unit
+    size_t const nal_size = unit->size - 3;
+    m_nalUnit.SetBufferPointer((uint8_t*)pSource->GetDataPointer() + 3, nal_size);
+    m_nalUnit.SetDataSize(nal_size);
+    m_nalUnit.SetFlags(pSource->GetFlags());
+    m_nalUnit.SetTime(unit->time);
+    pSource->MoveDataPointer((int32_t)unit->size);
+
+    m_nalUnit.m_nal_unit_type = unit->type;
+    return &m_nalUnit;
+}
+
+void NALUnitPreSplitter::SetSuggestedSize(size_t size)
+{
+    NALUnitSplitter::SetSuggestedSize(size);
+
+    // applied by the parse thread before next NAL unit
+    if (size > m_suggestedSize)
+        m_suggestedSize = size;
+}
+
+MediaData * NALUnitPreSplitter::SplitNext(MediaData * pSource, int32_t & type)
+{
+    m_splitter.SetSuggestedSize(m_suggestedSize);
+
+    NalUnit * nalUnit = m_splitter.GetNalUnits(pSource);
+    if (!nalUnit)
+        return 0;
+
+    type = nalUnit->m_nal_unit_type;
+    return nalUnit;
+}
+
+// Swap NAL unit and remove emulation prevention bytes as the decoder thread would do
+void NALUnitPreSplitter::PrepareUnit(MediaData & nalUnit, Unit & unit)
+{
+    size_t const size = nalUnit.GetDataSize();
+
+    // swapping pads the data to whole dwords
+    unit.payload.resize(size + 4);
+    unit.payloadSize = size;
+    SwapMemoryAndRemovePreventingBytes(unit.payload.data(), unit.payloadSize, nalUnit.GetDataPointer(), size);
+}
+
+void NALUnitPreSplitter::ResetSplit()
+{
+    m_splitter.Reset();
+}
+
 } // namespace UMC
 #endif // MFX_ENABLE_H264_VIDEO_DECODE
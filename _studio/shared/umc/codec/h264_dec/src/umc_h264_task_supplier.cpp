@@ -1999,7 +1999,7 @@ Status TaskSupplier::Init(VideoDecoderParams *init)
     m_iThreadNum = (0 == nAllowedThreadNumber) ? (vm_sys_info_get_cpu_num()) : (nAllowedThreadNumber);
 
     DPBOutput::Reset(m_iThreadNum != 1);
-    AU_Splitter::Init();
+    AU_Splitter::Init(init);
     Status umcRes = SVC_Extension::Init();
     if (UMC_OK != umcRes)
     {
@@ -2074,7 +2074,7 @@ Status TaskSupplier::PreInit(VideoDecoderParams *init)
     // It should be equal to CPU number
     m_iThreadNum = (0 == nAllowedThreadNumber) ? (vm_sys_info_get_cpu_num()) : (nAllowedThreadNumber);
 
-    AU_Splitter::Init();
+    AU_Splitter::Init(init);
     DPBOutput::Reset(m_iThreadNum != 1);
 
     m_local_delta_frame_time = 1.0/30;
@@ -3143,7 +3143,7 @@ Status TaskSupplier::AddSource(MediaData * pSource)
     if (umcRes != UMC_OK)
         return pSource || !completed ? umcRes : UMC_OK;
 
-    umcRes = AddOneFrame(pSource); // construct frame
+    umcRes = GetPreSplitter() ? AddPreSplitFrame(pSource) : AddOneFrame(pSource); // construct frame
 
     if (UMC_ERR_NOT_ENOUGH_BUFFER == umcRes)
     {
@@ -3252,6 +3252,48 @@ Status TaskSupplier::ProcessNalUnit(NalUnit *nalUnit)
     return umcRes;
 }
 
+Status TaskSupplier::AddPreSplitFrame(MediaData * pSource)
+{
+    NalUnitSplitterThread * splitter = GetPreSplitter();
+    splitter->PutData(pSource);
+
+    size_t stalled = 0; // size of the window nothing was taken from
+    for (;;)
+    {
+        // wait for the parse thread only if the caller can't give it more input
+        bool const mayWait = (!pSource || splitter->IsFull()) && splitter->IsPending();
+
+        MediaData * data = splitter->GetData(false);
+        if (!data || data->GetDataSize() == stalled)
+        {
+            if (!mayWait)
+                break;
+
+            data = splitter->GetData(true);
+            if (!data || data->GetDataSize() == stalled)
+                continue;
+        }
+
+#if (MFX_VERSION >= 1025)
+        MediaData::AuxInfo* aux = (pSource) ? pSource->GetAuxInfo(MFX_EXTBUFF_DECODE_ERROR_REPORT) : NULL;
+        if (aux)
+            data->SetAuxInfo(aux->ptr, aux->size, aux->type);
+        else
+            data->ClearAuxInfo(MFX_EXTBUFF_DECODE_ERROR_REPORT);
+#endif
+
+        size_t const size = data->GetDataSize();
+
+        Status umcRes = AddOneFrame(data);
+        if (umcRes != UMC_ERR_NOT_ENOUGH_DATA && umcRes != UMC_ERR_SYNC)
+            return umcRes;
+
+        stalled = data->GetDataSize() == size ? size : 0;
+    }
+
+    return pSource ? UMC_ERR_NOT_ENOUGH_DATA : AddOneFrame(0);
+}
+
 Status TaskSupplier::AddOneFrame(MediaData * pSource)
 {
     Status umsRes = UMC_OK;
@@ -30,6 +30,7 @@
 #include "umc_h265_heap.h"
 #include "umc_h265_headers.h"
 #include "umc_video_decoder.h"
+#include "umc_nal_unit_splitter_thread.h"
 
 namespace UMC_HEVC_DECODER
 {
@@ -55,6 +56,8 @@ public:
     UMC::MediaDataEx * GetNalUnit(UMC::MediaData * src);
     // Returns internal NAL unit splitter
     NALUnitSplitter_H265 * GetNalUnitSplitter();
+    // Returns the parse thread splitter, NULL if NAL units are split on decoding
+    UMC::NalUnitSplitterThread * GetPreSplitter();
 
 protected:
 
@@ -64,6 +67,7 @@ protected:
 protected:
 
     std::unique_ptr<NALUnitSplitter_H265> m_pNALSplitter;
+    UMC::NalUnitSplitterThread *          m_pPreSplitter;
 };
 
 } // namespace UMC_HEVC_DECODER
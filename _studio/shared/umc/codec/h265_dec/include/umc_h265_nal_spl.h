@@ -24,10 +24,12 @@
 #ifndef __UMC_H265_NAL_SPL_H
 #define __UMC_H265_NAL_SPL_H
 
+#include <atomic>
 #include <vector>
 #include "umc_h265_dec_defs.h"
 #include "umc_media_data_ex.h"
 #include "umc_h265_heap.h"
+#include "umc_nal_unit_splitter_thread.h"
 
 namespace UMC_HEVC_DECODER
 {
@@ -145,6 +147,37 @@ protected:
     UMC::MediaDataEx::_MediaDataEx m_MediaDataEx;
 };
 
+// NAL unit splitter which searches start codes and removes emulation prevention bytes
+// on the parse thread, NAL units of its window are handed out as they are
+class NALUnitPreSplitter_H265 : public NALUnitSplitter_H265, public UMC::NalUnitSplitterThread
+{
+public:
+
+    NALUnitPreSplitter_H265();
+
+    virtual ~NALUnitPreSplitter_H265();
+
+    // Initialize splitter with default values
+    virtual void Init();
+    // Free resources
+    virtual void Release();
+
+    // Set destination bitstream pointer and size to NAL unit
+    virtual UMC::MediaDataEx * GetNalUnits(UMC::MediaData * in);
+
+    // Set maximum NAL unit size
+    virtual void SetSuggestedSize(size_t size);
+
+protected:
+
+    virtual UMC::MediaData * SplitNext(UMC::MediaData * pSource, int32_t & type);
+    virtual void PrepareUnit(UMC::MediaData & nalUnit, Unit & unit);
+    virtual void ResetSplit();
+
+    NALUnitSplitter_H265  m_splitter;       // used by the parse thread
+    std::atomic<size_t>   m_suggestedSize;
+};
+
 } // namespace UMC_HEVC_DECODER
 
 #endif // __UMC_H265_NAL_SPL_H
@@ -76,8 +76,12 @@ public:
     void PermanentDisableDeblocking(bool disable);
     // Check if deblocking should be skipped
     bool IsShouldSkipDeblocking(H265DecoderFrame * pFrame);
-    // Check if frame should be skipped to decrease decoding delays
-    bool IsShouldSkipFrame(H265DecoderFrame * pFrame);
+    // Check if NAL unit of a coded slice should be discarded to decrease decoding delays,
+    // the decision is made from the NAL unit header only, before the slice is parsed
+    bool IsShouldSkipNalUnit(NalUnitType nal_unit_type, uint32_t nuh_temporal_id, uint32_t max_sub_layers) const;
+    // Account a picture discarded by IsShouldSkipNalUnit
+    void OnPictureSkipped()
+    { m_NumberOfSkippedFrames++; }
     // Set decoding skip frame mode
     void ChangeVideoDecodingSpeed(int32_t& num);
     void Reset();
@@ -93,9 +97,17 @@ public:
 
 private:
 
+    // Skip levels, each one increases the number of discarded pictures
+    enum
+    {
+        SKIP_NONE            = 0,
+        SKIP_NON_REFERENCE   = 1, // sub-layer non-reference pictures of the highest sub-layer
+        SKIP_SUB_LAYERS      = 2, // SKIP_SUB_LAYERS + N drops N + 1 highest sub-layers (down to the base one)
+                                  // and sub-layer non-reference pictures of the new highest sub-layer
+        SKIP_NON_IRAP        = 7, // decode IRAP pictures only
+    };
+
     int32_t m_VideoDecodingSpeed;
-    int32_t m_SkipCycle;
-    int32_t m_ModSkipCycle;
     int32_t m_PermanentTurnOffDeblocking;
 
     int32_t m_NumberOfSkippedFrames;
@@ -370,6 +382,11 @@ public:
     // Decode slice header start, set slice links to SPS and PPS and correct tile offsets table if needed
     virtual H265Slice * DecodeSliceHeader(UMC::MediaDataEx *nalUnit);
 
+    // Check if coded slice NAL unit belongs to a picture discarded by the skip mode
+    bool IsShouldSkipNalUnit(UMC::MediaDataEx *nalUnit) const;
+    // Parse slice header of a discarded picture to keep POC derivation state up to date
+    void UpdatePocDecoding(UMC::MediaDataEx *nalUnit);
+
     Heap_Objects * GetObjHeap()
     {
         return &m_ObjHeap;
@@ -412,6 +429,8 @@ protected:
 
     // Find NAL units in new bitstream buffer and process them
     virtual UMC::Status AddOneFrame(UMC::MediaData * pSource);
+    // Queue the source to the parse thread and add frames of NAL units it has split
+    UMC::Status AddPreSplitFrame(UMC::MediaData * pSource);
 
     // Allocate frame internals
     virtual UMC::Status AllocateFrameData(H265DecoderFrame * pFrame, mfxSize dimensions, const H265SeqParamSet* pSeqParamSet, const H265PicParamSet *pPicParamSet);
@@ -30,6 +30,7 @@ namespace UMC_HEVC_DECODER
 
 AU_Splitter_H265::AU_Splitter_H265()
     : m_Headers(&m_ObjHeap)
+    , m_pPreSplitter(0)
 {
 }
 
@@ -38,16 +39,29 @@ AU_Splitter_H265::~AU_Splitter_H265()
     Close();
 }
 
-void AU_Splitter_H265::Init(UMC::VideoDecoderParams *)
+void AU_Splitter_H265::Init(UMC::VideoDecoderParams *init)
 {
     Close();
 
-    m_pNALSplitter.reset(new NALUnitSplitter_H265());
-    m_pNALSplitter->Init();
+    if (init && init->preSplitSize)
+    {
+        NALUnitPreSplitter_H265 * splitter = new NALUnitPreSplitter_H265();
+        m_pNALSplitter.reset(splitter);
+        m_pNALSplitter->Init();
+
+        m_pPreSplitter = splitter;
+        m_pPreSplitter->Start(init->preSplitSize);
+    }
+    else
+    {
+        m_pNALSplitter.reset(new NALUnitSplitter_H265());
+        m_pNALSplitter->Init();
+    }
 }
 
 void AU_Splitter_H265::Close()
 {
+    m_pPreSplitter = 0;
     m_pNALSplitter.reset(0);
     m_Headers.Reset(false);
     m_ObjHeap.Release();
@@ -55,6 +69,9 @@ void AU_Splitter_H265::Close()
 
 void AU_Splitter_H265::Reset()
 {
+    if (m_pPreSplitter)
+        m_pPreSplitter->Drop();
+
     if (m_pNALSplitter.get())
         m_pNALSplitter->Reset();
 
@@ -80,6 +97,12 @@ NALUnitSplitter_H265 * AU_Splitter_H265::GetNalUnitSplitter()
     return m_pNALSplitter.get();
 }
 
+// Returns the parse thread splitter
+UMC::NalUnitSplitterThread * AU_Splitter_H265::GetPreSplitter()
+{
+    return m_pPreSplitter;
+}
+
 
 } // namespace UMC_HEVC_DECODER
 #endif // MFX_ENABLE_H265_VIDEO_DECODE
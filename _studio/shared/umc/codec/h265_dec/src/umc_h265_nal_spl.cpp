@@ -393,6 +393,39 @@ public:
     }
 };
 
+// Takes NAL units prepared by the parse thread instead of swapping them again
+class PreSplitSwapper : public Swapper
+{
+public:
+
+    PreSplitSwapper(UMC::NalUnitSplitterThread const & splitter)
+        : m_splitter(splitter)
+    {
+    }
+
+    virtual void SwapMemory(uint8_t *pDestination, size_t &nDstSize, uint8_t *pSource, size_t nSrcSize, std::vector<uint32_t> *pRemovedOffsets)
+    {
+        UMC::NalUnitSplitterThread::Unit const * unit = m_splitter.FindPrepared(pSource, nSrcSize);
+        if (!unit)
+        {
+            Swapper::SwapMemory(pDestination, nDstSize, pSource, nSrcSize, pRemovedOffsets);
+            return;
+        }
+
+        MFX_INTERNAL_CPY(pDestination, unit->payload.data(), (uint32_t)unit->payloadSize);
+        nDstSize = unit->payloadSize;
+
+        if (pRemovedOffsets)
+            pRemovedOffsets->insert(pRemovedOffsets->end(), unit->removedOffsets.begin(), unit->removedOffsets.end());
+    }
+
+    using Swapper::SwapMemory;
+
+private:
+
+    UMC::NalUnitSplitterThread const & m_splitter;
+};
+
 NALUnitSplitter_H265::NALUnitSplitter_H265()
     : m_pSwapper(0)
     , m_pStartCodeIter(0)
@@ -648,6 +681,101 @@ void SwapMemoryAndRemovePreventingBytes_H265(void *pDestination, size_t &nDstSiz
 
 } // void SwapMemoryAndRemovePreventingBytes_H265(void *pDst, size_t &nDstSize, void *pSrc, size_t nSrcSize, , std::vector<uint32_t> *pRemovedOffsets)
 
+NALUnitPreSplitter_H265::NALUnitPreSplitter_H265()
+    : m_suggestedSize(0)
+{
+}
+
+NALUnitPreSplitter_H265::~NALUnitPreSplitter_H265()
+{
+    Release();
+}
+
+// Initialize splitter with default values
+void NALUnitPreSplitter_H265::Init()
+{
+    NALUnitSplitter_H265::Init();
+
+    delete m_pSwapper;
+    m_pSwapper = new PreSplitSwapper(*this);
+
+    m_splitter.Init();
+}
+
+// Free resources
+void NALUnitPreSplitter_H265::Release()
+{
+    Stop();
+
+    m_splitter.Release();
+    NALUnitSplitter_H265::Release();
+}
+
+// Set destination bitstream pointer and size to NAL unit
+UMC::MediaDataEx * NALUnitPreSplitter_H265::GetNalUnits(UMC::MediaData * pSource)
+{
+    Unit const * unit = FindUnit(pSource);
+    if (!unit)
+        return NALUnitSplitter_H265::GetNalUnits(pSource);
+
+    UMC::MediaDataEx * out = &m_MediaData;
+    UMC::MediaDataEx::_MediaDataEx* pMediaDataEx = &m_MediaDataEx;
+
+    // skip 3 bytes start code the window has before each unit
+    size_t const nal_size = unit->size - 3;
+    out->SetBufferPointer((uint8_t*)pSource->GetDataPointer() + 3, nal_size);
+    out->SetDataSize(nal_size);
+    out->SetFlags(pSource->GetFlags());
+    out->SetTime(unit->time);
+    pSource->MoveDataPointer((int32_t)unit->size);
+
+    pMediaDataEx->values[0] = unit->type;
+
+    pMediaDataEx->offsets[0] = 0;
+    pMediaDataEx->offsets[1] = (int32_t)nal_size;
+    pMediaDataEx->count = 1;
+    pMediaDataEx->index = 0;
+    return out;
+}
+
+// Set maximum NAL unit size
+void NALUnitPreSplitter_H265::SetSuggestedSize(size_t size)
+{
+    NALUnitSplitter_H265::SetSuggestedSize(size);
+
+    // applied by the parse thread before next NAL unit
+    if (size > m_suggestedSize)
+        m_suggestedSize = size;
+}
+
+UMC::MediaData * NALUnitPreSplitter_H265::SplitNext(UMC::MediaData * pSource, int32_t & type)
+{
+    m_splitter.SetSuggestedSize(m_suggestedSize);
+
+    UMC::MediaDataEx * nalUnit = m_splitter.GetNalUnits(pSource);
+    if (!nalUnit)
+        return 0;
+
+    type = nalUnit->GetExData()->values[0];
+    return nalUnit;
+}
+
+// Swap NAL unit and remove emulation prevention bytes as the decoder thread would do
+void NALUnitPreSplitter_H265::PrepareUnit(UMC::MediaData & nalUnit, Unit & unit)
+{
+    size_t const size = nalUnit.GetDataSize();
+
+    // swapping pads the data to whole dwords
+    unit.payload.resize(size + 4);
+    unit.payloadSize = size;
+    SwapMemoryAndRemovePreventingBytes_H265(unit.payload.data(), unit.payloadSize, nalUnit.GetDataPointer(), size, &unit.removedOffsets);
+}
+
+void NALUnitPreSplitter_H265::ResetSplit()
+{
+    m_splitter.Reset();
+}
+
 } // namespace UMC_HEVC_DECODER
 
 #endif // MFX_ENABLE_H265_VIDEO_DECODE
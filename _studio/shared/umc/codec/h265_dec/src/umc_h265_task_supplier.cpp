@@ -275,9 +275,7 @@ ViewItem_H265 * MVC_Extension::GetView()
 // Skipping_H265 class routine
 /****************************************************************************************************/
 Skipping_H265::Skipping_H265()
-    : m_VideoDecodingSpeed(0)
-    , m_SkipCycle(1)
-    , m_ModSkipCycle(1)
+    : m_VideoDecodingSpeed(SKIP_NONE)
     , m_PermanentTurnOffDeblocking(0)
     , m_NumberOfSkippedFrames(0)
 {
@@ -289,9 +287,7 @@ Skipping_H265::~Skipping_H265()
 
 void Skipping_H265::Reset()
 {
-    m_VideoDecodingSpeed = 0;
-    m_SkipCycle = 0;
-    m_ModSkipCycle = 0;
+    m_VideoDecodingSpeed = SKIP_NONE;
     m_PermanentTurnOffDeblocking = 0;
     m_NumberOfSkippedFrames = 0;
 }
@@ -308,10 +304,30 @@ bool Skipping_H265::IsShouldSkipDeblocking(H265DecoderFrame *)
     return (IS_SKIP_DEBLOCKING_MODE_PREVENTIVE || IS_SKIP_DEBLOCKING_MODE_PERMANENT);
 }
 
-// Check if frame should be skipped to decrease decoding delays
-bool Skipping_H265::IsShouldSkipFrame(H265DecoderFrame * )
+// Check if NAL unit of a coded slice should be discarded to decrease decoding delays
+bool Skipping_H265::IsShouldSkipNalUnit(NalUnitType nal_unit_type, uint32_t nuh_temporal_id, uint32_t max_sub_layers) const
 {
-    return false;
+    if (m_VideoDecodingSpeed == SKIP_NONE)
+        return false;
+
+    if (nal_unit_type >= NAL_UT_CODED_SLICE_BLA_W_LP && nal_unit_type <= NAL_UT_CODED_SLICE_CRA)
+        return false; // IRAP
+
+    if (m_VideoDecodingSpeed >= SKIP_NON_IRAP)
+        return true;
+
+    // pictures with TemporalId greater than the current one are never referenced (8.1.2),
+    // so any number of the highest sub-layers may be dropped
+    int32_t const highest = max_sub_layers ? int32_t(max_sub_layers) - 1 : 0;
+    int32_t const dropped = m_VideoDecodingSpeed - SKIP_NON_REFERENCE;
+    uint32_t const maxTemporalId = std::max(highest - dropped, 0);
+
+    if (nuh_temporal_id > maxTemporalId)
+        return true;
+
+    // sub-layer non-reference pictures are only referenced by pictures of higher sub-layers,
+    // which are not decoded
+    return nuh_temporal_id == maxTemporalId && IsSubLayerNonReference(nal_unit_type);
 }
 
 // Set decoding skip frame mode
@@ -319,23 +335,19 @@ void Skipping_H265::ChangeVideoDecodingSpeed(int32_t & num)
 {
     m_VideoDecodingSpeed += num;
 
-    if (m_VideoDecodingSpeed < 0)
-        m_VideoDecodingSpeed = 0;
-    if (m_VideoDecodingSpeed > 7)
-        m_VideoDecodingSpeed = 7;
+    if (m_VideoDecodingSpeed < SKIP_NONE)
+        m_VideoDecodingSpeed = SKIP_NONE;
+    if (m_VideoDecodingSpeed > SKIP_NON_IRAP)
+        m_VideoDecodingSpeed = SKIP_NON_IRAP;
 
     num = m_VideoDecodingSpeed;
-
-    int32_t deblocking_off = m_PermanentTurnOffDeblocking;
-    if (deblocking_off == 3)
-        m_PermanentTurnOffDeblocking = 3;
 }
 
 // Get current skip mode state
 Skipping_H265::SkipInfo Skipping_H265::GetSkipInfo() const
 {
     SkipInfo info;
-    info.isDeblockingTurnedOff = (m_VideoDecodingSpeed == 5) || (m_VideoDecodingSpeed == 7);
+    info.isDeblockingTurnedOff = (IS_SKIP_DEBLOCKING_MODE_PREVENTIVE || IS_SKIP_DEBLOCKING_MODE_PERMANENT);
     info.numberOfSkippedFrames = m_NumberOfSkippedFrames;
     return info;
 }
@@ -1591,7 +1603,7 @@ UMC::Status TaskSupplier_H265::AddSource(UMC::MediaData * pSource)
     if (GetFrameToDisplayInternal(false))
         return UMC::UMC_OK;
 
-    umcRes = AddOneFrame(pSource); // construct frame
+    umcRes = GetPreSplitter() ? AddPreSplitFrame(pSource) : AddOneFrame(pSource); // construct frame
 
     if (UMC::UMC_ERR_NOT_ENOUGH_BUFFER == umcRes)
     {
@@ -1679,6 +1691,42 @@ UMC::Status TaskSupplier_H265::ProcessNalUnit(UMC::MediaDataEx *nalUnit)
     return umcRes;
 }
 
+// Queue bitstream buffer to the parse thread and process NAL units it has split
+UMC::Status TaskSupplier_H265::AddPreSplitFrame(UMC::MediaData * pSource)
+{
+    UMC::NalUnitSplitterThread * splitter = GetPreSplitter();
+    splitter->PutData(pSource);
+
+    size_t stalled = 0; // size of the window nothing was taken from
+    for (;;)
+    {
+        // wait for the parse thread only if the caller can't give it more input
+        bool const mayWait = (!pSource || splitter->IsFull()) && splitter->IsPending();
+
+        UMC::MediaData * data = splitter->GetData(false);
+        if (!data || data->GetDataSize() == stalled)
+        {
+            if (!mayWait)
+                break;
+
+            data = splitter->GetData(true);
+            if (!data || data->GetDataSize() == stalled)
+                continue;
+        }
+
+        size_t const size = data->GetDataSize();
+
+        UMC::Status umcRes = AddOneFrame(data);
+        if (umcRes != UMC::UMC_ERR_NOT_ENOUGH_DATA)
+            return umcRes;
+
+        // e.g. the decoder went back to SPS to look for the next slice
+        stalled = data->GetDataSize() == size ? size : 0;
+    }
+
+    return pSource ? UMC::UMC_ERR_NOT_ENOUGH_DATA : AddOneFrame(0);
+}
+
 // Find NAL units in new bitstream buffer and process them
 UMC::Status TaskSupplier_H265::AddOneFrame(UMC::MediaData * pSource)
 {
@@ -1785,6 +1833,24 @@ UMC::Status TaskSupplier_H265::AddOneFrame(UMC::MediaData * pSource)
             case NAL_UT_CODED_SLICE_CRA:
             case NAL_UT_CODED_SLICE_RADL_R:
             case NAL_UT_CODED_SLICE_RASL_R:
+                if (IsShouldSkipNalUnit(nalUnit))
+                {
+                    // first slice of a discarded picture completes the previous one
+                    uint8_t const* nal = reinterpret_cast<uint8_t const*>(nalUnit->GetDataPointer());
+                    if (nal[2] & 0x80) // first_slice_segment_in_pic_flag
+                    {
+                        // a discarded TemporalId 0 picture still may be prevTid0Pic of the following ones (8.3.1)
+                        if ((nal[1] & 0x07) == 1 && nut != NAL_UT_CODED_SLICE_RADL_R && nut != NAL_UT_CODED_SLICE_RASL_R &&
+                            !IsSubLayerNonReference(nut))
+                            UpdatePocDecoding(nalUnit);
+
+                        OnPictureSkipped();
+                        if (AddSlice(0, !pSource) == UMC::UMC_OK)
+                            return UMC::UMC_OK;
+                    }
+                    break;
+                }
+
                 if(H265Slice *pSlice = DecodeSliceHeader(nalUnit))
                 {
                     UMC::Status sts = AddSlice(pSlice, !pSource);
@@ -1875,6 +1941,64 @@ UMC::Status TaskSupplier_H265::AddOneFrame(UMC::MediaData * pSource)
     return UMC::UMC_ERR_NOT_ENOUGH_DATA;
 }
 
+// Check the NAL unit header of a coded slice against the skip mode
+bool TaskSupplier_H265::IsShouldSkipNalUnit(UMC::MediaDataEx *nalUnit) const
+{
+    if (nalUnit->GetDataSize() < 3)
+        return false;
+
+    H265SeqParamSet const* sps = GetCurrentSequence();
+    if (!sps)
+        return false;
+
+    // nal_unit_header: forbidden_zero_bit, nal_unit_type(6), nuh_layer_id(6), nuh_temporal_id_plus1(3)
+    uint8_t const* nal = reinterpret_cast<uint8_t const*>(nalUnit->GetDataPointer());
+    NalUnitType const nal_unit_type = NalUnitType((nal[0] >> 1) & 0x3f);
+    uint32_t const nuh_temporal_id_plus1 = nal[1] & 0x07;
+    if (!nuh_temporal_id_plus1)
+        return false; // broken header, let the slice parser report it
+
+    return Skipping_H265::IsShouldSkipNalUnit(nal_unit_type, nuh_temporal_id_plus1 - 1, sps->sps_max_sub_layers);
+}
+
+// Parse slice header of a discarded picture to keep POC derivation state up to date
+void TaskSupplier_H265::UpdatePocDecoding(UMC::MediaDataEx *nalUnit)
+{
+    H265Slice * pSlice = m_ObjHeap.AllocateObject<H265Slice>();
+    pSlice->IncrementReference();
+
+    notifier0<H265Slice> memory_leak_preventing_slice(pSlice, &H265Slice::DecrementReference);
+
+    MemoryPiece memCopy;
+    memCopy.SetData(nalUnit);
+
+    pSlice->m_source.Allocate(nalUnit->GetDataSize() + DEFAULT_NU_TAIL_SIZE);
+
+    notifier0<MemoryPiece> memory_leak_preventing(&pSlice->m_source, &MemoryPiece::Release);
+    SwapperBase * swapper = m_pNALSplitter->GetSwapper();
+    swapper->SwapMemory(&pSlice->m_source, &memCopy, 0);
+
+    int32_t pps_pid = pSlice->RetrievePicParamSetNumber();
+    if (pps_pid == -1)
+        return;
+
+    pSlice->SetPicParam(m_Headers.m_PicParams.GetHeader(pps_pid));
+    H265PicParamSet const* pps = pSlice->GetPicParam();
+    if (!pps)
+        return;
+
+    pSlice->SetSeqParam(m_Headers.m_SeqParams.GetHeader(pps->pps_seq_parameter_set_id));
+    if (!pSlice->GetSeqParam())
+        return;
+
+    pSlice->m_pCurrentFrame = NULL;
+
+    memory_leak_preventing.ClearNotification();
+
+    // slice header parsing updates prevPicOrderCntMsb/prevPocPicOrderCntLsb, the slice itself is dropped
+    pSlice->Reset(&m_pocDecoding);
+}
+
 // Decode slice header start, set slice links to SPS and PPS and correct tile offsets table if needed
 H265Slice *TaskSupplier_H265::DecodeSliceHeader(UMC::MediaDataEx *nalUnit)
 {
@@ -2342,7 +2466,7 @@ void TaskSupplier_H265::CompleteFrame(H265DecoderFrame * pFrame)
 
     // skipping algorithm
     const H265Slice *slice = slicesInfo->GetSlice(0);
-    if (!slice || IsShouldSkipFrame(pFrame) || IsSkipForCRAorBLA(slice))
+    if (!slice || IsSkipForCRAorBLA(slice))
     {
         slicesInfo->SetStatus(H265DecoderFrameInfo::STATUS_COMPLETED);
 
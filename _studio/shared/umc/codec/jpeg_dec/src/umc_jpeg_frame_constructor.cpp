@@ -24,9 +24,43 @@
 #include "umc_jpeg_frame_constructor.h"
 #include "jpegdec_base.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace UMC
 {
 
+// Returns position of the first 0xFF byte in [source, source + size) or size
+// if there is none. Entropy-coded data is the bulk of a JPEG frame and has
+// 0xFF only once per ~256 bytes, so scan it 32 bytes per iteration.
+static inline size_t FindFF(const uint8_t * source, size_t size)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i ff = _mm_set1_epi8((char)0xff);
+
+    for (; i + 32 <= size; i += 32)
+    {
+        __m128i lo = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(source + i)), ff);
+        __m128i hi = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(source + i + 16)), ff);
+
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(lo) | ((uint32_t)_mm_movemask_epi8(hi) << 16);
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+#endif
+
+    for (; i < size; i++)
+    {
+        if (source[i] == 0xff)
+            break;
+    }
+
+    return i;
+}
+
 //////////////////////////////////////////////////////
 //
 //////////////////////////////////////////////////////
@@ -88,16 +122,12 @@ int32_t JpegFrameConstructor::FindMarkerCode(uint8_t * (&source), size_t & size,
 
     for (;;)
     {
-        uint32_t i = 0;
+        uint32_t i = (uint32_t)FindFF(source, size);
         ffCount = 0;
-        for (; i < (uint32_t)size; i++)
+        if (i < (uint32_t)size)
         {
-            if (source[i] == 0xff)
-            {
-                ffCount = 1;
-                i++;
-                break;
-            }
+            ffCount = 1;
+            i++;
         }
 
         for (; i < (uint32_t)size; i++, ffCount++)
@@ -21,6 +21,7 @@
 #pragma once
 
 #include "umc_defs.h"
+#include "umc_bit_reader.h"
 
 #if defined (MFX_ENABLE_MPEG2_VIDEO_DECODE)
 
@@ -36,90 +37,36 @@ namespace UMC_MPEG2_DECODER
 
     // Bitstream low level parsing class
     class MPEG2BaseBitstream
+        : public UMC::CachedBitReader<mpeg2_exception>
     {
     public:
 
         MPEG2BaseBitstream()
         {
-            Reset(nullptr, 0);
         }
 
         MPEG2BaseBitstream(uint8_t * pb, uint32_t maxsize)
+            : UMC::CachedBitReader<mpeg2_exception>(pb, maxsize)
         {
-            Reset(pb, maxsize);
         }
 
         virtual ~MPEG2BaseBitstream()
         {
         }
 
-        // Reset the bitstream with new data pointer
-        void Reset(uint8_t * pb, uint32_t maxsize)
-        {
-            Reset(pb, 0, maxsize);
-        }
-
-        // Reset the bitstream with new data pointer and bit offset
-        void Reset(uint8_t * pb, int32_t offset, uint32_t maxsize)
-        {
-            m_pbs       = pb;
-            m_pbsBase   = pb;
-            m_bitOffset = offset;
-            m_maxBsSize = maxsize;
-        }
-
-        // Reads one bit from the buffer.
-        inline uint32_t GetBit()
-        {
-            if (m_pbs >= m_pbsBase + m_maxBsSize)
-                throw mpeg2_exception(UMC::UMC_ERR_NOT_ENOUGH_DATA);
-
-            uint32_t const bit = (*m_pbs >> (7 - m_bitOffset)) & 1;
-            if (++m_bitOffset == 8)
-            {
-                ++m_pbs;
-                m_bitOffset = 0;
-            }
-
-            return bit;
-        }
-
-        // Read N bits from bitstream array
-        inline uint32_t GetBits(uint32_t nbits)
-        {
-            uint32_t bits = 0;
-            for (; nbits > 0; --nbits)
-            {
-                bits <<= 1;
-                bits |= GetBit();
-            }
-
-            return bits;
-        }
-
-        // Move bitstream position pointer to N bits forward or backward
-        inline void Seek(int32_t nbits)
-        {
-            int32_t bitsOffset = m_bitOffset + nbits;
-            m_pbs += bitsOffset >> 3;
-            m_bitOffset = bitsOffset & 7;
-        }
-
         // Check one bit without shifting byte offset
-        inline uint32_t Check1Bit() const
+        inline uint32_t Check1Bit()
         {
-            if (m_pbs >= m_pbsBase + m_maxBsSize)
-                throw mpeg2_exception(UMC::UMC_ERR_NOT_ENOUGH_DATA);
-
-            uint32_t const bit = (*m_pbs >> (7 - m_bitOffset)) & 1;
-
-            return bit;
+            return PeekBits(1);
         }
 
-        // Return a number of bits left
-        inline size_t BitsLeft() const
+        // Show N (1..32) bits without shifting byte offset, bits past the end of the buffer read as zeros
+        inline uint32_t ShowBits(uint32_t nbits)
         {
-            return static_cast<size_t> (m_maxBsSize*8 - BitsDecoded());
+            if (m_cacheBits < static_cast<int32_t>(nbits))
+                Refill();
+
+            return static_cast<uint32_t>((m_cache >> 1) >> (63 - nbits));
         }
 
         // Check that position in bitstream didn't move outside the limit
@@ -129,24 +76,6 @@ namespace UMC_MPEG2_DECODER
             return (bitsDecoded > m_maxBsSize*8);
         }
 
-        // Returns number of decoded bits since last reset
-        inline size_t BitsDecoded() const
-        {
-            return static_cast<size_t>(m_pbs - m_pbsBase) * 8 + m_bitOffset;
-        }
-
-        // Returns number of decoded bytes since last reset
-        inline size_t BytesDecoded() const
-        {
-            return static_cast<size_t>(m_pbs - m_pbsBase) + (m_bitOffset / 8);
-        }
-
-        // Returns number of bytes left in bitstream array
-        inline size_t BytesLeft() const
-        {
-            return (int32_t)m_maxBsSize - (int32_t) BytesDecoded();
-        }
-
         // Return bitstream array base address and size
         void GetOrg(uint8_t * & pbs, uint32_t & size) const
         {
@@ -158,13 +87,6 @@ namespace UMC_MPEG2_DECODER
         {
             return m_maxBsSize;
         }
-
-    protected:
-
-        uint8_t const * m_pbs; // pointer to the current position of the buffer
-        int32_t  m_bitOffset;  // the bit position (0 to 7) in the char pointed by m_pbs
-        uint8_t* m_pbsBase;    // pointer to the first byte of the buffer
-        uint32_t m_maxBsSize;  // maximum buffer size in bytes
     };
 
     // MPEG2 bitstream headers parsing class
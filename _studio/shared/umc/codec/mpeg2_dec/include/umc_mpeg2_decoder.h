@@ -60,6 +60,10 @@ namespace UMC_MPEG2_DECODER
         uint32_t GetNumSkipFrames() const
         { return m_NumberOfSkippedFrames; }
 
+        // Check if any frames may be skipped
+        bool IsSkipEnabled() const
+        { return m_SkipLevel != SKIP_NONE; }
+
     private:
 
         enum SkipLevel
@@ -0,0 +1,88 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "umc_defs.h"
+
+#if defined (MFX_ENABLE_MPEG2_VIDEO_DECODE) && defined (MFX_ENABLE_SW_FALLBACK)
+
+#include <condition_variable>
+#include <list>
+
+#include "umc_mpeg2_decoder.h"
+#include "umc_mpeg2_slice_decoder.h"
+
+namespace UMC_MPEG2_DECODER
+{
+    // CPU decoder, used when the device has no MPEG-2 decode support.
+    // Submitted pictures are queued and their slices are decoded by the
+    // scheduler threads calling QueryFrames, several slices at a time.
+    class MPEG2DecoderSW
+        : public MPEG2Decoder
+    {
+    public:
+
+        UMC::Status SetParams(UMC::BaseCodecParams*) override;
+
+        UMC::Status Reset() override;
+
+        // Decode one slice of the submitted pictures and check for frame completeness,
+        // returns false if there was nothing to decode
+        bool QueryFrames(MPEG2DecoderFrame&) override;
+
+    private:
+
+        struct PictureTask
+        {
+            MPEG2DecoderFrame*            frame      = nullptr;
+            uint8_t                       fieldIndex = 0;
+            bool                          reference  = false; // I or P, later pictures may predict from it
+            MPEG2PictureContext           context;
+            std::vector<UMC::FrameMemID>  locked;             // surfaces locked for the planes in context
+            size_t                        sliceCount = 0;
+            size_t                        started    = 0;
+            size_t                        completed  = 0;
+        };
+
+        void AllocateFrameData(UMC::VideoDataInfo const&, UMC::FrameMemID, MPEG2DecoderFrame&) override;
+        // Queue picture for decoding
+        UMC::Status Submit(MPEG2DecoderFrame&, uint8_t) override;
+        UMC::Status CompletePicture(MPEG2DecoderFrame&, uint8_t) override;
+
+        // Lock the frame surface and return its planes
+        MPEG2FramePlanes LockFrame(MPEG2DecoderFrame const&, PictureTask&);
+        // Earliest picture up to decOrder with a slice to start, m_tasksGuard must be held
+        PictureTask* FindNextSlice(uint32_t decOrder) const;
+        // Decode a slice of the earliest picture that doesn't wait for its references
+        bool DecodeNextSlice(uint32_t decOrder);
+        // Decode the queued pictures of the frame on the calling thread
+        void WaitForFrame(MPEG2DecoderFrame const&);
+        bool HasTasks(MPEG2DecoderFrame const&) const;
+
+    private:
+
+        std::mutex                               m_tasksGuard;
+        std::condition_variable                  m_pictureDone; // a picture got its last slice decoded
+        std::list<std::unique_ptr<PictureTask>>  m_tasks;      // in decoding order
+    };
+}
+
+#endif // MFX_ENABLE_MPEG2_VIDEO_DECODE && MFX_ENABLE_SW_FALLBACK
@@ -0,0 +1,56 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "umc_defs.h"
+
+#if defined (MFX_ENABLE_MPEG2_VIDEO_DECODE) && defined (MFX_ENABLE_SW_FALLBACK)
+
+#include <stdint.h>
+
+// Pixel kernels of the CPU decoder. The SSE2 variants are used when the
+// compiler targets SSE2 (always on x86-64) and give the same results as
+// the C ones.
+namespace UMC_MPEG2_DECODER
+{
+    // Inverse 8x8 DCT of dequantized coefficients in raster order. The
+    // arithmetic is the widely used 'simple' integer IDCT (IEEE 1180
+    // compliant), so reconstruction matches common software decoders.
+    void IDCT8x8(int16_t* block);
+
+    // dst = clip(block) / dst = clip(dst + block) for one 8x8 luma block
+    void PutBlock(const int16_t* block, uint8_t* dst, int32_t pitch);
+    void AddBlock(const int16_t* block, uint8_t* dst, int32_t pitch);
+
+    // Same for a pair of 8x8 Cb and Cr blocks written to interleaved (NV12) chroma
+    void PutBlockUV(const int16_t* cb, const int16_t* cr, uint8_t* dst, int32_t pitch);
+    void AddBlockUV(const int16_t* cb, const int16_t* cr, uint8_t* dst, int32_t pitch);
+
+    // Half sample prediction of a 16 byte wide block. 'dxy' is the half
+    // sample phase (bit 0 horizontal, bit 1 vertical), 'step' is the
+    // distance to the horizontal neighbour (1 for luma, 2 for NV12 chroma).
+    // With 'average' the prediction is averaged into dst (bidirectional and
+    // dual prime prediction). Reads 16 + step bytes from h + 1 rows.
+    void Predict16(const uint8_t* src, int32_t srcPitch, uint8_t* dst, int32_t dstPitch,
+                   int32_t h, int32_t dxy, int32_t step, bool average);
+}
+
+#endif // MFX_ENABLE_MPEG2_VIDEO_DECODE && MFX_ENABLE_SW_FALLBACK
@@ -0,0 +1,161 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "umc_defs.h"
+
+#if defined (MFX_ENABLE_MPEG2_VIDEO_DECODE) && defined (MFX_ENABLE_SW_FALLBACK)
+
+#include "umc_mpeg2_defs.h"
+#include "umc_mpeg2_bitstream.h"
+
+namespace UMC_MPEG2_DECODER
+{
+    class MPEG2Slice;
+
+    // Locked NV12 frame, both planes share the pitch
+    struct MPEG2FramePlanes
+    {
+        uint8_t* y     = nullptr;
+        uint8_t* uv    = nullptr;
+        int32_t  pitch = 0;
+    };
+
+    // Picture (frame or field) parameters shared by all its slices
+    struct MPEG2PictureContext
+    {
+        uint8_t  pictureCodingType        = 0;
+        uint8_t  pictureStructure         = 0;
+        bool     secondField              = false;
+        bool     topFieldFirst            = false;
+        bool     framePredFrameDct        = false;
+        bool     concealmentMotionVectors = false;
+        bool     qScaleType               = false;
+        bool     intraVlcFormat           = false;
+        bool     alternateScan            = false;
+        uint8_t  intraDcPrecision         = 0;
+        uint8_t  fCode[2][2]              = {};     // [forward/backward][horizontal/vertical]
+        bool     verticalPositionExt      = false;  // vertical_size > 2800
+
+        int32_t  width                    = 0;      // luma samples of the frame buffers
+        int32_t  height                   = 0;
+        int32_t  mbWidth                  = 0;
+        int32_t  mbHeight                 = 0;      // of the picture, in field MBs for fields
+
+        uint8_t  intraQM[64]              = {};     // raster order
+        uint8_t  nonIntraQM[64]           = {};
+
+        MPEG2FramePlanes cur;
+        MPEG2FramePlanes ref[2];                    // forward and backward references
+    };
+
+    // Reorders a quantiser matrix from the bitstream (zigzag) order to raster order
+    void ZigzagToRaster(uint8_t const* zigzag, uint8_t* raster);
+
+    // Parses the macroblocks of one slice and reconstructs them into the
+    // current frame. Slices of a picture are independent, so any number of
+    // them may be decoded at the same time.
+    class MPEG2SliceDecoder
+    {
+    public:
+
+        MPEG2SliceDecoder(MPEG2PictureContext const&);
+
+        // Returns false if the slice is corrupted, the rest of it is then
+        // concealed with the forward reference
+        bool DecodeSlice(MPEG2Slice const&);
+
+    private:
+
+        enum
+        {
+            MB_QUANT           = 1,
+            MB_MOTION_FORWARD  = 2,
+            MB_MOTION_BACKWARD = 4,
+            MB_PATTERN         = 8,
+            MB_INTRA           = 16,
+        };
+
+        enum MotionType
+        {
+            MC_FIELD = 1,
+            MC_FRAME = 2, // frame pictures
+            MC_16X8  = 2, // field pictures
+            MC_DMV   = 3,
+        };
+
+        struct Motion
+        {
+            uint8_t  type           = MC_FRAME;
+            uint8_t  directions     = 0;      // MB_MOTION_FORWARD | MB_MOTION_BACKWARD
+            int16_t  mv[2][2][2]    = {};     // [r][s][t]
+            uint8_t  fieldSelect[2][2] = {};  // [r][s]
+            int16_t  dmv[2]         = {};
+        };
+
+        struct PlaneView
+        {
+            uint8_t* ptr;
+            int32_t  pitch;
+            int32_t  rows;
+        };
+
+        void DecodeMacroblock(int32_t address);
+        void SetQuantiserScale(uint32_t code);
+        void DecodeMotionVectors(Motion&, int32_t s);
+        int32_t DecodeMotionComponent(int32_t pred, int32_t fcode);
+        void DecodeIntraBlock(int16_t* block, int32_t cc);
+        void DecodeNonIntraBlock(int16_t* block);
+        void DecodeCoefficients(int16_t* block, int32_t n, int32_t parity, uint8_t const* qm, bool intra);
+
+        void SkipMacroblock(int32_t address);
+        void PredictMacroblock(Motion const&, int32_t mbx, int32_t mby);
+        // parity < 0 predicts from the frame, 0 and 1 from one of its fields
+        void PredictField(MPEG2FramePlanes const& ref, int32_t parity, int32_t mbx, int32_t row,
+                          int32_t mvx, int32_t mvy, uint8_t* dstY, uint8_t* dstUV, int32_t dstPitch,
+                          int32_t h, bool average);
+        void Predict(PlaneView const& ref, bool chroma, int32_t x, int32_t y, int32_t dxy,
+                     uint8_t* dst, int32_t dstPitch, int32_t h, bool average);
+        void Conceal(int32_t address, int32_t end);
+
+        PlaneView GetView(MPEG2FramePlanes const&, bool chroma, int32_t parity) const;
+        MPEG2FramePlanes const& GetFieldReference(int32_t s, int32_t parity) const;
+
+        void ResetDcPredictors();
+
+    private:
+
+        MPEG2PictureContext const& m_ctx;
+        MPEG2BaseBitstream         m_bs;
+
+        bool     m_fieldPicture;
+        int32_t  m_parity;           // of the current field
+        int32_t  m_quantiserScale;
+        int32_t  m_dcPred[3];
+        int32_t  m_pmv[2][2][2];     // motion vector predictors [r][s][t]
+        Motion   m_motion;           // of the last coded macroblock, reused by skipped ones in B pictures
+        bool     m_motionValid;
+
+        alignas(16) int16_t m_blocks[6][64];
+    };
+}
+
+#endif // MFX_ENABLE_MPEG2_VIDEO_DECODE && MFX_ENABLE_SW_FALLBACK
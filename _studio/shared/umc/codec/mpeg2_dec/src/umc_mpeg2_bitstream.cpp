@@ -367,12 +367,10 @@ namespace UMC_MPEG2_DECODER
         {
             bitsToRead = BitsLeft() <= 11 ? BitsLeft() : 11;
 
-            cc = GetBits(bitsToRead);
+            cc = PeekBits(bitsToRead);
             if (11 - bitsToRead) // if left bits are less than 11
                 cc <<= (11 - bitsToRead);
 
-            Seek(-bitsToRead);
-
             if (cc >= 24)
                 break;
 
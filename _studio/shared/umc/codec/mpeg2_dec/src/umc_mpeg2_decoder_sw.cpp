@@ -0,0 +1,325 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "umc_defs.h"
+#if defined (MFX_ENABLE_MPEG2_VIDEO_DECODE) && defined (MFX_ENABLE_SW_FALLBACK)
+
+#include <algorithm>
+
+#include "mfx_utils.h"
+#include "umc_frame_allocator.h"
+#include "umc_mpeg2_decoder_sw.h"
+#include "umc_mpeg2_slice.h"
+
+namespace UMC_MPEG2_DECODER
+{
+    // 6.3.11, zigzag order
+    static const uint8_t default_intra_quantizer_matrix[64] =
+    {
+         8, 16, 16, 19, 16, 19, 22, 22,
+        22, 22, 22, 22, 26, 24, 26, 27,
+        27, 27, 26, 26, 26, 26, 27, 27,
+        27, 29, 29, 29, 34, 34, 34, 29,
+        29, 29, 27, 27, 29, 29, 32, 32,
+        34, 34, 37, 38, 37, 35, 35, 34,
+        35, 38, 38, 40, 40, 40, 48, 48,
+        46, 46, 56, 56, 58, 69, 69, 83
+    };
+
+    UMC::Status MPEG2DecoderSW::SetParams(UMC::BaseCodecParams*)
+    {
+        SetDPBSize(m_params.async_depth + NUM_REF_FRAMES);
+
+        return UMC::UMC_OK;
+    }
+
+    UMC::Status MPEG2DecoderSW::Reset()
+    {
+        {
+            std::unique_lock<std::mutex> l(m_tasksGuard);
+
+            for (auto const& task : m_tasks)
+                for (UMC::FrameMemID id : task->locked)
+                    m_allocator->Unlock(id);
+
+            m_tasks.clear();
+        }
+
+        m_pictureDone.notify_all();
+
+        return MPEG2Decoder::Reset();
+    }
+
+    // Allocate frame internals
+    void MPEG2DecoderSW::AllocateFrameData(UMC::VideoDataInfo const& info, UMC::FrameMemID id, MPEG2DecoderFrame& frame)
+    {
+        UMC::FrameData fd;
+        fd.Init(&info, id, m_allocator);
+
+        frame.Allocate(&fd);
+
+        auto fd2 = frame.GetFrameData();
+        fd2->m_locked = true;
+    }
+
+    // Lock the frame surface and return its planes
+    MPEG2FramePlanes MPEG2DecoderSW::LockFrame(MPEG2DecoderFrame const& frame, PictureTask& task)
+    {
+        UMC::FrameData const* fd = m_allocator->Lock(frame.GetMemID());
+        if (!fd)
+            throw mpeg2_exception(UMC::UMC_ERR_LOCK);
+
+        task.locked.push_back(frame.GetMemID());
+
+        MPEG2FramePlanes planes;
+        planes.y     = fd->GetPlaneMemoryInfo(0)->m_planePtr;
+        planes.uv    = fd->GetPlaneMemoryInfo(1)->m_planePtr;
+        planes.pitch = static_cast<int32_t>(fd->GetPlaneMemoryInfo(0)->m_pitch);
+
+        return planes;
+    }
+
+    // Queue picture for decoding
+    UMC::Status MPEG2DecoderSW::Submit(MPEG2DecoderFrame& frame, uint8_t fieldIndex)
+    {
+        MPEG2DecoderFrameInfo const& info = *frame.GetAU(fieldIndex);
+        MPEG2Slice const* slice = info.GetSlice(0);
+        MFX_CHECK(slice, UMC::UMC_ERR_FAILED);
+
+        auto const& seq    = slice->GetSeqHeader();
+        auto const& seqExt = slice->GetSeqExtHeader();
+        auto const& pic    = slice->GetPicHeader();
+        auto const& picExt = slice->GetPicExtHeader();
+
+        std::unique_ptr<PictureTask> task(new PictureTask);
+        task->frame      = &frame;
+        task->fieldIndex = fieldIndex;
+        task->reference  = pic.picture_coding_type != MPEG2_B_PICTURE;
+        task->sliceCount = info.GetSliceCount();
+
+        MPEG2PictureContext& ctx = task->context;
+        ctx.pictureCodingType        = pic.picture_coding_type;
+        ctx.pictureStructure         = picExt.picture_structure;
+        ctx.secondField              = fieldIndex == 1;
+        ctx.topFieldFirst            = picExt.top_field_first;
+        ctx.framePredFrameDct        = picExt.frame_pred_frame_dct;
+        ctx.concealmentMotionVectors = picExt.concealment_motion_vectors;
+        ctx.qScaleType               = picExt.q_scale_type;
+        ctx.intraVlcFormat           = picExt.intra_vlc_format;
+        ctx.alternateScan            = picExt.alternate_scan;
+        ctx.intraDcPrecision         = picExt.intra_dc_precision;
+        ctx.fCode[0][0]              = picExt.f_code[0];
+        ctx.fCode[0][1]              = picExt.f_code[1];
+        ctx.fCode[1][0]              = picExt.f_code[2];
+        ctx.fCode[1][1]              = picExt.f_code[3];
+        ctx.verticalPositionExt      = seq.vertical_size_value > 2800;
+
+        // coded size in macroblocks, limited by the surface
+        UMC::VideoDataInfo const* surface = frame.GetFrameData()->GetInfo();
+        int32_t const surfaceMbWidth  = static_cast<int32_t>(surface->GetWidth()) / 16;
+        int32_t const surfaceMbHeight = static_cast<int32_t>(surface->GetHeight()) / 16;
+
+        int32_t const frameMbHeight = seqExt.progressive_sequence ?
+            static_cast<int32_t>(mfx::align2_value<uint32_t>(seq.vertical_size_value, 16) / 16) :
+            static_cast<int32_t>(mfx::align2_value<uint32_t>(seq.vertical_size_value, 32) / 16);
+
+        ctx.mbWidth  = std::min(static_cast<int32_t>(mfx::align2_value<uint32_t>(seq.horizontal_size_value, 16) / 16), surfaceMbWidth);
+        ctx.width    = ctx.mbWidth * 16;
+        ctx.height   = std::min(frameMbHeight, surfaceMbHeight) * 16;
+        ctx.mbHeight = ctx.pictureStructure == FRM_PICTURE ? ctx.height / 16 : ctx.height / 32;
+
+        // quantiser matrices, in 4:2:0 luma ones are used for chroma
+        MPEG2QuantMatrix const* customQM = slice->GetQMatrix();
+
+        uint8_t const* intraQM = customQM && customQM->load_intra_quantiser_matrix ?
+                                    customQM->intra_quantiser_matrix :
+                                    (seq.load_intra_quantiser_matrix ? seq.intra_quantiser_matrix : default_intra_quantizer_matrix);
+        ZigzagToRaster(intraQM, ctx.intraQM);
+
+        uint8_t const* nonIntraQM = customQM && customQM->load_non_intra_quantiser_matrix ?
+                                    customQM->non_intra_quantiser_matrix :
+                                    (seq.load_non_intra_quantiser_matrix ? seq.non_intra_quantiser_matrix : nullptr);
+        if (nonIntraQM)
+            ZigzagToRaster(nonIntraQM, ctx.nonIntraQM);
+        else
+            std::fill(std::begin(ctx.nonIntraQM), std::end(ctx.nonIntraQM), uint8_t(16));
+
+        MPEG2DecoderFrame const* forward  = info.GetForwardRefPic();
+        MPEG2DecoderFrame const* backward = info.GetBackwardRefPic();
+
+        // P field after an I field of the same frame: the same parity comes from the previous reference frame
+        if (forward == &frame)
+        {
+            std::unique_lock<std::mutex> l(m_guard);
+
+            forward = nullptr;
+            for (MPEG2DecoderFrame const* f : m_dpb)
+            {
+                if (f != &frame && !f->Empty() && f->IsRef() && (!forward || f->decOrder > forward->decOrder))
+                    forward = f;
+            }
+        }
+
+        try
+        {
+            ctx.cur    = LockFrame(frame, *task);
+            // missing references are replaced by the current frame, prediction from it is broken but safe
+            ctx.ref[0] = forward  ? LockFrame(*forward, *task)  : ctx.cur;
+            ctx.ref[1] = backward ? LockFrame(*backward, *task) : ctx.ref[0];
+        }
+        catch (mpeg2_exception const& ex)
+        {
+            for (UMC::FrameMemID id : task->locked)
+                m_allocator->Unlock(id);
+
+            frame.AddError(UMC::ERROR_FRAME_MAJOR);
+            return ex.GetStatus();
+        }
+
+        std::unique_lock<std::mutex> l(m_tasksGuard);
+        m_tasks.push_back(std::move(task));
+
+        return UMC::UMC_OK;
+    }
+
+    UMC::Status MPEG2DecoderSW::CompletePicture(MPEG2DecoderFrame& frame, uint8_t fieldIndex)
+    {
+        // A skipped frame frees its slices right away, the first field must be done by then
+        if (fieldIndex && IsSkipEnabled())
+            WaitForFrame(frame);
+
+        return MPEG2Decoder::CompletePicture(frame, fieldIndex);
+    }
+
+    bool MPEG2DecoderSW::HasTasks(MPEG2DecoderFrame const& frame) const
+    {
+        return std::any_of(m_tasks.begin(), m_tasks.end(),
+            [&frame](std::unique_ptr<PictureTask> const& task) { return task->frame == &frame; });
+    }
+
+    MPEG2DecoderSW::PictureTask* MPEG2DecoderSW::FindNextSlice(uint32_t decOrder) const
+    {
+        for (auto const& t : m_tasks)
+        {
+            if (t->frame->decOrder > decOrder) // skip frames beyond the current frame (in dec order)
+                break;
+
+            if (t->started < t->sliceCount)
+                return t.get();
+
+            // pictures after an unfinished reference may predict from it
+            if (t->reference && t->completed < t->sliceCount)
+                break;
+        }
+
+        return nullptr;
+    }
+
+    // Decode a slice of the earliest picture that doesn't wait for its references
+    bool MPEG2DecoderSW::DecodeNextSlice(uint32_t decOrder)
+    {
+        PictureTask* task = nullptr;
+        size_t sliceIndex = 0;
+
+        {
+            std::unique_lock<std::mutex> l(m_tasksGuard);
+
+            task = FindNextSlice(decOrder);
+            if (!task)
+                return false;
+
+            sliceIndex = task->started++;
+        }
+
+        MPEG2SliceDecoder decoder(task->context);
+        bool const ok = decoder.DecodeSlice(*task->frame->GetAU(task->fieldIndex)->GetSlice(static_cast<uint32_t>(sliceIndex)));
+
+        bool pictureDone = false;
+
+        {
+            std::unique_lock<std::mutex> l(m_tasksGuard);
+
+            if (!ok)
+                task->frame->AddError(UMC::ERROR_FRAME_MINOR);
+
+            if (++task->completed == task->sliceCount)
+            {
+                for (UMC::FrameMemID id : task->locked)
+                    m_allocator->Unlock(id);
+
+                m_tasks.remove_if([task](std::unique_ptr<PictureTask> const& t) { return t.get() == task; });
+                pictureDone = true;
+            }
+        }
+
+        // only a finished picture can complete a frame or let the pictures predicted from it start
+        if (pictureDone)
+            m_pictureDone.notify_all();
+
+        return true;
+    }
+
+    // Decode the queued pictures of the frame on the calling thread
+    void MPEG2DecoderSW::WaitForFrame(MPEG2DecoderFrame const& frame)
+    {
+        for (;;)
+        {
+            if (DecodeNextSlice(frame.decOrder))
+                continue;
+
+            // the remaining slices are being decoded by other threads
+            std::unique_lock<std::mutex> l(m_tasksGuard);
+            m_pictureDone.wait(l, [this, &frame]
+                { return !HasTasks(frame) || FindNextSlice(frame.decOrder); });
+
+            if (!HasTasks(frame))
+                return;
+        }
+    }
+
+    // Decode one slice of the submitted pictures and check for frame completeness
+    bool MPEG2DecoderSW::QueryFrames(MPEG2DecoderFrame& frame)
+    {
+        bool const progress = DecodeNextSlice(frame.decOrder);
+
+        DPBType decodeQueue;
+
+        {
+            std::unique_lock<std::mutex> l(m_guard);
+
+            std::copy_if(m_dpb.begin(), m_dpb.end(), std::back_inserter(decodeQueue),
+                [&frame](MPEG2DecoderFrame const* f)
+                { return f->DecodingStarted() && !f->DecodingCompleted() && f->IsFullFrame() && f->decOrder <= frame.decOrder; }
+            );
+        }
+
+        std::unique_lock<std::mutex> l(m_tasksGuard);
+
+        for (MPEG2DecoderFrame* f : decodeQueue)
+        {
+            if (!f->DecodingCompleted() && !HasTasks(*f))
+                f->CompleteDecoding();
+        }
+
+        return progress;
+    }
+}
+
+#endif // MFX_ENABLE_MPEG2_VIDEO_DECODE && MFX_ENABLE_SW_FALLBACK
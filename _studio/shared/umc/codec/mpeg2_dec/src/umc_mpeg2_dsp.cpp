@@ -0,0 +1,392 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "umc_defs.h"
+
+#if defined (MFX_ENABLE_MPEG2_VIDEO_DECODE) && defined (MFX_ENABLE_SW_FALLBACK)
+
+#include "umc_mpeg2_dsp.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace UMC_MPEG2_DECODER
+{
+    // cos(k * pi / 16) * sqrt(2) * (1 << 14)
+    enum
+    {
+        W1 = 22725,
+        W2 = 21407,
+        W3 = 19266,
+        W4 = 16383,
+        W5 = 12873,
+        W6 = 8867,
+        W7 = 4520,
+
+        ROW_SHIFT = 11,
+        COL_SHIFT = 20
+    };
+
+    inline int16_t Saturate16(int32_t v)
+    {
+        return (int16_t)(v < -32768 ? -32768 : (v > 32767 ? 32767 : v));
+    }
+
+    inline uint8_t Clip8(int32_t v)
+    {
+        return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+
+#if !defined(__SSE2__)
+
+    static void IDCTRow(int16_t* row)
+    {
+        if (!(row[1] | row[2] | row[3] | row[4] | row[5] | row[6] | row[7]))
+        {
+            // DC only rows are scaled without rounding, the result is kept to 16 bits
+            int16_t const dc = (int16_t)(row[0] * 8);
+            for (int i = 0; i < 8; ++i)
+                row[i] = dc;
+            return;
+        }
+
+        int32_t a0 = W4 * row[0] + (1 << (ROW_SHIFT - 1));
+        int32_t a1 = a0, a2 = a0, a3 = a0;
+
+        a0 += W2 * row[2] + W4 * row[4] + W6 * row[6];
+        a1 += W6 * row[2] - W4 * row[4] - W2 * row[6];
+        a2 -= W6 * row[2] + W4 * row[4] - W2 * row[6];
+        a3 -= W2 * row[2] - W4 * row[4] + W6 * row[6];
+
+        int32_t const b0 = W1 * row[1] + W3 * row[3] + W5 * row[5] + W7 * row[7];
+        int32_t const b1 = W3 * row[1] - W7 * row[3] - W1 * row[5] - W5 * row[7];
+        int32_t const b2 = W5 * row[1] - W1 * row[3] + W7 * row[5] + W3 * row[7];
+        int32_t const b3 = W7 * row[1] - W5 * row[3] + W3 * row[5] - W1 * row[7];
+
+        row[0] = Saturate16((a0 + b0) >> ROW_SHIFT);
+        row[7] = Saturate16((a0 - b0) >> ROW_SHIFT);
+        row[1] = Saturate16((a1 + b1) >> ROW_SHIFT);
+        row[6] = Saturate16((a1 - b1) >> ROW_SHIFT);
+        row[2] = Saturate16((a2 + b2) >> ROW_SHIFT);
+        row[5] = Saturate16((a2 - b2) >> ROW_SHIFT);
+        row[3] = Saturate16((a3 + b3) >> ROW_SHIFT);
+        row[4] = Saturate16((a3 - b3) >> ROW_SHIFT);
+    }
+
+    static void IDCTCol(int16_t* col)
+    {
+        // rounding is folded into the DC term: (1 << (COL_SHIFT - 1)) / W4 == 32
+        int32_t a0 = W4 * (col[8 * 0] + 32);
+        int32_t a1 = a0, a2 = a0, a3 = a0;
+
+        a0 += W2 * col[8 * 2] + W4 * col[8 * 4] + W6 * col[8 * 6];
+        a1 += W6 * col[8 * 2] - W4 * col[8 * 4] - W2 * col[8 * 6];
+        a2 -= W6 * col[8 * 2] + W4 * col[8 * 4] - W2 * col[8 * 6];
+        a3 -= W2 * col[8 * 2] - W4 * col[8 * 4] + W6 * col[8 * 6];
+
+        int32_t const b0 = W1 * col[8 * 1] + W3 * col[8 * 3] + W5 * col[8 * 5] + W7 * col[8 * 7];
+        int32_t const b1 = W3 * col[8 * 1] - W7 * col[8 * 3] - W1 * col[8 * 5] - W5 * col[8 * 7];
+        int32_t const b2 = W5 * col[8 * 1] - W1 * col[8 * 3] + W7 * col[8 * 5] + W3 * col[8 * 7];
+        int32_t const b3 = W7 * col[8 * 1] - W5 * col[8 * 3] + W3 * col[8 * 5] - W1 * col[8 * 7];
+
+        col[8 * 0] = Saturate16((a0 + b0) >> COL_SHIFT);
+        col[8 * 7] = Saturate16((a0 - b0) >> COL_SHIFT);
+        col[8 * 1] = Saturate16((a1 + b1) >> COL_SHIFT);
+        col[8 * 6] = Saturate16((a1 - b1) >> COL_SHIFT);
+        col[8 * 2] = Saturate16((a2 + b2) >> COL_SHIFT);
+        col[8 * 5] = Saturate16((a2 - b2) >> COL_SHIFT);
+        col[8 * 3] = Saturate16((a3 + b3) >> COL_SHIFT);
+        col[8 * 4] = Saturate16((a3 - b3) >> COL_SHIFT);
+    }
+
+    void IDCT8x8(int16_t* block)
+    {
+        for (int i = 0; i < 8; ++i)
+            IDCTRow(block + 8 * i);
+
+        for (int i = 0; i < 8; ++i)
+            IDCTCol(block + i);
+    }
+
+    void PutBlock(const int16_t* block, uint8_t* dst, int32_t pitch)
+    {
+        for (int y = 0; y < 8; ++y, block += 8, dst += pitch)
+            for (int x = 0; x < 8; ++x)
+                dst[x] = Clip8(block[x]);
+    }
+
+    void AddBlock(const int16_t* block, uint8_t* dst, int32_t pitch)
+    {
+        for (int y = 0; y < 8; ++y, block += 8, dst += pitch)
+            for (int x = 0; x < 8; ++x)
+                dst[x] = Clip8(dst[x] + block[x]);
+    }
+
+    void PutBlockUV(const int16_t* cb, const int16_t* cr, uint8_t* dst, int32_t pitch)
+    {
+        for (int y = 0; y < 8; ++y, cb += 8, cr += 8, dst += pitch)
+            for (int x = 0; x < 8; ++x)
+            {
+                dst[2 * x]     = Clip8(cb[x]);
+                dst[2 * x + 1] = Clip8(cr[x]);
+            }
+    }
+
+    void AddBlockUV(const int16_t* cb, const int16_t* cr, uint8_t* dst, int32_t pitch)
+    {
+        for (int y = 0; y < 8; ++y, cb += 8, cr += 8, dst += pitch)
+            for (int x = 0; x < 8; ++x)
+            {
+                dst[2 * x]     = Clip8(dst[2 * x]     + cb[x]);
+                dst[2 * x + 1] = Clip8(dst[2 * x + 1] + cr[x]);
+            }
+    }
+
+    void Predict16(const uint8_t* src, int32_t srcPitch, uint8_t* dst, int32_t dstPitch,
+                   int32_t h, int32_t dxy, int32_t step, bool average)
+    {
+        for (int32_t y = 0; y < h; ++y, src += srcPitch, dst += dstPitch)
+        {
+            for (int32_t x = 0; x < 16; ++x)
+            {
+                int32_t p;
+                switch (dxy)
+                {
+                case 0:  p = src[x]; break;
+                case 1:  p = (src[x] + src[x + step] + 1) >> 1; break;
+                case 2:  p = (src[x] + src[x + srcPitch] + 1) >> 1; break;
+                default: p = (src[x] + src[x + step] + src[x + srcPitch] + src[x + srcPitch + step] + 2) >> 2; break;
+                }
+
+                dst[x] = (uint8_t)(average ? (dst[x] + p + 1) >> 1 : p);
+            }
+        }
+    }
+
+#else // __SSE2__
+
+    // (w0, w1) repeated, multiplies interleaved (x, y) pairs with _mm_madd_epi16
+    inline __m128i Pair(int16_t w0, int16_t w1)
+    {
+        return _mm_set1_epi32((int32_t)(((uint32_t)(uint16_t)w1 << 16) | (uint16_t)w0));
+    }
+
+    static inline void Transpose8x8(__m128i r[8])
+    {
+        __m128i const a0 = _mm_unpacklo_epi16(r[0], r[1]);
+        __m128i const a1 = _mm_unpackhi_epi16(r[0], r[1]);
+        __m128i const a2 = _mm_unpacklo_epi16(r[2], r[3]);
+        __m128i const a3 = _mm_unpackhi_epi16(r[2], r[3]);
+        __m128i const a4 = _mm_unpacklo_epi16(r[4], r[5]);
+        __m128i const a5 = _mm_unpackhi_epi16(r[4], r[5]);
+        __m128i const a6 = _mm_unpacklo_epi16(r[6], r[7]);
+        __m128i const a7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+        __m128i const b0 = _mm_unpacklo_epi32(a0, a2);
+        __m128i const b1 = _mm_unpackhi_epi32(a0, a2);
+        __m128i const b2 = _mm_unpacklo_epi32(a1, a3);
+        __m128i const b3 = _mm_unpackhi_epi32(a1, a3);
+        __m128i const b4 = _mm_unpacklo_epi32(a4, a6);
+        __m128i const b5 = _mm_unpackhi_epi32(a4, a6);
+        __m128i const b6 = _mm_unpacklo_epi32(a5, a7);
+        __m128i const b7 = _mm_unpackhi_epi32(a5, a7);
+
+        r[0] = _mm_unpacklo_epi64(b0, b4);
+        r[1] = _mm_unpackhi_epi64(b0, b4);
+        r[2] = _mm_unpacklo_epi64(b1, b5);
+        r[3] = _mm_unpackhi_epi64(b1, b5);
+        r[4] = _mm_unpacklo_epi64(b2, b6);
+        r[5] = _mm_unpackhi_epi64(b2, b6);
+        r[6] = _mm_unpacklo_epi64(b3, b7);
+        r[7] = _mm_unpackhi_epi64(b3, b7);
+    }
+
+    // One dimensional IDCT of eight vectors, lanes are independent transforms
+    template <int SHIFT>
+    static inline void IDCT1D(__m128i x[8], __m128i rnd)
+    {
+        __m128i const x02l = _mm_unpacklo_epi16(x[0], x[2]), x02h = _mm_unpackhi_epi16(x[0], x[2]);
+        __m128i const x46l = _mm_unpacklo_epi16(x[4], x[6]), x46h = _mm_unpackhi_epi16(x[4], x[6]);
+        __m128i const x13l = _mm_unpacklo_epi16(x[1], x[3]), x13h = _mm_unpackhi_epi16(x[1], x[3]);
+        __m128i const x57l = _mm_unpacklo_epi16(x[5], x[7]), x57h = _mm_unpackhi_epi16(x[5], x[7]);
+
+#define MPEG2_MADD(xy0, w0a, w0b, xy1, w1a, w1b) \
+        _mm_add_epi32(_mm_madd_epi16(xy0, Pair(w0a, w0b)), _mm_madd_epi16(xy1, Pair(w1a, w1b)))
+
+        __m128i const a0l = _mm_add_epi32(MPEG2_MADD(x02l, W4,  W2, x46l,  W4,  W6), rnd);
+        __m128i const a0h = _mm_add_epi32(MPEG2_MADD(x02h, W4,  W2, x46h,  W4,  W6), rnd);
+        __m128i const a1l = _mm_add_epi32(MPEG2_MADD(x02l, W4,  W6, x46l, -W4, -W2), rnd);
+        __m128i const a1h = _mm_add_epi32(MPEG2_MADD(x02h, W4,  W6, x46h, -W4, -W2), rnd);
+        __m128i const a2l = _mm_add_epi32(MPEG2_MADD(x02l, W4, -W6, x46l, -W4,  W2), rnd);
+        __m128i const a2h = _mm_add_epi32(MPEG2_MADD(x02h, W4, -W6, x46h, -W4,  W2), rnd);
+        __m128i const a3l = _mm_add_epi32(MPEG2_MADD(x02l, W4, -W2, x46l,  W4, -W6), rnd);
+        __m128i const a3h = _mm_add_epi32(MPEG2_MADD(x02h, W4, -W2, x46h,  W4, -W6), rnd);
+
+        __m128i const b0l = MPEG2_MADD(x13l, W1,  W3, x57l,  W5,  W7);
+        __m128i const b0h = MPEG2_MADD(x13h, W1,  W3, x57h,  W5,  W7);
+        __m128i const b1l = MPEG2_MADD(x13l, W3, -W7, x57l, -W1, -W5);
+        __m128i const b1h = MPEG2_MADD(x13h, W3, -W7, x57h, -W1, -W5);
+        __m128i const b2l = MPEG2_MADD(x13l, W5, -W1, x57l,  W7,  W3);
+        __m128i const b2h = MPEG2_MADD(x13h, W5, -W1, x57h,  W7,  W3);
+        __m128i const b3l = MPEG2_MADD(x13l, W7, -W5, x57l,  W3, -W1);
+        __m128i const b3h = MPEG2_MADD(x13h, W7, -W5, x57h,  W3, -W1);
+
+#undef MPEG2_MADD
+
+#define MPEG2_OUT(a, b, op) \
+        _mm_packs_epi32(_mm_srai_epi32(op(a##l, b##l), SHIFT), _mm_srai_epi32(op(a##h, b##h), SHIFT))
+
+        x[0] = MPEG2_OUT(a0, b0, _mm_add_epi32);
+        x[7] = MPEG2_OUT(a0, b0, _mm_sub_epi32);
+        x[1] = MPEG2_OUT(a1, b1, _mm_add_epi32);
+        x[6] = MPEG2_OUT(a1, b1, _mm_sub_epi32);
+        x[2] = MPEG2_OUT(a2, b2, _mm_add_epi32);
+        x[5] = MPEG2_OUT(a2, b2, _mm_sub_epi32);
+        x[3] = MPEG2_OUT(a3, b3, _mm_add_epi32);
+        x[4] = MPEG2_OUT(a3, b3, _mm_sub_epi32);
+
+#undef MPEG2_OUT
+    }
+
+    void IDCT8x8(int16_t* block)
+    {
+        __m128i r[8];
+        for (int i = 0; i < 8; ++i)
+            r[i] = _mm_loadu_si128((const __m128i*)(block + 8 * i));
+
+        // rows: transpose so that every lane holds one row
+        Transpose8x8(r);
+
+        __m128i const ac = _mm_or_si128(_mm_or_si128(_mm_or_si128(r[1], r[2]), _mm_or_si128(r[3], r[4])),
+                                        _mm_or_si128(_mm_or_si128(r[5], r[6]), r[7]));
+        __m128i const dcOnly = _mm_cmpeq_epi16(ac, _mm_setzero_si128());
+        __m128i const dc = _mm_and_si128(dcOnly, _mm_slli_epi16(r[0], 3));
+
+        IDCT1D<ROW_SHIFT>(r, _mm_set1_epi32(1 << (ROW_SHIFT - 1)));
+
+        for (int i = 0; i < 8; ++i)
+            r[i] = _mm_or_si128(dc, _mm_andnot_si128(dcOnly, r[i]));
+
+        // columns: back to raster order, lanes are columns
+        Transpose8x8(r);
+
+        r[0] = _mm_add_epi16(r[0], _mm_set1_epi16(32));
+        IDCT1D<COL_SHIFT>(r, _mm_setzero_si128());
+
+        for (int i = 0; i < 8; ++i)
+            _mm_storeu_si128((__m128i*)(block + 8 * i), r[i]);
+    }
+
+    void PutBlock(const int16_t* block, uint8_t* dst, int32_t pitch)
+    {
+        for (int y = 0; y < 8; ++y, block += 8, dst += pitch)
+        {
+            __m128i const v = _mm_loadu_si128((const __m128i*)block);
+            _mm_storel_epi64((__m128i*)dst, _mm_packus_epi16(v, v));
+        }
+    }
+
+    void AddBlock(const int16_t* block, uint8_t* dst, int32_t pitch)
+    {
+        __m128i const zero = _mm_setzero_si128();
+        for (int y = 0; y < 8; ++y, block += 8, dst += pitch)
+        {
+            __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)dst), zero);
+            v = _mm_adds_epi16(v, _mm_loadu_si128((const __m128i*)block));
+            _mm_storel_epi64((__m128i*)dst, _mm_packus_epi16(v, v));
+        }
+    }
+
+    void PutBlockUV(const int16_t* cb, const int16_t* cr, uint8_t* dst, int32_t pitch)
+    {
+        for (int y = 0; y < 8; ++y, cb += 8, cr += 8, dst += pitch)
+        {
+            __m128i const u = _mm_loadu_si128((const __m128i*)cb);
+            __m128i const v = _mm_loadu_si128((const __m128i*)cr);
+            _mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi8(_mm_packus_epi16(u, u), _mm_packus_epi16(v, v)));
+        }
+    }
+
+    void AddBlockUV(const int16_t* cb, const int16_t* cr, uint8_t* dst, int32_t pitch)
+    {
+        __m128i const zero = _mm_setzero_si128();
+        for (int y = 0; y < 8; ++y, cb += 8, cr += 8, dst += pitch)
+        {
+            __m128i const u = _mm_loadu_si128((const __m128i*)cb);
+            __m128i const v = _mm_loadu_si128((const __m128i*)cr);
+            __m128i const p = _mm_loadu_si128((const __m128i*)dst);
+
+            __m128i const lo = _mm_adds_epi16(_mm_unpacklo_epi8(p, zero), _mm_unpacklo_epi16(u, v));
+            __m128i const hi = _mm_adds_epi16(_mm_unpackhi_epi8(p, zero), _mm_unpackhi_epi16(u, v));
+            _mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(lo, hi));
+        }
+    }
+
+    // (a + b + c + d + 2) >> 2, exact
+    static inline __m128i Average4(__m128i a, __m128i b, __m128i c, __m128i d)
+    {
+        __m128i const zero = _mm_setzero_si128();
+        __m128i const two  = _mm_set1_epi16(2);
+
+        __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                                   _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero)));
+        __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)),
+                                   _mm_add_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero)));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+
+        return _mm_packus_epi16(lo, hi);
+    }
+
+    void Predict16(const uint8_t* src, int32_t srcPitch, uint8_t* dst, int32_t dstPitch,
+                   int32_t h, int32_t dxy, int32_t step, bool average)
+    {
+        for (int32_t y = 0; y < h; ++y, src += srcPitch, dst += dstPitch)
+        {
+            __m128i p = _mm_loadu_si128((const __m128i*)src);
+            switch (dxy)
+            {
+            case 0:
+                break;
+            case 1:
+                p = _mm_avg_epu8(p, _mm_loadu_si128((const __m128i*)(src + step)));
+                break;
+            case 2:
+                p = _mm_avg_epu8(p, _mm_loadu_si128((const __m128i*)(src + srcPitch)));
+                break;
+            default:
+                p = Average4(p, _mm_loadu_si128((const __m128i*)(src + step)),
+                                _mm_loadu_si128((const __m128i*)(src + srcPitch)),
+                                _mm_loadu_si128((const __m128i*)(src + srcPitch + step)));
+                break;
+            }
+
+            if (average)
+                p = _mm_avg_epu8(p, _mm_loadu_si128((const __m128i*)dst));
+
+            _mm_storeu_si128((__m128i*)dst, p);
+        }
+    }
+
+#endif // __SSE2__
+}
+
+#endif // MFX_ENABLE_MPEG2_VIDEO_DECODE && MFX_ENABLE_SW_FALLBACK
@@ -0,0 +1,1194 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "umc_defs.h"
+
+#if defined (MFX_ENABLE_MPEG2_VIDEO_DECODE) && defined (MFX_ENABLE_SW_FALLBACK)
+
+#include <algorithm>
+#include <vector>
+
+#include "mfx_utils.h"
+#include "umc_mpeg2_slice_decoder.h"
+#include "umc_mpeg2_slice.h"
+#include "umc_mpeg2_dsp.h"
+
+namespace UMC_MPEG2_DECODER
+{
+/****************************************************************************************************/
+// Variable length code tables (ISO/IEC 13818-2 Annex B)
+/****************************************************************************************************/
+
+    struct VLCCode
+    {
+        const char* code;  // '0' and '1', spaces are ignored, a trailing 's' is a sign bit negating the value
+        int16_t     value;
+    };
+
+    struct VLCEntry
+    {
+        int16_t value;     // or the offset of the second level table
+        uint8_t length;    // 0 for invalid codes
+        uint8_t subBits;   // index bits of the second level table, 0 for leaves
+    };
+
+    // Two level lookup table, built once from the code lists below
+    class VLCTable
+    {
+    public:
+
+        VLCTable(VLCCode const* codes, size_t count, uint32_t rootBits)
+            : m_maxBits(0)
+            , m_rootBits(0)
+        {
+            struct Code
+            {
+                uint32_t bits;
+                uint32_t length;
+                int16_t  value;
+            };
+
+            std::vector<Code> all;
+            for (size_t i = 0; i < count; ++i)
+            {
+                Code c = { 0, 0, codes[i].value };
+                bool sign = false;
+                for (char const* p = codes[i].code; *p; ++p)
+                {
+                    if (*p == '0' || *p == '1')
+                    {
+                        c.bits = (c.bits << 1) | uint32_t(*p == '1');
+                        ++c.length;
+                    }
+                    else if (*p == 's')
+                        sign = true;
+                }
+
+                if (sign)
+                {
+                    all.push_back({ c.bits << 1,       c.length + 1, c.value });
+                    all.push_back({ (c.bits << 1) | 1, c.length + 1, int16_t(-c.value) });
+                }
+                else
+                    all.push_back(c);
+
+                m_maxBits = std::max(m_maxBits, all.back().length);
+            }
+
+            m_rootBits = std::min(rootBits, m_maxBits);
+            m_entries.assign(size_t(1) << m_rootBits, VLCEntry{ 0, 0, 0 });
+
+            // size the second level tables by their longest code
+            std::vector<uint8_t> subBits(m_entries.size(), 0);
+            for (Code const& c : all)
+            {
+                if (c.length > m_rootBits)
+                {
+                    uint32_t const prefix = c.bits >> (c.length - m_rootBits);
+                    subBits[prefix] = std::max<uint8_t>(subBits[prefix], uint8_t(c.length - m_rootBits));
+                }
+            }
+
+            for (size_t prefix = 0; prefix < subBits.size(); ++prefix)
+            {
+                if (!subBits[prefix])
+                    continue;
+
+                m_entries[prefix] = { int16_t(m_entries.size()), 0, subBits[prefix] };
+                m_entries.resize(m_entries.size() + (size_t(1) << subBits[prefix]), VLCEntry{ 0, 0, 0 });
+            }
+
+            for (Code const& c : all)
+            {
+                size_t first, fill;
+                if (c.length <= m_rootBits)
+                {
+                    first = size_t(c.bits) << (m_rootBits - c.length);
+                    fill  = size_t(1) << (m_rootBits - c.length);
+                }
+                else
+                {
+                    uint32_t const rest   = c.length - m_rootBits;
+                    VLCEntry const& table = m_entries[c.bits >> rest];
+                    first = table.value + (size_t(c.bits & ((1u << rest) - 1)) << (table.subBits - rest));
+                    fill  = size_t(1) << (table.subBits - rest);
+                }
+
+                std::fill(m_entries.begin() + first, m_entries.begin() + first + fill, VLCEntry{ c.value, uint8_t(c.length), 0 });
+            }
+        }
+
+        // Find the entry for the next code without consuming it
+        VLCEntry const& Lookup(MPEG2BaseBitstream& bs) const
+        {
+            uint32_t const bits = bs.ShowBits(m_maxBits);
+            uint32_t const rest = m_maxBits - m_rootBits;
+
+            VLCEntry const* e = &m_entries[bits >> rest];
+            if (e->subBits)
+                e = &m_entries[e->value + ((bits >> (rest - e->subBits)) & ((1u << e->subBits) - 1))];
+
+            if (!e->length)
+                throw mpeg2_exception(UMC::UMC_ERR_INVALID_STREAM);
+
+            return *e;
+        }
+
+        int32_t Decode(MPEG2BaseBitstream& bs) const
+        {
+            VLCEntry const& e = Lookup(bs);
+            bs.GetBits(e.length);
+            return e.value;
+        }
+
+    private:
+
+        uint32_t              m_maxBits;
+        uint32_t              m_rootBits;
+        std::vector<VLCEntry> m_entries;
+    };
+
+    enum
+    {
+        MBA_ESCAPE   = -1,
+        MBA_STUFFING = -2,
+
+        DCT_EOB      = -1,
+        DCT_ESCAPE   = -2,
+    };
+
+#define DCT_VALUE(run, level) int16_t(((level) << 8) | (run))
+
+    // Table B-1
+    static const VLCCode MBAddressIncrementCodes[] =
+    {
+        { "1",             1 }, { "011",           2 }, { "010",           3 }, { "0011",          4 },
+        { "0010",          5 }, { "0001 1",        6 }, { "0001 0",        7 }, { "0000 111",      8 },
+        { "0000 110",      9 }, { "0000 1011",    10 }, { "0000 1010",    11 }, { "0000 1001",    12 },
+        { "0000 1000",    13 }, { "0000 0111",    14 }, { "0000 0110",    15 }, { "0000 0101 11", 16 },
+        { "0000 0101 10", 17 }, { "0000 0101 01", 18 }, { "0000 0101 00", 19 }, { "0000 0100 11", 20 },
+        { "0000 0100 10", 21 }, { "0000 0100 011", 22 }, { "0000 0100 010", 23 }, { "0000 0100 001", 24 },
+        { "0000 0100 000", 25 }, { "0000 0011 111", 26 }, { "0000 0011 110", 27 }, { "0000 0011 101", 28 },
+        { "0000 0011 100", 29 }, { "0000 0011 011", 30 }, { "0000 0011 010", 31 }, { "0000 0011 001", 32 },
+        { "0000 0011 000", 33 },
+        { "0000 0001 000", MBA_ESCAPE },
+        { "0000 0001 111", MBA_STUFFING }, // MPEG-1 only, skipped
+    };
+
+    // Tables B-2, B-3, B-4: quant, motion forward, motion backward, pattern, intra
+    static const VLCCode MBTypeICodes[] =
+    {
+        { "1",       16 },
+        { "01",      17 },
+    };
+
+    static const VLCCode MBTypePCodes[] =
+    {
+        { "1",       10 },
+        { "01",       8 },
+        { "001",      2 },
+        { "0001 1",  16 },
+        { "0001 0",  11 },
+        { "0000 1",   9 },
+        { "0000 01", 17 },
+    };
+
+    static const VLCCode MBTypeBCodes[] =
+    {
+        { "10",       6 },
+        { "11",      14 },
+        { "010",      4 },
+        { "011",     12 },
+        { "0010",     2 },
+        { "0011",    10 },
+        { "0001 1",  16 },
+        { "0001 0",  15 },
+        { "0000 11", 11 },
+        { "0000 10", 13 },
+        { "0000 01", 17 },
+    };
+
+    // Table B-9
+    static const VLCCode CodedBlockPatternCodes[] =
+    {
+        { "111",         60 }, { "1101",         4 }, { "1100",         8 }, { "1011",        16 },
+        { "1010",        32 }, { "1001 1",      12 }, { "1001 0",      48 }, { "1000 1",      20 },
+        { "1000 0",      40 }, { "0111 1",      28 }, { "0111 0",      44 }, { "0110 1",      52 },
+        { "0110 0",      56 }, { "0101 1",       1 }, { "0101 0",      61 }, { "0100 1",       2 },
+        { "0100 0",      62 }, { "0011 11",     24 }, { "0011 10",     36 }, { "0011 01",      3 },
+        { "0011 00",     63 }, { "0010 111",     5 }, { "0010 110",     9 }, { "0010 101",    17 },
+        { "0010 100",    33 }, { "0010 011",     6 }, { "0010 010",    10 }, { "0010 001",    18 },
+        { "0010 000",    34 }, { "0001 1111",    7 }, { "0001 1110",   11 }, { "0001 1101",   19 },
+        { "0001 1100",   35 }, { "0001 1011",   13 }, { "0001 1010",   49 }, { "0001 1001",   21 },
+        { "0001 1000",   41 }, { "0001 0111",   14 }, { "0001 0110",   50 }, { "0001 0101",   22 },
+        { "0001 0100",   42 }, { "0001 0011",   15 }, { "0001 0010",   51 }, { "0001 0001",   23 },
+        { "0001 0000",   43 }, { "0000 1111",   25 }, { "0000 1110",   37 }, { "0000 1101",   26 },
+        { "0000 1100",   38 }, { "0000 1011",   29 }, { "0000 1010",   45 }, { "0000 1001",   53 },
+        { "0000 1000",   57 }, { "0000 0111",   30 }, { "0000 0110",   46 }, { "0000 0101",   54 },
+        { "0000 0100",   58 }, { "0000 0011 1", 31 }, { "0000 0011 0", 47 }, { "0000 0010 1", 55 },
+        { "0000 0010 0", 59 }, { "0000 0001 1", 27 }, { "0000 0001 0", 39 }, { "0000 0000 1",  0 },
+    };
+
+    // Table B-10
+    static const VLCCode MotionCodes[] =
+    {
+        { "1",               0 },
+        { "01s",             1 },
+        { "001s",            2 },
+        { "0001s",           3 },
+        { "0000 11s",        4 },
+        { "0000 101s",       5 },
+        { "0000 100s",       6 },
+        { "0000 011s",       7 },
+        { "0000 0101 1s",    8 },
+        { "0000 0101 0s",    9 },
+        { "0000 0100 1s",   10 },
+        { "0000 0100 01s",  11 },
+        { "0000 0100 00s",  12 },
+        { "0000 0011 11s",  13 },
+        { "0000 0011 10s",  14 },
+        { "0000 0011 01s",  15 },
+        { "0000 0011 00s",  16 },
+    };
+
+    // Table B-11
+    static const VLCCode DMVectorCodes[] =
+    {
+        { "0",   0 },
+        { "10",  1 },
+        { "11", -1 },
+    };
+
+    // Table B-12
+    static const VLCCode DCSizeLumaCodes[] =
+    {
+        { "100",          0 },
+        { "00",           1 },
+        { "01",           2 },
+        { "101",          3 },
+        { "110",          4 },
+        { "1110",         5 },
+        { "1111 0",       6 },
+        { "1111 10",      7 },
+        { "1111 110",     8 },
+        { "1111 1110",    9 },
+        { "1111 1111 0", 10 },
+        { "1111 1111 1", 11 },
+    };
+
+    // Table B-13
+    static const VLCCode DCSizeChromaCodes[] =
+    {
+        { "00",            0 },
+        { "01",            1 },
+        { "10",            2 },
+        { "110",           3 },
+        { "1110",          4 },
+        { "1111 0",        5 },
+        { "1111 10",       6 },
+        { "1111 110",      7 },
+        { "1111 1110",     8 },
+        { "1111 1111 0",   9 },
+        { "1111 1111 10", 10 },
+        { "1111 1111 11", 11 },
+    };
+
+    // Table B-14 without the sign bit, the special first coefficient code
+    // of non intra blocks is handled by the caller
+    static const VLCCode DCTCodesB14[] =
+    {
+        { "11",                  DCT_VALUE( 0,  1) },
+        { "10",                  DCT_EOB },
+        { "011",                 DCT_VALUE( 1,  1) },
+        { "0101",                DCT_VALUE( 2,  1) },
+        { "0100",                DCT_VALUE( 0,  2) },
+        { "0011 1",              DCT_VALUE( 3,  1) },
+        { "0011 0",              DCT_VALUE( 4,  1) },
+        { "0010 1",              DCT_VALUE( 0,  3) },
+        { "0001 11",             DCT_VALUE( 5,  1) },
+        { "0001 10",             DCT_VALUE( 1,  2) },
+        { "0001 01",             DCT_VALUE( 6,  1) },
+        { "0001 00",             DCT_VALUE( 7,  1) },
+        { "0000 01",             DCT_ESCAPE },
+        { "0000 111",            DCT_VALUE( 8,  1) },
+        { "0000 110",            DCT_VALUE( 0,  4) },
+        { "0000 101",            DCT_VALUE( 9,  1) },
+        { "0000 100",            DCT_VALUE( 2,  2) },
+        { "0010 0111",           DCT_VALUE(10,  1) },
+        { "0010 0110",           DCT_VALUE( 0,  5) },
+        { "0010 0101",           DCT_VALUE( 1,  3) },
+        { "0010 0100",           DCT_VALUE( 3,  2) },
+        { "0010 0011",           DCT_VALUE(11,  1) },
+        { "0010 0010",           DCT_VALUE(12,  1) },
+        { "0010 0001",           DCT_VALUE( 0,  6) },
+        { "0010 0000",           DCT_VALUE(13,  1) },
+        { "0000 0011 11",        DCT_VALUE( 4,  2) },
+        { "0000 0011 10",        DCT_VALUE(14,  1) },
+        { "0000 0011 01",        DCT_VALUE(15,  1) },
+        { "0000 0011 00",        DCT_VALUE( 1,  4) },
+        { "0000 0010 11",        DCT_VALUE( 2,  3) },
+        { "0000 0010 10",        DCT_VALUE( 0,  7) },
+        { "0000 0010 01",        DCT_VALUE( 5,  2) },
+        { "0000 0010 00",        DCT_VALUE(16,  1) },
+        { "0000 0001 1111",      DCT_VALUE(17,  1) },
+        { "0000 0001 1110",      DCT_VALUE( 6,  2) },
+        { "0000 0001 1101",      DCT_VALUE( 0,  8) },
+        { "0000 0001 1100",      DCT_VALUE( 3,  3) },
+        { "0000 0001 1011",      DCT_VALUE( 1,  5) },
+        { "0000 0001 1010",      DCT_VALUE(18,  1) },
+        { "0000 0001 1001",      DCT_VALUE(19,  1) },
+        { "0000 0001 1000",      DCT_VALUE( 0,  9) },
+        { "0000 0001 0111",      DCT_VALUE(20,  1) },
+        { "0000 0001 0110",      DCT_VALUE(21,  1) },
+        { "0000 0001 0101",      DCT_VALUE( 7,  2) },
+        { "0000 0001 0100",      DCT_VALUE( 2,  4) },
+        { "0000 0001 0011",      DCT_VALUE( 0, 10) },
+        { "0000 0001 0010",      DCT_VALUE( 4,  3) },
+        { "0000 0001 0001",      DCT_VALUE( 8,  2) },
+        { "0000 0001 0000",      DCT_VALUE( 0, 11) },
+        { "0000 0000 1111 1",    DCT_VALUE(22,  1) },
+        { "0000 0000 1111 0",    DCT_VALUE(23,  1) },
+        { "0000 0000 1110 1",    DCT_VALUE(24,  1) },
+        { "0000 0000 1110 0",    DCT_VALUE(25,  1) },
+        { "0000 0000 1101 1",    DCT_VALUE(26,  1) },
+        { "0000 0000 1101 0",    DCT_VALUE( 0, 12) },
+        { "0000 0000 1100 1",    DCT_VALUE( 0, 13) },
+        { "0000 0000 1100 0",    DCT_VALUE( 0, 14) },
+        { "0000 0000 1011 1",    DCT_VALUE( 0, 15) },
+        { "0000 0000 1011 0",    DCT_VALUE( 1,  6) },
+        { "0000 0000 1010 1",    DCT_VALUE( 1,  7) },
+        { "0000 0000 1010 0",    DCT_VALUE( 2,  5) },
+        { "0000 0000 1001 1",    DCT_VALUE( 3,  4) },
+        { "0000 0000 1001 0",    DCT_VALUE( 5,  3) },
+        { "0000 0000 1000 1",    DCT_VALUE( 9,  2) },
+        { "0000 0000 1000 0",    DCT_VALUE(10,  2) },
+        { "0000 0000 0111 11",   DCT_VALUE( 0, 16) },
+        { "0000 0000 0111 10",   DCT_VALUE( 0, 17) },
+        { "0000 0000 0111 01",   DCT_VALUE( 0, 18) },
+        { "0000 0000 0111 00",   DCT_VALUE( 0, 19) },
+        { "0000 0000 0110 11",   DCT_VALUE( 0, 20) },
+        { "0000 0000 0110 10",   DCT_VALUE( 0, 21) },
+        { "0000 0000 0110 01",   DCT_VALUE( 0, 22) },
+        { "0000 0000 0110 00",   DCT_VALUE( 0, 23) },
+        { "0000 0000 0101 11",   DCT_VALUE( 0, 24) },
+        { "0000 0000 0101 10",   DCT_VALUE( 0, 25) },
+        { "0000 0000 0101 01",   DCT_VALUE( 0, 26) },
+        { "0000 0000 0101 00",   DCT_VALUE( 0, 27) },
+        { "0000 0000 0100 11",   DCT_VALUE( 0, 28) },
+        { "0000 0000 0100 10",   DCT_VALUE( 0, 29) },
+        { "0000 0000 0100 01",   DCT_VALUE( 0, 30) },
+        { "0000 0000 0100 00",   DCT_VALUE( 0, 31) },
+        { "0000 0000 0011 111",  DCT_VALUE( 1,  8) },
+        { "0000 0000 0011 110",  DCT_VALUE( 1,  9) },
+        { "0000 0000 0011 101",  DCT_VALUE( 1, 10) },
+        { "0000 0000 0011 100",  DCT_VALUE( 1, 11) },
+        { "0000 0000 0011 011",  DCT_VALUE( 1, 12) },
+        { "0000 0000 0011 010",  DCT_VALUE( 1, 13) },
+        { "0000 0000 0011 001",  DCT_VALUE( 1, 14) },
+        { "0000 0000 0011 000",  DCT_VALUE( 0, 32) },
+        { "0000 0000 0010 111",  DCT_VALUE( 0, 33) },
+        { "0000 0000 0010 110",  DCT_VALUE( 0, 34) },
+        { "0000 0000 0010 101",  DCT_VALUE( 0, 35) },
+        { "0000 0000 0010 100",  DCT_VALUE( 0, 36) },
+        { "0000 0000 0010 011",  DCT_VALUE( 0, 37) },
+        { "0000 0000 0010 010",  DCT_VALUE( 0, 38) },
+        { "0000 0000 0010 001",  DCT_VALUE( 0, 39) },
+        { "0000 0000 0010 000",  DCT_VALUE( 0, 40) },
+        { "0000 0000 0001 1111", DCT_VALUE(27,  1) },
+        { "0000 0000 0001 1110", DCT_VALUE(28,  1) },
+        { "0000 0000 0001 1101", DCT_VALUE(29,  1) },
+        { "0000 0000 0001 1100", DCT_VALUE(30,  1) },
+        { "0000 0000 0001 1011", DCT_VALUE(31,  1) },
+        { "0000 0000 0001 1010", DCT_VALUE(11,  2) },
+        { "0000 0000 0001 1001", DCT_VALUE(12,  2) },
+        { "0000 0000 0001 1000", DCT_VALUE(13,  2) },
+        { "0000 0000 0001 0111", DCT_VALUE(14,  2) },
+        { "0000 0000 0001 0110", DCT_VALUE(15,  2) },
+        { "0000 0000 0001 0101", DCT_VALUE(16,  2) },
+        { "0000 0000 0001 0100", DCT_VALUE( 6,  3) },
+        { "0000 0000 0001 0011", DCT_VALUE( 1, 15) },
+        { "0000 0000 0001 0010", DCT_VALUE( 1, 16) },
+        { "0000 0000 0001 0001", DCT_VALUE( 1, 17) },
+        { "0000 0000 0001 0000", DCT_VALUE( 1, 18) },
+    };
+
+    // Table B-15 without the sign bit
+    static const VLCCode DCTCodesB15[] =
+    {
+        { "10",                  DCT_VALUE( 0,  1) },
+        { "110",                 DCT_VALUE( 0,  2) },
+        { "010",                 DCT_VALUE( 1,  1) },
+        { "0111",                DCT_VALUE( 0,  3) },
+        { "0110",                DCT_EOB },
+        { "1110 1",              DCT_VALUE( 0,  5) },
+        { "1110 0",              DCT_VALUE( 0,  4) },
+        { "0011 1",              DCT_VALUE( 3,  1) },
+        { "0011 0",              DCT_VALUE( 1,  2) },
+        { "0010 1",              DCT_VALUE( 2,  1) },
+        { "0001 11",             DCT_VALUE( 5,  1) },
+        { "0001 10",             DCT_VALUE( 4,  1) },
+        { "0001 01",             DCT_VALUE( 0,  6) },
+        { "0001 00",             DCT_VALUE( 0,  7) },
+        { "0000 01",             DCT_ESCAPE },
+        { "1111 100",            DCT_VALUE( 0,  9) },
+        { "1111 011",            DCT_VALUE( 0,  8) },
+        { "1111 010",            DCT_VALUE(10,  1) },
+        { "1111 001",            DCT_VALUE( 1,  3) },
+        { "1111 000",            DCT_VALUE( 9,  1) },
+        { "0000 111",            DCT_VALUE( 2,  2) },
+        { "0000 110",            DCT_VALUE( 6,  1) },
+        { "0000 101",            DCT_VALUE( 8,  1) },
+        { "0000 100",            DCT_VALUE( 7,  1) },
+        { "1111 1111",           DCT_VALUE( 0, 15) },
+        { "1111 1110",           DCT_VALUE( 0, 14) },
+        { "1111 1101",           DCT_VALUE( 4,  2) },
+        { "1111 1100",           DCT_VALUE( 2,  3) },
+        { "1111 1011",           DCT_VALUE( 0, 13) },
+        { "1111 1010",           DCT_VALUE( 0, 12) },
+        { "0010 0111",           DCT_VALUE( 1,  4) },
+        { "0010 0110",           DCT_VALUE( 3,  2) },
+        { "0010 0101",           DCT_VALUE(12,  1) },
+        { "0010 0100",           DCT_VALUE(13,  1) },
+        { "0010 0011",           DCT_VALUE( 0, 10) },
+        { "0010 0010",           DCT_VALUE( 0, 11) },
+        { "0010 0001",           DCT_VALUE(11,  1) },
+        { "0010 0000",           DCT_VALUE( 1,  5) },
+        { "0000 0011 1",         DCT_VALUE(15,  1) },
+        { "0000 0010 1",         DCT_VALUE(14,  1) },
+        { "0000 0010 0",         DCT_VALUE( 5,  2) },
+        { "0000 0011 01",        DCT_VALUE(16,  1) },
+        { "0000 0011 00",        DCT_VALUE( 2,  4) },
+        { "0000 0001 1111",      DCT_VALUE(17,  1) },
+        { "0000 0001 1110",      DCT_VALUE( 6,  2) },
+        { "0000 0001 1100",      DCT_VALUE( 3,  3) },
+        { "0000 0001 1010",      DCT_VALUE(18,  1) },
+        { "0000 0001 1001",      DCT_VALUE(19,  1) },
+        { "0000 0001 0111",      DCT_VALUE(20,  1) },
+        { "0000 0001 0110",      DCT_VALUE(21,  1) },
+        { "0000 0001 0101",      DCT_VALUE( 7,  2) },
+        { "0000 0001 0010",      DCT_VALUE( 4,  3) },
+        { "0000 0001 0001",      DCT_VALUE( 8,  2) },
+        { "0000 0000 1111 1",    DCT_VALUE(22,  1) },
+        { "0000 0000 1111 0",    DCT_VALUE(23,  1) },
+        { "0000 0000 1110 1",    DCT_VALUE(24,  1) },
+        { "0000 0000 1110 0",    DCT_VALUE(25,  1) },
+        { "0000 0000 1101 1",    DCT_VALUE(26,  1) },
+        { "0000 0000 1011 0",    DCT_VALUE( 1,  6) },
+        { "0000 0000 1010 1",    DCT_VALUE( 1,  7) },
+        { "0000 0000 1010 0",    DCT_VALUE( 2,  5) },
+        { "0000 0000 1001 1",    DCT_VALUE( 3,  4) },
+        { "0000 0000 1001 0",    DCT_VALUE( 5,  3) },
+        { "0000 0000 1000 1",    DCT_VALUE( 9,  2) },
+        { "0000 0000 1000 0",    DCT_VALUE(10,  2) },
+        { "0000 0000 0111 11",   DCT_VALUE( 0, 16) },
+        { "0000 0000 0111 10",   DCT_VALUE( 0, 17) },
+        { "0000 0000 0111 01",   DCT_VALUE( 0, 18) },
+        { "0000 0000 0111 00",   DCT_VALUE( 0, 19) },
+        { "0000 0000 0110 11",   DCT_VALUE( 0, 20) },
+        { "0000 0000 0110 10",   DCT_VALUE( 0, 21) },
+        { "0000 0000 0110 01",   DCT_VALUE( 0, 22) },
+        { "0000 0000 0110 00",   DCT_VALUE( 0, 23) },
+        { "0000 0000 0101 11",   DCT_VALUE( 0, 24) },
+        { "0000 0000 0101 10",   DCT_VALUE( 0, 25) },
+        { "0000 0000 0101 01",   DCT_VALUE( 0, 26) },
+        { "0000 0000 0101 00",   DCT_VALUE( 0, 27) },
+        { "0000 0000 0100 11",   DCT_VALUE( 0, 28) },
+        { "0000 0000 0100 10",   DCT_VALUE( 0, 29) },
+        { "0000 0000 0100 01",   DCT_VALUE( 0, 30) },
+        { "0000 0000 0100 00",   DCT_VALUE( 0, 31) },
+        { "0000 0000 0011 111",  DCT_VALUE( 1,  8) },
+        { "0000 0000 0011 110",  DCT_VALUE( 1,  9) },
+        { "0000 0000 0011 101",  DCT_VALUE( 1, 10) },
+        { "0000 0000 0011 100",  DCT_VALUE( 1, 11) },
+        { "0000 0000 0011 011",  DCT_VALUE( 1, 12) },
+        { "0000 0000 0011 010",  DCT_VALUE( 1, 13) },
+        { "0000 0000 0011 001",  DCT_VALUE( 1, 14) },
+        { "0000 0000 0011 000",  DCT_VALUE( 0, 32) },
+        { "0000 0000 0010 111",  DCT_VALUE( 0, 33) },
+        { "0000 0000 0010 110",  DCT_VALUE( 0, 34) },
+        { "0000 0000 0010 101",  DCT_VALUE( 0, 35) },
+        { "0000 0000 0010 100",  DCT_VALUE( 0, 36) },
+        { "0000 0000 0010 011",  DCT_VALUE( 0, 37) },
+        { "0000 0000 0010 010",  DCT_VALUE( 0, 38) },
+        { "0000 0000 0010 001",  DCT_VALUE( 0, 39) },
+        { "0000 0000 0010 000",  DCT_VALUE( 0, 40) },
+        { "0000 0000 0001 1111", DCT_VALUE(27,  1) },
+        { "0000 0000 0001 1110", DCT_VALUE(28,  1) },
+        { "0000 0000 0001 1101", DCT_VALUE(29,  1) },
+        { "0000 0000 0001 1100", DCT_VALUE(30,  1) },
+        { "0000 0000 0001 1011", DCT_VALUE(31,  1) },
+        { "0000 0000 0001 1010", DCT_VALUE(11,  2) },
+        { "0000 0000 0001 1001", DCT_VALUE(12,  2) },
+        { "0000 0000 0001 1000", DCT_VALUE(13,  2) },
+        { "0000 0000 0001 0111", DCT_VALUE(14,  2) },
+        { "0000 0000 0001 0110", DCT_VALUE(15,  2) },
+        { "0000 0000 0001 0101", DCT_VALUE(16,  2) },
+        { "0000 0000 0001 0100", DCT_VALUE( 6,  3) },
+        { "0000 0000 0001 0011", DCT_VALUE( 1, 15) },
+        { "0000 0000 0001 0010", DCT_VALUE( 1, 16) },
+        { "0000 0000 0001 0001", DCT_VALUE( 1, 17) },
+        { "0000 0000 0001 0000", DCT_VALUE( 1, 18) },
+    };
+
+#undef DCT_VALUE
+
+#define MPEG2_VLC_TABLE(codes, rootBits) VLCTable(codes, sizeof(codes) / sizeof(codes[0]), rootBits)
+
+    struct VLCTables
+    {
+        VLCTable mbAddressIncrement = MPEG2_VLC_TABLE(MBAddressIncrementCodes, 11);
+        VLCTable mbTypeI            = MPEG2_VLC_TABLE(MBTypeICodes, 2);
+        VLCTable mbTypeP            = MPEG2_VLC_TABLE(MBTypePCodes, 6);
+        VLCTable mbTypeB            = MPEG2_VLC_TABLE(MBTypeBCodes, 6);
+        VLCTable codedBlockPattern  = MPEG2_VLC_TABLE(CodedBlockPatternCodes, 9);
+        VLCTable motionCode         = MPEG2_VLC_TABLE(MotionCodes, 11);
+        VLCTable dmvector           = MPEG2_VLC_TABLE(DMVectorCodes, 2);
+        VLCTable dcSizeLuma         = MPEG2_VLC_TABLE(DCSizeLumaCodes, 9);
+        VLCTable dcSizeChroma       = MPEG2_VLC_TABLE(DCSizeChromaCodes, 10);
+        VLCTable dctB14             = MPEG2_VLC_TABLE(DCTCodesB14, 10);
+        VLCTable dctB15             = MPEG2_VLC_TABLE(DCTCodesB15, 10);
+    };
+
+#undef MPEG2_VLC_TABLE
+
+    static VLCTables const& GetTables()
+    {
+        static VLCTables const tables;
+        return tables;
+    }
+
+/****************************************************************************************************/
+// Scans and quantisation
+/****************************************************************************************************/
+
+    static const uint8_t ZigzagScan[64] =
+    {
+         0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+        12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+        35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+        58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+    };
+
+    static const uint8_t AlternateScan[64] =
+    {
+         0,  8, 16, 24,  1,  9,  2, 10, 17, 25, 32, 40, 48, 56, 57, 49,
+        41, 33, 26, 18,  3, 11,  4, 12, 19, 27, 34, 42, 50, 58, 35, 43,
+        51, 59, 20, 28,  5, 13,  6, 14, 21, 29, 36, 44, 52, 60, 37, 45,
+        53, 61, 22, 30,  7, 15, 23, 31, 38, 46, 54, 62, 39, 47, 55, 63
+    };
+
+    // Table 7-6, q_scale_type = 1
+    static const uint8_t NonLinearQuantiserScale[32] =
+    {
+         0,  1,  2,  3,  4,  5,  6,  7,  8, 10, 12, 14, 16, 18, 20, 22,
+        24, 28, 32, 36, 40, 44, 48, 52, 56, 64, 72, 80, 88, 96, 104, 112
+    };
+
+    void ZigzagToRaster(uint8_t const* zigzag, uint8_t* raster)
+    {
+        for (int i = 0; i < 64; ++i)
+            raster[ZigzagScan[i]] = zigzag[i];
+    }
+
+    inline int32_t Saturate2048(int32_t v)
+    {
+        return v < -2048 ? -2048 : (v > 2047 ? 2047 : v);
+    }
+
+/****************************************************************************************************/
+// MPEG2SliceDecoder
+/****************************************************************************************************/
+
+    MPEG2SliceDecoder::MPEG2SliceDecoder(MPEG2PictureContext const& ctx)
+        : m_ctx(ctx)
+        , m_fieldPicture(ctx.pictureStructure != FRM_PICTURE)
+        , m_parity(ctx.pictureStructure == BOTTOM_FLD_PICTURE ? 1 : 0)
+        , m_quantiserScale(0)
+        , m_dcPred()
+        , m_pmv()
+        , m_motionValid(false)
+    {
+        std::fill(&m_blocks[0][0], &m_blocks[0][0] + 6 * 64, int16_t(0));
+    }
+
+    void MPEG2SliceDecoder::ResetDcPredictors()
+    {
+        m_dcPred[0] = m_dcPred[1] = m_dcPred[2] = 1 << (m_ctx.intraDcPrecision + 7);
+    }
+
+    void MPEG2SliceDecoder::SetQuantiserScale(uint32_t code)
+    {
+        if (!code)
+            throw mpeg2_exception(UMC::UMC_ERR_INVALID_STREAM);
+
+        m_quantiserScale = m_ctx.qScaleType ? NonLinearQuantiserScale[code] : int32_t(code) * 2;
+    }
+
+    bool MPEG2SliceDecoder::DecodeSlice(MPEG2Slice const& slice)
+    {
+        MPEG2SliceHeader const& header = slice.GetSliceHeader();
+
+        int32_t const row = (m_ctx.verticalPositionExt ? (header.slice_vertical_position_extension << 7) : 0)
+                          + header.slice_vertical_position - 1;
+        if (row < 0 || row >= m_ctx.mbHeight || int32_t(header.macroblockAddressIncrement) >= m_ctx.mbWidth)
+            return false;
+
+        int32_t address = row * m_ctx.mbWidth + header.macroblockAddressIncrement;
+
+        // macroblocks from here on belong to this slice, a slice does not leave its row
+        int32_t const end = std::min<int32_t>(address + header.numberMBsInSlice, (row + 1) * m_ctx.mbWidth);
+
+        uint8_t* data;
+        uint32_t size;
+        slice.GetBitStream().GetOrg(data, size);
+
+        try
+        {
+            m_bs.Reset(data, header.mbOffset, size);
+
+            SetQuantiserScale(header.quantiser_scale_code);
+            ResetDcPredictors();
+            std::fill(&m_pmv[0][0][0], &m_pmv[0][0][0] + 8, 0);
+            m_motionValid = false;
+
+            bool first = true;
+            for (;;)
+            {
+                VLCTables const& tables = GetTables();
+
+                int32_t increment = 0;
+                for (;;)
+                {
+                    int32_t const code = tables.mbAddressIncrement.Decode(m_bs);
+                    if (code == MBA_ESCAPE)
+                        increment += 33;
+                    else if (code != MBA_STUFFING)
+                    {
+                        increment += code;
+                        break;
+                    }
+                }
+
+                if (!first)
+                {
+                    // skipped macroblocks
+                    for (int32_t i = 1; i < increment; ++i)
+                    {
+                        if (++address >= end)
+                            throw mpeg2_exception(UMC::UMC_ERR_INVALID_STREAM);
+
+                        SkipMacroblock(address);
+                    }
+
+                    ++address;
+                }
+
+                if (address >= end)
+                    throw mpeg2_exception(UMC::UMC_ERR_INVALID_STREAM);
+
+                DecodeMacroblock(address);
+                first = false;
+
+                // 23 zero bits: next start code or the end of data
+                if (!m_bs.ShowBits(23))
+                    break;
+            }
+        }
+        catch (mpeg2_exception const&)
+        {
+            Conceal(address, end);
+            return false;
+        }
+
+        return true;
+    }
+
+    void MPEG2SliceDecoder::DecodeMacroblock(int32_t address)
+    {
+        VLCTables const& tables = GetTables();
+
+        int32_t const mbx = address % m_ctx.mbWidth;
+        int32_t const mby = address / m_ctx.mbWidth;
+
+        VLCTable const& typeTable = m_ctx.pictureCodingType == MPEG2_I_PICTURE ? tables.mbTypeI :
+                                   (m_ctx.pictureCodingType == MPEG2_P_PICTURE ? tables.mbTypeP : tables.mbTypeB);
+        int32_t const type = typeTable.Decode(m_bs);
+
+        Motion motion;
+        motion.directions = uint8_t(type & (MB_MOTION_FORWARD | MB_MOTION_BACKWARD));
+        motion.type       = m_fieldPicture ? MC_FIELD : MC_FRAME;
+
+        if (motion.directions && (m_fieldPicture || !m_ctx.framePredFrameDct))
+        {
+            motion.type = uint8_t(m_bs.GetBits(2));
+            if (!motion.type)
+                throw mpeg2_exception(UMC::UMC_ERR_INVALID_STREAM);
+        }
+
+        bool const fieldDct = !m_fieldPicture && !m_ctx.framePredFrameDct && (type & (MB_INTRA | MB_PATTERN)) && m_bs.GetBits(1);
+
+        if (type & MB_QUANT)
+            SetQuantiserScale(m_bs.GetBits(5));
+
+        uint8_t* const y  = m_ctx.cur.y  + (m_fieldPicture ? m_parity * m_ctx.cur.pitch : 0);
+        uint8_t* const uv = m_ctx.cur.uv + (m_fieldPicture ? m_parity * m_ctx.cur.pitch : 0);
+        int32_t const pitch = m_fieldPicture ? 2 * m_ctx.cur.pitch : m_ctx.cur.pitch;
+
+        uint8_t* const dstY  = y  + mby * 16 * pitch + mbx * 16;
+        uint8_t* const dstUV = uv + mby * 8  * pitch + mbx * 16;
+
+        // luma blocks of field DCT macroblocks interleave line by line
+        int32_t const blockPitch = fieldDct ? 2 * pitch : pitch;
+        int32_t const blockRow   = fieldDct ? pitch : 8 * pitch;
+
+        if (type & MB_INTRA)
+        {
+            if (m_ctx.concealmentMotionVectors)
+            {
+                Motion concealment;
+                concealment.type = m_fieldPicture ? MC_FIELD : MC_FRAME;
+                DecodeMotionVectors(concealment, 0);
+                m_bs.GetBits(1); // marker_bit
+            }
+            else
+                std::fill(&m_pmv[0][0][0], &m_pmv[0][0][0] + 8, 0);
+
+            m_motionValid = false;
+
+            for (int32_t i = 0; i < 6; ++i)
+                DecodeIntraBlock(m_blocks[i], i < 4 ? 0 : i - 3);
+
+            for (int32_t i = 0; i < 6; ++i)
+                IDCT8x8(m_blocks[i]);
+
+            for (int32_t i = 0; i < 4; ++i)
+                PutBlock(m_blocks[i], dstY + (i >> 1) * blockRow + (i & 1) * 8, blockPitch);
+            PutBlockUV(m_blocks[4], m_blocks[5], dstUV, pitch);
+
+            std::fill(&m_blocks[0][0], &m_blocks[0][0] + 6 * 64, int16_t(0));
+            return;
+        }
+
+        ResetDcPredictors();
+
+        if (m_ctx.pictureCodingType == MPEG2_P_PICTURE && !(type & MB_MOTION_FORWARD))
+        {
+            // no motion compensation: zero vector from the same parity
+            std::fill(&m_pmv[0][0][0], &m_pmv[0][0][0] + 8, 0);
+            motion.directions = MB_MOTION_FORWARD;
+            motion.fieldSelect[0][0] = uint8_t(m_parity);
+        }
+        else
+        {
+            if (motion.directions & MB_MOTION_FORWARD)
+                DecodeMotionVectors(motion, 0);
+            if (motion.directions & MB_MOTION_BACKWARD)
+                DecodeMotionVectors(motion, 1);
+        }
+
+        uint32_t const cbp = (type & MB_PATTERN) ? uint32_t(tables.codedBlockPattern.Decode(m_bs)) : 0;
+
+        for (int32_t i = 0; i < 6; ++i)
+            if (cbp & (32 >> i))
+                DecodeNonIntraBlock(m_blocks[i]);
+
+        PredictMacroblock(motion, mbx, mby);
+        m_motion      = motion;
+        m_motionValid = true;
+
+        if (!cbp)
+            return;
+
+        for (int32_t i = 0; i < 4; ++i)
+        {
+            if (cbp & (32 >> i))
+            {
+                IDCT8x8(m_blocks[i]);
+                AddBlock(m_blocks[i], dstY + (i >> 1) * blockRow + (i & 1) * 8, blockPitch);
+            }
+        }
+
+        if (cbp & 3)
+        {
+            // an uncoded chroma block stays zero and adds nothing
+            if (cbp & 2)
+                IDCT8x8(m_blocks[4]);
+            if (cbp & 1)
+                IDCT8x8(m_blocks[5]);
+            AddBlockUV(m_blocks[4], m_blocks[5], dstUV, pitch);
+        }
+
+        std::fill(&m_blocks[0][0], &m_blocks[0][0] + 6 * 64, int16_t(0));
+    }
+
+    void MPEG2SliceDecoder::DecodeMotionVectors(Motion& motion, int32_t s)
+    {
+        VLCTables const& tables = GetTables();
+
+        bool const dualPrime = motion.type == MC_DMV;
+
+        // frame pictures with field vectors keep the vertical predictors in frame units
+        bool const fieldVectorsInFrame = !m_fieldPicture && motion.type != MC_FRAME;
+
+        int32_t const count = (m_fieldPicture ? motion.type == MC_16X8 : motion.type == MC_FIELD) ? 2 : 1;
+
+        for (int32_t r = 0; r < count; ++r)
+        {
+            if (m_fieldPicture ? !dualPrime : count == 2)
+                motion.fieldSelect[r][s] = uint8_t(m_bs.GetBits(1));
+
+            int32_t const h = DecodeMotionComponent(m_pmv[r][s][0], m_ctx.fCode[s][0]);
+            if (dualPrime)
+                motion.dmv[0] = int16_t(tables.dmvector.Decode(m_bs));
+
+            int32_t const v = DecodeMotionComponent(fieldVectorsInFrame ? m_pmv[r][s][1] >> 1 : m_pmv[r][s][1], m_ctx.fCode[s][1]);
+            if (dualPrime)
+                motion.dmv[1] = int16_t(tables.dmvector.Decode(m_bs));
+
+            motion.mv[r][s][0] = int16_t(h);
+            motion.mv[r][s][1] = int16_t(v);
+
+            m_pmv[r][s][0] = h;
+            m_pmv[r][s][1] = fieldVectorsInFrame ? v * 2 : v;
+        }
+
+        if (count == 1)
+        {
+            m_pmv[1][s][0] = m_pmv[0][s][0];
+            m_pmv[1][s][1] = m_pmv[0][s][1];
+        }
+    }
+
+    int32_t MPEG2SliceDecoder::DecodeMotionComponent(int32_t pred, int32_t fcode)
+    {
+        int32_t const code = GetTables().motionCode.Decode(m_bs);
+        if (!code)
+            return pred;
+
+        if (fcode < 1 || fcode > 9)
+            throw mpeg2_exception(UMC::UMC_ERR_INVALID_STREAM);
+
+        int32_t const rsize = fcode - 1;
+
+        int32_t delta = code;
+        if (rsize)
+        {
+            delta = ((std::abs(code) - 1) << rsize) + int32_t(m_bs.GetBits(rsize)) + 1;
+            if (code < 0)
+                delta = -delta;
+        }
+
+        // wrap into [-16 * f, 16 * f - 1]
+        int32_t const range = 32 << rsize;
+        int32_t v = pred + delta;
+        if (v < -(range >> 1))
+            v += range;
+        else if (v >= (range >> 1))
+            v -= range;
+
+        return v;
+    }
+
+    void MPEG2SliceDecoder::DecodeIntraBlock(int16_t* block, int32_t cc)
+    {
+        VLCTables const& tables = GetTables();
+
+        int32_t const size = (cc ? tables.dcSizeChroma : tables.dcSizeLuma).Decode(m_bs);
+
+        int32_t diff = 0;
+        if (size)
+        {
+            diff = int32_t(m_bs.GetBits(size));
+            if (diff < (1 << (size - 1)))
+                diff += 1 - (1 << size);
+        }
+
+        m_dcPred[cc] += diff;
+        block[0] = int16_t(Saturate2048(m_dcPred[cc] << (3 - m_ctx.intraDcPrecision)));
+
+        DecodeCoefficients(block, 1, block[0], m_ctx.intraQM, true);
+    }
+
+    void MPEG2SliceDecoder::DecodeNonIntraBlock(int16_t* block)
+    {
+        int32_t n = 0;
+        int32_t parity = 0;
+
+        // the first coefficient uses '1s' for run 0, level 1
+        if (m_bs.ShowBits(1))
+        {
+            int32_t const sign = int32_t(m_bs.GetBits(2) & 1);
+            int32_t const pos  = m_ctx.alternateScan ? AlternateScan[0] : ZigzagScan[0];
+
+            int32_t const value = Saturate2048((3 * m_quantiserScale * m_ctx.nonIntraQM[pos]) / 32);
+            block[pos] = int16_t(sign ? -value : value);
+            parity     = value;
+            n          = 1;
+        }
+
+        DecodeCoefficients(block, n, parity, m_ctx.nonIntraQM, false);
+    }
+
+    void MPEG2SliceDecoder::DecodeCoefficients(int16_t* block, int32_t n, int32_t parity, uint8_t const* qm, bool intra)
+    {
+        VLCTables const& tables = GetTables();
+
+        VLCTable const& table = intra && m_ctx.intraVlcFormat ? tables.dctB15 : tables.dctB14;
+        uint8_t const*  scan  = m_ctx.alternateScan ? AlternateScan : ZigzagScan;
+        int32_t const   qs    = m_quantiserScale;
+
+        for (;;)
+        {
+            VLCEntry const& e = table.Lookup(m_bs);
+
+            int32_t run, level;
+            if (e.value >= 0)
+            {
+                // code and sign in one read
+                uint32_t const bits = m_bs.GetBits(e.length + 1);
+                run   = e.value & 0xff;
+                level = (bits & 1) ? -(e.value >> 8) : (e.value >> 8);
+            }
+            else if (e.value == DCT_EOB)
+            {
+                m_bs.GetBits(e.length);
+                break;
+            }
+            else
+            {
+                m_bs.GetBits(e.length);
+                run   = int32_t(m_bs.GetBits(6));
+                level = int32_t(m_bs.GetBits(12));
+                if (!(level & 0x7ff)) // 0 and -2048 are forbidden
+                    throw mpeg2_exception(UMC::UMC_ERR_INVALID_STREAM);
+                if (level & 0x800)
+                    level -= 0x1000;
+            }
+
+            n += run;
+            if (n > 63)
+                throw mpeg2_exception(UMC::UMC_ERR_INVALID_STREAM);
+
+            int32_t const pos = scan[n++];
+
+            // 7.4.2.3, '/' truncates towards zero
+            int32_t value = intra ?
+                (level * qs * qm[pos]) / 16 :
+                ((2 * level + (level > 0 ? 1 : -1)) * qs * qm[pos]) / 32;
+            value = Saturate2048(value);
+
+            block[pos] = int16_t(value);
+            parity ^= value;
+        }
+
+        // 7.4.4 mismatch control
+        if (!(parity & 1))
+            block[63] ^= 1;
+    }
+
+    void MPEG2SliceDecoder::SkipMacroblock(int32_t address)
+    {
+        ResetDcPredictors();
+
+        if (m_ctx.pictureCodingType == MPEG2_P_PICTURE)
+        {
+            // zero vector from the same parity, predictors are reset
+            std::fill(&m_pmv[0][0][0], &m_pmv[0][0][0] + 8, 0);
+
+            Motion motion;
+            motion.type       = m_fieldPicture ? MC_FIELD : MC_FRAME;
+            motion.directions = MB_MOTION_FORWARD;
+            motion.fieldSelect[0][0] = uint8_t(m_parity);
+
+            m_motion      = motion;
+            m_motionValid = true;
+        }
+        else if (m_ctx.pictureCodingType != MPEG2_B_PICTURE || !m_motionValid)
+            throw mpeg2_exception(UMC::UMC_ERR_INVALID_STREAM);
+
+        // B pictures repeat the prediction of the previous macroblock
+        PredictMacroblock(m_motion, address % m_ctx.mbWidth, address / m_ctx.mbWidth);
+    }
+
+    MPEG2SliceDecoder::PlaneView MPEG2SliceDecoder::GetView(MPEG2FramePlanes const& planes, bool chroma, int32_t parity) const
+    {
+        int32_t const rows = chroma ? m_ctx.height / 2 : m_ctx.height;
+        uint8_t* const ptr = chroma ? planes.uv : planes.y;
+
+        if (parity < 0)
+            return { ptr, planes.pitch, rows };
+
+        return { ptr + parity * planes.pitch, 2 * planes.pitch, rows / 2 };
+    }
+
+    MPEG2FramePlanes const& MPEG2SliceDecoder::GetFieldReference(int32_t s, int32_t parity) const
+    {
+        // the second field of a P frame may refer to the first one
+        if (m_ctx.secondField && m_ctx.pictureCodingType == MPEG2_P_PICTURE && parity != m_parity)
+            return m_ctx.cur;
+
+        return m_ctx.ref[s];
+    }
+
+    void MPEG2SliceDecoder::Predict(PlaneView const& ref, bool chroma, int32_t x, int32_t y, int32_t dxy,
+                                    uint8_t* dst, int32_t dstPitch, int32_t h, bool average)
+    {
+        int32_t const step = chroma ? 2 : 1;
+        int32_t const cols = m_ctx.width / step;
+        int32_t const w    = 16 / step + (dxy & 1);
+        int32_t const rows = h + (dxy >> 1);
+
+        uint8_t const* src = ref.ptr + y * ref.pitch + x * step;
+        int32_t srcPitch   = ref.pitch;
+
+        // vectors may point outside of the picture, the border is repeated then
+        alignas(16) uint8_t edge[17 * 32];
+        if (x < 0 || y < 0 || x + w > cols || y + rows > ref.rows)
+        {
+            for (int32_t r = 0; r < rows; ++r)
+            {
+                uint8_t const* line = ref.ptr + mfx::clamp(y + r, 0, ref.rows - 1) * ref.pitch;
+                for (int32_t i = 0; i < w; ++i)
+                {
+                    int32_t const sx = mfx::clamp(x + i, 0, cols - 1) * step;
+                    for (int32_t c = 0; c < step; ++c)
+                        edge[r * 32 + i * step + c] = line[sx + c];
+                }
+            }
+
+            src      = edge;
+            srcPitch = 32;
+        }
+
+        Predict16(src, srcPitch, dst, dstPitch, h, dxy, step, average);
+    }
+
+    void MPEG2SliceDecoder::PredictField(MPEG2FramePlanes const& ref, int32_t parity, int32_t mbx, int32_t row,
+                                         int32_t mvx, int32_t mvy, uint8_t* dstY, uint8_t* dstUV, int32_t dstPitch,
+                                         int32_t h, bool average)
+    {
+        Predict(GetView(ref, false, parity), false, mbx * 16 + (mvx >> 1), row + (mvy >> 1),
+                ((mvy & 1) << 1) | (mvx & 1), dstY, dstPitch, h, average);
+
+        // 4:2:0 chroma vectors are halved towards zero
+        int32_t const cx = mvx / 2;
+        int32_t const cy = mvy / 2;
+        Predict(GetView(ref, true, parity), true, mbx * 8 + (cx >> 1), row / 2 + (cy >> 1),
+                ((cy & 1) << 1) | (cx & 1), dstUV, dstPitch, h / 2, average);
+    }
+
+    void MPEG2SliceDecoder::PredictMacroblock(Motion const& motion, int32_t mbx, int32_t mby)
+    {
+        int32_t const pitch = m_ctx.cur.pitch;
+        bool average = false;
+
+        for (int32_t s = 0; s < 2; ++s)
+        {
+            if (!(motion.directions & (s ? MB_MOTION_BACKWARD : MB_MOTION_FORWARD)))
+                continue;
+
+            int16_t const (*mv)[2][2] = motion.mv;
+
+            if (!m_fieldPicture)
+            {
+                uint8_t* const dstY  = m_ctx.cur.y  + mby * 16 * pitch + mbx * 16;
+                uint8_t* const dstUV = m_ctx.cur.uv + mby * 8  * pitch + mbx * 16;
+
+                switch (motion.type)
+                {
+                case MC_FRAME:
+                    PredictField(m_ctx.ref[s], -1, mbx, mby * 16, mv[0][s][0], mv[0][s][1], dstY, dstUV, pitch, 16, average);
+                    break;
+
+                case MC_FIELD:
+                    for (int32_t p = 0; p < 2; ++p)
+                        PredictField(m_ctx.ref[s], motion.fieldSelect[p][s], mbx, mby * 8, mv[p][s][0], mv[p][s][1],
+                                     dstY + p * pitch, dstUV + p * pitch, 2 * pitch, 8, average);
+                    break;
+
+                default: // MC_DMV
+                    for (int32_t p = 0; p < 2; ++p)
+                    {
+                        // same parity, then the opposite one with the derived vector (7.6.3.6)
+                        PredictField(m_ctx.ref[s], p, mbx, mby * 8, mv[0][s][0], mv[0][s][1],
+                                     dstY + p * pitch, dstUV + p * pitch, 2 * pitch, 8, average);
+
+                        int32_t const m = (m_ctx.topFieldFirst == !p) ? 1 : 3;
+                        int32_t const x = ((mv[0][s][0] * m + (mv[0][s][0] > 0)) >> 1) + motion.dmv[0];
+                        int32_t const y = ((mv[0][s][1] * m + (mv[0][s][1] > 0)) >> 1) + motion.dmv[1] + (p ? 1 : -1);
+                        PredictField(m_ctx.ref[s], 1 - p, mbx, mby * 8, x, y,
+                                     dstY + p * pitch, dstUV + p * pitch, 2 * pitch, 8, true);
+                    }
+                    break;
+                }
+            }
+            else
+            {
+                uint8_t* const dstY  = m_ctx.cur.y  + m_parity * pitch + mby * 32 * pitch + mbx * 16;
+                uint8_t* const dstUV = m_ctx.cur.uv + m_parity * pitch + mby * 16 * pitch + mbx * 16;
+
+                switch (motion.type)
+                {
+                case MC_FIELD:
+                    PredictField(GetFieldReference(s, motion.fieldSelect[0][s]), motion.fieldSelect[0][s], mbx, mby * 16,
+                                 mv[0][s][0], mv[0][s][1], dstY, dstUV, 2 * pitch, 16, average);
+                    break;
+
+                case MC_16X8:
+                    for (int32_t r = 0; r < 2; ++r)
+                        PredictField(GetFieldReference(s, motion.fieldSelect[r][s]), motion.fieldSelect[r][s], mbx, mby * 16 + 8 * r,
+                                     mv[r][s][0], mv[r][s][1], dstY + 16 * r * pitch, dstUV + 8 * r * pitch, 2 * pitch, 8, average);
+                    break;
+
+                default: // MC_DMV
+                {
+                    PredictField(m_ctx.ref[s], m_parity, mbx, mby * 16, mv[0][s][0], mv[0][s][1],
+                                 dstY, dstUV, 2 * pitch, 16, average);
+
+                    int32_t const x = ((mv[0][s][0] + (mv[0][s][0] > 0)) >> 1) + motion.dmv[0];
+                    int32_t const y = ((mv[0][s][1] + (mv[0][s][1] > 0)) >> 1) + motion.dmv[1] + (m_parity ? 1 : -1);
+                    PredictField(GetFieldReference(s, 1 - m_parity), 1 - m_parity, mbx, mby * 16, x, y,
+                                 dstY, dstUV, 2 * pitch, 16, true);
+                    break;
+                }
+                }
+            }
+
+            average = true;
+        }
+    }
+
+    void MPEG2SliceDecoder::Conceal(int32_t address, int32_t end)
+    {
+        // copy from the forward reference, nothing to copy from without one
+        if (m_ctx.ref[0].y == m_ctx.cur.y)
+            return;
+
+        Motion motion;
+        motion.type       = m_fieldPicture ? MC_FIELD : MC_FRAME;
+        motion.directions = MB_MOTION_FORWARD;
+        motion.fieldSelect[0][0] = uint8_t(m_parity);
+
+        for (; address < end; ++address)
+            PredictMacroblock(motion, address % m_ctx.mbWidth, address / m_ctx.mbWidth);
+    }
+}
+
+#endif // MFX_ENABLE_MPEG2_VIDEO_DECODE && MFX_ENABLE_SW_FALLBACK
@@ -238,7 +238,17 @@ namespace UMC_MPEG2_DECODER
             else
                 out->IOPattern = MFX_IOPATTERN_OUT_VIDEO_MEMORY;
 
-            CHECK_UNSUPPORTED(!IsHWSupported(core, in));
+            if (!IsHWSupported(core, in))
+            {
+#if defined (MFX_ENABLE_SW_FALLBACK)
+                // MPEG-2 is decoded on the CPU, MPEG-1 syntax is not supported there
+                CHECK_UNSUPPORTED(in->mfx.CodecProfile == MFX_PROFILE_MPEG1);
+                if (res == MFX_ERR_NONE)
+                    res = MFX_WRN_PARTIAL_ACCELERATION;
+#else
+                return MFX_ERR_UNSUPPORTED;
+#endif
+            }
         }
 
         return res;
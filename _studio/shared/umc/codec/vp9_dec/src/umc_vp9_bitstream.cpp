@@ -32,28 +32,11 @@ namespace UMC_VP9_DECODER
 
 VP9Bitstream::VP9Bitstream()
 {
-    Reset(0, 0);
 }
 
 VP9Bitstream::VP9Bitstream(uint8_t * const pb, const uint32_t maxsize)
+    : UMC::CachedBitReader<vp9_exception>(pb, maxsize)
 {
-    Reset(pb, maxsize);
-}
-
-// Reset the bitstream with new data pointer
-void VP9Bitstream::Reset(uint8_t * const pb, const uint32_t maxsize)
-{
-    Reset(pb, 0, maxsize);
-}
-
-// Reset the bitstream with new data pointer and bit offset
-void VP9Bitstream::Reset(uint8_t * const pb, int32_t offset, const uint32_t maxsize)
-{
-    m_pbs       = pb;
-    m_pbsBase   = pb;
-    m_bitOffset = offset;
-    m_maxBsSize = maxsize;
-
 }
 
 // Return bitstream array base address and size
@@ -63,38 +46,6 @@ void VP9Bitstream::GetOrg(uint8_t **pbs, uint32_t *size)
     *size      = m_maxBsSize; 
 }
 
-uint32_t VP9Bitstream::GetBits(uint32_t nbits)
-{
-    mfxU32 bits = 0;
-    for (; nbits > 0; --nbits)
-    {
-        bits <<= 1;
-        bits |= GetBit();
-    }
-
-    return bits;
-}
-
-uint32_t VP9Bitstream::GetUe()
-{
-    uint32_t zeroes = 0;
-    while (GetBit() == 0)
-        ++zeroes;
-
-    return zeroes == 0 ?
-        0 : ((1 << zeroes) | GetBits(zeroes)) - 1; 
-}
-
-int32_t VP9Bitstream::GetSe()
-{
-    int32_t val = GetUe();
-    uint32_t sign = (val & 1);
-    val = (val + 1) >> 1;
-
-    return
-        sign ? val : -int32_t(val); 
-}
-
 void GetFrameSize(VP9Bitstream* bs, VP9DecoderFrame* frame)
 {
     frame->width = bs->GetBits(16) + 1;
@@ -0,0 +1,232 @@
+// Copyright (c) 2020 Intel Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __UMC_BIT_READER_H__
+#define __UMC_BIT_READER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "umc_structures.h"
+
+namespace UMC
+{
+    // MSB-first bit reader with a 64-bit cache register.
+    //
+    // Bits are consumed from the top of m_cache. Refill loads a whole big-endian
+    // 64-bit word when at least 8 bytes are left in the buffer and tops the
+    // cache up to 56..63 valid bits without branches, so any read of up to 32
+    // bits needs at most one refill and one end-of-buffer check.
+    // Only the last 7 bytes of the buffer are loaded byte by byte.
+    //
+    // Exception is constructed from UMC::Status and thrown on reading past the end.
+    template <typename Exception>
+    class CachedBitReader
+    {
+    public:
+
+        CachedBitReader()
+        {
+            Reset(nullptr, 0, 0);
+        }
+
+        CachedBitReader(uint8_t * pb, uint32_t maxsize)
+        {
+            Reset(pb, 0, maxsize);
+        }
+
+        // Reset the bitstream with new data pointer
+        void Reset(uint8_t * pb, uint32_t maxsize)
+        {
+            Reset(pb, 0, maxsize);
+        }
+
+        // Reset the bitstream with new data pointer and bit offset
+        void Reset(uint8_t * pb, int32_t offset, uint32_t maxsize)
+        {
+            m_pbsBase   = pb;
+            m_maxBsSize = maxsize;
+            m_pbsEnd    = pb + maxsize;
+            SetPosition(static_cast<size_t>(offset));
+        }
+
+        // Read N (0..32) bits from bitstream array
+        inline uint32_t GetBits(uint32_t nbits)
+        {
+            if (m_cacheBits < static_cast<int32_t>(nbits))
+            {
+                Refill();
+                if (m_cacheBits < static_cast<int32_t>(nbits))
+                    throw Exception(UMC::UMC_ERR_NOT_ENOUGH_DATA);
+            }
+
+            // two shifts keep nbits == 0 well defined
+            uint32_t const bits = static_cast<uint32_t>((m_cache >> 1) >> (63 - nbits));
+            m_cache <<= nbits;
+            m_cacheBits -= nbits;
+
+            return bits;
+        }
+
+        // Reads one bit from the buffer
+        inline uint32_t GetBit()
+        {
+            return GetBits(1);
+        }
+
+        // Show N (0..32) bits without moving the position
+        inline uint32_t PeekBits(uint32_t nbits)
+        {
+            if (m_cacheBits < static_cast<int32_t>(nbits))
+            {
+                Refill();
+                if (m_cacheBits < static_cast<int32_t>(nbits))
+                    throw Exception(UMC::UMC_ERR_NOT_ENOUGH_DATA);
+            }
+
+            return static_cast<uint32_t>((m_cache >> 1) >> (63 - nbits));
+        }
+
+        // Read exp-Golomb coded unsigned value
+        inline uint32_t GetUe()
+        {
+            uint32_t zeroes = 0;
+            while (GetBit() == 0)
+                ++zeroes;
+
+            return zeroes == 0 ?
+                0 : ((1u << zeroes) | GetBits(zeroes)) - 1;
+        }
+
+        // Read exp-Golomb coded signed value
+        inline int32_t GetSe()
+        {
+            int32_t val = GetUe();
+            uint32_t sign = (val & 1);
+            val = (val + 1) >> 1;
+
+            return
+                sign ? val : -int32_t(val);
+        }
+
+        // Move bitstream position pointer to N bits forward or backward,
+        // position may go beyond the buffer, next read will throw then
+        inline void Seek(int32_t nbits)
+        {
+            if (nbits >= 0 && nbits <= m_cacheBits)
+            {
+                // short forward skip inside the cache
+                m_cache     <<= nbits;
+                m_cacheBits -= nbits;
+                return;
+            }
+
+            SetPosition(BitsDecoded() + nbits);
+        }
+
+        // Returns number of decoded bits since last reset
+        inline size_t BitsDecoded() const
+        {
+            return static_cast<size_t>(m_pbs - m_pbsBase) * 8 - m_cacheBits;
+        }
+
+        // Returns number of decoded bytes since last reset
+        inline size_t BytesDecoded() const
+        {
+            return BitsDecoded() / 8;
+        }
+
+        // Return a number of bits left
+        inline size_t BitsLeft() const
+        {
+            return static_cast<size_t>(m_maxBsSize) * 8 - BitsDecoded();
+        }
+
+        // Returns number of bytes left in bitstream array
+        inline size_t BytesLeft() const
+        {
+            return (int32_t)m_maxBsSize - (int32_t)BytesDecoded();
+        }
+
+        // Returns true if position is not byte aligned
+        inline bool IsByteAligned() const
+        {
+            return (BitsDecoded() & 7) == 0;
+        }
+
+    protected:
+
+        static inline uint64_t LoadBE64(uint8_t const* p)
+        {
+            // compilers fold this into a single load + bswap
+            return
+                  (uint64_t(p[0]) << 56) | (uint64_t(p[1]) << 48)
+                | (uint64_t(p[2]) << 40) | (uint64_t(p[3]) << 32)
+                | (uint64_t(p[4]) << 24) | (uint64_t(p[5]) << 16)
+                | (uint64_t(p[6]) <<  8) |  uint64_t(p[7]);
+        }
+
+        inline void Refill()
+        {
+            if (m_pbsEnd - m_pbs >= 8)
+            {
+                // bits below m_cacheBits already hold the same data as the word, OR is safe
+                m_cache     |= LoadBE64(m_pbs) >> m_cacheBits;
+                m_pbs       += (63 - m_cacheBits) >> 3;
+                m_cacheBits |= 56;
+                return;
+            }
+
+            while (m_cacheBits <= 56 && m_pbs < m_pbsEnd)
+            {
+                m_cache     |= uint64_t(*m_pbs++) << (56 - m_cacheBits);
+                m_cacheBits += 8;
+            }
+        }
+
+        inline void SetPosition(size_t bitPos)
+        {
+            m_pbs       = m_pbsBase + (bitPos >> 3);
+            m_cache     = 0;
+            m_cacheBits = 0;
+
+            int32_t const skip = static_cast<int32_t>(bitPos & 7);
+            if (!skip)
+                return;
+
+            Refill();
+            if (m_cacheBits >= skip)
+            {
+                m_cache     <<= skip;
+                m_cacheBits -= skip;
+            }
+            else
+                m_cacheBits = -skip; // beyond the end, keeps BitsDecoded() exact
+        }
+
+        uint8_t* m_pbs;        // next byte to be loaded into the cache
+        uint8_t* m_pbsBase;    // pointer to the first byte of the buffer
+        uint8_t* m_pbsEnd;     // pointer past the last byte of the buffer
+        uint32_t m_maxBsSize;  // maximum buffer size in bytes
+        uint64_t m_cache;      // not consumed bits, MSB first
+        int32_t  m_cacheBits;  // number of valid bits in m_cache
+    };
+}
+
+#endif // __UMC_BIT_READER_H__
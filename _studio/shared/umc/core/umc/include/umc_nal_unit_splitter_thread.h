@@ -0,0 +1,183 @@
+// Copyright (c) 2020 Intel Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __UMC_NAL_UNIT_SPLITTER_THREAD_H__
+#define __UMC_NAL_UNIT_SPLITTER_THREAD_H__
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "umc_media_data.h"
+
+namespace UMC
+{
+    // Splits the AVC/HEVC decoder input into NAL units on a dedicated parse thread.
+    //
+    // PutData copies the input once into a buffer and consumes it at once. The start code
+    // search and the emulation prevention bytes removal run on the parse thread in place while
+    // the decoder is busy with earlier frames. GetData returns a window over that buffer from
+    // the first NAL unit which isn't consumed yet, so the caller may move back over the window
+    // the same way it does over the application bitstream. Units and the window are kept as
+    // offsets from the start of the stream, consumed input is dropped by moving the window
+    // start and the buffer is compacted only when the input doesn't fit at its end.
+    // Codec specific splitters hand the NAL units of the window out without scanning them
+    // again and take their prepared payload instead of swapping them.
+    class NalUnitSplitterThread
+    {
+    public:
+
+        struct Unit
+        {
+            Unit();
+
+            size_t                 offset;         // of the 3 byte start code in the stream
+            size_t                 size;           // including the start code
+            int32_t                type;
+            double                 time;
+            bool                   frameEnd;       // last NAL unit of a complete input frame
+            std::vector<uint8_t>   payload;        // NAL unit prepared for parsing
+            size_t                 payloadSize;
+            std::vector<uint32_t>  removedOffsets; // of the emulation prevention bytes
+        };
+
+        NalUnitSplitterThread();
+        virtual ~NalUnitSplitterThread();
+
+        // Start the parse thread, at most 'limit' bytes of input are queued ahead
+        void Start(size_t limit);
+        // Stop the parse thread and drop the queued input
+        void Stop();
+        // Drop the queued input
+        void Drop();
+
+        // Queue the data of the source and consume it, NULL source ends the stream
+        void PutData(MediaData * pSource);
+        // Returns the window over NAL units which are not consumed yet, NULL if there are none.
+        // The window ends with the last NAL unit of a complete input frame if there is one in it,
+        // it takes the next frame in if nothing was consumed from it since the last call.
+        // Waits for new NAL units if 'wait' is set and the parse thread still has input.
+        MediaData * GetData(bool wait);
+        // Returns true if there is input which isn't in the window yet
+        bool IsPending();
+        // Returns true if the last PutData couldn't queue the whole source
+        bool IsFull() const
+        {
+            return m_full;
+        }
+
+        // Removes all queued input and returns it starting at the current position of the window,
+        // the application gets it back when the decoder has to be reinitialized
+        void TakeBack(std::vector<uint8_t> & data);
+
+        // Returns the last unit handed out of the window if the NAL unit is its whole data
+        Unit const * FindPrepared(uint8_t const * nalUnit, size_t size) const;
+
+    protected:
+
+        // Codec specific part, called on the parse thread.
+        // Returns next NAL unit of the source and its type, NULL if the source needs more data.
+        // NULL source returns the NAL unit gathered by previous calls at the end of stream.
+        virtual MediaData * SplitNext(MediaData * pSource, int32_t & type) = 0;
+        // Fills payload of the unit with the NAL unit prepared for parsing
+        virtual void PrepareUnit(MediaData & nalUnit, Unit & unit) = 0;
+        // Resets the state of SplitNext
+        virtual void ResetSplit() = 0;
+
+        // Returns the unit whose start code is at the current position of the window, NULL for other sources.
+        // Bytes the splitter dropped between units (trailing zeros, 4th byte of start codes) are skipped.
+        Unit const * FindUnit(MediaData * pSource);
+
+    private:
+
+        struct Chunk
+        {
+            size_t                begin;         // stream offsets of the input
+            size_t                end;
+            double                time;
+            uint32_t              flags;
+            bool                  eos;
+        };
+
+        uint8_t * At(size_t offset)
+        {
+            return m_buffer.data() + (offset - m_origin);
+        }
+        uint8_t const * At(size_t offset) const
+        {
+            return m_buffer.data() + (offset - m_origin);
+        }
+        size_t OffsetOf(void const * ptr) const
+        {
+            return m_origin + (reinterpret_cast<uint8_t const *>(ptr) - m_buffer.data());
+        }
+
+        void Run();
+        void Split(Chunk const & chunk);
+        void Publish(Unit & unit);
+        // Makes room for 'size' bytes of input at the end of the buffer
+        void Reserve(std::unique_lock<std::mutex> & guard, size_t size);
+        // Removes consumed units from the window and appends split ones
+        void UpdateWindow();
+        // Points m_data to the window
+        void SetWindow(size_t position);
+        // Returns stream offset of the caller in the window
+        size_t GetPosition();
+        void ClearInput();
+
+        std::thread              m_thread;
+        std::mutex               m_guard;
+        std::condition_variable  m_inputReady;
+        std::condition_variable  m_unitsReady;
+        bool                     m_stop;
+        bool                     m_busy;         // parse thread is splitting a chunk
+        bool                     m_eos;          // end of stream is queued
+
+        size_t                   m_limit;
+        bool                     m_full;
+
+        // queued input from the window start on, moved or reallocated only while the parse thread is idle
+        std::vector<uint8_t>     m_buffer;
+        size_t                   m_origin;       // stream offset of m_buffer start
+        size_t                   m_inputEnd;     // stream offset of the end of queued input
+
+        std::deque<Chunk>        m_input;
+        std::deque<Unit>         m_ready;        // split units waiting for the window
+
+        // used by the parse thread while it is busy
+        size_t                   m_splitPos;     // stream offset of input which isn't split yet
+        double                   m_splitTime;    // time of the input at m_splitPos
+
+        // used by the decoder thread
+        std::deque<Unit>         m_units;        // NAL units of the window
+        size_t                   m_base;         // stream offset of the window start
+        size_t                   m_windowEnd;    // end of the last unit moved to the window
+        size_t                   m_position;     // of the window returned last time
+        size_t                   m_end;          // end of the window returned last time
+        double                   m_time;
+        bool                     m_frameEnd;
+        Unit const *             m_current;      // last unit handed out of the window
+        MediaData                m_data;
+    };
+}
+
+#endif // __UMC_NAL_UNIT_SPLITTER_THREAD_H__
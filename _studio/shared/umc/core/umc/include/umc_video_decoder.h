@@ -47,6 +47,8 @@ public:
     BaseCodec               *pPostProcessing;               // (BaseCodec*) pointer to post processing
 
     VideoAccelerator        *pVideoAccelerator;             // pointer to video accelerator
+
+    size_t                  preSplitSize;                   // (size_t) input queued for splitting on a parse thread, 0 - split on decoding
 };
 
 /******************************************************************************/
@@ -0,0 +1,450 @@
+// Copyright (c) 2020 Intel Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "umc_defs.h"
+#include "umc_nal_unit_splitter_thread.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace UMC
+{
+    static const uint8_t g_startCode[] = { 0, 0, 1 };
+
+    NalUnitSplitterThread::Unit::Unit()
+        : offset(0)
+        , size(0)
+        , type(-1)
+        , time(-1)
+        , frameEnd(false)
+        , payloadSize(0)
+    {
+    }
+
+    NalUnitSplitterThread::NalUnitSplitterThread()
+        : m_stop(false)
+        , m_busy(false)
+        , m_eos(false)
+        , m_limit(0)
+        , m_full(false)
+        , m_origin(0)
+        , m_inputEnd(0)
+        , m_splitPos(0)
+        , m_splitTime(-1)
+        , m_base(0)
+        , m_windowEnd(0)
+        , m_position(0)
+        , m_end(0)
+        , m_time(-1)
+        , m_frameEnd(false)
+        , m_current(nullptr)
+    {
+    }
+
+    NalUnitSplitterThread::~NalUnitSplitterThread()
+    {
+        // derived classes stop the thread before SplitNext goes away
+        VM_ASSERT(!m_thread.joinable());
+        Stop();
+    }
+
+    void NalUnitSplitterThread::Start(size_t limit)
+    {
+        Stop();
+
+        m_limit = limit;
+        m_stop  = false;
+        m_thread = std::thread([this]() { Run(); });
+    }
+
+    void NalUnitSplitterThread::Stop()
+    {
+        if (m_thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_guard);
+                m_stop = true;
+            }
+
+            m_inputReady.notify_one();
+            m_thread.join();
+        }
+
+        std::lock_guard<std::mutex> guard(m_guard);
+        ClearInput();
+        std::vector<uint8_t>().swap(m_buffer);
+    }
+
+    void NalUnitSplitterThread::Drop()
+    {
+        std::unique_lock<std::mutex> guard(m_guard);
+        m_unitsReady.wait(guard, [this]() { return !m_busy; });
+
+        ClearInput();
+        ResetSplit();
+    }
+
+    void NalUnitSplitterThread::ClearInput()
+    {
+        m_input.clear();
+        m_ready.clear();
+        m_eos  = false;
+        m_full = false;
+
+        m_origin = m_inputEnd = 0;
+        m_splitPos  = 0;
+        m_splitTime = -1;
+
+        m_units.clear();
+        m_base = m_windowEnd = m_position = m_end = 0;
+        m_time = -1;
+        m_frameEnd = false;
+        m_current = nullptr;
+        m_data.SetBufferPointer(nullptr, 0);
+    }
+
+    void NalUnitSplitterThread::PutData(MediaData * pSource)
+    {
+        std::unique_lock<std::mutex> guard(m_guard);
+
+        m_full = false;
+
+        if (!pSource)
+        {
+            if (!m_eos)
+            {
+                Chunk chunk;
+                chunk.begin = chunk.end = m_inputEnd;
+                chunk.time  = -1;
+                chunk.flags = MediaData::FLAG_VIDEO_DATA_END_OF_STREAM;
+                chunk.eos   = true;
+                m_input.push_back(chunk);
+                m_eos = true;
+                m_inputReady.notify_one();
+            }
+
+            return;
+        }
+
+        size_t size = pSource->GetDataSize();
+        if (!size)
+            return;
+
+        uint32_t const flags  = pSource->GetFlags();
+        size_t const   queued = m_inputEnd - m_windowEnd;
+        size_t         room   = queued < m_limit ? m_limit - queued : 0;
+
+        if (room < size)
+        {
+            // complete units can't be cut, they are taken as a whole when nothing is queued
+            if (!(flags & MediaData::FLAG_VIDEO_DATA_NOT_FULL_UNIT))
+                room = queued ? 0 : size;
+
+            m_full = true;
+            size = std::min(size, room);
+            if (!size)
+                return;
+        }
+
+        Reserve(guard, size);
+
+        uint8_t const * data = reinterpret_cast<uint8_t const *>(pSource->GetDataPointer());
+        std::copy(data, data + size, At(m_inputEnd));
+
+        Chunk chunk;
+        chunk.begin = m_inputEnd;
+        chunk.end   = m_inputEnd + size;
+        chunk.time  = pSource->GetTime();
+        chunk.flags = flags;
+        chunk.eos   = false;
+        pSource->MoveDataPointer(static_cast<int32_t>(size));
+
+        m_inputEnd = chunk.end;
+        m_input.push_back(chunk);
+        m_eos = false;
+        m_inputReady.notify_one();
+    }
+
+    void NalUnitSplitterThread::Reserve(std::unique_lock<std::mutex> & guard, size_t size)
+    {
+        if (m_inputEnd + size <= m_origin + m_buffer.size())
+            return;
+
+        // the parse thread reads the buffer while it splits
+        m_unitsReady.wait(guard, [this]() { return !m_busy; });
+
+        size_t const position = GetPosition();
+        size_t const live     = m_inputEnd - m_base;
+
+        if (2 * (live + size) > m_buffer.size())
+        {
+            // keep the buffer twice as large as the live data, so compaction moves
+            // no more bytes than were appended since the previous one
+            std::vector<uint8_t> buffer(2 * (live + size));
+            std::copy(At(m_base), At(m_inputEnd), buffer.data());
+            m_buffer.swap(buffer);
+        }
+        else
+        {
+            std::copy(At(m_base), At(m_inputEnd), m_buffer.data());
+        }
+
+        m_origin = m_base;
+
+        if (m_data.GetBufferPointer())
+            SetWindow(position);
+    }
+
+    MediaData * NalUnitSplitterThread::GetData(bool wait)
+    {
+        std::unique_lock<std::mutex> guard(m_guard);
+
+        if (wait)
+            m_unitsReady.wait(guard, [this]() { return !m_ready.empty() || (!m_busy && m_input.empty()); });
+
+        UpdateWindow();
+
+        if (GetPosition() >= m_windowEnd)
+            return nullptr;
+
+        return &m_data;
+    }
+
+    bool NalUnitSplitterThread::IsPending()
+    {
+        std::lock_guard<std::mutex> guard(m_guard);
+        return m_busy || !m_input.empty() || !m_ready.empty();
+    }
+
+    size_t NalUnitSplitterThread::GetPosition()
+    {
+        if (!m_data.GetBufferPointer())
+            return m_base;
+
+        return m_base + (reinterpret_cast<uint8_t *>(m_data.GetDataPointer()) - reinterpret_cast<uint8_t *>(m_data.GetBufferPointer()));
+    }
+
+    void NalUnitSplitterThread::UpdateWindow()
+    {
+        size_t const position = GetPosition();
+
+        // the caller took nothing since the last time, it looks ahead into the next frame
+        bool const stalled = m_data.GetBufferPointer() && position == m_position;
+
+        // drop consumed units, a partly consumed one stays
+        while (!m_units.empty() && m_units.front().offset + m_units.front().size <= position)
+            m_units.pop_front();
+
+        m_base = std::min(position, m_units.empty() ? m_windowEnd : m_units.front().offset);
+
+        size_t const from = stalled && !m_units.empty() ? m_end : position;
+
+        for (auto & unit : m_ready)
+        {
+            m_windowEnd = unit.offset + unit.size;
+            m_units.push_back(std::move(unit));
+        }
+        m_ready.clear();
+
+        m_current = nullptr;
+
+        // expose NAL units up to the end of the first complete frame
+        size_t end = m_windowEnd;
+        bool frameEnd = false;
+        double time = -1;
+
+        for (auto const & unit : m_units)
+        {
+            if (time < 0 && position < unit.offset + unit.size)
+                time = unit.time;
+
+            if (unit.offset + unit.size <= from)
+                continue;
+
+            if (unit.frameEnd)
+            {
+                end = unit.offset + unit.size;
+                frameEnd = true;
+                break;
+            }
+        }
+
+        m_position = position;
+        m_end      = end;
+        m_time     = time;
+        m_frameEnd = frameEnd;
+
+        SetWindow(position);
+    }
+
+    void NalUnitSplitterThread::SetWindow(size_t position)
+    {
+        m_data.SetBufferPointer(At(m_base), m_end - m_base);
+        m_data.SetDataSize(m_end - m_base);
+        m_data.MoveDataPointer(static_cast<int32_t>(position - m_base));
+        m_data.SetTime(m_time);
+        m_data.SetFlags(m_frameEnd ? 0 : MediaData::FLAG_VIDEO_DATA_NOT_FULL_FRAME);
+    }
+
+    NalUnitSplitterThread::Unit const * NalUnitSplitterThread::FindUnit(MediaData * pSource)
+    {
+        m_current = nullptr;
+
+        if (pSource != &m_data || m_units.empty())
+            return nullptr;
+
+        size_t const position = GetPosition();
+
+        auto unit = std::lower_bound(m_units.begin(), m_units.end(), position,
+            [](Unit const & u, size_t offset) { return u.offset < offset; });
+
+        if (unit == m_units.end() || unit->offset + unit->size > m_end)
+            return nullptr;
+
+        if (unit->offset != position)
+        {
+            // the position is inside of the previous unit
+            if (unit != m_units.begin() && std::prev(unit)->offset + std::prev(unit)->size > position)
+                return nullptr;
+
+            m_data.MoveDataPointer(static_cast<int32_t>(unit->offset - position));
+        }
+
+        m_current = &*unit;
+        return m_current;
+    }
+
+    NalUnitSplitterThread::Unit const * NalUnitSplitterThread::FindPrepared(uint8_t const * nalUnit, size_t size) const
+    {
+        if (!m_current)
+            return nullptr;
+
+        uint8_t const * data = At(m_current->offset) + sizeof(g_startCode);
+        if (nalUnit != data || size != m_current->size - sizeof(g_startCode))
+            return nullptr;
+
+        return m_current;
+    }
+
+    void NalUnitSplitterThread::TakeBack(std::vector<uint8_t> & data)
+    {
+        std::unique_lock<std::mutex> guard(m_guard);
+        m_unitsReady.wait(guard, [this]() { return !m_busy; });
+
+        size_t const position = GetPosition();
+        data.assign(At(position), At(m_inputEnd));
+
+        ClearInput();
+        ResetSplit();
+    }
+
+    void NalUnitSplitterThread::Run()
+    {
+        std::unique_lock<std::mutex> guard(m_guard);
+
+        for (;;)
+        {
+            m_inputReady.wait(guard, [this]() { return m_stop || !m_input.empty(); });
+            if (m_stop)
+                break;
+
+            Chunk const chunk = m_input.front();
+            m_input.pop_front();
+            m_busy = true;
+
+            guard.unlock();
+            Split(chunk);
+            guard.lock();
+
+            m_busy = false;
+            m_unitsReady.notify_all();
+        }
+    }
+
+    void NalUnitSplitterThread::Split(Chunk const & chunk)
+    {
+        // the input which isn't split yet is contiguous with the chunk
+        if (m_splitPos == chunk.begin)
+            m_splitTime = chunk.time;
+
+        MediaData source;
+        source.SetBufferPointer(At(m_splitPos), chunk.end - m_splitPos);
+        source.SetDataSize(chunk.end - m_splitPos);
+        source.SetTime(chunk.time);
+        // the last NAL unit ends with the stream
+        source.SetFlags(chunk.eos ? MediaData::FLAG_VIDEO_DATA_END_OF_STREAM : chunk.flags);
+
+        Unit unit;
+        bool hasUnit = false;
+
+        for (;;)
+        {
+            uint8_t const * before = reinterpret_cast<uint8_t const *>(source.GetDataPointer());
+
+            int32_t type = -1;
+            MediaData * nalUnit = SplitNext(&source, type);
+
+            if (!nalUnit)
+            {
+                // SplitNext gathers an incomplete NAL unit in its own buffer, split it
+                // in place again when the rest of it is queued
+                size_t const splitPos = OffsetOf(before);
+                if (splitPos >= chunk.begin)
+                    m_splitTime = chunk.time;
+
+                m_splitPos = splitPos;
+                ResetSplit();
+                break;
+            }
+
+            if (hasUnit)
+                Publish(unit);
+
+            unit = Unit();
+            unit.offset = OffsetOf(nalUnit->GetDataPointer()) - sizeof(g_startCode);
+            unit.size   = sizeof(g_startCode) + nalUnit->GetDataSize();
+            unit.type   = type;
+            unit.time   = unit.offset < chunk.begin ? m_splitTime : chunk.time;
+            VM_ASSERT(unit.offset >= m_splitPos && unit.offset + unit.size <= chunk.end);
+            PrepareUnit(*nalUnit, unit);
+            hasUnit = true;
+        }
+
+        if (hasUnit)
+        {
+            unit.frameEnd = !chunk.eos && !(chunk.flags & MediaData::FLAG_VIDEO_DATA_NOT_FULL_FRAME);
+            Publish(unit);
+        }
+
+        if (chunk.eos)
+        {
+            m_splitPos = chunk.end;
+            ResetSplit();
+        }
+    }
+
+    void NalUnitSplitterThread::Publish(Unit & unit)
+    {
+        std::lock_guard<std::mutex> guard(m_guard);
+
+        m_ready.push_back(std::move(unit));
+        m_unitsReady.notify_all();
+    }
+}
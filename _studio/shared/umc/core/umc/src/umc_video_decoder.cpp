@@ -32,6 +32,7 @@ VideoDecoderParams::VideoDecoderParams(void)
     pPostProcessing = NULL;
     lpMemoryAllocator = NULL;
     pVideoAccelerator = NULL;
+    preSplitSize = 0;
 } // VideoDecoderParams::VideoDecoderParams(void)
 
 VideoDecoderParams::~VideoDecoderParams(void)
@@ -34,6 +34,9 @@ uint16_t vm_interlocked_inc16(volatile uint16_t *pVariable);
 /* Thread-safe 16-bit variable decrementing */
 uint16_t vm_interlocked_dec16(volatile uint16_t *pVariable);
 
+/* Thread-safe 16-bit variable comparing and storing */
+uint16_t vm_interlocked_cas16(volatile uint16_t *pVariable, uint16_t with, uint16_t cmp);
+
 /* Thread-safe 32-bit variable incrementing */
 uint32_t vm_interlocked_inc32(volatile uint32_t *pVariable);
 
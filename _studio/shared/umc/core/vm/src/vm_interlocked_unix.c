@@ -50,6 +50,17 @@ uint16_t vm_interlocked_dec16(volatile uint16_t *pVariable)
     return vm_interlocked_add16(pVariable, (uint16_t)-1) - 1;
 } /* uint16_t vm_interlocked_dec16(uint16_t *pVariable) */
 
+uint16_t vm_interlocked_cas16(volatile uint16_t *pVariable, uint16_t value_to_exchange, uint16_t value_to_compare)
+{
+    uint16_t previous_value;
+
+    asm volatile ("lock; cmpxchgw %1,%2"
+                  : "=a" (previous_value)
+                  : "r" (value_to_exchange), "m" (*pVariable), "0" (value_to_compare)
+                  : "memory", "cc");
+    return previous_value;
+} /* uint16_t vm_interlocked_cas16(volatile uint16_t *pVariable, uint16_t value_to_exchange, uint16_t value_to_compare) */
+
 uint32_t vm_interlocked_inc32(volatile uint32_t *pVariable)
 {
     return vm_interlocked_add32(pVariable, 1) + 1;
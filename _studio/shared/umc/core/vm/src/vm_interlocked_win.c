@@ -18,3 +18,15 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+
+#if defined(_WIN32) || defined(_WIN64)
+
+#include <windows.h>
+#include <vm_interlocked.h>
+
+uint16_t vm_interlocked_cas16(volatile uint16_t *pVariable, uint16_t value_to_exchange, uint16_t value_to_compare)
+{
+    return (uint16_t)InterlockedCompareExchange16((volatile SHORT *)pVariable, (SHORT)value_to_exchange, (SHORT)value_to_compare);
+} /* uint16_t vm_interlocked_cas16(volatile uint16_t *pVariable, uint16_t value_to_exchange, uint16_t value_to_compare) */
+
+#endif /* defined(_WIN32) || defined(_WIN64) */
@@ -25,6 +25,7 @@
 #include "umc_va_linux_protected.h"
 #include "umc_va_video_processing.h"
 #include "mfx_trace.h"
+#include "mfx_va_caps_cache.h"
 #include "umc_frame_allocator.h"
 #include "mfxstructures.h"
 
@@ -444,7 +445,7 @@ Status LinuxVideoAccelerator::Init(VideoAcceleratorParams* pInfo)
         {
             va_profiles    = new VAProfile[va_max_num_profiles];
             va_entrypoints = new VAEntrypoint[va_max_num_entrypoints];
-            va_res = vaQueryConfigProfiles(m_dpy, va_profiles, &va_num_profiles);
+            va_res = MfxVaCaps::QueryConfigProfiles(m_dpy, va_profiles, &va_num_profiles);
             umcRes = va_to_umc_res(va_res);
         }
 
@@ -481,7 +482,7 @@ Status LinuxVideoAccelerator::Init(VideoAcceleratorParams* pInfo)
         }
         if (UMC_OK == umcRes)
         {
-            va_res = vaQueryConfigEntrypoints(m_dpy, va_profile, va_entrypoints, &va_num_entrypoints);
+            va_res = MfxVaCaps::QueryConfigEntrypoints(m_dpy, va_profile, va_entrypoints, &va_num_entrypoints);
             umcRes = va_to_umc_res(va_res);
         }
         if (UMC_OK == umcRes)
@@ -528,7 +529,7 @@ Status LinuxVideoAccelerator::Init(VideoAcceleratorParams* pInfo)
 
             va_attributes[nattr++].type = VAConfigAttribEncryption;
 
-            va_res = vaGetConfigAttributes(m_dpy, va_profile, va_entrypoint, va_attributes, nattr);
+            va_res = MfxVaCaps::GetConfigAttributes(m_dpy, va_profile, va_entrypoint, va_attributes, nattr);
             umcRes = va_to_umc_res(va_res);
         }
 
@@ -142,7 +142,11 @@ typedef struct {
 MFX_PACK_END()
 
 enum {
-    MFX_EXTBUFF_THREADS_PARAM = MFX_MAKEFOURCC('T','H','D','P')
+    MFX_EXTBUFF_THREADS_PARAM = MFX_MAKEFOURCC('T','H','D','P'),
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    MFX_EXTBUFF_DEVICE_BUSY_WAIT = MFX_MAKEFOURCC('B','S','Y','W'),
+    MFX_EXTBUFF_SYSMEM_FRAME_POOL = MFX_MAKEFOURCC('S','M','F','P'),
+#endif
 };
 
 MFX_PACK_BEGIN_USUAL_STRUCT()
@@ -156,6 +160,34 @@ typedef struct {
 } mfxExtThreadsParam;
 MFX_PACK_END()
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+/* Attached to mfxInitParam: instead of returning MFX_WRN_DEVICE_BUSY right away, DecodeFrameAsync and
+   EncodeFrameAsync wait until a task of the session completes and retry, for up to Timeout milliseconds
+   per call. MFX_WRN_DEVICE_BUSY is returned if resources are still busy when the time runs out.
+   Timeout equal to 0 disables waiting. Not supported with ExternalThreads. */
+MFX_PACK_BEGIN_USUAL_STRUCT()
+typedef struct {
+    mfxExtBuffer Header;
+
+    mfxU32       Timeout;
+    mfxU32       reserved[15];
+} mfxExtDeviceBusyWait;
+MFX_PACK_END()
+
+/* Attached to mfxInitParam: system memory frames the library allocates itself are kept in a process-wide pool of
+   hugepage backed blocks after they are freed, so frames of the same size are reused by next Init/Reset calls of
+   any session without faulting pages in again. MaxSize limits memory mapped by the pool in megabytes, the largest
+   value requested by open sessions is used. The pool is released when the last session is closed. */
+MFX_PACK_BEGIN_USUAL_STRUCT()
+typedef struct {
+    mfxExtBuffer Header;
+
+    mfxU32       MaxSize;
+    mfxU32       reserved[15];
+} mfxExtSysMemFramePool;
+MFX_PACK_END()
+#endif
+
 /* PlatformCodeName */
 enum {
     MFX_PLATFORM_UNKNOWN        = 0,
@@ -971,6 +971,13 @@ enum {
     MFX_EXTBUFF_AVC_SCALING_MATRIX              = MFX_MAKEFOURCC('A','V','S','M'),
     MFX_EXTBUFF_MPEG2_QUANT_MATRIX              = MFX_MAKEFOURCC('M','2','Q','M'),
     MFX_EXTBUFF_TASK_DEPENDENCY                 = MFX_MAKEFOURCC('S','Y','N','C'),
+    MFX_EXTBUFF_BITSTREAM_FRAGMENTS             = MFX_MAKEFOURCC('B','S','F','G'),
+    MFX_EXTBUFF_CODED_BUFFER_REF                = MFX_MAKEFOURCC('C','B','R','F'),
+    MFX_EXTBUFF_ENCODE_STAGE_LATENCY            = MFX_MAKEFOURCC('E','S','L','T'),
+    MFX_EXTBUFF_ENCODE_STAGE_LATENCY_STAT       = MFX_MAKEFOURCC('E','S','L','S'),
+    MFX_EXTBUFF_VPP_EXECUTION                   = MFX_MAKEFOURCC('V','E','X','E'),
+    MFX_EXTBUFF_DECODE_PRE_SPLIT                = MFX_MAKEFOURCC('D','P','S','P'),
+    MFX_EXTBUFF_AV1_FILM_GRAIN_SYNTHESIS        = MFX_MAKEFOURCC('A','1','F','S'),
 #endif
 #if (MFX_VERSION >= 1031)
     MFX_EXTBUFF_PARTIAL_BITSTREAM_PARAM         = MFX_MAKEFOURCC('P','B','O','P'),
@@ -1867,6 +1874,138 @@ MFX_PACK_END()
 
 #endif
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+/* One piece of a scattered bitstream, see mfxExtBitstreamFragments */
+MFX_PACK_BEGIN_STRUCT_W_PTR()
+typedef struct {
+    mfxU8*          Data;
+    mfxU32          DataLength;
+    mfxU32          reserved[3];
+} mfxBitstreamFragment;
+MFX_PACK_END()
+
+/* Attached to mfxBitstream for decode: the input is the concatenation of Fragments[] instead of Data.
+   mfxBitstream::DataOffset and DataLength address the concatenated stream, MaxLength is ignored.
+   Release() is called once per fragment when the library no longer references its memory, fragments ending before
+   DataOffset included. NumReleased counts leading fragments already given back, it is updated by the library and
+   must be set to 0 when the list is filled. */
+MFX_PACK_BEGIN_STRUCT_W_PTR()
+typedef struct {
+    mfxExtBuffer            Header;
+
+    mfxU16                  NumFragments;
+    mfxU16                  NumReleased;
+    mfxU16                  reserved1[2];
+    mfxBitstreamFragment*   Fragments;
+
+    mfxHDL                  pthis;
+    void                    (MFX_CDECL *Release)(mfxHDL pthis, mfxBitstreamFragment *fragment);
+
+    mfxU32                  reserved[16];
+} mfxExtBitstreamFragments;
+MFX_PACK_END()
+
+/* Attached to mfxVideoParam at AVC/HEVC decoder Init: with Mode equal to MFX_CODINGOPTION_ON DecodeFrameAsync
+   copies the input and returns, NAL units are split ahead on a dedicated thread. MaxQueueSize limits the input
+   queued ahead in bytes, 0 lets the decoder choose. When MFX_ERR_INCOMPATIBLE_VIDEO_PARAM is returned the queued
+   input is put back into mfxBitstream before DataOffset, or moved to the head of Data, so MaxLength must leave
+   room for it. Not supported with mfxExtBitstreamFragments. */
+MFX_PACK_BEGIN_USUAL_STRUCT()
+typedef struct {
+    mfxExtBuffer    Header;
+
+    mfxU16          Mode;
+    mfxU16          reserved1;
+    mfxU32          MaxQueueSize;
+    mfxU32          reserved[14];
+} mfxExtDecodePreSplit;
+MFX_PACK_END()
+
+/* Attached to mfxVideoParam at AV1 decoder Init: with Mode equal to MFX_CODINGOPTION_ON film grain is synthesized
+   on the CPU by the session threads from the reconstructed frame instead of by the driver. The result is bit-exact
+   with the AV1 specification, mfxInfoMFX::FilmGrain still turns film grain off. Only NV12 and P010 output is supported. */
+MFX_PACK_BEGIN_USUAL_STRUCT()
+typedef struct {
+    mfxExtBuffer    Header;
+
+    mfxU16          Mode;
+    mfxU16          reserved[11];
+} mfxExtAV1FilmGrainSynthesis;
+MFX_PACK_END()
+
+/* Zero-copy encoder output.
+   Attached to mfxVideoParam at Init: NumHeldBuffers is the number of coded buffers the application
+   may hold at once, the encoder allocates that many extra ones. 0 disables the mode.
+   Attached to mfxBitstream in EncodeFrameAsync: when the frame can be output without patching,
+   Data points to the mapped coded buffer after sync, Referenced is set to MFX_CODINGOPTION_ON and the
+   application must call Release() to give the buffer back and restore its own Data and MaxLength.
+   Otherwise the frame is copied into Data as usual and Referenced is set to MFX_CODINGOPTION_OFF.
+   A referenced bitstream may be held across Reset, it must be released before Close. */
+MFX_PACK_BEGIN_STRUCT_W_PTR()
+typedef struct {
+    mfxExtBuffer    Header;
+
+    mfxU16          NumHeldBuffers;
+    mfxU16          Referenced;
+    mfxU16          reserved1[2];
+
+    mfxU8*          SavedData;
+    mfxU32          SavedMaxLength;
+    mfxU32          reserved2;
+
+    mfxHDL          pthis;
+    mfxStatus       (MFX_CDECL *Release)(mfxHDL pthis, mfxBitstream *bs);
+
+    mfxU32          reserved[14];
+} mfxExtCodedBufferRef;
+MFX_PACK_END()
+
+/* Encoder pipeline stages reported by mfxExtEncodeStageLatency. Stages not used by the
+   current configuration are skipped. */
+enum {
+    MFX_ENCODE_STAGE_ACCEPT     = 0, /* accepted by EncodeFrameAsync, waiting for the async part */
+    MFX_ENCODE_STAGE_SCD        = 1, /* scene change detection and pre-encode analysis */
+    MFX_ENCODE_STAGE_MCTF       = 2, /* motion compensated temporal filter */
+    MFX_ENCODE_STAGE_REORDER    = 3, /* waiting in the reordering buffer */
+    MFX_ENCODE_STAGE_LOOKAHEAD  = 4,
+    MFX_ENCODE_STAGE_HISTOGRAM  = 5,
+    MFX_ENCODE_STAGE_READY      = 6, /* waiting for submission to the hardware */
+    MFX_ENCODE_STAGE_ENCODE     = 7, /* submitted, until the coded frame is queried */
+    MFX_ENCODE_STAGE_NUM        = 8
+};
+
+/* Attached to mfxBitstream in EncodeFrameAsync: after sync, EnterTime[] holds the time the frame
+   entered each stage and Latency[] the time spent there, DoneTime is the time the coded frame
+   became ready. Times are in microseconds of a monotonic clock, 0 for skipped stages. */
+MFX_PACK_BEGIN_STRUCT_W_L_TYPE()
+typedef struct {
+    mfxExtBuffer    Header;
+
+    mfxU64          EnterTime[16];
+    mfxU64          DoneTime;
+    mfxU32          Latency[16];
+
+    mfxU32          reserved[14];
+} mfxExtEncodeStageLatency;
+MFX_PACK_END()
+
+/* Attached to mfxVideoParam in GetVideoParam: per stage latency histograms over all frames
+   output since Init. Histogram[s][b] counts frames that spent [2^b, 2^(b+1)) microseconds
+   in stage s, the first bin also counts shorter and the last bin longer latencies. */
+MFX_PACK_BEGIN_STRUCT_W_L_TYPE()
+typedef struct {
+    mfxExtBuffer    Header;
+
+    mfxU32          NumFrame;
+    mfxU32          reserved1;
+    mfxU64          TotalLatency[16];
+    mfxU32          Histogram[16][24];
+
+    mfxU32          reserved[30];
+} mfxExtEncodeStageLatencyStat;
+MFX_PACK_END()
+#endif
+
 MFX_PACK_BEGIN_USUAL_STRUCT()
 typedef struct {
     mfxExtBuffer Header;
@@ -2109,6 +2248,27 @@ typedef struct {
 } mfxExtVPPScaling;
 MFX_PACK_END()
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+/* VPP execution mode */
+enum {
+    MFX_VPP_EXECUTION_AUTO = 0, /* GPU; system memory processing falls back to the CPU when the GPU pipeline can't be created */
+    MFX_VPP_EXECUTION_GPU  = 1,
+    MFX_VPP_EXECUTION_CPU  = 2  /* system memory only: crop, resize, color conversion and composition */
+};
+
+/* Attached to mfxVideoParam in Init/Query/QueryIOSurf to choose where VPP runs. The CPU path splits
+   every output frame in row tiles processed by the session threads, QueryIOSurf and Init return
+   MFX_WRN_PARTIAL_ACCELERATION when it is used. */
+MFX_PACK_BEGIN_USUAL_STRUCT()
+typedef struct {
+    mfxExtBuffer Header;
+
+    mfxU16 Mode;
+    mfxU16 reserved[11];
+} mfxExtVPPExecution;
+MFX_PACK_END()
+#endif
+
 #if (MFX_VERSION >= MFX_VERSION_NEXT)
 
 /* SceneChangeType */
@@ -79,6 +79,13 @@ EXTBUF(mfxExtInsertHeaders               , MFX_EXTBUFF_INSERT_HEADERS
 #if (MFX_VERSION >= MFX_VERSION_NEXT)
 EXTBUF(mfxExtAVCScalingMatrix            , MFX_EXTBUFF_AVC_SCALING_MATRIX              )
 EXTBUF(mfxExtDPB                         , MFX_EXTBUFF_DPB                             )
+EXTBUF(mfxExtCodedBufferRef              , MFX_EXTBUFF_CODED_BUFFER_REF                )
+EXTBUF(mfxExtEncodeStageLatency          , MFX_EXTBUFF_ENCODE_STAGE_LATENCY            )
+EXTBUF(mfxExtEncodeStageLatencyStat      , MFX_EXTBUFF_ENCODE_STAGE_LATENCY_STAT       )
+EXTBUF(mfxExtVPPExecution                , MFX_EXTBUFF_VPP_EXECUTION                   )
+EXTBUF(mfxExtDecodePreSplit              , MFX_EXTBUFF_DECODE_PRE_SPLIT                )
+EXTBUF(mfxExtAV1FilmGrainSynthesis       , MFX_EXTBUFF_AV1_FILM_GRAIN_SYNTHESIS        )
+EXTBUF(mfxExtBitstreamFragments          , MFX_EXTBUFF_BITSTREAM_FRAGMENTS             )
 #endif
 #endif //defined(__MFXSTRUCTURES_H__)
 
@@ -125,6 +132,10 @@ EXTBUF(mfxExtCamPipeControl         , MFX_EXTBUF_CAM_PIPECONTROL             )
 #if defined(__MFXCOMMON_H__)
 // Threading API
 EXTBUF(mfxExtThreadsParam           , MFX_EXTBUFF_THREADS_PARAM)
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+EXTBUF(mfxExtDeviceBusyWait         , MFX_EXTBUFF_DEVICE_BUSY_WAIT)
+EXTBUF(mfxExtSysMemFramePool        , MFX_EXTBUFF_SYSMEM_FRAME_POOL)
+#endif
 #endif //defined(__MFXCOMMON_H__)
 
 #if defined(__MFXSC_H__)
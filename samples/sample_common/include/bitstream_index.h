@@ -0,0 +1,68 @@
+/******************************************************************************\
+Copyright (c) 2005-2020, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef __BITSTREAM_INDEX_H__
+#define __BITSTREAM_INDEX_H__
+
+#include <stdio.h>
+#include <vector>
+
+#include "mfxdefs.h"
+#include "vm/strings_defs.h"
+
+// Random access point of an input file
+struct sBitstreamIndexEntry
+{
+    mfxU64 offset;      // of the access unit (with its AUD, parameter sets and SEI) or of the IVF frame header
+    mfxU64 paramOffset; // of the parameter sets to send before the access unit if it doesn't carry them
+    mfxU32 paramSize;   // 0 if the access unit carries its own parameter sets
+    mfxU32 frame;       // output order number of the first frame decoded from this point
+    mfxU64 timeStamp;   // IVF frame time stamp, 0 for elementary streams
+};
+
+// Index of the random access points (H.264 IDR, HEVC IRAP, VPx/AV1 key frames)
+// of an elementary stream or IVF file. The file is scanned once, the result is
+// kept in the "<file>.idx" sidecar and reused while the file size is the same.
+class CBitstreamIndex
+{
+public:
+
+    // Loads the sidecar index of the file or scans the file and saves it
+    mfxStatus Open(const msdk_char *strFileName, mfxU32 codecId);
+
+    mfxStatus Build(const msdk_char *strFileName, mfxU32 codecId);
+    mfxStatus Load(const msdk_char *strIndexName, mfxU32 codecId, mfxU64 fileSize);
+    mfxStatus Save(const msdk_char *strIndexName) const;
+
+    // Returns the last random access point at or before the output frame, NULL if there is none
+    const sBitstreamIndexEntry* Find(mfxU32 frame) const;
+
+    const std::vector<sBitstreamIndexEntry>& GetEntries() const { return m_entries; }
+
+protected:
+
+    mfxStatus ScanNalUnits(FILE *pFile, bool bHevc);
+    mfxStatus ScanIVF(FILE *pFile);
+
+    mfxU32                            m_codecId  = 0;
+    mfxU64                            m_fileSize = 0;
+    std::vector<sBitstreamIndexEntry> m_entries;
+};
+
+#endif //__BITSTREAM_INDEX_H__
@@ -0,0 +1,121 @@
+/******************************************************************************\
+Copyright (c) 2020, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef __BRC_TRACE_H__
+#define __BRC_TRACE_H__
+
+#include "sample_defs.h"
+
+#if (MFX_VERSION >= 1024)
+#include "mfxbrc.h"
+#include <vector>
+#include <stdio.h>
+
+/*
+Trace of external BRC activity captured from a real encode.
+File layout: BRCTraceHeader followed by BRCTraceFrame records in encoding order.
+Every encode pass of a frame (first encode and recodes) is kept as (QP, size) pair,
+it is the model of coded frame size as a function of QP used to replay the trace
+against any BRC implementation.
+*/
+
+#define BRC_TRACE_MAGIC       MFX_MAKEFOURCC('B','R','C','T')
+#define BRC_TRACE_VERSION     1
+#define BRC_TRACE_MAX_PASSES  8
+
+struct BRCTracePass
+{
+    mfxI32 QpY;
+    mfxU32 CodedFrameSize;
+};
+
+struct BRCTraceFrame
+{
+    mfxU32       EncodedOrder;
+    mfxU32       DisplayOrder;
+    mfxU16       FrameType;
+    mfxU16       PyramidLayer;
+    mfxU16       SceneChange;
+    mfxU16       LongTerm;
+    mfxU32       FrameCmplx;
+    mfxU16       BRCStatus;     // status of the last pass
+    mfxU16       NumPasses;
+    BRCTracePass Passes[BRC_TRACE_MAX_PASSES];
+
+    // Coded size of the frame if it was encoded with given QP
+    mfxU32 GetSize(mfxI32 qp) const;
+};
+
+struct BRCTraceHeader
+{
+    mfxU32              Magic;
+    mfxU32              Version;
+    mfxInfoMFX          mfx;
+    mfxExtCodingOption  CO;
+    mfxExtCodingOption2 CO2;
+    mfxExtCodingOption3 CO3;
+};
+
+class BRCTrace
+{
+public:
+    BRCTraceHeader             Header;
+    std::vector<BRCTraceFrame> Frames;
+
+    BRCTrace();
+
+    mfxStatus Load(const msdk_char* fileName);
+
+    // Fills par with parameters of recorded encode, ext buffers point to Header
+    void GetVideoParam(mfxVideoParam& par, std::vector<mfxExtBuffer*>& extParam);
+};
+
+/*
+Records calls of application mfxExtBRC. Attach() substitutes callbacks in mfxExtBRC
+with own ones, original callbacks are called through, so recorder can wrap any BRC.
+*/
+class BRCTraceRecorder
+{
+public:
+    BRCTraceRecorder();
+    ~BRCTraceRecorder();
+
+    mfxStatus Attach(mfxExtBRC& brc, const msdk_char* fileName);
+    void      Detach(mfxExtBRC& brc);
+
+protected:
+    static mfxStatus MFX_CDECL Init        (mfxHDL pthis, mfxVideoParam* par);
+    static mfxStatus MFX_CDECL Reset       (mfxHDL pthis, mfxVideoParam* par);
+    static mfxStatus MFX_CDECL Close       (mfxHDL pthis);
+    static mfxStatus MFX_CDECL GetFrameCtrl(mfxHDL pthis, mfxBRCFrameParam* par, mfxBRCFrameCtrl* ctrl);
+    static mfxStatus MFX_CDECL Update      (mfxHDL pthis, mfxBRCFrameParam* par, mfxBRCFrameCtrl* ctrl, mfxBRCFrameStatus* status);
+
+    mfxStatus WriteHeader(mfxVideoParam* par);
+    void      WriteFrame();
+
+    mfxExtBRC     m_brc;       // wrapped BRC
+    msdk_string   m_fileName;
+    FILE*         m_file;
+    BRCTraceFrame m_frame;
+    bool          m_bFrameStarted;
+    bool          m_bFrameSkipped;
+};
+
+#endif // #if (MFX_VERSION >= 1024)
+#endif // __BRC_TRACE_H__
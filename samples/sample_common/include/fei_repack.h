@@ -0,0 +1,112 @@
+/******************************************************************************\
+Copyright (c) 2020, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+
+#ifndef __FEI_REPACK_H__
+#define __FEI_REPACK_H__
+
+#include "sample_defs.h"
+#include "sample_utils.h"
+#include "mfxfei.h"
+#if (MFX_VERSION >= 1027)
+#include "mfxfeihevc.h"
+#endif
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+/*
+Kernels shared by FEI samples to repack PreENC / DecodeStreamOut output into encoder input buffers.
+Every kernel processes a range of rows and rows don't depend on each other, so a frame may be
+split between threads with RowParallel. SSE2 is used when available, results are bit-exact
+with the scalar code.
+*/
+
+// Calls fn(begin, end) for slices of rows [0, numRows) on the calling thread and numThreads - 1
+// workers, returns when all slices are done. Slice boundaries are multiples of 'align' rows.
+class RowParallel
+{
+public:
+    explicit RowParallel(mfxU32 numThreads = 1);
+    ~RowParallel();
+
+    mfxU32 GetNumThreads() const { return (mfxU32)m_workers.size() + 1; }
+
+    void Run(mfxU32 numRows, mfxU32 align, const std::function<void(mfxU32, mfxU32)>& fn);
+
+private:
+    void WorkerLoop();
+    void RunSlices();
+
+    std::vector<std::thread>                   m_workers;
+    std::mutex                                 m_mutex;
+    std::condition_variable                    m_start;
+    std::condition_variable                    m_done;
+    const std::function<void(mfxU32, mfxU32)>* m_fn;
+    mfxU32                                     m_numRows;
+    mfxU32                                     m_sliceRows;
+    mfxU32                                     m_numSlices;
+    std::atomic<mfxU32>                        m_nextSlice;
+    mfxU32                                     m_busy;  // workers which haven't finished current job
+    mfxU64                                     m_job;   // incremented to wake up workers
+    bool                                       m_stop;
+
+    DISALLOW_COPY_AND_ASSIGN(RowParallel);
+};
+
+// Average of non-intra MVs over 'count' (4 or 16) consequent MV pairs, separately for L0 and L1.
+// If all MVs of a list are intra the first one is returned.
+void FeiSelectFromMV(const mfxI16Pair (*mv)[2], mfxI32 count, mfxI16Pair (&res)[2]);
+
+// Copies MVs of 8x8 blocks to all 4x4 sub-blocks (DecodeStreamOut -> ENC MV layout)
+void FeiBroadcastMV8x8(const mfxI16Pair (&mv8x8)[4][2], mfxI16Pair (&mv4x4)[16][2]);
+
+#if (MFX_VERSION >= 1027)
+struct FeiHevcMvpRepackPar
+{
+    mfxU32 WidthCU_enc;   // 16x16 blocks of encoded frame
+    mfxU32 HeightCU_enc;
+    mfxU32 WidthCU_ds;    // 16x16 blocks of PreENC (possibly downsampled) frame
+    mfxU32 HeightCU_ds;
+    mfxU8  DSPower2;      // 0..3
+    mfxU8  NumPredPairs;  // 1..4
+    mfxU8  NumL0;         // valid L0 and L1 predictors, quality mode ignores distortion of others
+    mfxU8  NumL1;
+    bool   Ldb;           // duplicate first L0 predictor to first L1 slot, performance mode only
+    mfxU8  RefL0[4];
+    mfxU8  RefL1[4];
+
+    const mfxExtFeiPreEncMV::mfxExtFeiPreEncMVMB*         MV[4];
+    const mfxExtFeiPreEncMBStat::mfxExtFeiPreEncMBStatMB* MB[4]; // quality mode only
+};
+
+// Disables blocks [begin, end) of MVP buffer
+void FeiHevcDisableMVP(mfxExtFeiHevcEncMVPredictors& mvp, mfxU32 begin, mfxU32 end);
+
+// Fills MVP blocks of 16x16 rows [rowBegin, rowEnd). Blocks are in 32x32 layout, so slices should
+// start at even rows to keep threads on separate cache lines.
+void FeiHevcRepackMVPPerformance(const FeiHevcMvpRepackPar& par, mfxExtFeiHevcEncMVPredictors& mvp, mfxU32 rowBegin, mfxU32 rowEnd);
+void FeiHevcRepackMVPQuality(const FeiHevcMvpRepackPar& par, mfxExtFeiHevcEncMVPredictors& mvp, mfxU32 rowBegin, mfxU32 rowEnd);
+#endif // MFX_VERSION >= 1027
+
+#endif // __FEI_REPACK_H__
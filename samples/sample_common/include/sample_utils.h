@@ -52,6 +52,7 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include "abstract_splitter.h"
 #include "avc_bitstream.h"
 #include "avc_spl.h"
+#include "bitstream_index.h"
 #include "avc_headers.h"
 #include "avc_nal_spl.h"
 
@@ -256,6 +257,11 @@ template<>struct mfx_ext_buffer_id<mfxExtAVCRefListCtrl>{
 template<>struct mfx_ext_buffer_id<mfxExtThreadsParam>{
     enum {id = MFX_EXTBUFF_THREADS_PARAM};
 };
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+template<>struct mfx_ext_buffer_id<mfxExtSysMemFramePool>{
+    enum {id = MFX_EXTBUFF_SYSMEM_FRAME_POOL};
+};
+#endif
 template<>struct mfx_ext_buffer_id<mfxExtFeiParam> {
     enum {id = MFX_EXTBUFF_FEI_PARAM};
 };
@@ -850,10 +856,13 @@ public :
     virtual void      Close();
     virtual mfxStatus Init(const msdk_char *strFileName);
     virtual mfxStatus ReadNextFrame(mfxBitstream *pBS);
+    //moves position to the random access point, its parameter sets are returned ahead of it
+    virtual mfxStatus Seek(const sBitstreamIndexEntry& entry);
 
 protected:
     FILE*     m_fSource;
     bool      m_bInited;
+    std::vector<mfxU8> m_headers; // parameter sets to return before the file data
 };
 
 class CH264FrameReader : public CSmplBitstreamReader
@@ -866,6 +875,7 @@ public:
     virtual void      Close();
     virtual mfxStatus Init(const msdk_char *strFileName);
     virtual mfxStatus ReadNextFrame(mfxBitstream *pBS);
+    virtual mfxStatus Seek(const sBitstreamIndexEntry& entry);
 
 private:
     mfxBitstream *m_processedBS;
@@ -1364,6 +1374,9 @@ template<typename T>
         return msdk_opt_read(string.c_str(), value);
     }
 
+// Parses list of CPUs in "0-3,8,10-11" form (same as Linux cpulist)
+mfxStatus msdk_parse_cpu_list(const msdk_char* string, std::vector<mfxU32>& cpus);
+
 mfxStatus StrFormatToCodecFormatFourCC(msdk_char* strInput, mfxU32 &codecFormat);
 msdk_string StatusToString(mfxStatus sts);
 mfxI32 getMonitorType(msdk_char* str);
@@ -23,6 +23,8 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include <stdlib.h>
 #include "base_allocator.h"
 #include <vector>
+#include <map>
+#include <mutex>
 
 struct sBuffer
 {
@@ -40,8 +42,60 @@ struct sFrame
 struct SysMemAllocatorParams : mfxAllocatorParams
 {
     SysMemAllocatorParams()
-        : mfxAllocatorParams(), pBufferAllocator(NULL) { }
+        : mfxAllocatorParams(), pBufferAllocator(NULL), bFirstTouch(false), bUseFramePool(false), nFramePoolBudget(0) { }
     MFXBufferAllocator *pBufferAllocator;
+    // write surfaces right at allocation, so pages are placed on NUMA node of allocating thread
+    bool bFirstTouch;
+    // take surfaces from SysMemFramePool instead of heap (own buffer allocator only)
+    bool bUseFramePool;
+    // limit of memory mapped by SysMemFramePool in bytes, 0 - no limit
+    size_t nFramePoolBudget;
+};
+
+// Process-wide pool of large system memory blocks.
+// Blocks of one size are carved from 2MB aligned slabs (hugetlb pages if the system
+// has them reserved, transparent hugepages otherwise) and go back to the pool on
+// Free, so surfaces of the same resolution are reused across Close/Init without
+// faulting pages in again. The pool never maps more than its budget: Alloc returns
+// NULL instead and the caller falls back to the heap.
+class SysMemFramePool
+{
+public:
+    static SysMemFramePool& Instance();
+
+    void*  Alloc(size_t nbytes);
+    // returns false if ptr wasn't allocated by the pool
+    bool   Free(void* ptr);
+    void   SetBudget(size_t nbytes);
+    // unmaps slabs which have no blocks in use
+    void   Trim();
+    size_t GetMappedSize();
+
+private:
+    struct Slab
+    {
+        mfxU8*              base;
+        size_t              size;
+        size_t              blockSize;
+        mfxU32              numUsed;
+        std::vector<mfxU8*> idle;
+    };
+
+    SysMemFramePool();
+    ~SysMemFramePool() = delete;
+
+    Slab*  CreateSlab(size_t blockSize);
+    void   DestroySlab(Slab* slab);
+    size_t ReleaseIdleSlabs(size_t nbytes);
+
+    std::mutex                            m_mutex;
+    size_t                                m_budget;
+    size_t                                m_mapped;
+    std::map<size_t, std::vector<Slab*> > m_classes; // block size -> slabs
+    std::map<mfxU8*, Slab*>               m_slabs;   // slab base -> slab
+
+    SysMemFramePool(const SysMemFramePool&);
+    SysMemFramePool& operator=(const SysMemFramePool&);
 };
 
 class SysMemFrameAllocator: public BaseFrameAllocator
@@ -64,6 +118,8 @@ protected:
 
     MFXBufferAllocator *m_pBufferAllocator;
     bool m_bOwnBufferAllocator;
+    bool m_bFirstTouch;
+    bool m_bUseFramePool;
 
     std::vector<mfxFrameAllocResponse *> m_vResp;
 
@@ -73,12 +129,15 @@ protected:
 class SysMemBufferAllocator : public MFXBufferAllocator
 {
 public:
-    SysMemBufferAllocator();
+    SysMemBufferAllocator(bool bUseFramePool = false);
     virtual ~SysMemBufferAllocator();
     virtual mfxStatus AllocBuffer(mfxU32 nbytes, mfxU16 type, mfxMemId *mid);
     virtual mfxStatus LockBuffer(mfxMemId mid, mfxU8 **ptr);
     virtual mfxStatus UnlockBuffer(mfxMemId mid);
     virtual mfxStatus FreeBuffer(mfxMemId mid);
+
+protected:
+    bool m_bUseFramePool;
 };
 
 #endif // __SYSMEM_ALLOCATOR_H__
\ No newline at end of file
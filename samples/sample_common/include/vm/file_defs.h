@@ -29,12 +29,18 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #define MSDK_FOPEN(file, name, mode) _tfopen_s(&file, name, mode)
 
 #define msdk_fgets  _fgetts
+
+#define MSDK_FSEEK(file, offset, origin) _fseeki64(file, offset, origin)
+#define MSDK_FTELL(file) _ftelli64(file)
 #else // #if defined(_WIN32) || defined(_WIN64)
 #include <unistd.h>
 
 #define MSDK_FOPEN(file, name, mode) !(file = fopen(name, mode))
 
 #define msdk_fgets  fgets
+
+#define MSDK_FSEEK(file, offset, origin) fseeko(file, offset, origin)
+#define MSDK_FTELL(file) ftello(file)
 #endif // #if defined(_WIN32) || defined(_WIN64)
 
 #endif // #ifndef __FILE_DEFS_H__
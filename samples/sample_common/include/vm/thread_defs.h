@@ -20,6 +20,8 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #ifndef __THREAD_DEFS_H__
 #define __THREAD_DEFS_H__
 
+#include <vector>
+
 #include "mfxdefs.h"
 #include "vm/strings_defs.h"
 
@@ -151,4 +153,11 @@ mfxStatus msdk_setrlimit_vmem(mfxU64 size);
 mfxStatus msdk_thread_get_schedtype(const msdk_char*, mfxI32 &type);
 void msdk_thread_printf_scheduling_help();
 
+// nodes[i] - CPUs of NUMA node i which process is allowed to run on (may be empty).
+// CPUs are ordered by physical core, so hardware threads of one core are adjacent.
+mfxStatus msdk_get_numa_nodes(std::vector<std::vector<mfxU32> >& nodes);
+// Affinity of calling thread as list of logical CPU numbers
+mfxStatus msdk_thread_get_affinity(std::vector<mfxU32>& cpus);
+mfxStatus msdk_thread_set_affinity(const std::vector<mfxU32>& cpus);
+
 #endif //__THREAD_DEFS_H__
@@ -0,0 +1,423 @@
+/******************************************************************************\
+Copyright (c) 2005-2020, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#include "mfx_samples_config.h"
+
+#include <algorithm>
+
+#include "bitstream_index.h"
+#include "sample_defs.h"
+#include "mfxvp8.h"
+
+#define BITSTREAM_INDEX_VERSION 1
+
+namespace
+{
+    const mfxU64 INVALID_OFFSET = mfxU64(-1);
+
+    enum
+    {
+        NAL_HEADER_BYTES = 3, // HEVC NAL unit header + first byte of slice segment header
+        IVF_PEEK_BYTES   = 64 // enough for VPx frame tags and AV1 TD + sequence header OBU headers
+    };
+
+    struct NalUnitInfo
+    {
+        bool vcl;
+        bool firstInPicture;
+        bool randomAccess;
+        bool skippedLeading; // HEVC RASL, not decodable after seeking to the associated IRAP
+        bool parameterSet;
+        bool startsAccessUnit; // non-VCL unit which may only precede the first VCL unit of an AU
+        bool ignore;
+    };
+
+    NalUnitInfo ParseAvcNalUnitHeader(const mfxU8 *header)
+    {
+        NalUnitInfo info = {};
+        mfxU8 type = header[0] & 0x1f;
+
+        info.vcl              = type >= 1 && type <= 5;
+        info.firstInPicture   = info.vcl && (header[1] & 0x80); // first_mb_in_slice == 0
+        info.randomAccess     = type == 5;
+        info.parameterSet     = type == 7 || type == 8 || type == 13 || type == 15;
+        info.startsAccessUnit = (type >= 6 && type <= 9) || (type >= 13 && type <= 18);
+        return info;
+    }
+
+    NalUnitInfo ParseHevcNalUnitHeader(const mfxU8 *header)
+    {
+        NalUnitInfo info = {};
+        mfxU8 type    = (header[0] >> 1) & 0x3f;
+        mfxU8 layerId = ((header[0] & 1) << 5) | (header[1] >> 3);
+
+        info.ignore           = layerId != 0;
+        info.vcl              = type < 32;
+        info.firstInPicture   = info.vcl && (header[2] & 0x80); // first_slice_segment_in_pic_flag
+        info.randomAccess     = type >= 16 && type <= 21;
+        info.skippedLeading   = type == 8 || type == 9;
+        info.parameterSet     = type >= 32 && type <= 34;
+        info.startsAccessUnit = (type >= 32 && type <= 35) || type == 39 || (type >= 41 && type <= 44) || (type >= 48 && type <= 55);
+        return info;
+    }
+
+    bool IsVP8KeyFrame(const mfxU8 *data, mfxU32 size)
+    {
+        // frame tag: key_frame is 0 for key frames
+        return size >= 3 && !(data[0] & 1);
+    }
+
+    bool IsVP9KeyFrame(const mfxU8 *data, mfxU32 size)
+    {
+        if (!size || (data[0] >> 6) != 2) // frame_marker
+            return false;
+
+        mfxU32 profile = ((data[0] >> 5) & 1) | (((data[0] >> 4) & 1) << 1);
+        mfxU32 bit = profile == 3 ? 5 : 4; // reserved_zero follows profile 3
+
+        bool showExistingFrame = (data[0] >> (7 - bit)) & 1;
+        bool nonKeyFrame       = (data[0] >> (6 - bit)) & 1;
+        return !showExistingFrame && !nonKeyFrame;
+    }
+
+    bool IsAV1KeyFrame(const mfxU8 *data, mfxU32 size)
+    {
+        // temporal units starting a coded video sequence carry the sequence header
+        for (mfxU32 pos = 0; pos < size;)
+        {
+            mfxU8 obuType = (data[pos] >> 3) & 0xf;
+            bool  hasExtension = (data[pos] >> 2) & 1;
+            bool  hasSize = (data[pos] >> 1) & 1;
+
+            if (obuType == 1) // OBU_SEQUENCE_HEADER
+                return true;
+            if (obuType == 3 || obuType == 4 || obuType == 6 || !hasSize) // frame header, frame
+                return false;
+
+            pos += 1 + hasExtension;
+
+            mfxU64 obuSize = 0;
+            for (mfxU32 i = 0; i < 8 && pos < size; ++i)
+            {
+                mfxU8 byte = data[pos++];
+                obuSize |= mfxU64(byte & 0x7f) << (7 * i);
+                if (!(byte & 0x80))
+                    break;
+            }
+            if (obuSize > size - pos)
+                return false;
+            pos += mfxU32(obuSize);
+        }
+        return false;
+    }
+}
+
+mfxStatus CBitstreamIndex::Open(const msdk_char *strFileName, mfxU32 codecId)
+{
+    MSDK_CHECK_POINTER(strFileName, MFX_ERR_NULL_PTR);
+
+    FILE *pFile = NULL;
+    MSDK_FOPEN(pFile, strFileName, MSDK_STRING("rb"));
+    MSDK_CHECK_POINTER(pFile, MFX_ERR_NULL_PTR);
+
+    MSDK_FSEEK(pFile, 0, SEEK_END);
+    mfxU64 fileSize = MSDK_FTELL(pFile);
+    fclose(pFile);
+
+    msdk_tstring strIndexName = msdk_tstring(strFileName) + MSDK_STRING(".idx");
+
+    if (MFX_ERR_NONE == Load(strIndexName.c_str(), codecId, fileSize))
+        return MFX_ERR_NONE;
+
+    mfxStatus sts = Build(strFileName, codecId);
+    MSDK_CHECK_STATUS(sts, "CBitstreamIndex::Build failed");
+
+    // the index is still usable if the sidecar can't be written
+    if (MFX_ERR_NONE != Save(strIndexName.c_str()))
+        msdk_printf(MSDK_STRING("WARNING: failed to save bitstream index to %s\n"), strIndexName.c_str());
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus CBitstreamIndex::Build(const msdk_char *strFileName, mfxU32 codecId)
+{
+    MSDK_CHECK_POINTER(strFileName, MFX_ERR_NULL_PTR);
+
+    FILE *pFile = NULL;
+    MSDK_FOPEN(pFile, strFileName, MSDK_STRING("rb"));
+    MSDK_CHECK_POINTER(pFile, MFX_ERR_NULL_PTR);
+
+    m_entries.clear();
+    m_codecId = codecId;
+
+    mfxStatus sts = MFX_ERR_NONE;
+    switch (codecId)
+    {
+    case MFX_CODEC_AVC:
+        sts = ScanNalUnits(pFile, false);
+        break;
+    case MFX_CODEC_HEVC:
+        sts = ScanNalUnits(pFile, true);
+        break;
+    case MFX_CODEC_VP8:
+    case MFX_CODEC_VP9:
+    case MFX_CODEC_AV1:
+        sts = ScanIVF(pFile);
+        break;
+    default:
+        sts = MFX_ERR_UNSUPPORTED;
+        break;
+    }
+
+    MSDK_FSEEK(pFile, 0, SEEK_END);
+    m_fileSize = MSDK_FTELL(pFile);
+    fclose(pFile);
+
+    return sts;
+}
+
+mfxStatus CBitstreamIndex::ScanNalUnits(FILE *pFile, bool bHevc)
+{
+    std::vector<mfxU8> buffer(1024 * 1024);
+    mfxU64 bufferOffset = 0;
+
+    const mfxU32 headerSize = bHevc ? 3 : 2;
+    mfxU8  header[NAL_HEADER_BYTES] = {};
+    mfxU32 headerBytes = headerSize; // no NAL unit header is pending
+    mfxU32 zeros = 0;
+    mfxU64 nalOffset = 0;
+
+    mfxU64 prefixOffset = INVALID_OFFSET; // of the non-VCL units preceding the next VCL unit
+    mfxU64 paramOffset = INVALID_OFFSET, paramEnd = INVALID_OFFSET;
+    bool   prevParameterSet = false, vclSinceParameterSets = true;
+    mfxU32 pictures = 0;
+
+    for (;;)
+    {
+        mfxU32 size = (mfxU32)fread(buffer.data(), 1, buffer.size(), pFile);
+        if (!size)
+            break;
+
+        for (mfxU32 i = 0; i < size; ++i)
+        {
+            mfxU8 byte = buffer[i];
+
+            if (headerBytes < headerSize)
+            {
+                header[headerBytes++] = byte;
+
+                if (headerBytes == headerSize)
+                {
+                    NalUnitInfo nal = bHevc ? ParseHevcNalUnitHeader(header) : ParseAvcNalUnitHeader(header);
+
+                    // parameter sets run till the start of the next NAL unit
+                    if (prevParameterSet)
+                        paramEnd = nalOffset;
+                    prevParameterSet = !nal.ignore && nal.parameterSet;
+
+                    if (nal.ignore)
+                    {
+                    }
+                    else if (!nal.vcl)
+                    {
+                        if (nal.parameterSet && vclSinceParameterSets)
+                        {
+                            paramOffset = nalOffset;
+                            vclSinceParameterSets = false;
+                        }
+                        if (nal.startsAccessUnit && prefixOffset == INVALID_OFFSET)
+                            prefixOffset = nalOffset;
+                    }
+                    else
+                    {
+                        mfxU64 auOffset = prefixOffset != INVALID_OFFSET ? prefixOffset : nalOffset;
+                        prefixOffset = INVALID_OFFSET;
+                        vclSinceParameterSets = true;
+
+                        if (nal.firstInPicture && nal.randomAccess)
+                        {
+                            sBitstreamIndexEntry entry = {};
+                            entry.offset = entry.paramOffset = auOffset;
+                            entry.frame = pictures;
+                            if (paramOffset != INVALID_OFFSET && paramOffset < auOffset)
+                            {
+                                entry.paramOffset = paramOffset;
+                                entry.paramSize = mfxU32(paramEnd - paramOffset);
+                            }
+                            m_entries.push_back(entry);
+                        }
+
+                        // pictures before the first random access point and the leading pictures
+                        // skipped after it aren't output when decoding from the start of the file
+                        if (nal.firstInPicture && !m_entries.empty() && !(nal.skippedLeading && m_entries.size() == 1))
+                        {
+                            if (nal.skippedLeading)
+                                m_entries.back().frame++;
+                            pictures++;
+                        }
+                    }
+                }
+            }
+
+            if (!byte)
+            {
+                zeros++;
+            }
+            else
+            {
+                if (byte == 1 && zeros >= 2)
+                {
+                    // start code, including leading zero_byte
+                    nalOffset = bufferOffset + i - std::min<mfxU32>(zeros, 3);
+                    headerBytes = 0;
+                }
+                zeros = 0;
+            }
+        }
+
+        bufferOffset += size;
+    }
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus CBitstreamIndex::ScanIVF(FILE *pFile)
+{
+    /* IVF file header: bytes 0-3 'DKIF', 4-5 version, 6-7 header length, 8-11 codec FourCC
+       frame header: bytes 0-3 frame size, 4-11 time stamp */
+    mfxU32 signature = 0;
+    mfxU16 version = 0, headerLength = 0;
+    MSDK_CHECK_NOT_EQUAL(fread(&signature, sizeof(signature), 1, pFile), 1, MFX_ERR_MORE_DATA);
+    MSDK_CHECK_NOT_EQUAL(fread(&version, sizeof(version), 1, pFile), 1, MFX_ERR_MORE_DATA);
+    MSDK_CHECK_NOT_EQUAL(fread(&headerLength, sizeof(headerLength), 1, pFile), 1, MFX_ERR_MORE_DATA);
+    MSDK_CHECK_NOT_EQUAL(MFX_MAKEFOURCC('D','K','I','F'), signature, MFX_ERR_UNSUPPORTED);
+
+    mfxU64 offset = headerLength;
+    mfxU8  data[IVF_PEEK_BYTES];
+
+    for (mfxU32 frame = 0;; ++frame)
+    {
+        mfxU32 frameSize = 0;
+        mfxU64 timeStamp = 0;
+
+        if (MSDK_FSEEK(pFile, offset, SEEK_SET) ||
+            fread(&frameSize, sizeof(frameSize), 1, pFile) != 1 ||
+            fread(&timeStamp, sizeof(timeStamp), 1, pFile) != 1)
+            break;
+
+        mfxU32 size = (mfxU32)fread(data, 1, std::min<mfxU32>(frameSize, sizeof(data)), pFile);
+
+        bool keyFrame =
+            m_codecId == MFX_CODEC_VP8 ? IsVP8KeyFrame(data, size) :
+            m_codecId == MFX_CODEC_VP9 ? IsVP9KeyFrame(data, size) :
+                                         IsAV1KeyFrame(data, size);
+        if (keyFrame)
+        {
+            sBitstreamIndexEntry entry = {};
+            entry.offset = entry.paramOffset = offset;
+            entry.frame = frame;
+            entry.timeStamp = timeStamp;
+            m_entries.push_back(entry);
+        }
+
+        offset += sizeof(frameSize) + sizeof(timeStamp) + frameSize;
+    }
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus CBitstreamIndex::Load(const msdk_char *strIndexName, mfxU32 codecId, mfxU64 fileSize)
+{
+    MSDK_CHECK_POINTER(strIndexName, MFX_ERR_NULL_PTR);
+
+    FILE *pFile = NULL;
+    MSDK_FOPEN(pFile, strIndexName, MSDK_STRING("r"));
+    if (!pFile)
+        return MFX_ERR_NOT_FOUND;
+
+    mfxStatus sts = MFX_ERR_NONE;
+    unsigned int version = 0, codec = 0;
+    unsigned long long size = 0;
+
+    if (fscanf(pFile, "MSDKIDX %u %x %llu", &version, &codec, &size) != 3 ||
+        version != BITSTREAM_INDEX_VERSION || codec != codecId || size != fileSize)
+        sts = MFX_ERR_NOT_FOUND; // stale or foreign index, has to be rebuilt
+
+    std::vector<sBitstreamIndexEntry> entries;
+    while (MFX_ERR_NONE == sts)
+    {
+        unsigned long long offset = 0, paramOffset = 0, timeStamp = 0;
+        unsigned int paramSize = 0, frame = 0;
+
+        int fields = fscanf(pFile, "%llu %llu %u %u %llu", &offset, &paramOffset, &paramSize, &frame, &timeStamp);
+        if (fields == EOF)
+            break;
+        if (fields != 5 || offset >= fileSize || paramOffset + paramSize > fileSize)
+        {
+            sts = MFX_ERR_NOT_FOUND;
+            break;
+        }
+
+        sBitstreamIndexEntry entry = {};
+        entry.offset = offset;
+        entry.paramOffset = paramOffset;
+        entry.paramSize = paramSize;
+        entry.frame = frame;
+        entry.timeStamp = timeStamp;
+        entries.push_back(entry);
+    }
+    fclose(pFile);
+
+    if (MFX_ERR_NONE == sts)
+    {
+        m_codecId = codecId;
+        m_fileSize = fileSize;
+        m_entries.swap(entries);
+    }
+    return sts;
+}
+
+mfxStatus CBitstreamIndex::Save(const msdk_char *strIndexName) const
+{
+    MSDK_CHECK_POINTER(strIndexName, MFX_ERR_NULL_PTR);
+
+    FILE *pFile = NULL;
+    MSDK_FOPEN(pFile, strIndexName, MSDK_STRING("w"));
+    MSDK_CHECK_POINTER(pFile, MFX_ERR_NULL_PTR);
+
+    bool ok = fprintf(pFile, "MSDKIDX %u %08x %llu\n", BITSTREAM_INDEX_VERSION, m_codecId, (unsigned long long)m_fileSize) > 0;
+
+    for (const sBitstreamIndexEntry& entry : m_entries)
+    {
+        ok = ok && fprintf(pFile, "%llu %llu %u %u %llu\n",
+            (unsigned long long)entry.offset, (unsigned long long)entry.paramOffset,
+            entry.paramSize, entry.frame, (unsigned long long)entry.timeStamp) > 0;
+    }
+
+    ok = !fclose(pFile) && ok;
+    return ok ? MFX_ERR_NONE : MFX_ERR_DEVICE_FAILED;
+}
+
+const sBitstreamIndexEntry* CBitstreamIndex::Find(mfxU32 frame) const
+{
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), frame,
+        [](mfxU32 f, const sBitstreamIndexEntry& entry) { return f < entry.frame; });
+
+    return it == m_entries.begin() ? NULL : &*(it - 1);
+}
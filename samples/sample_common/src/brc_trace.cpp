@@ -0,0 +1,315 @@
+/******************************************************************************\
+Copyright (c) 2020, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#include "brc_trace.h"
+#include "sample_utils.h"
+#include <math.h>
+#include <climits>
+#include <algorithm>
+
+#if (MFX_VERSION >= 1024)
+
+// Fallback for frames encoded with single QP: coded size halves every 6 QP steps
+#define BRC_TRACE_QP_PER_DOUBLING 6.0
+
+mfxU32 BRCTraceFrame::GetSize(mfxI32 qp) const
+{
+    BRCTracePass passes[BRC_TRACE_MAX_PASSES];
+    mfxU32 n = 0;
+
+    for (mfxU32 i = 0; i < std::min<mfxU32>(NumPasses, BRC_TRACE_MAX_PASSES); i++)
+    {
+        // skipped passes tell nothing about size/QP relation
+        if (Passes[i].CodedFrameSize)
+            passes[n++] = Passes[i];
+    }
+
+    if (!n)
+        return 0;
+
+    std::sort(passes, passes + n, [](const BRCTracePass& l, const BRCTracePass& r) { return l.QpY < r.QpY; });
+
+    // segment of the log-linear model: passes around qp, or the outermost pair
+    mfxU32 hi = (mfxU32)(std::lower_bound(passes, passes + n, qp, [](const BRCTracePass& p, mfxI32 q) { return p.QpY < q; }) - passes);
+    hi = std::min(std::max(hi, 1u), n - 1);
+    mfxU32 lo = hi ? hi - 1 : 0;
+
+    mfxF64 slope = log(2.0) / BRC_TRACE_QP_PER_DOUBLING;
+    if (passes[hi].QpY != passes[lo].QpY)
+    {
+        mfxF64 measured = log((mfxF64)passes[lo].CodedFrameSize / passes[hi].CodedFrameSize) / (passes[hi].QpY - passes[lo].QpY);
+        // keep model sane when size hardly changes with QP (e.g. padded or very small frames)
+        slope = std::min(std::max(measured, slope / 2), slope * 2);
+    }
+
+    const BRCTracePass& ref = (abs(passes[lo].QpY - qp) <= abs(passes[hi].QpY - qp)) ? passes[lo] : passes[hi];
+    mfxF64 size = ref.CodedFrameSize * exp(slope * (ref.QpY - qp));
+
+    return (mfxU32)std::min<mfxF64>(std::max<mfxF64>(size, 1.0), (mfxF64)UINT_MAX);
+}
+
+BRCTrace::BRCTrace()
+    : Header()
+{
+}
+
+mfxStatus BRCTrace::Load(const msdk_char* fileName)
+{
+    MSDK_CHECK_POINTER(fileName, MFX_ERR_NULL_PTR);
+
+    FILE* file = NULL;
+    MSDK_FOPEN(file, fileName, MSDK_STRING("rb"));
+    MSDK_CHECK_POINTER(file, MFX_ERR_NOT_FOUND);
+
+    Frames.clear();
+
+    if (1 != fread(&Header, sizeof(Header), 1, file) || Header.Magic != BRC_TRACE_MAGIC || Header.Version != BRC_TRACE_VERSION)
+    {
+        fclose(file);
+        msdk_printf(MSDK_STRING("ERROR: %s is not a BRC trace\n"), fileName);
+        return MFX_ERR_UNSUPPORTED;
+    }
+
+    BRCTraceFrame frame = {};
+    while (1 == fread(&frame, sizeof(frame), 1, file))
+    {
+        frame.NumPasses = std::min<mfxU16>(frame.NumPasses, BRC_TRACE_MAX_PASSES);
+        Frames.push_back(frame);
+    }
+
+    fclose(file);
+    return MFX_ERR_NONE;
+}
+
+void BRCTrace::GetVideoParam(mfxVideoParam& par, std::vector<mfxExtBuffer*>& extParam)
+{
+    Header.CO.Header.BufferId  = MFX_EXTBUFF_CODING_OPTION;
+    Header.CO.Header.BufferSz  = sizeof(Header.CO);
+    Header.CO2.Header.BufferId = MFX_EXTBUFF_CODING_OPTION2;
+    Header.CO2.Header.BufferSz = sizeof(Header.CO2);
+    Header.CO3.Header.BufferId = MFX_EXTBUFF_CODING_OPTION3;
+    Header.CO3.Header.BufferSz = sizeof(Header.CO3);
+
+    extParam.clear();
+    extParam.push_back(&Header.CO.Header);
+    extParam.push_back(&Header.CO2.Header);
+    extParam.push_back(&Header.CO3.Header);
+
+    par = {};
+    par.mfx         = Header.mfx;
+    par.IOPattern   = MFX_IOPATTERN_IN_VIDEO_MEMORY;
+    par.ExtParam    = extParam.data();
+    par.NumExtParam = (mfxU16)extParam.size();
+}
+
+BRCTraceRecorder::BRCTraceRecorder()
+    : m_brc()
+    , m_fileName()
+    , m_file(NULL)
+    , m_frame()
+    , m_bFrameStarted(false)
+    , m_bFrameSkipped(false)
+{
+}
+
+BRCTraceRecorder::~BRCTraceRecorder()
+{
+    if (m_bFrameStarted)
+        WriteFrame();
+
+    if (m_file)
+        fclose(m_file);
+}
+
+mfxStatus BRCTraceRecorder::Attach(mfxExtBRC& brc, const msdk_char* fileName)
+{
+    MSDK_CHECK_POINTER(fileName, MFX_ERR_NULL_PTR);
+    MSDK_CHECK_POINTER(brc.Init, MFX_ERR_NULL_PTR);
+    MSDK_CHECK_NOT_EQUAL(m_brc.pthis, NULL, MFX_ERR_UNDEFINED_BEHAVIOR);
+
+    m_fileName = fileName;
+    m_brc = brc;
+
+    brc.pthis        = this;
+    brc.Init         = Init;
+    brc.Reset        = Reset;
+    brc.Close        = Close;
+    brc.GetFrameCtrl = GetFrameCtrl;
+    brc.Update       = Update;
+
+    return MFX_ERR_NONE;
+}
+
+void BRCTraceRecorder::Detach(mfxExtBRC& brc)
+{
+    if (brc.pthis != this)
+        return;
+
+    brc.pthis        = m_brc.pthis;
+    brc.Init         = m_brc.Init;
+    brc.Reset        = m_brc.Reset;
+    brc.Close        = m_brc.Close;
+    brc.GetFrameCtrl = m_brc.GetFrameCtrl;
+    brc.Update       = m_brc.Update;
+
+    m_brc = {};
+}
+
+mfxStatus BRCTraceRecorder::WriteHeader(mfxVideoParam* par)
+{
+    // encoder re-initialization keeps writing to the same trace
+    if (m_file)
+        return MFX_ERR_NONE;
+
+    MSDK_FOPEN(m_file, m_fileName.c_str(), MSDK_STRING("wb"));
+    MSDK_CHECK_POINTER(m_file, MFX_ERR_NOT_FOUND);
+
+    BRCTraceHeader header = {};
+    header.Magic   = BRC_TRACE_MAGIC;
+    header.Version = BRC_TRACE_VERSION;
+    header.mfx     = par->mfx;
+
+    mfxExtBuffer* co  = GetExtBuffer(par->ExtParam, par->NumExtParam, MFX_EXTBUFF_CODING_OPTION);
+    mfxExtBuffer* co2 = GetExtBuffer(par->ExtParam, par->NumExtParam, MFX_EXTBUFF_CODING_OPTION2);
+    mfxExtBuffer* co3 = GetExtBuffer(par->ExtParam, par->NumExtParam, MFX_EXTBUFF_CODING_OPTION3);
+
+    if (co)
+        header.CO = *(mfxExtCodingOption*)co;
+    if (co2)
+        header.CO2 = *(mfxExtCodingOption2*)co2;
+    if (co3)
+        header.CO3 = *(mfxExtCodingOption3*)co3;
+
+    MSDK_CHECK_NOT_EQUAL(fwrite(&header, sizeof(header), 1, m_file), 1, MFX_ERR_UNKNOWN);
+
+    return MFX_ERR_NONE;
+}
+
+void BRCTraceRecorder::WriteFrame()
+{
+    if (m_file)
+        fwrite(&m_frame, sizeof(m_frame), 1, m_file);
+
+    m_bFrameStarted = false;
+}
+
+mfxStatus BRCTraceRecorder::Init(mfxHDL pthis, mfxVideoParam* par)
+{
+    MSDK_CHECK_POINTER(pthis, MFX_ERR_NULL_PTR);
+    MSDK_CHECK_POINTER(par, MFX_ERR_NULL_PTR);
+    BRCTraceRecorder& rec = *(BRCTraceRecorder*)pthis;
+
+    mfxStatus sts = rec.m_brc.Init(rec.m_brc.pthis, par);
+    if (sts != MFX_ERR_NONE)
+        return sts;
+
+    return rec.WriteHeader(par);
+}
+
+mfxStatus BRCTraceRecorder::Reset(mfxHDL pthis, mfxVideoParam* par)
+{
+    MSDK_CHECK_POINTER(pthis, MFX_ERR_NULL_PTR);
+    BRCTraceRecorder& rec = *(BRCTraceRecorder*)pthis;
+
+    return rec.m_brc.Reset(rec.m_brc.pthis, par);
+}
+
+mfxStatus BRCTraceRecorder::Close(mfxHDL pthis)
+{
+    MSDK_CHECK_POINTER(pthis, MFX_ERR_NULL_PTR);
+    BRCTraceRecorder& rec = *(BRCTraceRecorder*)pthis;
+
+    if (rec.m_bFrameStarted)
+        rec.WriteFrame();
+
+    return rec.m_brc.Close(rec.m_brc.pthis);
+}
+
+mfxStatus BRCTraceRecorder::GetFrameCtrl(mfxHDL pthis, mfxBRCFrameParam* par, mfxBRCFrameCtrl* ctrl)
+{
+    MSDK_CHECK_POINTER(pthis, MFX_ERR_NULL_PTR);
+    MSDK_CHECK_POINTER(par, MFX_ERR_NULL_PTR);
+    BRCTraceRecorder& rec = *(BRCTraceRecorder*)pthis;
+
+    mfxStatus sts = rec.m_brc.GetFrameCtrl(rec.m_brc.pthis, par, ctrl);
+    if (sts != MFX_ERR_NONE)
+        return sts;
+
+    // recode of the same frame comes with the same EncodedOrder
+    if (rec.m_bFrameStarted && rec.m_frame.EncodedOrder == par->EncodedOrder)
+        return sts;
+
+    if (rec.m_bFrameStarted)
+        rec.WriteFrame();
+
+    rec.m_frame = {};
+    rec.m_frame.EncodedOrder = par->EncodedOrder;
+    rec.m_frame.DisplayOrder = par->DisplayOrder;
+    rec.m_frame.FrameType    = par->FrameType;
+    rec.m_frame.PyramidLayer = par->PyramidLayer;
+#if (MFX_VERSION >= 1026)
+    rec.m_frame.SceneChange  = par->SceneChange;
+    rec.m_frame.LongTerm     = par->LongTerm;
+    rec.m_frame.FrameCmplx   = par->FrameCmplx;
+#endif
+    rec.m_bFrameStarted = true;
+    rec.m_bFrameSkipped = false;
+
+    return sts;
+}
+
+mfxStatus BRCTraceRecorder::Update(mfxHDL pthis, mfxBRCFrameParam* par, mfxBRCFrameCtrl* ctrl, mfxBRCFrameStatus* status)
+{
+    MSDK_CHECK_POINTER(pthis, MFX_ERR_NULL_PTR);
+    MSDK_CHECK_POINTER(par, MFX_ERR_NULL_PTR);
+    MSDK_CHECK_POINTER(ctrl, MFX_ERR_NULL_PTR);
+    MSDK_CHECK_POINTER(status, MFX_ERR_NULL_PTR);
+    BRCTraceRecorder& rec = *(BRCTraceRecorder*)pthis;
+
+    mfxStatus sts = rec.m_brc.Update(rec.m_brc.pthis, par, ctrl, status);
+    if (sts != MFX_ERR_NONE)
+        return sts;
+
+    if (!rec.m_bFrameStarted)
+        return sts;
+
+    // size of skipped frame does not depend on QP, keep it out of the model
+    if (!rec.m_bFrameSkipped && rec.m_frame.NumPasses < BRC_TRACE_MAX_PASSES)
+    {
+        rec.m_frame.Passes[rec.m_frame.NumPasses].QpY            = ctrl->QpY;
+        rec.m_frame.Passes[rec.m_frame.NumPasses].CodedFrameSize = par->CodedFrameSize;
+        rec.m_frame.NumPasses++;
+    }
+
+    // encoder re-encodes the frame as skipped one and calls BRC again
+    if (status->BRCStatus == MFX_BRC_PANIC_BIG_FRAME)
+        rec.m_bFrameSkipped = true;
+
+    if (!rec.m_bFrameSkipped)
+        rec.m_frame.BRCStatus = status->BRCStatus;
+    else
+        rec.m_frame.BRCStatus = MFX_BRC_PANIC_BIG_FRAME;
+
+    if (status->BRCStatus == MFX_BRC_OK || status->BRCStatus == MFX_BRC_PANIC_SMALL_FRAME)
+        rec.WriteFrame();
+
+    return sts;
+}
+
+#endif // #if (MFX_VERSION >= 1024)
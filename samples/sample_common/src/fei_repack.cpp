@@ -0,0 +1,460 @@
+/******************************************************************************\
+Copyright (c) 2020, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+
+#include "fei_repack.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FEI_REPACK_SSE2
+#include <emmintrin.h>
+#endif
+
+RowParallel::RowParallel(mfxU32 numThreads)
+    : m_fn(NULL)
+    , m_numRows(0)
+    , m_sliceRows(0)
+    , m_numSlices(0)
+    , m_nextSlice(0)
+    , m_busy(0)
+    , m_job(0)
+    , m_stop(false)
+{
+    for (mfxU32 i = 1; i < numThreads; ++i)
+        m_workers.push_back(std::thread(&RowParallel::WorkerLoop, this));
+}
+
+RowParallel::~RowParallel()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+void RowParallel::Run(mfxU32 numRows, mfxU32 align, const std::function<void(mfxU32, mfxU32)>& fn)
+{
+    if (!numRows)
+        return;
+
+    align = std::max<mfxU32>(align, 1);
+    mfxU32 units = (numRows + align - 1) / align;
+
+    if (m_workers.empty() || units < 2)
+    {
+        fn(0, numRows);
+        return;
+    }
+
+    // a few slices per thread to even out load
+    mfxU32 slices = std::min(units, GetNumThreads() * 4);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fn        = &fn;
+        m_numRows   = numRows;
+        m_sliceRows = (units + slices - 1) / slices * align;
+        m_numSlices = (numRows + m_sliceRows - 1) / m_sliceRows;
+        m_nextSlice = 0;
+        m_busy      = (mfxU32)m_workers.size();
+        ++m_job;
+    }
+    m_start.notify_all();
+
+    RunSlices();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_busy == 0; });
+    m_fn = NULL;
+}
+
+void RowParallel::WorkerLoop()
+{
+    mfxU64 job = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [this, job] { return m_stop || m_job != job; });
+            if (m_stop)
+                return;
+            job = m_job;
+        }
+
+        RunSlices();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busy == 0)
+            m_done.notify_one();
+    }
+}
+
+void RowParallel::RunSlices()
+{
+    for (mfxU32 slice = m_nextSlice++; slice < m_numSlices; slice = m_nextSlice++)
+    {
+        mfxU32 begin = slice * m_sliceRows;
+        (*m_fn)(begin, std::min(begin + m_sliceRows, m_numRows));
+    }
+}
+
+void FeiSelectFromMV(const mfxI16Pair (*mv)[2], mfxI32 count, mfxI16Pair (&res)[2])
+{
+    mfxI32 xsum[2] = {}, ysum[2] = {}, found[2] = { count, count };
+
+#ifdef FEI_REPACK_SSE2
+    // 32-bit lanes hold L0 and L1 MVs of two consequent pairs, intra MVs (x == -0x8000) are
+    // zeroed before accumulation and counted
+    const __m128i xMask  = _mm_set1_epi32(0xffff);
+    const __m128i intraX = _mm_set1_epi32(0x8000);
+    __m128i sumX  = _mm_setzero_si128();
+    __m128i sumY  = _mm_setzero_si128();
+    __m128i intra = _mm_setzero_si128();
+
+    for (mfxI32 i = 0; i < count; i += 2)
+    {
+        __m128i pairs   = _mm_loadu_si128((const __m128i*)mv[i]);
+        __m128i isIntra = _mm_cmpeq_epi32(_mm_and_si128(pairs, xMask), intraX);
+
+        pairs = _mm_andnot_si128(isIntra, pairs);
+        sumX  = _mm_add_epi32(sumX, _mm_srai_epi32(_mm_slli_epi32(pairs, 16), 16));
+        sumY  = _mm_add_epi32(sumY, _mm_srai_epi32(pairs, 16));
+        intra = _mm_sub_epi32(intra, isIntra);
+    }
+
+    mfxI32 x[4], y[4], n[4];
+    _mm_storeu_si128((__m128i*)x, sumX);
+    _mm_storeu_si128((__m128i*)y, sumY);
+    _mm_storeu_si128((__m128i*)n, intra);
+
+    for (int ref = 0; ref < 2; ref++)
+    {
+        xsum[ref]   = x[ref] + x[ref + 2];
+        ysum[ref]   = y[ref] + y[ref + 2];
+        found[ref] -= n[ref] + n[ref + 2];
+    }
+#else
+    for (int ref = 0; ref < 2; ref++)
+    {
+        for (mfxI32 i = 0; i < count; i++)
+        {
+            if (mv[i][ref].x == -0x8000) // ignore intra
+            {
+                found[ref]--;
+                continue;
+            }
+            xsum[ref] += mv[i][ref].x;
+            ysum[ref] += mv[i][ref].y;
+        }
+    }
+#endif
+
+    for (int ref = 0; ref < 2; ref++)
+    {
+        if (!found[ref])
+            res[ref] = mv[0][ref]; // all MV are fill with 0x8000
+        else
+        {
+            res[ref].x = (mfxI16)(xsum[ref] / found[ref]);
+            res[ref].y = (mfxI16)(ysum[ref] / found[ref]);
+        }
+    }
+}
+
+void FeiBroadcastMV8x8(const mfxI16Pair (&mv8x8)[4][2], mfxI16Pair (&mv4x4)[16][2])
+{
+#ifdef FEI_REPACK_SSE2
+    for (int i = 0; i < 4; i++)
+    {
+        __m128i pair = _mm_loadl_epi64((const __m128i*)mv8x8[i]);
+        pair = _mm_unpacklo_epi64(pair, pair);
+        _mm_storeu_si128((__m128i*)mv4x4[4 * i], pair);
+        _mm_storeu_si128((__m128i*)mv4x4[4 * i + 2], pair);
+    }
+#else
+    for (int i = 0; i < 16; i++)
+    {
+        mv4x4[i][0] = mv8x8[i >> 2][0];
+        mv4x4[i][1] = mv8x8[i >> 2][1];
+    }
+#endif
+}
+
+#if (MFX_VERSION >= 1027)
+
+static const mfxU8 ZigzagOrder[16] = { 0, 1, 4, 5, 2, 3, 6, 7, 8, 9, 12, 13, 10, 11, 14, 15 };
+
+// MV of PreENC MB (in raster order of sub-blocks) to be used for 16x16 block of the encoded frame,
+// when PreENC input was downsampled by 2^ds
+static inline mfxU32 DSSubBlock(mfxU32 rowIdx, mfxU32 colIdx, mfxU8 ds)
+{
+    switch (ds)
+    {
+    case 1:
+        return (rowIdx & 1) * 8 + (colIdx & 1) * 2;
+    case 2:
+        return (rowIdx & 3) * 4 + (colIdx & 3);
+    case 3:
+        return (rowIdx & 7) / 2 * 4 + (colIdx & 7) / 2;
+    default:
+        return 0;
+    }
+}
+
+// Copies L0/L1 MV pair multiplied by 2^shift
+static inline void ScaleMVPair(const mfxI16Pair (&src)[2], mfxI16Pair (&dst)[2], mfxU8 shift)
+{
+#ifdef FEI_REPACK_SSE2
+    __m128i pair = _mm_loadl_epi64((const __m128i*)src);
+    _mm_storel_epi64((__m128i*)dst, _mm_sll_epi16(pair, _mm_cvtsi32_si128(shift)));
+#else
+    for (int i = 0; i < 2; i++)
+    {
+        dst[i].x = (mfxI16)((mfxU16)src[i].x << shift);
+        dst[i].y = (mfxI16)((mfxU16)src[i].y << shift);
+    }
+#endif
+}
+
+// Block of 32x32 layout of HEVC encoder for first 16x16 block of the row
+static inline mfxFeiHevcEncMVPredictors* GetMVPLine(mfxExtFeiHevcEncMVPredictors& mvp, mfxU32 widthCU, mfxU32 rowIdx)
+{
+    return mvp.Data
+        + (rowIdx & ~1) * widthCU   // offset for new line of 32x32 blocks layout;
+        + ((rowIdx & 1) << 1);      // zero shift for top 16x16 blocks into 32x32 layout and double for bottom blocks
+}
+
+static inline mfxU32 GetMVPOffset(mfxU32 colIdx)
+{
+    return ((colIdx >> 1) << 2)     // column offset;
+        + (colIdx & 1);             // zero or single offset depending on the number of column index
+}
+
+// Number of 16x16 blocks in the row which have PreENC data, the rest gets zero MVs
+static inline mfxU32 GetNumPreEncCols(const FeiHevcMvpRepackPar& par, mfxU32 rowIdx)
+{
+    if (par.DSPower2)
+        return par.WidthCU_enc;
+
+    return rowIdx < par.HeightCU_ds ? std::min(par.WidthCU_enc, par.WidthCU_ds) : 0;
+}
+
+void FeiHevcDisableMVP(mfxExtFeiHevcEncMVPredictors& mvp, mfxU32 begin, mfxU32 end)
+{
+    for (mfxU32 i = begin; i < end; ++i)
+    {
+        mfxFeiHevcEncMVPredictors& block = mvp.Data[i];
+
+        block.BlockSize = 0;
+        block.RefIdx[0].RefL0 = block.RefIdx[0].RefL1 = 0xf;
+        block.RefIdx[1].RefL0 = block.RefIdx[1].RefL1 = 0xf;
+        block.RefIdx[2].RefL0 = block.RefIdx[2].RefL1 = 0xf;
+        block.RefIdx[3].RefL0 = block.RefIdx[3].RefL1 = 0xf;
+    }
+}
+
+void FeiHevcRepackMVPPerformance(const FeiHevcMvpRepackPar& par, mfxExtFeiHevcEncMVPredictors& mvp, mfxU32 rowBegin, mfxU32 rowEnd)
+{
+    const mfxU8  ds      = par.DSPower2;
+    const mfxU32 colMask = (1u << ds) - 1;
+    const mfxI16Pair zeroPair = { 0, 0 };
+
+    // references are the same for all blocks
+    mfxFeiHevcEncMVPredictors refs = {};
+    for (mfxU32 j = 0; j < 4; ++j)
+    {
+        refs.RefIdx[j].RefL0 = j < par.NumPredPairs ? par.RefL0[j] : 0xf;
+        refs.RefIdx[j].RefL1 = j < par.NumPredPairs ? par.RefL1[j] : 0xf;
+    }
+
+    // Duplicate predictors to the first L0 reference in the first L1 MVP slot
+    if (par.Ldb)
+        refs.RefIdx[0].RefL1 = refs.RefIdx[0].RefL0;
+
+    for (mfxU32 rowIdx = rowBegin; rowIdx < rowEnd; ++rowIdx)
+    {
+        // sub-block pattern repeats every 2^ds columns
+        mfxU8 subBlock[8];
+        for (mfxU32 colIdx = 0; colIdx <= colMask; ++colIdx)
+            subBlock[colIdx] = ZigzagOrder[DSSubBlock(rowIdx, colIdx, ds)];
+
+        const mfxExtFeiPreEncMV::mfxExtFeiPreEncMVMB* mv[4];
+        for (mfxU32 j = 0; j < par.NumPredPairs; ++j)
+            mv[j] = par.MV[j] + (rowIdx >> ds) * par.WidthCU_ds;
+
+        mfxFeiHevcEncMVPredictors* line = GetMVPLine(mvp, par.WidthCU_enc, rowIdx);
+        mfxU32 numPreEncCols = GetNumPreEncCols(par, rowIdx);
+
+        for (mfxU32 colIdx = 0; colIdx < par.WidthCU_enc; ++colIdx)
+        {
+            mfxFeiHevcEncMVPredictors& block = line[GetMVPOffset(colIdx)];
+
+            MSDK_MEMCPY(block.RefIdx, refs.RefIdx, sizeof(block.RefIdx));
+            block.BlockSize = 1; // Using finest granularity
+
+            if (colIdx < numPreEncCols)
+            {
+                mfxU32 preencCUIdx = colIdx >> ds;
+                mfxU32 preencMVIdx = subBlock[colIdx & colMask];
+
+                for (mfxU32 j = 0; j < par.NumPredPairs; ++j)
+                    ScaleMVPair(mv[j][preencCUIdx].MV[preencMVIdx], block.MV[j], ds);
+            }
+            else
+            {
+                for (mfxU32 j = 0; j < par.NumPredPairs; ++j)
+                    block.MV[j][0] = block.MV[j][1] = zeroPair;
+            }
+
+            if (par.Ldb)
+                block.MV[0][1] = block.MV[0][0];
+        }
+    }
+}
+
+void FeiHevcRepackMVPQuality(const FeiHevcMvpRepackPar& par, mfxExtFeiHevcEncMVPredictors& mvp, mfxU32 rowBegin, mfxU32 rowEnd)
+{
+    const mfxU8  ds      = par.DSPower2;
+    const mfxU32 colMask = (1u << ds) - 1;
+    const mfxI16Pair zeroPair = { 0, 0 };
+
+    mfxFeiHevcEncMVPredictors disabled = {};
+    for (mfxU32 j = 0; j < 4; ++j)
+        disabled.RefIdx[j].RefL0 = disabled.RefIdx[j].RefL1 = 0xf;
+
+    for (mfxU32 rowIdx = rowBegin; rowIdx < rowEnd; ++rowIdx)
+    {
+        // 2x downsampling averages 4 MVs of 4x4 blocks in 8x8 block, otherwise single MV is taken
+        mfxU8 subBlock[8];
+        for (mfxU32 colIdx = 0; colIdx <= colMask; ++colIdx)
+            subBlock[colIdx] = (ds == 1) ? (mfxU8)((rowIdx & 1) * 8 + (colIdx & 1) * 4) : ZigzagOrder[DSSubBlock(rowIdx, colIdx, ds)];
+
+        const mfxExtFeiPreEncMV::mfxExtFeiPreEncMVMB*         mvs[4];
+        const mfxExtFeiPreEncMBStat::mfxExtFeiPreEncMBStatMB* mbs[4];
+        for (mfxU32 j = 0; j < par.NumPredPairs; ++j)
+        {
+            mvs[j] = par.MV[j] + (rowIdx >> ds) * par.WidthCU_ds;
+            mbs[j] = par.MB[j] + (rowIdx >> ds) * par.WidthCU_ds;
+        }
+
+        mfxFeiHevcEncMVPredictors* line = GetMVPLine(mvp, par.WidthCU_enc, rowIdx);
+        mfxU32 numPreEncCols = GetNumPreEncCols(par, rowIdx);
+
+        for (mfxU32 colIdx = 0; colIdx < par.WidthCU_enc; ++colIdx)
+        {
+            // intermediate arrays to be sorted by distortion
+            mfxU8 ref[4][2];
+            mfxI16Pair mv[4][2];
+            mfxU16 distortion[4][2];
+
+            mfxFeiHevcEncMVPredictors& block = line[GetMVPOffset(colIdx)];
+
+            MSDK_MEMCPY(block.RefIdx, disabled.RefIdx, sizeof(block.RefIdx));
+            block.BlockSize = 1; // Using finest granularity
+
+            mfxU32 preencCUIdx = colIdx >> ds;
+            mfxU32 preencMVIdx = subBlock[colIdx & colMask];
+
+            for (mfxU32 j = 0; j < par.NumPredPairs; ++j)
+            {
+                ref[j][0] = par.RefL0[j];
+                ref[j][1] = par.RefL1[j];
+
+                if (colIdx >= numPreEncCols)
+                {
+                    mv[j][0] = mv[j][1] = zeroPair;
+                    distortion[j][0] = distortion[j][1] = 0xffff;
+                    continue;
+                }
+
+                const mfxExtFeiPreEncMV::mfxExtFeiPreEncMVMB&         mvMB   = mvs[j][preencCUIdx];
+                const mfxExtFeiPreEncMBStat::mfxExtFeiPreEncMBStatMB& statMB = mbs[j][preencCUIdx];
+
+                switch (ds)
+                {
+                case 0: // w/o VPP
+                    FeiSelectFromMV(mvMB.MV, 16, mv[j]);
+                    break;
+                case 1:
+                    FeiSelectFromMV(&mvMB.MV[preencMVIdx], 4, mv[j]);
+                    break;
+                default:
+                    mv[j][0] = mvMB.MV[preencMVIdx][0];
+                    mv[j][1] = mvMB.MV[preencMVIdx][1];
+                    break;
+                }
+
+                if (ds)
+                    ScaleMVPair(mv[j], mv[j], ds);
+
+                distortion[j][0] = (!ds || j < par.NumL0) ? statMB.Inter[0].BestDistortion : 0xffff;
+                distortion[j][1] = (!ds || j < par.NumL1) ? statMB.Inter[1].BestDistortion : 0xffff;
+            }
+
+            // sort predictors by ascending distortion
+            if (par.NumPredPairs < 2) // nothing to sort
+            {
+                block.MV[0][0] = mv[0][0];
+                block.MV[0][1] = mv[0][1];
+                block.RefIdx[0].RefL0 = ref[0][0];
+                block.RefIdx[0].RefL1 = ref[0][1];
+                continue;
+            }
+
+            // smaller idx to be first argument to be preferred if equal
+            #define CMP_DIST(k,l) {                               \
+                mfxU8 res0 = distortion[k][0] > distortion[l][0]; \
+                mfxU8 res1 = distortion[k][1] > distortion[l][1]; \
+                worse[k][0] += res0; worse[l][0] += res0 ^ 1;     \
+                worse[k][1] += res1; worse[l][1] += res1 ^ 1;     \
+            }
+
+            // fill unused
+            for (mfxU32 j = par.NumPredPairs; j < 4; ++j)
+            {
+                distortion[j][1] = distortion[j][0] = 0xffff;
+                ref[j][1] = ref[j][0] = 0xff;
+                mv[j][0].y = mv[j][0].x = -0x8000;
+                mv[j][1].y = mv[j][1].x = -0x8000;
+            }
+
+            mfxU8 worse[4][2] = { {0,} };
+            CMP_DIST(0, 1); CMP_DIST(2, 3);
+            CMP_DIST(0, 2); CMP_DIST(1, 3);
+            CMP_DIST(0, 3); CMP_DIST(1, 2);
+            #undef CMP_DIST
+
+            // here 'worse' tells how many cases are better, so it is position in sorted array
+            for (mfxU32 j = 0; j < 4; j++)
+            {
+                block.MV[worse[j][0]][0] = mv[j][0];
+                block.MV[worse[j][1]][1] = mv[j][1];
+                block.RefIdx[worse[j][0]].RefL0 = ref[j][0];
+                block.RefIdx[worse[j][1]].RefL1 = ref[j][1];
+            }
+        }
+    }
+}
+
+#endif // MFX_VERSION >= 1027
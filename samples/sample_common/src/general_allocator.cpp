@@ -69,7 +69,8 @@ mfxStatus GeneralAllocator::Init(mfxAllocatorParams *pParams)
     }
 
     m_SYSAllocator.reset(new SysMemFrameAllocator);
-    sts = m_SYSAllocator.get()->Init(0);
+    // pass system memory settings through, other parameters are for video memory allocator
+    sts = m_SYSAllocator.get()->Init(dynamic_cast<SysMemAllocatorParams*>(pParams));
     MSDK_CHECK_STATUS(sts, "m_SYSAllocator.get failed");
 
     return sts;
@@ -690,9 +690,27 @@ void CSmplBitstreamReader::Reset()
     if (!m_bInited)
         return;
 
+    m_headers.clear();
     fseek(m_fSource, 0, SEEK_SET);
 }
 
+mfxStatus CSmplBitstreamReader::Seek(const sBitstreamIndexEntry& entry)
+{
+    if (!m_bInited)
+        return MFX_ERR_NOT_INITIALIZED;
+
+    m_headers.resize(entry.paramSize);
+    if (entry.paramSize)
+    {
+        MSDK_CHECK_NOT_EQUAL(MSDK_FSEEK(m_fSource, entry.paramOffset, SEEK_SET), 0, MFX_ERR_UNDEFINED_BEHAVIOR);
+        if (fread(m_headers.data(), 1, entry.paramSize, m_fSource) != entry.paramSize)
+            return MFX_ERR_MORE_DATA;
+    }
+
+    MSDK_CHECK_NOT_EQUAL(MSDK_FSEEK(m_fSource, entry.offset, SEEK_SET), 0, MFX_ERR_UNDEFINED_BEHAVIOR);
+    return MFX_ERR_NONE;
+}
+
 mfxStatus CSmplBitstreamReader::Init(const msdk_char *strFileName)
 {
     MSDK_CHECK_POINTER(strFileName, MFX_ERR_NULL_PTR);
@@ -728,6 +746,21 @@ mfxStatus CSmplBitstreamReader::ReadNextFrame(mfxBitstream *pBS)
 
     memmove(pBS->Data, pBS->Data + pBS->DataOffset, pBS->DataLength);
     pBS->DataOffset = 0;
+
+    // parameter sets of the random access point we seeked to
+    if (!m_headers.empty())
+    {
+        if (m_headers.size() > pBS->MaxLength - pBS->DataLength)
+            return MFX_ERR_NOT_ENOUGH_BUFFER;
+
+        MSDK_MEMCPY_BITSTREAM(*pBS, pBS->DataLength, m_headers.data(), m_headers.size());
+        pBS->DataLength += (mfxU32)m_headers.size();
+        m_headers.clear();
+
+        if (pBS->MaxLength == pBS->DataLength)
+            return MFX_ERR_NONE;
+    }
+
     mfxU32 nBytesRead = (mfxU32)fread(pBS->Data + pBS->DataLength, 1, pBS->MaxLength - pBS->DataLength, m_fSource);
 
     CHECK_SET_EOS(pBS);
@@ -2268,6 +2301,56 @@ msdk_opt_read(const msdk_char* string, mfxPriority& value)
 
 mfxStatus msdk_opt_read(msdk_char* string, mfxPriority& value);
 
+mfxStatus msdk_parse_cpu_list(const msdk_char* string, std::vector<mfxU32>& cpus)
+{
+    if (!string)
+        return MFX_ERR_NULL_PTR;
+
+    cpus.clear();
+
+    // CPU numbers are limited to keep malformed ranges from exploding the list
+    const mfxU32 maxCpu = 4096;
+    auto isDigit = [](msdk_char c) { return c >= MSDK_CHAR('0') && c <= MSDK_CHAR('9'); };
+
+    const msdk_char* ptr = string;
+    while (*ptr)
+    {
+        msdk_char* stopCharacter;
+        if (!isDigit(*ptr))
+            return MFX_ERR_UNKNOWN;
+        mfxU32 first = (mfxU32)msdk_strtol(ptr, &stopCharacter, 10);
+
+        mfxU32 last = first;
+        ptr = stopCharacter;
+        if (*ptr == MSDK_CHAR('-'))
+        {
+            ++ptr;
+            if (!isDigit(*ptr))
+                return MFX_ERR_UNKNOWN;
+            last = (mfxU32)msdk_strtol(ptr, &stopCharacter, 10);
+            ptr = stopCharacter;
+        }
+
+        if (last < first || last >= maxCpu)
+            return MFX_ERR_UNKNOWN;
+
+        for (mfxU32 cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+
+        if (*ptr == MSDK_CHAR(','))
+            ++ptr;
+        else if (*ptr && *ptr != MSDK_CHAR('\n'))
+            return MFX_ERR_UNKNOWN;
+        else
+            break;
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+    return cpus.empty() ? MFX_ERR_UNKNOWN : MFX_ERR_NONE;
+}
+
 bool IsDecodeCodecSupported(mfxU32 codecFormat)
 {
     switch(codecFormat)
@@ -2609,6 +2692,25 @@ mfxStatus CH264FrameReader::ReadNextFrame(mfxBitstream *pBS)
     return sts;
 }
 
+mfxStatus CH264FrameReader::Seek(const sBitstreamIndexEntry& entry)
+{
+    mfxStatus sts = CSmplBitstreamReader::Seek(entry);
+    if (sts != MFX_ERR_NONE)
+        return sts;
+
+    // drop the data buffered from the previous position
+    m_originalBS.DataOffset = 0;
+    m_originalBS.DataLength = 0;
+    m_originalBS.DataFlag = 0;
+    m_isEndOfStream = false;
+    m_processedBS = NULL;
+    m_frame = NULL;
+
+    m_pNALSplitter.reset(new ProtectedLibrary::AVC_Spl());
+
+    return MFX_ERR_NONE;
+}
+
 mfxStatus CH264FrameReader::PrepareNextFrame(mfxBitstream *in, mfxBitstream **out)
 {
     mfxStatus sts = MFX_ERR_NONE;
@@ -20,13 +20,228 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include "sysmem_allocator.h"
 #include "sample_utils.h"
 
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
 #define MSDK_ALIGN32(X) (((mfxU32)((X)+31)) & (~ (mfxU32)31))
 #define ID_BUFFER MFX_MAKEFOURCC('B','U','F','F')
 #define ID_FRAME  MFX_MAKEFOURCC('F','R','M','E')
 
+namespace
+{
+    const size_t POOL_SLAB_ALIGN      = 2 * 1024 * 1024;
+    const size_t POOL_BLOCK_ALIGN     = 4096;
+    // smaller buffers are not worth a slab
+    const size_t POOL_MIN_BLOCK       = 256 * 1024;
+    const mfxU32 POOL_MAX_SLAB_BLOCKS = 8;
+
+    size_t AlignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    mfxU8* MapSlab(size_t size)
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        return (mfxU8*)VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+#if defined(MAP_HUGETLB)
+        void* huge = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (MAP_FAILED != huge)
+            return (mfxU8*)huge;
+#endif
+        // map with a margin to get 2MB alignment, so the kernel may back slab by transparent hugepages
+        size_t full = size + POOL_SLAB_ALIGN;
+        void* raw = mmap(NULL, full, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (MAP_FAILED == raw)
+            return NULL;
+
+        mfxU8* begin = (mfxU8*)raw;
+        mfxU8* aligned = (mfxU8*)AlignUp((size_t)begin, POOL_SLAB_ALIGN);
+        if (aligned > begin)
+            munmap(begin, aligned - begin);
+        if (begin + full > aligned + size)
+            munmap(aligned + size, (begin + full) - (aligned + size));
+#if defined(MADV_HUGEPAGE)
+        madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+        return aligned;
+#endif
+    }
+
+    void UnmapSlab(mfxU8* base, size_t size)
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        (void)size;
+        VirtualFree(base, 0, MEM_RELEASE);
+#else
+        munmap(base, size);
+#endif
+    }
+}
+
+SysMemFramePool& SysMemFramePool::Instance()
+{
+    // never destroyed: buffers may be freed from other static destructors
+    static SysMemFramePool* pool = new SysMemFramePool;
+    return *pool;
+}
+
+SysMemFramePool::SysMemFramePool()
+: m_budget(0), m_mapped(0)
+{
+}
+
+void* SysMemFramePool::Alloc(size_t nbytes)
+{
+    if (nbytes < POOL_MIN_BLOCK)
+        return NULL;
+
+    size_t blockSize = AlignUp(nbytes, POOL_BLOCK_ALIGN);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<Slab*>& slabs = m_classes[blockSize];
+    for (Slab* slab : slabs)
+    {
+        if (!slab->idle.empty())
+        {
+            mfxU8* block = slab->idle.back();
+            slab->idle.pop_back();
+            slab->numUsed++;
+            return block;
+        }
+    }
+
+    Slab* slab = CreateSlab(blockSize);
+    if (!slab)
+        return NULL;
+
+    slabs.push_back(slab);
+    mfxU8* block = slab->idle.back();
+    slab->idle.pop_back();
+    slab->numUsed++;
+    return block;
+}
+
+bool SysMemFramePool::Free(void* ptr)
+{
+    if (!ptr)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    mfxU8* block = (mfxU8*)ptr;
+    auto it = m_slabs.upper_bound(block);
+    if (it == m_slabs.begin())
+        return false;
+    --it;
+
+    Slab* slab = it->second;
+    if (block >= slab->base + slab->size)
+        return false;
+
+    slab->idle.push_back(block);
+    slab->numUsed--;
+    return true;
+}
+
+void SysMemFramePool::SetBudget(size_t nbytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = nbytes;
+    if (m_budget && m_mapped > m_budget)
+        ReleaseIdleSlabs(m_mapped - m_budget);
+}
+
+void SysMemFramePool::Trim()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ReleaseIdleSlabs(m_mapped);
+}
+
+size_t SysMemFramePool::GetMappedSize()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_mapped;
+}
+
+// m_mutex should be taken
+SysMemFramePool::Slab* SysMemFramePool::CreateSlab(size_t blockSize)
+{
+    // choose number of blocks giving the least tail in 2MB granularity
+    size_t slabSize = AlignUp(blockSize, POOL_SLAB_ALIGN);
+    for (mfxU32 n = 2; n <= POOL_MAX_SLAB_BLOCKS; n++)
+    {
+        size_t size = AlignUp(blockSize * n, POOL_SLAB_ALIGN);
+        if ((size % blockSize) * slabSize < (slabSize % blockSize) * size)
+            slabSize = size;
+    }
+
+    if (m_budget && m_mapped + slabSize > m_budget)
+    {
+        ReleaseIdleSlabs(m_mapped + slabSize - m_budget);
+        // near the budget a single block slab is still better than heap
+        if (m_mapped + slabSize > m_budget)
+            slabSize = AlignUp(blockSize, POOL_SLAB_ALIGN);
+        if (m_mapped + slabSize > m_budget)
+            return NULL;
+    }
+
+    mfxU8* base = MapSlab(slabSize);
+    if (!base)
+        return NULL;
+
+    Slab* slab = new Slab;
+    slab->base      = base;
+    slab->size      = slabSize;
+    slab->blockSize = blockSize;
+    slab->numUsed   = 0;
+    // reversed, so blocks are handed out from the slab start
+    for (size_t offset = (slabSize / blockSize) * blockSize; offset >= blockSize; offset -= blockSize)
+        slab->idle.push_back(base + offset - blockSize);
+
+    m_slabs[base] = slab;
+    m_mapped += slabSize;
+    return slab;
+}
+
+// m_mutex should be taken
+void SysMemFramePool::DestroySlab(Slab* slab)
+{
+    std::vector<Slab*>& slabs = m_classes[slab->blockSize];
+    slabs.erase(std::remove(slabs.begin(), slabs.end(), slab), slabs.end());
+    if (slabs.empty())
+        m_classes.erase(slab->blockSize);
+
+    m_slabs.erase(slab->base);
+    m_mapped -= slab->size;
+    UnmapSlab(slab->base, slab->size);
+    delete slab;
+}
+
+// m_mutex should be taken
+size_t SysMemFramePool::ReleaseIdleSlabs(size_t nbytes)
+{
+    size_t released = 0;
+    for (auto it = m_slabs.begin(); it != m_slabs.end() && released < nbytes;)
+    {
+        Slab* slab = (it++)->second;
+        if (slab->numUsed)
+            continue;
+
+        released += slab->size;
+        DestroySlab(slab);
+    }
+    return released;
+}
+
 
 SysMemFrameAllocator::SysMemFrameAllocator()
-: m_pBufferAllocator(0), m_bOwnBufferAllocator(false)
+: m_pBufferAllocator(0), m_bOwnBufferAllocator(false), m_bFirstTouch(false), m_bUseFramePool(false)
 {
 }
 
@@ -47,12 +262,16 @@ mfxStatus SysMemFrameAllocator::Init(mfxAllocatorParams *pParams)
 
         m_pBufferAllocator = pSysMemParams->pBufferAllocator;
         m_bOwnBufferAllocator = false;
+        m_bFirstTouch = pSysMemParams->bFirstTouch;
+        m_bUseFramePool = pSysMemParams->bUseFramePool;
+        if (m_bUseFramePool)
+            SysMemFramePool::Instance().SetBudget(pSysMemParams->nFramePoolBudget);
     }
 
     // if buffer allocator wasn't passed from application create own
     if (!m_pBufferAllocator)
     {
-        m_pBufferAllocator = new SysMemBufferAllocator;
+        m_pBufferAllocator = new SysMemBufferAllocator(m_bUseFramePool);
         if (!m_pBufferAllocator)
             return MFX_ERR_MEMORY_ALLOC;
 
@@ -420,6 +639,8 @@ mfxStatus SysMemFrameAllocator::AllocImpl(mfxFrameAllocRequest *request, mfxFram
 
         fs->id = ID_FRAME;
         fs->info = request->Info;
+        if (m_bFirstTouch)
+            memset((mfxU8 *)fs + MSDK_ALIGN32(sizeof(sFrame)), 0, nbytes);
         sts = m_pBufferAllocator->Unlock(m_pBufferAllocator->pthis, mids[numAllocated]);
 
         if (MFX_ERR_NONE != sts)
@@ -469,7 +690,8 @@ mfxStatus SysMemFrameAllocator::ReleaseResponse(mfxFrameAllocResponse *response)
     return sts;
 }
 
-SysMemBufferAllocator::SysMemBufferAllocator()
+SysMemBufferAllocator::SysMemBufferAllocator(bool bUseFramePool)
+: m_bUseFramePool(bUseFramePool)
 {
 
 }
@@ -488,7 +710,18 @@ mfxStatus SysMemBufferAllocator::AllocBuffer(mfxU32 nbytes, mfxU16 type, mfxMemI
         return MFX_ERR_UNSUPPORTED;
 
     mfxU32 header_size = MSDK_ALIGN32(sizeof(sBuffer));
-    mfxU8 *buffer_ptr = (mfxU8 *)calloc(header_size + nbytes + 32, 1);
+    mfxU8 *buffer_ptr = NULL;
+
+    // recycled blocks keep old content, only the header is cleared
+    if (m_bUseFramePool)
+    {
+        buffer_ptr = (mfxU8 *)SysMemFramePool::Instance().Alloc(header_size + nbytes + 32);
+        if (buffer_ptr)
+            memset(buffer_ptr, 0, header_size);
+    }
+
+    if (!buffer_ptr)
+        buffer_ptr = (mfxU8 *)calloc(header_size + nbytes + 32, 1);
 
     if (!buffer_ptr)
         return MFX_ERR_MEMORY_ALLOC;
@@ -533,6 +766,8 @@ mfxStatus SysMemBufferAllocator::FreeBuffer(mfxMemId mid)
     if (!bs || ID_BUFFER != bs->id)
         return MFX_ERR_INVALID_HANDLE;
 
-    free(bs);
+    bs->id = 0;
+    if (!m_bUseFramePool || !SysMemFramePool::Instance().Free(bs))
+        free(bs);
     return MFX_ERR_NONE;
 }
@@ -22,6 +22,8 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include <new> // std::bad_alloc
 #include <stdio.h> // setrlimit
 #include <sched.h>
+#include <algorithm>
+#include <iterator>
 #include <unistd.h>
 #include <sys/syscall.h>
 
@@ -290,4 +292,115 @@ mfxU32 msdk_get_current_pid()
     return syscall(SYS_getpid);
 }
 
+mfxStatus msdk_thread_get_affinity(std::vector<mfxU32>& cpus)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set)) return MFX_ERR_UNKNOWN;
+
+    cpus.clear();
+    for (mfxU32 cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+    return MFX_ERR_NONE;
+}
+
+mfxStatus msdk_thread_set_affinity(const std::vector<mfxU32>& cpus)
+{
+    if (cpus.empty()) return MFX_ERR_UNSUPPORTED;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (mfxU32 cpu : cpus)
+    {
+        if (cpu >= CPU_SETSIZE) return MFX_ERR_UNSUPPORTED;
+        CPU_SET(cpu, &set);
+    }
+    // threads created after this call (e.g. by MFXInit) inherit the mask
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) return MFX_ERR_UNKNOWN;
+    return MFX_ERR_NONE;
+}
+
+static mfxStatus msdk_read_cpu_list(const char* path, std::vector<mfxU32>& cpus)
+{
+    FILE* file = fopen(path, "r");
+    if (!file) return MFX_ERR_NOT_FOUND;
+
+    char line[4096] = {};
+    bool res = fgets(line, sizeof(line), file) != NULL;
+    fclose(file);
+    if (!res) return MFX_ERR_UNKNOWN;
+
+    return msdk_parse_cpu_list(line, cpus);
+}
+
+static mfxU32 msdk_read_cpu_topology(mfxU32 cpu, const char* name)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/%s", cpu, name);
+
+    mfxU32 value = 0;
+    FILE* file = fopen(path, "r");
+    if (file)
+    {
+        if (fscanf(file, "%u", &value) != 1) value = 0;
+        fclose(file);
+    }
+    return value;
+}
+
+static void msdk_sort_by_core(std::vector<mfxU32>& cpus)
+{
+    struct CpuKey { mfxU32 package, core, cpu; };
+
+    std::vector<CpuKey> keys;
+    for (mfxU32 cpu : cpus)
+        keys.push_back({ msdk_read_cpu_topology(cpu, "physical_package_id"), msdk_read_cpu_topology(cpu, "core_id"), cpu });
+
+    std::sort(keys.begin(), keys.end(), [](const CpuKey& l, const CpuKey& r)
+    {
+        if (l.package != r.package) return l.package < r.package;
+        if (l.core != r.core) return l.core < r.core;
+        return l.cpu < r.cpu;
+    });
+
+    for (size_t i = 0; i < keys.size(); ++i)
+        cpus[i] = keys[i].cpu;
+}
+
+mfxStatus msdk_get_numa_nodes(std::vector<std::vector<mfxU32> >& nodes)
+{
+    std::vector<mfxU32> allowed;
+    mfxStatus sts = msdk_thread_get_affinity(allowed);
+    if (MFX_ERR_NONE != sts) return sts;
+
+    nodes.clear();
+
+    // node numbers may be sparse, so walk the list of online nodes
+    std::vector<mfxU32> online;
+    if (MFX_ERR_NONE == msdk_read_cpu_list("/sys/devices/system/node/online", online))
+    {
+        for (mfxU32 node : online)
+        {
+            char path[128];
+            snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+
+            std::vector<mfxU32> cpus;
+            if (MFX_ERR_NONE != msdk_read_cpu_list(path, cpus)) continue;
+
+            if (nodes.size() <= node) nodes.resize(node + 1);
+            std::set_intersection(cpus.begin(), cpus.end(), allowed.begin(), allowed.end(), std::back_inserter(nodes[node]));
+        }
+    }
+
+    // kernel without NUMA support - single node
+    if (nodes.empty()) nodes.push_back(allowed);
+
+    for (std::vector<mfxU32>& cpus : nodes)
+        msdk_sort_by_core(cpus);
+
+    return MFX_ERR_NONE;
+}
+
 #endif // #if !defined(_WIN32) && !defined(_WIN64)
@@ -139,4 +139,92 @@ mfxU32 msdk_get_current_pid()
     return GetCurrentProcessId();
 }
 
+/* Affinity is handled within processor group of the process only (up to 64 CPUs) */
+static void msdk_mask_to_cpus(DWORD_PTR mask, std::vector<mfxU32>& cpus)
+{
+    cpus.clear();
+    for (mfxU32 cpu = 0; cpu < sizeof(mask) * 8; ++cpu)
+    {
+        if (mask & ((DWORD_PTR)1 << cpu)) cpus.push_back(cpu);
+    }
+}
+
+mfxStatus msdk_thread_get_affinity(std::vector<mfxU32>& cpus)
+{
+    DWORD_PTR processMask = 0, systemMask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) return MFX_ERR_UNKNOWN;
+
+    // there is no getter for thread affinity, read it back through the setter
+    HANDLE thread = GetCurrentThread();
+    DWORD_PTR threadMask = SetThreadAffinityMask(thread, processMask);
+    if (!threadMask) return MFX_ERR_UNKNOWN;
+    SetThreadAffinityMask(thread, threadMask);
+
+    msdk_mask_to_cpus(threadMask, cpus);
+    return MFX_ERR_NONE;
+}
+
+mfxStatus msdk_thread_set_affinity(const std::vector<mfxU32>& cpus)
+{
+    if (cpus.empty()) return MFX_ERR_UNSUPPORTED;
+
+    DWORD_PTR mask = 0;
+    for (mfxU32 cpu : cpus)
+    {
+        if (cpu >= sizeof(mask) * 8) return MFX_ERR_UNSUPPORTED;
+        mask |= (DWORD_PTR)1 << cpu;
+    }
+    if (!SetThreadAffinityMask(GetCurrentThread(), mask)) return MFX_ERR_UNKNOWN;
+    return MFX_ERR_NONE;
+}
+
+mfxStatus msdk_get_numa_nodes(std::vector<std::vector<mfxU32> >& nodes)
+{
+    DWORD_PTR processMask = 0, systemMask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) return MFX_ERR_UNKNOWN;
+
+    nodes.clear();
+
+    ULONG highestNode = 0;
+    if (GetNumaHighestNodeNumber(&highestNode))
+    {
+        nodes.resize(highestNode + 1);
+        for (ULONG node = 0; node <= highestNode && node <= 0xff; ++node)
+        {
+            ULONGLONG nodeMask = 0;
+            if (GetNumaNodeProcessorMask((UCHAR)node, &nodeMask))
+                msdk_mask_to_cpus((DWORD_PTR)nodeMask & processMask, nodes[node]);
+        }
+    }
+
+    if (nodes.empty())
+    {
+        nodes.resize(1);
+        msdk_mask_to_cpus(processMask, nodes[0]);
+    }
+
+    // order CPUs by physical core
+    DWORD length = 0;
+    GetLogicalProcessorInformation(NULL, &length);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (!info.empty() && GetLogicalProcessorInformation(info.data(), &length))
+    {
+        for (std::vector<mfxU32>& cpus : nodes)
+        {
+            std::vector<mfxU32> sorted;
+            for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& item : info)
+            {
+                if (item.Relationship != RelationProcessorCore) continue;
+                for (mfxU32 cpu : cpus)
+                {
+                    if (item.ProcessorMask & ((ULONG_PTR)1 << cpu)) sorted.push_back(cpu);
+                }
+            }
+            if (sorted.size() == cpus.size()) cpus = sorted;
+        }
+    }
+
+    return MFX_ERR_NONE;
+}
+
 #endif // #if defined(_WIN32) || defined(_WIN64)
@@ -111,6 +111,7 @@ struct sInputParams
     mfxU32  fourcc;
     mfxU16  chromaType;
     mfxU32  nFrames;
+    mfxU32  nSeekFrame; // first output frame, decoding starts from the preceding random access point
     mfxU16  eDeinterlace;
     bool    outI420;
 
@@ -220,6 +221,8 @@ protected: // functions
     mfxStatus GetImpl(const sInputParams & params, mfxIMPL & impl);
     virtual mfxStatus CreateRenderingWindow(sInputParams *pParams);
     virtual mfxStatus InitMfxParams(sInputParams *pParams);
+    // Moves file reader to the random access point preceding the seek frame
+    virtual mfxStatus SeekInput(sInputParams *pParams);
 
     virtual mfxStatus AllocateExtMVCBuffers();
 
@@ -297,6 +300,7 @@ protected: // variables
     mfxU32                  m_nTimeout; // enables timeout for video playback, measured in seconds
     mfxU16                  m_nMaxFps; // limit of fps, if isn't specified equal 0.
     mfxU32                  m_nFrames; //limit number of output frames
+    mfxU32                  m_nSkipFrames; //frames decoded from the random access point before the seek position
 
     mfxU16                  m_diMode;
     bool                    m_bVppIsUsed;
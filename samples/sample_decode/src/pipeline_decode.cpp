@@ -62,6 +62,7 @@ CDecodingPipeline::CDecodingPipeline()
     : m_mfxBS(8 * 1024 * 1024)
 {
     m_nFrames=0;
+    m_nSkipFrames=0;
     m_export_mode=0;
     m_bVppFullColorRange=false;
     m_bVppIsUsed = false;
@@ -533,6 +534,12 @@ mfxStatus CDecodingPipeline::Init(sInputParams *pParams)
     m_mfxVideoParams.mfx.IgnoreLevelConstrain = pParams->bIgnoreLevelConstrain;
 #endif
 
+    if (pParams->nSeekFrame)
+    {
+        sts = SeekInput(pParams);
+        MSDK_CHECK_STATUS(sts, "SeekInput failed");
+    }
+
     // Populate parameters. Involves DecodeHeader call
     sts = InitMfxParams(pParams);
     MSDK_CHECK_STATUS(sts, "InitMfxParams failed");
@@ -699,6 +706,29 @@ mfxStatus CDecodingPipeline::CreateRenderingWindow(sInputParams *pParams)
     return sts;
 }
 
+mfxStatus CDecodingPipeline::SeekInput(sInputParams *pParams)
+{
+    MSDK_CHECK_POINTER(pParams, MFX_ERR_NULL_PTR);
+
+    CBitstreamIndex index;
+    mfxStatus sts = index.Open(pParams->strSrcFile, pParams->videoType);
+    MSDK_CHECK_STATUS(sts, "CBitstreamIndex::Open failed");
+
+    const sBitstreamIndexEntry* entry = index.Find(pParams->nSeekFrame);
+    if (!entry)
+    {
+        // no random access point before the frame, decode from the start of the file
+        m_nSkipFrames = pParams->nSeekFrame;
+        return MFX_ERR_NONE;
+    }
+
+    sts = m_FileReader->Seek(*entry);
+    MSDK_CHECK_STATUS(sts, "m_FileReader->Seek failed");
+
+    m_nSkipFrames = pParams->nSeekFrame - entry->frame;
+    return MFX_ERR_NONE;
+}
+
 mfxStatus CDecodingPipeline::InitMfxParams(sInputParams *pParams)
 {
     MSDK_CHECK_POINTER(m_pmfxDEC, MFX_ERR_NULL_PTR);
@@ -1671,6 +1701,13 @@ mfxStatus CDecodingPipeline::SyncOutputSurface(mfxU32 wait)
     if (MFX_WRN_IN_EXECUTION == sts) {
         return sts;
     }
+    if (MFX_ERR_NONE == sts && m_nSkipFrames) {
+        // the frame precedes the seek position, it is decoded only as a reference
+        --m_nSkipFrames;
+        ReturnSurfaceToBuffers(m_pCurrentOutputSurface);
+        m_pCurrentOutputSurface = NULL;
+        return sts;
+    }
     if (MFX_ERR_NONE == sts) {
         // we got completely decoded frame - pushing it to the delivering thread...
         ++m_synced_count;
@@ -50,6 +50,7 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 
 #if (MFX_VERSION >= 1024)
 #include "brc_routines.h"
+#include "brc_trace.h"
 #endif
 
 #if defined(_WIN64) || defined(_WIN32)
@@ -153,6 +154,7 @@ struct sInputParams
     mfxU16 nGPB;
     mfxU16 nTransformSkip;
     ExtBRCType nExtBRC;
+    msdk_string strBRCTraceFile; // record explicit extbrc calls for brc_replay tool
     mfxU16 nAdaptiveMaxFrameSize;
 
     mfxU16 WeightedPred;
@@ -372,6 +374,10 @@ protected:
 
     std::vector<mfxPayload*> m_UserDataUnregSEI;
 
+#if (MFX_VERSION >= 1024)
+    BRCTraceRecorder m_BRCTrace;
+#endif
+
     CHWDevice *m_hwdev;
 
     bool m_bQPFileMode;
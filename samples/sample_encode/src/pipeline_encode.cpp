@@ -699,6 +699,12 @@ mfxStatus CEncodingPipeline::InitMfxEncParams(sInputParams *pInParams)
     {
         auto extBRC = m_mfxEncParams.AddExtBuffer<mfxExtBRC>();
         HEVCExtBRC::Create(*extBRC);
+
+        if (!pInParams->strBRCTraceFile.empty())
+        {
+            mfxStatus sts = m_BRCTrace.Attach(*extBRC, pInParams->strBRCTraceFile.c_str());
+            MSDK_CHECK_STATUS(sts, "m_BRCTrace.Attach failed");
+        }
     }
 #endif
 
@@ -1964,7 +1970,10 @@ void CEncodingPipeline::Close()
 #if (MFX_VERSION >= 1024)
     auto extBRC = m_mfxEncParams.GetExtBuffer<mfxExtBRC>();
     if (extBRC)
+    {
+        m_BRCTrace.Detach(*extBRC);
         HEVCExtBRC::Destroy(*extBRC);
+    }
 #endif
 
     DeallocateExtMVCBuffers();
@@ -181,6 +181,7 @@ void PrintHelp(msdk_char *strAppName, const msdk_char *strErrorMessage, ...)
 #endif
 #if (MFX_VERSION >= 1024)
     msdk_printf(MSDK_STRING("   [-extbrc:<on,off,implicit>] - External BRC for AVC and HEVC encoders\n"));
+    msdk_printf(MSDK_STRING("   [-brc_trace <file>]      - record calls of external BRC (-extbrc:on) to file for brc_replay tool\n"));
 #endif
 #if (MFX_VERSION >= 1026)
     msdk_printf(MSDK_STRING("   [-ExtBrcAdaptiveLTR:<on,off>] - Set AdaptiveLTR for implicit extbrc\n"));
@@ -1033,6 +1034,11 @@ mfxStatus ParseInputString(msdk_char* strInput[], mfxU8 nArgNum, sInputParams* p
         {
             pParams->nExtBRC = EXTBRC_IMPLICIT;
         }
+        else if (0 == msdk_strcmp(strInput[i], MSDK_STRING("-brc_trace")))
+        {
+            VAL_CHECK(i + 1 >= nArgNum, i, strInput[i]);
+            pParams->strBRCTraceFile = strInput[++i];
+        }
 #endif
 #if (MFX_VERSION >= 1026)
         else if (0 == msdk_strcmp(strInput[i], MSDK_STRING("-ExtBrcAdaptiveLTR:on")))
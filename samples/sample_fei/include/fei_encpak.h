@@ -22,6 +22,8 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 
 #include "encoding_task_pool.h"
 #include "predictors_repacking.h"
+#include "fei_repack.h"
+#include <memory>
 
 #ifndef MFX_VERSION
 #error MFX_VERSION not defined
@@ -70,6 +72,9 @@ public:
 
     mfxExtFeiEncMV::mfxExtFeiEncMVMB m_tmpMBencMV;
 
+    /* Rows of MBs are split between threads in Decode StreamOut -> PAK repacking */
+    std::unique_ptr<RowParallel> m_repackWorkers;
+
     FEI_EncPakInterface(MFXVideoSession* session, iTaskPool* task_pool, mfxU32 allocId, bufList* ext_bufs, AppConfig* config);
     ~FEI_EncPakInterface();
 
@@ -330,6 +330,7 @@ struct AppConfig
         , nDstHeight(0)
         , nInputSurf(0)
         , nReconSurf(0)
+        , nRepackThreads(1)
 
         , bUseHWmemory(true)          // only HW memory is supported (ENCODE supports SW memory)
 
@@ -443,6 +444,7 @@ struct AppConfig
 
     mfxU16 nInputSurf;
     mfxU16 nReconSurf;
+    mfxU16 nRepackThreads; // threads to split DecodeStreamOut repacking between
 
     bool   bUseHWmemory;
 
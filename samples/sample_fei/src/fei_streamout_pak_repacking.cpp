@@ -23,7 +23,6 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #error MFX_VERSION not defined
 #endif
 
-static mfxU32 mv_data_length_offset = 0;
 // Intra types remapped to cases with set cbp. H.264 Table 7-11.
 static const int mb_type_remap[26] = {0, 21, 22, 23, 24, 21, 22, 23, 24, 21, 22, 23, 24, 21, 22, 23, 24, 21, 22, 23, 24, 21, 22, 23, 24, 25};
 // Luma intra pred mode for H.264 Table 7-11.
@@ -47,16 +46,13 @@ static const mfxU8 sub_mb_type[1+22][4] = {
 // 3. Because of MV are changed, directMV and skip conditions have to be recomputed
 // 4. After MV elimination some splits can be enlarged
 
-inline mfxStatus RepackStremoutMB2PakMB(mfxFeiDecStreamOutMBCtrl* dsoMB, mfxFeiPakMBCtrl* pakMB, mfxU8 QP)
+// MBs are independent, so this and RepackStreamoutMV may be called for different MBs concurrently
+inline void RepackStremoutMB2PakMB(const mfxFeiDecStreamOutMBCtrl* dsoMB, mfxFeiPakMBCtrl* pakMB, mfxU32 mbIdx, mfxU8 QP)
 {
-    MSDK_CHECK_POINTER(dsoMB, MFX_ERR_NULL_PTR);
-    MSDK_CHECK_POINTER(pakMB, MFX_ERR_NULL_PTR);
-
     /* fill header */
     pakMB->Header              = MFX_PAK_OBJECT_HEADER;
     pakMB->MVDataLength        = dsoMB->IntraMbFlag? 0 : 128;
-    pakMB->MVDataOffset        = dsoMB->IntraMbFlag? 0 : mv_data_length_offset;
-    mv_data_length_offset     += 128;
+    pakMB->MVDataOffset        = dsoMB->IntraMbFlag? 0 : mbIdx * 128; // MV data of MB in mfxExtFeiEncMV
 
     pakMB->ExtendedFormat      = 1;
     pakMB->MVFormat            = dsoMB->IntraMbFlag ? 0 : 6;
@@ -109,19 +105,11 @@ inline mfxStatus RepackStremoutMB2PakMB(mfxFeiDecStreamOutMBCtrl* dsoMB, mfxFeiP
     pakMB->MaxSizeInWord    = 0xff;
 
     pakMB->reserved2[4]     = pakMB->IsLastMB ? 0x5000000 : 0; /* end of slice */
-
-    return MFX_ERR_NONE;
 }
 
-inline mfxStatus RepackStreamoutMV(mfxFeiDecStreamOutMBCtrl* dsoMB, mfxExtFeiEncMV::mfxExtFeiEncMVMB* encMB)
+inline void RepackStreamoutMV(const mfxFeiDecStreamOutMBCtrl* dsoMB, mfxExtFeiEncMV::mfxExtFeiEncMVMB* encMB)
 {
-
-    for (int i = 0; i < 16; i++){
-        encMB->MV[i][0] = dsoMB->MV[i>>2][0];
-        encMB->MV[i][1] = dsoMB->MV[i>>2][1];
-    }
-
-    return MFX_ERR_NONE;
+    FeiBroadcastMV8x8(dsoMB->MV, encMB->MV);
 }
 
 
@@ -590,10 +578,11 @@ mfxStatus FEI_EncPakInterface::PakOneStreamoutFrame(iTask *eTask, mfxU8 QP, iTas
     mfxExtFeiPakMBCtrl* feiEncMBCode = NULL;
     mfxExtFeiEncMV*     feiEncMV     = NULL;
 
+    mfxU32 widthMB = (m_videoParams_PAK.mfx.FrameInfo.Width + 15) >> 4;
+    MSDK_CHECK_ERROR(widthMB, 0, MFX_ERR_NOT_INITIALIZED);
+
     for (mfxU32 fieldId = 0; fieldId < numOfFields; ++fieldId)
     {
-        mv_data_length_offset = 0;
-
         /* get mfxExtFeiPakMBCtrl buffer */
         feiEncMBCode = reinterpret_cast<mfxExtFeiPakMBCtrl*>(eTask->bufs->PB_bufs.out.getBufById(MFX_EXTBUFF_FEI_PAK_CTRL, fieldId));
         MSDK_CHECK_POINTER(feiEncMBCode, MFX_ERR_NULL_PTR);
@@ -602,19 +591,28 @@ mfxStatus FEI_EncPakInterface::PakOneStreamoutFrame(iTask *eTask, mfxU8 QP, iTas
         feiEncMV = reinterpret_cast<mfxExtFeiEncMV*>(eTask->bufs->PB_bufs.out.getBufById(MFX_EXTBUFF_FEI_ENC_MV, fieldId));
         MSDK_CHECK_POINTER(feiEncMV, MFX_ERR_NULL_PTR);
 
-        /* repack streamout output to PAK input */
-        for (mfxU32 i = 0; i < feiEncMBCode->NumMBAlloc; ++i)
+        MSDK_CHECK_POINTER(pExtBufDecodeStreamout->MB, MFX_ERR_NULL_PTR);
+        MSDK_CHECK_POINTER(feiEncMBCode->MB,           MFX_ERR_NULL_PTR);
+        MSDK_CHECK_POINTER(feiEncMV->MB,               MFX_ERR_NULL_PTR);
+
+        /* NOTE: streamout holds data for both fields in MB array (first NumMBAlloc for first field data, second NumMBAlloc for second field) */
+        mfxFeiDecStreamOutMBCtrl* dsoMB = pExtBufDecodeStreamout->MB + fieldId*feiEncMBCode->NumMBAlloc;
+        mfxU32 numMB = feiEncMBCode->NumMBAlloc;
+
+        /* repack streamout output to PAK input, rows of MBs are independent */
+        m_repackWorkers->Run((numMB + widthMB - 1) / widthMB, 1, [&](mfxU32 rowBegin, mfxU32 rowEnd)
         {
-            /* temporary, this flag is not set at all by driver */
-            (pExtBufDecodeStreamout->MB + fieldId*feiEncMBCode->NumMBAlloc + i)->IsLastMB = (i == (feiEncMBCode->NumMBAlloc - 1));
+            for (mfxU32 i = rowBegin * widthMB; i < (std::min)(rowEnd * widthMB, numMB); ++i)
+            {
+                /* temporary, this flag is not set at all by driver */
+                dsoMB[i].IsLastMB = (i == (numMB - 1));
 
-            /* NOTE: streamout holds data for both fields in MB array (first NumMBAlloc for first field data, second NumMBAlloc for second field) */
-            sts = RepackStremoutMB2PakMB(pExtBufDecodeStreamout->MB + fieldId*feiEncMBCode->NumMBAlloc + i, feiEncMBCode->MB + i, QP);
-            MSDK_CHECK_STATUS(sts, "Decode StreamOut to PAK-object repacking: RepackStremoutMB2PakMB failed");
+                RepackStremoutMB2PakMB(dsoMB + i, feiEncMBCode->MB + i, i, QP);
+                RepackStreamoutMV(dsoMB + i, feiEncMV->MB + i);
+            }
+        });
 
-            sts = RepackStreamoutMV(pExtBufDecodeStreamout->MB + fieldId*feiEncMBCode->NumMBAlloc + i, feiEncMV->MB + i);
-            MSDK_CHECK_STATUS(sts, "Decode StreamOut to PAK-object repacking: RepackStreamoutMV failed");
-        }
+        /* direct MVs depend on neighbour MBs and colocated picture, so this part stays serial */
 
         sts = ResetDirect(eTask, pTaskList);
         MSDK_CHECK_STATUS(sts, "Decode StreamOut to PAK-object repacking: ResetDirect failed");
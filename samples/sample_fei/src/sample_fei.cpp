@@ -148,6 +148,7 @@ void PrintHelp(msdk_char *strAppName, const msdk_char *strErrorMessage)
     msdk_printf(MSDK_STRING("   [-rawref] - use raw frames for reference instead of reconstructed frames (ENCODE only)\n"));
     msdk_printf(MSDK_STRING("   [-n_surf_input n] - specify number of surfaces that would be allocated for input frames\n"));
     msdk_printf(MSDK_STRING("   [-n_surf_recon n] - specify number of surfaces that would be allocated for reconstruct frames (ENC or/and PAK)\n"));
+    msdk_printf(MSDK_STRING("   [-repack_threads n] - number of threads for DecodeStreamOut to PAK repacking (default is 1)\n"));
 
     // user module options
     msdk_printf(MSDK_STRING("\n"));
@@ -697,6 +698,11 @@ mfxStatus ParseInputString(msdk_char* strInput[], mfxU8 nArgNum, AppConfig* pCon
             i++;
             pConfig->nReconSurf = (mfxU16)msdk_strtol(strInput[i], &stopCharacter, 10);
         }
+        else if (0 == msdk_strcmp(strInput[i], MSDK_STRING("-repack_threads")))
+        {
+            i++;
+            pConfig->nRepackThreads = (mfxU16)msdk_strtol(strInput[i], &stopCharacter, 10);
+        }
         else if (0 == msdk_strcmp(strInput[i], MSDK_STRING("-w")))
         {
             i++;
@@ -22,6 +22,8 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 
 #include "sample_hevc_fei_defs.h"
 #include "mfxfeihevc.h"
+#include "fei_repack.h"
+#include <memory>
 
 class PredictorsRepaking
 {
@@ -41,6 +43,9 @@ public:
     inline void SetPerfomanceRepackingMode() { m_repakingMode = PERFORMANCE; }
     inline void SetQualityRepackingMode() { m_repakingMode = QUALITY; }
 
+    // rows of 16x16 blocks are split between numThreads threads (the calling one included)
+    void SetNumThreads(mfxU16 numThreads);
+
 private:
     const mfxU8  m_max_fei_enc_mvp_num;// maximum number of predictors for encoder
     //variables
@@ -54,11 +59,13 @@ private:
     mfxU16 m_heightCU_enc;         // height in CU (16x16) for encoder
     mfxU16 m_maxNumMvPredictorsL0;
     mfxU16 m_maxNumMvPredictorsL1;
+    std::unique_ptr<RowParallel> m_workers;
 
     //functions
     mfxStatus RepackPredictorsPerformance(const HevcTask& task, mfxExtFeiHevcEncMVPredictors& mvp, mfxU16 nMvPredictors[2]);
     mfxStatus RepackPredictorsQuality(const HevcTask& task, mfxExtFeiHevcEncMVPredictors& mvp, mfxU16 nMvPredictors[2]);
     mfxU8 ConvertDSratioPower2(mfxU8 DSfactor);
+    mfxStatus InitRepackPar(const HevcTask& task, mfxExtFeiHevcEncMVPredictors& mvp, mfxU8 numFinalL0Predictors, mfxU8 numFinalL1Predictors, bool bQuality, FeiHevcMvpRepackPar& par);
 
     DISALLOW_COPY_AND_ASSIGN(PredictorsRepaking);
 };
@@ -83,6 +83,7 @@ struct sInputParams
     bool bFormattedMVout;      // use internal format for dumping MVP
     bool bFormattedMVPin;      // use internal format for reading MVP
     bool bQualityRepack;       // use quality mode in MV repack
+    mfxU16 nRepackThreads;     // threads to split MV repack between
     bool bExtBRC;
     mfxU8  QP;
     mfxU16 dstWidth;           // destination picture width
@@ -119,6 +120,7 @@ struct sInputParams
         , bFormattedMVout(false)
         , bFormattedMVPin(false)
         , bQualityRepack(false)
+        , nRepackThreads(1)
         , bExtBRC(false)
         , QP(0)
         , dstWidth(0)
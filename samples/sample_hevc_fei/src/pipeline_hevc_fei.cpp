@@ -620,6 +620,7 @@ FEI_Encode* CEncodingPipeline::CreateEncode(mfxFrameInfo& in_fi)
         CHECK_STS_AND_RETURN(sts, "CreateEncode::pRepacker->Init failed", NULL);
 
         m_inParams.bQualityRepack ? pRepacker->SetQualityRepackingMode() : pRepacker->SetPerfomanceRepackingMode();
+        pRepacker->SetNumThreads(m_inParams.nRepackThreads);
     }
 
     mfxHDL hdl = NULL;
@@ -141,6 +141,7 @@ void PrintHelp(const msdk_char *strAppName, const msdk_char *strErrorMessage)
     msdk_printf(MSDK_STRING("   [-MultiPredL1 type]         - use internal L1 MV predictors (0 - no internal MV predictor, 1 - spatial internal MV predictors)\n"));
     msdk_printf(MSDK_STRING("   [-MVPBlockSize size]        - external MV predictor block size (0 - no MVP, 1 - MVP per 16x16, 2 - MVP per 32x32, 7 - use with -mvpin)\n"));
     msdk_printf(MSDK_STRING("   [-qrep]                     - quality  MV predictors repacking before encode\n"));
+    msdk_printf(MSDK_STRING("   [-RepackThreads num]        - number of threads for MV predictors repacking (default is 1)\n"));
 
     msdk_printf(MSDK_STRING("Partitioning: \n"));
     msdk_printf(MSDK_STRING("   [-ForceCtuSplit]          - force splitting CTU into CU at least once\n"));
@@ -355,6 +356,11 @@ mfxStatus ParseInputString(msdk_char* strInput[], mfxU32 nArgNum, sInputParams&
             params.bQualityRepack = true;                  // to enable quality mode in repack
             params.preencCtrl.DisableStatisticsOutput = 0; // to gather statistics in preenc, needed for quality repack
         }
+        else if (0 == msdk_strcmp(strInput[i], MSDK_STRING("-RepackThreads")))
+        {
+            CHECK_NEXT_VAL(i + 1 >= nArgNum, strInput[i], strInput[0]);
+            PARSE_CHECK(msdk_opt_read(strInput[++i], params.nRepackThreads), "RepackThreads", isParseInvalid);
+        }
         else if (0 == msdk_strcmp(strInput[i], MSDK_STRING("-ppyr:on")))
         {
             params.PRefType = MFX_P_REF_PYRAMID;
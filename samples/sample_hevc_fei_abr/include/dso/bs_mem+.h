@@ -1,4 +1,4 @@
-// Copyright (c) 2018 Intel Corporation
+// Copyright (c) 2018-2020 Intel Corporation
 //
 // Permission is hereby granted, free of charge, to any person obtaining a copy
 // of this software and associated documentation files (the "Software"), to deal
@@ -22,7 +22,13 @@
 #include <map>
 #include <list>
 #include <set>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <type_traits>
+#include <new>
 #include <mutex>
+#include <stdlib.h>
 #include <memory.h>
 
 //#define BS_MEM_TRACE
@@ -34,118 +40,495 @@
 namespace BS_MEM
 {
 
-class MemBase
+/*
+    Objects are carved from per-root bump arenas: alloc() without base opens a new
+    arena, alloc() with base places the object into the arena of its base.
+    Sub-objects are released together with their arena, so lifetime tracking
+    (bound/lock/unlock/free) is done per arena instead of per object:
+     - bound(root, base)  - arena of the root is released when all its bases are gone
+     - bound(child, base) - arena of the child is pinned until base is released
+     - lock/unlock(child) - locks the whole arena
+     - free(child)        - destroys the child, its block is reused by the next
+                            allocation of the same size in the arena
+    Pointers are validated against the chunks of live arenas before their header
+    is read, so a stale or foreign pointer is rejected instead of dereferenced.
+*/
+class Allocator
 {
-public:
-    virtual void* Get() = 0;
-    virtual ~MemBase(){}
-};
+private:
+    static const unsigned int MAGIC        = 0xB5AE7A00;
+    static const size_t       ALIGN        = 16;
+    static const size_t       MIN_CHUNK    = 4 * 1024;
+    static const size_t       MAX_CHUNK    = 64 * 1024;
+    static const unsigned int NUM_CLASSES  = 5;  // 4K..64K
+    static const unsigned int MAX_CACHED   = 64; // per class
 
-template<class T> class MemObj : public MemBase
-{
-public:
-    T* m_obj;
-    bool m_del;
+    struct Arena;
 
-    MemObj(unsigned int count, bool zero)
+    struct alignas(16) ObjHdr
     {
-        if (zero)
-            m_obj = new T[count]{}; // array value-initialization
+        Arena*       arena;
+        unsigned int magic;
+        unsigned int size; // carved size including this header
+    };
+
+    struct alignas(16) Chunk
+    {
+        Chunk* next;
+        size_t size; // including this header
+    };
+
+    struct Dtor
+    {
+        void (*destroy)(void*, unsigned int);
+        void* p;
+        unsigned int count;
+    };
+
+    struct ChunkRef
+    {
+        size_t size;
+        Arena* arena;
+    };
+
+    struct Arena
+    {
+        void*  root = nullptr;
+        Chunk* chunks = nullptr;
+        char*  cur = nullptr;
+        size_t left = 0;
+        size_t grow = MIN_CHUNK;
+        unsigned int locked = 0;
+        bool to_delete = false;
+        std::vector<Arena*> base; // owners of the root object
+        std::vector<Arena*> pin;  // owners of some sub-object
+        std::vector<Arena*> dep;  // arenas owned or pinned by this one
+        std::vector<Dtor> dtor;
+        std::map<size_t, void*> freed; // size -> list of freed sub-object blocks
+    };
+
+    std::unordered_set<Arena*> m_arena;
+    std::map<char*, ChunkRef> m_chunk; // chunks of live arenas by address
+    Chunk* m_cache[NUM_CLASSES];
+    unsigned int m_cached[NUM_CLASSES];
+    std::mutex m_mtx;
+    bool m_zero;
+
+    inline void __notrace(const char*, ...) {}
+
+#ifdef BS_MEM_TRACE
+#define BS_MEM_TRACE_F printf
+#else
+#define BS_MEM_TRACE_F __notrace
+#endif
+
+    static inline size_t Align(size_t n) { return (n + ALIGN - 1) & ~(ALIGN - 1); }
+
+    static inline int SizeClass(size_t size)
+    {
+        for (unsigned int i = 0; i < NUM_CLASSES; i++)
+            if (size == (MIN_CHUNK << i))
+                return (int)i;
+        return -1;
+    }
+
+    static inline ObjHdr* Hdr(void* p) { return (ObjHdr*)p - 1; }
+
+    Chunk* NewChunk(size_t size)
+    {
+        int cls = SizeClass(size);
+        Chunk* c = nullptr;
+
+        if (cls >= 0 && m_cache[cls])
+        {
+            c = m_cache[cls];
+            m_cache[cls] = c->next;
+            m_cached[cls]--;
+        }
         else
-            m_obj = new T[count];
-        m_del = true;
+        {
+            c = (Chunk*)malloc(size);
+            if (!c)
+                throw std::bad_alloc();
+        }
+
+        c->next = nullptr;
+        c->size = size;
+        return c;
     }
 
-    MemObj(T* obj)
-        : m_obj(obj)
-        , m_del(false)
-    {}
+    void DeleteChunk(Chunk* c)
+    {
+        int cls = SizeClass(c->size);
+
+        if (cls >= 0 && m_cached[cls] < MAX_CACHED)
+        {
+            c->next = m_cache[cls];
+            m_cache[cls] = c;
+            m_cached[cls]++;
+            return;
+        }
+
+        ::free(c);
+    }
+
+    Chunk* NewArenaChunk(Arena& a, size_t size)
+    {
+        Chunk* c = NewChunk(size);
+
+        try
+        {
+            m_chunk[(char*)c] = { size, &a };
+        }
+        catch (...)
+        {
+            DeleteChunk(c);
+            throw;
+        }
 
-    MemObj(const MemObj&) = delete;
-    MemObj& operator=(const MemObj&) = delete;
+        return c;
+    }
 
-    virtual ~MemObj()
+    void DeleteArenaChunk(Chunk* c)
     {
-        if (m_del)
-            delete[] m_obj;
+        m_chunk.erase((char*)c);
+        DeleteChunk(c);
     }
 
-    void* Get() { return m_obj; }
-};
+    void* Carve(Arena& a, size_t size)
+    {
+        size = Align(size);
 
-class MemD
-{
-public:
-    MemD()
-        : locked(0)
-        , to_delete(false)
-        , mem(nullptr)
+        auto freed = a.freed.find(size);
+        if (freed != a.freed.end())
+        {
+            // freed blocks are chained through their first bytes
+            void* p = freed->second;
+            freed->second = *(void**)p;
+            if (!freed->second)
+                a.freed.erase(freed);
+            return p;
+        }
+
+        if (size > a.left)
+        {
+            size_t need = sizeof(Chunk) + size;
+
+            if (need > MAX_CHUNK / 2)
+            {
+                // dedicated chunk, keep bumping in the current one
+                Chunk* c = NewArenaChunk(a, need);
+                c->next = a.chunks->next;
+                a.chunks->next = c;
+                return c + 1;
+            }
+
+            while (a.grow < need)
+                a.grow *= 2;
+
+            Chunk* c = NewArenaChunk(a, a.grow);
+            c->next = a.chunks;
+            a.chunks = c;
+            a.cur = (char*)(c + 1);
+            a.left = a.grow - sizeof(Chunk);
+
+            if (a.grow < MAX_CHUNK)
+                a.grow *= 2;
+        }
+
+        void* p = a.cur;
+        a.cur += size;
+        a.left -= size;
+        return p;
+    }
+
+    Arena* NewArena()
     {
+        const size_t hdr = sizeof(Chunk) + Align(sizeof(Arena));
+        Chunk* c = NewChunk(MIN_CHUNK);
+        Arena* a = new (c + 1) Arena;
+
+        a->chunks = c;
+        a->cur = (char*)c + hdr;
+        a->left = MIN_CHUNK - hdr;
+        a->grow = MIN_CHUNK * 2;
+
+        try
+        {
+            m_arena.insert(a);
+            m_chunk[(char*)c] = { MIN_CHUNK, a };
+        }
+        catch (...)
+        {
+            m_arena.erase(a);
+            a->~Arena();
+            DeleteChunk(c);
+            throw;
+        }
+
+        return a;
     }
 
-    ~MemD()
+    void DeleteArena(Arena* a)
     {
-        if (mem)
-            delete mem;
+        for (auto it = a->dtor.rbegin(); it != a->dtor.rend(); it++)
+            it->destroy(it->p, it->count);
+
+        Chunk* c = a->chunks;
+        a->~Arena();
+
+        // the chunk holding the arena header is the last one in the list
+        while (c)
+        {
+            Chunk* next = c->next;
+            DeleteArenaChunk(c);
+            c = next;
+        }
     }
 
-    unsigned int locked;
-    bool to_delete;
-    std::set<void*> base;
-    std::set<void*> dep;
-    MemBase* mem;
-};
+    // Destroys a sub-object and makes its block available to the arena again
+    void FreeSubObject(Arena& a, void* p)
+    {
+        ObjHdr* hdr = Hdr(p);
+        size_t  size = hdr->size;
 
-class Allocator
-{
-private:
-    std::map<void*, MemD> m_mem;
-    std::recursive_mutex m_mtx;
-    bool m_zero;
+        for (auto it = a.dtor.rbegin(); it != a.dtor.rend(); it++)
+        {
+            if (it->p != p)
+                continue;
 
-    inline bool Touch(void* p) { return !!m_mem.count(p); }
-    inline void __notrace(const char*, ...) {}
+            it->destroy(it->p, it->count);
+            a.dtor.erase(std::next(it).base());
+            break;
+        }
 
-#ifdef BS_MEM_TRACE
-#define BS_MEM_TRACE_F printf
-#else
-#define BS_MEM_TRACE_F __notrace
-#endif
+        hdr->magic = 0;
+
+        // an object filling a whole chunk (dedicated chunks) gives the chunk back
+        Chunk* c = (Chunk*)hdr - 1;
+        auto ref = m_chunk.find((char*)c);
+        if (ref != m_chunk.end() && ref->second.size == sizeof(Chunk) + size)
+        {
+            Chunk** link = &a.chunks;
+            while (*link && *link != c)
+                link = &(*link)->next;
+
+            if (*link)
+            {
+                if (c == a.chunks)
+                    a.left = 0;
+                *link = c->next;
+                DeleteArenaChunk(c);
+                return;
+            }
+        }
+
+        void*& head = a.freed[size];
+        *(void**)hdr = head;
+        head = hdr;
+    }
+
+    template<class T> static void Destroy(void* p, unsigned int count)
+    {
+        for (unsigned int i = count; i > 0; i--)
+            ((T*)p)[i - 1].~T();
+    }
+
+    template<class T> static void Construct(Arena&, T* p, unsigned int count, bool zero, std::true_type)
+    {
+        if (zero)
+            memset(p, 0, sizeof(T) * count);
+    }
+
+    template<class T> static void Construct(Arena& a, T* p, unsigned int count, bool zero, std::false_type)
+    {
+        a.dtor.reserve(a.dtor.size() + 1);
+
+        if (zero)
+            for (unsigned int i = 0; i < count; i++)
+                new (p + i) T();
+        else
+            for (unsigned int i = 0; i < count; i++)
+                new (p + i) T;
+
+        a.dtor.push_back({ &Destroy<T>, p, count });
+    }
+
+    template<class T> T* Alloc(void* base, unsigned int count, bool zero)
+    {
+        static_assert(alignof(T) <= ALIGN, "BS_MEM: unsupported alignment");
+
+        Arena* a = nullptr;
+        bool   newArena = !base;
+
+        if (base)
+        {
+            if (!Touch(base))
+                throw std::bad_alloc();
+            a = Hdr(base)->arena;
+        }
+        else
+            a = NewArena();
+
+        try
+        {
+            ObjHdr* hdr = (ObjHdr*)Carve(*a, sizeof(ObjHdr) + sizeof(T) * count);
+            T* p = (T*)(hdr + 1);
+
+            hdr->arena = a;
+            hdr->magic = MAGIC;
+            hdr->size  = (unsigned int)Align(sizeof(ObjHdr) + sizeof(T) * count);
+
+            Construct(*a, p, count, zero, std::integral_constant<bool,
+                   std::is_trivially_default_constructible<T>::value
+                && std::is_trivially_destructible<T>::value>());
+
+            if (newArena)
+                a->root = p;
+
+            return p;
+        }
+        catch (...)
+        {
+            if (newArena)
+            {
+                m_arena.erase(a);
+                DeleteArena(a);
+            }
+            throw;
+        }
+    }
+
+    inline bool Touch(void* p)
+    {
+        if (!p || ((size_t)p & (ALIGN - 1)))
+            return false;
+
+        // the header is read only if it lies inside a chunk of a live arena
+        auto it = m_chunk.upper_bound((char*)p);
+        if (it == m_chunk.begin())
+            return false;
+        --it;
+
+        char* begin = it->first + sizeof(Chunk);
+        char* end   = it->first + it->second.size;
+        if ((char*)p < begin + sizeof(ObjHdr) || (char*)p >= end)
+            return false;
+
+        ObjHdr* hdr = Hdr(p);
+        return hdr->magic == MAGIC && hdr->arena == it->second.arena;
+    }
+
+    static inline bool Erase(std::vector<Arena*>& v, Arena* a)
+    {
+        auto it = std::find(v.begin(), v.end(), a);
+        if (it == v.end())
+            return false;
+        *it = v.back();
+        v.pop_back();
+        return true;
+    }
+
+    static inline void Insert(std::vector<Arena*>& v, Arena* a)
+    {
+        if (std::find(v.begin(), v.end(), a) == v.end())
+            v.push_back(a);
+    }
+
+    void Release(Arena* a)
+    {
+        if (a->locked || !a->pin.empty())
+        {
+            BS_MEM_TRACE_F(" - delayed\n");
+            a->to_delete = true;
+            return;
+        }
+
+        if (!a->base.empty())
+        {
+            BS_MEM_TRACE_F(" - delayed\n");
+            return;
+        }
+
+        BS_MEM_TRACE_F(" - done\n");
+
+        m_arena.erase(a);
+
+        for (auto d : a->dep)
+        {
+            if (!m_arena.count(d))
+                continue;
+
+            bool wasBase = Erase(d->base, a);
+            bool wasPin  = Erase(d->pin, a);
+
+            if ((wasBase && d->base.empty()) || (wasPin && d->to_delete))
+                Release(d);
+        }
+
+        DeleteArena(a);
+    }
 
 public:
 
     Allocator()
         : m_zero(false)
     {
+        for (unsigned int i = 0; i < NUM_CLASSES; i++)
+        {
+            m_cache[i] = nullptr;
+            m_cached[i] = 0;
+        }
     }
 
     ~Allocator()
     {
+        for (auto a : m_arena)
+            DeleteArena(a);
+
+        for (unsigned int i = 0; i < NUM_CLASSES; i++)
+        {
+            while (m_cache[i])
+            {
+                Chunk* next = m_cache[i]->next;
+                ::free(m_cache[i]);
+                m_cache[i] = next;
+            }
+        }
     }
 
+    Allocator(const Allocator&) = delete;
+    Allocator& operator=(const Allocator&) = delete;
+
     void SetZero(bool zero)
     {
-        std::unique_lock<std::recursive_mutex> _lock(m_mtx);
+        std::unique_lock<std::mutex> _lock(m_mtx);
         m_zero = zero;
     }
 
     bool touch(void* p)
     {
-        std::unique_lock<std::recursive_mutex> _lock(m_mtx);
+        std::unique_lock<std::mutex> _lock(m_mtx);
         BS_MEM_TRACE_F("BS_MEM::touch(%p)\n", p);
         return Touch(p);
     }
 
     void bound(void* dep, void* base)
     {
-        std::unique_lock<std::recursive_mutex> _lock(m_mtx);
+        std::unique_lock<std::mutex> _lock(m_mtx);
         BS_MEM_TRACE_F("BS_MEM::bound(%p, %p)\n", dep, base);
 
         if (!Touch(base) || !Touch(dep))
             throw std::bad_alloc();
 
-        m_mem[base].dep.insert(dep);
-        m_mem[dep].base.insert(base);
+        Arena* a = Hdr(dep)->arena;
+        Arena* b = Hdr(base)->arena;
+
+        if (a == b)
+            return;
+
+        Insert(a->root == dep ? a->base : a->pin, b);
+        Insert(b->dep, a);
     }
 
     template<class T> T* alloc(void* base = nullptr, unsigned int count = 1)
@@ -153,16 +536,9 @@ public:
         if (count == 0)
             return nullptr;
 
-        std::unique_lock<std::recursive_mutex> _lock(m_mtx);
-
-        MemBase* pObj = new MemObj<T>(count, m_zero);
-        T* p = (T*)pObj->Get();
-
-        m_mem[p].mem = pObj;
-
+        std::unique_lock<std::mutex> _lock(m_mtx);
+        T* p = Alloc<T>(base, count, m_zero);
         BS_MEM_TRACE_F("BS_MEM::alloc(%p, %d) = %p\n", base, count, p);
-        if (base)
-            bound(p, base);
 
         return p;
     }
@@ -172,67 +548,42 @@ public:
         if (count == 0)
             return nullptr;
 
-        std::unique_lock<std::recursive_mutex> _lock(m_mtx);
-
-        MemBase* pObj = new MemObj<T>(count, false);
-        T* p = (T*)pObj->Get();
-
-        m_mem[p].mem = pObj;
-
+        std::unique_lock<std::mutex> _lock(m_mtx);
+        T* p = Alloc<T>(base, count, false);
         BS_MEM_TRACE_F("BS_MEM::alloc_nozero(%p, %d) = %p\n", base, count, p);
-        if (base)
-            bound(p, base);
 
         return p;
     }
 
     void free(void* p)
     {
-        std::unique_lock<std::recursive_mutex> _lock(m_mtx);
+        std::unique_lock<std::mutex> _lock(m_mtx);
         BS_MEM_TRACE_F("BS_MEM::free(%p)", p);
 
         if (!Touch(p))
             throw std::bad_alloc();
 
-        auto& d = m_mem[p];
-
-        if (d.locked)
-        {
-            BS_MEM_TRACE_F(" - delayed\n", p);
-            d.to_delete = true;
-            return;
-        }
+        Arena* a = Hdr(p)->arena;
 
-        if (!d.base.empty())
+        if (a->root != p)
         {
-            BS_MEM_TRACE_F(" - delayed\n", p);
+            BS_MEM_TRACE_F(" - sub-object\n");
+            FreeSubObject(*a, p);
             return;
         }
 
-        BS_MEM_TRACE_F(" - done\n", p);
-
-        for (auto& pdep : d.dep)
-        {
-            auto& ddep = m_mem[pdep];
-
-            ddep.base.erase(p);
-
-            if (ddep.base.empty())
-                free(pdep);
-        }
-
-        m_mem.erase(p);
+        Release(a);
     }
 
     void lock(void* p)
     {
-        std::unique_lock<std::recursive_mutex> _lock(m_mtx);
+        std::unique_lock<std::mutex> _lock(m_mtx);
         BS_MEM_TRACE_F("BS_MEM::lock(%p)\n", p);
 
         if (!Touch(p))
             throw std::bad_alloc();
 
-        m_mem[p].locked++;
+        Hdr(p)->arena->locked++;
     }
 
     void unlock(void* p)
@@ -242,20 +593,24 @@ public:
         if (!p)
             return;
 
-        std::unique_lock<std::recursive_mutex> _lock(m_mtx);
+        std::unique_lock<std::mutex> _lock(m_mtx);
 
         if (!Touch(p))
             throw std::bad_alloc();
 
-        auto& d = m_mem[p];
+        Arena* a = Hdr(p)->arena;
 
-        if (!m_mem[p].locked)
+        if (!a->locked)
             throw std::bad_alloc();
 
-        d.locked--;
+        a->locked--;
 
-        if (d.to_delete)
-            free(p);
+        if (a->to_delete && !a->locked)
+        {
+            a->to_delete = false;
+            BS_MEM_TRACE_F("BS_MEM::free(%p)", a->root);
+            Release(a);
+        }
     }
 #undef BS_MEM_TRACE_F
 };
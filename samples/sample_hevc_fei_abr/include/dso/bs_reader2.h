@@ -384,8 +384,8 @@ private:
     Bs64u m_tla;
     Bs32u m_tln;
 
-    void MoreData(Bs32u keepBytes = 4);
-    bool MoreDataNoThrow(Bs32u keepBytes = 4);
+    void MoreData(Bs32u keepBytes = 16);
+    bool MoreDataNoThrow(Bs32u keepBytes = 16);
 };
 
 class TLAuto
@@ -23,7 +23,7 @@
 #include "bs_reader2.h"
 #include "hevc_cabac.h"
 
-#define BS_AVC2_ADE_MODE 1 //0 - literal standard implementation, 1 - optimized(2-byte buffering affects SE offsets in trace)
+#define BS_AVC2_ADE_MODE 1 //0 - literal standard implementation, 1 - optimized(64-bit window buffering affects SE offsets in trace)
 
 namespace COMMON_CABAC
 {
@@ -34,11 +34,42 @@ namespace COMMON_CABAC
         Bs64u m_bpos  = 0;
         bool  m_pcm   = false;
 #if (BS_AVC2_ADE_MODE == 1)
-        Bs32u m_val   = 0;
+        // m_val keeps 9-bit codIOffset followed by m_bits look-ahead bits (m_bits > 0 between calls)
+        Bs64u m_val   = 0;
         Bs32u m_range = 0;
         Bs32s m_bits  = 0;
+        Bs32s m_pad   = 0; // zero bits appended past the end of buffer
 
-        inline Bs32u B(Bs16u n) { m_bpos += n * 8; return m_bs.GetBytes(n, true); }
+        static const Bs32s REFILL_BITS = 48;
+
+        inline Bs64u B(Bs16u n)
+        {
+            Bs64u start = m_bs.GetByteOffset();
+            Bs64u b = m_bs.GetBytes(n, true);
+            Bs64u got = m_bs.GetByteOffset() - start;
+
+            if (got < n)
+                m_pad += Bs32s(n - got) * 8;
+
+            m_bpos += n * 8;
+            return b;
+        }
+        inline void  Refill()
+        {
+            Bs64u hi = B(4);
+            Bs64u lo = B(2);
+            m_val = (m_val << REFILL_BITS) | (hi << 16) | lo;
+            m_bits += REFILL_BITS;
+        }
+        inline void  Flush()
+        {
+            // only return bits that were really taken from the reader
+            if (m_bits > m_pad)
+                m_bs.ReturnBits(m_bits - m_pad);
+            m_bpos -= m_bits;
+            m_bits = 0;
+            m_pad = 0;
+        }
 #else
         Bs16u m_codIRange;
         Bs16u m_codIOffset;
@@ -54,12 +85,14 @@ namespace COMMON_CABAC
         inline void Init()
         {
             #if (BS_AVC2_ADE_MODE == 1)
-            m_val = B(3);
+            m_val = 0;
+            m_bits = -9;
+            m_pad = 0;
+            Refill();
             m_range = 510;
-            m_bits = 15;
 
             if (!m_pcm)
-                m_bpos = 15;
+                m_bpos = m_bits;
             #else
             m_codIRange = 510;
             m_codIOffset = b(9);
@@ -72,13 +105,14 @@ namespace COMMON_CABAC
 
         Bs8u DecodeDecision(Bs8u& ctxState);
         Bs8u DecodeBypass();
+        Bs32u DecodeBypass(Bs32u n); // n <= 32 bypass bins, first bin in MSB
         Bs8u DecodeTerminate();
 
         #if (BS_AVC2_ADE_MODE == 1)
         inline Bs16u GetR() { return Bs16u(m_range); }
         inline Bs16u GetV() { return Bs16u((m_val >> (m_bits))); }
         inline Bs64u BitCount() { return m_bpos - m_bits; }
-        inline void  InitPCMBlock() { m_bs.ReturnBits(m_bits); m_bpos -= m_bits; m_bits = 0; m_pcm = true; }
+        inline void  InitPCMBlock() { Flush(); m_pcm = true; }
         #else
         inline Bs16u GetR() { return m_codIRange; }
         inline Bs16u GetV() { return m_codIOffset; }
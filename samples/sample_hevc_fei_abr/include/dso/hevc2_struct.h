@@ -35,8 +35,9 @@ enum INIT_MODE
     PARALLEL_SD         = 0x04,
     PARALLEL_TILES      = 0x08,
     PARSE_SSD_TC        = 0x10 | PARSE_SSD,
+    PARALLEL_WPP        = 0x20,
 
-    ASYNC               = (PARALLEL_AU | PARALLEL_SD | PARALLEL_TILES)
+    ASYNC               = (PARALLEL_AU | PARALLEL_SD | PARALLEL_TILES | PARALLEL_WPP)
 };
 
 enum TRACE_LEVEL
@@ -24,6 +24,8 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include "fei_utils.h"
 #include "bs_parser++.h"
 
+#include <deque>
+
 class HevcSwDso : public IYUVSource
 {
 public:
@@ -37,7 +39,7 @@ public:
               DIST_EST_ALGO alg  = NNZ)
         : IYUVSource(inPars, sp)
         , m_inPars(inPars)
-        , m_parser(est_dist ? BS_HEVC2::PARSE_SSD_TC : BS_HEVC2::PARSE_SSD)
+        , m_parser((est_dist ? BS_HEVC2::PARSE_SSD_TC : BS_HEVC2::PARSE_SSD) | (inPars.DSOAsyncDepth ? BS_HEVC2::ASYNC : 0))
         , m_mvpPool(mvpPool)
         , m_ctuCtrlPool(ctuCtrlPool)
         , m_bCalcBRCStat(calc_BRC_stat)
@@ -49,6 +51,7 @@ public:
 
     virtual ~HevcSwDso()
     {
+        Close();
     }
 
     virtual mfxStatus SetBufferAllocator(std::shared_ptr<FeiBufferAllocator> & bufferAlloc) override
@@ -61,13 +64,15 @@ public:
     virtual mfxStatus QueryIOSurf(mfxFrameAllocRequest* request) override { return MFX_ERR_UNSUPPORTED; }
     virtual mfxStatus PreInit() override { return MFX_ERR_UNSUPPORTED; }
     virtual mfxStatus Init()    override;
-    virtual void      Close()   override { return; }
+    virtual void      Close()   override;
 
     virtual mfxStatus GetActualFrameInfo(mfxFrameInfo & info) override { return MFX_ERR_UNSUPPORTED; }
     virtual mfxStatus GetFrame(mfxFrameSurface1* & pSurf)     override { return MFX_ERR_UNSUPPORTED; }
     virtual mfxStatus GetFrame(HevcTaskDSO & task)            override;
 
 protected:
+    mfxStatus ParseNextAU(BS_HEVC2::NALU* & au);
+
     void FillFrameTask(const BS_HEVC2::NALU* header, HevcTaskDSO & task);
     void FillMVP(const BS_HEVC2::NALU* header, mfxExtFeiHevcEncMVPredictors & mvp, mfxU32 nMvPredictors[2]);
     void FillCtuControls(const BS_HEVC2::NALU* header, mfxExtFeiHevcEncCtuCtrl & ctuCtrls);
@@ -92,6 +97,11 @@ private:
     mfxI32 m_DisplayOrderSinceLastIDR = 0, m_previousMaxDisplayOrder = -1;
     mfxU32 m_ProcessedFrames = 0;
 
+    // Streaming mode: AUs submitted to parser and not yet extracted, in decoding order
+    std::deque<BS_HEVC2::NALU*> m_auQueue;
+    mfxU16 m_asyncDepth = 0;
+    bool   m_bEOS       = false;
+
     DISALLOW_COPY_AND_ASSIGN(HevcSwDso);
 };
 
@@ -41,6 +41,7 @@ struct SourceFrameInfo
     bool       forceToInter;
 
     mfxU16 DSOMVPBlockSize;
+    mfxU16 DSOAsyncDepth;  // number of AUs parsed by DSO in parallel (0 - serial parsing)
 
     SourceFrameInfo()
         : DecodeId(0)
@@ -48,6 +49,7 @@ struct SourceFrameInfo
         , forceToIntra(false)
         , forceToInter(false)
         , DSOMVPBlockSize(7)
+        , DSOAsyncDepth(0)
     {
         MSDK_ZERO_MEMORY(strSrcFile);
         MSDK_ZERO_MEMORY(strDsoFile);
@@ -117,6 +117,7 @@ void PrintHelp(const msdk_char *strErrorMessage)
     msdk_printf(MSDK_STRING("                                 0 - no MVP, 1 - MVP per 16x16 block, 2 - MVP per 32x32 block, 7 - MVP block size specified in the MVP structs (default) \n"));
     msdk_printf(MSDK_STRING("   [-DSOMVPBlockSize size]     - force DSO to generate MVP buffer with MVPs per block size:  \n"));
     msdk_printf(MSDK_STRING("                                 0 - no DSO MVP output, 1 - MVP per 16x16 block, 2 - MVP per 32x32 block, 7 - determined by CTU partitioning (default) \n"));
+    msdk_printf(MSDK_STRING("   [-DSOAsyncDepth depth]      - number of access units DSO parses in parallel ahead of encoding (0 - serial parsing (default)) \n"));
     msdk_printf(MSDK_STRING("   [-DrawMVP] - creates output YUV file with MVP overlay\n"));
     msdk_printf(MSDK_STRING("   [-DumpMVP] - dumps final per-frame MVP structures with DSO data as binary files with filenames\n"));
     msdk_printf(MSDK_STRING("                'MVPdump_encorder_frame_%%(frame_number_in_encoded_order).bin' (frame numbering starts with 1)\n"));
@@ -554,6 +555,11 @@ mfxStatus CmdProcessor::ParseParamsForOneSession(mfxU32 argc, msdk_char* argv[])
             CHECK_NEXT_VAL(i + 1 >= argc, argv[i]);
             PARSE_CHECK(msdk_opt_read(argv[++i], params.input.DSOMVPBlockSize), "DSOMVPBlockSize", isParseInvalid);
         }
+        else if (0 == msdk_strcmp(argv[i], MSDK_STRING("-DSOAsyncDepth")))
+        {
+            CHECK_NEXT_VAL(i + 1 >= argc, argv[i]);
+            PARSE_CHECK(msdk_opt_read(argv[++i], params.input.DSOAsyncDepth), "DSOAsyncDepth", isParseInvalid);
+        }
         else if (0 == msdk_strcmp(argv[i], MSDK_STRING("-MVPBlockSize")))
         {
             CHECK_NEXT_VAL(i + 1 >= argc, argv[i]);
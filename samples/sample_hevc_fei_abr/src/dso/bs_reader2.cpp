@@ -340,7 +340,7 @@ Bs32u Reader::ExtractData(Bs8u* buf, Bs32u size)
     while (buf < end)
     {
         Bs32u S = Bs32u(m_bsEnd - m_bs);
-        S = BS_MIN(S, size);
+        S = BS_MIN(S, Bs32u(end - buf));
 
         memmove(buf, m_bs, S);
         buf  += S;
@@ -348,7 +348,7 @@ Bs32u Reader::ExtractData(Bs8u* buf, Bs32u size)
 
         if (m_bsEnd == m_bs)
         {
-            if (MoreDataNoThrow())
+            if (!MoreDataNoThrow())
                 break;
         }
     }
@@ -69,6 +69,7 @@ Scheduler::Scheduler()
     m_locked = 0;
     m_id = 0;
     m_depth = 0;
+    m_nReady = 0;
 }
 
 Scheduler::~Scheduler()
@@ -441,6 +442,24 @@ void Scheduler::_AbortDependent(Task& task)
     BS_THREAD_TRACE_FLUSH;
 }
 
+void Scheduler::Wake()
+{
+    std::unique_lock<std::recursive_mutex> lock(m_mtx);
+    BS_THREAD_TRACE_F("Scheduler::Wake()\n");
+    BS_THREAD_TRACE_FLUSH;
+
+    // tasks still working see the new counter when they return WAITING
+    m_nReady++;
+
+    for (auto& task : m_task)
+    {
+        if (task.state == WAITING && !task.blocked)
+            task.state = QUEUED;
+    }
+
+    Update(*this, 0);
+}
+
 void Scheduler::Execute(Thread& self, Scheduler& sync)
 {
     std::unique_lock<std::mutex> lockThread(self.mtx);
@@ -493,6 +512,12 @@ void Scheduler::Update(Scheduler& self, Thread* thread)
         if (thread->task->state == WORKING)
             thread->task->state = QUEUED;
 
+        // other task finished while this one was polling, its wake-up is missed otherwise
+        if (   thread->task->state == WAITING
+            && !thread->task->blocked
+            && thread->task->nReady != self.m_nReady)
+            thread->task->state = QUEUED;
+
         if (   thread->task->state == DONE
             || thread->task->state == FAILED)
         {
@@ -525,6 +550,8 @@ void Scheduler::Update(Scheduler& self, Thread* thread)
 
         if (Ready(thread->task->state))
         {
+            self.m_nReady++;
+
             for (auto& task : self.m_task)
             {
                 if (   task.state == WAITING
@@ -588,6 +615,7 @@ void Scheduler::Update(Scheduler& self, Thread* thread)
 
         pThread->task = pTask;
         pTask->state = WORKING;
+        pTask->nReady = self.m_nReady;
 
         BS_THREAD_TRACE_F("    : TH=%d ID=%d P=%d N=%d -- EXECUTE\n",
             pThread->id, pTask->id, pTask->priority, pTask->n);
@@ -24,55 +24,77 @@ using namespace COMMON_CABAC;
 using namespace BS_HEVC;
 
 // ADE ////////////////////////////////////////////////////////////////////////
-static const Bs8u renormTab[32] =
+#if (BS_AVC2_ADE_MODE == 1)
+#if defined(_MSC_VER)
+#include <intrin.h>
+static inline Bs32u Clz32(Bs32u x) { unsigned long i; _BitScanReverse(&i, x); return 31 - i; }
+#else
+static inline Bs32u Clz32(Bs32u x) { return __builtin_clz(x); }
+#endif
+
+// LPS range and state transitions indexed by packed (pStateIdx << 1) | valMPS
+struct ADETables
 {
-    6, 5, 4, 4, 3, 3, 3, 3,
-    2, 2, 2, 2, 2, 2, 2, 2,
-    1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1
+    Bs8u rLPS[128][4];
+    Bs8u nextMPS[128];
+    Bs8u nextLPS[128];
+
+    ADETables()
+    {
+        for (Bs32u s = 0; s < 128; s++)
+        {
+            Bs32u state = (s >> 1);
+            Bs32u vMPS  = (s & 1);
+
+            for (Bs32u q = 0; q < 4; q++)
+                rLPS[s][q] = rangeTabLpsT[q][state];
+
+            nextMPS[s] = Bs8u((transIdxMps[state] << 1) | vMPS);
+            nextLPS[s] = Bs8u((transIdxLps[state] << 1) | (state ? vMPS : !vMPS));
+        }
+    }
 };
 
+static const ADETables ADETab;
+#endif
+
 Bs8u ADE::DecodeDecision(Bs8u& ctxState)
 {
 #if (BS_AVC2_ADE_MODE == 1)
-    Bs32u vMPS = (ctxState & 1);
-    Bs32u bin = vMPS;
-    Bs32u state = (ctxState >> 1);
-    Bs32u rLPS = rangeTabLpsT[(m_range >> 6) & 3][state];
+    Bs32u s = ctxState;
+    Bs32u rLPS = ADETab.rLPS[s][(m_range >> 6) & 3];
 
     m_range -= rLPS;
 
-    if (m_val < (m_range << m_bits))
+    Bs64u scaled = Bs64u(m_range) << m_bits;
+
+    if (m_val < scaled)
     {
-        ctxState = (transIdxMps[state] << 1) | vMPS;
+        ctxState = ADETab.nextMPS[s];
 
         if (m_range >= 256)
-            return bin;
+            return Bs8u(s & 1);
 
         m_range <<= 1;
         m_bits--;
     }
     else
     {
-        Bs8u renorm = renormTab[(rLPS >> 3) & 0x1F];
-        m_val -= (m_range << m_bits);
+        // rLPS < 256, shift it up to 9 bits
+        Bs32u renorm = Clz32(rLPS) - 23;
+
+        m_val -= scaled;
         m_range = (rLPS << renorm);
         m_bits -= renorm;
 
-        bin ^= 1;
-        if (!state)
-            vMPS ^= 1;
-
-        ctxState = (transIdxLps[state] << 1) | vMPS;
+        ctxState = ADETab.nextLPS[s];
+        s ^= 1;
     }
 
-    if (m_bits > 0)
-        return bin;
-
-    m_val = (m_val << 16) | B(2);
-    m_bits += 16;
+    if (m_bits <= 0)
+        Refill();
 
-    return bin;
+    return Bs8u(s & 1);
 #else
     Bs8u  binVal = 0;
     Bs8u  valMPS = (ctxState & 1);
@@ -114,17 +136,14 @@ Bs8u ADE::DecodeBypass()
 {
 #if (BS_AVC2_ADE_MODE == 1)
     if (!--m_bits)
-    {
-        m_val = (m_val << 16) | B(2);
-        m_bits = 16;
-    }
+        Refill();
 
-    Bs32s val = m_val - (m_range << m_bits);
+    Bs64u scaled = Bs64u(m_range) << m_bits;
 
-    if (val < 0)
+    if (m_val < scaled)
         return 0;
 
-    m_val = Bs32u(val);
+    m_val -= scaled;
     return 1;
 #else
     m_codIOffset = (m_codIOffset << 1) | b();
@@ -142,9 +161,8 @@ Bs8u ADE::DecodeTerminate()
 {
 #if (BS_AVC2_ADE_MODE == 1)
     Bs32u range = m_range - 2;
-    Bs32s val = m_val - (range << m_bits);
 
-    if (val < 0)
+    if (m_val < (Bs64u(range) << m_bits))
     {
         if (range >= 256)
         {
@@ -154,17 +172,17 @@ Bs8u ADE::DecodeTerminate()
 
         m_range = (range << 1);
 
-        if (--m_bits)
-            return 0;
-
-        m_val = (m_val << 16) | B(2);
-        m_bits = 16;
+        if (!--m_bits)
+            Refill();
 
         return 0;
     }
 
     m_range = range;
 
+    // end of slice segment/sub-stream or PCM follows, give look-ahead back to the reader
+    Flush();
+
     return 1;
 #else
     m_codIRange -= 2;
@@ -181,3 +199,35 @@ Bs8u ADE::DecodeTerminate()
     return 0;
 #endif
 }
+
+Bs32u ADE::DecodeBypass(Bs32u n)
+{
+#if (BS_AVC2_ADE_MODE == 1)
+    Bs32u bins = 0;
+
+    while (n)
+    {
+        if (m_bits <= 1)
+            Refill();
+
+        // k bypass bins are the k-bit quotient of (codIOffset:next k bits) / codIRange
+        Bs32u k = BS_MIN(n, Bs32u(m_bits - 1));
+        Bs32s shift = m_bits - k;
+        Bs64u q = (m_val >> shift) / m_range;
+
+        m_val -= (q * m_range) << shift;
+        m_bits = shift;
+        bins = (k < 32 ? (bins << k) : 0) | Bs32u(q);
+        n -= k;
+    }
+
+    return bins;
+#else
+    Bs32u bins = 0;
+
+    while (n--)
+        bins = (bins << 1) | DecodeBypass();
+
+    return bins;
+#endif
+}
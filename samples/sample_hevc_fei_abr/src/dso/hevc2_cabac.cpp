@@ -129,11 +129,7 @@ Bs8u CABAC::SaoBandPosition()
     //bypass bypass bypass bypass bypass bypass
     Bs8u b;
 
-    b  = (DecodeBypass() << 4);
-    b |= (DecodeBypass() << 3);
-    b |= (DecodeBypass() << 2);
-    b |= (DecodeBypass() << 1);
-    b |=  DecodeBypass();
+    b = (Bs8u)DecodeBypass(5);
 
     BinCount += 5;
 
@@ -146,8 +142,7 @@ Bs8u CABAC::SaoEoClassLuma()
     //bypass bypass bypass na na na
     Bs8u b;
 
-    b  = (DecodeBypass() << 1);
-    b |=  DecodeBypass();
+    b = (Bs8u)DecodeBypass(2);
 
     BinCount += 2;
 
@@ -287,9 +282,7 @@ Bs8u CABAC::IntraChromaPredMode()
         return 4;
 
     BinCount += 2;
-    Bs8u b = (DecodeBypass() << 1);
-
-    return b | DecodeBypass();
+    return (Bs8u)DecodeBypass(2);
 }
 
 Bs8u CABAC::MergeIdx()
@@ -415,7 +408,7 @@ Bs16u CABAC::CuQpDeltaAbs()
 {
     //9.3.3.9
     //0 1 1 1 1 bypass
-    Bs16u k = 0, v0 = 0, v1 = 0, b;
+    Bs16u k = 0, v0 = 0, v1 = 0;
 
     while (v0 < 5)
     {
@@ -435,11 +428,7 @@ Bs16u CABAC::CuQpDeltaAbs()
 
     BinCount += k * 2 + 1;
 
-    while (k--)
-    {
-        b = DecodeBypass();
-        v1 |= (b << k);
-    }
+    v1 = (Bs16u)DecodeBypass(k);
 
     return (v0 + v1);
 }
@@ -573,8 +562,7 @@ Bs32u CABAC::LastSigCoeffXSuffix(Bs16u prefix)
 
     BinCount += prefix;
 
-    while (prefix--)
-        b = (b << 1) | DecodeBypass();
+    b = DecodeBypass(prefix);
 
     return b;
 }
@@ -689,8 +677,7 @@ Bs32u CABAC::CoeffAbsLevelRemaining(Bs16u i, Bs16u baseLevel, Bs16u cIdx, CU& cu
 
     if (b < 4)
     {
-        for (Bs16u c = 0; c < cRiceParam; c++)
-            b = ((b << 1) | DecodeBypass());
+        b = (b << cRiceParam) | DecodeBypass(cRiceParam);
 
         BinCount += cRiceParam;
     }
@@ -725,11 +712,7 @@ Bs32u CABAC::CoeffAbsLevelRemaining(Bs16u i, Bs16u baseLevel, Bs16u cIdx, CU& cu
             BinCount += b + k + 1;
         }
 
-        while (k--)
-        {
-            b = DecodeBypass();
-            v1 |= (b << k);
-        }
+        v1 = DecodeBypass(k);
 
         b = v0 + v1 + cMax;
     }
@@ -752,7 +735,7 @@ Bs32u CABAC::EGkBypass(Bs32u k)
 {
     //EGk
     //bypass bypass bypass bypass bypass bypass
-    Bs32u v0 = 0, v1 = 0, b;
+    Bs32u v0 = 0, v1 = 0;
 
     while (DecodeBypass())
     {
@@ -763,11 +746,7 @@ Bs32u CABAC::EGkBypass(Bs32u k)
 
     BinCount += k;
 
-    while (k--)
-    {
-        b = DecodeBypass();
-        v1 |= (b << k);
-    }
+    v1 = DecodeBypass(k);
 
     return (v0 + v1);
 }
@@ -781,8 +760,7 @@ Bs16u CABAC::NewPaletteEntries(Bs16u cIdx)
 
     BinCount += n;
 
-    while (n--)
-        b = (b << 1) | DecodeBypass();
+    b = (Bs16u)DecodeBypass(n);
 
     return b;
 }
@@ -808,8 +786,7 @@ Bs16u CABAC::NumPaletteIndices(Bs16u MaxPaletteIndex)
 
     BinCount += cRiceParam;
 
-    while (cRiceParam--)
-        prefixVal = (prefixVal << 1) | DecodeBypass();
+    prefixVal = Bs16u((prefixVal << cRiceParam) | DecodeBypass(cRiceParam));
 
     return prefixVal + 1;
 }
@@ -825,8 +802,7 @@ Bs32u CABAC::TBBypass(Bs32u cMax)
 
     BinCount += k;
 
-    while (k--)
-        v = (v << 1) | DecodeBypass();
+    v = DecodeBypass(k);
 
     if (v < u)
         return v;
@@ -888,8 +864,7 @@ Bs16u CABAC::PaletteEscapeVal(Bs16u cIdx, bool cu_transquant_bypass_flag)
 
         BinCount += bd;
 
-        while (bd--)
-            v = (v << 1) | DecodeBypass();
+        v = (Bs16u)DecodeBypass(bd);
 
         return v;
     }
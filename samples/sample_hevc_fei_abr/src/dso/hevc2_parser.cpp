@@ -116,7 +116,7 @@ BSErr Parser::Lock(void* p)
     {
         lock(p);
     }
-    catch (std::bad_alloc())
+    catch (std::bad_alloc&)
     {
         return BS_ERR_MEM_ALLOC;
     }
@@ -129,7 +129,7 @@ BSErr Parser::Unlock(void* p)
     {
         unlock(p);
     }
-    catch (std::bad_alloc())
+    catch (std::bad_alloc&)
     {
         return BS_ERR_MEM_ALLOC;
     }
@@ -309,13 +309,19 @@ BSErr Parser::sync(NALU* pAU)
 
         lock.unlock();
 
-        if (DONE != m_thread.Sync(m_spAuToId[pAU].AUDone, -1))
-            return m_spAuToId[pAU].sts;
+        BsThread::State st = m_thread.Sync(m_spAuToId[pAU].AUDone, -1);
 
         lock.lock();
 
+        BSErr sts = m_spAuToId[pAU].sts;
+
+        if (st != DONE && !sts)
+            sts = BS_ERR_UNKNOWN;
+
         m_spAuToId.erase(pAU);
-        return BS_ERR_NONE;
+        unlock(pAU);
+
+        return sts;
     }
 
     return BS_ERR_INVALID_PARAMS;
@@ -408,6 +414,10 @@ BSErr Parser::ParseNextAuSubmit(NALU*& pAU)
         m_spAuToId.erase(pAU);
     }
 
+    // AU stays alive until sync() even if ParallelAU fails and frees it,
+    // so the caller can safely lock it right after submission
+    m_pAllocator->lock(pAU);
+
     pPar->p   = this;
     pPar->pAU = pAU;
 
@@ -584,6 +594,8 @@ BSErr Parser::ParseNextAu(NALU*& pAU)
             }
             catch (EndOfBuffer&)
             {
+                // last NAL unit of the stream ends with the data, not where parsing stopped
+                nalu.p->NumBytesInNalUnit = Bs32u(GetByteOffset() - nalu.p->StartOffset - (nalu.NuhBytes - 2));
                 nalu.complete = true;
             }
 
@@ -673,6 +685,8 @@ Bs32u Parser::ParseSSDSubmit(SDThread*& pSDT, NALU* AU)
     Bs8u* pRBSP = 0;
     BsThread::SyncPoint spColPic;
     Bs16u SliceAddrRs = pSlice->slice_segment_address;
+    std::shared_ptr<WPPSync> wpp;
+    bool bTiles = colWidth.size() * rowHeight.size() > 1;
 
     auto GetSDT = [this] () -> SDThread*
     {
@@ -734,8 +748,19 @@ Bs32u Parser::ParseSSDSubmit(SDThread*& pSDT, NALU* AU)
 
 
     if (   pSlice->num_entry_point_offsets
-        && colWidth.size() * rowHeight.size() > 1
-        && (m_mode & PARALLEL_TILES))
+        && pSlice->pps->entropy_coding_sync_enabled_flag
+        && !bTiles
+        && !(pSlice->slice_segment_address % PicWidthInCtbsY)
+        && m_sdt.size() > 1
+        && (m_mode & PARALLEL_WPP))
+    {
+        wpp = std::make_shared<WPPSync>();
+        wpp->RowSize = PicWidthInCtbsY;
+        wpp->pScheduler = &m_thread;
+    }
+
+    if (   pSlice->num_entry_point_offsets
+        && ((bTiles && (m_mode & PARALLEL_TILES)) || wpp))
     {
         Bs16u AddrInTs = CtbAddrRsToTs[pSlice->slice_segment_address];
         Bs16u Tid = TileId[AddrInTs];
@@ -777,7 +802,31 @@ Bs32u Parser::ParseSSDSubmit(SDThread*& pSDT, NALU* AU)
             }
         };
 
-        if (   pSlice->pps->entropy_coding_sync_enabled_flag
+        if (wpp)
+        {
+            // one CTU row per task, rows are parsed in wavefront
+            while (EPid < pSlice->num_entry_point_offsets)
+            {
+                SplitTilesPar t = {};
+
+                SplitTiles.back().NumBytesInRbsp += pSlice->entry_point_offset_minus1[EPid++] + 1;
+                SplitTiles.back().NumCtb = PicWidthInCtbsY;
+                AddrInTs += PicWidthInCtbsY;
+
+                if (AddrInTs >= PicSizeInCtbsY)
+                    throw InvalidSyntax();
+
+                t.AddrInTs = AddrInTs;
+                t.AddrInRs = CtbAddrTsToRs[AddrInTs];
+                t.NumCtb = PicSizeInCtbsY - AddrInTs;
+                SplitTiles.push_back(t);
+            }
+
+            wpp->SDT.resize(SplitTiles.size(), nullptr);
+            wpp->NumCtbDone.resize(SplitTiles.size(), 0);
+            wpp->NumCtbWait.resize(SplitTiles.size(), 0);
+        }
+        else if (   pSlice->pps->entropy_coding_sync_enabled_flag
             && pSlice->num_entry_point_offsets + 1 > rowHeight[Tid])
         {
             while (EPid < pSlice->num_entry_point_offsets)
@@ -868,18 +917,40 @@ Bs32u Parser::ParseSSDSubmit(SDThread*& pSDT, NALU* AU)
     }
 
 
+    // 1st task updates the slice while the rest are submitted
+    NALU  baseNALU  = *nalu.p;
+    Slice baseSlice = *pSlice;
+
     for (Bs16u TGId = 0; TGId < SplitTiles.size(); TGId++)
     {
-        sliceDep.resize(0);
-
         if (sdpar.ColPic)
-        {
             lock(sdpar.ColPic);
-            sliceDep.push_back(spColPic);
+
+        // wavefront rows keep dependencies of the 1st row to be scheduled in order
+        if (!wpp || !TGId)
+        {
+            sliceDep.resize(0);
+
+            if (sdpar.ColPic)
+                sliceDep.push_back(spColPic);
         }
 
         if (TGId > 0)
+        {
+            {
+                std::unique_lock<std::mutex> lockSDT(pSDT->mtx);
+
+                // row above must stay untouched until this row is parsed
+                if (wpp)
+                    pSDT->locked++;
+
+                // lock kept for next dependent slice segment goes to the last task
+                if (TGId == 1 && pSlice->dependent_slice_segment_flag)
+                    pSDT->locked--;
+            }
+
             pSDT = GetSDT();
+        }
         else if (!pSlice->dependent_slice_segment_flag)
         {
             if (pSDT && pSDT->locked)
@@ -911,8 +982,8 @@ Bs32u Parser::ParseSSDSubmit(SDThread*& pSDT, NALU* AU)
                 NALU* fakeNALU = alloc<NALU>();
                 Slice* fakeSlice = alloc<Slice>(fakeNALU);
 
-                *fakeNALU = *nalu.p;
-                *fakeSlice = *pSlice;
+                *fakeNALU = baseNALU;
+                *fakeSlice = baseSlice;
                 fakeNALU->slice = fakeSlice;
                 fakeNALU->forbidden_zero_bit = 1;
                 sdpar.Slice = fakeNALU;
@@ -932,6 +1003,7 @@ Bs32u Parser::ParseSSDSubmit(SDThread*& pSDT, NALU* AU)
                 pSDT->RBSPSize = 0;
                 pSDT->RBSPOffset = 0;
                 pSDT->rbsp.resize(MaxRBSP);
+                (Info&)pSDT->p = *(Info*)this;
                 sdpar.NewPicture = true;
             }
 
@@ -939,7 +1011,6 @@ Bs32u Parser::ParseSSDSubmit(SDThread*& pSDT, NALU* AU)
             pRBSP += SplitTiles[TGId].NumBytesInRbsp;
 
             pSDT->RBSPSize += SplitTiles[TGId].NumBytesInRbsp;
-            (Info&)pSDT->p = *(Info*)this;
 
             sdpar.Slice->NumBytesInRbsp = SplitTiles[TGId].NumBytesInRbsp + sdpar.HeaderSize;
             sdpar.Slice->slice->slice_segment_address = SplitTiles[TGId].AddrInRs;
@@ -949,6 +1020,13 @@ Bs32u Parser::ParseSSDSubmit(SDThread*& pSDT, NALU* AU)
             if (!sdpar.Slice->slice->Split)
                 pSDT->locked++;
 
+            if (wpp)
+            {
+                wpp->SDT[TGId] = pSDT;
+                sdpar.WPP = wpp;
+                sdpar.WPPRow = TGId;
+            }
+
             lockMap.lock();
             m_spAuToId[AU].pAllocator = this;
             m_spAuToId[AU].SD.push_back(SDDesc());
@@ -966,7 +1044,7 @@ Bs32u Parser::ParseSSDSubmit(SDThread*& pSDT, NALU* AU)
     return CurRBSP;
 }
 
-BsThread::State Parser::ParallelSD(void* self, unsigned int)
+BsThread::State Parser::ParallelSD(void* self, unsigned int entryCnt)
 {
     SDThread& sdt = *(SDThread*)self;
     std::unique_lock<std::mutex> lock(sdt.mtx);
@@ -975,15 +1053,26 @@ BsThread::State Parser::ParallelSD(void* self, unsigned int)
 
     lock.unlock();
 
-    sdt.p.NewPicture = par.NewPicture;
-    sdt.p.m_cSlice = par.Slice->slice;
-    sdt.p.SetEmulation(par.Emulation);
-    sdt.p.SetEmuBytes(0);
+    // wavefront row re-entered after waiting for the row above continues from where it stopped
+    if (!entryCnt)
+    {
+        sdt.p.NewPicture = par.NewPicture;
+        sdt.p.m_cSlice = par.Slice->slice;
+        sdt.p.SetEmulation(par.Emulation);
+        sdt.p.SetEmuBytes(0);
+    }
 
     try
     {
-        sdt.p.Reset(&sdt.rbsp[0] + sdt.RBSPOffset, par.Slice->NumBytesInRbsp - par.HeaderSize);
-        par.Slice->slice->ctu = sdt.p.parseSSD(*par.Slice, par.ColPic, par.NumCtb);
+        if (!entryCnt)
+            sdt.p.Reset(&sdt.rbsp[0] + sdt.RBSPOffset, par.Slice->NumBytesInRbsp - par.HeaderSize);
+
+        CTU* ctu = sdt.p.parseSSD(*par.Slice, par.ColPic, par.NumCtb, par.WPP.get(), par.WPPRow);
+
+        if (!ctu)
+            return WAITING;
+
+        par.Slice->slice->ctu = ctu;
         sdt.p.m_pAllocator->bound(par.Slice->slice->ctu, par.Slice->slice);
     }
     catch(Exception& ex)
@@ -995,6 +1084,9 @@ BsThread::State Parser::ParallelSD(void* self, unsigned int)
         st = FAILED;
     }
 
+    if (par.WPP)
+        par.WPP->Finish(par.WPPRow);
+
     if (par.pTask)
         par.pTask->state = st;
 
@@ -1011,5 +1103,14 @@ BsThread::State Parser::ParallelSD(void* self, unsigned int)
     sdt.p.NewPicture = false;
     sdt.locked--;
 
+    lock.unlock();
+
+    if (par.WPP && par.WPPRow)
+    {
+        SDThread& above = *par.WPP->SDT[par.WPPRow - 1];
+        std::unique_lock<std::mutex> lockAbove(above.mtx);
+        above.locked--;
+    }
+
     return st;
 }
@@ -23,6 +23,7 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include <string>
 #include <fstream>
 #include <numeric>
+#include <algorithm>
 
 using namespace BS_HEVC2;
 
@@ -39,6 +40,12 @@ mfxStatus HevcSwDso::Init()
         return MFX_ERR_UNDEFINED_BEHAVIOR;
     }
 
+    if (m_inPars.DSOAsyncDepth)
+    {
+        m_asyncDepth = std::min<mfxU16>(m_inPars.DSOAsyncDepth, m_parser.async_depth());
+        m_bEOS       = false;
+    }
+
     if (m_ctuCtrlPool.get())
     {
         std::list<CTUCtrlPool::Type> list;
@@ -59,6 +66,100 @@ mfxStatus HevcSwDso::Init()
     return MFX_ERR_NONE;
 }
 
+void HevcSwDso::Close()
+{
+    // AUs parsed ahead must be completed before their trees can be released
+    while (!m_auQueue.empty())
+    {
+        m_parser.sync(m_auQueue.front());
+        m_parser.unlock(m_auQueue.front());
+        m_auQueue.pop_front();
+    }
+}
+
+// Releases AU syntax tree locked at submission once MVP/CTU data are extracted from it
+class AutoAUUnlocker
+{
+public:
+    AutoAUUnlocker(BS_HEVC2_parser & parser, BS_HEVC2::NALU* au)
+        : m_parser(parser)
+        , m_au(au)
+    {}
+
+    ~AutoAUUnlocker()
+    {
+        if (m_au)
+            m_parser.unlock(m_au);
+    }
+
+private:
+    BS_HEVC2_parser & m_parser;
+    BS_HEVC2::NALU*   m_au;
+
+    DISALLOW_COPY_AND_ASSIGN(AutoAUUnlocker);
+};
+
+mfxStatus HevcSwDso::ParseNextAU(BS_HEVC2::NALU* & au)
+{
+    BSErr bs_sts = BS_ERR_NONE;
+
+    if (!m_asyncDepth)
+    {
+        bs_sts = m_parser.parse_next_unit();
+
+        if (bs_sts != BS_ERR_NONE)
+        {
+            msdk_printf(MSDK_STRING("\nERROR : HevcSwDso::GetFrame : m_parser.parse_next_unit failed with code %d\n"), bs_sts);
+            return MFX_ERR_UNDEFINED_BEHAVIOR;
+        }
+
+        au = (BS_HEVC2::NALU*) m_parser.get_header();
+
+        return MFX_ERR_NONE;
+    }
+
+    // Keep up to m_asyncDepth AUs in flight, each one is parsed by parser threads
+    // independently of the others. Submitted AU is locked by caller right away,
+    // otherwise parser may release it once the next AU is parsed.
+    while (!m_bEOS && m_auQueue.size() < m_asyncDepth)
+    {
+        BS_HEVC2::NALU* next = nullptr;
+
+        if (m_parser.parse_next_au(next) != BS_ERR_NONE || m_parser.lock(next) != BS_ERR_NONE)
+        {
+            m_bEOS = true;
+            break;
+        }
+
+        m_auQueue.push_back(next);
+    }
+
+    if (m_auQueue.empty())
+    {
+        msdk_printf(MSDK_STRING("\nERROR : HevcSwDso::GetFrame : no more access units in DSO stream\n"));
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+    }
+
+    au = m_auQueue.front();
+    m_auQueue.pop_front();
+
+    bs_sts = m_parser.sync(au);
+
+    if (bs_sts != BS_ERR_NONE)
+    {
+        m_parser.unlock(au);
+        m_bEOS = true;
+
+        // AUs submitted after the failed one are not valid either
+        Close();
+
+        msdk_printf(MSDK_STRING("\nERROR : HevcSwDso::GetFrame : m_parser.sync failed with code %d\n"), bs_sts);
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+    }
+
+    return MFX_ERR_NONE;
+}
+
 void DumpMVPs(mfxExtFeiHevcEncMVPredictors & mvp, mfxU32 encorder)
 {
     std::string fname = "MVPdump_encorder_frame_" + std::to_string(encorder + 1) + ".bin";
@@ -70,15 +171,14 @@ void DumpMVPs(mfxExtFeiHevcEncMVPredictors & mvp, mfxU32 encorder)
 
 mfxStatus HevcSwDso::GetFrame(HevcTaskDSO & task)
 {
-    BSErr bs_sts = m_parser.parse_next_unit();
+    BS_HEVC2::NALU* hdr = nullptr;
 
-    if (bs_sts != BS_ERR_NONE)
-    {
-        msdk_printf(MSDK_STRING("\nERROR : HevcSwDso::GetFrame : m_parser.parse_next_unit failed with code %d\n"), bs_sts);
-        return MFX_ERR_UNDEFINED_BEHAVIOR;
-    }
+    mfxStatus sts = ParseNextAU(hdr);
+    if (sts != MFX_ERR_NONE)
+        return sts;
 
-    auto * hdr = (BS_HEVC2::NALU*) m_parser.get_header();
+    // In streaming mode only MVP/CTU buffers outlive this call, syntax tree is released on return
+    AutoAUUnlocker auLock(m_parser, m_asyncDepth ? hdr : nullptr);
 
     FillFrameTask(hdr, task);
 
@@ -172,6 +172,13 @@ namespace TranscodingSample
         EXTBRC_IMPLICIT
     };
 
+    // automatic placement of session threads on CPUs
+    enum PlacementMode {
+        PLACEMENT_NONE,
+        PLACEMENT_NUMA, // sessions are spread over NUMA nodes, pinned to all CPUs of node
+        PLACEMENT_CORE  // sessions are spread over NUMA nodes, CPUs of node are split between its sessions
+    };
+
     struct __sInputParams
     {
         // session parameters
@@ -189,6 +196,10 @@ namespace TranscodingSample
 #endif
         bool   bIsPerf;   // special performance mode. Use pre-allocated bitstreams, output
         mfxU16 nThreadsNum; // number of internal session threads number
+        PlacementMode ePlacement; // automatic CPU placement for sessions without explicit one
+        mfxI32 nNumaNode;   // NUMA node to run session on, -1 if not set
+        bool bUseFramePool;       // take system memory surfaces from SysMemFramePool and mfxExtSysMemFramePool
+        mfxU32 nFramePoolBudget;  // budget of each pool in MB
         bool bRobustFlag;   // Robust transcoding mode. Allows auto-recovery after hardware errors
         bool bSoftRobustFlag;
 
@@ -370,6 +381,8 @@ namespace TranscodingSample
     {
         sInputParams();
         msdk_string DumpLogFileName;
+        // CPUs to pin pipeline thread and library threads of session to, empty - no pinning
+        std::vector<mfxU32> CpuAffinity;
 #if MFX_VERSION >= 1022
         std::vector<mfxExtEncoderROI> m_ROIData;
 
@@ -954,12 +967,18 @@ namespace TranscodingSample
         // Thread handle
         std::future<void> handle;
 
+        // CPUs the pipeline thread is pinned to, empty - no pinning
+        std::vector<mfxU32> cpuAffinity;
+
         void TranscodeRoutine()
         {
             using namespace std::chrono;
             MSDK_CHECK_POINTER_NO_RET(pPipeline);
             transcodingSts = MFX_ERR_NONE;
 
+            if (!cpuAffinity.empty() && MFX_ERR_NONE != msdk_thread_set_affinity(cpuAffinity))
+                msdk_printf(MSDK_STRING("WARNING: failed to set affinity of pipeline thread\n"));
+
             auto start_time = system_clock::now();
             while (MFX_ERR_NONE == transcodingSts)
             {
@@ -65,6 +65,7 @@ namespace TranscodingSample
         mfxStatus CheckAndFixAdapterDependency(mfxU32 idxSession, CTranscodingPipeline * pParentPipeline);
 #endif
         virtual mfxStatus VerifyCrossSessionsOptions();
+        virtual mfxStatus AssignCpuPlacement();
         virtual mfxStatus CreateSafetyBuffers();
         virtual void      DoTranscoding();
         virtual void      DoRobustTranscoding();
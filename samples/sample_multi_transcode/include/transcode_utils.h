@@ -92,6 +92,9 @@ namespace TranscodingSample
         bool                                         bRobustFlag;
         bool                                         bSoftRobustFlag;
         bool                                         shouldUseGreedyFormula;
+        PlacementMode                                m_Placement;
+        bool                                         m_bUseFramePool;
+        mfxU32                                       m_nFramePoolBudget;
         std::vector<msdk_string>                     m_lines;
     private:
         DISALLOW_COPY_AND_ASSIGN(CmdProcessor);
@@ -95,6 +95,7 @@ sInputParams::sInputParams() : __sInputParams()
 #endif
     priority = MFX_PRIORITY_NORMAL;
     libType = MFX_IMPL_SOFTWARE;
+    nNumaNode = -1;
 #if (defined(_WIN32) || defined(_WIN64)) && (MFX_VERSION >= 1031)
     //Adapter type
     bPrefferiGfx = false;
@@ -3737,6 +3738,14 @@ mfxStatus CTranscodingPipeline::Init(sInputParams *pParams,
         threadsPar->NumThread = pParams->nThreadsNum;
     }
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    if (pParams->bUseFramePool)
+    {
+        auto framePool = m_initPar.AddExtBuffer<mfxExtSysMemFramePool>();
+        framePool->MaxSize = pParams->nFramePoolBudget;
+    }
+#endif
+
     //--- GPU Copy settings
     m_initPar.GPUCopy = pParams->nGpuCopyMode;
 
@@ -33,6 +33,7 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #endif
 
 #include <future>
+#include <algorithm>
 using namespace std;
 using namespace TranscodingSample;
 
@@ -103,6 +104,33 @@ CTranscodingPipeline* CreatePipeline()
     return new CTranscodingPipeline;
 }
 
+// Pins calling thread to session CPUs while session is initialized: library threads
+// created by MFXInit and components inherit the affinity, system memory surfaces are
+// first touched on the session's NUMA node
+class SessionAffinityGuard
+{
+public:
+    SessionAffinityGuard(const std::vector<mfxU32>& cpus)
+        : m_bSet(false)
+    {
+        if (cpus.empty() || MFX_ERR_NONE != msdk_thread_get_affinity(m_saved))
+            return;
+
+        m_bSet = (MFX_ERR_NONE == msdk_thread_set_affinity(cpus));
+        if (!m_bSet)
+            msdk_printf(MSDK_STRING("WARNING: failed to set thread affinity for session initialization\n"));
+    }
+    ~SessionAffinityGuard()
+    {
+        if (m_bSet)
+            msdk_thread_set_affinity(m_saved);
+    }
+
+private:
+    std::vector<mfxU32> m_saved;
+    bool                m_bSet;
+};
+
 mfxStatus Launcher::Init(int argc, msdk_char *argv[])
 {
     mfxStatus sts;
@@ -137,6 +165,9 @@ mfxStatus Launcher::Init(int argc, msdk_char *argv[])
     sts = VerifyCrossSessionsOptions();
     MSDK_CHECK_STATUS(sts, "VerifyCrossSessionsOptions failed");
 
+    sts = AssignCpuPlacement();
+    MSDK_CHECK_STATUS(sts, "AssignCpuPlacement failed");
+
 #if (defined(_WIN32) || defined(_WIN64)) && (MFX_VERSION >= 1031)
     // check available adapters
     sts = QueryAdapters();
@@ -291,6 +322,16 @@ mfxStatus Launcher::Init(int argc, msdk_char *argv[])
         m_pAllocParam.reset(new SysMemAllocatorParams);
     }
 
+    SysMemAllocatorParams* pSysMemParams = dynamic_cast<SysMemAllocatorParams*>(m_pAllocParam.get());
+    if (pSysMemParams)
+    {
+        pSysMemParams->bFirstTouch = std::any_of(m_InputParamsArray.begin(), m_InputParamsArray.end(),
+            [](const sInputParams& params) { return !params.CpuAffinity.empty(); });
+        // global option, same in all sessions
+        pSysMemParams->bUseFramePool = m_InputParamsArray[0].bUseFramePool;
+        pSysMemParams->nFramePoolBudget = (size_t)m_InputParamsArray[0].nFramePoolBudget << 20;
+    }
+
     // each pair of source and sink has own safety buffer
     sts = CreateSafetyBuffers();
     MSDK_CHECK_STATUS(sts, "CreateSafetyBuffers failed");
@@ -317,6 +358,8 @@ mfxStatus Launcher::Init(int argc, msdk_char *argv[])
     for (i = 0; i < m_InputParamsArray.size(); i++)
     {
         msdk_printf(MSDK_STRING("Session %d:\n"), i);
+        SessionAffinityGuard affinity(m_InputParamsArray[i].CpuAffinity);
+
         std::unique_ptr<GeneralAllocator> pAllocator(new GeneralAllocator);
         sts = pAllocator->Init(m_pAllocParam.get());
         MSDK_CHECK_STATUS(sts, "pAllocator->Init failed");
@@ -460,6 +503,7 @@ mfxStatus Launcher::Init(int argc, msdk_char *argv[])
         pThreadPipeline->startStatus = MFX_WRN_DEVICE_BUSY;
         // set other session's parameters
         pThreadPipeline->implType = m_InputParamsArray[i].libType;
+        pThreadPipeline->cpuAffinity = m_InputParamsArray[i].CpuAffinity;
         m_pThreadContextArray.push_back(std::move(pThreadPipeline));
 
         mfxVersion ver = {{0, 0}};
@@ -471,6 +515,8 @@ mfxStatus Launcher::Init(int argc, msdk_char *argv[])
 
     for (i = 0; i < m_InputParamsArray.size(); i++)
     {
+        SessionAffinityGuard affinity(m_InputParamsArray[i].CpuAffinity);
+
         sts = m_pThreadContextArray[i]->pPipeline->CompleteInit();
         MSDK_CHECK_STATUS(sts, "m_pThreadContextArray[i]->pPipeline->CompleteInit failed");
 
@@ -1101,6 +1147,124 @@ mfxStatus Launcher::VerifyCrossSessionsOptions()
 
 } // mfxStatus Launcher::VerifyCrossSessionsOptions()
 
+mfxStatus Launcher::AssignCpuPlacement()
+{
+    bool bPlacement = std::any_of(m_InputParamsArray.begin(), m_InputParamsArray.end(), [](const sInputParams& params)
+    {
+        return params.ePlacement != PLACEMENT_NONE || params.nNumaNode >= 0 || !params.CpuAffinity.empty();
+    });
+    if (!bPlacement)
+        return MFX_ERR_NONE;
+
+    std::vector<std::vector<mfxU32>> nodes;
+    mfxStatus sts = msdk_get_numa_nodes(nodes);
+    MSDK_CHECK_STATUS(sts, "msdk_get_numa_nodes failed");
+
+    std::vector<mfxU32> usableNodes;
+    for (mfxU32 node = 0; node < nodes.size(); node++)
+    {
+        if (!nodes[node].empty())
+            usableNodes.push_back(node);
+    }
+    MSDK_CHECK_ERROR(usableNodes.empty(), true, MFX_ERR_UNSUPPORTED);
+
+    // sessions of heterogeneous pipeline exchange surfaces, so they are kept on one node
+    mfxI32 heterogeneousNode = -1;
+    for (const sInputParams& params : m_InputParamsArray)
+    {
+        if ((params.eMode == Sink || params.eMode == Source) && params.CpuAffinity.empty() && params.nNumaNode >= 0)
+        {
+            heterogeneousNode = params.nNumaNode;
+            break;
+        }
+    }
+
+    std::vector<mfxI32> sessionNode(m_InputParamsArray.size(), -1);
+    mfxU32 nextNode = 0;
+    for (size_t i = 0; i < m_InputParamsArray.size(); i++)
+    {
+        const sInputParams& params = m_InputParamsArray[i];
+        bool bHeterogeneous = (params.eMode == Sink || params.eMode == Source);
+
+        if (!params.CpuAffinity.empty())
+            continue;
+
+        if (params.nNumaNode >= 0)
+        {
+            if ((size_t)params.nNumaNode >= nodes.size() || nodes[params.nNumaNode].empty())
+            {
+                msdk_printf(MSDK_STRING("error: session %d: NUMA node %d has no CPUs available\n"), (int)i, params.nNumaNode);
+                return MFX_ERR_UNSUPPORTED;
+            }
+            sessionNode[i] = params.nNumaNode;
+        }
+        else if (params.ePlacement != PLACEMENT_NONE)
+        {
+            if (bHeterogeneous && heterogeneousNode >= 0)
+            {
+                sessionNode[i] = heterogeneousNode;
+            }
+            else
+            {
+                sessionNode[i] = usableNodes[nextNode++ % usableNodes.size()];
+                if (bHeterogeneous)
+                    heterogeneousNode = sessionNode[i];
+            }
+        }
+    }
+
+    for (mfxU32 node = 0; node < nodes.size(); node++)
+    {
+        const std::vector<mfxU32>& cpus = nodes[node];
+
+        // CPUs of node are split between sessions placed automatically in core mode,
+        // CPUs are ordered by physical core, so contiguous ranges keep hardware threads together
+        std::vector<size_t> coreSessions;
+        for (size_t i = 0; i < m_InputParamsArray.size(); i++)
+        {
+            if (sessionNode[i] != (mfxI32)node)
+                continue;
+
+            sInputParams& params = m_InputParamsArray[i];
+            if (params.ePlacement == PLACEMENT_CORE && params.nNumaNode < 0)
+                coreSessions.push_back(i);
+            else
+                params.CpuAffinity = cpus;
+        }
+
+        size_t numSessions = coreSessions.size();
+        for (size_t j = 0; j < numSessions; j++)
+        {
+            std::vector<mfxU32>& affinity = m_InputParamsArray[coreSessions[j]].CpuAffinity;
+            if (numSessions >= cpus.size())
+            {
+                affinity.assign(1, cpus[j % cpus.size()]);
+            }
+            else
+            {
+                affinity.assign(cpus.begin() + j * cpus.size() / numSessions,
+                                cpus.begin() + (j + 1) * cpus.size() / numSessions);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < m_InputParamsArray.size(); i++)
+    {
+        const std::vector<mfxU32>& cpus = m_InputParamsArray[i].CpuAffinity;
+        if (cpus.empty())
+            continue;
+
+        msdk_stringstream ss;
+        ss << MSDK_STRING("Session ") << i << MSDK_STRING(" CPUs:");
+        for (mfxU32 cpu : cpus)
+            ss << MSDK_STRING(" ") << cpu;
+        msdk_printf(MSDK_STRING("%s\n"), ss.str().c_str());
+    }
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus Launcher::AssignCpuPlacement()
+
 mfxStatus Launcher::CreateSafetyBuffers()
 {
     SafetySurfaceBuffer* pBuffer     = NULL;
@@ -127,6 +127,15 @@ void TranscodingSample::PrintHelp()
     msdk_printf(MSDK_STRING("                Set time to run transcoding in seconds\n"));
     msdk_printf(MSDK_STRING("  -greedy \n"));
     msdk_printf(MSDK_STRING("                Use greedy formula to calculate number of surfaces\n"));
+    msdk_printf(MSDK_STRING("  -placement:numa|core\n"));
+    msdk_printf(MSDK_STRING("                Pin each session (pipeline thread and library threads) to CPUs automatically:\n"));
+    msdk_printf(MSDK_STRING("                      numa - sessions are spread over NUMA nodes and pinned to all CPUs of node\n"));
+    msdk_printf(MSDK_STRING("                      core - as numa, but CPUs of node are split between its sessions\n"));
+    msdk_printf(MSDK_STRING("                Sessions connected with -o::sink/-i::source are kept on one node.\n"));
+    msdk_printf(MSDK_STRING("                System memory surfaces are allocated on the node of session.\n"));
+    msdk_printf(MSDK_STRING("  -frame_pool <MB>\n"));
+    msdk_printf(MSDK_STRING("                Take system memory surfaces of the sample and of the library from hugepage\n"));
+    msdk_printf(MSDK_STRING("                backed pools which keep them for reuse by next sessions. <MB> limits size of each pool\n"));
     msdk_printf(MSDK_STRING("\n"));
     msdk_printf(MSDK_STRING("Pipeline description (general options):\n"));
     msdk_printf(MSDK_STRING("  -i::h265|h264|mpeg2|vc1|mvc|jpeg|vp9|av1 <file-name>\n"));
@@ -194,6 +203,11 @@ void TranscodingSample::PrintHelp()
     msdk_printf(MSDK_STRING("  -join         Join session with other session(s), by default sessions are not joined\n"));
     msdk_printf(MSDK_STRING("  -priority     Use priority for join sessions. 0 - Low, 1 - Normal, 2 - High. Normal by default\n"));
     msdk_printf(MSDK_STRING("  -threads num  Number of session internal threads to create\n"));
+    msdk_printf(MSDK_STRING("  -numa_node N  Run session on CPUs of NUMA node N, overrides -placement\n"));
+    msdk_printf(MSDK_STRING("  -cpus list    Run session on given CPUs, e.g. 0-7,16-23, overrides -placement and -numa_node\n"));
+#if defined(_WIN32) || defined(_WIN64)
+    msdk_printf(MSDK_STRING("                Note: library threads do not inherit affinity on Windows, only pipeline thread is pinned\n"));
+#endif
     msdk_printf(MSDK_STRING("  -n            Number of frames to transcode\n") \
         MSDK_STRING("                  (session ends after this number of frames is reached). \n") \
         MSDK_STRING("                In decoding sessions (-o::sink) this parameter limits number\n") \
@@ -462,6 +476,9 @@ CmdProcessor::CmdProcessor()
     statisticsLogFile = NULL;
     DumpLogFileName.clear();
     shouldUseGreedyFormula=false;
+    m_Placement = PLACEMENT_NONE;
+    m_bUseFramePool = false;
+    m_nFramePoolBudget = 0;
     bRobustFlag = false;
     bSoftRobustFlag = false;
 
@@ -549,6 +566,29 @@ mfxStatus CmdProcessor::ParseCmdLine(int argc, msdk_char *argv[])
         {
             shouldUseGreedyFormula=true;
         }
+        else if (0 == msdk_strcmp(argv[0], MSDK_STRING("-placement:numa")))
+        {
+            m_Placement = PLACEMENT_NUMA;
+        }
+        else if (0 == msdk_strcmp(argv[0], MSDK_STRING("-placement:core")))
+        {
+            m_Placement = PLACEMENT_CORE;
+        }
+        else if (0 == msdk_strcmp(argv[0], MSDK_STRING("-frame_pool")))
+        {
+            --argc;
+            ++argv;
+            if (!argv[0]) {
+                msdk_printf(MSDK_STRING("error: no argument given for '-frame_pool' option\n"));
+                return MFX_ERR_UNSUPPORTED;
+            }
+            if (MFX_ERR_NONE != msdk_opt_read(argv[0], m_nFramePoolBudget) || !m_nFramePoolBudget)
+            {
+                msdk_printf(MSDK_STRING("error: -frame_pool \"%s\" is invalid"), argv[0]);
+                return MFX_ERR_UNSUPPORTED;
+            }
+            m_bUseFramePool = true;
+        }
         else if (0 == msdk_strcmp(argv[0], MSDK_STRING("-p")))
         {
             if (m_PerfFILE)
@@ -1491,6 +1531,9 @@ mfxStatus CmdProcessor::ParseParamsForOneSession(mfxU32 argc, msdk_char *argv[])
         InputParams.bSoftRobustFlag = true;
 
     InputParams.shouldUseGreedyFormula = shouldUseGreedyFormula;
+    InputParams.ePlacement = m_Placement;
+    InputParams.bUseFramePool = m_bUseFramePool;
+    InputParams.nFramePoolBudget = m_nFramePoolBudget;
 
     InputParams.statisticsWindowSize = statisticsWindowSize;
     InputParams.statisticsLogFile = statisticsLogFile;
@@ -1677,6 +1720,34 @@ mfxStatus CmdProcessor::ParseParamsForOneSession(mfxU32 argc, msdk_char *argv[])
                 return MFX_ERR_UNSUPPORTED;
             }
         }
+        else if (0 == msdk_strcmp(argv[i], MSDK_STRING("-numa_node")))
+        {
+            VAL_CHECK(i+1 == argc, i, argv[i]);
+            i++;
+            if (MFX_ERR_NONE != msdk_opt_read(argv[i], InputParams.nNumaNode) || InputParams.nNumaNode < 0)
+            {
+                PrintError(MSDK_STRING("NUMA node \"%s\" is invalid"), argv[i]);
+                return MFX_ERR_UNSUPPORTED;
+            }
+        }
+        else if (0 == msdk_strcmp(argv[i], MSDK_STRING("-cpus")))
+        {
+            VAL_CHECK(i+1 == argc, i, argv[i]);
+            i++;
+            if (MFX_ERR_NONE != msdk_parse_cpu_list(argv[i], InputParams.CpuAffinity))
+            {
+                PrintError(MSDK_STRING("CPU list \"%s\" is invalid"), argv[i]);
+                return MFX_ERR_UNSUPPORTED;
+            }
+        }
+        else if (0 == msdk_strcmp(argv[i], MSDK_STRING("-placement:numa")))
+        {
+            InputParams.ePlacement = PLACEMENT_NUMA;
+        }
+        else if (0 == msdk_strcmp(argv[i], MSDK_STRING("-placement:core")))
+        {
+            InputParams.ePlacement = PLACEMENT_CORE;
+        }
         else if(0 == msdk_strcmp(argv[i], MSDK_STRING("-f")))
         {
             VAL_CHECK(i+1 == argc, i, argv[i]);
@@ -22,10 +22,11 @@
 
 import re
 import sys
+import json
 import argparse
 from pathlib import Path
 
-from ted import discover
+from ted import discover, perf
 
 
 if __name__ == '__main__':
@@ -44,6 +45,27 @@ if __name__ == '__main__':
         help='provide device on which to run tests (default: /dev/dri/renderD128)'
     )
 
+    parser.add_argument(
+        '--perf', action='store_true',
+        help='run CPU-only performance tests from perf folder instead of conformance tests'
+    )
+    parser.add_argument(
+        '--baseline', action='store', default=None,
+        help='performance baseline file (default: perf_baseline.json next to ted.py)'
+    )
+    parser.add_argument(
+        '--update-baseline', action='store_true',
+        help='store measured performance as the new baseline instead of checking it'
+    )
+    parser.add_argument(
+        '--tolerance', action='store', type=float, default=10.0,
+        help='allowed fps and CPU time regression against baseline, %% (default: 10)'
+    )
+    parser.add_argument(
+        '--rss-tolerance', action='store', type=float, default=20.0,
+        help='allowed peak RSS growth against baseline, %% (default: 20)'
+    )
+
     args = parser.parse_args()
 
     base_dir = Path(__file__).parent.absolute()
@@ -62,7 +84,8 @@ if __name__ == '__main__':
 
     tests_to_run = []
     print("Disovering tests...")
-    for test in discover.tests(base_dir, cfg, args):
+    found = discover.perf_tests(base_dir, cfg, args) if args.perf else discover.tests(base_dir, cfg, args)
+    for test in found:
         if test_re and not test_re.search(test.name):
             print('  {} - skipped'.format(test.name))
             continue
@@ -76,11 +99,18 @@ if __name__ == '__main__':
     n = len(tests_to_run)
     print("\nRunning {} test{}...".format(n, 's' if n > 1 else ''))
 
+    if args.perf:
+        baseline_fn = Path(args.baseline) if args.baseline else base_dir / 'perf_baseline.json'
+        baseline = perf.load_baseline(baseline_fn)
+
     results = []
     total = passed = 0
     for test in tests_to_run:
         print('  {}'.format(test.name))
-        total_, passed_, details = test.run()
+        if args.perf:
+            total_, passed_, details = test.run(baseline, args.update_baseline)
+        else:
+            total_, passed_, details = test.run()
 
         results.append(details)
 
@@ -88,6 +118,15 @@ if __name__ == '__main__':
         total += total_
         passed += passed_
 
+    if args.perf:
+        summary = base_dir / 'results' / 'perf' / 'summary.json'
+        summary.parent.mkdir(parents=True, exist_ok=True)
+        summary.write_text(json.dumps(results, indent=2))
+
+        if args.update_baseline:
+            perf.save_baseline(baseline_fn, baseline)
+            print("\nBaseline updated: {}".format(baseline_fn))
+
     print("\n{} of {} cases passed".format(passed, total))
 
     # return code is number of failed cases
@@ -23,7 +23,7 @@
 import json
 import pathlib
 
-from . import test, configuration
+from . import test, perf, configuration
 
 
 def tests(base_dir, cfg, args):
@@ -36,6 +36,16 @@ def tests(base_dir, cfg, args):
             print(" WARN: Can't parse test '{}' - {}".format(fn.name, ex))
 
 
+def perf_tests(base_dir, cfg, args):
+    base_dir = pathlib.Path(base_dir)
+
+    for fn in (base_dir / 'perf').rglob("*.json"):
+        try:
+            yield perf.PerfTest(fn, base_dir, cfg, args)
+        except Exception as ex:
+            print(" WARN: Can't parse perf test '{}' - {}".format(fn.name, ex))
+
+
 def config(base_dir):
     fn = base_dir / 'ted.json'
 
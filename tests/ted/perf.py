@@ -0,0 +1,293 @@
+# -*- coding: utf-8 -*-
+
+# Copyright (c) 2020 Intel Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+import json
+import statistics
+import collections
+import itertools
+
+from pathlib import Path
+
+from . import run
+from .test import CaseLogger, ValidationError
+
+
+# CPU-only tools: none of them needs a GPU or /dev/dri. host_overhead runs
+# the runtime on top of libva_null, so for it the numbers cover the host-side
+# part of the pipeline (parsing, task management, bitstream packing).
+_TOOLS = {
+    'host_overhead',
+    'hevc_fei_extractor',
+    'asc_cpu',
+}
+
+# keys which are test-wide settings rather than case parameters
+_SETTINGS = {
+    'type',
+    'tool',
+    'repeat',
+    'tolerance',
+    'rss_tolerance',
+}
+
+
+def load_baseline(fn):
+    if not fn.exists():
+        return {}
+
+    return json.loads(fn.read_text())
+
+
+def save_baseline(fn, baseline):
+    with fn.open('w') as f:
+        json.dump(baseline, f, indent=2, sort_keys=True)
+        f.write('\n')
+
+
+class PerfTest(object):
+    def __init__(self, fn, base, cfg, args):
+        self.cases = []
+        self.cfg = cfg
+        self.base_dir = Path(base)
+
+        fn = Path(fn)
+
+        self.config = json.loads(fn.read_text(), object_pairs_hook=collections.OrderedDict)
+        self.name = fn.stem
+
+        if self.config.get('type', None) != 'perf':
+            raise ValidationError("not a perf test")
+
+        self.tool = self.config.get('tool', None)
+        if self.tool not in _TOOLS:
+            raise ValidationError("unknown tool")
+
+        self.repeat = int(self.config.get('repeat', 3))
+        self.tolerance = float(self.config.get('tolerance', args.tolerance))
+        self.rss_tolerance = float(self.config.get('rss_tolerance', args.rss_tolerance))
+
+        self.results = self.base_dir / 'results' / 'perf' / self.name
+
+        self.generate_cases()
+
+        self.runner = run.Runner(dict(), cfg)
+
+    def clear_results(self):
+        if self.results.exists():
+            for fn in self.results.glob('*.*'):
+                fn.unlink()
+
+    def host_overhead(self, case):
+        stream = case['stream']
+
+        codec = case.get('codec', stream.codec)
+        if codec == 'jpg':
+            codec = 'jpeg'
+
+        mode = case.get('mode', 'dec')
+        frames = int(case.get('frames', stream.frames))
+
+        cmd = ['host_overhead', mode, codec]
+        if mode == 'enc':
+            cmd.extend(['-w', stream.width, '-h', stream.height])
+        else:
+            cmd.extend(['-i', stream.path])
+        cmd.extend(['-n', frames])
+
+        if 'async' in case:
+            cmd.extend(['-async', case['async']])
+        if case.get('loop', False):
+            cmd.append('-loop')
+
+        return cmd, frames, []
+
+    def hevc_fei_extractor(self, case, case_id):
+        stream = case['stream']
+
+        outputs = ['{:04d}.ctu'.format(case_id), '{:04d}.cu'.format(case_id)]
+        cmd = ['hevc_fei_extractor', stream.path] + outputs
+
+        return cmd, stream.frames, outputs
+
+    def asc_cpu(self, case):
+        stream = case['stream']
+        loops = int(case.get('loop', 1))
+
+        cmd = ['asc_cpu', '-i', stream.path, '-w', stream.width, '-h', stream.height]
+        cmd.extend(['-loop', loops])
+
+        return cmd, stream.frames * loops, []
+
+    def build_command(self, case_id, case):
+        if self.tool == 'host_overhead':
+            return self.host_overhead(case)
+        elif self.tool == 'hevc_fei_extractor':
+            return self.hevc_fei_extractor(case, case_id)
+        elif self.tool == 'asc_cpu':
+            return self.asc_cpu(case)
+
+    def measure(self, case_id, cmd, log):
+        samples = []
+        for _ in range(self.repeat):
+            usage = self.runner._measure(case_id, cmd, self.results, log)
+            if usage is None:
+                return None
+            samples.append(usage)
+
+        # median filters out one-off hiccups (page cache, frequency ramp-up)
+        return {
+            key: statistics.median(s[key] for s in samples)
+            for key in ('wall', 'cpu', 'rss')
+        }
+
+    def compare(self, metrics, reference):
+        errors = []
+
+        if metrics['fps'] < reference['fps'] * (1 - self.tolerance / 100):
+            errors.append("fps {:.1f} < baseline {:.1f}".format(metrics['fps'], reference['fps']))
+
+        if metrics['cpu_ms'] > reference['cpu_ms'] * (1 + self.tolerance / 100):
+            errors.append("cpu {:.3f} ms/frame > baseline {:.3f}".format(
+                metrics['cpu_ms'], reference['cpu_ms']))
+
+        if metrics['rss_kb'] > reference['rss_kb'] * (1 + self.rss_tolerance / 100):
+            errors.append("peak RSS {} KiB > baseline {}".format(metrics['rss_kb'], reference['rss_kb']))
+
+        return errors
+
+    def run(self, baseline, update=False):
+        self.clear_results()
+        self.results.mkdir(parents=True, exist_ok=True)
+        total = passed = 0
+
+        details = {
+            'test': self.name,
+            'cases': []
+        }
+        for i, case in enumerate(self.cases, 1):
+            log = CaseLogger(self.results / "{:04d}.log".format(i), self.cfg)
+
+            total += 1
+            print("    {:04d}".format(i), end="")
+
+            cmd, frames, outputs = self.build_command(i, case)
+            # streams are named without their location so baselines can be
+            # shared between checkouts
+            cmdline = ' '.join(e.name if isinstance(e, Path) else str(e) for e in cmd)
+            key = '{}/{:04d}'.format(self.name, i)
+
+            res = {
+                'id': '{:04d}'.format(i),
+                'cmd': cmdline,
+            }
+
+            usage = self.measure(i, cmd, log)
+
+            for fn in outputs:
+                try:
+                    (self.results / fn).unlink()
+                except Exception:
+                    pass
+
+            if usage is None:
+                print(' - FAIL')
+                res['status'] = 'FAIL'
+                res['error'] = 'fail'
+                with log.fn.open('r') as f:
+                    print(f.read())
+                details['cases'].append(res)
+                continue
+
+            metrics = {
+                'fps': frames / usage['wall'] if usage['wall'] else 0.0,
+                'cpu_ms': usage['cpu'] * 1000 / frames,
+                'rss_kb': int(usage['rss']),
+            }
+            res['metrics'] = metrics
+
+            reference = baseline.get(key, None)
+            if reference is not None and reference.get('cmd', None) != cmdline:
+                # case was changed, old numbers aren't comparable
+                reference = None
+
+            errors = []
+            if update:
+                baseline[key] = dict(metrics, cmd=cmdline)
+            elif reference is not None:
+                res['baseline'] = reference
+                errors = self.compare(metrics, reference)
+
+            summary = "{:.1f} fps, {:.3f} ms/frame cpu, {} KiB".format(
+                metrics['fps'], metrics['cpu_ms'], metrics['rss_kb'])
+            log.log(summary)
+
+            if errors:
+                print(' - FAIL ({})'.format('; '.join(errors)))
+                res['status'] = 'FAIL'
+                res['error'] = '; '.join(errors)
+                log.log('FAIL: ' + res['error'])
+            else:
+                passed += 1
+                note = '' if reference is not None or update else ', no baseline'
+                print(' - ok ({}{})'.format(summary, note))
+                res['status'] = 'PASS'
+                log.log('PASS')
+
+            details['cases'].append(res)
+
+        return (total, passed, details)
+
+    def generate_cases(self):
+        keys = []
+        values = []
+
+        for key, val in self.config.items():
+            if key in _SETTINGS:
+                continue
+
+            keys.append(key)
+            if isinstance(val, list):
+                values.append(val)
+            else:
+                values.append([val])
+
+        for vals in itertools.product(*values):
+            case = collections.OrderedDict(zip(keys, vals))
+
+            if 'stream' not in case:
+                raise ValidationError("stream is not defined")
+            case['stream'] = self.cfg.stream_by_name(case['stream'])
+
+            if self.tool == 'host_overhead':
+                mode = case.get('mode', 'dec')
+                if mode not in ['enc', 'dec', 'hdr']:
+                    raise ValidationError("unknown host_overhead mode '{}'".format(mode))
+                if mode == 'enc' and 'codec' not in case:
+                    raise ValidationError("unknown codec for encode case")
+            elif self.tool == 'hevc_fei_extractor':
+                if case['stream'].codec != 'h265':
+                    raise ValidationError("hevc_fei_extractor requires h265 stream")
+            elif self.tool == 'asc_cpu':
+                if case['stream'].codec != 'i420':
+                    raise ValidationError("asc_cpu requires i420 stream")
+
+            self.cases.append(case)
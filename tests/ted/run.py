@@ -23,6 +23,7 @@
 import os
 import re
 import json
+import time
 import pprint
 import pathlib
 import hashlib
@@ -105,6 +106,52 @@ class Runner(object):
 
             return exc.returncode
 
+    def _measure(self, case_id, cmd, workdir, log):
+        # same as _run() but returns wall time (s), user+system CPU time (s)
+        # and peak RSS (KiB) of the child, or None if it failed
+        log.dump_header()
+        log.separator()
+        for var, val in self.extra_env.items():
+            log.log("export {}={}".format(var, val))
+
+        log.log("cd {}".format(workdir.resolve()))
+
+        cmd = [str(e) for e in cmd]
+        log.log(subprocess.list2cmdline(cmd))
+        log.separator()
+
+        try:
+            start = time.perf_counter()
+            p = subprocess.Popen(
+                cmd,
+                stdout=subprocess.PIPE,
+                stderr=subprocess.STDOUT,
+                cwd=str(workdir),
+                env=self.env,
+            )
+            output = p.stdout.read()
+            _, status, usage = os.wait4(p.pid, 0)
+            wall = time.perf_counter() - start
+            # the child is reaped by wait4(), don't let Popen wait for it again
+            p.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -1
+        except OSError as exc:
+            log.log("can't run: {}".format(exc))
+            log.separator()
+            return None
+
+        log.log(output.decode('utf-8', 'ignore'))
+        log.separator()
+
+        if p.returncode != 0:
+            log.log("return code: {}".format(p.returncode))
+            return None
+
+        return {
+            'wall': wall,
+            'cpu': usage.ru_utime + usage.ru_stime,
+            'rss': usage.ru_maxrss,
+        }
+
     def other_options(self, case):
         cmd = []
         # process remaining arguments
@@ -0,0 +1,290 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Zero-copy encoder output (mfxExtCodedBufferRef) of the AVC and HEVC encoders.
+// The test is linked with libva_null ahead of libva, so the runtime loaded by
+// the dispatcher runs its full task path on a device that writes a synthetic
+// bitstream into the coded buffers.
+
+#include "mfxvideo++.h"
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <va/va.h>
+#include <va/va_drm.h>
+
+namespace
+{
+    const mfxU16 WIDTH  = 320;
+    const mfxU16 HEIGHT = 240;
+
+    // output bitstream of one frame with the coded buffer reference attached
+    struct Output
+    {
+        Output(mfxU32 size)
+            : data(size)
+        {
+            ref.Header.BufferId = MFX_EXTBUFF_CODED_BUFFER_REF;
+            ref.Header.BufferSz = sizeof(ref);
+
+            bs.Data        = data.data();
+            bs.MaxLength   = size;
+            bs.ExtParam    = &ext;
+            bs.NumExtParam = 1;
+        }
+
+        bool IsLent() const
+        {
+            return ref.Referenced == MFX_CODINGOPTION_ON;
+        }
+
+        mfxStatus Release()
+        {
+            return ref.Release ? ref.Release(ref.pthis, &bs) : MFX_ERR_NULL_PTR;
+        }
+
+        std::vector<mfxU8>   data;
+        mfxBitstream         bs  = {};
+        mfxExtCodedBufferRef ref = {};
+        mfxExtBuffer*        ext = &ref.Header;
+    };
+}
+
+class CodedBufferRefTest : public ::testing::TestWithParam<mfxU32>
+{
+protected:
+    void SetUp() override
+    {
+        m_fd = open("/dev/null", O_RDWR);
+        ASSERT_GE(m_fd, 0);
+
+        m_display = vaGetDisplayDRM(m_fd);
+        int major = 0, minor = 0;
+        ASSERT_EQ(VA_STATUS_SUCCESS, vaInitialize(m_display, &major, &minor)) << "libva_null is not linked ahead of libva";
+
+        mfxVersion version = { { 0, 1 } };
+        ASSERT_EQ(MFX_ERR_NONE, m_session.Init(MFX_IMPL_HARDWARE_ANY, &version));
+        ASSERT_EQ(MFX_ERR_NONE, m_session.SetHandle(MFX_HANDLE_VA_DISPLAY, m_display));
+
+        m_encode.reset(new MFXVideoENCODE(m_session));
+    }
+
+    void TearDown() override
+    {
+        m_encode.reset();
+        m_session.Close();
+
+        if (m_display)
+            vaTerminate(m_display);
+        if (m_fd >= 0)
+            close(m_fd);
+    }
+
+    void Init(mfxU16 numHeld)
+    {
+        m_par.mfx.CodecId                 = GetParam();
+        m_par.mfx.TargetUsage             = MFX_TARGETUSAGE_BALANCED;
+        m_par.mfx.RateControlMethod       = MFX_RATECONTROL_CQP;
+        m_par.mfx.QPI = m_par.mfx.QPP     = m_par.mfx.QPB = 26;
+        m_par.mfx.GopPicSize              = 30;
+        m_par.mfx.GopRefDist              = 1;
+        m_par.mfx.FrameInfo.FourCC        = MFX_FOURCC_NV12;
+        m_par.mfx.FrameInfo.ChromaFormat  = MFX_CHROMAFORMAT_YUV420;
+        m_par.mfx.FrameInfo.PicStruct     = MFX_PICSTRUCT_PROGRESSIVE;
+        m_par.mfx.FrameInfo.Width         = WIDTH;
+        m_par.mfx.FrameInfo.Height        = HEIGHT;
+        m_par.mfx.FrameInfo.CropW         = WIDTH;
+        m_par.mfx.FrameInfo.CropH         = HEIGHT;
+        m_par.mfx.FrameInfo.FrameRateExtN = 30;
+        m_par.mfx.FrameInfo.FrameRateExtD = 1;
+        m_par.IOPattern                   = MFX_IOPATTERN_IN_SYSTEM_MEMORY;
+        m_par.AsyncDepth                  = 1;
+
+        m_codedRef.Header.BufferId = MFX_EXTBUFF_CODED_BUFFER_REF;
+        m_codedRef.Header.BufferSz = sizeof(m_codedRef);
+        m_codedRef.NumHeldBuffers  = numHeld;
+        m_parExt[0]                = &m_codedRef.Header;
+        m_par.ExtParam             = m_parExt;
+        m_par.NumExtParam          = 1;
+
+        ASSERT_EQ(MFX_ERR_NONE, m_encode->Init(&m_par));
+
+        mfxVideoParam actual = {};
+        ASSERT_EQ(MFX_ERR_NONE, m_encode->GetVideoParam(&actual));
+        m_bsSize = actual.mfx.BufferSizeInKB * 1000 * std::max<mfxU16>(actual.mfx.BRCParamMultiplier, 1);
+
+        m_frame.assign(WIDTH * HEIGHT * 3 / 2, 128);
+        m_surface = mfxFrameSurface1();
+        m_surface.Info       = m_par.mfx.FrameInfo;
+        m_surface.Data.Y     = m_frame.data();
+        m_surface.Data.UV    = m_surface.Data.Y + WIDTH * HEIGHT;
+        m_surface.Data.Pitch = WIDTH;
+    }
+
+    // Reset that starts a new sequence, the encoder drops all its pool locks
+    void ResetWithIdr()
+    {
+        mfxExtEncoderResetOption resetOpt = {};
+        resetOpt.Header.BufferId = MFX_EXTBUFF_ENCODER_RESET_OPTION;
+        resetOpt.Header.BufferSz = sizeof(resetOpt);
+        resetOpt.StartNewSequence = MFX_CODINGOPTION_ON;
+
+        mfxExtBuffer* ext[] = { &m_codedRef.Header, &resetOpt.Header };
+        mfxVideoParam par = m_par;
+        par.ExtParam    = ext;
+        par.NumExtParam = 2;
+
+        ASSERT_EQ(MFX_ERR_NONE, m_encode->Reset(&par));
+    }
+
+    // Encodes frames until one is output to 'out' and syncs it
+    void EncodeFrame(Output& out)
+    {
+        mfxSyncPoint syncp = nullptr;
+        mfxStatus sts = MFX_ERR_MORE_DATA;
+
+        for (int i = 0; i < 4 && sts == MFX_ERR_MORE_DATA; i++)
+        {
+            m_surface.Data.FrameOrder = m_frameOrder++;
+
+            do
+            {
+                sts = m_encode->EncodeFrameAsync(nullptr, &m_surface, &out.bs, &syncp);
+                if (sts == MFX_WRN_DEVICE_BUSY)
+                    std::this_thread::yield();
+            } while (sts == MFX_WRN_DEVICE_BUSY);
+        }
+
+        ASSERT_EQ(MFX_ERR_NONE, sts);
+        ASSERT_NE(nullptr, syncp);
+        ASSERT_EQ(MFX_ERR_NONE, m_session.SyncOperation(syncp, MFX_INFINITE));
+        ASSERT_GT(out.bs.DataLength, 0u);
+    }
+
+    int                             m_fd      = -1;
+    VADisplay                       m_display = nullptr;
+    MFXVideoSession                 m_session;
+    std::unique_ptr<MFXVideoENCODE> m_encode;
+
+    mfxVideoParam        m_par       = {};
+    mfxExtCodedBufferRef m_codedRef  = {};
+    mfxExtBuffer*        m_parExt[1] = {};
+    mfxU32               m_bsSize    = 0;
+
+    std::vector<mfxU8> m_frame;
+    mfxFrameSurface1   m_surface    = {};
+    mfxU32             m_frameOrder = 0;
+};
+
+TEST_P(CodedBufferRefTest, ShouldLendCodedBufferAndTakeItBack)
+{
+    ASSERT_NO_FATAL_FAILURE(Init(1));
+
+    Output out(m_bsSize);
+    ASSERT_NO_FATAL_FAILURE(EncodeFrame(out));
+
+    ASSERT_TRUE(out.IsLent());
+    EXPECT_NE(out.data.data(), out.bs.Data);
+    EXPECT_EQ(out.data.data(), out.ref.SavedData);
+    EXPECT_EQ(m_bsSize, out.ref.SavedMaxLength);
+
+    ASSERT_EQ(MFX_ERR_NONE, out.Release());
+    EXPECT_FALSE(out.IsLent());
+    EXPECT_EQ(out.data.data(), out.bs.Data);
+    EXPECT_EQ(m_bsSize, out.bs.MaxLength);
+    EXPECT_EQ(0u, out.bs.DataLength);
+
+    // the buffer is given back once only
+    EXPECT_EQ(MFX_ERR_UNDEFINED_BEHAVIOR, out.ref.Release(out.ref.pthis, &out.bs));
+
+    // and goes back to the pool
+    ASSERT_NO_FATAL_FAILURE(EncodeFrame(out));
+    EXPECT_TRUE(out.IsLent());
+    EXPECT_EQ(MFX_ERR_NONE, out.Release());
+}
+
+TEST_P(CodedBufferRefTest, ShouldCopyWhenAllBuffersAreHeld)
+{
+    ASSERT_NO_FATAL_FAILURE(Init(1));
+
+    Output held(m_bsSize);
+    ASSERT_NO_FATAL_FAILURE(EncodeFrame(held));
+    ASSERT_TRUE(held.IsLent());
+
+    Output copied(m_bsSize);
+    ASSERT_NO_FATAL_FAILURE(EncodeFrame(copied));
+    EXPECT_FALSE(copied.IsLent());
+    EXPECT_EQ(copied.data.data(), copied.bs.Data);
+
+    ASSERT_EQ(MFX_ERR_NONE, held.Release());
+
+    Output lent(m_bsSize);
+    ASSERT_NO_FATAL_FAILURE(EncodeFrame(lent));
+    EXPECT_TRUE(lent.IsLent());
+    EXPECT_EQ(MFX_ERR_NONE, lent.Release());
+}
+
+TEST_P(CodedBufferRefTest, ShouldKeepBufferHeldAcrossReset)
+{
+    ASSERT_NO_FATAL_FAILURE(Init(1));
+
+    Output held(m_bsSize);
+    ASSERT_NO_FATAL_FAILURE(EncodeFrame(held));
+    ASSERT_TRUE(held.IsLent());
+
+    // the encoder must not write to a buffer the application holds,
+    // whatever the device writes would overwrite the marker
+    std::memset(held.bs.Data + held.bs.DataOffset, 0xa5, held.bs.DataLength);
+    std::vector<mfxU8> const marker(held.bs.Data + held.bs.DataOffset, held.bs.Data + held.bs.DataOffset + held.bs.DataLength);
+
+    ASSERT_NO_FATAL_FAILURE(ResetWithIdr());
+
+    // more frames than there are coded buffers, each returned right away
+    for (int i = 0; i < 16; i++)
+    {
+        Output out(m_bsSize);
+        ASSERT_NO_FATAL_FAILURE(EncodeFrame(out));
+        EXPECT_FALSE(out.IsLent()) << "frame " << i << " got a buffer while the only lendable one is held";
+        if (out.IsLent())
+        {
+            ASSERT_EQ(MFX_ERR_NONE, out.Release());
+        }
+    }
+
+    EXPECT_TRUE(std::equal(marker.begin(), marker.end(), held.bs.Data + held.bs.DataOffset));
+
+    ASSERT_EQ(MFX_ERR_NONE, held.Release());
+
+    Output lent(m_bsSize);
+    ASSERT_NO_FATAL_FAILURE(EncodeFrame(lent));
+    EXPECT_TRUE(lent.IsLent());
+    EXPECT_EQ(MFX_ERR_NONE, lent.Release());
+}
+
+INSTANTIATE_TEST_CASE_P(Codecs, CodedBufferRefTest, ::testing::Values(mfxU32(MFX_CODEC_AVC), mfxU32(MFX_CODEC_HEVC)));
@@ -0,0 +1,313 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// The parse thread of the AVC/HEVC decoders in mfxExtDecodePreSplit mode
+// (UMC::NalUnitSplitterThread). A start code splitter of the test stands in
+// for the codec ones, the input is consumed the same way TaskSupplier does it:
+// frames are queued ahead, the window is read while the thread splits.
+
+#include "umc_nal_unit_splitter_thread.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace UMC;
+
+namespace
+{
+    // Splits at 3 and 4 byte start codes. As the codec splitters it consumes
+    // an incomplete NAL unit and returns NULL until the rest of it comes.
+    class TestSplitter : public NalUnitSplitterThread
+    {
+    public:
+
+        ~TestSplitter()
+        {
+            Stop();
+        }
+
+        // hands the next NAL unit of the window out as the codec splitters do
+        Unit const * Next(MediaData * window)
+        {
+            Unit const * unit = FindUnit(window);
+            if (!unit)
+                return nullptr;
+
+            uint8_t const * nalUnit = reinterpret_cast<uint8_t const *>(window->GetDataPointer()) + 3;
+            if (FindPrepared(nalUnit, unit->size - 3) != unit)
+                return nullptr;
+
+            window->MoveDataPointer(static_cast<int32_t>(unit->size));
+            return unit;
+        }
+
+    protected:
+
+        static uint8_t * FindStartCode(uint8_t * begin, uint8_t * end)
+        {
+            for (uint8_t * p = begin; p + 3 <= end; p++)
+            {
+                if (!p[0] && !p[1] && p[2] == 1)
+                    return p + 3;
+            }
+
+            return end;
+        }
+
+        MediaData * SplitNext(MediaData * pSource, int32_t & type) override
+        {
+            if (!pSource)
+                return nullptr;
+
+            uint8_t * begin = reinterpret_cast<uint8_t *>(pSource->GetDataPointer());
+            uint8_t * end   = begin + pSource->GetDataSize();
+            uint8_t * nal   = FindStartCode(begin, end);
+            uint8_t * next  = FindStartCode(nal, end);
+            uint8_t * nalEnd = end;
+
+            if (next != end)
+            {
+                nalEnd = next - 3;
+                if (nalEnd > nal && !nalEnd[-1])
+                    nalEnd--;
+            }
+            else if (nal == end || (pSource->GetFlags() & MediaData::FLAG_VIDEO_DATA_NOT_FULL_UNIT))
+            {
+                pSource->MoveDataPointer(static_cast<int32_t>(end - begin));
+                return nullptr;
+            }
+
+            m_nalUnit.SetBufferPointer(nal, nalEnd - nal);
+            m_nalUnit.SetDataSize(nalEnd - nal);
+            m_nalUnit.SetTime(pSource->GetTime());
+            pSource->MoveDataPointer(static_cast<int32_t>(nalEnd - begin));
+
+            type = nal[0] & 0x1f;
+            return &m_nalUnit;
+        }
+
+        void PrepareUnit(MediaData & nalUnit, Unit & unit) override
+        {
+            uint8_t const * data = reinterpret_cast<uint8_t const *>(nalUnit.GetDataPointer());
+            unit.payload.assign(data, data + nalUnit.GetDataSize());
+            unit.payloadSize = unit.payload.size();
+        }
+
+        void ResetSplit() override
+        {
+        }
+
+        MediaData m_nalUnit;
+    };
+
+    struct NalUnit
+    {
+        std::vector<uint8_t> data;
+        int32_t              type;
+        double               time;
+
+        bool operator == (NalUnit const & other) const
+        {
+            return data == other.data && type == other.type && time == other.time;
+        }
+    };
+}
+
+class NalSplitterThreadTest : public ::testing::Test
+{
+protected:
+
+    static const int FRAMES = 40;
+
+    void SetUp() override
+    {
+        std::uniform_int_distribution<int> units(1, 6);
+        std::uniform_int_distribution<int> size(1, 200);
+        std::uniform_int_distribution<int> byte(1, 255);
+        std::bernoulli_distribution        longCode(0.5);
+
+        for (int i = 0; i < FRAMES; i++)
+        {
+            std::vector<uint8_t> frame;
+
+            for (int n = units(rng); n; n--)
+            {
+                if (longCode(rng))
+                    frame.push_back(0);
+                frame.insert(frame.end(), { 0, 0, 1 });
+
+                // no zero bytes in the payload, so there are no start codes in it
+                NalUnit unit;
+                unit.data.resize(size(rng));
+                for (uint8_t & b : unit.data)
+                    b = (uint8_t)byte(rng);
+                unit.type = unit.data[0] & 0x1f;
+                unit.time = i;
+
+                frame.insert(frame.end(), unit.data.begin(), unit.data.end());
+                expected.push_back(unit);
+            }
+
+            frames.push_back(frame);
+        }
+    }
+
+    // Puts the frames in pieces of at most 'piece' bytes, reads the window
+    // after each one and waits for the thread when the queue is full
+    void Run(size_t limit, size_t piece)
+    {
+        splitter.Start(limit);
+
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            std::vector<uint8_t> & frame = frames[i];
+
+            for (size_t offset = 0; offset < frame.size(); )
+            {
+                size_t const size = std::min(piece, frame.size() - offset);
+                bool const last = offset + size == frame.size();
+
+                MediaData source;
+                source.SetBufferPointer(frame.data() + offset, size);
+                source.SetDataSize(size);
+                source.SetTime((double)i);
+                source.SetFlags(last ? 0 : MediaData::FLAG_VIDEO_DATA_NOT_FULL_UNIT | MediaData::FLAG_VIDEO_DATA_NOT_FULL_FRAME);
+
+                while (source.GetDataSize())
+                {
+                    splitter.PutData(&source);
+                    Read(splitter.IsFull());
+                }
+
+                offset += size;
+            }
+        }
+
+        splitter.PutData(nullptr);
+        Read(true);
+    }
+
+    void Read(bool wait)
+    {
+        for (;;)
+        {
+            MediaData * window = splitter.GetData(wait);
+            if (!window)
+                return;
+
+            size_t const size = window->GetDataSize();
+
+            while (NalUnitSplitterThread::Unit const * unit = splitter.Next(window))
+            {
+                // move back over the unit as the decoder does when it looks ahead
+                if (got.size() % 3 == 0)
+                {
+                    window->MoveDataPointer(-static_cast<int32_t>(unit->size));
+                    ASSERT_EQ(unit, splitter.Next(window));
+                }
+
+                NalUnit nalUnit;
+                nalUnit.data.assign(unit->payload.begin(), unit->payload.begin() + unit->payloadSize);
+                nalUnit.type = unit->type;
+                nalUnit.time = unit->time;
+                got.push_back(nalUnit);
+            }
+
+            if (window->GetDataSize() == size && !wait)
+                return;
+        }
+    }
+
+    std::mt19937                      rng{ 20200601 };
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<NalUnit>              expected;
+    std::vector<NalUnit>              got;
+    TestSplitter                      splitter;
+};
+
+TEST_F(NalSplitterThreadTest, SplitsCompleteFrames)
+{
+    Run(1 << 20, SIZE_MAX);
+    EXPECT_EQ(expected, got);
+}
+
+// the queue is smaller than a frame, the buffer is compacted and grown
+// while the thread splits
+TEST_F(NalSplitterThreadTest, SplitsWithSmallQueue)
+{
+    Run(64, SIZE_MAX);
+    EXPECT_EQ(expected, got);
+}
+
+// NAL units and start codes are cut between pieces, the thread splits them
+// again when the rest is queued
+TEST_F(NalSplitterThreadTest, SplitsFragmentedUnits)
+{
+    for (size_t piece : { 1, 2, 7, 50 })
+    {
+        got.clear();
+        Run(256, piece);
+        EXPECT_EQ(expected, got) << "piece " << piece;
+    }
+}
+
+TEST_F(NalSplitterThreadTest, TakesBackUnconsumedInput)
+{
+    splitter.Start(1 << 20);
+
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        MediaData source;
+        source.SetBufferPointer(frames[i].data(), frames[i].size());
+        source.SetDataSize(frames[i].size());
+        source.SetTime((double)i);
+        splitter.PutData(&source);
+        ASSERT_EQ(0u, source.GetDataSize());
+    }
+
+    // consume the first frame
+    size_t const units = std::count_if(expected.begin(), expected.end(), [](NalUnit const & u) { return u.time == 0; });
+    while (got.size() < units)
+    {
+        MediaData * window = splitter.GetData(true);
+        ASSERT_NE(nullptr, window);
+
+        while (got.size() < units)
+        {
+            NalUnitSplitterThread::Unit const * unit = splitter.Next(window);
+            if (!unit)
+                break;
+            got.push_back(NalUnit());
+        }
+    }
+
+    std::vector<uint8_t> rest;
+    splitter.TakeBack(rest);
+
+    std::vector<uint8_t> input;
+    for (size_t i = 1; i < frames.size(); i++)
+        input.insert(input.end(), frames[i].begin(), frames[i].end());
+
+    EXPECT_EQ(input, rest);
+    EXPECT_EQ(nullptr, splitter.GetData(false));
+}
@@ -0,0 +1,269 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_vpp_cpu_kernels.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace MfxCpuVideoProcessing;
+
+// Tolerances of the AVX2 kernels against the C ones:
+//  - unpack / pack are bit exact, both round to nearest even;
+//  - the filters and the color matrix use FMA and may differ from the C
+//    multiply-add in the last bits, so float output is compared within
+//    FLOAT_TOLERANCE (in 8-bit sample units);
+//  - after packing this can move a sample by at most one code value.
+static const float FLOAT_TOLERANCE = 1e-3f;
+static const int   CODE_TOLERANCE  = 1;
+
+// covers the empty row, all tail lengths of the 8 and 16 wide loops and a
+// couple of full iterations
+static const mfxI32 MAX_WIDTH = 67;
+
+class VppCpuKernelsTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        GetCpuKernels(c, false);
+        GetCpuKernels(simd, true);
+    }
+
+    // the AVX2 table is only filled in on CPUs that support it
+    bool HasSimd() const
+    {
+        if (simd.HorzFilter != c.HorzFilter)
+            return true;
+
+        std::cout << "[   INFO   ] AVX2 is not supported, nothing to compare" << std::endl;
+        return false;
+    }
+
+    std::vector<float> RandomRow(size_t size, float lo, float hi)
+    {
+        std::uniform_real_distribution<float> dist(lo, hi);
+        std::vector<float> row(size);
+        for (float & v : row)
+            v = dist(rng);
+        return row;
+    }
+
+    CpuKernels   c;
+    CpuKernels   simd;
+    std::mt19937 rng{ 20200601 };
+};
+
+TEST_F(VppCpuKernelsTest, UnpackIsBitExact)
+{
+    if (!HasSimd())
+        return;
+
+    std::uniform_int_distribution<int> dist(0, 0xffff);
+    std::vector<mfxU8>  src8(2 * MAX_WIDTH);
+    std::vector<mfxU16> src16(2 * MAX_WIDTH);
+    for (size_t i = 0; i < src8.size(); i++)
+    {
+        src8[i]  = (mfxU8)dist(rng);
+        src16[i] = (mfxU16)dist(rng);
+    }
+
+    for (mfxI32 step = 1; step <= 2; step++)
+    {
+        for (mfxI32 w = 0; w <= MAX_WIDTH; w++)
+        {
+            std::vector<float> ref(w + 1, -1.f), tst(w + 1, -1.f);
+
+            c.UnpackRow8(src8.data(), step, ref.data(), w);
+            simd.UnpackRow8(src8.data(), step, tst.data(), w);
+            ASSERT_EQ(ref, tst) << "8-bit, step " << step << ", width " << w;
+
+            for (mfxI32 shift = 0; shift <= 6; shift += 6)
+            {
+                c.UnpackRow16(src16.data(), step, shift, ref.data(), w);
+                simd.UnpackRow16(src16.data(), step, shift, tst.data(), w);
+                ASSERT_EQ(ref, tst) << "16-bit, step " << step << ", shift " << shift << ", width " << w;
+            }
+        }
+    }
+}
+
+TEST_F(VppCpuKernelsTest, PackIsBitExact)
+{
+    if (!HasSimd())
+        return;
+
+    // out of range values check the saturation, .5 the rounding
+    std::vector<float> u = RandomRow(MAX_WIDTH, -16.f, 272.f);
+    std::vector<float> v = RandomRow(MAX_WIDTH, -16.f, 272.f);
+    u[1] = 2.5f;
+    v[1] = 3.5f;
+
+    for (mfxI32 w = 0; w <= MAX_WIDTH; w++)
+    {
+        std::vector<mfxU8> ref8(2 * w + 1, 0xaa), tst8(2 * w + 1, 0xaa);
+        std::vector<mfxU16> ref16(2 * w + 1, 0xaaaa), tst16(2 * w + 1, 0xaaaa);
+
+        for (mfxI32 step = 1; step <= 2; step++)
+        {
+            c.PackRow8(u.data(), ref8.data(), step, w);
+            simd.PackRow8(u.data(), tst8.data(), step, w);
+            ASSERT_EQ(ref8, tst8) << "8-bit, step " << step << ", width " << w;
+
+            c.PackRow16(u.data(), ref16.data(), step, 6, w);
+            simd.PackRow16(u.data(), tst16.data(), step, 6, w);
+            ASSERT_EQ(ref16, tst16) << "16-bit, step " << step << ", width " << w;
+        }
+
+        c.PackUV8(u.data(), v.data(), ref8.data(), w);
+        simd.PackUV8(u.data(), v.data(), tst8.data(), w);
+        ASSERT_EQ(ref8, tst8) << "8-bit UV, width " << w;
+
+        c.PackUV16(u.data(), v.data(), ref16.data(), 6, w);
+        simd.PackUV16(u.data(), v.data(), tst16.data(), 6, w);
+        ASSERT_EQ(ref16, tst16) << "16-bit UV, width " << w;
+    }
+}
+
+TEST_F(VppCpuKernelsTest, ResizeFiltersMatchWithinTolerance)
+{
+    if (!HasSimd())
+        return;
+
+    const mfxI32 maxTaps = 8;
+    std::vector<float> src = RandomRow(2 * MAX_WIDTH + maxTaps, 0.f, 255.f);
+    std::vector<std::vector<float>> rows(maxTaps);
+    for (auto & row : rows)
+        row = RandomRow(MAX_WIDTH, 0.f, 255.f);
+
+    std::vector<const float *> rowPtr;
+    for (auto & row : rows)
+        rowPtr.push_back(row.data());
+
+    for (mfxI32 taps = 1; taps <= maxTaps; taps++)
+    {
+        for (mfxI32 w = 0; w <= MAX_WIDTH; w++)
+        {
+            // downscale by 2 with random weights normalized per output
+            // sample as the resizer builds them, so the output stays in range
+            std::vector<mfxI32> start(w);
+            std::vector<float> coef = RandomRow((size_t)taps * w, 0.1f, 1.f);
+            for (mfxI32 i = 0; i < w; i++)
+            {
+                start[i] = 2 * i;
+                float sum = 0.f;
+                for (mfxI32 k = 0; k < taps; k++)
+                    sum += coef[k * w + i];
+                for (mfxI32 k = 0; k < taps; k++)
+                    coef[k * w + i] /= sum;
+            }
+
+            std::vector<float> ref(w), tst(w);
+            c.HorzFilter(src.data(), ref.data(), start.data(), coef.data(), taps, w);
+            simd.HorzFilter(src.data(), tst.data(), start.data(), coef.data(), taps, w);
+            for (mfxI32 i = 0; i < w; i++)
+                ASSERT_NEAR(ref[i], tst[i], FLOAT_TOLERANCE) << "horizontal, taps " << taps << ", width " << w << ", x " << i;
+
+            c.VertFilter(rowPtr.data(), coef.data(), taps, ref.data(), w);
+            simd.VertFilter(rowPtr.data(), coef.data(), taps, tst.data(), w);
+            for (mfxI32 i = 0; i < w; i++)
+                ASSERT_NEAR(ref[i], tst[i], FLOAT_TOLERANCE) << "vertical, taps " << taps << ", width " << w << ", x " << i;
+        }
+    }
+}
+
+TEST_F(VppCpuKernelsTest, ColorConversionMatchesWithinTolerance)
+{
+    if (!HasSimd())
+        return;
+
+    // BT.601 limited range YUV -> R, G, B
+    const float matrix[3][4] =
+    {
+        { 1.164f,  0.f,    1.596f, -222.9f },
+        { 1.164f, -0.392f, -0.813f, 135.6f },
+        { 1.164f,  2.017f,  0.f,   -276.8f },
+    };
+
+    std::vector<float> y = RandomRow(MAX_WIDTH, 16.f, 235.f);
+    std::vector<float> u = RandomRow(MAX_WIDTH, 16.f, 240.f);
+    std::vector<float> v = RandomRow(MAX_WIDTH, 16.f, 240.f);
+
+    for (mfxI32 w = 0; w <= MAX_WIDTH; w++)
+    {
+        for (const auto & m : matrix)
+        {
+            std::vector<float> ref(w), tst(w);
+            c.Combine3(y.data(), u.data(), v.data(), m, ref.data(), w);
+            simd.Combine3(y.data(), u.data(), v.data(), m, tst.data(), w);
+            for (mfxI32 i = 0; i < w; i++)
+                ASSERT_NEAR(ref[i], tst[i], FLOAT_TOLERANCE) << "width " << w << ", x " << i;
+
+            std::vector<mfxU8> ref8(w), tst8(w);
+            c.PackRow8(ref.data(), ref8.data(), 1, w);
+            simd.PackRow8(tst.data(), tst8.data(), 1, w);
+            for (mfxI32 i = 0; i < w; i++)
+                ASSERT_LE(std::abs(ref8[i] - tst8[i]), CODE_TOLERANCE) << "width " << w << ", x " << i;
+        }
+    }
+}
+
+// a composited row goes through unpack, blend and pack of the same table
+TEST_F(VppCpuKernelsTest, CompositionMatchesWithinTolerance)
+{
+    if (!HasSimd())
+        return;
+
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<mfxU8> bg(MAX_WIDTH), fg(MAX_WIDTH), alpha(4 * MAX_WIDTH);
+    for (mfxI32 i = 0; i < MAX_WIDTH; i++)
+    {
+        bg[i] = (mfxU8)dist(rng);
+        fg[i] = (mfxU8)dist(rng);
+    }
+    for (mfxU8 & a : alpha)
+        a = (mfxU8)dist(rng);
+
+    auto compose = [&](const CpuKernels & k, mfxI32 w, bool perPixelAlpha, std::vector<mfxU8> & out)
+    {
+        std::vector<float> dst(w), src(w), a(w);
+        k.UnpackRow8(bg.data(), 1, dst.data(), w);
+        k.UnpackRow8(fg.data(), 1, src.data(), w);
+        // alpha of an RGB4 plane, every fourth byte
+        k.UnpackRow8(alpha.data() + 3, 4, a.data(), w);
+        k.BlendRow(src.data(), perPixelAlpha ? a.data() : nullptr, 1, 0.75f, dst.data(), w);
+        k.PackRow8(dst.data(), out.data(), 1, w);
+    };
+
+    for (int perPixelAlpha = 0; perPixelAlpha <= 1; perPixelAlpha++)
+    {
+        for (mfxI32 w = 0; w <= MAX_WIDTH; w++)
+        {
+            std::vector<mfxU8> ref(w), tst(w);
+            compose(c, w, !!perPixelAlpha, ref);
+            compose(simd, w, !!perPixelAlpha, tst);
+            for (mfxI32 i = 0; i < w; i++)
+                ASSERT_LE(std::abs(ref[i] - tst[i]), CODE_TOLERANCE) << "width " << w << ", x " << i;
+        }
+    }
+}
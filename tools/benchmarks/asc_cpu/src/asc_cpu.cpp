@@ -0,0 +1,160 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// CPU-path scene change detection benchmark.
+// Feeds the luma plane of an I420 file through ASC without a CmDevice (SSE4/
+// AVX2 code path only) and reports frames per second, CPU time per frame and
+// the number of detected scene changes.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "asc.h"
+
+namespace
+{
+    struct Options
+    {
+        const char* input  = nullptr;
+        mfxI32      width  = 0;
+        mfxI32      height = 0;
+        mfxU32      frames = 0;  // 0 - all frames in the file
+        mfxU32      loops  = 1;
+    };
+
+    mfxU64 GetNs(clockid_t clk)
+    {
+        timespec ts = {};
+        clock_gettime(clk, &ts);
+        return mfxU64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    void PrintUsage()
+    {
+        printf("Usage: asc_cpu -i <input.yuv> -w <width> -h <height> [options]\n");
+        printf("   -i <file>    I420 input\n");
+        printf("   -w, -h       frame size\n");
+        printf("   -n <frames>  frames to process per loop (default: whole file)\n");
+        printf("   -loop <n>    pass the input through ASC n times (default: 1)\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "-i") && i + 1 < argc)
+            opt.input = argv[++i];
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+            opt.width = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-h") && i + 1 < argc)
+            opt.height = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            opt.frames = mfxU32(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-loop") && i + 1 < argc)
+            opt.loops = mfxU32(atoi(argv[++i]));
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (!opt.input || opt.width <= 0 || opt.height <= 0 || !opt.loops)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    FILE* f = fopen(opt.input, "rb");
+    if (!f)
+    {
+        printf("Can't open %s\n", opt.input);
+        return 1;
+    }
+
+    // keep only luma, chroma isn't used by ASC
+    size_t const lumaSize  = size_t(opt.width) * opt.height;
+    size_t const frameSize = lumaSize * 3 / 2;
+    std::vector<mfxU8> frame(frameSize);
+    std::vector<mfxU8> luma;
+
+    mfxU32 nFrames = 0;
+    while ((!opt.frames || nFrames < opt.frames) && fread(frame.data(), 1, frameSize, f) == frameSize)
+    {
+        luma.insert(luma.end(), frame.begin(), frame.begin() + lumaSize);
+        ++nFrames;
+    }
+    fclose(f);
+
+    if (!nFrames)
+    {
+        printf("No complete frames in %s\n", opt.input);
+        return 1;
+    }
+
+    ns_asc::ASC asc;
+    mfxStatus sts = asc.Init(opt.width, opt.height, opt.width, MFX_PICSTRUCT_PROGRESSIVE, nullptr);
+    if (sts != MFX_ERR_NONE)
+    {
+        printf("ASC::Init failed with status %d\n", int(sts));
+        return 1;
+    }
+
+    mfxU32 sceneChanges = 0;
+
+    mfxU64 const cpu0  = GetNs(CLOCK_PROCESS_CPUTIME_ID);
+    mfxU64 const wall0 = GetNs(CLOCK_MONOTONIC);
+
+    for (mfxU32 loop = 0; loop < opt.loops; ++loop)
+    {
+        for (mfxU32 i = 0; i < nFrames; ++i)
+        {
+            sts = asc.PutFrameProgressive(&luma[lumaSize * i], opt.width);
+            if (sts != MFX_ERR_NONE)
+            {
+                printf("ASC::PutFrameProgressive failed with status %d\n", int(sts));
+                asc.Close();
+                return 1;
+            }
+            sceneChanges += asc.Get_frame_shot_Decision() ? 1 : 0;
+        }
+    }
+
+    mfxU64 const wallNs = GetNs(CLOCK_MONOTONIC) - wall0;
+    mfxU64 const cpuNs  = GetNs(CLOCK_PROCESS_CPUTIME_ID) - cpu0;
+
+    asc.Close();
+
+    mfxU64 const total = mfxU64(nFrames) * opt.loops;
+
+    printf("ASC CPU: %dx%d, %llu frames\n", opt.width, opt.height, (unsigned long long)total);
+    printf("  scene changes      : %u\n", sceneChanges);
+    printf("  fps                : %.1f\n", total * 1e9 / (wallNs ? wallNs : 1));
+    printf("  cpu us/frame       : %.2f\n", cpuNs / 1e3 / total);
+
+    return 0;
+}
@@ -0,0 +1,528 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// FEI MV predictor repacking benchmark.
+// Generates synthetic PreENC MV/statistics fields and repacks them into HEVC
+// FEI encoder MV predictors (performance and quality modes) and DecodeStreamOut
+// 8x8 MVs into AVC ENC MV layout. The scalar loops the FEI samples used before
+// are timed against the kernels from sample_common, single-threaded and split
+// by rows between threads, and outputs are checked to be bit-exact.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <functional>
+
+#include "fei_repack.h"
+
+namespace
+{
+    typedef mfxExtFeiPreEncMV::mfxExtFeiPreEncMVMB         PreEncMVMB;
+    typedef mfxExtFeiPreEncMBStat::mfxExtFeiPreEncMBStatMB PreEncMBStatMB;
+
+    const mfxU8 ZigzagOrder[16] = { 0, 1, 4, 5, 2, 3, 6, 7, 8, 9, 12, 13, 10, 11, 14, 15 };
+
+    struct Options
+    {
+        mfxU32 width     = 3840;
+        mfxU32 height    = 2160;
+        mfxU32 dsFactor  = 1;
+        mfxU32 numPreds  = 4;
+        mfxU32 frames    = 100;
+        mfxU32 threads   = 0;   // 0 - number of CPU cores
+    };
+
+    struct Frame
+    {
+        FeiHevcMvpRepackPar                   par;
+        std::vector<PreEncMVMB>               mv[4];
+        std::vector<PreEncMBStatMB>           mb[4];
+        std::vector<mfxFeiHevcEncMVPredictors> data;
+        mfxExtFeiHevcEncMVPredictors          mvp;
+    };
+
+    mfxU8 ConvertDSratioPower2(mfxU32 ratio)
+    {
+        return ratio == 8 ? 3 : ratio == 4 ? 2 : ratio == 2 ? 1 : 0;
+    }
+
+    // random MVs, every 8th one is intra
+    void FillMV(mfxI16Pair& mv, std::mt19937& rng)
+    {
+        if (rng() % 8 == 0)
+        {
+            mv.x = mv.y = -0x8000;
+            return;
+        }
+
+        mv.x = mfxI16(mfxI32(rng() % 1024) - 512);
+        mv.y = mfxI16(mfxI32(rng() % 512) - 256);
+    }
+
+    void InitFrame(Frame& frame, const Options& opt)
+    {
+        FeiHevcMvpRepackPar& par = frame.par;
+        std::mt19937 rng(1);
+
+        memset(&par, 0, sizeof(par));
+        par.DSPower2     = ConvertDSratioPower2(opt.dsFactor);
+        par.WidthCU_ds   = (MSDK_ALIGN16((MSDK_ALIGN16(opt.width) >> par.DSPower2))) >> 4;
+        par.HeightCU_ds  = (MSDK_ALIGN16((MSDK_ALIGN16(opt.height) >> par.DSPower2))) >> 4;
+        par.WidthCU_enc  = (MSDK_ALIGN32(opt.width)) >> 4;
+        par.HeightCU_enc = (MSDK_ALIGN32(opt.height)) >> 4;
+        par.NumPredPairs = mfxU8(opt.numPreds);
+        par.NumL0        = mfxU8(opt.numPreds);
+        par.NumL1        = mfxU8(opt.numPreds / 2);
+
+        for (mfxU32 j = 0; j < par.NumPredPairs; ++j)
+        {
+            frame.mv[j].resize(par.WidthCU_ds * par.HeightCU_ds);
+            frame.mb[j].resize(par.WidthCU_ds * par.HeightCU_ds);
+
+            for (PreEncMVMB& mb : frame.mv[j])
+                for (mfxU32 k = 0; k < 16; ++k)
+                {
+                    FillMV(mb.MV[k][0], rng);
+                    FillMV(mb.MV[k][1], rng);
+                }
+
+            for (PreEncMBStatMB& mb : frame.mb[j])
+            {
+                memset(&mb, 0, sizeof(mb));
+                mb.Inter[0].BestDistortion = mfxU16(rng() % 4096);
+                mb.Inter[1].BestDistortion = mfxU16(rng() % 4096);
+            }
+
+            par.MV[j]    = frame.mv[j].data();
+            par.MB[j]    = frame.mb[j].data();
+            par.RefL0[j] = mfxU8(j);
+            par.RefL1[j] = mfxU8(j < par.NumL1 ? j : 0xf);
+        }
+
+        memset(&frame.mvp, 0, sizeof(frame.mvp));
+        frame.mvp.Pitch  = par.WidthCU_enc + 2;
+        frame.mvp.Height = par.HeightCU_enc;
+        frame.data.resize(frame.mvp.Pitch * frame.mvp.Height);
+        frame.mvp.Data   = frame.data.data();
+    }
+
+    void Scramble(Frame& frame)
+    {
+        memset(frame.data.data(), 0xa5, frame.data.size() * sizeof(mfxFeiHevcEncMVPredictors));
+    }
+
+    void DisableAll(mfxExtFeiHevcEncMVPredictors& mvp)
+    {
+        FeiHevcDisableMVP(mvp, 0, mvp.Pitch * mvp.Height);
+    }
+
+    mfxU32 PermutEncIdx(const FeiHevcMvpRepackPar& par, mfxU32 rowIdx, mfxU32 colIdx)
+    {
+        return ((colIdx >> 1) << 2) + (rowIdx & ~1) * par.WidthCU_enc + (colIdx & 1) + ((rowIdx & 1) << 1);
+    }
+
+    mfxU32 PreEncCUIdx(const FeiHevcMvpRepackPar& par, mfxU32 rowIdx, mfxU32 colIdx)
+    {
+        return (rowIdx >> par.DSPower2) * par.WidthCU_ds + (colIdx >> par.DSPower2);
+    }
+
+    mfxU32 PreEncMVIdx(mfxU8 ds, mfxU32 rowIdx, mfxU32 colIdx)
+    {
+        switch (ds)
+        {
+        case 1:  return (rowIdx & 1) * 8 + (colIdx & 1) * 2;
+        case 2:  return (rowIdx & 3) * 4 + (colIdx & 3);
+        case 3:  return (rowIdx & 7) / 2 * 4 + (colIdx & 7) / 2;
+        default: return 0;
+        }
+    }
+
+    void ShiftMV(mfxI16Pair& mv, mfxU8 ds)
+    {
+        mv.x = mfxI16(mfxU16(mv.x) << ds);
+        mv.y = mfxI16(mfxU16(mv.y) << ds);
+    }
+
+    // PredictorsRepaking::RepackPredictorsPerformance() loops as they were in sample_hevc_fei
+    void RefPerformance(const FeiHevcMvpRepackPar& par, mfxExtFeiHevcEncMVPredictors& mvp)
+    {
+        const mfxI16Pair zeroPair = { 0, 0 };
+
+        DisableAll(mvp);
+
+        for (mfxU32 rowIdx = 0; rowIdx < par.HeightCU_enc; ++rowIdx)
+        {
+            for (mfxU32 colIdx = 0; colIdx < par.WidthCU_enc; ++colIdx)
+            {
+                mfxFeiHevcEncMVPredictors& block = mvp.Data[PermutEncIdx(par, rowIdx, colIdx)];
+                block.BlockSize = 1;
+
+                mfxU32 linearPreEncIdx = rowIdx * par.WidthCU_ds + colIdx;
+                for (mfxU32 j = 0; j < par.NumPredPairs; ++j)
+                {
+                    block.RefIdx[j].RefL0 = par.RefL0[j];
+                    block.RefIdx[j].RefL1 = par.RefL1[j];
+
+                    if (par.DSPower2 == 0)
+                    {
+                        if (colIdx >= par.WidthCU_ds || rowIdx >= par.HeightCU_ds)
+                        {
+                            block.MV[j][0] = zeroPair;
+                            block.MV[j][1] = zeroPair;
+                        }
+                        else
+                        {
+                            block.MV[j][0] = par.MV[j][linearPreEncIdx].MV[0][0];
+                            block.MV[j][1] = par.MV[j][linearPreEncIdx].MV[0][1];
+                        }
+                    }
+                    else
+                    {
+                        mfxU32 preencCUIdx = PreEncCUIdx(par, rowIdx, colIdx);
+                        mfxU32 preencMVIdx = ZigzagOrder[PreEncMVIdx(par.DSPower2, rowIdx, colIdx)];
+
+                        block.MV[j][0] = par.MV[j][preencCUIdx].MV[preencMVIdx][0];
+                        block.MV[j][1] = par.MV[j][preencCUIdx].MV[preencMVIdx][1];
+
+                        ShiftMV(block.MV[j][0], par.DSPower2);
+                        ShiftMV(block.MV[j][1], par.DSPower2);
+                    }
+                }
+
+                if (par.Ldb)
+                {
+                    block.RefIdx[0].RefL1 = block.RefIdx[0].RefL0;
+                    block.MV[0][1] = block.MV[0][0];
+                }
+            }
+        }
+    }
+
+    void RefSelectFromMV(const mfxI16Pair(*mv)[2], mfxI32 count, mfxI16Pair(&res)[2])
+    {
+        for (int ref = 0; ref < 2; ref++)
+        {
+            mfxI32 found = 0, xsum = 0, ysum = 0;
+            for (int i = 0; i < count; i++)
+            {
+                if (mv[i][ref].x == -0x8000)
+                    continue;
+                found++;
+                xsum += mv[i][ref].x;
+                ysum += mv[i][ref].y;
+            }
+            if (!found)
+                res[ref] = mv[0][ref];
+            else
+            {
+                res[ref].x = mfxI16(xsum / found);
+                res[ref].y = mfxI16(ysum / found);
+            }
+        }
+    }
+
+    // PredictorsRepaking::RepackPredictorsQuality() loops as they were in sample_hevc_fei,
+    // distortion of blocks out of PreENC frame is set to max instead of being left uninitialized
+    void RefQuality(const FeiHevcMvpRepackPar& par, mfxExtFeiHevcEncMVPredictors& mvp)
+    {
+        const mfxI16Pair zeroPair = { 0, 0 };
+
+        DisableAll(mvp);
+
+        for (mfxU32 rowIdx = 0; rowIdx < par.HeightCU_enc; ++rowIdx)
+        {
+            for (mfxU32 colIdx = 0; colIdx < par.WidthCU_enc; ++colIdx)
+            {
+                mfxU8 ref[4][2];
+                mfxI16Pair mv[4][2];
+                mfxU16 distortion[4][2];
+
+                mfxFeiHevcEncMVPredictors& block = mvp.Data[PermutEncIdx(par, rowIdx, colIdx)];
+                block.BlockSize = 1;
+
+                mfxU32 linearPreEncIdx = rowIdx * par.WidthCU_ds + colIdx;
+                for (mfxU32 j = 0; j < par.NumPredPairs; ++j)
+                {
+                    ref[j][0] = par.RefL0[j];
+                    ref[j][1] = par.RefL1[j];
+
+                    if (par.DSPower2 == 0)
+                    {
+                        if (colIdx >= par.WidthCU_ds || rowIdx >= par.HeightCU_ds)
+                        {
+                            mv[j][0] = zeroPair;
+                            mv[j][1] = zeroPair;
+                            distortion[j][0] = distortion[j][1] = 0xffff;
+                        }
+                        else
+                        {
+                            RefSelectFromMV(&par.MV[j][linearPreEncIdx].MV[0], 16, mv[j]);
+                            distortion[j][0] = par.MB[j][linearPreEncIdx].Inter[0].BestDistortion;
+                            distortion[j][1] = par.MB[j][linearPreEncIdx].Inter[1].BestDistortion;
+                        }
+                    }
+                    else
+                    {
+                        mfxU32 preencCUIdx = PreEncCUIdx(par, rowIdx, colIdx);
+
+                        if (par.DSPower2 == 1)
+                        {
+                            mfxU32 preencMVIdx = (rowIdx & 1) * 8 + (colIdx & 1) * 4;
+                            RefSelectFromMV(&par.MV[j][preencCUIdx].MV[preencMVIdx], 4, mv[j]);
+                        }
+                        else
+                        {
+                            mfxU32 preencMVIdx = ZigzagOrder[PreEncMVIdx(par.DSPower2, rowIdx, colIdx)];
+                            mv[j][0] = par.MV[j][preencCUIdx].MV[preencMVIdx][0];
+                            mv[j][1] = par.MV[j][preencCUIdx].MV[preencMVIdx][1];
+                        }
+
+                        ShiftMV(mv[j][0], par.DSPower2);
+                        ShiftMV(mv[j][1], par.DSPower2);
+
+                        distortion[j][0] = (j < par.NumL0) ? par.MB[j][preencCUIdx].Inter[0].BestDistortion : 0xffff;
+                        distortion[j][1] = (j < par.NumL1) ? par.MB[j][preencCUIdx].Inter[1].BestDistortion : 0xffff;
+                    }
+                }
+
+                if (par.NumPredPairs < 2)
+                {
+                    block.MV[0][0] = mv[0][0];
+                    block.MV[0][1] = mv[0][1];
+                    block.RefIdx[0].RefL0 = ref[0][0];
+                    block.RefIdx[0].RefL1 = ref[0][1];
+                    continue;
+                }
+
+                for (mfxU32 j = par.NumPredPairs; j < 4; ++j)
+                {
+                    distortion[j][1] = distortion[j][0] = 0xffff;
+                    ref[j][1] = ref[j][0] = 0xff;
+                    mv[j][0].y = mv[j][0].x = -0x8000;
+                    mv[j][1].y = mv[j][1].x = -0x8000;
+                }
+
+                // position in sorted array is number of predictors with smaller distortion
+                mfxU8 worse[4][2] = { {0,} };
+                for (mfxU32 k = 0; k < 4; ++k)
+                    for (mfxU32 l = k + 1; l < 4; ++l)
+                        for (mfxU32 list = 0; list < 2; ++list)
+                        {
+                            mfxU8 res = distortion[k][list] > distortion[l][list];
+                            worse[k][list] += res;
+                            worse[l][list] += res ^ 1;
+                        }
+
+                for (mfxU32 j = 0; j < 4; j++)
+                {
+                    block.MV[worse[j][0]][0] = mv[j][0];
+                    block.MV[worse[j][1]][1] = mv[j][1];
+                    block.RefIdx[worse[j][0]].RefL0 = ref[j][0];
+                    block.RefIdx[worse[j][1]].RefL1 = ref[j][1];
+                }
+            }
+        }
+    }
+
+    typedef void (*HevcKernel)(const FeiHevcMvpRepackPar&, mfxExtFeiHevcEncMVPredictors&, mfxU32, mfxU32);
+
+    void RunKernel(HevcKernel kernel, const FeiHevcMvpRepackPar& par, mfxExtFeiHevcEncMVPredictors& mvp, RowParallel& workers)
+    {
+        // kernels fill whole WidthCU_enc x HeightCU_enc area, only the rest of the buffer is reset
+        FeiHevcDisableMVP(mvp, par.WidthCU_enc * par.HeightCU_enc, mvp.Pitch * mvp.Height);
+        workers.Run(par.HeightCU_enc, 2, [&](mfxU32 begin, mfxU32 end) { kernel(par, mvp, begin, end); });
+    }
+
+    double TimeUs(mfxU32 frames, const std::function<void()>& fn)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (mfxU32 i = 0; i < frames; ++i)
+            fn();
+        std::chrono::duration<double, std::micro> total = std::chrono::steady_clock::now() - start;
+        return total.count() / frames;
+    }
+
+    bool Compare(const mfxExtFeiHevcEncMVPredictors& ref, const mfxExtFeiHevcEncMVPredictors& tst, const char* name)
+    {
+        if (memcmp(ref.Data, tst.Data, ref.Pitch * ref.Height * sizeof(mfxFeiHevcEncMVPredictors)))
+        {
+            printf("%s: output mismatch\n", name);
+            return false;
+        }
+        return true;
+    }
+
+    bool BenchHevc(const Options& opt, RowParallel& workers, bool quality)
+    {
+        Frame ref, tst;
+        InitFrame(ref, opt);
+        InitFrame(tst, opt);
+
+        HevcKernel kernel = quality ? FeiHevcRepackMVPQuality : FeiHevcRepackMVPPerformance;
+        void (*reference)(const FeiHevcMvpRepackPar&, mfxExtFeiHevcEncMVPredictors&) = quality ? RefQuality : RefPerformance;
+        const char* name = quality ? "HEVC quality" : "HEVC performance";
+        RowParallel serial(1);
+
+        // both GPB (Ldb) and regular P/B frames for performance mode
+        for (int ldb = 0; ldb <= (quality ? 0 : 1); ++ldb)
+        {
+            ref.par.Ldb = tst.par.Ldb = !!ldb;
+
+            // stale data of previous frame, fields not written by repacking should keep it
+            Scramble(ref);
+            reference(ref.par, ref.mvp);
+
+            Scramble(tst);
+            RunKernel(kernel, tst.par, tst.mvp, serial);
+            if (!Compare(ref.mvp, tst.mvp, name))
+                return false;
+
+            Scramble(tst);
+            RunKernel(kernel, tst.par, tst.mvp, workers);
+            if (!Compare(ref.mvp, tst.mvp, name))
+                return false;
+        }
+
+        ref.par.Ldb = tst.par.Ldb = false;
+
+        double refUs    = TimeUs(opt.frames, [&] { reference(ref.par, ref.mvp); });
+        double serialUs = TimeUs(opt.frames, [&] { RunKernel(kernel, tst.par, tst.mvp, serial); });
+        double rowsUs   = TimeUs(opt.frames, [&] { RunKernel(kernel, tst.par, tst.mvp, workers); });
+
+        printf("%s:\n", name);
+        printf("  scalar us/frame         : %.1f\n", refUs);
+        printf("  kernel us/frame         : %.1f (x%.2f)\n", serialUs, refUs / serialUs);
+        printf("  kernel %2u thr us/frame  : %.1f (x%.2f)\n", workers.GetNumThreads(), rowsUs, refUs / rowsUs);
+
+        return true;
+    }
+
+    // FEI_EncPakInterface::PakOneStreamoutFrame() MV broadcast for AVC
+    bool BenchAvc(const Options& opt, RowParallel& workers)
+    {
+        mfxU32 widthMB  = MSDK_ALIGN16(opt.width) >> 4;
+        mfxU32 heightMB = MSDK_ALIGN16(opt.height) >> 4;
+        std::mt19937 rng(1);
+
+        std::vector<mfxFeiDecStreamOutMBCtrl>        dso(widthMB * heightMB);
+        std::vector<mfxExtFeiEncMV::mfxExtFeiEncMVMB> ref(dso.size()), tst(dso.size());
+
+        for (mfxFeiDecStreamOutMBCtrl& mb : dso)
+            for (mfxU32 k = 0; k < 4; ++k)
+            {
+                FillMV(mb.MV[k][0], rng);
+                FillMV(mb.MV[k][1], rng);
+            }
+
+        auto reference = [&]
+        {
+            for (size_t i = 0; i < dso.size(); ++i)
+                for (int k = 0; k < 16; k++)
+                {
+                    ref[i].MV[k][0] = dso[i].MV[k >> 2][0];
+                    ref[i].MV[k][1] = dso[i].MV[k >> 2][1];
+                }
+        };
+        auto rows = [&](mfxU32 begin, mfxU32 end)
+        {
+            for (mfxU32 i = begin * widthMB; i < end * widthMB; ++i)
+                FeiBroadcastMV8x8(dso[i].MV, tst[i].MV);
+        };
+
+        reference();
+        workers.Run(heightMB, 1, rows);
+        if (memcmp(ref.data(), tst.data(), ref.size() * sizeof(ref[0])))
+        {
+            printf("AVC StreamOut MV: output mismatch\n");
+            return false;
+        }
+
+        double refUs    = TimeUs(opt.frames, reference);
+        double serialUs = TimeUs(opt.frames, [&] { rows(0, heightMB); });
+        double rowsUs   = TimeUs(opt.frames, [&] { workers.Run(heightMB, 1, rows); });
+
+        printf("AVC StreamOut MV:\n");
+        printf("  scalar us/frame         : %.1f\n", refUs);
+        printf("  kernel us/frame         : %.1f (x%.2f)\n", serialUs, refUs / serialUs);
+        printf("  kernel %2u thr us/frame  : %.1f (x%.2f)\n", workers.GetNumThreads(), rowsUs, refUs / rowsUs);
+
+        return true;
+    }
+
+    void PrintUsage()
+    {
+        printf("Usage: fei_repack [options]\n");
+        printf("   -w, -h       frame size (default: 3840x2160)\n");
+        printf("   -ds <n>      PreENC downsampling factor 1, 2, 4 or 8 (default: 1)\n");
+        printf("   -preds <n>   number of MV predictors 1..4 (default: 4)\n");
+        printf("   -n <frames>  frames to repack per measurement (default: 100)\n");
+        printf("   -t <n>       threads for row-parallel repacking (default: number of CPUs)\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "-w") && i + 1 < argc)
+            opt.width = mfxU32(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-h") && i + 1 < argc)
+            opt.height = mfxU32(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-ds") && i + 1 < argc)
+            opt.dsFactor = mfxU32(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-preds") && i + 1 < argc)
+            opt.numPreds = mfxU32(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            opt.frames = mfxU32(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            opt.threads = mfxU32(atoi(argv[++i]));
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    bool dsValid = opt.dsFactor == 1 || opt.dsFactor == 2 || opt.dsFactor == 4 || opt.dsFactor == 8;
+    if (!opt.width || !opt.height || !dsValid || !opt.numPreds || opt.numPreds > 4 || !opt.frames)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (!opt.threads)
+        opt.threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    RowParallel workers(opt.threads);
+
+    printf("FEI repacking: %ux%u, ds %ux, %u predictors, %u frames\n", opt.width, opt.height, opt.dsFactor, opt.numPreds, opt.frames);
+
+    if (!BenchHevc(opt, workers, false) || !BenchHevc(opt, workers, true) || !BenchAvc(opt, workers))
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,730 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Host-side overhead benchmark for the encode, decode and DecodeHeader paths.
+// Runs the hardware runtime on top of libva_null (instant, CPU-only VA backend)
+// and reports CPU time per frame spent in the application thread submitting
+// and synchronizing tasks, in runtime worker threads and in the VA backend
+// itself, so host hot spots can be measured and tracked without a GPU.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "mfxvideo++.h"
+#include "mfxjpeg.h"
+#include "mfxvp8.h"
+
+#include <va/va.h>
+#include <va/va_drm.h>
+
+#include "va_null.h"
+
+#define BENCH_CHECK_STS(sts, msg)                                 \
+    if ((sts) < MFX_ERR_NONE)                                     \
+    {                                                             \
+        printf("%s failed with status %d\n", (msg), int(sts));    \
+        return (sts);                                             \
+    }
+
+namespace
+{
+    enum eMode
+    {
+        MODE_ENCODE,
+        MODE_DECODE,
+        MODE_HEADER
+    };
+
+    struct Options
+    {
+        eMode       mode     = MODE_ENCODE;
+        mfxU32      codecId  = MFX_CODEC_AVC;
+        const char* input    = nullptr;
+        mfxU16      width    = 1920;
+        mfxU16      height   = 1080;
+        mfxU32      frames   = 300;
+        mfxU16      async    = 4;
+        mfxU16      lowPower = MFX_CODINGOPTION_OFF;
+        bool        loop     = false;
+        bool        zeroCopy = false;
+    };
+
+    struct Timings
+    {
+        mfxU64 submitNs   = 0; // app thread CPU in Encode/DecodeFrameAsync
+        mfxU64 syncNs     = 0; // app thread CPU in SyncOperation
+        mfxU64 appNs      = 0; // app thread CPU in the whole loop
+        mfxU64 processNs  = 0; // all threads
+        mfxU64 wallNs     = 0;
+        mfxU64 bytes      = 0;
+        mfxU32 frames     = 0;
+        mfxU32 referenced = 0; // frames returned as coded buffer references
+    };
+
+    mfxU64 ToNs(timespec const& ts)
+    {
+        return mfxU64(ts.tv_sec) * 1000000000ull + mfxU64(ts.tv_nsec);
+    }
+
+    mfxU64 ThreadCpuNs()
+    {
+        timespec ts = {};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ToNs(ts);
+    }
+
+    mfxU64 ProcessCpuNs()
+    {
+        timespec ts = {};
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ToNs(ts);
+    }
+
+    mfxU64 WallNs()
+    {
+        timespec ts = {};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ToNs(ts);
+    }
+
+    mfxStatus ReadInput(const char* name, std::vector<mfxU8>& input)
+    {
+        FILE* f = fopen(name, "rb");
+        if (!f)
+        {
+            printf("can't open %s\n", name);
+            return MFX_ERR_NULL_PTR;
+        }
+
+        mfxU8 chunk[1 << 16];
+        for (size_t n; (n = fread(chunk, 1, sizeof(chunk), f)) > 0; )
+            input.insert(input.end(), chunk, chunk + n);
+        fclose(f);
+
+        // IVF: keep the first frame, decoders take VP8/VP9/AV1 frames without container
+        if (input.size() > 44 && !memcmp(input.data(), "DKIF", 4))
+        {
+            mfxU32 hdrSize   = input[6] | (input[7] << 8);
+            mfxU32 frameSize = input[hdrSize] | (input[hdrSize + 1] << 8) | (input[hdrSize + 2] << 16) | (mfxU32(input[hdrSize + 3]) << 24);
+            mfxU32 begin     = hdrSize + 12;
+
+            if (begin + frameSize > input.size())
+            {
+                printf("broken IVF file %s\n", name);
+                return MFX_ERR_UNDEFINED_BEHAVIOR;
+            }
+            input = std::vector<mfxU8>(input.begin() + begin, input.begin() + begin + frameSize);
+        }
+
+        return input.empty() ? MFX_ERR_MORE_DATA : MFX_ERR_NONE;
+    }
+
+    // Adds thread CPU time of the scope to the counter
+    class CpuScope
+    {
+    public:
+        CpuScope(mfxU64& counter)
+            : m_counter(counter)
+            , m_start(ThreadCpuNs())
+        {}
+        ~CpuScope()
+        {
+            m_counter += ThreadCpuNs() - m_start;
+        }
+    private:
+        mfxU64& m_counter;
+        mfxU64  m_start;
+    };
+
+    struct Task
+    {
+        std::vector<mfxU8> data;
+        mfxBitstream       bs    = {};
+        mfxSyncPoint       syncp = nullptr;
+        mfxExtCodedBufferRef ref = {};
+        mfxExtBuffer*      ext   = nullptr;
+    };
+
+    class SurfacePool
+    {
+    public:
+        void Alloc(mfxFrameInfo const& info, mfxU16 count)
+        {
+            mfxU32 pitch = (info.FourCC == MFX_FOURCC_P010 ? 2 : 1) * info.Width;
+            mfxU32 lumaSize = pitch * info.Height;
+
+            m_data.resize(count);
+            m_surfaces.resize(count);
+
+            for (mfxU16 i = 0; i < count; ++i)
+            {
+                // synthetic content: gradient luma, flat chroma
+                m_data[i].resize(lumaSize * 3 / 2);
+                for (mfxU32 y = 0; y < info.Height; ++y)
+                    for (mfxU32 x = 0; x < pitch; ++x)
+                        m_data[i][y * pitch + x] = mfxU8(x + y + i);
+                std::fill(m_data[i].begin() + lumaSize, m_data[i].end(), mfxU8(128));
+
+                mfxFrameSurface1& surface = m_surfaces[i];
+                surface = mfxFrameSurface1();
+                surface.Info = info;
+                surface.Data.Y     = m_data[i].data();
+                surface.Data.UV    = surface.Data.Y + lumaSize;
+                surface.Data.Pitch = mfxU16(pitch);
+            }
+        }
+
+        mfxFrameSurface1* GetFree()
+        {
+            auto it = std::find_if(m_surfaces.begin(), m_surfaces.end(),
+                [](mfxFrameSurface1 const& s) { return !s.Data.Locked; });
+            return it == m_surfaces.end() ? nullptr : &*it;
+        }
+
+    private:
+        std::vector<std::vector<mfxU8>> m_data;
+        std::vector<mfxFrameSurface1>   m_surfaces;
+    };
+
+    class TaskRing
+    {
+    public:
+        TaskRing(MFXVideoSession& session, Timings& timings, mfxU16 size, mfxU32 bsSize, bool zeroCopy = false)
+            : m_session(session)
+            , m_timings(timings)
+            , m_tasks(std::max<mfxU16>(size, 1))
+        {
+            for (Task& task : m_tasks)
+            {
+                task.data.resize(bsSize);
+                task.bs.Data      = task.data.data();
+                task.bs.MaxLength = bsSize;
+
+                if (zeroCopy)
+                {
+                    task.ref.Header.BufferId = MFX_EXTBUFF_CODED_BUFFER_REF;
+                    task.ref.Header.BufferSz = sizeof(task.ref);
+                    task.ext                 = &task.ref.Header;
+                    task.bs.ExtParam         = &task.ext;
+                    task.bs.NumExtParam      = 1;
+                }
+            }
+        }
+
+        Task& Current() { return m_tasks[m_cur]; }
+
+        void Next()
+        {
+            if (m_tasks[m_cur].syncp)
+                m_cur = (m_cur + 1) % m_tasks.size();
+        }
+
+        mfxStatus Sync(Task& task)
+        {
+            if (!task.syncp)
+                return MFX_ERR_NONE;
+
+            mfxStatus sts;
+            {
+                CpuScope scope(m_timings.syncNs);
+                sts = m_session.SyncOperation(task.syncp, MFX_INFINITE);
+            }
+            BENCH_CHECK_STS(sts, "SyncOperation");
+
+            m_timings.frames++;
+            m_timings.bytes += task.bs.DataLength;
+
+            if (task.ref.Referenced == MFX_CODINGOPTION_ON)
+            {
+                m_timings.referenced++;
+                sts = task.ref.Release(task.ref.pthis, &task.bs);
+                BENCH_CHECK_STS(sts, "mfxExtCodedBufferRef::Release");
+            }
+
+            task.syncp = nullptr;
+            task.bs.DataOffset = task.bs.DataLength = 0;
+            return MFX_ERR_NONE;
+        }
+
+        mfxStatus SyncAll()
+        {
+            for (size_t i = 0; i < m_tasks.size(); ++i)
+            {
+                mfxStatus sts = Sync(m_tasks[(m_cur + i) % m_tasks.size()]);
+                BENCH_CHECK_STS(sts, "SyncAll");
+            }
+            return MFX_ERR_NONE;
+        }
+
+    private:
+        MFXVideoSession&  m_session;
+        Timings&          m_timings;
+        std::vector<Task> m_tasks;
+        size_t            m_cur = 0;
+    };
+
+    mfxStatus RunEncode(MFXVideoSession& session, Options const& opt, Timings& t)
+    {
+        mfxVideoParam par = {};
+        par.mfx.CodecId                 = opt.codecId;
+        if (opt.codecId == MFX_CODEC_JPEG)
+        {
+            par.mfx.Interleaved         = 1;
+            par.mfx.Quality             = 75;
+        }
+        else
+        {
+            par.mfx.TargetUsage         = MFX_TARGETUSAGE_BALANCED;
+            par.mfx.RateControlMethod   = MFX_RATECONTROL_CQP;
+            par.mfx.QPI = par.mfx.QPP = par.mfx.QPB = 26;
+            par.mfx.GopPicSize          = 30;
+            par.mfx.LowPower            = opt.lowPower;
+        }
+        par.mfx.FrameInfo.FourCC        = MFX_FOURCC_NV12;
+        par.mfx.FrameInfo.ChromaFormat  = MFX_CHROMAFORMAT_YUV420;
+        par.mfx.FrameInfo.PicStruct     = MFX_PICSTRUCT_PROGRESSIVE;
+        par.mfx.FrameInfo.Width         = mfxU16((opt.width + 31) & ~31);
+        par.mfx.FrameInfo.Height        = mfxU16((opt.height + 31) & ~31);
+        par.mfx.FrameInfo.CropW         = opt.width;
+        par.mfx.FrameInfo.CropH         = opt.height;
+        par.mfx.FrameInfo.FrameRateExtN = 30;
+        par.mfx.FrameInfo.FrameRateExtD = 1;
+        par.IOPattern                   = MFX_IOPATTERN_IN_SYSTEM_MEMORY;
+        par.AsyncDepth                  = opt.async;
+
+        mfxExtCodedBufferRef codedRef = {};
+        mfxExtBuffer* ext = &codedRef.Header;
+        if (opt.zeroCopy)
+        {
+            codedRef.Header.BufferId = MFX_EXTBUFF_CODED_BUFFER_REF;
+            codedRef.Header.BufferSz = sizeof(codedRef);
+            codedRef.NumHeldBuffers  = opt.async;
+            par.ExtParam             = &ext;
+            par.NumExtParam          = 1;
+        }
+
+        MFXVideoENCODE encode(session);
+
+        mfxStatus sts = encode.Query(&par, &par);
+        BENCH_CHECK_STS(sts, "ENCODE::Query");
+
+        mfxFrameAllocRequest request = {};
+        sts = encode.QueryIOSurf(&par, &request);
+        BENCH_CHECK_STS(sts, "ENCODE::QueryIOSurf");
+
+        sts = encode.Init(&par);
+        BENCH_CHECK_STS(sts, "ENCODE::Init");
+
+        mfxVideoParam actual = {};
+        sts = encode.GetVideoParam(&actual);
+        BENCH_CHECK_STS(sts, "ENCODE::GetVideoParam");
+
+        SurfacePool surfaces;
+        surfaces.Alloc(par.mfx.FrameInfo, mfxU16(request.NumFrameSuggested + opt.async));
+
+        mfxU32 bsSize = actual.mfx.BufferSizeInKB * 1000 * std::max<mfxU16>(actual.mfx.BRCParamMultiplier, 1);
+        TaskRing tasks(session, t, opt.async, bsSize, opt.zeroCopy);
+
+        mfxU64 appStart = ThreadCpuNs();
+        mfxU64 processStart = ProcessCpuNs();
+        mfxU64 wallStart = WallNs();
+
+        for (mfxU32 submitted = 0; ; )
+        {
+            bool drain = submitted == opt.frames;
+            mfxFrameSurface1* surface = nullptr;
+
+            if (!drain)
+            {
+                surface = surfaces.GetFree();
+                if (!surface)
+                {
+                    sts = tasks.SyncAll();
+                    BENCH_CHECK_STS(sts, "SyncAll");
+                    surface = surfaces.GetFree();
+                }
+                if (!surface)
+                {
+                    printf("no free surfaces\n");
+                    return MFX_ERR_NOT_ENOUGH_BUFFER;
+                }
+            }
+
+            Task& task = tasks.Current();
+            sts = tasks.Sync(task);
+            BENCH_CHECK_STS(sts, "Sync");
+
+            for (;;)
+            {
+                {
+                    CpuScope scope(t.submitNs);
+                    sts = encode.EncodeFrameAsync(nullptr, surface, &task.bs, &task.syncp);
+                }
+                if (sts != MFX_WRN_DEVICE_BUSY)
+                    break;
+                std::this_thread::yield();
+            }
+
+            if (sts == MFX_ERR_MORE_DATA)
+            {
+                if (drain)
+                    break;
+                submitted++;
+                continue;
+            }
+            BENCH_CHECK_STS(sts, "ENCODE::EncodeFrameAsync");
+
+            if (!drain)
+                submitted++;
+            tasks.Next();
+        }
+
+        sts = tasks.SyncAll();
+        BENCH_CHECK_STS(sts, "SyncAll");
+
+        t.appNs     = ThreadCpuNs() - appStart;
+        t.processNs = ProcessCpuNs() - processStart;
+        t.wallNs    = WallNs() - wallStart;
+
+        return encode.Close();
+    }
+
+    mfxStatus RunDecode(MFXVideoSession& session, Options const& opt, Timings& t)
+    {
+        std::vector<mfxU8> input;
+        mfxStatus sts = ReadInput(opt.input, input);
+        BENCH_CHECK_STS(sts, "ReadInput");
+
+        // with -loop the stream is appended again once the decoder has consumed it
+        std::vector<mfxU8> data(input.begin(), input.end());
+        data.reserve(input.size() * 2);
+
+        mfxBitstream bs = {};
+        bs.Data       = data.data();
+        bs.DataLength = mfxU32(data.size());
+        bs.MaxLength  = mfxU32(data.capacity());
+
+        mfxVideoParam par = {};
+        par.mfx.CodecId = opt.codecId;
+        par.IOPattern   = MFX_IOPATTERN_OUT_SYSTEM_MEMORY;
+        par.AsyncDepth  = opt.async;
+
+        MFXVideoDECODE decode(session);
+
+        sts = decode.DecodeHeader(&bs, &par);
+        BENCH_CHECK_STS(sts, "DECODE::DecodeHeader");
+
+        mfxFrameAllocRequest request = {};
+        sts = decode.QueryIOSurf(&par, &request);
+        BENCH_CHECK_STS(sts, "DECODE::QueryIOSurf");
+
+        sts = decode.Init(&par);
+        BENCH_CHECK_STS(sts, "DECODE::Init");
+
+        SurfacePool surfaces;
+        surfaces.Alloc(par.mfx.FrameInfo, mfxU16(request.NumFrameSuggested + opt.async));
+
+        TaskRing tasks(session, t, opt.async, 0);
+
+        mfxU64 appStart = ThreadCpuNs();
+        mfxU64 processStart = ProcessCpuNs();
+        mfxU64 wallStart = WallNs();
+
+        bool eos = false;
+
+        for (mfxU32 outputs = 0; outputs < opt.frames; )
+        {
+            mfxFrameSurface1* surface = surfaces.GetFree();
+            if (!surface)
+            {
+                sts = tasks.SyncAll();
+                BENCH_CHECK_STS(sts, "SyncAll");
+                surface = surfaces.GetFree();
+            }
+            if (!surface)
+            {
+                printf("no free surfaces\n");
+                return MFX_ERR_NOT_ENOUGH_BUFFER;
+            }
+
+            Task& task = tasks.Current();
+            sts = tasks.Sync(task);
+            BENCH_CHECK_STS(sts, "Sync");
+
+            mfxFrameSurface1* out = nullptr;
+
+            for (;;)
+            {
+                {
+                    CpuScope scope(t.submitNs);
+                    sts = decode.DecodeFrameAsync(eos ? nullptr : &bs, surface, &out, &task.syncp);
+                }
+                if (sts != MFX_WRN_DEVICE_BUSY)
+                    break;
+                std::this_thread::yield();
+            }
+
+            if (sts == MFX_ERR_MORE_SURFACE || sts == MFX_WRN_VIDEO_PARAM_CHANGED)
+                continue;
+
+            if (sts == MFX_ERR_MORE_DATA)
+            {
+                if (eos)
+                    break;
+
+                if (opt.loop)
+                {
+                    std::copy(data.begin() + bs.DataOffset, data.begin() + bs.DataOffset + bs.DataLength, data.begin());
+                    data.resize(bs.DataLength);
+                    data.insert(data.end(), input.begin(), input.end());
+
+                    bs.Data       = data.data();
+                    bs.DataOffset = 0;
+                    bs.DataLength = mfxU32(data.size());
+                    bs.MaxLength  = mfxU32(data.capacity());
+                    continue;
+                }
+
+                eos = true;
+                continue;
+            }
+            BENCH_CHECK_STS(sts, "DECODE::DecodeFrameAsync");
+
+            if (task.syncp)
+                outputs++;
+            tasks.Next();
+        }
+
+        sts = tasks.SyncAll();
+        BENCH_CHECK_STS(sts, "SyncAll");
+
+        t.appNs     = ThreadCpuNs() - appStart;
+        t.processNs = ProcessCpuNs() - processStart;
+        t.wallNs    = WallNs() - wallStart;
+
+        return decode.Close();
+    }
+
+    mfxStatus RunHeader(MFXVideoSession& session, Options const& opt, Timings& t)
+    {
+        std::vector<mfxU8> input;
+        mfxStatus sts = ReadInput(opt.input, input);
+        BENCH_CHECK_STS(sts, "ReadInput");
+
+        MFXVideoDECODE decode(session);
+
+        mfxU64 appStart = ThreadCpuNs();
+        mfxU64 processStart = ProcessCpuNs();
+        mfxU64 wallStart = WallNs();
+
+        for (mfxU32 i = 0; i < opt.frames; ++i)
+        {
+            mfxBitstream bs = {};
+            bs.Data       = input.data();
+            bs.DataLength = mfxU32(input.size());
+            bs.MaxLength  = mfxU32(input.size());
+
+            mfxVideoParam par = {};
+            par.mfx.CodecId = opt.codecId;
+
+            {
+                CpuScope scope(t.submitNs);
+                sts = decode.DecodeHeader(&bs, &par);
+            }
+            BENCH_CHECK_STS(sts, "DECODE::DecodeHeader");
+
+            t.frames++;
+        }
+
+        t.appNs     = ThreadCpuNs() - appStart;
+        t.processNs = ProcessCpuNs() - processStart;
+        t.wallNs    = WallNs() - wallStart;
+
+        return MFX_ERR_NONE;
+    }
+
+    struct Codec
+    {
+        const char* name;
+        mfxU32      codecId;
+    };
+
+    const Codec g_codecs[] =
+    {
+        { "h264",  MFX_CODEC_AVC   },
+        { "h265",  MFX_CODEC_HEVC  },
+        { "mpeg2", MFX_CODEC_MPEG2 },
+        { "vp8",   MFX_CODEC_VP8   },
+        { "vp9",   MFX_CODEC_VP9   },
+#if (MFX_VERSION >= 1034)
+        { "av1",   MFX_CODEC_AV1   },
+#endif
+        { "jpeg",  MFX_CODEC_JPEG  },
+    };
+
+    void PrintUsage()
+    {
+        printf("Usage: host_overhead enc|dec|hdr <codec> [options]\n");
+        printf("  enc            encode synthetic NV12 frames (h264, h265, mpeg2, jpeg)\n");
+        printf("  dec            decode input stream\n");
+        printf("  hdr            call DecodeHeader on input stream -n times\n");
+        printf("  codec          h264|h265|mpeg2|vp8|vp9|av1|jpeg\n");
+        printf("  -i <file>      input elementary stream or IVF file (required for dec and hdr)\n");
+        printf("  -w <width>     encoded frame width (default 1920)\n");
+        printf("  -h <height>    encoded frame height (default 1080)\n");
+        printf("  -n <frames>    number of frames to process (default 300)\n");
+        printf("  -async <depth> AsyncDepth and number of frames in flight (default 4)\n");
+        printf("  -lowpower      use VDEnc (VAEntrypointEncSliceLP) for encode\n");
+        printf("  -loop          repeat input stream until -n frames are decoded\n");
+        printf("  -zerocopy      h264/h265 encode: reference coded buffers instead of copying\n");
+        printf("Set MFX_VA_NULL_DEVICE_ID to emulate another platform (hex PCI device ID).\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+
+    if (argc < 3)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (!strcmp(argv[1], "enc"))
+        opt.mode = MODE_ENCODE;
+    else if (!strcmp(argv[1], "dec"))
+        opt.mode = MODE_DECODE;
+    else if (!strcmp(argv[1], "hdr"))
+        opt.mode = MODE_HEADER;
+    else
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    auto codec = std::find_if(std::begin(g_codecs), std::end(g_codecs),
+        [&](Codec const& c) { return !strcmp(c.name, argv[2]); });
+    if (codec == std::end(g_codecs))
+    {
+        PrintUsage();
+        return 1;
+    }
+    opt.codecId = codec->codecId;
+
+    for (int i = 3; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "-i") && i + 1 < argc)
+            opt.input = argv[++i];
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+            opt.width = mfxU16(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-h") && i + 1 < argc)
+            opt.height = mfxU16(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            opt.frames = mfxU32(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-async") && i + 1 < argc)
+            opt.async = mfxU16(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-lowpower"))
+            opt.lowPower = MFX_CODINGOPTION_ON;
+        else if (!strcmp(argv[i], "-loop"))
+            opt.loop = true;
+        else if (!strcmp(argv[i], "-zerocopy"))
+            opt.zeroCopy = true;
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (!opt.frames || !opt.width || !opt.height || (opt.mode != MODE_ENCODE && !opt.input))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    int fd = open("/dev/null", O_RDWR);
+    VADisplay display = vaGetDisplayDRM(fd);
+    int major = 0, minor = 0;
+    if (vaInitialize(display, &major, &minor) != VA_STATUS_SUCCESS)
+    {
+        printf("libva_null is not linked ahead of libva\n");
+        return 1;
+    }
+
+    MFXVideoSession session;
+    mfxVersion version = { { 0, 1 } };
+
+    mfxStatus sts = session.Init(MFX_IMPL_HARDWARE_ANY, &version);
+    if (sts >= MFX_ERR_NONE)
+        sts = session.SetHandle(MFX_HANDLE_VA_DISPLAY, display);
+
+    Timings t;
+    VANullStats va = {};
+
+    if (sts >= MFX_ERR_NONE)
+    {
+        vaNullResetStats();
+        switch (opt.mode)
+        {
+        case MODE_ENCODE: sts = RunEncode(session, opt, t); break;
+        case MODE_DECODE: sts = RunDecode(session, opt, t); break;
+        case MODE_HEADER: sts = RunHeader(session, opt, t); break;
+        }
+        vaNullGetStats(&va);
+    }
+
+    session.Close();
+    vaTerminate(display);
+    close(fd);
+
+    if (sts < MFX_ERR_NONE || !t.frames)
+    {
+        printf("FAILED (status %d, %u frames)\n", int(sts), t.frames);
+        return 1;
+    }
+
+    double const n = t.frames;
+    auto us = [n](mfxU64 ns) { return ns / 1000.0 / n; };
+
+    printf("%s %s: %u frames, %.1f bytes/frame, async %u\n", argv[1], argv[2], t.frames, t.bytes / n, opt.async);
+    printf("%-28s %10s\n", "component", "us/frame");
+    printf("%-28s %10.2f\n", opt.mode == MODE_HEADER ? "DecodeHeader (app thread)" : "submit (app thread)", us(t.submitNs));
+    printf("%-28s %10.2f\n", "sync (app thread)",        us(t.syncNs));
+    printf("%-28s %10.2f\n", "app other",                us(t.appNs - std::min(t.appNs, t.submitNs + t.syncNs)));
+    printf("%-28s %10.2f\n", "runtime worker threads",   us(t.processNs - std::min(t.processNs, t.appNs)));
+    printf("%-28s %10.2f\n", "va backend (included above)", us(va.CpuTimeNs));
+    printf("%-28s %10.2f\n", "total CPU",                us(t.processNs));
+    printf("%-28s %10.2f\n", "wall",                     us(t.wallNs));
+    printf("%-28s %10.2f\n", "va calls/frame",           va.Calls / n);
+    printf("%-28s %10.2f\n", "va param KB/frame",        va.BufferBytes / 1024.0 / n);
+    if (opt.zeroCopy)
+        printf("%-28s %10u\n", "referenced frames",      t.referenced);
+
+    return 0;
+}
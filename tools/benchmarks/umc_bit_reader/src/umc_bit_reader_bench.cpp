@@ -0,0 +1,271 @@
+// Copyright (c) 2020 Intel Corporation
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Micro-benchmark for UMC::CachedBitReader used by VP9/AV1/MPEG-2 header parsers.
+// Compares it with the bit-by-bit reader it replaced and checks both return
+// the same values for the same read pattern.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <chrono>
+#include <random>
+
+#include "umc_bit_reader.h"
+
+namespace
+{
+    struct bench_exception
+    {
+        bench_exception(int32_t status = -1)
+            : m_status(status)
+        {}
+
+        int32_t m_status;
+    };
+
+    // bit-by-bit reader as it used to be in VP9Bitstream/MPEG2BaseBitstream
+    class ReferenceBitReader
+    {
+    public:
+
+        ReferenceBitReader(uint8_t * pb, uint32_t maxsize)
+            : m_pbs(pb)
+            , m_bitOffset(0)
+            , m_pbsBase(pb)
+            , m_maxBsSize(maxsize)
+        {}
+
+        uint32_t GetBit()
+        {
+            if (m_pbs >= m_pbsBase + m_maxBsSize)
+                throw bench_exception(UMC::UMC_ERR_NOT_ENOUGH_DATA);
+
+            uint32_t const bit = (*m_pbs >> (7 - m_bitOffset)) & 1;
+            if (++m_bitOffset == 8)
+            {
+                ++m_pbs;
+                m_bitOffset = 0;
+            }
+
+            return bit;
+        }
+
+        uint32_t GetBits(uint32_t nbits)
+        {
+            uint32_t bits = 0;
+            for (; nbits > 0; --nbits)
+            {
+                bits <<= 1;
+                bits |= GetBit();
+            }
+
+            return bits;
+        }
+
+        size_t BitsDecoded() const
+        {
+            return static_cast<size_t>(m_pbs - m_pbsBase) * 8 + m_bitOffset;
+        }
+
+    private:
+
+        uint8_t* m_pbs;
+        int32_t  m_bitOffset;
+        uint8_t* m_pbsBase;
+        uint32_t m_maxBsSize;
+    };
+
+    typedef UMC::CachedBitReader<bench_exception> CachedBitReader;
+
+    // Reads the whole buffer with the given field widths, returns checksum and number of reads
+    template <typename Reader>
+    uint64_t ReadAll(Reader& reader, std::vector<uint8_t> const& widths, size_t totalBits, size_t& reads)
+    {
+        uint64_t sum = 0;
+        size_t pos = 0;
+        reads = 0;
+
+        for (size_t i = 0; ; )
+        {
+            uint32_t const n = widths[i];
+            if (pos + n > totalBits)
+                break;
+
+            sum = sum * 31 + reader.GetBits(n);
+            pos += n;
+            ++reads;
+
+            if (++i == widths.size())
+                i = 0;
+        }
+
+        return sum;
+    }
+
+    template <typename Reader>
+    double Measure(std::vector<uint8_t>& data, std::vector<uint8_t> const& widths, uint32_t iterations, uint64_t& sum, size_t& reads)
+    {
+        auto const start = std::chrono::steady_clock::now();
+
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            Reader reader(data.data(), static_cast<uint32_t>(data.size()));
+            sum += ReadAll(reader, widths, data.size() * 8, reads);
+        }
+
+        auto const stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+    }
+
+    bool CheckSeek(std::vector<uint8_t>& data, std::mt19937& rng)
+    {
+        CachedBitReader reader(data.data(), static_cast<uint32_t>(data.size()));
+        size_t const totalBits = data.size() * 8;
+
+        for (uint32_t i = 0; i < 100000; ++i)
+        {
+            size_t const pos = rng() % totalBits;
+            uint32_t const n = std::min<uint32_t>(rng() % 33, static_cast<uint32_t>(totalBits - pos));
+
+            reader.Seek(static_cast<int32_t>(pos) - static_cast<int32_t>(reader.BitsDecoded()));
+            if (reader.BitsDecoded() != pos)
+                return false;
+
+            ReferenceBitReader ref(data.data(), static_cast<uint32_t>(data.size()));
+            ref.GetBits(static_cast<uint32_t>(pos & 31));
+            for (size_t skip = pos & ~size_t(31); skip; skip -= 32)
+                ref.GetBits(32);
+
+            uint32_t const expected = ref.GetBits(n);
+            if (reader.PeekBits(n) != expected || reader.GetBits(n) != expected)
+                return false;
+
+            reader.Seek(-static_cast<int32_t>(n));
+            if (reader.GetBits(n) != expected)
+                return false;
+        }
+
+        // read past the end must throw
+        reader.Reset(data.data(), static_cast<uint32_t>(data.size()));
+        reader.Seek(static_cast<int32_t>(totalBits - 3));
+        try
+        {
+            reader.GetBits(4);
+            return false;
+        }
+        catch (bench_exception const&)
+        {
+        }
+
+        return true;
+    }
+
+    void PrintUsage()
+    {
+        printf("Usage: umc_bit_reader [-size <bytes>] [-iter <count>]\n");
+        printf("  -size  size of random bitstream buffer (default 1048576)\n");
+        printf("  -iter  number of passes over the buffer (default 20)\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t size = 1 << 20;
+    uint32_t iterations = 20;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "-size") && i + 1 < argc)
+            size = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-iter") && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (!size || !iterations)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::mt19937 rng(12345);
+    std::vector<uint8_t> data(size);
+    for (auto& b : data)
+        b = static_cast<uint8_t>(rng());
+
+    struct Pattern
+    {
+        char const*          name;
+        std::vector<uint8_t> widths;
+    };
+
+    std::vector<Pattern> patterns =
+    {
+        // flags and short fields dominate uncompressed headers
+        { "flags (1 bit)",          { 1 } },
+        { "header mix (1..16 bit)", { 1, 1, 3, 1, 16, 16, 1, 6, 3, 1, 1, 8, 2, 1, 4, 1 } },
+        { "obu/le bytes (8 bit)",   { 8 } },
+        { "long fields (32 bit)",   { 32, 24, 17 } },
+    };
+
+    {
+        std::vector<uint8_t> random(256);
+        for (auto& w : random)
+            w = static_cast<uint8_t>(rng() % 33);
+        patterns.push_back({ "random (0..32 bit)", random });
+    }
+
+    int ret = 0;
+
+    printf("%-24s %12s %12s %12s %8s\n", "pattern", "reads", "ref ns/read", "new ns/read", "speedup");
+
+    for (auto const& pattern : patterns)
+    {
+        uint64_t sumRef = 0, sumNew = 0;
+        size_t readsRef = 0, readsNew = 0;
+
+        double const tRef = Measure<ReferenceBitReader>(data, pattern.widths, iterations, sumRef, readsRef);
+        double const tNew = Measure<CachedBitReader>(data, pattern.widths, iterations, sumNew, readsNew);
+
+        if (sumRef != sumNew || readsRef != readsNew)
+        {
+            printf("%-24s MISMATCH\n", pattern.name);
+            ret = 1;
+            continue;
+        }
+
+        printf("%-24s %12zu %12.2f %12.2f %7.2fx\n", pattern.name, readsNew,
+            tRef / readsRef, tNew / readsNew, tRef / tNew);
+    }
+
+    if (!CheckSeek(data, rng))
+    {
+        printf("seek/peek check FAILED\n");
+        ret = 1;
+    }
+
+    return ret;
+}
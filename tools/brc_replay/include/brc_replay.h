@@ -0,0 +1,103 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __BRC_REPLAY_H__
+#define __BRC_REPLAY_H__
+
+#include "brc_trace.h"
+#include <string>
+#include <vector>
+
+// Offline replay of BRC traces (see brc_trace.h) against mfxExtBRC implementations.
+// Coded frame sizes come from per-frame size(QP) model of the trace, so rate control
+// can be tuned and regression-tested without encoder and GPU.
+
+namespace BRCReplay
+{
+
+// BRC implementation under test, created through its mfxExtBRC callback table
+struct Implementation
+{
+    const char* Name;
+    mfxExtBRC*  (*Create)();
+    void        (*Destroy)(mfxExtBRC* brc);
+};
+
+struct Options
+{
+    mfxU32      Loops             = 1;     // number of passes over the trace
+    bool        Strict            = false; // HRD violations are failures
+
+    // overrides of recorded rate control parameters, 0 - keep recorded value
+    mfxU16      RateControlMethod = 0;
+    mfxU32      TargetKbps        = 0;
+    mfxU32      MaxKbps           = 0;
+    mfxU32      BufferSizeInKB    = 0;
+    mfxU32      InitialDelayInKB  = 0;
+
+    std::string CsvFile;                   // per-frame results
+};
+
+struct Latency
+{
+    mfxF64 MeanNs = 0;
+    mfxF64 P50Ns  = 0;
+    mfxF64 P99Ns  = 0;
+    mfxF64 MaxNs  = 0;
+};
+
+struct Report
+{
+    mfxU32  NumFrames          = 0;
+    mfxU32  NumRecodes         = 0;
+    mfxU32  NumSkipped         = 0;  // MFX_BRC_PANIC_BIG_FRAME
+    mfxU32  NumPadded          = 0;  // MFX_BRC_PANIC_SMALL_FRAME
+    mfxU32  NumRecodeLimit     = 0;  // frames BRC kept asking to recode
+    mfxStatus Status           = MFX_ERR_NONE;
+
+    mfxF64  TargetKbps         = 0;
+    mfxF64  ActualKbps         = 0;
+
+    // leaky bucket model of CPB, only for CBR and VBR with buffer size set
+    bool    HRDChecked         = false;
+    mfxU32  NumUnderflow       = 0;  // frame removed before it is fully in buffer
+    mfxU32  NumOverflow        = 0;  // CBR buffer overfilled, stuffing would be required
+    mfxF64  MinFullness        = 0;  // fraction of buffer size
+    mfxF64  MaxFullness        = 0;
+
+    mfxF64  MeanQP             = 0;
+    mfxF64  QPStdDev           = 0;
+    mfxF64  MeanAbsDeltaQP     = 0;  // between consecutive frames of the same type and layer
+    mfxU32  NumQPReversals     = 0;  // QP trend changed direction within the same type and layer
+
+    Latency GetFrameCtrl;
+    Latency Update;
+    mfxF64  FramesPerSecond    = 0;
+};
+
+mfxStatus Run(const Implementation& impl, BRCTrace& trace, const Options& opt, Report& report);
+void      Print(const Implementation& impl, const Report& report);
+
+// Command line driver shared by replay executables
+int Main(int argc, char** argv, const Implementation* impls, mfxU32 numImpls);
+
+} // namespace BRCReplay
+
+#endif // __BRC_REPLAY_H__
@@ -0,0 +1,431 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "brc_replay.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+
+namespace BRCReplay
+{
+
+typedef std::chrono::steady_clock Clock;
+
+static Latency GetLatency(std::vector<mfxU32>& samples)
+{
+    Latency lat;
+    if (samples.empty())
+        return lat;
+
+    mfxF64 sum = 0;
+    for (mfxU32 ns : samples)
+        sum += ns;
+    lat.MeanNs = sum / samples.size();
+
+    size_t p50 = samples.size() / 2;
+    size_t p99 = std::min(samples.size() - 1, samples.size() * 99 / 100);
+
+    std::nth_element(samples.begin(), samples.begin() + p50, samples.end());
+    lat.P50Ns = samples[p50];
+    std::nth_element(samples.begin() + p50, samples.begin() + p99, samples.end());
+    lat.P99Ns = samples[p99];
+    lat.MaxNs = *std::max_element(samples.begin() + p99, samples.end());
+
+    return lat;
+}
+
+static mfxU32 GetNs(Clock::time_point start, Clock::time_point end)
+{
+    return (mfxU32)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+// QP statistics are tracked per frame type and pyramid layer, QP of I and B frames
+// naturally differs and should not count as oscillation
+struct QPTrack
+{
+    mfxI32 LastQP    = -1;
+    mfxI32 LastDelta = 0;
+};
+
+static mfxU32 GetTrackIdx(mfxU16 frameType, mfxU16 layer)
+{
+    mfxU32 type = (frameType & MFX_FRAMETYPE_I) ? 0 : (frameType & MFX_FRAMETYPE_P) ? 1 : 2;
+    return type * 8 + std::min<mfxU16>(layer, 7);
+}
+
+mfxStatus Run(const Implementation& impl, BRCTrace& trace, const Options& opt, Report& report)
+{
+    report = Report();
+
+    if (trace.Frames.empty())
+        return MFX_ERR_NOT_ENOUGH_BUFFER;
+
+    std::vector<mfxExtBuffer*> extParam;
+    mfxVideoParam par = {};
+    trace.GetVideoParam(par, extParam);
+
+    if (opt.RateControlMethod)
+        par.mfx.RateControlMethod = opt.RateControlMethod;
+
+    if (opt.TargetKbps || opt.MaxKbps || opt.BufferSizeInKB || opt.InitialDelayInKB)
+    {
+        mfxU32 mult  = std::max<mfxU16>(par.mfx.BRCParamMultiplier, 1);
+        mfxU32 tbr   = opt.TargetKbps       ? opt.TargetKbps       : par.mfx.TargetKbps       * mult;
+        mfxU32 maxbr = opt.MaxKbps          ? opt.MaxKbps          : par.mfx.MaxKbps          * mult;
+        mfxU32 buf   = opt.BufferSizeInKB   ? opt.BufferSizeInKB   : par.mfx.BufferSizeInKB   * mult;
+        mfxU32 delay = opt.InitialDelayInKB ? opt.InitialDelayInKB : par.mfx.InitialDelayInKB * mult;
+
+        mult = std::max(std::max(tbr, maxbr), std::max(buf, delay)) / 0x10000 + 1;
+
+        par.mfx.BRCParamMultiplier = (mfxU16)mult;
+        par.mfx.TargetKbps         = (mfxU16)(tbr   / mult);
+        par.mfx.MaxKbps            = (mfxU16)(maxbr / mult);
+        par.mfx.BufferSizeInKB     = (mfxU16)(buf   / mult);
+        par.mfx.InitialDelayInKB   = (mfxU16)(delay / mult);
+    }
+
+    std::unique_ptr<mfxExtBRC, void(*)(mfxExtBRC*)> brc(impl.Create(), impl.Destroy);
+    if (!brc)
+        return MFX_ERR_MEMORY_ALLOC;
+
+    mfxStatus sts = brc->Init(brc->pthis, &par);
+    if (sts < MFX_ERR_NONE)
+        return sts;
+
+    FILE* csv = NULL;
+    if (!opt.CsvFile.empty())
+    {
+        csv = fopen(opt.CsvFile.c_str(), "w");
+        if (csv)
+            fprintf(csv, "EncodedOrder,DisplayOrder,FrameType,PyramidLayer,QP,Size,Recodes,BRCStatus,Fullness\n");
+    }
+
+    const mfxU32 mult      = std::max<mfxU16>(par.mfx.BRCParamMultiplier, 1);
+    const mfxF64 frameRate = (par.mfx.FrameInfo.FrameRateExtN && par.mfx.FrameInfo.FrameRateExtD)
+        ? (mfxF64)par.mfx.FrameInfo.FrameRateExtN / par.mfx.FrameInfo.FrameRateExtD : 30.;
+    const bool   isCBR     = par.mfx.RateControlMethod == MFX_RATECONTROL_CBR;
+    const mfxF64 hrdRate   = 1000. * mult * (isCBR ? par.mfx.TargetKbps : std::max(par.mfx.MaxKbps, par.mfx.TargetKbps));
+    const mfxF64 hrdSize   = 8000. * mult * par.mfx.BufferSizeInKB;
+    const mfxF64 bitsIn    = hrdRate / frameRate;
+
+    report.TargetKbps = (mfxF64)par.mfx.TargetKbps * mult;
+    report.HRDChecked = (isCBR || par.mfx.RateControlMethod == MFX_RATECONTROL_VBR) && hrdSize > 0 && hrdRate > 0;
+
+    mfxF64 fullness = report.HRDChecked ? std::min(8000. * mult * par.mfx.InitialDelayInKB, hrdSize) : 0;
+    report.MinFullness = report.MaxFullness = report.HRDChecked ? fullness / hrdSize : 0;
+
+    mfxU32 span = 0;
+    for (const BRCTraceFrame& frame : trace.Frames)
+        span = std::max(span, frame.EncodedOrder + 1);
+
+    const size_t numCalls = trace.Frames.size() * opt.Loops;
+    std::vector<mfxU32> latCtrl, latUpdate;
+    latCtrl.reserve(numCalls + numCalls / 4);
+    latUpdate.reserve(numCalls + numCalls / 4);
+
+    QPTrack tracks[3 * 8];
+    mfxF64 qpSum = 0, qpSqSum = 0, absDeltaSum = 0, totalBits = 0;
+    mfxU32 numDeltas = 0;
+
+    Clock::time_point start = Clock::now();
+
+    for (mfxU32 loop = 0; loop < opt.Loops && sts >= MFX_ERR_NONE; loop++)
+    {
+        for (const BRCTraceFrame& frame : trace.Frames)
+        {
+            mfxBRCFrameParam frame_par = {};
+            frame_par.EncodedOrder = frame.EncodedOrder + loop * span;
+            frame_par.DisplayOrder = frame.DisplayOrder + loop * span;
+            frame_par.FrameType    = frame.FrameType;
+            frame_par.PyramidLayer = frame.PyramidLayer;
+#if (MFX_VERSION >= 1026)
+            frame_par.SceneChange  = frame.SceneChange;
+            frame_par.LongTerm     = frame.LongTerm;
+            frame_par.FrameCmplx   = frame.FrameCmplx;
+#endif
+            mfxBRCFrameCtrl   ctrl   = {};
+            mfxBRCFrameStatus status = {};
+            mfxU32            size   = 0;
+            bool              skip   = false;
+
+            // same call sequence as HEVC encoder ExtBRC feature
+            for (;;)
+            {
+                ctrl = {};
+                Clock::time_point t0 = Clock::now();
+                sts = brc->GetFrameCtrl(brc->pthis, &frame_par, &ctrl);
+                Clock::time_point t1 = Clock::now();
+                latCtrl.push_back(GetNs(t0, t1));
+                if (sts < MFX_ERR_NONE)
+                    break;
+
+                // skipped frame costs next to nothing
+                size = skip ? 0 : frame.GetSize(ctrl.QpY);
+                frame_par.CodedFrameSize = size;
+
+                status = {};
+                t0 = Clock::now();
+                sts = brc->Update(brc->pthis, &frame_par, &ctrl, &status);
+                t1 = Clock::now();
+                latUpdate.push_back(GetNs(t0, t1));
+                if (sts < MFX_ERR_NONE)
+                    break;
+
+                if (status.BRCStatus == MFX_BRC_PANIC_SMALL_FRAME)
+                {
+                    // frame is padded up to MinFrameSize (in bits) and reported again
+                    report.NumPadded++;
+                    frame_par.NumRecode++;
+                    size = std::max(size, (status.MinFrameSize + 7) >> 3);
+                    frame_par.CodedFrameSize = size;
+
+                    status = {};
+                    t0 = Clock::now();
+                    sts = brc->Update(brc->pthis, &frame_par, &ctrl, &status);
+                    t1 = Clock::now();
+                    latUpdate.push_back(GetNs(t0, t1));
+                    break;
+                }
+
+                if (status.BRCStatus == MFX_BRC_PANIC_BIG_FRAME && !skip)
+                {
+                    report.NumSkipped++;
+                    skip = true;
+                }
+                else if (status.BRCStatus != MFX_BRC_BIG_FRAME && status.BRCStatus != MFX_BRC_SMALL_FRAME)
+                    break;
+                else
+                    report.NumRecodes++;
+
+                if (++frame_par.NumRecode >= BRC_TRACE_MAX_PASSES)
+                {
+                    report.NumRecodeLimit++;
+                    break;
+                }
+            }
+
+            if (sts < MFX_ERR_NONE)
+                break;
+
+            report.NumFrames++;
+            totalBits += 8. * size;
+
+            qpSum   += ctrl.QpY;
+            qpSqSum += (mfxF64)ctrl.QpY * ctrl.QpY;
+
+            QPTrack& track = tracks[GetTrackIdx(frame.FrameType, frame.PyramidLayer)];
+            if (track.LastQP >= 0)
+            {
+                mfxI32 delta = ctrl.QpY - track.LastQP;
+                absDeltaSum += abs(delta);
+                numDeltas++;
+
+                if (delta && track.LastDelta && ((delta > 0) != (track.LastDelta > 0)))
+                    report.NumQPReversals++;
+                if (delta)
+                    track.LastDelta = delta;
+            }
+            track.LastQP = ctrl.QpY;
+
+            if (report.HRDChecked)
+            {
+                fullness -= 8. * size;
+                if (fullness < 0)
+                {
+                    report.NumUnderflow++;
+                    fullness = 0;
+                }
+                report.MinFullness = std::min(report.MinFullness, fullness / hrdSize);
+
+                fullness += bitsIn;
+                if (fullness > hrdSize)
+                {
+                    if (isCBR)
+                        report.NumOverflow++;
+                    fullness = hrdSize;
+                }
+                report.MaxFullness = std::max(report.MaxFullness, fullness / hrdSize);
+            }
+
+            if (csv)
+                fprintf(csv, "%u,%u,%u,%u,%d,%u,%u,%u,%.4f\n", frame_par.EncodedOrder, frame_par.DisplayOrder,
+                    frame.FrameType, frame.PyramidLayer, ctrl.QpY, size, frame_par.NumRecode, status.BRCStatus,
+                    report.HRDChecked ? fullness / hrdSize : 0.);
+        }
+    }
+
+    mfxF64 elapsed = std::chrono::duration<mfxF64>(Clock::now() - start).count();
+
+    brc->Close(brc->pthis);
+    if (csv)
+        fclose(csv);
+
+    report.Status = sts < MFX_ERR_NONE ? sts : MFX_ERR_NONE;
+
+    if (report.NumFrames)
+    {
+        report.ActualKbps      = totalBits * frameRate / report.NumFrames / 1000.;
+        report.MeanQP          = qpSum / report.NumFrames;
+        report.QPStdDev        = sqrt(std::max(0., qpSqSum / report.NumFrames - report.MeanQP * report.MeanQP));
+        report.MeanAbsDeltaQP  = numDeltas ? absDeltaSum / numDeltas : 0;
+        report.FramesPerSecond = elapsed > 0 ? report.NumFrames / elapsed : 0;
+    }
+
+    report.GetFrameCtrl = GetLatency(latCtrl);
+    report.Update       = GetLatency(latUpdate);
+
+    return report.Status;
+}
+
+void Print(const Implementation& impl, const Report& report)
+{
+    printf("BRC: %s\n", impl.Name);
+    if (report.Status < MFX_ERR_NONE)
+        printf("  FAILED with status %d after %u frames\n", report.Status, report.NumFrames);
+
+    printf("  frames:        %u (recodes %u, skipped %u, padded %u, recode limit hit %u)\n",
+        report.NumFrames, report.NumRecodes, report.NumSkipped, report.NumPadded, report.NumRecodeLimit);
+    printf("  bitrate:       %.1f kbps (target %.1f kbps, %+.2f%%)\n", report.ActualKbps, report.TargetKbps,
+        report.TargetKbps > 0 ? 100. * (report.ActualKbps - report.TargetKbps) / report.TargetKbps : 0.);
+
+    if (report.HRDChecked)
+        printf("  HRD:           %s (underflow %u, overflow %u, fullness %.1f%%..%.1f%%)\n",
+            (report.NumUnderflow || report.NumOverflow) ? "VIOLATED" : "compliant",
+            report.NumUnderflow, report.NumOverflow, 100. * report.MinFullness, 100. * report.MaxFullness);
+    else
+        printf("  HRD:           not checked\n");
+
+    printf("  QP:            mean %.2f, stddev %.2f, mean |dQP| %.2f, reversals %u (%.2f%% of frames)\n",
+        report.MeanQP, report.QPStdDev, report.MeanAbsDeltaQP, report.NumQPReversals,
+        report.NumFrames ? 100. * report.NumQPReversals / report.NumFrames : 0.);
+    printf("  GetFrameCtrl:  mean %.0f ns, p50 %.0f ns, p99 %.0f ns, max %.0f ns\n",
+        report.GetFrameCtrl.MeanNs, report.GetFrameCtrl.P50Ns, report.GetFrameCtrl.P99Ns, report.GetFrameCtrl.MaxNs);
+    printf("  Update:        mean %.0f ns, p50 %.0f ns, p99 %.0f ns, max %.0f ns\n",
+        report.Update.MeanNs, report.Update.P50Ns, report.Update.P99Ns, report.Update.MaxNs);
+    printf("  throughput:    %.0f frames/s\n", report.FramesPerSecond);
+}
+
+static void PrintHelp(const char* app, const Implementation* impls, mfxU32 numImpls)
+{
+    printf("Usage: %s -i <trace> [options]\n", app);
+    printf("Replays BRC trace recorded by sample_encode -brc_trace against BRC implementations\n");
+    printf("  -i <file>        BRC trace\n");
+    printf("  -impl <name>     BRC to run, all available by default:");
+    for (mfxU32 i = 0; i < numImpls; i++)
+        printf(" %s", impls[i].Name);
+    printf("\n");
+    printf("  -loops <n>       replay trace n times (default 1)\n");
+    printf("  -cbr | -vbr      override rate control method\n");
+    printf("  -tbr <kbps>      override target bitrate\n");
+    printf("  -maxbr <kbps>    override max bitrate\n");
+    printf("  -buf <KB>        override HRD buffer size\n");
+    printf("  -delay <KB>      override HRD initial delay\n");
+    printf("  -csv <file>      per-frame results (<file>.<impl>.csv when several BRCs are run)\n");
+    printf("  -strict          treat HRD violations as failure\n");
+}
+
+int Main(int argc, char** argv, const Implementation* impls, mfxU32 numImpls)
+{
+    Options     opt;
+    std::string input, implName;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+
+        if (!strcmp(argv[i], "-i") && hasValue)
+            input = argv[++i];
+        else if (!strcmp(argv[i], "-impl") && hasValue)
+            implName = argv[++i];
+        else if (!strcmp(argv[i], "-loops") && hasValue)
+            opt.Loops = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-cbr"))
+            opt.RateControlMethod = MFX_RATECONTROL_CBR;
+        else if (!strcmp(argv[i], "-vbr"))
+            opt.RateControlMethod = MFX_RATECONTROL_VBR;
+        else if (!strcmp(argv[i], "-tbr") && hasValue)
+            opt.TargetKbps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-maxbr") && hasValue)
+            opt.MaxKbps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-buf") && hasValue)
+            opt.BufferSizeInKB = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-delay") && hasValue)
+            opt.InitialDelayInKB = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-csv") && hasValue)
+            opt.CsvFile = argv[++i];
+        else if (!strcmp(argv[i], "-strict"))
+            opt.Strict = true;
+        else
+        {
+            PrintHelp(argv[0], impls, numImpls);
+            return 1;
+        }
+    }
+
+    if (input.empty())
+    {
+        PrintHelp(argv[0], impls, numImpls);
+        return 1;
+    }
+
+    BRCTrace trace;
+    if (trace.Load(input.c_str()) != MFX_ERR_NONE)
+        return 1;
+
+    printf("Trace: %s, %zu frames, RateControlMethod %u, TargetKbps %u, MaxKbps %u, BufferSizeInKB %u\n",
+        input.c_str(), trace.Frames.size(), trace.Header.mfx.RateControlMethod, trace.Header.mfx.TargetKbps,
+        trace.Header.mfx.MaxKbps, trace.Header.mfx.BufferSizeInKB);
+
+    int    result = 0;
+    mfxU32 numRun = 0;
+
+    for (mfxU32 i = 0; i < numImpls; i++)
+    {
+        if (!implName.empty() && implName != impls[i].Name)
+            continue;
+
+        Options implOpt = opt;
+        if (!opt.CsvFile.empty() && implName.empty() && numImpls > 1)
+            implOpt.CsvFile = opt.CsvFile + "." + impls[i].Name + ".csv";
+
+        Report report;
+        Run(impls[i], trace, implOpt, report);
+        Print(impls[i], report);
+        numRun++;
+
+        if (report.Status < MFX_ERR_NONE || (opt.Strict && (report.NumUnderflow || report.NumOverflow)))
+            result = 1;
+    }
+
+    if (!numRun)
+    {
+        printf("ERROR: unknown BRC implementation %s\n", implName.c_str());
+        return 1;
+    }
+
+    return result;
+}
+
+} // namespace BRCReplay
@@ -0,0 +1,58 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// mfxExtBRC of the runtime: MfxHwH265EncodeBRC::ExtBRC used by AVC and HEVC encoders
+// with implicit external BRC
+
+#include "mfx_brc_common.h"
+#include <memory>
+
+#if defined (MFX_ENABLE_H264_VIDEO_ENCODE) || defined (MFX_ENABLE_H265_VIDEO_ENCODE)
+
+mfxExtBRC* CreateLibBRC()
+{
+    std::unique_ptr<mfxExtBRC> brc(new mfxExtBRC());
+    if (HEVCExtBRC::Create(*brc) != MFX_ERR_NONE)
+        return nullptr;
+
+    return brc.release();
+}
+
+void DestroyLibBRC(mfxExtBRC* brc)
+{
+    if (brc)
+    {
+        HEVCExtBRC::Destroy(*brc);
+        delete brc;
+    }
+}
+
+#else
+
+mfxExtBRC* CreateLibBRC()
+{
+    return nullptr;
+}
+
+void DestroyLibBRC(mfxExtBRC*)
+{
+}
+
+#endif
@@ -53,6 +53,7 @@ struct Task
     unsigned int blocked;
     bool detach;
     State state;
+    unsigned int nReady; // Scheduler::m_nReady when task was started
     std::mutex mtx;
     std::condition_variable cv;
 };
@@ -90,6 +91,7 @@ private:
     unsigned int            m_id;
     size_t                  m_depth;
     unsigned int            m_locked;
+    unsigned int            m_nReady; // number of tasks finished and Wake() calls so far
 
     static void Execute (Thread& self, Scheduler& sync);
     static void Update  (Scheduler& self, Thread* thread);
@@ -110,6 +112,7 @@ public:
     State   AddDependency   (SyncPoint task, unsigned int nDep, SyncPoint *dep);
     void    Detach          (SyncPoint task); // no sync for this task
     bool    WaitForAny      (unsigned int waitMS);
+    void    Wake            (); // re-queue WAITING tasks, e.g. when the state they poll has changed
 };
 
 };
\ No newline at end of file
@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <vector>
 #include <list>
+#include <memory>
 
 namespace BS_HEVC2
 {
@@ -302,6 +303,7 @@ public:
     inline void SyncDS  () { (CabacCtx&)(*this) = m_ctxDS; }
     inline void StoreWPP() { m_ctxWPP = (CabacCtx&)(*this); }
     inline void StoreDS () { m_ctxDS = (CabacCtx&)(*this); }
+    inline void SyncWPP (const CABAC& above) { (CabacCtx&)(*this) = above.m_ctxWPP; }
 
     inline Bs16u GetR()     { return ADE::GetR(); }
     inline Bs16u GetV()     { return ADE::GetV(); }
@@ -386,6 +388,7 @@ public:
     inline bool  CoeffAbsLevelGreater2Flag(Bs16u cIdx) { return DD(BS_HEVC::COEFF_ABS_LEVEL_GREATER2_FLAG, ctxSet + 4 * !!cIdx); }
            Bs32u CoeffAbsLevelRemaining(Bs16u i, Bs16u baseLevel, Bs16u cIdx, CU& cu, TU& tu);
     inline bool  CoeffSignFlag()                       { return DB(); }
+    inline Bs32u CoeffSignFlags(Bs32u n)               { BinCount += n; return DecodeBypass(n); }
 
     //palette_coding()
     inline Bs8u  PalettePredictorRun()              { return (Bs8u)EGkBypass(0); }
@@ -403,6 +406,8 @@ public:
            Bs16u PaletteEscapeVal(Bs16u cIdx, bool cu_transquant_bypass_flag);
 };
 
+struct WPPSync;
+
 class SDParser //Slice data parser
     : public  BsReader2::Reader
     , private CABAC
@@ -426,6 +431,39 @@ private:
     bool report_TCLevels = false;
     std::vector<Bs32s> TCLevels;
 
+    WPPSync* m_pWPP        = nullptr; // set when slice segment is parsed in wavefront
+    Bs16u    m_WPPRow      = 0;
+    Bs32u    m_WPPAboveRs  = 0;
+    Bs32u    m_WPPImported = 0;
+
+    bool WPPImport(Bs32u NumCtb); // false if the row above is behind
+
+    // parseSSD() state kept while a wavefront row waits for the row above
+    struct SSDState
+    {
+        NALU*  pNALU       = nullptr; // set while slice segment data is being parsed
+        NALU*  pColPic     = nullptr;
+        Bs32u  NumCtb      = 0;
+        size_t nCTU        = 0;
+        size_t nCU         = 0;
+        size_t nPU         = 0;
+        size_t nTU         = 0;
+        Bs16u  CtbAddrInRs = 0;
+        Bs16u  CtbAddrInTs = 0;
+        Bs16u  SliceAddrRs = 0;
+        Bs16u  xCtb        = 0;
+        Bs16u  yCtb        = 0;
+        CTU*   pCTU        = nullptr;
+        bool   CtxReady    = false; // contexts are initialized
+        bool   CtuDone     = false; // last CTU is parsed
+        std::vector<Slice*> ColSlices;
+    } m_ssd;
+
+    void SSDStart(NALU& nalu, NALU* pColPic, Bs32u NumCtb, WPPSync* pWPP, Bs16u WPPRow);
+    bool SSDParse();
+    CTU* SSDFinish();
+    void SSDStop();
+
     template<class T> T* Alloc(Bs16u n_elem = 1)
     {
         if (std::is_same<CTU, T>::value)
@@ -490,7 +528,9 @@ public:
 
     bool more_rbsp_data();
 
-    CTU* parseSSD(NALU& nalu, NALU* pColPic, Bs32u NumCtb = -1);
+    // Returns nullptr without blocking when a wavefront row (WPPRow > 0) has to wait for
+    // the row above, the call is repeated with the same arguments to continue then
+    CTU* parseSSD(NALU& nalu, NALU* pColPic, Bs32u NumCtb = -1, WPPSync* pWPP = nullptr, Bs16u WPPRow = 0);
 };
 
 struct SDDesc
@@ -509,6 +549,8 @@ struct SDPar
     bool  Emulation;
     bool  NewPicture;
     SDDesc* pTask;
+    std::shared_ptr<WPPSync> WPP;
+    Bs16u WPPRow;
 };
 
 struct SDThread
@@ -522,6 +564,55 @@ struct SDThread
     std::mutex mtx;
 };
 
+struct WPPSync //CTU rows of slice segment parsed in wavefront, one task per row
+{
+    std::mutex mtx;
+    std::vector<SDThread*> SDT;
+    std::vector<Bs32s> NumCtbDone; // -1 if row is finished incomplete
+    std::vector<Bs32s> NumCtbWait; // CTUs of the row above the row's task waits for, 0 if it runs
+    Bs32s RowSize;
+    BsThread::Scheduler* pScheduler;
+
+    // Row tasks don't block scheduler workers: a row that is ahead of the row above
+    // returns WAITING and is woken up by Set()/Finish() of that row
+    inline bool Ready(Bs16u row, Bs32s n, Bs32s& done)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        done = NumCtbDone[row];
+
+        if (done < 0 || done >= n)
+            return true;
+
+        NumCtbWait[row + 1] = n;
+        return false;
+    }
+
+    inline void Set(Bs16u row, Bs32s n)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        NumCtbDone[row] = n;
+        WakeBelow(lock, row, n);
+    }
+
+    inline void Finish(Bs16u row)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (NumCtbDone[row] < RowSize)
+            NumCtbDone[row] = -1;
+        WakeBelow(lock, row, RowSize);
+    }
+
+    inline void WakeBelow(std::unique_lock<std::mutex>& lock, Bs16u row, Bs32s n)
+    {
+        if (row + 1u >= NumCtbWait.size() || !NumCtbWait[row + 1] || n < NumCtbWait[row + 1])
+            return;
+
+        NumCtbWait[row + 1] = 0;
+        lock.unlock();
+        pScheduler->Wake();
+    }
+};
+
 struct SyncPoint
 {
     BsThread::SyncPoint AU; // headers parsed, slice tasks submitted
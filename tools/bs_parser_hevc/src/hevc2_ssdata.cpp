@@ -57,13 +57,65 @@ bool SDParser::more_rbsp_data()
     return true;
 }
 
-CTU* SDParser::parseSSD(NALU& nalu, NALU* pColPic, Bs32u NumCtb)
+bool SDParser::WPPImport(Bs32u NumCtb)
+{
+    if (NumCtb <= m_WPPImported)
+        return true;
+
+    auto& above = m_pWPP->SDT[m_WPPRow - 1]->p;
+    Bs32s done = 0;
+
+    if (!m_pWPP->Ready(m_WPPRow - 1, NumCtb, done))
+        return false;
+
+    if (done < 0)
+        throw InvalidSyntax();
+
+    for (; m_WPPImported < NumCtb; m_WPPImported++)
+    {
+        Bs32u addr = m_WPPAboveRs + m_WPPImported;
+
+        CtuInRs[addr] = above.CtuInRs[addr];
+
+        for (Bs16u cIdx = 0; cIdx < 3; cIdx++)
+            if (addr < m_sao[cIdx].size())
+                m_sao[cIdx][addr] = above.m_sao[cIdx][addr];
+    }
+
+    return true;
+}
+
+CTU* SDParser::parseSSD(NALU& nalu, NALU* pColPic, Bs32u NumCtb, WPPSync* pWPP, Bs16u WPPRow)
 {
     TLAuto tl(*this, TRACE_CTU);
-    BS_MEM::AutoLock _cpLock(m_pAllocator, pColPic);
+    CTU* pCTU = nullptr;
+
+    if (!m_ssd.pNALU)
+        SSDStart(nalu, pColPic, NumCtb, pWPP, WPPRow);
+
+    try
+    {
+        // wavefront row waits for the row above, state is kept for the next call
+        if (!SSDParse())
+            return nullptr;
+
+        pCTU = SSDFinish();
+    }
+    catch (...)
+    {
+        SSDStop();
+        throw;
+    }
+
+    SSDStop();
+
+    return pCTU;
+}
+
+void SDParser::SSDStart(NALU& nalu, NALU* pColPic, Bs32u NumCtb, WPPSync* pWPP, Bs16u WPPRow)
+{
+    auto& s = m_ssd;
     auto& slice = *nalu.slice;
-    auto& pps = *slice.pps;
-    std::vector<Slice*> colSLices;
 
     if (NewPicture)
     {
@@ -88,101 +140,165 @@ CTU* SDParser::parseSSD(NALU& nalu, NALU* pColPic, Bs32u NumCtb)
         m_tu.reserve(PicSizeInMinTbY);
     }
 
-    auto nCTU = m_ctu.size();
-    auto nCU = m_cu.size();
-    auto nPU = m_pu.size();
-    auto nTU = m_tu.size();
+    if (m_pAllocator && pColPic)
+        m_pAllocator->lock(pColPic);
+
+    s.pNALU    = &nalu;
+    s.pColPic  = pColPic;
+    s.NumCtb   = NumCtb;
+    s.CtxReady = false;
+    s.CtuDone  = false;
 
-    Bs16u CtbAddrInRs = slice.slice_segment_address;
-    Bs16u CtbAddrInTs = CtbAddrRsToTs[CtbAddrInRs];
-    Bs16u SliceAddrRs = (slice.dependent_slice_segment_flag) ? SliceAddrRsInTs[CtbAddrInTs - 1] : CtbAddrInRs;
-    Bs16u xCtb = (CtbAddrInRs % PicWidthInCtbsY) << CtbLog2SizeY;
-    Bs16u yCtb = (CtbAddrInRs / PicWidthInCtbsY) << CtbLog2SizeY;
+    s.nCTU = m_ctu.size();
+    s.nCU  = m_cu.size();
+    s.nPU  = m_pu.size();
+    s.nTU  = m_tu.size();
+
+    s.CtbAddrInRs = slice.slice_segment_address;
+    s.CtbAddrInTs = CtbAddrRsToTs[s.CtbAddrInRs];
+    s.SliceAddrRs = (slice.dependent_slice_segment_flag || WPPRow) ? SliceAddrRsInTs[s.CtbAddrInTs - 1] : s.CtbAddrInRs;
+    s.xCtb = (s.CtbAddrInRs % PicWidthInCtbsY) << CtbLog2SizeY;
+    s.yCtb = (s.CtbAddrInRs / PicWidthInCtbsY) << CtbLog2SizeY;
+    s.pCTU = nullptr;
+
+    s.ColSlices.clear();
 
     while (pColPic)
     {
         if (isSlice(*pColPic))
-            colSLices.push_back(pColPic->slice);
+            s.ColSlices.push_back(pColPic->slice);
         pColPic = pColPic->next;
     }
 
-    if (!colSLices.empty())
+    if (!s.ColSlices.empty())
     {
-        ColPicSlices = &colSLices[0];
-        NumColSlices = (Bs16u)colSLices.size();
+        ColPicSlices = &s.ColSlices[0];
+        NumColSlices = (Bs16u)s.ColSlices.size();
     }
 
-    SliceAddrRsInTs[CtbAddrInTs] = SliceAddrRs;
+    SliceAddrRsInTs[s.CtbAddrInTs] = s.SliceAddrRs;
 
-    if (   !slice.dependent_slice_segment_flag
-        || TileId[CtbAddrInTs] != TileId[CtbAddrInTs-1])
-    {
-        InitCtx();
-    }
-    else if (pps.entropy_coding_sync_enabled_flag && (CtbAddrInRs % PicWidthInCtbsY) == 0)
+    m_pWPP        = pWPP;
+    m_WPPRow      = WPPRow;
+    m_WPPAboveRs  = s.CtbAddrInRs - PicWidthInCtbsY;
+    m_WPPImported = 0;
+}
+
+void SDParser::SSDStop()
+{
+    if (m_pAllocator && m_ssd.pColPic)
+        m_pAllocator->unlock(m_ssd.pColPic);
+
+    m_ssd.pNALU   = nullptr;
+    m_ssd.pColPic = nullptr;
+    m_pWPP = nullptr;
+
+    ColPicSlices = 0;
+    NumColSlices = 0;
+}
+
+bool SDParser::SSDParse()
+{
+    auto& s = m_ssd;
+    auto& slice = *s.pNALU->slice;
+    auto& pps = *slice.pps;
+
+    if (!s.CtxReady)
     {
-        if (AvailableZs(xCtb, yCtb, xCtb + CtbLog2SizeY, yCtb - CtbLog2SizeY))
-            SyncWPP();
-        else
+        if (m_WPPRow)
+        {
+            // row above is parsed by another thread, its contexts are ready after 2nd CTU
+            if (!WPPImport(std::min<Bs32u>(2, PicWidthInCtbsY)))
+                return false;
+
+            if (AvailableZs(s.xCtb, s.yCtb, s.xCtb + CtbLog2SizeY, s.yCtb - CtbLog2SizeY))
+                SyncWPP(m_pWPP->SDT[m_WPPRow - 1]->p);
+            else
+                InitCtx();
+        }
+        else if (   !slice.dependent_slice_segment_flag
+            || TileId[s.CtbAddrInTs] != TileId[s.CtbAddrInTs-1])
+        {
             InitCtx();
-    }
-    else
-    {
-        SyncDS();
-    }
-    qPY_PREV = SliceQpY;
+        }
+        else if (pps.entropy_coding_sync_enabled_flag && (s.CtbAddrInRs % PicWidthInCtbsY) == 0)
+        {
+            if (AvailableZs(s.xCtb, s.yCtb, s.xCtb + CtbLog2SizeY, s.yCtb - CtbLog2SizeY))
+                SyncWPP();
+            else
+                InitCtx();
+        }
+        else
+        {
+            SyncDS();
+        }
+        qPY_PREV = SliceQpY;
 
-    InitADE();
+        InitADE();
 
-    if (pps.entropy_coding_sync_enabled_flag && PicWidthInCtbsY == 1)
-        StoreWPP();
+        if (pps.entropy_coding_sync_enabled_flag && PicWidthInCtbsY == 1)
+            StoreWPP();
 
-    CTU* pCTU = Alloc<CTU>();
+        s.pCTU = Alloc<CTU>();
+        s.CtxReady = true;
+    }
 
-    for (;;)
+    while (!s.CtuDone)
     {
-        auto& ctu = *pCTU;
+        auto& ctu = *s.pCTU;
 
-        CtuInRs[CtbAddrInRs] = pCTU;
+        CtuInRs[s.CtbAddrInRs] = s.pCTU;
 
-        BS2_SET(CtbAddrInRs, ctu.CtbAddrInRs);
-        BS2_SET(CtbAddrInTs, ctu.CtbAddrInTs);
+        // the row above is behind, parsing resumes from this CTU on the next call
+        if (m_WPPRow && !WPPImport(std::min<Bs32u>(s.CtbAddrInRs % PicWidthInCtbsY + 2, PicWidthInCtbsY)))
+            return false;
+
+        BS2_SET(s.CtbAddrInRs, ctu.CtbAddrInRs);
+        BS2_SET(s.CtbAddrInTs, ctu.CtbAddrInTs);
 
         if (slice.sao_luma_flag || slice.sao_chroma_flag)
-            parseSAO(ctu, xCtb >> CtbLog2SizeY, yCtb >> CtbLog2SizeY);
+            parseSAO(ctu, s.xCtb >> CtbLog2SizeY, s.yCtb >> CtbLog2SizeY);
 
         ctu.Cu = Alloc<CU>();
-        ctu.Cu->x = xCtb;
-        ctu.Cu->y = yCtb;
+        ctu.Cu->x = s.xCtb;
+        ctu.Cu->y = s.yCtb;
         parseCQT(*ctu.Cu, CtbLog2SizeY, 0);
 
-        if (slice.Split && !--NumCtb)
+        // end_of_slice_segment_flag is terminate-coded, contexts can be stored before it
+        if (pps.entropy_coding_sync_enabled_flag && (s.CtbAddrInRs % PicWidthInCtbsY) == 1)
+            StoreWPP();
+
+        if (m_pWPP)
+            m_pWPP->Set(m_WPPRow, s.CtbAddrInRs % PicWidthInCtbsY + 1);
+
+        if (slice.Split && !--s.NumCtb)
+        {
+            s.CtuDone = true;
             break;
+        }
 
         BS2_SET(EndOfSliceSegmentFlag(), ctu.end_of_slice_segment_flag);
 
-        if (pps.entropy_coding_sync_enabled_flag && (CtbAddrInRs % PicWidthInCtbsY) == 1)
-            StoreWPP();
-
         if (ctu.end_of_slice_segment_flag)
         {
             if (pps.dependent_slice_segments_enabled_flag)
                 StoreDS();
+            s.CtuDone = true;
             break;
         }
 
-        pCTU->Next = Alloc<CTU>();
-        pCTU = pCTU->Next;
-        CtbAddrInTs++;
-        CtbAddrInRs = CtbAddrTsToRs[CtbAddrInTs];
-        xCtb = (CtbAddrInRs % PicWidthInCtbsY) << CtbLog2SizeY;
-        yCtb = (CtbAddrInRs / PicWidthInCtbsY) << CtbLog2SizeY;
-        SliceAddrRsInTs[CtbAddrInTs] = SliceAddrRs;
+        s.pCTU->Next = Alloc<CTU>();
+        s.pCTU = s.pCTU->Next;
+        s.CtbAddrInTs++;
+        s.CtbAddrInRs = CtbAddrTsToRs[s.CtbAddrInTs];
+        s.xCtb = (s.CtbAddrInRs % PicWidthInCtbsY) << CtbLog2SizeY;
+        s.yCtb = (s.CtbAddrInRs / PicWidthInCtbsY) << CtbLog2SizeY;
+        SliceAddrRsInTs[s.CtbAddrInTs] = s.SliceAddrRs;
 
         if (   (   pps.tiles_enabled_flag
-                && TileId[CtbAddrInTs] != TileId[CtbAddrInTs - 1])
+                && TileId[s.CtbAddrInTs] != TileId[s.CtbAddrInTs - 1])
             || (   pps.entropy_coding_sync_enabled_flag
-                && (CtbAddrInTs % PicWidthInCtbsY == 0 || TileId[CtbAddrInTs] != TileId[CtbAddrRsToTs[CtbAddrInRs - 1]])))
+                && (s.CtbAddrInTs % PicWidthInCtbsY == 0 || TileId[s.CtbAddrInTs] != TileId[CtbAddrRsToTs[s.CtbAddrInRs - 1]])))
         {
             if (!EndOfSubsetOneBit())
                 throw InvalidSyntax();
@@ -193,17 +309,17 @@ CTU* SDParser::parseSSD(NALU& nalu, NALU* pColPic, Bs32u NumCtb)
                 throw InvalidSyntax();
         }
 
-        if (TileId[CtbAddrInTs] != TileId[CtbAddrInTs - 1])
+        if (TileId[s.CtbAddrInTs] != TileId[s.CtbAddrInTs - 1])
         {
             InitCtx();
             InitADE();
             qPY_PREV = SliceQpY;
         }
-        else if (pps.entropy_coding_sync_enabled_flag && (CtbAddrInRs % PicWidthInCtbsY) == 0)
+        else if (pps.entropy_coding_sync_enabled_flag && (s.CtbAddrInRs % PicWidthInCtbsY) == 0)
         {
             InitPCMBlock();
 
-            if (AvailableZs(xCtb, yCtb, xCtb + CtbLog2SizeY, yCtb - CtbLog2SizeY))
+            if (AvailableZs(s.xCtb, s.yCtb, s.xCtb + CtbLog2SizeY, s.yCtb - CtbLog2SizeY))
                 SyncWPP();
             else
                 InitCtx();
@@ -212,16 +328,30 @@ CTU* SDParser::parseSSD(NALU& nalu, NALU* pColPic, Bs32u NumCtb)
         }
     }
 
-    if (!pCTU || (!pCTU->end_of_slice_segment_flag && !slice.Split))
+    if (!s.pCTU || (!s.pCTU->end_of_slice_segment_flag && !slice.Split))
         throw InvalidSyntax();
 
+    // next dependent slice segment continues in this thread and may refer to the row above
+    if (m_WPPRow && !WPPImport(PicWidthInCtbsY))
+        return false;
+
+    return true;
+}
+
+CTU* SDParser::SSDFinish()
+{
+    auto& s = m_ssd;
+    auto& slice = *s.pNALU->slice;
+    CTU* pCTU = s.pCTU;
+
+    m_pWPP = nullptr;
+
     if (m_pAllocator)
     {
-        nCTU = m_ctu.size() - nCTU;
-        nCU  = m_cu.size()  - nCU;
-        nPU  = m_pu.size()  - nPU;
-        nTU  = m_tu.size()  - nTU;
-
+        auto nCTU = m_ctu.size() - s.nCTU;
+        auto nCU  = m_cu.size()  - s.nCU;
+        auto nPU  = m_pu.size()  - s.nPU;
+        auto nTU  = m_tu.size()  - s.nTU;
         pCTU = m_pAllocator->alloc<CTU>(0, (Bs32u)nCTU);
         auto pCU  = m_pAllocator->alloc<CU>(pCTU, (Bs32u)nCU);
         auto pPU  = m_pAllocator->alloc<PU>(pCTU, (Bs32u)nPU);
@@ -298,9 +428,6 @@ CTU* SDParser::parseSSD(NALU& nalu, NALU* pColPic, Bs32u NumCtb)
         //printf("NumCTU = %d\n", slice.NumCTU);
     }
 
-    ColPicSlices = 0;
-    NumColSlices = 0;
-
     return pCTU;
 }
 
@@ -1665,17 +1792,12 @@ void SDParser::parseResidual(CU& cu, TU& tu, Bs16u x0, Bs16u y0, Bs16u log2Trafo
                 escapeDataPresent = true;
         }
 
-        for (Bs32s ii = 0; ii < nSC; ii++)
-        {
-            auto n = sig_coeff[ii];
+        // sign of firstSigScanPos (last one in sig_coeff[]) may be hidden
+        Bs32u nSign = Bs32u(nSC - (pps.sign_data_hiding_enabled_flag && signHidden));
+        Bs32u signs = CoeffSignFlags(nSign);
 
-            if (   !pps.sign_data_hiding_enabled_flag
-                || !signHidden
-                || (n != firstSigScanPos))
-            {
-                BS2_SET(CoeffSignFlag(), coeff_sign_flag[n]);
-            }
-        }
+        for (Bs32u ii = 0; ii < nSign; ii++)
+            BS2_SET(!!((signs >> (nSign - 1 - ii)) & 1), coeff_sign_flag[sig_coeff[ii]]);
 
         Bs32s numSigCoeff = 0;
         Bs32s sumAbsLevel = 0;
@@ -0,0 +1,66 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Null VA backend.
+//
+// libva_null exports the subset of the libva API used by the runtime and
+// completes every request instantly on the CPU: surfaces and buffers live in
+// system memory, vaSyncSurface never waits and encode pictures produce a
+// synthetic bitstream (packed headers submitted by the runtime followed by
+// a dummy payload). An application linked with libva_null ahead of libva
+// (and libc) interposes these symbols for the whole process, including the
+// runtime loaded by the dispatcher, so the full host-side task path can be
+// profiled without a GPU.
+//
+// The display is created with vaGetDisplayDRM() on any fd (e.g. /dev/null).
+// I915_GETPARAM ioctls on that fd are answered with the device ID from
+// MFX_VA_NULL_DEVICE_ID (hex, default 0x3E92) so the runtime picks a platform.
+
+#ifndef __VA_NULL_H__
+#define __VA_NULL_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint64_t Calls;       // VA entry points served
+    uint64_t CpuTimeNs;   // thread CPU time spent inside them
+    uint64_t Pictures;    // vaEndPicture calls
+    uint64_t Syncs;       // vaSyncSurface/vaSyncBuffer calls
+    uint64_t BufferBytes; // bytes passed to vaCreateBuffer
+} VANullStats;
+
+void vaNullGetStats(VANullStats* stats);
+void vaNullResetStats(void);
+
+// used by the ioctl interposer, not part of the application interface
+void vaNullRegisterFd(int fd);
+int  vaNullIsRegisteredFd(int fd);
+int  vaNullDeviceId(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __VA_NULL_H__
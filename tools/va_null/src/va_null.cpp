@@ -0,0 +1,1435 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <va/va.h>
+#include <va/va_backend.h>
+#include <va/va_drm.h>
+#include <va/va_drmcommon.h>
+#include <va/va_vpp.h>
+
+#include "va_null.h"
+
+#ifndef VA_DISPLAY_MAGIC
+#define VA_DISPLAY_MAGIC 0x56414430
+#endif
+
+namespace
+{
+    std::atomic<uint64_t> g_calls       { 0 };
+    std::atomic<uint64_t> g_cpuTimeNs   { 0 };
+    std::atomic<uint64_t> g_pictures    { 0 };
+    std::atomic<uint64_t> g_syncs       { 0 };
+    std::atomic<uint64_t> g_bufferBytes { 0 };
+
+    inline uint64_t ThreadCpuTimeNs()
+    {
+        timespec ts = {};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+    }
+
+    // Accounts a VA call in the global statistics
+    class CallScope
+    {
+    public:
+        CallScope()
+            : m_start(ThreadCpuTimeNs())
+        {}
+        ~CallScope()
+        {
+            g_calls++;
+            g_cpuTimeNs += ThreadCpuTimeNs() - m_start;
+        }
+    private:
+        uint64_t m_start;
+    };
+
+    inline uint32_t Align(uint32_t value, uint32_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    struct Layout
+    {
+        uint32_t bpp        = 0;
+        uint32_t numPlanes  = 0;
+        uint32_t pitches[3] = {};
+        uint32_t offsets[3] = {};
+        uint32_t size       = 0;
+    };
+
+    bool GetLayout(uint32_t fourcc, uint32_t width, uint32_t height, Layout& layout)
+    {
+        uint32_t h     = Align(height, 32);
+        uint32_t bytes = 0;  // bytes per pixel of single plane formats
+        uint32_t cwDiv = 0;  // chroma subsampling of planar formats
+        uint32_t chDiv = 0;
+
+        layout = Layout();
+
+        switch (fourcc)
+        {
+        case VA_FOURCC_NV12:
+        case VA_FOURCC_P010:
+        case VA_FOURCC_P016:
+        case VA_FOURCC_P208:
+        {
+            bool     is16   = fourcc == VA_FOURCC_P010 || fourcc == VA_FOURCC_P016;
+            uint32_t pitch  = Align(width * (is16 ? 2 : 1), 64);
+            uint32_t uvRows = fourcc == VA_FOURCC_P208 ? h : h / 2;
+
+            layout.bpp        = fourcc == VA_FOURCC_P208 ? 16 : (is16 ? 24 : 12);
+            layout.numPlanes  = 2;
+            layout.pitches[0] = layout.pitches[1] = pitch;
+            layout.offsets[1] = pitch * h;
+            layout.size       = pitch * (h + uvRows);
+            return true;
+        }
+        case VA_FOURCC_YV12:
+        case VA_FOURCC_I420:
+        case VA_FOURCC_IMC3: cwDiv = 2; chDiv = 2; break;
+        case VA_FOURCC_422H: cwDiv = 2; chDiv = 1; break;
+        case VA_FOURCC_422V: cwDiv = 1; chDiv = 2; break;
+        case VA_FOURCC_411P: cwDiv = 4; chDiv = 1; break;
+        case VA_FOURCC_444P:
+        case VA_FOURCC_RGBP: cwDiv = 1; chDiv = 1; break;
+        case VA_FOURCC_Y800: bytes = 1; break;
+        case VA_FOURCC_YUY2:
+        case VA_FOURCC_UYVY:
+        case VA_FOURCC_RGB565: bytes = 2; break;
+        case VA_FOURCC_Y210:
+        case VA_FOURCC_Y216:
+        case VA_FOURCC_AYUV:
+        case VA_FOURCC_Y410:
+        case VA_FOURCC_ARGB:
+        case VA_FOURCC_ABGR:
+        case VA_FOURCC_XRGB:
+        case VA_FOURCC_XBGR:
+        case VA_FOURCC_RGBA:
+        case VA_FOURCC_BGRA:
+        case VA_FOURCC_A2R10G10B10:
+        case VA_FOURCC_A2B10G10R10: bytes = 4; break;
+        case VA_FOURCC_Y416: bytes = 8; break;
+        default:
+            return false;
+        }
+
+        if (bytes)
+        {
+            layout.bpp        = bytes * 8;
+            layout.numPlanes  = 1;
+            layout.pitches[0] = Align(width * bytes, 64);
+            layout.size       = layout.pitches[0] * h;
+            return true;
+        }
+
+        // IMC3 keeps luma pitch for chroma planes
+        uint32_t pitch   = Align(width, 64);
+        uint32_t cPitch  = fourcc == VA_FOURCC_IMC3 ? pitch : pitch / cwDiv;
+        uint32_t cHeight = h / chDiv;
+
+        layout.bpp        = 8 + 16 / (cwDiv * chDiv);
+        layout.numPlanes  = 3;
+        layout.pitches[0] = pitch;
+        layout.pitches[1] = layout.pitches[2] = cPitch;
+        layout.offsets[1] = pitch * h;
+        layout.offsets[2] = layout.offsets[1] + cPitch * cHeight;
+        layout.size       = layout.offsets[2] + cPitch * cHeight;
+        return true;
+    }
+
+    uint32_t RTFormatToFourCC(uint32_t format)
+    {
+        switch (format)
+        {
+        case VA_RT_FORMAT_YUV420:     return VA_FOURCC_NV12;
+        case VA_RT_FORMAT_YUV420_10:  return VA_FOURCC_P010;
+        case VA_RT_FORMAT_YUV420_12:  return VA_FOURCC_P016;
+        case VA_RT_FORMAT_YUV422:     return VA_FOURCC_YUY2;
+        case VA_RT_FORMAT_YUV444:     return VA_FOURCC_AYUV;
+        case VA_RT_FORMAT_YUV400:     return VA_FOURCC_Y800;
+        case VA_RT_FORMAT_RGB32:      return VA_FOURCC_ARGB;
+        case VA_RT_FORMAT_RGBP:       return VA_FOURCC_RGBP;
+#ifdef VA_RT_FORMAT_YUV422_10
+        case VA_RT_FORMAT_YUV422_10:  return VA_FOURCC_Y210;
+#endif
+#ifdef VA_RT_FORMAT_YUV444_10
+        case VA_RT_FORMAT_YUV444_10:  return VA_FOURCC_Y410;
+#endif
+#ifdef VA_RT_FORMAT_RGB32_10
+        case VA_RT_FORMAT_RGB32_10:   return VA_FOURCC_A2R10G10B10;
+#endif
+        default:                      return 0;
+        }
+    }
+
+    enum eCodec
+    {
+        CODEC_NONE,
+        CODEC_AVC,
+        CODEC_HEVC,
+        CODEC_MPEG2,
+        CODEC_VC1,
+        CODEC_JPEG,
+        CODEC_VP8,
+        CODEC_VP9
+    };
+
+    eCodec GetCodec(VAProfile profile)
+    {
+        switch (profile)
+        {
+        case VAProfileH264ConstrainedBaseline:
+        case VAProfileH264Main:
+        case VAProfileH264High:
+            return CODEC_AVC;
+        case VAProfileHEVCMain:
+        case VAProfileHEVCMain10:
+        case VAProfileHEVCMain12:
+        case VAProfileHEVCMain422_10:
+        case VAProfileHEVCMain422_12:
+        case VAProfileHEVCMain444:
+        case VAProfileHEVCMain444_10:
+        case VAProfileHEVCMain444_12:
+            return CODEC_HEVC;
+        case VAProfileMPEG2Simple:
+        case VAProfileMPEG2Main:
+            return CODEC_MPEG2;
+        case VAProfileVC1Simple:
+        case VAProfileVC1Main:
+        case VAProfileVC1Advanced:
+            return CODEC_VC1;
+        case VAProfileJPEGBaseline:
+            return CODEC_JPEG;
+        case VAProfileVP8Version0_3:
+            return CODEC_VP8;
+        case VAProfileVP9Profile0:
+        case VAProfileVP9Profile1:
+        case VAProfileVP9Profile2:
+        case VAProfileVP9Profile3:
+            return CODEC_VP9;
+        default:
+            return CODEC_NONE;
+        }
+    }
+
+    const VAProfile g_profiles[] =
+    {
+        VAProfileNone,
+        VAProfileH264ConstrainedBaseline, VAProfileH264Main, VAProfileH264High,
+        VAProfileHEVCMain, VAProfileHEVCMain10, VAProfileHEVCMain12,
+        VAProfileHEVCMain422_10, VAProfileHEVCMain422_12,
+        VAProfileHEVCMain444, VAProfileHEVCMain444_10, VAProfileHEVCMain444_12,
+        VAProfileMPEG2Simple, VAProfileMPEG2Main,
+        VAProfileVC1Simple, VAProfileVC1Main, VAProfileVC1Advanced,
+        VAProfileJPEGBaseline,
+        VAProfileVP8Version0_3,
+        VAProfileVP9Profile0, VAProfileVP9Profile1, VAProfileVP9Profile2, VAProfileVP9Profile3,
+    };
+
+    const int MAX_ENTRYPOINTS = 4;
+
+    // nothing is processed, so report a rate no caller rejects: 2160p60 in 16x16 blocks per second
+    const unsigned int PROCESSING_RATE = 3840 * 2160 / 256 * 60;
+
+    int GetEntrypoints(VAProfile profile, VAEntrypoint* entrypoints)
+    {
+        int n = 0;
+
+        switch (GetCodec(profile))
+        {
+        case CODEC_NONE:
+            entrypoints[n++] = VAEntrypointVideoProc;
+            break;
+        case CODEC_AVC:
+        case CODEC_HEVC:
+            entrypoints[n++] = VAEntrypointVLD;
+            entrypoints[n++] = VAEntrypointEncSlice;
+            entrypoints[n++] = VAEntrypointEncSliceLP;
+            break;
+        case CODEC_MPEG2:
+            entrypoints[n++] = VAEntrypointVLD;
+            entrypoints[n++] = VAEntrypointEncSlice;
+            break;
+        case CODEC_JPEG:
+            entrypoints[n++] = VAEntrypointVLD;
+            entrypoints[n++] = VAEntrypointEncPicture;
+            break;
+        case CODEC_VP9:
+            entrypoints[n++] = VAEntrypointVLD;
+            entrypoints[n++] = VAEntrypointEncSliceLP;
+            break;
+        case CODEC_VC1:
+        case CODEC_VP8:
+            entrypoints[n++] = VAEntrypointVLD;
+            break;
+        }
+
+        return n;
+    }
+
+    bool IsSupported(VAProfile profile, VAEntrypoint entrypoint)
+    {
+        if (std::find(std::begin(g_profiles), std::end(g_profiles), profile) == std::end(g_profiles))
+            return false;
+
+        VAEntrypoint entrypoints[MAX_ENTRYPOINTS];
+        int n = GetEntrypoints(profile, entrypoints);
+        return std::find(entrypoints, entrypoints + n, entrypoint) != entrypoints + n;
+    }
+
+    bool IsEncode(VAEntrypoint entrypoint)
+    {
+        return entrypoint == VAEntrypointEncSlice
+            || entrypoint == VAEntrypointEncSliceLP
+            || entrypoint == VAEntrypointEncPicture;
+    }
+
+    // Reports every capability the runtime probes as present with generous limits
+    uint32_t GetAttribValue(VAProfile profile, VAEntrypoint entrypoint, VAConfigAttribType type)
+    {
+        bool encode = IsEncode(entrypoint);
+
+        switch (type)
+        {
+        case VAConfigAttribRTFormat:
+            return VA_RT_FORMAT_YUV420 | VA_RT_FORMAT_YUV422 | VA_RT_FORMAT_YUV444
+                | VA_RT_FORMAT_YUV400 | VA_RT_FORMAT_YUV420_10 | VA_RT_FORMAT_YUV420_12
+                | VA_RT_FORMAT_RGB32 | VA_RT_FORMAT_RGBP;
+        case VAConfigAttribMaxPictureWidth:
+        case VAConfigAttribMaxPictureHeight:
+            return GetCodec(profile) == CODEC_JPEG ? 16384 : 8192;
+        case VAConfigAttribDecSliceMode:
+            return encode ? VA_ATTRIB_NOT_SUPPORTED : VA_DEC_SLICE_MODE_NORMAL;
+        case VAConfigAttribDecProcessing:
+            return VA_DEC_PROCESSING_NONE;
+        case VAConfigAttribEncryption:
+            return VA_ATTRIB_NOT_SUPPORTED;
+        default:
+            break;
+        }
+
+        if (!encode)
+            return VA_ATTRIB_NOT_SUPPORTED;
+
+        switch (type)
+        {
+        case VAConfigAttribRateControl:
+            return VA_RC_CQP | VA_RC_CBR | VA_RC_VBR | VA_RC_ICQ | VA_RC_QVBR | VA_RC_AVBR;
+        case VAConfigAttribEncPackedHeaders:
+            return VA_ENC_PACKED_HEADER_SEQUENCE | VA_ENC_PACKED_HEADER_PICTURE
+                | VA_ENC_PACKED_HEADER_SLICE | VA_ENC_PACKED_HEADER_MISC | VA_ENC_PACKED_HEADER_RAW_DATA;
+        case VAConfigAttribEncInterlaced:
+            return VA_ENC_INTERLACED_NONE;
+        case VAConfigAttribEncMaxRefFrames:
+            return (2 << 16) | 3;
+        case VAConfigAttribEncMaxSlices:
+            return 256;
+        case VAConfigAttribEncSliceStructure:
+            return VA_ENC_SLICE_STRUCTURE_ARBITRARY_MACROBLOCKS;
+        case VAConfigAttribEncQualityRange:
+            return 7;
+        case VAConfigAttribEncSkipFrame:
+            return 1;
+        case VAConfigAttribEncJPEG:
+        {
+            VAConfigAttribValEncJPEG jpeg = {};
+            jpeg.bits.arithmatic_coding_mode    = 0;
+            jpeg.bits.progressive_dct_mode      = 0;
+            jpeg.bits.non_interleaved_mode      = 1;
+            jpeg.bits.differential_mode         = 0;
+            jpeg.bits.max_num_components        = 3;
+            jpeg.bits.max_num_scans             = 1;
+            jpeg.bits.max_num_huffman_tables    = 2;
+            jpeg.bits.max_num_quantization_tables = 3;
+            return jpeg.value;
+        }
+        case VAConfigAttribContextPriority:
+            return 1024;
+        default:
+            return VA_ATTRIB_NOT_SUPPORTED;
+        }
+    }
+
+    struct Surface
+    {
+        uint32_t             fourcc = 0;
+        uint32_t             width  = 0;
+        uint32_t             height = 0;
+        Layout               layout;
+        std::vector<uint8_t> data;
+    };
+
+    struct Buffer
+    {
+        VABufferType         type     = VABufferTypeMax;
+        uint32_t             size     = 0;
+        uint32_t             num      = 0;
+        std::vector<uint8_t> data;
+        uint8_t*             external = nullptr; // image derived from surface
+        VACodedBufferSegment segment;
+
+        uint8_t* Ptr() { return external ? external : data.data(); }
+    };
+
+    struct Config
+    {
+        VAProfile                   profile    = VAProfileNone;
+        VAEntrypoint                entrypoint = VAEntrypointVLD;
+        std::vector<VAConfigAttrib> attribs;
+    };
+
+    struct Context
+    {
+        VAConfigID           config     = VA_INVALID_ID;
+        int                  width      = 0;
+        int                  height     = 0;
+        VASurfaceID          target     = VA_INVALID_SURFACE;
+        VABufferID           codedBuf   = VA_INVALID_ID;
+        uint32_t             packedBits = 0;
+        std::vector<uint8_t> headers;    // packed headers of current picture
+    };
+
+    struct Image
+    {
+        VAImage     image;
+        VASurfaceID derivedFrom = VA_INVALID_SURFACE;
+    };
+
+    struct Device
+    {
+        std::mutex                                mutex;
+        VAGenericID                               nextId = 1;
+        std::unordered_map<VASurfaceID, Surface>  surfaces;
+        std::unordered_map<VABufferID,  Buffer>   buffers;
+        std::unordered_map<VAConfigID,  Config>   configs;
+        std::unordered_map<VAContextID, Context>  contexts;
+        std::unordered_map<VAImageID,   Image>    images;
+        std::unordered_map<VAMFContextID, std::vector<VAContextID>> mfContexts;
+    };
+
+    struct NullDisplay
+    {
+        VADisplayContext displayContext;
+        VADriverContext  driverContext;
+        drm_state        drmState;
+        Device           device;
+    };
+
+    template <class T>
+    T* Find(std::unordered_map<VAGenericID, T>& map, VAGenericID id)
+    {
+        auto it = map.find(id);
+        return it == map.end() ? nullptr : &it->second;
+    }
+
+    Device* GetDevice(VADisplay dpy)
+    {
+        VADisplayContextP ctx = reinterpret_cast<VADisplayContextP>(dpy);
+        if (!ctx || ctx->vadpy_magic != VA_DISPLAY_MAGIC || !ctx->pDriverContext)
+            return nullptr;
+        return &static_cast<NullDisplay*>(ctx->pDriverContext->pDriverData)->device;
+    }
+
+    VAImageFormat MakeImageFormat(uint32_t fourcc, uint32_t bpp)
+    {
+        VAImageFormat format = {};
+        format.fourcc         = fourcc;
+        format.byte_order     = VA_LSB_FIRST;
+        format.bits_per_pixel = bpp;
+
+        switch (fourcc)
+        {
+        case VA_FOURCC_ARGB:
+        case VA_FOURCC_XRGB:
+            format.depth      = fourcc == VA_FOURCC_ARGB ? 32 : 24;
+            format.red_mask   = 0x00ff0000;
+            format.green_mask = 0x0000ff00;
+            format.blue_mask  = 0x000000ff;
+            format.alpha_mask = fourcc == VA_FOURCC_ARGB ? 0xff000000 : 0;
+            break;
+        case VA_FOURCC_ABGR:
+        case VA_FOURCC_XBGR:
+            format.depth      = fourcc == VA_FOURCC_ABGR ? 32 : 24;
+            format.red_mask   = 0x000000ff;
+            format.green_mask = 0x0000ff00;
+            format.blue_mask  = 0x00ff0000;
+            format.alpha_mask = fourcc == VA_FOURCC_ABGR ? 0xff000000 : 0;
+            break;
+        default:
+            break;
+        }
+
+        return format;
+    }
+
+    VABufferID GetCodedBuffer(VAProfile profile, const void* pp)
+    {
+        switch (GetCodec(profile))
+        {
+        case CODEC_AVC:   return static_cast<const VAEncPictureParameterBufferH264*>(pp)->coded_buf;
+        case CODEC_HEVC:  return static_cast<const VAEncPictureParameterBufferHEVC*>(pp)->coded_buf;
+        case CODEC_MPEG2: return static_cast<const VAEncPictureParameterBufferMPEG2*>(pp)->coded_buf;
+        case CODEC_JPEG:  return static_cast<const VAEncPictureParameterBufferJPEG*>(pp)->coded_buf;
+        case CODEC_VP9:   return static_cast<const VAEncPictureParameterBufferVP9*>(pp)->coded_buf;
+        default:          return VA_INVALID_ID;
+        }
+    }
+
+    // Writes packed headers of the picture followed by a dummy slice payload
+    void WriteSyntheticBitstream(Context& ctx, Buffer& coded)
+    {
+        uint8_t* dst      = coded.Ptr();
+        uint32_t capacity = uint32_t(coded.data.size());
+        uint32_t size     = std::min<uint32_t>(uint32_t(ctx.headers.size()), capacity);
+
+        std::copy(ctx.headers.begin(), ctx.headers.begin() + size, dst);
+
+        uint32_t payload = std::max<uint32_t>(uint32_t(ctx.width * ctx.height) / 256, 16);
+        payload = std::min(payload, capacity - size);
+
+        if (payload)
+        {
+            // no zero bytes - can't emulate start codes, ends with rbsp stop bit
+            memset(dst + size, 0x55, payload);
+            dst[size + payload - 1] = 0x80;
+            size += payload;
+        }
+
+        coded.segment = VACodedBufferSegment();
+        coded.segment.size = size;
+        coded.segment.buf  = dst;
+    }
+}
+
+extern "C"
+{
+
+void vaNullGetStats(VANullStats* stats)
+{
+    if (!stats)
+        return;
+
+    stats->Calls       = g_calls;
+    stats->CpuTimeNs   = g_cpuTimeNs;
+    stats->Pictures    = g_pictures;
+    stats->Syncs       = g_syncs;
+    stats->BufferBytes = g_bufferBytes;
+}
+
+void vaNullResetStats(void)
+{
+    g_calls       = 0;
+    g_cpuTimeNs   = 0;
+    g_pictures    = 0;
+    g_syncs       = 0;
+    g_bufferBytes = 0;
+}
+
+VADisplay vaGetDisplayDRM(int fd)
+{
+    NullDisplay* display = new NullDisplay;
+
+    memset(&display->displayContext, 0, sizeof(display->displayContext));
+    memset(&display->driverContext, 0, sizeof(display->driverContext));
+    memset(&display->drmState, 0, sizeof(display->drmState));
+
+    display->drmState.fd        = fd;
+    display->drmState.auth_type = VA_DRM_AUTH_CUSTOM;
+
+    display->driverContext.drm_state    = &display->drmState;
+    display->driverContext.pDriverData  = display;
+    display->driverContext.display_type = VA_DISPLAY_DRM;
+
+    display->displayContext.vadpy_magic    = VA_DISPLAY_MAGIC;
+    display->displayContext.pDriverContext = &display->driverContext;
+
+    vaNullRegisterFd(fd);
+
+    return &display->displayContext;
+}
+
+int vaDisplayIsValid(VADisplay dpy)
+{
+    return GetDevice(dpy) != nullptr;
+}
+
+VAStatus vaInitialize(VADisplay dpy, int* major_version, int* minor_version)
+{
+    if (!GetDevice(dpy))
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    if (major_version) *major_version = VA_MAJOR_VERSION;
+    if (minor_version) *minor_version = VA_MINOR_VERSION;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaTerminate(VADisplay dpy)
+{
+    if (!GetDevice(dpy))
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    VADisplayContextP ctx = reinterpret_cast<VADisplayContextP>(dpy);
+    NullDisplay* display = static_cast<NullDisplay*>(ctx->pDriverContext->pDriverData);
+    ctx->vadpy_magic = 0;
+    delete display;
+    return VA_STATUS_SUCCESS;
+}
+
+const char* vaQueryVendorString(VADisplay)
+{
+    return "Null VA backend";
+}
+
+const char* vaErrorStr(VAStatus error_status)
+{
+    return error_status == VA_STATUS_SUCCESS ? "success (no error)" : "null backend error";
+}
+
+int vaMaxNumProfiles(VADisplay)
+{
+    return int(sizeof(g_profiles) / sizeof(g_profiles[0]));
+}
+
+int vaMaxNumEntrypoints(VADisplay)
+{
+    return MAX_ENTRYPOINTS;
+}
+
+int vaMaxNumConfigAttributes(VADisplay)
+{
+    return VAConfigAttribTypeMax;
+}
+
+int vaMaxNumImageFormats(VADisplay)
+{
+    return 4;
+}
+
+VAStatus vaQueryConfigProfiles(VADisplay dpy, VAProfile* profile_list, int* num_profiles)
+{
+    CallScope scope;
+    if (!GetDevice(dpy))
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!profile_list || !num_profiles)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::copy(std::begin(g_profiles), std::end(g_profiles), profile_list);
+    *num_profiles = vaMaxNumProfiles(dpy);
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaQueryConfigEntrypoints(VADisplay dpy, VAProfile profile, VAEntrypoint* entrypoint_list, int* num_entrypoints)
+{
+    CallScope scope;
+    if (!GetDevice(dpy))
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!entrypoint_list || !num_entrypoints)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+    if (std::find(std::begin(g_profiles), std::end(g_profiles), profile) == std::end(g_profiles))
+        return VA_STATUS_ERROR_UNSUPPORTED_PROFILE;
+
+    *num_entrypoints = GetEntrypoints(profile, entrypoint_list);
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaGetConfigAttributes(VADisplay dpy, VAProfile profile, VAEntrypoint entrypoint, VAConfigAttrib* attrib_list, int num_attribs)
+{
+    CallScope scope;
+    if (!GetDevice(dpy))
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!IsSupported(profile, entrypoint))
+        return VA_STATUS_ERROR_UNSUPPORTED_ENTRYPOINT;
+    if (num_attribs && !attrib_list)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    for (int i = 0; i < num_attribs; ++i)
+        attrib_list[i].value = GetAttribValue(profile, entrypoint, attrib_list[i].type);
+
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaCreateConfig(VADisplay dpy, VAProfile profile, VAEntrypoint entrypoint, VAConfigAttrib* attrib_list, int num_attribs, VAConfigID* config_id)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!config_id || (num_attribs && !attrib_list))
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+    if (!IsSupported(profile, entrypoint))
+        return VA_STATUS_ERROR_UNSUPPORTED_ENTRYPOINT;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    Config& config = dev->configs[dev->nextId];
+    config.profile    = profile;
+    config.entrypoint = entrypoint;
+    config.attribs.assign(attrib_list, attrib_list + num_attribs);
+
+    *config_id = dev->nextId++;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaDestroyConfig(VADisplay dpy, VAConfigID config_id)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+    return dev->configs.erase(config_id) ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_CONFIG;
+}
+
+VAStatus vaQueryConfigAttributes(VADisplay dpy, VAConfigID config_id, VAProfile* profile, VAEntrypoint* entrypoint, VAConfigAttrib* attrib_list, int* num_attribs)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    Config* config = Find(dev->configs, config_id);
+    if (!config)
+        return VA_STATUS_ERROR_INVALID_CONFIG;
+
+    if (profile)    *profile    = config->profile;
+    if (entrypoint) *entrypoint = config->entrypoint;
+    if (attrib_list)
+        std::copy(config->attribs.begin(), config->attribs.end(), attrib_list);
+    if (num_attribs)
+        *num_attribs = int(config->attribs.size());
+
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaCreateSurfaces(VADisplay dpy, unsigned int format, unsigned int width, unsigned int height, VASurfaceID* surfaces, unsigned int num_surfaces, VASurfaceAttrib* attrib_list, unsigned int num_attribs)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!surfaces || !width || !height)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    uint32_t fourcc = RTFormatToFourCC(format);
+
+    for (unsigned int i = 0; attrib_list && i < num_attribs; ++i)
+    {
+        if (attrib_list[i].type == VASurfaceAttribPixelFormat && attrib_list[i].value.type == VAGenericValueTypeInteger)
+            fourcc = uint32_t(attrib_list[i].value.value.i);
+    }
+
+    Layout layout;
+    if (!GetLayout(fourcc, width, height, layout))
+        return VA_STATUS_ERROR_UNSUPPORTED_RT_FORMAT;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    for (unsigned int i = 0; i < num_surfaces; ++i)
+    {
+        Surface& surface = dev->surfaces[dev->nextId];
+        surface.fourcc = fourcc;
+        surface.width  = width;
+        surface.height = height;
+        surface.layout = layout;
+        surface.data.assign(layout.size, 0);
+
+        surfaces[i] = dev->nextId++;
+    }
+
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaDestroySurfaces(VADisplay dpy, VASurfaceID* surfaces, int num_surfaces)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (num_surfaces && !surfaces)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    VAStatus sts = VA_STATUS_SUCCESS;
+    for (int i = 0; i < num_surfaces; ++i)
+    {
+        if (!dev->surfaces.erase(surfaces[i]))
+            sts = VA_STATUS_ERROR_INVALID_SURFACE;
+    }
+    return sts;
+}
+
+VAStatus vaCreateContext(VADisplay dpy, VAConfigID config_id, int picture_width, int picture_height, int /*flag*/, VASurfaceID* /*render_targets*/, int /*num_render_targets*/, VAContextID* context)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!context)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    if (!Find(dev->configs, config_id))
+        return VA_STATUS_ERROR_INVALID_CONFIG;
+
+    Context& ctx = dev->contexts[dev->nextId];
+    ctx.config = config_id;
+    ctx.width  = picture_width;
+    ctx.height = picture_height;
+
+    *context = dev->nextId++;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaDestroyContext(VADisplay dpy, VAContextID context)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+    return dev->contexts.erase(context) ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_CONTEXT;
+}
+
+VAStatus vaCreateBuffer(VADisplay dpy, VAContextID /*context*/, VABufferType type, unsigned int size, unsigned int num_elements, void* data, VABufferID* buf_id)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!buf_id)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    size_t bytes = size_t(size) * num_elements;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    Buffer& buffer = dev->buffers[dev->nextId];
+    buffer.type = type;
+    buffer.size = size;
+    buffer.num  = num_elements;
+
+    if (data)
+        buffer.data.assign(static_cast<uint8_t*>(data), static_cast<uint8_t*>(data) + bytes);
+    else
+        buffer.data.assign(bytes, 0);
+
+    buffer.segment = VACodedBufferSegment();
+    buffer.segment.buf = buffer.data.data();
+
+    g_bufferBytes += bytes;
+
+    *buf_id = dev->nextId++;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaBufferSetNumElements(VADisplay dpy, VABufferID buf_id, unsigned int num_elements)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    Buffer* buffer = Find(dev->buffers, buf_id);
+    if (!buffer)
+        return VA_STATUS_ERROR_INVALID_BUFFER;
+    if (num_elements > buffer->num)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    buffer->num = num_elements;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaMapBuffer(VADisplay dpy, VABufferID buf_id, void** pbuf)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!pbuf)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    Buffer* buffer = Find(dev->buffers, buf_id);
+    if (!buffer)
+        return VA_STATUS_ERROR_INVALID_BUFFER;
+
+    if (buffer->type == VAEncCodedBufferType)
+        *pbuf = &buffer->segment;
+    else
+        *pbuf = buffer->Ptr();
+
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaUnmapBuffer(VADisplay dpy, VABufferID buf_id)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+    return Find(dev->buffers, buf_id) ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_BUFFER;
+}
+
+VAStatus vaDestroyBuffer(VADisplay dpy, VABufferID buffer_id)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+    return dev->buffers.erase(buffer_id) ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_BUFFER;
+}
+
+VAStatus vaBeginPicture(VADisplay dpy, VAContextID context, VASurfaceID render_target)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    Context* ctx = Find(dev->contexts, context);
+    if (!ctx)
+        return VA_STATUS_ERROR_INVALID_CONTEXT;
+    if (!Find(dev->surfaces, render_target))
+        return VA_STATUS_ERROR_INVALID_SURFACE;
+
+    ctx->target     = render_target;
+    ctx->codedBuf   = VA_INVALID_ID;
+    ctx->packedBits = 0;
+    ctx->headers.clear();
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaRenderPicture(VADisplay dpy, VAContextID context, VABufferID* buffers, int num_buffers)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (num_buffers && !buffers)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    Context* ctx = Find(dev->contexts, context);
+    if (!ctx || ctx->target == VA_INVALID_SURFACE)
+        return VA_STATUS_ERROR_INVALID_CONTEXT;
+
+    Config* config = Find(dev->configs, ctx->config);
+    if (!config)
+        return VA_STATUS_ERROR_INVALID_CONFIG;
+
+    for (int i = 0; i < num_buffers; ++i)
+    {
+        Buffer* buffer = Find(dev->buffers, buffers[i]);
+        if (!buffer)
+            return VA_STATUS_ERROR_INVALID_BUFFER;
+
+        if (!IsEncode(config->entrypoint))
+            continue;
+
+        switch (buffer->type)
+        {
+        case VAEncPictureParameterBufferType:
+            ctx->codedBuf = GetCodedBuffer(config->profile, buffer->Ptr());
+            break;
+        case VAEncPackedHeaderParameterBufferType:
+            ctx->packedBits = reinterpret_cast<VAEncPackedHeaderParameterBuffer*>(buffer->Ptr())->bit_length;
+            break;
+        case VAEncPackedHeaderDataBufferType:
+        {
+            size_t bytes = std::min<size_t>((ctx->packedBits + 7) / 8, buffer->data.size());
+            ctx->headers.insert(ctx->headers.end(), buffer->Ptr(), buffer->Ptr() + bytes);
+            ctx->packedBits = 0;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaEndPicture(VADisplay dpy, VAContextID context)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    Context* ctx = Find(dev->contexts, context);
+    if (!ctx || ctx->target == VA_INVALID_SURFACE)
+        return VA_STATUS_ERROR_INVALID_CONTEXT;
+
+    Buffer* coded = Find(dev->buffers, ctx->codedBuf);
+    if (coded && coded->type == VAEncCodedBufferType)
+        WriteSyntheticBitstream(*ctx, *coded);
+
+    ctx->target = VA_INVALID_SURFACE;
+    g_pictures++;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaSyncSurface(VADisplay dpy, VASurfaceID render_target)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    g_syncs++;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+    return Find(dev->surfaces, render_target) ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_SURFACE;
+}
+
+#if VA_CHECK_VERSION(1, 9, 0)
+VAStatus vaSyncBuffer(VADisplay dpy, VABufferID buf_id, uint64_t /*timeout_ns*/)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    g_syncs++;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+    return Find(dev->buffers, buf_id) ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_INVALID_BUFFER;
+}
+#endif
+
+VAStatus vaQuerySurfaceStatus(VADisplay dpy, VASurfaceID render_target, VASurfaceStatus* status)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!status)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+    if (!Find(dev->surfaces, render_target))
+        return VA_STATUS_ERROR_INVALID_SURFACE;
+
+    *status = VASurfaceReady;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaQuerySurfaceError(VADisplay dpy, VASurfaceID surface, VAStatus /*error_status*/, void** error_info)
+{
+    static VASurfaceDecodeMBErrors noErrors[1] = {};
+
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!error_info)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+    if (!Find(dev->surfaces, surface))
+        return VA_STATUS_ERROR_INVALID_SURFACE;
+
+    noErrors[0].status = -1; // empty list terminator
+    *error_info = noErrors;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaQueryImageFormats(VADisplay dpy, VAImageFormat* format_list, int* num_formats)
+{
+    CallScope scope;
+    if (!GetDevice(dpy))
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!format_list || !num_formats)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    const uint32_t fourccs[] = { VA_FOURCC_NV12, VA_FOURCC_P010, VA_FOURCC_YUY2, VA_FOURCC_ARGB };
+    *num_formats = 0;
+    for (uint32_t fourcc : fourccs)
+    {
+        Layout layout;
+        GetLayout(fourcc, 16, 16, layout);
+        format_list[(*num_formats)++] = MakeImageFormat(fourcc, layout.bpp);
+    }
+
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaCreateImage(VADisplay dpy, VAImageFormat* format, int width, int height, VAImage* image)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!format || !image || width <= 0 || height <= 0)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    Layout layout;
+    if (!GetLayout(format->fourcc, width, height, layout))
+        return VA_STATUS_ERROR_INVALID_IMAGE_FORMAT;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    VABufferID bufId = dev->nextId++;
+    Buffer& buffer = dev->buffers[bufId];
+    buffer.type = VAImageBufferType;
+    buffer.size = layout.size;
+    buffer.num  = 1;
+    buffer.data.assign(layout.size, 0);
+
+    VAImageID imageId = dev->nextId++;
+    Image& img = dev->images[imageId];
+    img.image = VAImage();
+    img.image.image_id   = imageId;
+    img.image.format     = *format;
+    img.image.buf        = bufId;
+    img.image.width      = uint16_t(width);
+    img.image.height     = uint16_t(height);
+    img.image.data_size  = layout.size;
+    img.image.num_planes = layout.numPlanes;
+    std::copy(layout.pitches, layout.pitches + 3, img.image.pitches);
+    std::copy(layout.offsets, layout.offsets + 3, img.image.offsets);
+
+    *image = img.image;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaDeriveImage(VADisplay dpy, VASurfaceID surface, VAImage* image)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!image)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    Surface* surf = Find(dev->surfaces, surface);
+    if (!surf)
+        return VA_STATUS_ERROR_INVALID_SURFACE;
+
+    VABufferID bufId = dev->nextId++;
+    Buffer& buffer = dev->buffers[bufId];
+    buffer.type     = VAImageBufferType;
+    buffer.size     = surf->layout.size;
+    buffer.num      = 1;
+    buffer.external = surf->data.data();
+
+    VAImageID imageId = dev->nextId++;
+    Image& img = dev->images[imageId];
+    img.derivedFrom = surface;
+    img.image = VAImage();
+    img.image.image_id   = imageId;
+    img.image.format     = MakeImageFormat(surf->fourcc, surf->layout.bpp);
+    img.image.buf        = bufId;
+    img.image.width      = uint16_t(surf->width);
+    img.image.height     = uint16_t(surf->height);
+    img.image.data_size  = surf->layout.size;
+    img.image.num_planes = surf->layout.numPlanes;
+    std::copy(surf->layout.pitches, surf->layout.pitches + 3, img.image.pitches);
+    std::copy(surf->layout.offsets, surf->layout.offsets + 3, img.image.offsets);
+
+    *image = img.image;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaDestroyImage(VADisplay dpy, VAImageID image)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    Image* img = Find(dev->images, image);
+    if (!img)
+        return VA_STATUS_ERROR_INVALID_IMAGE;
+
+    dev->buffers.erase(img->image.buf);
+    dev->images.erase(image);
+    return VA_STATUS_SUCCESS;
+}
+
+// Surface and image share the layout when fourcc and size match (the only
+// case the runtime uses), so copies are done plane by plane with row pitches
+static VAStatus CopyRect(Surface& surf, VAImage& image, uint8_t* imageData, bool toSurface)
+{
+    if (image.format.fourcc != surf.fourcc)
+        return VA_STATUS_ERROR_INVALID_IMAGE_FORMAT;
+
+    Layout layout;
+    GetLayout(surf.fourcc, surf.width, surf.height, layout);
+
+    for (uint32_t plane = 0; plane < layout.numPlanes; ++plane)
+    {
+        uint32_t rows = (plane + 1 < layout.numPlanes ? layout.offsets[plane + 1] : layout.size) - layout.offsets[plane];
+        rows /= layout.pitches[plane];
+
+        uint32_t rowBytes = std::min(layout.pitches[plane], image.pitches[plane]);
+        uint32_t maxRows  = (image.data_size - image.offsets[plane]) / std::max(image.pitches[plane], 1u);
+        rows = std::min(rows, maxRows);
+
+        for (uint32_t y = 0; y < rows; ++y)
+        {
+            uint8_t* s = surf.data.data() + layout.offsets[plane] + y * layout.pitches[plane];
+            uint8_t* i = imageData + image.offsets[plane] + y * image.pitches[plane];
+            if (toSurface)
+                memcpy(s, i, rowBytes);
+            else
+                memcpy(i, s, rowBytes);
+        }
+    }
+
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaGetImage(VADisplay dpy, VASurfaceID surface, int /*x*/, int /*y*/, unsigned int /*width*/, unsigned int /*height*/, VAImageID image)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    Surface* surf = Find(dev->surfaces, surface);
+    Image*   img  = Find(dev->images, image);
+    if (!surf)
+        return VA_STATUS_ERROR_INVALID_SURFACE;
+    if (!img)
+        return VA_STATUS_ERROR_INVALID_IMAGE;
+
+    Buffer* buffer = Find(dev->buffers, img->image.buf);
+    if (!buffer)
+        return VA_STATUS_ERROR_INVALID_BUFFER;
+
+    return CopyRect(*surf, img->image, buffer->Ptr(), false);
+}
+
+VAStatus vaPutImage(VADisplay dpy, VASurfaceID surface, VAImageID image, int /*src_x*/, int /*src_y*/, unsigned int /*src_width*/, unsigned int /*src_height*/, int /*dest_x*/, int /*dest_y*/, unsigned int /*dest_width*/, unsigned int /*dest_height*/)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    Surface* surf = Find(dev->surfaces, surface);
+    Image*   img  = Find(dev->images, image);
+    if (!surf)
+        return VA_STATUS_ERROR_INVALID_SURFACE;
+    if (!img)
+        return VA_STATUS_ERROR_INVALID_IMAGE;
+    if (img->derivedFrom == surface)
+        return VA_STATUS_SUCCESS;
+
+    Buffer* buffer = Find(dev->buffers, img->image.buf);
+    if (!buffer)
+        return VA_STATUS_ERROR_INVALID_BUFFER;
+
+    return CopyRect(*surf, img->image, buffer->Ptr(), true);
+}
+
+VAStatus vaQueryVideoProcFilters(VADisplay dpy, VAContextID /*context*/, VAProcFilterType* /*filters*/, unsigned int* num_filters)
+{
+    CallScope scope;
+    if (!GetDevice(dpy))
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!num_filters)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    *num_filters = 0;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaQueryVideoProcFilterCaps(VADisplay dpy, VAContextID /*context*/, VAProcFilterType /*type*/, void* /*filter_caps*/, unsigned int* num_filter_caps)
+{
+    CallScope scope;
+    if (!GetDevice(dpy))
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!num_filter_caps)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    *num_filter_caps = 0;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaQueryVideoProcPipelineCaps(VADisplay dpy, VAContextID /*context*/, VABufferID* /*filters*/, unsigned int /*num_filters*/, VAProcPipelineCaps* pipeline_caps)
+{
+    CallScope scope;
+    if (!GetDevice(dpy))
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!pipeline_caps)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    // keep caller provided color standard/format arrays, report no extras
+    pipeline_caps->pipeline_flags             = 0;
+    pipeline_caps->filter_flags               = 0;
+    pipeline_caps->num_forward_references     = 0;
+    pipeline_caps->num_backward_references    = 0;
+    pipeline_caps->num_input_color_standards  = 0;
+    pipeline_caps->num_output_color_standards = 0;
+    pipeline_caps->rotation_flags             = 0;
+    pipeline_caps->blend_flags                = 0;
+    pipeline_caps->mirror_flags               = 0;
+    pipeline_caps->num_additional_outputs     = 0;
+    pipeline_caps->num_input_pixel_formats    = 0;
+    pipeline_caps->num_output_pixel_formats   = 0;
+    pipeline_caps->max_input_width            = 8192;
+    pipeline_caps->max_input_height           = 8192;
+    pipeline_caps->min_input_width            = 16;
+    pipeline_caps->min_input_height           = 16;
+    pipeline_caps->max_output_width           = 8192;
+    pipeline_caps->max_output_height          = 8192;
+    pipeline_caps->min_output_width           = 16;
+    pipeline_caps->min_output_height          = 16;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaQueryProcessingRate(VADisplay dpy, VAConfigID config, VAProcessingRateParameter* proc_buf, unsigned int* processing_rate)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!proc_buf || !processing_rate)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    if (!Find(dev->configs, config))
+        return VA_STATUS_ERROR_INVALID_CONFIG;
+
+    *processing_rate = PROCESSING_RATE;
+    return VA_STATUS_SUCCESS;
+}
+
+// Multi-frame contexts only group the member contexts; their pictures are already
+// completed by vaEndPicture, so a submission just validates the group
+VAStatus vaCreateMFContext(VADisplay dpy, VAMFContextID* mf_context)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (!mf_context)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    dev->mfContexts[dev->nextId];
+    *mf_context = dev->nextId++;
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaMFAddContext(VADisplay dpy, VAMFContextID mf_context, VAContextID context)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    auto mf = dev->mfContexts.find(mf_context);
+    if (mf == dev->mfContexts.end() || !Find(dev->contexts, context))
+        return VA_STATUS_ERROR_INVALID_CONTEXT;
+
+    if (std::find(mf->second.begin(), mf->second.end(), context) == mf->second.end())
+        mf->second.push_back(context);
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaMFReleaseContext(VADisplay dpy, VAMFContextID mf_context, VAContextID context)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    auto mf = dev->mfContexts.find(mf_context);
+    if (mf == dev->mfContexts.end())
+        return VA_STATUS_ERROR_INVALID_CONTEXT;
+
+    auto it = std::find(mf->second.begin(), mf->second.end(), context);
+    if (it == mf->second.end())
+        return VA_STATUS_ERROR_INVALID_CONTEXT;
+
+    mf->second.erase(it);
+    return VA_STATUS_SUCCESS;
+}
+
+VAStatus vaMFSubmit(VADisplay dpy, VAMFContextID mf_context, VAContextID* contexts, int num_contexts)
+{
+    CallScope scope;
+    Device* dev = GetDevice(dpy);
+    if (!dev)
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    if (num_contexts <= 0 || !contexts)
+        return VA_STATUS_ERROR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> guard(dev->mutex);
+
+    auto mf = dev->mfContexts.find(mf_context);
+    if (mf == dev->mfContexts.end())
+        return VA_STATUS_ERROR_INVALID_CONTEXT;
+
+    for (int i = 0; i < num_contexts; ++i)
+    {
+        if (std::find(mf->second.begin(), mf->second.end(), contexts[i]) == mf->second.end())
+            return VA_STATUS_ERROR_INVALID_CONTEXT;
+    }
+
+    return VA_STATUS_SUCCESS;
+}
+
+} // extern "C"
@@ -0,0 +1,125 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// ioctl() interposer: the runtime reads the device ID of a VA display with
+// DRM_IOCTL_I915_GETPARAM on its DRM fd. Requests on fds registered by the
+// null display are answered here, everything else goes to libc.
+// Kept in C since the C++ declaration of ioctl() in glibc headers carries an
+// exception specification that can't be matched portably.
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+
+#include "va_null.h"
+
+/* BEGIN: IOCTLs definitions (same as in libmfx_core_vaapi.cpp) */
+typedef struct drm_i915_getparam {
+    int param;
+    int *value;
+} drm_i915_getparam_t;
+
+#define I915_PARAM_CHIPSET_ID   4
+#define DRM_I915_GETPARAM       0x06
+#define DRM_IOCTL_BASE          'd'
+#define DRM_COMMAND_BASE        0x40
+#define DRM_IOWR(nr,type)       _IOWR(DRM_IOCTL_BASE,nr,type)
+#define DRM_IOCTL_I915_GETPARAM DRM_IOWR(DRM_COMMAND_BASE + DRM_I915_GETPARAM, drm_i915_getparam_t)
+/* END: IOCTLs definitions */
+
+#define VA_NULL_MAX_FDS 16
+
+static int g_fds[VA_NULL_MAX_FDS];
+static int g_numFds = 0;
+static pthread_mutex_t g_fdsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+void vaNullRegisterFd(int fd)
+{
+    int i, n;
+
+    pthread_mutex_lock(&g_fdsMutex);
+
+    n = __atomic_load_n(&g_numFds, __ATOMIC_ACQUIRE);
+    for (i = 0; i < n; ++i)
+        if (g_fds[i] == fd)
+            break;
+
+    if (i == n && n < VA_NULL_MAX_FDS)
+    {
+        g_fds[n] = fd;
+        __atomic_store_n(&g_numFds, n + 1, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&g_fdsMutex);
+}
+
+int vaNullIsRegisteredFd(int fd)
+{
+    int i, n = __atomic_load_n(&g_numFds, __ATOMIC_ACQUIRE);
+    for (i = 0; i < n; ++i)
+        if (g_fds[i] == fd)
+            return 1;
+    return 0;
+}
+
+int vaNullDeviceId(void)
+{
+    const char* id = getenv("MFX_VA_NULL_DEVICE_ID");
+    return id ? (int)strtol(id, NULL, 16) : 0x3E92; /* CFL GT2 */
+}
+
+typedef int (*ioctl_type)(int, unsigned long, ...);
+
+int ioctl(int fd, unsigned long request, ...)
+{
+    static ioctl_type next_ioctl = NULL;
+    va_list args;
+    void* arg;
+
+    va_start(args, request);
+    arg = va_arg(args, void*);
+    va_end(args);
+
+    if (vaNullIsRegisteredFd(fd))
+    {
+        drm_i915_getparam_t* gp = (drm_i915_getparam_t*)arg;
+
+        if (request == DRM_IOCTL_I915_GETPARAM && gp && gp->param == I915_PARAM_CHIPSET_ID && gp->value)
+        {
+            *gp->value = vaNullDeviceId();
+            return 0;
+        }
+
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (!next_ioctl)
+        next_ioctl = (ioctl_type)dlsym(RTLD_NEXT, "ioctl");
+
+    return next_ioctl(fd, request, arg);
+}